@@ -0,0 +1,40 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+include(FindPackageHelper)
+
+# TODO(tillt): Consider moving "_ROOT_DIR" logic into FindPackageHelper.
+if ("${LIBURING_ROOT_DIR}" STREQUAL "")
+  set(POSSIBLE_LIBURING_INCLUDE_DIRS "")
+  set(POSSIBLE_LIBURING_LIB_DIRS "")
+
+  list(
+    APPEND POSSIBLE_LIBURING_INCLUDE_DIRS
+    /usr/include/
+    /usr/local/include/)
+
+  list(
+    APPEND POSSIBLE_LIBURING_LIB_DIRS
+    /usr/lib
+    /usr/local/lib)
+else()
+  set(POSSIBLE_LIBURING_INCLUDE_DIRS ${LIBURING_ROOT_DIR}/include)
+  set(POSSIBLE_LIBURING_LIB_DIRS ${LIBURING_ROOT_DIR}/lib)
+endif()
+
+set(LIBURING_LIBRARY_NAMES uring)
+
+FIND_PACKAGE_HELPER(LIBURING liburing.h)
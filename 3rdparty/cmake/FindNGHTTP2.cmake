@@ -0,0 +1,40 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+include(FindPackageHelper)
+
+# TODO(tillt): Consider moving "_ROOT_DIR" logic into FindPackageHelper.
+if ("${NGHTTP2_ROOT_DIR}" STREQUAL "")
+  set(POSSIBLE_NGHTTP2_INCLUDE_DIRS "")
+  set(POSSIBLE_NGHTTP2_LIB_DIRS "")
+
+  list(
+    APPEND POSSIBLE_NGHTTP2_INCLUDE_DIRS
+    /usr/include/
+    /usr/local/include/)
+
+  list(
+    APPEND POSSIBLE_NGHTTP2_LIB_DIRS
+    /usr/lib
+    /usr/local/lib)
+else()
+  set(POSSIBLE_NGHTTP2_INCLUDE_DIRS ${NGHTTP2_ROOT_DIR}/include)
+  set(POSSIBLE_NGHTTP2_LIB_DIRS ${NGHTTP2_ROOT_DIR}/lib)
+endif()
+
+set(NGHTTP2_LIBRARY_NAMES nghttp2)
+
+FIND_PACKAGE_HELPER(NGHTTP2 nghttp2/nghttp2.h)
@@ -178,7 +178,7 @@ struct HttpEvent : Event
 struct DispatchEvent : Event
 {
   DispatchEvent(
-      std::unique_ptr<lambda::CallableOnce<void(ProcessBase*)>> _f,
+      lambda::CallableOnce<void(ProcessBase*)>&& _f,
       const Option<const std::type_info*>& _functionType)
     : f(std::move(_f)),
       functionType(_functionType)
@@ -199,8 +199,10 @@ struct DispatchEvent : Event
     consumer->consume(std::move(*this));
   }
 
-  // Function to get invoked as a result of this dispatch event.
-  std::unique_ptr<lambda::CallableOnce<void(ProcessBase*)>> f;
+  // Function to get invoked as a result of this dispatch event. It is
+  // held by value so that, for most dispatches, the function is stored
+  // within the event rather than in an allocation of its own.
+  lambda::CallableOnce<void(ProcessBase*)> f;
 
   Option<const std::type_info*> functionType;
 };
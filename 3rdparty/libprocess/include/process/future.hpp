@@ -66,6 +66,51 @@ struct wrap;
 template <typename T>
 struct unwrap;
 
+
+// A list of callbacks which stores the first callback inline. Most
+// futures only get a single callback of each kind (if any), e.g., the
+// `onAny` of a `then`, so this saves allocating a `std::vector` for it.
+template <typename C>
+class Callbacks
+{
+public:
+  template <typename... Args>
+  void emplace_back(Args&&... args)
+  {
+    if (first.isNone()) {
+      first = C(std::forward<Args>(args)...);
+    } else {
+      rest.emplace_back(std::forward<Args>(args)...);
+    }
+  }
+
+  size_t size() const
+  {
+    return first.isSome() ? rest.size() + 1 : 0;
+  }
+
+  C& operator[](size_t i)
+  {
+    return i == 0 ? first.get() : rest[i - 1];
+  }
+
+  void swap(Callbacks<C>& that)
+  {
+    std::swap(first, that.first);
+    rest.swap(that.rest);
+  }
+
+  void clear()
+  {
+    first = None();
+    rest.clear();
+  }
+
+private:
+  Option<C> first;
+  std::vector<C> rest;
+};
+
 } // namespace internal {
 
 
@@ -547,12 +592,12 @@ private:
     //   3. Error, the state is FAILED; 'error()' stores the message.
     Result<T> result;
 
-    std::vector<AbandonedCallback> onAbandonedCallbacks;
-    std::vector<DiscardCallback> onDiscardCallbacks;
-    std::vector<ReadyCallback> onReadyCallbacks;
-    std::vector<FailedCallback> onFailedCallbacks;
-    std::vector<DiscardedCallback> onDiscardedCallbacks;
-    std::vector<AnyCallback> onAnyCallbacks;
+    internal::Callbacks<AbandonedCallback> onAbandonedCallbacks;
+    internal::Callbacks<DiscardCallback> onDiscardCallbacks;
+    internal::Callbacks<ReadyCallback> onReadyCallbacks;
+    internal::Callbacks<FailedCallback> onFailedCallbacks;
+    internal::Callbacks<DiscardedCallback> onDiscardedCallbacks;
+    internal::Callbacks<AnyCallback> onAnyCallbacks;
   };
 
   // Abandons this future. Returns false if the future is already
@@ -608,6 +653,9 @@ private:
   // failed, or discarded, in which case it returns false.
   bool fail(const std::string& _message);
 
+  // Used by `WeakFuture::get()`.
+  explicit Future(std::shared_ptr<Data>&& _data) : data(std::move(_data)) {}
+
   std::shared_ptr<Data> data;
 };
 
@@ -618,7 +666,7 @@ namespace internal {
 //
 // TODO(*): Invoke callbacks in another execution context.
 template <typename C, typename... Arguments>
-void run(std::vector<C>&& callbacks, Arguments&&... arguments)
+void run(Callbacks<C>&& callbacks, Arguments&&... arguments)
 {
   for (size_t i = 0; i < callbacks.size(); ++i) {
     std::move(callbacks[i])(std::forward<Arguments>(arguments)...);
@@ -653,11 +701,10 @@ WeakFuture<T>::WeakFuture(const Future<T>& future)
 template <typename T>
 Option<Future<T>> WeakFuture<T>::get() const
 {
-  Future<T> future;
-  future.data = data.lock();
+  std::shared_ptr<typename Future<T>::Data> data_ = data.lock();
 
-  if (future.data) {
-    return future;
+  if (data_) {
+    return Future<T>(std::move(data_));
   }
 
   return None();
@@ -1059,7 +1106,7 @@ void Future<T>::Data::clearAllCallbacks()
 
 template <typename T>
 Future<T>::Future()
-  : data(new Data())
+  : data(std::make_shared<Data>())
 {
   data->abandoned = true;
 }
@@ -1067,7 +1114,7 @@ Future<T>::Future()
 
 template <typename T>
 Future<T>::Future(const T& _t)
-  : data(new Data())
+  : data(std::make_shared<Data>())
 {
   set(_t);
 }
@@ -1075,7 +1122,7 @@ Future<T>::Future(const T& _t)
 
 template <typename T>
 Future<T>::Future(T&& _t)
-  : data(new Data())
+  : data(std::make_shared<Data>())
 {
   set(std::move(_t));
 }
@@ -1084,7 +1131,7 @@ Future<T>::Future(T&& _t)
 template <typename T>
 template <typename U>
 Future<T>::Future(const U& u)
-  : data(new Data())
+  : data(std::make_shared<Data>())
 {
   set(u);
 }
@@ -1092,7 +1139,7 @@ Future<T>::Future(const U& u)
 
 template <typename T>
 Future<T>::Future(const Failure& failure)
-  : data(new Data())
+  : data(std::make_shared<Data>())
 {
   fail(failure.message);
 }
@@ -1100,7 +1147,7 @@ Future<T>::Future(const Failure& failure)
 
 template <typename T>
 Future<T>::Future(const ErrnoFailure& failure)
-  : data(new Data())
+  : data(std::make_shared<Data>())
 {
   fail(failure.message);
 }
@@ -1109,7 +1156,7 @@ Future<T>::Future(const ErrnoFailure& failure)
 template <typename T>
 template <typename E>
 Future<T>::Future(const Try<T, E>& t)
-  : data(new Data())
+  : data(std::make_shared<Data>())
 {
   if (t.isSome()){
     set(t.get());
@@ -1123,7 +1170,7 @@ Future<T>::Future(const Try<T, E>& t)
 template <typename T>
 template <typename E>
 Future<T>::Future(const Try<Future<T>, E>& t)
-  : data(t.isSome() ? t->data : std::shared_ptr<Data>(new Data()))
+  : data(t.isSome() ? t->data : std::make_shared<Data>())
 {
   if (!t.isSome()) {
     // TODO(chhsiao): Consider preserving the error type. See MESOS-8925.
@@ -1158,7 +1205,7 @@ bool Future<T>::discard()
 {
   bool result = false;
 
-  std::vector<DiscardCallback> callbacks;
+  internal::Callbacks<DiscardCallback> callbacks;
   synchronized (data->lock) {
     if (!data->discard && data->state == PENDING) {
       result = data->discard = true;
@@ -1183,7 +1230,7 @@ bool Future<T>::abandon(bool propagating)
 {
   bool result = false;
 
-  std::vector<AbandonedCallback> callbacks;
+  internal::Callbacks<AbandonedCallback> callbacks;
   synchronized (data->lock) {
     if (!data->abandoned &&
         data->state == PENDING &&
@@ -1278,7 +1325,8 @@ bool Future<T>::await(const Duration& duration) const
   synchronized (data->lock) {
     if (data->state == PENDING) {
       pending = true;
-      data->onAnyCallbacks.push_back(lambda::bind(&internal::awaited, latch));
+      data->onAnyCallbacks.emplace_back(
+          lambda::bind(&internal::awaited, latch));
     }
   }
 
@@ -62,6 +62,14 @@ enum class Scheme {
 };
 
 
+// The versions of the protocol a `Connection` can speak. HTTP/2 needs
+// libprocess to be built with nghttp2 (see `--enable-http2`).
+enum class Protocol {
+  HTTP_1_1,
+  HTTP_2,
+};
+
+
 namespace authentication {
 
 class Authenticator;
@@ -332,6 +340,14 @@ public:
     // interested. Returns false if the read-end was already closed.
     bool close();
 
+    // Returns true once the writer has waited for the pipe to be
+    // drained (see `Writer::drained()`). Such a writer only writes
+    // more data once the reader is ready for it, hence the reader
+    // should only read more data once it is able to handle it, e.g.,
+    // once the previous data has been sent out. Otherwise readers
+    // should keep reading, so that the data is not delayed.
+    bool paced() const;
+
     // Comparison operators useful for checking connection equality.
     bool operator==(const Reader& other) const { return data == other.data; }
     bool operator!=(const Reader& other) const { return !(*this == other); }
@@ -374,6 +390,15 @@ public:
     // was unable to continue reading!
     Future<Nothing> readerClosed() const;
 
+    // Returns Nothing once all of the data written so far has been
+    // read and the reader is waiting for more, or once the read-end
+    // of the pipe is closed. This allows writers to avoid buffering
+    // an unbounded amount of data in the pipe when the reader is
+    // slower than the writer. The returned future is discarded if
+    // the write-end of the pipe is closed or failed in the meantime.
+    // Note that this makes the pipe paced, see `Reader::paced()`.
+    Future<Nothing> drained() const;
+
     // Comparison operators useful for checking connection equality.
     bool operator==(const Writer& other) const { return data == other.data; }
     bool operator!=(const Writer& other) const { return !(*this == other); }
@@ -406,7 +431,7 @@ private:
   struct Data
   {
     Data()
-      : readEnd(Reader::OPEN), writeEnd(Writer::OPEN) {}
+      : readEnd(Reader::OPEN), writeEnd(Writer::OPEN), paced(false) {}
 
     // Rather than use a process to serialize access to the pipe's
     // internal data we use a 'std::atomic_flag'.
@@ -425,6 +450,12 @@ private:
     // Signals when the read-end is closed before the write-end.
     Promise<Nothing> readerClosure;
 
+    // Represents writers waiting for the pipe to be drained.
+    std::queue<Owned<Promise<Nothing>>> drains;
+
+    // Whether the writer has waited for the pipe to be drained.
+    bool paced;
+
     // Failure reason when the 'writeEnd' is FAILED.
     Option<Failure> failure;
   };
@@ -586,6 +617,16 @@ struct Request
    */
   bool acceptsEncoding(const std::string& encoding) const;
 
+  /**
+   * Returns the q value of the encoding in the "Accept-Encoding"
+   * header, i.e., how much it is preferred, 0 meaning that it is not
+   * acceptable (see `acceptsEncoding()`). An encoding which is not
+   * listed gets the q value of "*", unless `wildcard` is false.
+   */
+  double encodingQuality(
+      const std::string& encoding,
+      bool wildcard = true) const;
+
   /**
    * Returns whether the media type in the "Accept" header  is considered
    * acceptable in the response. See RFC 2616, section 14.1 for the details.
@@ -643,18 +684,20 @@ struct Response
   // using 'type' below.
   //
   // BODY: Uses 'body' as the body of the response. These may be
-  // encoded using gzip for efficiency, if 'Content-Encoding' is not
-  // already specified.
+  // encoded using gzip (or zstd) for efficiency, if 'Content-Encoding'
+  // is not already specified.
   //
   // PATH: Attempts to perform a 'sendfile' operation on the file
   // found at 'path'.
   //
   // PIPE: Splices data from the Pipe 'reader' using a "chunked"
-  // 'Transfer-Encoding'. The writer uses a Pipe::Writer to
-  // perform writes and to detect a closed read-end of the Pipe
-  // (i.e. nobody is listening any longer). Once the writer is
-  // finished, it will close its end of the pipe to signal end
-  // of file to the Reader.
+  // 'Transfer-Encoding'. Like a 'body', the data may be encoded
+  // using gzip (or zstd), in which case every chunk read from the
+  // Pipe is flushed to the client on its own. The writer uses a
+  // Pipe::Writer to perform writes and to detect a closed read-end
+  // of the Pipe (i.e. nobody is listening any longer). Once the
+  // writer is finished, it will close its end of the pipe to signal
+  // end of file to the Reader.
   //
   // In all cases (BODY, PATH, PIPE), you are expected to properly
   // specify the 'Content-Type' header, but the 'Content-Length' and
@@ -960,6 +1003,11 @@ std::string encode(const hashmap<std::string, std::string>& query);
  * Represents a connection to an HTTP server. Pipelining will be
  * used when there are multiple requests in-flight.
  *
+ * When connected with `Protocol::HTTP_2`, each request is sent on
+ * its own stream instead, and the responses complete in whatever
+ * order the server sends them, so a streamed response does not hold
+ * back the others. The `keepAlive` of the requests is then ignored.
+ *
  * TODO(bmahler): This does not prevent pipelining with HTTP/1.0.
  */
 class Connection
@@ -996,12 +1044,14 @@ private:
   Connection(
       const network::Socket& s,
       const network::Address& _localAddress,
-      const network::Address& _peerAddress);
+      const network::Address& _peerAddress,
+      Protocol protocol);
 
   friend Future<Connection> connect(
       const network::Address& address,
       Scheme scheme,
-      const Option<std::string>& peer_hostname);
+      const Option<std::string>& peer_hostname,
+      Protocol protocol);
   friend Future<Connection> connect(const URL&);
 
   // Forward declaration.
@@ -1011,6 +1061,13 @@ private:
 };
 
 
+Future<Connection> connect(
+    const network::Address& address,
+    Scheme scheme,
+    const Option<std::string>& peer_hostname,
+    Protocol protocol);
+
+
 Future<Connection> connect(
     const network::Address& address,
     Scheme scheme,
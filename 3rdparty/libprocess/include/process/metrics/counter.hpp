@@ -38,11 +38,18 @@ public:
 
   ~Counter() override {}
 
+  Type type() const override { return Type::COUNTER; }
+
   Future<double> value() const override
   {
     return static_cast<double>(data->value.load());
   }
 
+  Option<double> peek() const override
+  {
+    return static_cast<double>(data->value.load());
+  }
+
   void reset()
   {
     data->value.store(0);
@@ -0,0 +1,188 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License
+
+#ifndef __PROCESS_METRICS_HISTOGRAM_HPP__
+#define __PROCESS_METRICS_HISTOGRAM_HPP__
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <glog/logging.h>
+
+#include <process/future.hpp>
+
+#include <process/metrics/metric.hpp>
+
+#include <stout/none.hpp>
+#include <stout/option.hpp>
+
+namespace process {
+namespace metrics {
+namespace internal {
+
+// The buckets of a `Histogram` (or a `Timer`). Recording a value only
+// takes a couple of relaxed atomic operations, so a value can be
+// recorded from any thread without a lock.
+class Buckets
+{
+public:
+  explicit Buckets(const std::vector<double>& _bounds)
+    : bounds(_bounds),
+      counts(new std::atomic<uint64_t>[_bounds.size() + 1]),
+      sum(0.0)
+  {
+    CHECK(std::is_sorted(bounds.begin(), bounds.end()));
+
+    for (size_t i = 0; i <= bounds.size(); ++i) {
+      counts[i].store(0);
+    }
+  }
+
+  void record(double value)
+  {
+    // The bounds are inclusive, hence the first bound which is not
+    // less than 'value' is the one of its bucket.
+    const size_t index =
+      std::lower_bound(bounds.begin(), bounds.end(), value) - bounds.begin();
+
+    counts[index].fetch_add(1, std::memory_order_relaxed);
+
+    double current = sum.load(std::memory_order_relaxed);
+    while (!sum.compare_exchange_weak(
+               current, current + value, std::memory_order_relaxed)) {}
+  }
+
+  uint64_t count() const
+  {
+    uint64_t count = 0;
+    for (size_t i = 0; i <= bounds.size(); ++i) {
+      count += counts[i].load(std::memory_order_relaxed);
+    }
+    return count;
+  }
+
+  Distribution distribution() const
+  {
+    Distribution distribution;
+    distribution.bounds = bounds;
+    distribution.counts.reserve(bounds.size() + 1);
+
+    // NOTE: We derive the total count from the buckets rather than
+    // keeping a separate counter, so that the two always agree, even
+    // if values get recorded while we are reading the buckets.
+    for (size_t i = 0; i <= bounds.size(); ++i) {
+      distribution.counts.push_back(counts[i].load(std::memory_order_relaxed));
+      distribution.count += distribution.counts.back();
+    }
+
+    distribution.sum = sum.load(std::memory_order_relaxed);
+
+    return distribution;
+  }
+
+private:
+  const std::vector<double> bounds;
+  std::unique_ptr<std::atomic<uint64_t>[]> counts;
+  std::atomic<double> sum;
+};
+
+} // namespace internal {
+
+
+// A Metric that counts the observed values (e.g., request sizes) in a
+// fixed set of buckets. Unlike a windowed metric (see `Metric`), it
+// keeps no history, so it costs the same amount of memory no matter
+// how many values are recorded, and it does not lose any observation
+// between two collections. On the other hand, percentiles can only be
+// estimated within the bounds of the buckets.
+//
+// The JSON snapshot only contains the number of observations; the
+// buckets are exposed through the Prometheus endpoint.
+class Histogram : public Metric
+{
+public:
+  // Returns 'count' bounds, starting at 'start', each being 'factor'
+  // times the previous one.
+  static std::vector<double> exponential(
+      double start,
+      double factor,
+      size_t count)
+  {
+    std::vector<double> bounds;
+    bounds.reserve(count);
+
+    double bound = start;
+    for (size_t i = 0; i < count; ++i) {
+      bounds.push_back(bound);
+      bound *= factor;
+    }
+
+    return bounds;
+  }
+
+  // Returns 'count' bounds, starting at 'start', each being 'width'
+  // more than the previous one.
+  static std::vector<double> linear(double start, double width, size_t count)
+  {
+    std::vector<double> bounds;
+    bounds.reserve(count);
+
+    for (size_t i = 0; i < count; ++i) {
+      bounds.push_back(start + width * i);
+    }
+
+    return bounds;
+  }
+
+  // 'bounds' are the inclusive upper bounds of the buckets, in
+  // increasing order. A last bucket without an upper bound catches
+  // the values which are greater than all of them.
+  Histogram(const std::string& name, const std::vector<double>& bounds)
+    : Metric(name, None()),
+      data(new internal::Buckets(bounds)) {}
+
+  ~Histogram() override {}
+
+  Type type() const override { return Type::HISTOGRAM; }
+
+  Future<double> value() const override
+  {
+    return static_cast<double>(data->count());
+  }
+
+  Option<double> peek() const override
+  {
+    return static_cast<double>(data->count());
+  }
+
+  Option<Distribution> distribution() const override
+  {
+    return data->distribution();
+  }
+
+  void record(double value)
+  {
+    data->record(value);
+  }
+
+private:
+  std::shared_ptr<internal::Buckets> data;
+};
+
+} // namespace metrics {
+} // namespace process {
+
+#endif // __PROCESS_METRICS_HISTOGRAM_HPP__
@@ -14,8 +14,10 @@
 #define __PROCESS_METRICS_METRIC_HPP__
 
 #include <atomic>
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <process/future.hpp>
 #include <process/owned.hpp>
@@ -29,13 +31,49 @@
 namespace process {
 namespace metrics {
 
+// A copy of the buckets of a bucketed metric (see `Histogram`).
+struct Distribution
+{
+  // The inclusive upper bounds of the buckets, in increasing order.
+  // The last bucket, which has no upper bound, is implicit.
+  std::vector<double> bounds;
+
+  // The number of observations in each bucket, including the implicit
+  // last one, i.e., there is one more entry than in 'bounds'.
+  std::vector<uint64_t> counts;
+
+  uint64_t count = 0;
+  double sum = 0.0;
+};
+
+
 // The base class for Metrics.
 class Metric {
 public:
+  // How the value of a metric evolves, used by the exposition formats
+  // which need to know, e.g., the Prometheus text format.
+  enum class Type
+  {
+    GAUGE,     // Can go up and down.
+    COUNTER,   // Only goes up, unless reset.
+    HISTOGRAM, // Has a `distribution()`.
+  };
+
   virtual ~Metric() {}
 
+  virtual Type type() const { return Type::GAUGE; }
+
   virtual Future<double> value() const = 0;
 
+  // Returns the value of this metric if it can be read right away,
+  // e.g., because it is kept in an atomic, or None if it can only be
+  // obtained asynchronously through `value()`. Snapshots use this to
+  // avoid creating (and waiting on) a future for every such metric.
+  virtual Option<double> peek() const { return None(); }
+
+  // Returns the distribution of the observed values of a `HISTOGRAM`.
+  virtual Option<Distribution> distribution() const { return None(); }
+
   const std::string& name() const
   {
     return data->name;
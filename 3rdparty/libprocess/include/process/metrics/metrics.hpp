@@ -27,6 +27,7 @@
 
 #include <stout/nothing.hpp>
 #include <stout/option.hpp>
+#include <stout/try.hpp>
 
 namespace process {
 namespace metrics {
@@ -50,6 +51,16 @@ protected:
 private:
   static std::string help();
 
+  static std::string prometheusHelp();
+
+  // Parses the optional 'timeout' query parameter of the endpoints.
+  static Try<Option<Duration>> parseTimeout(const http::Request& request);
+
+  // Waits until all of 'futures' are completed or 'timeout' elapses.
+  static Future<Nothing> awaitAll(
+      const std::vector<Future<double>>& futures,
+      const Option<Duration>& timeout);
+
   MetricsProcess(
       const Option<Owned<RateLimiter>>& _limiter,
       const Option<std::string>& _authenticationRealm)
@@ -70,10 +81,43 @@ private:
   // capture with C++14.
   Future<std::map<std::string, double>> __snapshot(
       const Option<Duration>& timeout,
+      std::map<std::string, double>&& snapshot,
       std::vector<std::string>&& keys,
       std::vector<Future<double>>&& metrics,
       std::vector<Option<Statistics<double>>>&& statistics);
 
+  // A metric as rendered by the Prometheus endpoint.
+  struct Sample
+  {
+    std::string name;
+    Metric::Type type;
+    Option<double> value;
+    Option<Distribution> distribution;
+  };
+
+  Future<http::Response> _prometheus(
+      const http::Request& request,
+      const Option<http::authentication::Principal>&);
+
+  Future<http::Response> prometheus(const Option<Duration>& timeout);
+
+  // Fills in the values of the 'pending' samples from 'futures' and
+  // renders all of the 'samples' in the Prometheus text format.
+  //
+  // NOTE: This is not static for the same reason as `__snapshot()`.
+  Future<http::Response> __prometheus(
+      std::vector<Sample>&& samples,
+      std::vector<size_t>&& pending,
+      std::vector<Future<double>>&& futures);
+
+  // Adds the value (if any) and the statistics (if any) of the metric
+  // 'key' to 'snapshot'.
+  static void insert(
+      std::map<std::string, double>& snapshot,
+      const std::string& key,
+      const Option<double>& value,
+      const Option<Statistics<double>>& statistics);
+
   // The Owned<Metric> is an explicit copy of the Metric passed to 'add'.
   std::map<std::string, Owned<Metric>> metrics;
 
@@ -13,12 +13,20 @@
 #ifndef __PROCESS_METRICS_PULL_GAUGE_HPP__
 #define __PROCESS_METRICS_PULL_GAUGE_HPP__
 
+#include <atomic>
 #include <functional>
 #include <memory>
 #include <string>
 
+#include <process/clock.hpp>
+#include <process/future.hpp>
+
 #include <process/metrics/metric.hpp>
 
+#include <stout/duration.hpp>
+#include <stout/none.hpp>
+#include <stout/option.hpp>
+
 namespace process {
 namespace metrics {
 
@@ -53,21 +61,93 @@ public:
   // The user of `Gauge` must ensure that `f` is safe to execute up until
   // the removal of the `Gauge` (via `process::metrics::remove(...)`) is
   // complete.
-  PullGauge(const std::string& name, const std::function<Future<double>()>& f)
-    : Metric(name, None()), data(new Data(f)) {}
+  //
+  // If 'cache' is set, snapshots return the last value obtained from
+  // 'f' rather than waiting for 'f' (which typically dispatches to the
+  // owning process, and hence waits for that process to get to it).
+  // Once the cached value is older than 'cache', snapshots trigger a
+  // call to 'f' in the background which refreshes it whenever the
+  // owner gets around to it. Only the very first snapshot waits on 'f'.
+  PullGauge(
+      const std::string& name,
+      const std::function<Future<double>()>& f,
+      const Option<Duration>& cache = None())
+    : Metric(name, None()), data(new Data(f, cache)) {}
 
   ~PullGauge() override {}
 
-  Future<double> value() const override { return data->f(); }
+  Future<double> value() const override
+  {
+    if (data->cache.isNone()) {
+      return data->f();
+    }
+
+    return refresh(data);
+  }
+
+  Option<double> peek() const override
+  {
+    if (data->cache.isNone() || !data->cached.load()) {
+      return None();
+    }
+
+    // NOTE: We read the value before triggering a refresh, otherwise
+    // the refresh might complete on another thread in the meantime.
+    const double value = data->value.load();
+
+    // Refresh the value in the background if it is stale, unless a
+    // refresh is already in flight.
+    const int64_t now = Clock::now().duration().ns();
+
+    if (now - data->refreshed.load() >= data->cache->ns() &&
+        !data->refreshing.exchange(true)) {
+      refresh(data);
+    }
+
+    return value;
+  }
 
 private:
   struct Data
   {
-    explicit Data(const std::function<Future<double>()>& _f) : f(_f) {}
+    Data(
+        const std::function<Future<double>()>& _f,
+        const Option<Duration>& _cache)
+      : f(_f),
+        cache(_cache),
+        value(0),
+        cached(false),
+        refreshed(0),
+        refreshing(false) {}
 
     const std::function<Future<double>()> f;
+    const Option<Duration> cache;
+
+    // The last value obtained from 'f' and when (in nanoseconds since
+    // the epoch, as per `Clock::now()`) it was obtained.
+    std::atomic<double> value;
+    std::atomic<bool> cached;
+    std::atomic<int64_t> refreshed;
+
+    // Whether a refresh triggered by `peek()` is in flight.
+    std::atomic<bool> refreshing;
   };
 
+  // NOTE: This is static and takes a copy of 'data' so that the
+  // callbacks remain valid even if the gauge is removed while 'f'
+  // is still pending.
+  static Future<double> refresh(const std::shared_ptr<Data>& data)
+  {
+    return data->f()
+      .onReady([data](double value) {
+        data->value.store(value);
+        data->refreshed.store(Clock::now().duration().ns());
+        data->cached.store(true);
+      })
+      .onAny([data]() { data->refreshing.store(false); })
+      .onAbandoned([data]() { data->refreshing.store(false); });
+  }
+
   std::shared_ptr<Data> data;
 };
 
@@ -58,6 +58,11 @@ public:
     return static_cast<double>(data->value.load());
   }
 
+  Option<double> peek() const override
+  {
+    return static_cast<double>(data->value.load());
+  }
+
   PushGauge& operator=(double v)
   {
     data->value.store(v);
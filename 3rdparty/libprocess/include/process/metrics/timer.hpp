@@ -20,6 +20,7 @@
 #include <process/clock.hpp>
 #include <process/future.hpp>
 
+#include <process/metrics/histogram.hpp>
 #include <process/metrics/metric.hpp>
 
 #include <stout/duration.hpp>
@@ -42,6 +43,10 @@ public:
     : Metric(name + "_" + T::units(), window),
       data(new Data()) {}
 
+  // The durations are also counted in buckets, which are exposed as a
+  // histogram by the Prometheus endpoint.
+  Type type() const override { return Type::HISTOGRAM; }
+
   Future<double> value() const override
   {
     Future<double> value;
@@ -57,6 +62,22 @@ public:
     return value;
   }
 
+  Option<double> peek() const override
+  {
+    Option<double> value;
+
+    synchronized (data->lock) {
+      value = data->lastValue;
+    }
+
+    return value;
+  }
+
+  Option<Distribution> distribution() const override
+  {
+    return data->buckets.distribution();
+  }
+
   // Start the Timer.
   void start()
   {
@@ -82,6 +103,8 @@ public:
       value = data->lastValue.get();
     }
 
+    data->buckets.record(value);
+
     push(value);
 
     return t;
@@ -101,10 +124,14 @@ public:
 
 private:
   struct Data {
-    Data() = default;
+    // The buckets range from 100us to about an hour, doubling each time.
+    Data()
+      : buckets(Histogram::exponential(T(Microseconds(100)).value(), 2, 26)) {}
+
     std::atomic_flag lock = ATOMIC_FLAG_INIT;
     Time start;
     Option<double> lastValue;
+    internal::Buckets buckets;
   };
 
   static void _time(Time start, Timer that)
@@ -118,6 +145,8 @@ private:
       value = that.data->lastValue.get();
     }
 
+    that.data->buckets.record(value);
+
     that.push(value);
   }
 
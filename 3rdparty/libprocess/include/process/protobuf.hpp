@@ -282,6 +282,10 @@ private:
     }
   }
 
+  // NOTE: Unlike the other handlers, the message is not allocated on an
+  // arena here: the method takes ownership of the message and usually
+  // moves it (or parts of it) into longer lived state, and moving a
+  // message off an arena results in a deep copy.
   template <typename M>
   static void handlerMutM(
       T* t,
@@ -54,6 +54,8 @@ public:
   bool enable_tls_v1_1;
   bool enable_tls_v1_2;
   bool enable_tls_v1_3;
+  bool enable_ktls;
+  size_t session_cache_size;
 };
 
 
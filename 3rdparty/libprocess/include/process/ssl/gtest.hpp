@@ -140,6 +140,8 @@ protected:
     os::unsetenv("LIBPROCESS_SSL_ENABLE_TLS_V1_1");
     os::unsetenv("LIBPROCESS_SSL_ENABLE_TLS_V1_2");
     os::unsetenv("LIBPROCESS_SSL_ENABLE_TLS_V1_3");
+    os::unsetenv("LIBPROCESS_SSL_ENABLE_KTLS");
+    os::unsetenv("LIBPROCESS_SSL_SESSION_CACHE_SIZE");
 
     // Copy the given map into the clean slate.
     foreachpair (
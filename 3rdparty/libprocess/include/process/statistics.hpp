@@ -104,41 +104,51 @@ private:
       return None();
     }
 
-    std::sort(values.begin(), values.end());
-
     Statistics statistics;
 
     statistics.count = values.size();
 
-    statistics.min = values.front();
-    statistics.max = values.back();
+    auto minmax = std::minmax_element(values.begin(), values.end());
+
+    statistics.min = *minmax.first;
+    statistics.max = *minmax.second;
+
+    // Rather than sorting the values, we only select the ones which
+    // the percentiles are interpolated from, which keeps computing
+    // the statistics linear in the number of values. The percentiles
+    // must be computed in increasing order (see `select`).
+    size_t selected = 0;
 
-    statistics.p25 = percentile(values, 0.25);
-    statistics.p50 = percentile(values, 0.5);
-    statistics.p75 = percentile(values, 0.75);
-    statistics.p90 = percentile(values, 0.90);
-    statistics.p95 = percentile(values, 0.95);
-    statistics.p99 = percentile(values, 0.99);
-    statistics.p999 = percentile(values, 0.999);
-    statistics.p9999 = percentile(values, 0.9999);
+    statistics.p25 = percentile(values, selected, 0.25);
+    statistics.p50 = percentile(values, selected, 0.5);
+    statistics.p75 = percentile(values, selected, 0.75);
+    statistics.p90 = percentile(values, selected, 0.90);
+    statistics.p95 = percentile(values, selected, 0.95);
+    statistics.p99 = percentile(values, selected, 0.99);
+    statistics.p999 = percentile(values, selected, 0.999);
+    statistics.p9999 = percentile(values, selected, 0.9999);
 
     return statistics;
   }
 
-  // Returns the requested percentile from the sorted values.
+  // Returns the requested percentile of the values, selecting the
+  // values it is interpolated from (see `select`).
   // Note that we need at least two values to compute percentiles!
   //
   // TODO(dhamon): Use a 'Percentage' abstraction.
-  static T percentile(const std::vector<T>& values, double percentile)
+  static T percentile(
+      std::vector<T>& values,
+      size_t& selected,
+      double percentile)
   {
     CHECK_GE(values.size(), 2u);
 
     if (percentile <= 0.0) {
-      return values.front();
+      return select(values, selected, 0);
     }
 
     if (percentile >= 1.0) {
-      return values.back();
+      return select(values, selected, values.size() - 1);
     }
 
     // Use linear interpolation.
@@ -149,7 +159,40 @@ private:
     CHECK_GE(index, 0u);
     CHECK_LT(index, values.size() - 1);
 
-    return values[index] + (values[index + 1] - values[index]) * delta;
+    const T lower = select(values, selected, index);
+    const T upper = select(values, selected, index + 1);
+
+    return lower + (upper - lower) * delta;
+  }
+
+  // Returns the value which would be at the given position if the
+  // values were sorted, and moves it there. The values before
+  // `selected` are not greater than the values after it, and the ones
+  // which were selected before are in place. Hence positions can only
+  // be selected in increasing order, but may be selected repeatedly.
+  static const T& select(
+      std::vector<T>& values,
+      size_t& selected,
+      size_t position)
+  {
+    CHECK_LT(position, values.size());
+
+    if (position == selected) {
+      // This is common when interpolating, and cheaper than
+      // partitioning the values.
+      std::iter_swap(
+          values.begin() + position,
+          std::min_element(values.begin() + position, values.end()));
+    } else if (position > selected) {
+      std::nth_element(
+          values.begin() + selected,
+          values.begin() + position,
+          values.end());
+    }
+
+    selected = std::max(selected, position + 1);
+
+    return values[position];
   }
 };
 
@@ -13,8 +13,10 @@
 #ifndef __PROCESS_TIMESERIES_HPP__
 #define __PROCESS_TIMESERIES_HPP__
 
-#include <algorithm> // For max.
-#include <map>
+#include <glog/logging.h>
+
+#include <algorithm> // For max and rotate.
+#include <utility>
 #include <vector>
 
 #include <process/clock.hpp>
@@ -40,14 +42,12 @@ constexpr size_t TIME_SERIES_CAPACITY = 1000;
 // total number of data points to keep around, which informs how
 // often to delete older data points, while still keeping a window
 // worth of data.
-// TODO(bmahler): Investigate using Google's btree implementation.
-// This provides better insertion and lookup performance for large
-// containers. This _should_ also provide significant memory
-// savings. These are true because we have the following properties:
-//   1. Our insertion order will mostly be in sorted order.
-//   2. Our keys (Seconds) have efficient comparison operators.
-// See: http://code.google.com/p/cpp-btree/
-//      http://code.google.com/p/cpp-btree/wiki/UsageInstructions
+//
+// The values are stored in time order in a contiguous ring buffer,
+// so that the common case of appending a value neither allocates nor
+// rebalances a tree. Truncation only moves the beginning of the ring,
+// and sparsification leaves a gap at the next deletion candidate
+// which travels along with it (see `sparsify`).
 template <typename T>
 struct TimeSeries
 {
@@ -55,7 +55,10 @@ struct TimeSeries
              size_t _capacity = TIME_SERIES_CAPACITY)
     : window(_window),
       // The truncation technique requires at least 3 elements.
-      capacity(std::max((size_t) 3, _capacity)) {}
+      capacity(std::max((size_t) 3, _capacity)),
+      head(0),
+      count(0),
+      gap(0) {}
 
   struct Value
   {
@@ -68,16 +71,27 @@ struct TimeSeries
 
   void set(const T& value, const Time& time = Clock::now())
   {
-    // If we're not inserting at the end of the time series, then
-    // we have to reset the sparsification index. Given that
-    // out-of-order insertion is a rare use-case. This is a simple way
-    // to keep insertions O(log(n)). No need to figure out how to
-    // adjust the truncation index.
-    if (!values.empty() && time < values.rbegin()->first) {
+    if (count == 0 || time > at(count - 1).time) {
+      append(Value(time, value));
+    } else if (time == at(count - 1).time) {
+      at(count - 1).data = value;
+    } else {
+      // If we're not inserting at the end of the time series, then
+      // we have to reset the sparsification index. Given that
+      // out-of-order insertion is a rare use-case, this is a simple
+      // way to avoid figuring out how to adjust the index.
+      close();
       index = None();
+
+      const size_t position = lower_bound(time);
+
+      if (at(position).time == time) {
+        at(position).data = value;
+      } else {
+        insert(position, Value(time, value));
+      }
     }
 
-    values[time] = value;
     truncate();
     sparsify();
   }
@@ -92,16 +106,14 @@ struct TimeSeries
       return std::vector<Value>();
     }
 
-    typename std::map<Time, T>::const_iterator lower = values.lower_bound(
-        start.isSome() ? start.get() : Time::epoch());
-
-    typename std::map<Time, T>::const_iterator upper = values.upper_bound(
-        stop.isSome() ? stop.get() : Time::max());
+    size_t lower = start.isSome() ? lower_bound(start.get()) : 0;
+    size_t upper = stop.isSome() ? upper_bound(stop.get()) : count;
 
     std::vector<Value> values;
-    while (lower != upper) {
-      values.push_back(Value(lower->first, lower->second));
-      ++lower;
+    values.reserve(upper > lower ? upper - lower : 0);
+
+    for (; lower < upper; ++lower) {
+      values.push_back(at(lower));
     }
     return values;
   }
@@ -112,10 +124,10 @@ struct TimeSeries
       return None();
     }
 
-    return Value(values.rbegin()->first, values.rbegin()->second);
+    return at(count - 1);
   }
 
-  bool empty() const { return values.empty(); }
+  bool empty() const { return count == 0; }
 
   // Removes values outside the time window. This will ensure at
   // least one value remains. Note that this is called automatically
@@ -124,49 +136,53 @@ struct TimeSeries
   void truncate()
   {
     Time expired = Clock::now() - window;
-    typename std::map<Time, T>::iterator upper_bound =
-      values.upper_bound(expired);
+    size_t upper = upper_bound(expired);
 
     // Ensure at least 1 value remains.
-    if (values.size() <= 1 || upper_bound == values.end()) {
+    if (count <= 1 || upper == count) {
       return;
     }
 
+    // The values before `upper` are removed by moving the beginning
+    // of the ring past them, i.e., past the gap too if there is one
+    // before `upper`.
+    head = slot(offset(upper));
+    count -= upper;
+
     // When truncating and there exists a next value considered
     // for sparsification, there are two cases to consider for
     // updating the index:
     //
-    // Case 1: upper_bound < next
+    // Case 1: upper < index
     //   ----------------------------------------------------------
-    //       upper_bound index, next
+    //             upper index
     //                 v v
     //   Before: 0 1 2 3 4 5 6 7 ...
     //   ----------------------------------------------------------
-    //                 next  index    After truncating, index is
-    //                   v     v      must be adjusted:
+    //                   index        After truncating, index is
+    //                   v            must be adjusted:
     //   Truncate:     3 4 5 6 7 ...  index -= # elements removed
     //   ----------------------------------------------------------
-    //              index, next
+    //                 index
     //                   v
     //   After:        3 4 5 6 7 ...
     //   ----------------------------------------------------------
     //
-    // Case 2: upper_bound >= next
+    // Case 2: upper >= index
     //   ----------------------------------------------------------
-    //                   upper_bound, index, next
+    //                   upper, index
     //                   v
     //   Before: 0 1 2 3 4 5 6 7 ...
     //   ----------------------------------------------------------
     //                               After truncating, we must
     //   After:          4 5 6 7 ... reset index to None().
     //   ----------------------------------------------------------
-    if (index.isSome() && upper_bound->first < next->first) {
-      size_t size = values.size();
-      values.erase(values.begin(), upper_bound);
-      index = index.get() - (size - values.size());
+    if (index.isSome() && upper < index.get()) {
+      index = index.get() - upper;
     } else {
+      // The gap (if any) was before `upper`.
       index = None();
-      values.erase(values.begin(), upper_bound);
+      gap = 0;
     }
   }
 
@@ -195,36 +211,167 @@ private:
     // half-way point of the time series, we'll start another
     // sparsification cycle from the beginning, for example:
     //
-    // next             Time series with a capacity of 7.
+    // index            Time series with a capacity of 7.
     //   v              Initial state with 7 entries
     // 0 1 2 3 4 5 6
     //
-    //   next           Insert '7'.
+    //     index        Insert '7'.
     //     v            Capacity is exceeded, we remove '1' and
     // 0 2 3 4 5 6 7    advance to remove '3' next.
     //
-    //     next         Insert '8'.
+    //       index      Insert '8'.
     //       v          Capacity is exceeded, we remove '3' and
     // 0 2 4 5 6 7 8    advance to remove '5' next.
     //
-    // next             Insert '9'.
+    // index            Insert '9'.
     //   v              Capacity is exceeded, we remove '5' and now
     // 0 2 4 6 7 8 9    '7' is past the halfway mark, so we will reset
     //                  reset to the beginning and consider '2'.
+    //
+    // Rather than moving all the values after (or before) a removed
+    // one, its slot joins the gap before the index, and the value we
+    // skip is moved to the other side of the gap:
+    //
+    // index            Insert '7'.
+    //   v              Remove '1' by growing the gap, and move
+    // 0 _ 2 3 4 ...    '2' before the gap:
+    // 0 2 _ 3 4 ...
+    //
+    // Hence each removal moves a single value, and the gap is closed
+    // only once per sparsification cycle.
 
-    while (values.size() > capacity) {
+    while (count > capacity) {
       // If the index is uninitialized, or past the half-way point,
       // we set it back to the beginning.
-      if (index.isNone() || index.get() > values.size() / 2) {
+      if (index.isNone() || index.get() > count / 2) {
+        close();
+
         // The second element is the initial deletion candidate.
-        next = values.begin();
-        ++next;
         index = 1;
       }
 
-      next = values.erase(next);
-      next++; // Skip one element.
-      index = index.get() + 1;
+      size_t position = index.get();
+
+      ++gap;
+      --count;
+
+      if (position < count) {
+        // Skip one element.
+        values[slot(position)] = std::move(values[slot(position + gap)]);
+      } else {
+        // We removed the last value, so the gap is unused space at
+        // the end of the ring now.
+        gap = 0;
+      }
+
+      index = position + 1;
+    }
+  }
+
+  // Moves the values before the gap (if any) up to the values after
+  // it, so that the values are contiguous in the ring again.
+  void close()
+  {
+    if (gap == 0) {
+      return;
+    }
+
+    CHECK(index.isSome());
+
+    for (size_t i = index.get(); i > 0; --i) {
+      values[slot(i - 1 + gap)] = std::move(values[slot(i - 1)]);
+    }
+
+    head = slot(gap);
+    gap = 0;
+  }
+
+  // Returns the offset from the beginning of the ring of the value at
+  // the given position of the time series, i.e., skipping the gap.
+  size_t offset(size_t position) const
+  {
+    return gap > 0 && position >= index.get() ? position + gap : position;
+  }
+
+  // Returns the slot of the buffer at the given offset from the
+  // beginning of the ring.
+  size_t slot(size_t offset) const
+  {
+    size_t slot = head + offset;
+    return slot < values.size() ? slot : slot - values.size();
+  }
+
+  Value& at(size_t position) { return values[slot(offset(position))]; }
+
+  const Value& at(size_t position) const
+  {
+    return values[slot(offset(position))];
+  }
+
+  // Returns the position of the first value not before the given time.
+  size_t lower_bound(const Time& time) const
+  {
+    size_t first = 0;
+    size_t last = count;
+    while (first < last) {
+      size_t middle = first + (last - first) / 2;
+      if (at(middle).time < time) {
+        first = middle + 1;
+      } else {
+        last = middle;
+      }
+    }
+    return first;
+  }
+
+  // Returns the position of the first value after the given time.
+  size_t upper_bound(const Time& time) const
+  {
+    size_t first = 0;
+    size_t last = count;
+    while (first < last) {
+      size_t middle = first + (last - first) / 2;
+      if (time < at(middle).time) {
+        last = middle;
+      } else {
+        first = middle + 1;
+      }
+    }
+    return first;
+  }
+
+  void append(Value&& value)
+  {
+    if (count + gap < values.size()) {
+      values[slot(count + gap)] = std::move(value);
+      ++count;
+      return;
+    }
+
+    // The buffer is full, so we grow it. Given the gap is at most
+    // half of the values, this stops once the buffer can hold one
+    // and a half times the capacity. The ring must begin at the
+    // first slot to grow it.
+    std::rotate(values.begin(), values.begin() + head, values.end());
+    head = 0;
+
+    if (values.size() == values.capacity()) {
+      values.reserve(std::max((size_t) 16, values.size() * 2));
+    }
+
+    values.push_back(std::move(value));
+    ++count;
+  }
+
+  void insert(size_t position, Value&& value)
+  {
+    CHECK_EQ(0u, gap);
+
+    append(std::move(value));
+
+    // Move the values after the position one slot towards the end.
+    for (size_t i = count - 1; i > position; --i) {
+      std::swap(at(i), at(i - 1));
     }
   }
 
@@ -232,15 +379,17 @@ private:
   Duration window;
   size_t capacity;
 
-  // We use a map instead of a hashmap to store the values because
-  // that way we can retrieve a series in sorted order efficiently.
-  std::map<Time, T> values;
+  // The ring buffer of values, in time order starting from the slot
+  // `head`. The values before the index are followed by `gap` unused
+  // slots, and the slots after the last value are unused too, e.g.,
+  // once values were truncated.
+  std::vector<Value> values;
+  size_t head;
+  size_t count;
+  size_t gap;
 
-  // Next deletion candidate. We store both the iterator and index.
-  // The index is None initially, and whenever a value is appended
-  // out-of-order. This means 'next' is only valid when 'index' is
-  // Some.
-  typename std::map<Time, T>::iterator next;
+  // Position of the next deletion candidate. The index is None
+  // initially, and whenever a value is appended out-of-order.
   Option<size_t> index;
 };
 
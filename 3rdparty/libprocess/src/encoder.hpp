@@ -16,18 +16,27 @@
 #include <stdint.h>
 #include <time.h>
 
+#ifdef USE_ZSTD
+#include <zstd.h>
+#endif // USE_ZSTD
+
 #include <limits>
 #include <map>
 #include <sstream>
+#include <string>
 
 #include <process/http.hpp>
+#include <process/owned.hpp>
 #include <process/process.hpp>
 
+#include <stout/error.hpp>
 #include <stout/foreach.hpp>
 #include <stout/gzip.hpp>
 #include <stout/hashmap.hpp>
 #include <stout/numify.hpp>
+#include <stout/option.hpp>
 #include <stout/os.hpp>
+#include <stout/try.hpp>
 
 
 namespace process {
@@ -35,6 +44,158 @@ namespace process {
 const uint32_t GZIP_MINIMUM_BODY_LENGTH = 1024;
 
 
+// Incrementally compresses the body of a response using one of the
+// content codings that the server supports. The state is kept per
+// response, so that a streamed body gets compressed chunk by chunk
+// as it is produced, never as a whole.
+class Compressor
+{
+public:
+  // Returns the content coding to compress a response to `request`
+  // with, if the client accepts any of the supported ones. The client
+  // ranks the codings by their q values (see RFC 2616 section 14.3),
+  // and we prefer zstd, when built with it, over gzip of the same q
+  // value, as it is both faster and denser than gzip at its default
+  // level. Since "*" is mostly sent by clients which do not know
+  // about zstd, it only matches gzip.
+  static Option<std::string> negotiate(const http::Request& request)
+  {
+    const double gzip = request.encodingQuality("gzip");
+
+#ifdef USE_ZSTD
+    const double zstd = request.encodingQuality("zstd", false);
+
+    if (zstd > 0.0 && zstd >= gzip) {
+      return std::string("zstd");
+    }
+#endif // USE_ZSTD
+
+    if (gzip > 0.0) {
+      return std::string("gzip");
+    }
+
+    return None();
+  }
+
+  // Returns a compressor for a coding returned by `negotiate()`.
+  static Owned<Compressor> create(const std::string& encoding);
+
+  virtual ~Compressor() {}
+
+  // Compresses the next chunk of the body and flushes the output, so
+  // that the client can decode all of the body received so far, e.g.,
+  // an event of a subscription. Returns an empty string for an empty
+  // chunk.
+  virtual Try<std::string> compress(const std::string& data) = 0;
+
+  // Compresses the rest of the body (if any) and ends the stream.
+  virtual Try<std::string> finish(const std::string& data = "") = 0;
+};
+
+
+class GzipCompressor : public Compressor
+{
+public:
+  Try<std::string> compress(const std::string& data) override
+  {
+    return compressor.compress(data, true);
+  }
+
+  Try<std::string> finish(const std::string& data) override
+  {
+    Try<std::string> compressed = compressor.compress(data);
+    if (compressed.isError()) {
+      return compressed;
+    }
+
+    Try<std::string> last = compressor.finish();
+    if (last.isError()) {
+      return last;
+    }
+
+    return compressed.get() + last.get();
+  }
+
+private:
+  gzip::Compressor compressor;
+};
+
+
+#ifdef USE_ZSTD
+class ZstdCompressor : public Compressor
+{
+public:
+  ZstdCompressor() : context(ZSTD_createCCtx())
+  {
+    CHECK_NOTNULL(context);
+  }
+
+  ~ZstdCompressor() override
+  {
+    ZSTD_freeCCtx(context);
+  }
+
+  Try<std::string> compress(const std::string& data) override
+  {
+    if (data.empty()) {
+      return std::string();
+    }
+
+    return stream(data, ZSTD_e_flush);
+  }
+
+  Try<std::string> finish(const std::string& data) override
+  {
+    return stream(data, ZSTD_e_end);
+  }
+
+private:
+  ZstdCompressor(const ZstdCompressor&) = delete;
+  ZstdCompressor& operator=(const ZstdCompressor&) = delete;
+
+  Try<std::string> stream(const std::string& data, ZSTD_EndDirective mode)
+  {
+    ZSTD_inBuffer input = {data.data(), data.size(), 0};
+
+    // A flush or an end is complete once `ZSTD_compressStream2`
+    // returns 0, i.e., no more data is pending in the context.
+    std::string result;
+    size_t remaining;
+    do {
+      char buffer[16384];
+      ZSTD_outBuffer output = {buffer, sizeof(buffer), 0};
+
+      remaining = ZSTD_compressStream2(context, &output, &input, mode);
+      if (ZSTD_isError(remaining)) {
+        return Error(
+            "Failed to compress with zstd: " +
+            std::string(ZSTD_getErrorName(remaining)));
+      }
+
+      result.append(buffer, output.pos);
+    } while (remaining > 0);
+
+    return result;
+  }
+
+  ZSTD_CCtx* context;
+};
+#endif // USE_ZSTD
+
+
+inline Owned<Compressor> Compressor::create(const std::string& encoding)
+{
+#ifdef USE_ZSTD
+  if (encoding == "zstd") {
+    return Owned<Compressor>(new ZstdCompressor());
+  }
+#endif // USE_ZSTD
+
+  CHECK_EQ("gzip", encoding);
+  return Owned<Compressor>(new GzipCompressor());
+}
+
+
 class Encoder
 {
 public:
@@ -98,6 +259,30 @@ private:
 };
 
 
+// A `DataEncoder` which signals once it is done with the data, i.e.,
+// once the data has been sent or dropped (e.g., because the socket
+// was closed), since that is when encoders get deleted.
+class SentDataEncoder : public DataEncoder
+{
+public:
+  SentDataEncoder(std::string&& _data)
+    : DataEncoder(std::move(_data)) {}
+
+  ~SentDataEncoder() override
+  {
+    promise.set(Nothing());
+  }
+
+  Future<Nothing> sent() const
+  {
+    return promise.future();
+  }
+
+private:
+  Promise<Nothing> promise;
+};
+
+
 class MessageEncoder : public DataEncoder
 {
 public:
@@ -181,18 +366,25 @@ public:
     // Should we compress this response?
     std::string body = response.body;
 
+    Option<std::string> encoding;
     if (response.type == http::Response::BODY &&
         response.body.length() >= GZIP_MINIMUM_BODY_LENGTH &&
-        !headers.contains("Content-Encoding") &&
-        request.acceptsEncoding("gzip")) {
-      Try<std::string> compressed = gzip::compress(body);
+        !headers.contains("Content-Encoding")) {
+      encoding = Compressor::negotiate(request);
+    }
+
+    if (encoding.isSome()) {
+      Try<std::string> compressed =
+        Compressor::create(encoding.get())->finish(body);
+
       if (compressed.isError()) {
-        LOG(WARNING) << "Failed to gzip response body: " << compressed.error();
+        LOG(WARNING) << "Failed to compress response body with "
+                     << encoding.get() << ": " << compressed.error();
       } else {
         body = std::move(compressed.get());
 
         headers["Content-Length"] = stringify(body.length());
-        headers["Content-Encoding"] = "gzip";
+        headers["Content-Encoding"] = encoding.get();
       }
     }
 
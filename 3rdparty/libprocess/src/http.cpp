@@ -63,6 +63,9 @@
 
 #include "decoder.hpp"
 #include "encoder.hpp"
+#ifdef USE_HTTP2
+#include "http2.hpp"
+#endif // USE_HTTP2
 
 using std::deque;
 using std::istringstream;
@@ -325,10 +328,16 @@ bool Request::acceptsEncoding(const string& encoding) const
   // MAY assume that the client will accept any content coding. In
   // this case, if "identity" is one of the available content-codings,
   // then the server SHOULD use the "identity" content-coding...
+  return encodingQuality(encoding) > 0;
+}
+
+
+double Request::encodingQuality(const string& encoding, bool wildcard) const
+{
   Option<string> accept = headers.get("Accept-Encoding");
 
   if (accept.isNone() || accept->empty()) {
-    return false;
+    return 0;
   }
 
   // Remove spaces and tabs for easier parsing.
@@ -338,8 +347,10 @@ bool Request::acceptsEncoding(const string& encoding) const
 
   // First we'll look for the encoding specified explicitly, then '*'.
   vector<string> candidates;
-  candidates.push_back(encoding);      // Rule 1.
-  candidates.push_back("*");           // Rule 2.
+  candidates.push_back(encoding);
+  if (wildcard) {
+    candidates.push_back("*");
+  }
 
   foreach (const string& candidate, candidates) {
     // Is the candidate one of the accepted encodings?
@@ -351,24 +362,23 @@ bool Request::acceptsEncoding(const string& encoding) const
       }
 
       if (strings::lower(tokens[0]) == strings::lower(candidate)) {
-        // Is there a 0 q value? Ex: 'gzip;q=0.0'.
+        // Look for the q value, e.g., { "q": ["0.5"] }.
         const map<string, vector<string>> values =
           strings::pairs(encoding_, ";", "=");
 
-        // Look for { "q": ["0"] }.
         if (values.count("q") == 0 || values.find("q")->second.size() != 1) {
           // No q value, or malformed q value.
-          return true;
+          return 1;
         }
 
-        // Is the q value > 0?
+        // A q value which is not a number is not acceptable.
         Try<double> value = numify<double>(values.find("q")->second[0]);
-        return value.isSome() && value.get() > 0;
+        return value.isSome() ? value.get() : 0;
       }
     }
   }
 
-  return false;
+  return 0;
 }
 
 
@@ -458,11 +468,14 @@ Pipe::Writer Pipe::writer() const
 
 Future<string> Pipe::Reader::read()
 {
+  Future<string> future;
+  queue<Owned<Promise<Nothing>>> drains;
+
   synchronized (data->lock) {
     if (data->readEnd == Reader::CLOSED) {
       return Failure("closed");
     } else if (!data->writes.empty()) {
-      Future<string> future = data->writes.front();
+      future = data->writes.front();
       data->writes.pop();
       return future;
     } else if (data->writeEnd == Writer::CLOSED) {
@@ -472,9 +485,21 @@ Future<string> Pipe::Reader::read()
       return data->failure.get();
     } else {
       data->reads.push(Owned<Promise<string>>(new Promise<string>()));
-      return data->reads.back()->future();
+      future = data->reads.back()->future();
+
+      // The pipe is drained now that the reader waits for more data.
+      std::swap(data->drains, drains);
     }
   }
+
+  // NOTE: We set the promises outside the critical section to avoid
+  // triggering callbacks that try to reacquire the lock.
+  while (!drains.empty()) {
+    drains.front()->set(Nothing());
+    drains.pop();
+  }
+
+  return future;
 }
 
 
@@ -504,6 +529,7 @@ bool Pipe::Reader::close()
   bool closed = false;
   bool notify = false;
   queue<Owned<Promise<string>>> reads;
+  queue<Owned<Promise<Nothing>>> drains;
 
   synchronized (data->lock) {
     if (data->readEnd == Reader::OPEN) {
@@ -515,6 +541,10 @@ bool Pipe::Reader::close()
       // Extract the pending reads so we can fail them.
       std::swap(data->reads, reads);
 
+      // Extract the writers waiting for the pipe to be drained,
+      // since there is nothing more to wait for.
+      std::swap(data->drains, drains);
+
       closed = true;
       data->readEnd = Reader::CLOSED;
 
@@ -531,6 +561,11 @@ bool Pipe::Reader::close()
       reads.pop();
     }
 
+    while (!drains.empty()) {
+      drains.front()->set(Nothing());
+      drains.pop();
+    }
+
     if (notify) {
       data->readerClosure.set(Nothing());
     } else {
@@ -545,6 +580,14 @@ bool Pipe::Reader::close()
 }
 
 
+bool Pipe::Reader::paced() const
+{
+  synchronized (data->lock) {
+    return data->paced;
+  }
+}
+
+
 bool Pipe::Writer::write(string s)
 {
   bool written = false;
@@ -580,12 +623,17 @@ bool Pipe::Writer::close()
 {
   bool closed = false;
   queue<Owned<Promise<string>>> reads;
+  queue<Owned<Promise<Nothing>>> drains;
 
   synchronized (data->lock) {
     if (data->writeEnd == Writer::OPEN) {
       // Extract all the pending reads so we can complete them.
       std::swap(data->reads, reads);
 
+      // Extract the writers waiting for the pipe to be drained,
+      // which are not interested anymore.
+      std::swap(data->drains, drains);
+
       data->writeEnd = Writer::CLOSED;
       closed = true;
     }
@@ -598,6 +646,11 @@ bool Pipe::Writer::close()
     reads.pop();
   }
 
+  while (!drains.empty()) {
+    drains.front()->discard();
+    drains.pop();
+  }
+
   return closed;
 }
 
@@ -606,12 +659,17 @@ bool Pipe::Writer::fail(const string& message)
 {
   bool failed = false;
   queue<Owned<Promise<string>>> reads;
+  queue<Owned<Promise<Nothing>>> drains;
 
   synchronized (data->lock) {
     if (data->writeEnd == Writer::OPEN) {
       // Extract all the pending reads so we can fail them.
       std::swap(data->reads, reads);
 
+      // Extract the writers waiting for the pipe to be drained,
+      // which are not interested anymore.
+      std::swap(data->drains, drains);
+
       data->writeEnd = Writer::FAILED;
       data->failure = Failure(message);
       failed = true;
@@ -625,6 +683,11 @@ bool Pipe::Writer::fail(const string& message)
     reads.pop();
   }
 
+  while (!drains.empty()) {
+    drains.front()->discard();
+    drains.pop();
+  }
+
   return failed;
 }
 
@@ -635,6 +698,28 @@ Future<Nothing> Pipe::Writer::readerClosed() const
 }
 
 
+Future<Nothing> Pipe::Writer::drained() const
+{
+  synchronized (data->lock) {
+    data->paced = true;
+
+    if (data->readEnd == Reader::CLOSED || !data->reads.empty()) {
+      return Nothing();
+    }
+
+    if (data->writeEnd != Writer::OPEN) {
+      // There are no more writes to wait for.
+      Promise<Nothing> promise;
+      promise.discard();
+      return promise.future();
+    }
+
+    data->drains.push(Owned<Promise<Nothing>>(new Promise<Nothing>()));
+    return data->drains.back()->future();
+  }
+}
+
+
 namespace header {
 
 Try<WWWAuthenticate> WWWAuthenticate::create(const string& input)
@@ -1127,10 +1212,7 @@ Pipe::Reader encode(const Request& request)
 
   // TODO(bmahler): Use a 'Request' and a 'RequestEncoder' here!
   // Currently this does not handle 'gzip' content encoding,
-  // unless the caller manually compresses the 'body'. For
-  // streaming requests we must wipe 'gzip' as an acceptable
-  // encoding as we don't currently have streaming gzip utilities
-  // to support decoding a streaming gzip response!
+  // unless the caller manually compresses the 'body'.
 
   // Emit the headers.
   foreachpair (const string& key, const string& value, headers) {
@@ -1457,8 +1539,21 @@ struct Connection::Data
   // on within a different execution context. More generally,
   // we should be passing Process ownership to libprocess to
   // ensure all interaction with a Process occurs through a PID.
-  Data(const network::Socket& s)
-    : process(spawn(new internal::ConnectionProcess(s), true)) {}
+  Data(const network::Socket& s, Protocol protocol)
+  {
+    switch (protocol) {
+      case Protocol::HTTP_1_1:
+        process = spawn(new internal::ConnectionProcess(s), true);
+        break;
+      case Protocol::HTTP_2:
+#ifdef USE_HTTP2
+        http2 = spawn(new internal::Http2ConnectionProcess(s), true);
+        break;
+#else
+        UNREACHABLE();
+#endif // USE_HTTP2
+    }
+  }
 
   ~Data()
   {
@@ -1467,27 +1562,51 @@ struct Connection::Data
     // to ensure we don't drop any queued request dispatches
     // which would leave the caller with a future stuck in
     // a pending state.
-    terminate(process, false);
+    if (process.isSome()) {
+      terminate(process.get(), false);
+    }
+
+#ifdef USE_HTTP2
+    if (http2.isSome()) {
+      terminate(http2.get(), false);
+    }
+#endif // USE_HTTP2
   }
 
-  PID<internal::ConnectionProcess> process;
+  Option<PID<internal::ConnectionProcess>> process;
+
+#ifdef USE_HTTP2
+  // Set instead of `process` when the connection speaks HTTP/2.
+  Option<PID<internal::Http2ConnectionProcess>> http2;
+#endif // USE_HTTP2
 };
 
 
 Connection::Connection(
     const network::Socket& s,
     const network::Address& _localAddress,
-    const network::Address& _peerAddress)
+    const network::Address& _peerAddress,
+    Protocol protocol)
   : localAddress(_localAddress), peerAddress(_peerAddress),
-    data(std::make_shared<Connection::Data>(s)) {}
+    data(std::make_shared<Connection::Data>(s, protocol)) {}
 
 
 Future<Response> Connection::send(
     const http::Request& request,
     bool streamedResponse)
 {
+#ifdef USE_HTTP2
+  if (data->http2.isSome()) {
+    return dispatch(
+        data->http2.get(),
+        &internal::Http2ConnectionProcess::send,
+        request,
+        streamedResponse);
+  }
+#endif // USE_HTTP2
+
   return dispatch(
-      data->process,
+      data->process.get(),
       &internal::ConnectionProcess::send,
       request,
       streamedResponse);
@@ -1496,8 +1615,17 @@ Future<Response> Connection::send(
 
 Future<Nothing> Connection::disconnect()
 {
+#ifdef USE_HTTP2
+  if (data->http2.isSome()) {
+    return dispatch(
+        data->http2.get(),
+        &internal::Http2ConnectionProcess::disconnect,
+        None());
+  }
+#endif // USE_HTTP2
+
   return dispatch(
-      data->process,
+      data->process.get(),
       &internal::ConnectionProcess::disconnect,
       None());
 }
@@ -1505,8 +1633,16 @@ Future<Nothing> Connection::disconnect()
 
 Future<Nothing> Connection::disconnected()
 {
+#ifdef USE_HTTP2
+  if (data->http2.isSome()) {
+    return dispatch(
+        data->http2.get(),
+        &internal::Http2ConnectionProcess::disconnected);
+  }
+#endif // USE_HTTP2
+
   return dispatch(
-      data->process,
+      data->process.get(),
       &internal::ConnectionProcess::disconnected);
 }
 
@@ -1514,8 +1650,15 @@ Future<Nothing> Connection::disconnected()
 Future<Connection> connect(
     const network::Address& address,
     Scheme scheme,
-    const Option<string>& peer_hostname)
+    const Option<string>& peer_hostname,
+    Protocol protocol)
 {
+#ifndef USE_HTTP2
+  if (protocol == Protocol::HTTP_2) {
+    return Failure("HTTP/2 requires libprocess to be built with nghttp2");
+  }
+#endif // USE_HTTP2
+
   SocketImpl::Kind kind;
 
   switch (scheme) {
@@ -1544,28 +1687,46 @@ Future<Connection> connect(
       case Scheme::HTTP_UNIX:
         return socket->connect(address);
 #ifdef USE_SSL_SOCKET
-      case Scheme::HTTPS:
-        return socket->connect(
-            address,
-            network::openssl::create_tls_client_config(peer_hostname));
+      case Scheme::HTTPS: {
+        network::openssl::TLSClientConfig config =
+          network::openssl::create_tls_client_config(peer_hostname);
+
+#ifdef USE_HTTP2
+        // Offer HTTP/2 during the TLS handshake.
+        if (protocol == Protocol::HTTP_2) {
+          config.configure_socket = &http2::configure_socket;
+        }
+#endif // USE_HTTP2
+
+        return socket->connect(address, config);
+      }
 #endif
     }
     UNREACHABLE();
   }();
 
   return connected
-    .then([socket, address]() -> Future<Connection> {
+    .then([socket, address, protocol]() -> Future<Connection> {
       Try<network::Address> localAddress = socket->address();
       if (localAddress.isError()) {
         return Failure("Failed to get socket's local address: " +
             localAddress.error());
       }
 
-      return Connection(socket.get(), localAddress.get(), address);
+      return Connection(socket.get(), localAddress.get(), address, protocol);
     });
 }
 
 
+Future<Connection> connect(
+    const network::Address& address,
+    Scheme scheme,
+    const Option<string>& peer_hostname)
+{
+  return connect(address, scheme, peer_hostname, Protocol::HTTP_1_1);
+}
+
+
 Future<Connection> connect(
     const network::Address& address,
     Scheme scheme)
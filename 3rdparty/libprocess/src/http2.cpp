@@ -0,0 +1,1400 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License
+
+#include <string.h>
+
+#include <http_parser.h>
+
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <process/clock.hpp>
+#include <process/defer.hpp>
+
+#include <stout/foreach.hpp>
+#include <stout/gzip.hpp>
+#include <stout/numify.hpp>
+#include <stout/os.hpp>
+#include <stout/stringify.hpp>
+#include <stout/strings.hpp>
+
+#include <stout/os/read.hpp>
+
+#include "encoder.hpp"
+#include "http2.hpp"
+#include "socket_manager.hpp"
+
+#ifdef USE_SSL_SOCKET
+#include "openssl.hpp"
+#endif // USE_SSL_SOCKET
+
+using process::network::internal::SocketImpl;
+
+using process::http::BadRequest;
+using process::http::InternalServerError;
+using process::http::NotFound;
+using process::http::Pipe;
+using process::http::Request;
+using process::http::Response;
+
+using std::pair;
+using std::string;
+using std::vector;
+
+namespace process {
+namespace http2 {
+
+// The flow control windows we advertise. The default 64KB window of
+// a stream would cap its throughput at one window per round trip.
+constexpr int32_t STREAM_WINDOW_SIZE = 1 << 20; // 1MB.
+constexpr int32_t CONNECTION_WINDOW_SIZE = 1 << 24; // 16MB.
+
+constexpr uint32_t MAX_CONCURRENT_STREAMS = 100;
+
+
+// The body of a message being sent on a stream. nghttp2 pulls it
+// through `read` whenever flow control allows, and we append to it as
+// the chunks of a streamed body arrive.
+struct Body
+{
+  Body() : offset(0), eof(false) {}
+
+  ~Body()
+  {
+    if (fd.isSome()) {
+      os::close(fd.get());
+    }
+  }
+
+  void append(const string& chunk)
+  {
+    if (offset > 0) {
+      data.erase(0, offset);
+      offset = 0;
+    }
+
+    data.append(chunk);
+  }
+
+  nghttp2_data_provider provider()
+  {
+    nghttp2_data_provider provider;
+    provider.source.ptr = this;
+    provider.read_callback = &Body::read;
+    return provider;
+  }
+
+  static ssize_t read(
+      nghttp2_session* session,
+      int32_t stream_id,
+      uint8_t* buffer,
+      size_t length,
+      uint32_t* flags,
+      nghttp2_data_source* source,
+      void* user_data)
+  {
+    Body* body = static_cast<Body*>(source->ptr);
+
+    if (body->fd.isSome()) {
+      ssize_t read = os::read(body->fd.get(), buffer, length);
+      if (read < 0) {
+        return NGHTTP2_ERR_TEMPORAL_CALLBACK_FAILURE;
+      } else if (read == 0) {
+        *flags |= NGHTTP2_DATA_FLAG_EOF;
+      }
+      return read;
+    }
+
+    const size_t size = std::min(length, body->data.size() - body->offset);
+
+    memcpy(buffer, body->data.data() + body->offset, size);
+    body->offset += size;
+
+    if (body->offset == body->data.size()) {
+      body->data.clear();
+      body->offset = 0;
+
+      if (body->eof) {
+        *flags |= NGHTTP2_DATA_FLAG_EOF;
+      } else {
+        if (body->drained) {
+          std::function<void()> drained = std::move(body->drained);
+          body->drained = nullptr;
+          drained();
+        }
+
+        if (size == 0) {
+          // Wait for more of the body, see `nghttp2_session_resume_data`.
+          return NGHTTP2_ERR_DEFERRED;
+        }
+      }
+    }
+
+    return size;
+  }
+
+  // The part of the body which has not been sent yet starts at
+  // `offset`, and `eof` is set once `data` holds the end of the body.
+  string data;
+  size_t offset;
+  bool eof;
+
+  // Invoked once all of `data` has been handed to nghttp2, so that
+  // the next chunk of a streamed body is only read when flow control
+  // allows sending it.
+  std::function<void()> drained;
+
+  // Set when the body is a file.
+  Option<int_fd> fd;
+};
+
+
+// Returns the header fields of a message in the form HTTP/2 expects:
+// the names must be lowercase, and the fields specific to an HTTP/1.1
+// connection must not be sent (see RFC 7540, section 8.1.2).
+static vector<pair<string, string>> fields(const http::Headers& headers)
+{
+  vector<pair<string, string>> fields;
+
+  foreachpair (const string& key, const string& value, headers) {
+    const string name = strings::lower(key);
+
+    if (name == "connection" ||
+        name == "host" ||
+        name == "keep-alive" ||
+        name == "proxy-connection" ||
+        name == "transfer-encoding" ||
+        name == "upgrade") {
+      continue;
+    }
+
+    fields.emplace_back(name, value);
+  }
+
+  return fields;
+}
+
+
+// NOTE: The returned entries point into `fields`, which must outlive
+// them. nghttp2 copies the entries when a frame gets submitted.
+static vector<nghttp2_nv> nva(const vector<pair<string, string>>& fields)
+{
+  vector<nghttp2_nv> nva;
+  nva.reserve(fields.size());
+
+  foreach (const auto& field, fields) {
+    nghttp2_nv nv;
+    nv.name = (uint8_t*) field.first.data();
+    nv.namelen = field.first.size();
+    nv.value = (uint8_t*) field.second.data();
+    nv.valuelen = field.second.size();
+    nv.flags = NGHTTP2_NV_FLAG_NONE;
+    nva.push_back(nv);
+  }
+
+  return nva;
+}
+
+
+// Adds a header field received on a stream, joining repeated fields
+// as HTTP/1.1 does (see RFC 7230, section 3.2.2).
+static void add(http::Headers* headers, const string& name, const string& value)
+{
+  Option<string> existing = headers->get(name);
+
+  if (existing.isNone()) {
+    (*headers)[name] = value;
+  } else if (name == "cookie") {
+    (*headers)[name] = existing.get() + "; " + value;
+  } else {
+    (*headers)[name] = existing.get() + ", " + value;
+  }
+}
+
+
+// Sets the path, query and fragment of `url` from the ':path' of a
+// request.
+static Try<Nothing> parse(const string& path, http::URL* url)
+{
+  http_parser_url parsed;
+  http_parser_url_init(&parsed);
+
+  if (http_parser_parse_url(path.data(), path.size(), 0, &parsed) != 0) {
+    return Error("Malformed ':path'");
+  }
+
+  if (parsed.field_set & (1 << UF_PATH)) {
+    url->path = path.substr(
+        parsed.field_data[UF_PATH].off,
+        parsed.field_data[UF_PATH].len);
+  }
+
+  if (parsed.field_set & (1 << UF_FRAGMENT)) {
+    url->fragment = path.substr(
+        parsed.field_data[UF_FRAGMENT].off,
+        parsed.field_data[UF_FRAGMENT].len);
+  }
+
+  if (parsed.field_set & (1 << UF_QUERY)) {
+    Try<hashmap<string, string>> query = http::query::decode(path.substr(
+        parsed.field_data[UF_QUERY].off,
+        parsed.field_data[UF_QUERY].len));
+
+    if (query.isError()) {
+      return Error("Malformed query: " + query.error());
+    }
+
+    url->query = query.get();
+  }
+
+  return Nothing();
+}
+
+
+#ifdef USE_SSL_SOCKET
+Try<Nothing> configure_socket(
+    SSL* ssl,
+    const network::Address& peer,
+    const Option<string>& servername)
+{
+  Try<Nothing> configured = network::openssl::configure_socket(
+      ssl, network::openssl::Mode::CLIENT, peer, servername);
+
+  if (configured.isError()) {
+    return configured;
+  }
+
+  static const unsigned char protocols[] = "\x02h2\x08http/1.1";
+
+  // NOTE: Unlike most of OpenSSL, this returns 0 on success.
+  if (SSL_set_alpn_protos(ssl, protocols, sizeof(protocols) - 1) != 0) {
+    return Error("Failed to offer HTTP/2");
+  }
+
+  return Nothing();
+}
+#endif // USE_SSL_SOCKET
+
+
+// Makes sure that the producer of a response we will not send stops
+// producing it, as `HttpProxy::finalize` does.
+static void abandon(Future<Response> response)
+{
+  response.discard();
+
+  response.onReady([](const Response& response) {
+    if (response.type == Response::PIPE) {
+      CHECK_SOME(response.reader);
+      Pipe::Reader reader = response.reader.get(); // Remove const.
+      reader.close();
+    }
+  });
+}
+
+} // namespace http2 {
+
+
+struct Http2Proxy::Stream
+{
+  explicit Stream(int32_t _id) : id(_id), received(false)
+  {
+    request.type = Request::PIPE;
+  }
+
+  const int32_t id;
+
+  // The request, whose headers are needed again to negotiate the
+  // encoding of the response. It gets handed to the `handler` once
+  // its headers have been `received`.
+  Request request;
+  string path;
+  bool received;
+
+  // The reader of the request's body tells the responses of the
+  // streams apart in `Http2Proxy::handle`.
+  Option<Pipe::Reader> reader;
+  Option<Pipe::Writer> writer;
+
+  Option<Future<Response>> response;
+
+  // The body of a streamed response and, if the client accepts it,
+  // its compressor.
+  Option<Pipe::Reader> pipe;
+  Owned<Compressor> compressor;
+
+  http2::Body body;
+};
+
+
+Http2Proxy::Http2Proxy(
+    const network::inet::Socket& _socket,
+    const lambda::function<void(Request*)>& _handler)
+  : HttpProxy(_socket),
+    handler(_handler),
+    session(nullptr)
+{
+  nghttp2_session_callbacks* callbacks;
+  CHECK_EQ(0, nghttp2_session_callbacks_new(&callbacks));
+
+  nghttp2_session_callbacks_set_on_begin_headers_callback(
+      callbacks, &Http2Proxy::on_begin_headers);
+  nghttp2_session_callbacks_set_on_header_callback(
+      callbacks, &Http2Proxy::on_header);
+  nghttp2_session_callbacks_set_on_frame_recv_callback(
+      callbacks, &Http2Proxy::on_frame_recv);
+  nghttp2_session_callbacks_set_on_data_chunk_recv_callback(
+      callbacks, &Http2Proxy::on_data_chunk_recv);
+  nghttp2_session_callbacks_set_on_stream_close_callback(
+      callbacks, &Http2Proxy::on_stream_close);
+
+  CHECK_EQ(0, nghttp2_session_server_new(&session, callbacks, this));
+
+  nghttp2_session_callbacks_del(callbacks);
+}
+
+
+Http2Proxy::~Http2Proxy()
+{
+  nghttp2_session_del(session);
+}
+
+
+void Http2Proxy::initialize()
+{
+  const nghttp2_settings_entry settings[] = {
+    {NGHTTP2_SETTINGS_MAX_CONCURRENT_STREAMS, http2::MAX_CONCURRENT_STREAMS},
+    {NGHTTP2_SETTINGS_INITIAL_WINDOW_SIZE, http2::STREAM_WINDOW_SIZE}};
+
+  nghttp2_submit_settings(session, NGHTTP2_FLAG_NONE, settings, 2);
+
+  nghttp2_session_set_local_window_size(
+      session, NGHTTP2_FLAG_NONE, 0, http2::CONNECTION_WINDOW_SIZE);
+
+  flush();
+}
+
+
+void Http2Proxy::finalize()
+{
+  foreach (int32_t id, streams.keys()) {
+    close(id);
+  }
+
+  HttpProxy::finalize();
+}
+
+
+Future<Nothing> Http2Proxy::receive(const string& data)
+{
+  ssize_t read = nghttp2_session_mem_recv(
+      session, (const uint8_t*) data.data(), data.size());
+
+  if (read < 0) {
+    return Failure(nghttp2_strerror(read));
+  }
+
+  flush();
+
+  return Nothing();
+}
+
+
+void Http2Proxy::handle(const Future<Response>& future, const Request& request)
+{
+  foreachvalue (const Owned<Stream>& stream, streams) {
+    if (stream->reader.isSome() && stream->reader == request.reader) {
+      stream->response = future;
+
+      const int32_t id = stream->id;
+
+      future.onAny(defer(self(), [this, id](const Future<Response>& future) {
+        respond(id, future);
+      }));
+
+      return;
+    }
+  }
+
+  // The client has reset the stream in the meantime.
+  http2::abandon(future);
+}
+
+
+void Http2Proxy::respond(int32_t id, const Future<Response>& future)
+{
+  if (!streams.contains(id)) {
+    http2::abandon(future);
+    return;
+  }
+
+  Owned<Stream> stream = streams.at(id);
+
+  Response response;
+
+  if (future.isReady()) {
+    response = future.get();
+  } else {
+    response = InternalServerError(
+        future.isFailed() ? future.failure() : "discarded future");
+
+    VLOG(1) << "Returning '" << response.status << "' for stream " << id
+            << " (" << (future.isFailed() ? future.failure() : "discarded")
+            << ")";
+  }
+
+  if (response.type == Response::PATH) {
+    const string path = response.path;
+
+    Try<int_fd> fd = os::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd.isError()) {
+      const int error = errno;
+      if (error == ENOENT || error == ENOTDIR) {
+        VLOG(1) << "Returning '404 Not Found' for path '" << path << "'";
+        response = NotFound();
+      } else {
+        VLOG(1) << "Failed to send file at '" << path << "': " << fd.error();
+        response = InternalServerError();
+      }
+    } else {
+      const Try<Bytes> size = os::stat::size(fd.get());
+      if (size.isError()) {
+        VLOG(1) << "Failed to send file at '" << path << "': " << size.error();
+        response = InternalServerError();
+        os::close(fd.get());
+      } else if (os::stat::isdir(fd.get())) {
+        VLOG(1) << "Returning '404 Not Found' for directory '" << path << "'";
+        response = NotFound();
+        os::close(fd.get());
+      } else {
+        // While the user is expected to properly set a 'Content-Type'
+        // header, we fill in (or overwrite) 'Content-Length' header.
+        response.headers["Content-Length"] = stringify(size->bytes());
+        response.body.clear();
+
+        // Note the file descriptor gets closed along with the stream.
+        stream->body.fd = fd.get();
+      }
+    }
+  }
+
+  vector<pair<string, string>> fields = {{":status", stringify(response.code)}};
+
+  // Whether the response has a body to send after its headers.
+  bool body = true;
+
+  switch (response.type) {
+    case Response::NONE: {
+      body = false;
+      break;
+    }
+    case Response::BODY: {
+      Option<string> encoding;
+      if (response.body.length() >= GZIP_MINIMUM_BODY_LENGTH &&
+          !response.headers.contains("Content-Encoding")) {
+        encoding = Compressor::negotiate(stream->request);
+      }
+
+      if (encoding.isSome()) {
+        Try<string> compressed =
+          Compressor::create(encoding.get())->finish(response.body);
+
+        if (compressed.isError()) {
+          LOG(WARNING) << "Failed to compress response body with "
+                       << encoding.get() << ": " << compressed.error();
+        } else {
+          response.body = std::move(compressed.get());
+          response.headers["Content-Encoding"] = encoding.get();
+        }
+      }
+
+      response.headers["Content-Length"] = stringify(response.body.size());
+
+      body = !response.body.empty();
+      stream->body.data = std::move(response.body);
+      stream->body.eof = true;
+      break;
+    }
+    case Response::PATH: {
+      break;
+    }
+    case Response::PIPE: {
+      // Compress the chunks as they get read if the client accepts it.
+      Option<string> encoding;
+      if (!response.headers.contains("Content-Encoding")) {
+        encoding = Compressor::negotiate(stream->request);
+      }
+
+      if (encoding.isSome()) {
+        response.headers["Content-Encoding"] = encoding.get();
+        stream->compressor = Compressor::create(encoding.get());
+      }
+
+      CHECK_SOME(response.reader);
+      stream->pipe = response.reader.get();
+
+      stream->pipe->read()
+        .onAny(defer(self(), [this, id](const Future<string>& chunk) {
+          this->stream(id, chunk);
+        }));
+      break;
+    }
+  }
+
+  foreach (auto& field, http2::fields(response.headers)) {
+    fields.push_back(std::move(field));
+  }
+
+  const vector<nghttp2_nv> nva = http2::nva(fields);
+  const nghttp2_data_provider provider = stream->body.provider();
+
+  int error = nghttp2_submit_response(
+      session, id, nva.data(), nva.size(), body ? &provider : nullptr);
+
+  if (error != 0) {
+    LOG(WARNING) << "Failed to send response on stream " << id << ": "
+                 << nghttp2_strerror(error);
+  }
+
+  flush();
+}
+
+
+void Http2Proxy::stream(int32_t id, const Future<string>& chunk)
+{
+  // The stream has been closed in the meantime, along with the pipe.
+  if (!streams.contains(id)) {
+    return;
+  }
+
+  Owned<Stream> stream = streams.at(id);
+
+  CHECK_SOME(stream->pipe);
+
+  // The empty chunk, which ends the body, also ends the compressed
+  // stream (if any).
+  Try<string> data = Error("discarded");
+  if (chunk.isFailed()) {
+    data = Error(chunk.failure());
+  } else if (chunk.isReady() && stream->compressor.get() == nullptr) {
+    data = chunk.get();
+  } else if (chunk.isReady()) {
+    data = chunk->empty()
+      ? stream->compressor->finish()
+      : stream->compressor->compress(chunk.get());
+  }
+
+  if (data.isError()) {
+    VLOG(1) << "Failed to read from stream: " << data.error();
+
+    // Unlike HTTP/1.1, we can tell the client that the body is not
+    // complete without closing the connection.
+    nghttp2_submit_rst_stream(
+        session, NGHTTP2_FLAG_NONE, id, NGHTTP2_INTERNAL_ERROR);
+
+    flush();
+    return;
+  }
+
+  stream->body.append(data.get());
+
+  if (chunk->empty()) {
+    stream->body.eof = true;
+    stream->pipe->close();
+    stream->pipe = None();
+  } else if (!stream->pipe->paced()) {
+    // Keep reading, the writer expects its chunks to be sent right
+    // away (see `Pipe::Reader::paced()`).
+    stream->pipe->read()
+      .onAny(defer(self(), [this, id](const Future<string>& chunk) {
+        this->stream(id, chunk);
+      }));
+  } else {
+    // Keep reading once the chunk has been sent, so that a client
+    // which does not open its flow control window slows down the
+    // paced writer of the pipe rather than the chunks piling up in
+    // the body.
+    stream->body.drained = [this, id]() {
+      if (!streams.contains(id) || streams.at(id)->pipe.isNone()) {
+        return;
+      }
+
+      streams.at(id)->pipe->read()
+        .onAny(defer(self(), [this, id](const Future<string>& chunk) {
+          this->stream(id, chunk);
+        }));
+    };
+  }
+
+  nghttp2_session_resume_data(session, id);
+
+  flush();
+}
+
+
+void Http2Proxy::close(int32_t id)
+{
+  if (!streams.contains(id)) {
+    return;
+  }
+
+  Owned<Stream> stream = streams.at(id);
+  streams.erase(id);
+
+  // This is a no-op if the whole body has been received.
+  if (stream->writer.isSome()) {
+    stream->writer->fail("Stream closed");
+  }
+
+  // Need to make sure response producers know not to continue to
+  // create a response (streaming or otherwise).
+  if (stream->pipe.isSome()) {
+    stream->pipe->close();
+  }
+
+  if (stream->response.isSome()) {
+    http2::abandon(stream->response.get());
+  }
+}
+
+
+void Http2Proxy::flush()
+{
+  string data;
+
+  while (true) {
+    const uint8_t* bytes = nullptr;
+    ssize_t length = nghttp2_session_mem_send(session, &bytes);
+
+    if (length < 0) {
+      LOG(WARNING) << "Failed to send on HTTP/2 connection: "
+                   << nghttp2_strerror(length);
+
+      socket_manager->close(socket);
+      return;
+    } else if (length == 0) {
+      break;
+    }
+
+    data.append((const char*) bytes, length);
+  }
+
+  if (!data.empty()) {
+    socket_manager->send(new DataEncoder(std::move(data)), true, socket);
+  }
+}
+
+
+int Http2Proxy::on_begin_headers(
+    nghttp2_session* session,
+    const nghttp2_frame* frame,
+    void* user_data)
+{
+  Http2Proxy* proxy = static_cast<Http2Proxy*>(user_data);
+
+  if (frame->hd.type == NGHTTP2_HEADERS &&
+      frame->headers.cat == NGHTTP2_HCAT_REQUEST) {
+    const int32_t id = frame->hd.stream_id;
+    proxy->streams[id] = Owned<Stream>(new Stream(id));
+  }
+
+  return 0;
+}
+
+
+int Http2Proxy::on_header(
+    nghttp2_session* session,
+    const nghttp2_frame* frame,
+    const uint8_t* _name,
+    size_t namelen,
+    const uint8_t* _value,
+    size_t valuelen,
+    uint8_t flags,
+    void* user_data)
+{
+  Http2Proxy* proxy = static_cast<Http2Proxy*>(user_data);
+
+  const int32_t id = frame->hd.stream_id;
+
+  // Ignore trailers.
+  if (!proxy->streams.contains(id) || proxy->streams.at(id)->received) {
+    return 0;
+  }
+
+  Stream* stream = proxy->streams.at(id).get();
+
+  const string name((const char*) _name, namelen);
+  const string value((const char*) _value, valuelen);
+
+  if (name == ":method") {
+    stream->request.method = value;
+  } else if (name == ":path") {
+    stream->path = value;
+  } else if (name == ":authority") {
+    stream->request.headers["Host"] = value;
+  } else if (!strings::startsWith(name, ":")) {
+    http2::add(&stream->request.headers, name, value);
+  }
+
+  return 0;
+}
+
+
+int Http2Proxy::on_frame_recv(
+    nghttp2_session* session,
+    const nghttp2_frame* frame,
+    void* user_data)
+{
+  Http2Proxy* proxy = static_cast<Http2Proxy*>(user_data);
+
+  const int32_t id = frame->hd.stream_id;
+
+  if (!proxy->streams.contains(id)) {
+    return 0;
+  }
+
+  Stream* stream = proxy->streams.at(id).get();
+
+  if (frame->hd.type == NGHTTP2_HEADERS && !stream->received) {
+    stream->received = true;
+
+    Try<Nothing> parse = http2::parse(stream->path, &stream->request.url);
+
+    if (parse.isError()) {
+      VLOG(1) << "Returning '400 Bad Request' for stream " << id << ": "
+              << parse.error();
+
+      // NOTE: We must not send from within a callback of the session,
+      // hence we respond asynchronously.
+      Future<Response> response = BadRequest(parse.error());
+      stream->response = response;
+
+      response.onAny(defer(
+          proxy->self(),
+          [proxy, id](const Future<Response>& response) {
+            proxy->respond(id, response);
+          }));
+
+      return 0;
+    }
+
+    Try<network::inet::Address> address = proxy->socket.peer();
+    if (address.isSome()) {
+      stream->request.client = address.get();
+    }
+
+    stream->request.received = Clock::now();
+
+    Pipe pipe;
+    stream->reader = pipe.reader();
+    stream->writer = pipe.writer();
+    stream->request.reader = pipe.reader();
+
+    proxy->handler(new Request(stream->request));
+  }
+
+  if ((frame->hd.type == NGHTTP2_HEADERS || frame->hd.type == NGHTTP2_DATA) &&
+      (frame->hd.flags & NGHTTP2_FLAG_END_STREAM) &&
+      stream->writer.isSome()) {
+    stream->writer->close();
+  }
+
+  return 0;
+}
+
+
+int Http2Proxy::on_data_chunk_recv(
+    nghttp2_session* session,
+    uint8_t flags,
+    int32_t stream_id,
+    const uint8_t* data,
+    size_t len,
+    void* user_data)
+{
+  Http2Proxy* proxy = static_cast<Http2Proxy*>(user_data);
+
+  if (proxy->streams.contains(stream_id)) {
+    Stream* stream = proxy->streams.at(stream_id).get();
+
+    if (stream->writer.isSome()) {
+      stream->writer->write(string((const char*) data, len));
+    }
+  }
+
+  return 0;
+}
+
+
+int Http2Proxy::on_stream_close(
+    nghttp2_session* session,
+    int32_t stream_id,
+    uint32_t error_code,
+    void* user_data)
+{
+  Http2Proxy* proxy = static_cast<Http2Proxy*>(user_data);
+
+  proxy->close(stream_id);
+
+  return 0;
+}
+
+
+namespace http {
+namespace internal {
+
+struct Http2ConnectionProcess::Stream
+{
+  explicit Stream(bool _streamedResponse)
+    : streamedResponse(_streamedResponse), code(0) {}
+
+  const bool streamedResponse;
+  Promise<Response> promise;
+
+  // The status and headers of the response, until they are complete.
+  uint16_t code;
+  Headers headers;
+
+  // Set once the response has been handed to the caller.
+  Option<Pipe::Writer> writer;
+  Owned<gzip::Decompressor> decompressor;
+
+  // The body of the request, and its pipe if it is streamed.
+  http2::Body body;
+  Option<Pipe::Reader> pipe;
+};
+
+
+// Returns the ':authority' of a request, which takes the place of
+// the 'Host' header (see `encode` in http.cpp).
+static string authority(const Request& request)
+{
+  CHECK(request.url.domain.isSome() || request.url.ip.isSome());
+
+  string authority;
+
+  if (request.url.scheme == Some("http+unix")) {
+    authority = "localhost";
+  } else if (request.url.domain.isSome()) {
+    authority = request.url.domain.get();
+  } else {
+    authority = stringify(request.url.ip.get());
+  }
+
+  // Add port for non-standard ports.
+  if (request.url.port.isSome() &&
+      request.url.port != 80 &&
+      request.url.port != 443) {
+    authority += ":" + stringify(request.url.port.get());
+  }
+
+  return authority;
+}
+
+
+// Returns the ':path' of a request.
+static string path(const Request& request)
+{
+  string path = "/" + strings::remove(request.url.path, "/", strings::PREFIX);
+
+  if (!request.url.query.empty()) {
+    path += "?" + query::encode(request.url.query);
+  }
+
+  return path;
+}
+
+
+// Returns a 'BODY' response once the body of the provided
+// 'PIPE' response can be read completely.
+static Future<Response> convert(const Response& pipeResponse)
+{
+  CHECK_EQ(Response::PIPE, pipeResponse.type);
+  CHECK_SOME(pipeResponse.reader);
+
+  Pipe::Reader reader = pipeResponse.reader.get();
+
+  return reader.readAll()
+    .then([pipeResponse](const string& body) {
+      Response bodyResponse = pipeResponse;
+      bodyResponse.type = Response::BODY;
+      bodyResponse.body = body;
+      bodyResponse.reader = None(); // Remove the reader.
+      return bodyResponse;
+    });
+}
+
+
+Http2ConnectionProcess::Http2ConnectionProcess(const network::Socket& _socket)
+  : ProcessBase(ID::generate("__http2_connection__")),
+    socket(_socket),
+    session(nullptr),
+    sendChain(Nothing())
+{
+  nghttp2_session_callbacks* callbacks;
+  CHECK_EQ(0, nghttp2_session_callbacks_new(&callbacks));
+
+  nghttp2_session_callbacks_set_on_header_callback(
+      callbacks, &Http2ConnectionProcess::on_header);
+  nghttp2_session_callbacks_set_on_frame_recv_callback(
+      callbacks, &Http2ConnectionProcess::on_frame_recv);
+  nghttp2_session_callbacks_set_on_data_chunk_recv_callback(
+      callbacks, &Http2ConnectionProcess::on_data_chunk_recv);
+  nghttp2_session_callbacks_set_on_stream_close_callback(
+      callbacks, &Http2ConnectionProcess::on_stream_close);
+
+  CHECK_EQ(0, nghttp2_session_client_new(&session, callbacks, this));
+
+  nghttp2_session_callbacks_del(callbacks);
+}
+
+
+Http2ConnectionProcess::~Http2ConnectionProcess()
+{
+  nghttp2_session_del(session);
+}
+
+
+void Http2ConnectionProcess::initialize()
+{
+  const nghttp2_settings_entry settings[] = {
+    {NGHTTP2_SETTINGS_ENABLE_PUSH, 0},
+    {NGHTTP2_SETTINGS_INITIAL_WINDOW_SIZE, http2::STREAM_WINDOW_SIZE}};
+
+  nghttp2_submit_settings(session, NGHTTP2_FLAG_NONE, settings, 2);
+
+  nghttp2_session_set_local_window_size(
+      session, NGHTTP2_FLAG_NONE, 0, http2::CONNECTION_WINDOW_SIZE);
+
+  // This also sends the connection preface.
+  flush();
+
+  // Start the read loop on the socket. We read independently
+  // of the requests being sent in order to detect socket
+  // closure at any time.
+  read();
+}
+
+
+void Http2ConnectionProcess::finalize()
+{
+  disconnect("Connection object was destructed");
+}
+
+
+Future<Response> Http2ConnectionProcess::send(
+    const Request& request,
+    bool streamedResponse)
+{
+  if (!disconnection.future().isPending()) {
+    return Failure("Disconnected");
+  }
+
+  if (request.type == Request::PIPE) {
+    if (request.reader.isNone()) {
+      return Failure("Request reader must be set for PIPE request");
+    }
+
+    if (!request.body.empty()) {
+      return Failure("Request body must be empty for PIPE request");
+    }
+
+    if (request.headers.contains("Content-Length")) {
+      return Failure("'Content-Length' cannot be set for PIPE request");
+    }
+  }
+
+  Owned<Stream> stream(new Stream(streamedResponse));
+
+  vector<pair<string, string>> fields = {
+    {":method", request.method},
+    {":scheme",
+     socket.kind() == SocketImpl::Kind::POLL ? "http" : "https"},
+    {":authority", authority(request)},
+    {":path", path(request)}};
+
+  foreach (auto& field, http2::fields(request.headers)) {
+    fields.push_back(std::move(field));
+  }
+
+  if (request.type == Request::BODY) {
+    fields.emplace_back("content-length", stringify(request.body.size()));
+
+    stream->body.data = request.body;
+    stream->body.eof = true;
+  }
+
+  const vector<nghttp2_nv> nva = http2::nva(fields);
+  const nghttp2_data_provider provider = stream->body.provider();
+
+  const bool body =
+    request.type == Request::PIPE || !stream->body.data.empty();
+
+  int32_t id = nghttp2_submit_request(
+      session,
+      nullptr,
+      nva.data(),
+      nva.size(),
+      body ? &provider : nullptr,
+      nullptr);
+
+  if (id < 0) {
+    return Failure("Failed to send request: " + string(nghttp2_strerror(id)));
+  }
+
+  streams[id] = stream;
+
+  if (request.type == Request::PIPE) {
+    stream->pipe = request.reader.get();
+
+    stream->pipe->read()
+      .onAny(defer(self(), [this, id](const Future<string>& chunk) {
+        this->stream(id, chunk);
+      }));
+  }
+
+  Future<Response> response = stream->promise.future();
+
+  flush();
+
+  return response;
+}
+
+
+Future<Nothing> Http2ConnectionProcess::disconnect(
+    const Option<string>& message)
+{
+  Try<Nothing, SocketError> shutdown = socket.shutdown(
+      network::Socket::Shutdown::READ_WRITE);
+
+  // Fail the responses which are still pending, or still streaming.
+  foreachvalue (const Owned<Stream>& stream, streams) {
+    if (stream->writer.isSome()) {
+      stream->writer->fail(message.getOrElse("Disconnected"));
+    } else {
+      stream->promise.fail(message.getOrElse("Disconnected"));
+    }
+
+    if (stream->pipe.isSome()) {
+      stream->pipe->close();
+    }
+  }
+
+  streams.clear();
+
+  disconnection.set(Nothing());
+
+  return shutdown.isSome() ? Future<Nothing>(Nothing())
+                           : Failure(shutdown.error().message);
+}
+
+
+Future<Nothing> Http2ConnectionProcess::disconnected()
+{
+  return disconnection.future();
+}
+
+
+void Http2ConnectionProcess::stream(int32_t id, const Future<string>& chunk)
+{
+  if (!streams.contains(id)) {
+    return;
+  }
+
+  Owned<Stream> stream = streams.at(id);
+
+  CHECK_SOME(stream->pipe);
+
+  if (!chunk.isReady()) {
+    nghttp2_submit_rst_stream(session, NGHTTP2_FLAG_NONE, id, NGHTTP2_CANCEL);
+    flush();
+    return;
+  }
+
+  stream->body.append(chunk.get());
+
+  if (chunk->empty()) {
+    stream->body.eof = true;
+    stream->pipe = None();
+  } else {
+    stream->pipe->read()
+      .onAny(defer(self(), [this, id](const Future<string>& chunk) {
+        this->stream(id, chunk);
+      }));
+  }
+
+  nghttp2_session_resume_data(session, id);
+
+  flush();
+}
+
+
+void Http2ConnectionProcess::read()
+{
+  socket.recv()
+    .onAny(defer(self(), &Self::_read, lambda::_1));
+}
+
+
+void Http2ConnectionProcess::_read(const Future<string>& data)
+{
+  if (!data.isReady()) {
+    disconnect(data.isFailed() ? data.failure() : "discarded");
+    return;
+  } else if (data->empty()) {
+    disconnect(); // EOF.
+    return;
+  }
+
+  ssize_t length = nghttp2_session_mem_recv(
+      session, (const uint8_t*) data->data(), data->size());
+
+  if (length < 0) {
+    disconnect("Failed to decode HTTP/2 frames: " +
+               string(nghttp2_strerror(length)));
+    return;
+  }
+
+  flush();
+
+  if (disconnection.future().isPending()) {
+    read();
+  }
+}
+
+
+void Http2ConnectionProcess::flush()
+{
+  // Once disconnected, the bodies of the streams are gone.
+  if (!disconnection.future().isPending()) {
+    return;
+  }
+
+  string data;
+
+  while (true) {
+    const uint8_t* bytes = nullptr;
+    ssize_t length = nghttp2_session_mem_send(session, &bytes);
+
+    if (length < 0) {
+      disconnect("Failed to encode HTTP/2 frames: " +
+                 string(nghttp2_strerror(length)));
+      return;
+    } else if (length == 0) {
+      break;
+    }
+
+    data.append((const char*) bytes, length);
+  }
+
+  if (data.empty()) {
+    return;
+  }
+
+  network::Socket socket_ = socket;
+
+  sendChain = sendChain
+    .then([socket_, data]() mutable {
+      return socket_.send(data);
+    });
+
+  // If we can't write to the socket, disconnect.
+  sendChain
+    .onFailed(defer(self(), [this](const string& failure) {
+      disconnect(failure);
+    }));
+}
+
+
+int Http2ConnectionProcess::on_header(
+    nghttp2_session* session,
+    const nghttp2_frame* frame,
+    const uint8_t* _name,
+    size_t namelen,
+    const uint8_t* _value,
+    size_t valuelen,
+    uint8_t flags,
+    void* user_data)
+{
+  Http2ConnectionProcess* process =
+    static_cast<Http2ConnectionProcess*>(user_data);
+
+  const int32_t id = frame->hd.stream_id;
+
+  // Ignore trailers.
+  if (!process->streams.contains(id) ||
+      process->streams.at(id)->writer.isSome()) {
+    return 0;
+  }
+
+  Stream* stream = process->streams.at(id).get();
+
+  const string name((const char*) _name, namelen);
+  const string value((const char*) _value, valuelen);
+
+  if (name == ":status") {
+    Try<uint16_t> code = numify<uint16_t>(value);
+    if (code.isError()) {
+      return NGHTTP2_ERR_TEMPORAL_CALLBACK_FAILURE;
+    }
+
+    stream->code = code.get();
+  } else if (!strings::startsWith(name, ":")) {
+    http2::add(&stream->headers, name, value);
+  }
+
+  return 0;
+}
+
+
+int Http2ConnectionProcess::on_frame_recv(
+    nghttp2_session* session,
+    const nghttp2_frame* frame,
+    void* user_data)
+{
+  Http2ConnectionProcess* process =
+    static_cast<Http2ConnectionProcess*>(user_data);
+
+  const int32_t id = frame->hd.stream_id;
+
+  if (!process->streams.contains(id)) {
+    return 0;
+  }
+
+  Stream* stream = process->streams.at(id).get();
+
+  if (frame->hd.type == NGHTTP2_HEADERS && stream->writer.isNone()) {
+    // Skip the informational (1xx) responses.
+    if (stream->code < 200) {
+      stream->code = 0;
+      stream->headers.clear();
+      return 0;
+    }
+
+    Response response;
+    response.code = stream->code;
+    response.status = Status::string(stream->code);
+    response.headers = std::move(stream->headers);
+    response.type = Response::PIPE;
+
+    Option<string> encoding = response.headers.get("Content-Encoding");
+
+    if (encoding.isSome() && encoding.get() == "gzip") {
+      stream->decompressor =
+        Owned<gzip::Decompressor>(new gzip::Decompressor());
+    }
+
+    Pipe pipe;
+    stream->writer = pipe.writer();
+    response.reader = pipe.reader();
+
+    if (stream->streamedResponse) {
+      stream->promise.set(response);
+    } else {
+      // If the response should not be streamed, we convert
+      // the PIPE response into a BODY response.
+      stream->promise.associate(convert(response));
+    }
+  }
+
+  if ((frame->hd.type == NGHTTP2_HEADERS || frame->hd.type == NGHTTP2_DATA) &&
+      (frame->hd.flags & NGHTTP2_FLAG_END_STREAM) &&
+      stream->writer.isSome()) {
+    if (stream->decompressor.get() != nullptr &&
+        !stream->decompressor->finished()) {
+      stream->writer->fail("Failed to decompress body");
+    } else {
+      stream->writer->close();
+    }
+  }
+
+  return 0;
+}
+
+
+int Http2ConnectionProcess::on_data_chunk_recv(
+    nghttp2_session* session,
+    uint8_t flags,
+    int32_t stream_id,
+    const uint8_t* data,
+    size_t len,
+    void* user_data)
+{
+  Http2ConnectionProcess* process =
+    static_cast<Http2ConnectionProcess*>(user_data);
+
+  if (!process->streams.contains(stream_id)) {
+    return 0;
+  }
+
+  Stream* stream = process->streams.at(stream_id).get();
+
+  if (stream->writer.isNone()) {
+    return 0;
+  }
+
+  string body((const char*) data, len);
+
+  if (stream->decompressor.get() != nullptr) {
+    Try<string> decompressed = stream->decompressor->decompress(body);
+
+    if (decompressed.isError()) {
+      stream->writer->fail("Failed to decompress body");
+      return NGHTTP2_ERR_TEMPORAL_CALLBACK_FAILURE;
+    }
+
+    body = std::move(decompressed.get());
+  }
+
+  stream->writer->write(std::move(body));
+
+  return 0;
+}
+
+
+int Http2ConnectionProcess::on_stream_close(
+    nghttp2_session* session,
+    int32_t stream_id,
+    uint32_t error_code,
+    void* user_data)
+{
+  Http2ConnectionProcess* process =
+    static_cast<Http2ConnectionProcess*>(user_data);
+
+  if (!process->streams.contains(stream_id)) {
+    return 0;
+  }
+
+  Owned<Stream> stream = process->streams.at(stream_id);
+  process->streams.erase(stream_id);
+
+  const string message =
+    "Stream closed: " + string(nghttp2_http2_strerror(error_code));
+
+  // These are no-ops if the whole response has been received.
+  if (stream->writer.isSome()) {
+    stream->writer->fail(message);
+  } else {
+    stream->promise.fail(message);
+  }
+
+  if (stream->pipe.isSome()) {
+    stream->pipe->close();
+  }
+
+  return 0;
+}
+
+} // namespace internal {
+} // namespace http {
+} // namespace process {
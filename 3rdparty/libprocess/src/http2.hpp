@@ -0,0 +1,232 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License
+
+#ifndef __PROCESS_HTTP2_HPP__
+#define __PROCESS_HTTP2_HPP__
+
+#include <stdint.h>
+
+#include <nghttp2/nghttp2.h>
+
+#ifdef USE_SSL_SOCKET
+#include <openssl/ssl.h>
+#endif // USE_SSL_SOCKET
+
+#include <string>
+
+#include <process/future.hpp>
+#include <process/http.hpp>
+#include <process/owned.hpp>
+#include <process/process.hpp>
+#include <process/socket.hpp>
+
+#include <stout/hashmap.hpp>
+#include <stout/lambda.hpp>
+#include <stout/nothing.hpp>
+#include <stout/option.hpp>
+#include <stout/try.hpp>
+
+#include "http_proxy.hpp"
+
+namespace process {
+namespace http2 {
+
+// The connection preface which an HTTP/2 client starts with, whether
+// it knew beforehand that the server speaks HTTP/2 or negotiated it
+// during the TLS handshake (see RFC 7540, section 3.5). This is how
+// the server tells an HTTP/2 connection apart from an HTTP/1.1 one.
+constexpr char PREFACE[] = "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n";
+
+#ifdef USE_SSL_SOCKET
+// Configures a TLS client socket as by default, and to offer HTTP/2
+// during the handshake (ALPN, see RFC 7301).
+Try<Nothing> configure_socket(
+    SSL* ssl,
+    const network::Address& peer,
+    const Option<std::string>& servername);
+#endif // USE_SSL_SOCKET
+
+} // namespace http2 {
+
+
+// Serves the requests of an HTTP/2 connection. Each request arrives on
+// its own stream, and its response is sent on that stream as soon as
+// it is ready rather than in the order of the requests. Hence, a long
+// lived streaming response (e.g., a SUBSCRIBE call) or a slow response
+// does not hold back the responses to the other requests.
+//
+// This takes the place of the `HttpProxy` of the socket, so that the
+// `ProcessManager` hands it the responses in the same way. The bytes
+// read from the socket are fed to it through `receive`.
+class Http2Proxy : public HttpProxy
+{
+public:
+  // The `handler` is invoked with each request once its headers have
+  // been received; the body of the request is streamed through its
+  // `reader`.
+  Http2Proxy(
+      const network::inet::Socket& socket,
+      const lambda::function<void(http::Request*)>& handler);
+
+  ~Http2Proxy() override;
+
+  Future<Nothing> receive(const std::string& data);
+
+  void handle(
+      const Future<http::Response>& future,
+      const http::Request& request) override;
+
+protected:
+  void initialize() override;
+  void finalize() override;
+
+private:
+  // Starts sending the response of the stream.
+  void respond(int32_t id, const Future<http::Response>& future);
+
+  // Handles the chunks of a streamed response.
+  void stream(int32_t id, const Future<std::string>& chunk);
+
+  // Closes the stream, including any request or response body still
+  // being streamed.
+  void close(int32_t id);
+
+  // Sends whatever the session has to send.
+  void flush();
+
+  static int on_begin_headers(
+      nghttp2_session* session,
+      const nghttp2_frame* frame,
+      void* user_data);
+
+  static int on_header(
+      nghttp2_session* session,
+      const nghttp2_frame* frame,
+      const uint8_t* name,
+      size_t namelen,
+      const uint8_t* value,
+      size_t valuelen,
+      uint8_t flags,
+      void* user_data);
+
+  static int on_frame_recv(
+      nghttp2_session* session,
+      const nghttp2_frame* frame,
+      void* user_data);
+
+  static int on_data_chunk_recv(
+      nghttp2_session* session,
+      uint8_t flags,
+      int32_t stream_id,
+      const uint8_t* data,
+      size_t len,
+      void* user_data);
+
+  static int on_stream_close(
+      nghttp2_session* session,
+      int32_t stream_id,
+      uint32_t error_code,
+      void* user_data);
+
+  const lambda::function<void(http::Request*)> handler;
+
+  nghttp2_session* session;
+
+  struct Stream;
+  hashmap<int32_t, Owned<Stream>> streams;
+};
+
+
+namespace http {
+namespace internal {
+
+// The client side of an HTTP/2 `Connection`: each request is sent on
+// a new stream, and the responses complete in whatever order the
+// server sends them.
+class Http2ConnectionProcess : public Process<Http2ConnectionProcess>
+{
+public:
+  explicit Http2ConnectionProcess(const network::Socket& socket);
+
+  ~Http2ConnectionProcess() override;
+
+  Future<Response> send(const Request& request, bool streamedResponse);
+
+  Future<Nothing> disconnect(const Option<std::string>& message = None());
+
+  Future<Nothing> disconnected();
+
+protected:
+  void initialize() override;
+  void finalize() override;
+
+private:
+  // Handles the chunks of a streamed request.
+  void stream(int32_t id, const Future<std::string>& chunk);
+
+  void read();
+  void _read(const Future<std::string>& data);
+
+  // Sends whatever the session has to send.
+  void flush();
+
+  static int on_begin_headers(
+      nghttp2_session* session,
+      const nghttp2_frame* frame,
+      void* user_data);
+
+  static int on_header(
+      nghttp2_session* session,
+      const nghttp2_frame* frame,
+      const uint8_t* name,
+      size_t namelen,
+      const uint8_t* value,
+      size_t valuelen,
+      uint8_t flags,
+      void* user_data);
+
+  static int on_frame_recv(
+      nghttp2_session* session,
+      const nghttp2_frame* frame,
+      void* user_data);
+
+  static int on_data_chunk_recv(
+      nghttp2_session* session,
+      uint8_t flags,
+      int32_t stream_id,
+      const uint8_t* data,
+      size_t len,
+      void* user_data);
+
+  static int on_stream_close(
+      nghttp2_session* session,
+      int32_t stream_id,
+      uint32_t error_code,
+      void* user_data);
+
+  network::Socket socket;
+  nghttp2_session* session;
+
+  // We must chain the calls to `Socket::send` as it otherwise
+  // interleaves data across calls.
+  Future<Nothing> sendChain;
+  Promise<Nothing> disconnection;
+
+  struct Stream;
+  hashmap<int32_t, Owned<Stream>> streams;
+};
+
+} // namespace internal {
+} // namespace http {
+} // namespace process {
+
+#endif // __PROCESS_HTTP2_HPP__
@@ -209,6 +209,19 @@ bool HttpProxy::process(const Future<Response>& future, const Request& request)
     // header, we fill in (or overwrite) 'Transfer-Encoding' header.
     response.headers["Transfer-Encoding"] = "chunked";
 
+    // Compress the chunks as they get read if the client accepts it.
+    Option<string> encoding;
+    if (!response.headers.contains("Content-Encoding")) {
+      encoding = Compressor::negotiate(request);
+    }
+
+    if (encoding.isSome()) {
+      response.headers["Content-Encoding"] = encoding.get();
+      compressor = Compressor::create(encoding.get());
+    } else {
+      compressor.reset();
+    }
+
     VLOG(3) << "Starting \"chunked\" streaming";
 
     socket_manager->send(
@@ -250,30 +263,83 @@ void HttpProxy::stream(
 
   bool finished = false; // Whether we're done streaming.
 
-  if (chunk.isReady()) {
+  // The empty chunk, which ends the body, also ends the compressed
+  // stream (if any).
+  Future<string> data = chunk;
+  if (chunk.isReady() && compressor.get() != nullptr) {
+    Try<string> compressed = chunk->empty()
+      ? compressor->finish()
+      : compressor->compress(chunk.get());
+
+    if (compressed.isError()) {
+      data = Failure("Failed to compress: " + compressed.error());
+    } else {
+      data = compressed.get();
+    }
+  }
+
+  if (data.isReady()) {
     std::ostringstream out;
 
+    // NOTE: We must not send an empty chunk before the end of the
+    // body, which is marked by an empty chunk.
+    if (!data->empty()) {
+      out << std::hex << data->size() << "\r\n";
+      out << data.get();
+      out << "\r\n";
+    }
+
     if (chunk->empty()) {
       // Finished reading.
       out << "0\r\n" << "\r\n";
       finished = true;
-    } else {
-      out << std::hex << chunk->size() << "\r\n";
-      out << chunk.get();
-      out << "\r\n";
+    }
+
+    // A paced writer waits for the pipe to be drained before writing
+    // more, see `Pipe::Reader::paced()`.
+    const bool paced = reader.paced();
+
+    // Always persist the connection when streaming is not finished.
+    Future<Nothing> sent = Nothing();
+    string encoded = out.str();
+    if (!encoded.empty()) {
+      DataEncoder* encoder = nullptr;
+
+      if (paced) {
+        SentDataEncoder* sentEncoder =
+          new SentDataEncoder(std::move(encoded));
+
+        sent = sentEncoder->sent();
+        encoder = sentEncoder;
+      } else {
+        encoder = new DataEncoder(std::move(encoded));
+      }
+
+      socket_manager->send(
+          encoder,
+          finished ? request->keepAlive : true,
+          socket);
+    }
 
-      // Keep reading.
+    // Keep reading. For a paced writer we only read once the chunk
+    // has been sent, so that a slow client slows down the writer
+    // rather than the chunks piling up in the outgoing queue of the
+    // socket. Other writers (e.g., of event streams) expect their
+    // chunks to be sent right away.
+    if (!finished && paced) {
+      sent.onAny(defer(self(), [this, request](const Future<Nothing>&) {
+        CHECK_SOME(pipe);
+
+        http::Pipe::Reader reader = pipe.get();
+        reader.read()
+          .onAny(defer(self(), &Self::stream, request, lambda::_1));
+      }));
+    } else if (!finished) {
       reader.read()
         .onAny(defer(self(), &Self::stream, request, lambda::_1));
     }
-
-    // Always persist the connection when streaming is not finished.
-    socket_manager->send(
-        new DataEncoder(out.str()),
-        finished ? request->keepAlive : true,
-        socket);
-  } else if (chunk.isFailed()) {
-    VLOG(1) << "Failed to read from stream: " << chunk.failure();
+  } else if (data.isFailed()) {
+    VLOG(1) << "Failed to read from stream: " << data.failure();
     // TODO(bmahler): Have to close connection if headers were sent!
     socket_manager->send(InternalServerError(), *request, socket);
     finished = true;
@@ -287,6 +353,7 @@ void HttpProxy::stream(
   if (finished) {
     reader.close();
     pipe = None();
+    compressor.reset();
     next();
   }
 }
@@ -17,6 +17,7 @@
 
 #include <process/future.hpp>
 #include <process/http.hpp>
+#include <process/owned.hpp>
 #include <process/process.hpp>
 #include <process/socket.hpp>
 
@@ -24,6 +25,9 @@
 
 namespace process {
 
+// Forward declaration.
+class Compressor;
+
 // Provides a process that manages sending HTTP responses so as to
 // satisfy HTTP/1.1 pipelining. Each request should either enqueue a
 // response, or ask the proxy to handle a future response. The process
@@ -49,13 +53,15 @@ public:
   // Enqueues a future to a response that will get waited on (up to
   // some timeout) and then sent once all previously enqueued
   // responses have been processed (e.g., waited for and sent).
-  void handle(
+  virtual void handle(
       const Future<http::Response>& future,
       const http::Request& request);
 
 protected:
   void finalize() override;
 
+  network::inet::Socket socket; // Store the socket to keep it open.
+
 private:
   // Starts "waiting" on the next available future response.
   void next();
@@ -73,8 +79,6 @@ private:
       const Owned<http::Request>& request,
       const Future<std::string>& chunk);
 
-  network::inet::Socket socket; // Store the socket to keep it open.
-
   // Describes a queue "item" that wraps the future to the response
   // and the original request.
   // The original request contains needed information such as what encodings
@@ -91,6 +95,9 @@ private:
   std::queue<Item*> items;
 
   Option<http::Pipe::Reader> pipe; // Current pipe, if streaming.
+
+  // Compresses the current pipe, if the client accepts it.
+  Owned<Compressor> compressor;
 };
 
 } // namespace process {
@@ -12,6 +12,11 @@
 
 #include <glog/logging.h>
 
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <cmath>
 #include <map>
 #include <string>
 #include <vector>
@@ -28,6 +33,7 @@
 #include <stout/duration.hpp>
 #include <stout/error.hpp>
 #include <stout/foreach.hpp>
+#include <stout/hashset.hpp>
 #include <stout/numify.hpp>
 #include <stout/option.hpp>
 #include <stout/os.hpp>
@@ -40,6 +46,67 @@ namespace process {
 namespace metrics {
 namespace internal {
 
+namespace {
+
+// Prometheus metric names may only contain ASCII letters, digits,
+// underscores and colons (and may not start with a digit), so we
+// replace everything else, e.g., 'master/tasks_running' becomes
+// 'master_tasks_running'.
+string sanitize(const string& name)
+{
+  string sanitized = name;
+
+  for (size_t i = 0; i < sanitized.size(); ++i) {
+    const char c = sanitized[i];
+
+    if (!((c >= 'a' && c <= 'z') ||
+          (c >= 'A' && c <= 'Z') ||
+          (c >= '0' && c <= '9' && i > 0) ||
+          c == '_' ||
+          c == ':')) {
+      sanitized[i] = '_';
+    }
+  }
+
+  return sanitized;
+}
+
+
+// Appends 'value' formatted as per the Prometheus text format.
+//
+// NOTE: We use `snprintf` rather than `stringify` as this is called
+// for every sample and streams are comparatively slow. We prefer 15
+// significant digits so that, e.g., a bucket bound of 0.1 is rendered
+// as such, and only fall back to 17 if that does not round-trip.
+void append(string* out, double value)
+{
+  if (std::isnan(value)) {
+    out->append("NaN");
+  } else if (std::isinf(value)) {
+    out->append(value > 0 ? "+Inf" : "-Inf");
+  } else {
+    char buffer[32];
+    int length = ::snprintf(buffer, sizeof(buffer), "%.15g", value);
+
+    if (::strtod(buffer, nullptr) != value) {
+      length = ::snprintf(buffer, sizeof(buffer), "%.17g", value);
+    }
+
+    out->append(buffer, length);
+  }
+}
+
+
+void append(string* out, uint64_t value)
+{
+  char buffer[32];
+  int length = ::snprintf(buffer, sizeof(buffer), "%" PRIu64, value);
+  out->append(buffer, length);
+}
+
+} // namespace {
+
+
 MetricsProcess* MetricsProcess::create(
     const Option<string>& authenticationRealm)
 {
@@ -98,6 +165,11 @@ void MetricsProcess::initialize()
         authenticationRealm,
         help(),
         &MetricsProcess::_snapshot);
+
+  route("/prometheus",
+        authenticationRealm,
+        prometheusHelp(),
+        &MetricsProcess::_prometheus);
 }
 
 
@@ -118,6 +190,65 @@ string MetricsProcess::help()
 }
 
 
+string MetricsProcess::prometheusHelp()
+{
+  return HELP(
+      TLDR("Provides the current metrics in the Prometheus text format."),
+      DESCRIPTION(
+          "This endpoint provides the same metrics as '/metrics/snapshot',",
+          "rendered in the Prometheus text exposition format (version 0.0.4).",
+          "",
+          "Metric names have the characters which Prometheus does not allow",
+          "replaced with underscores, e.g., 'master/tasks_running' becomes",
+          "'master_tasks_running'. Counters are exposed as counters, timers",
+          "and histograms as histograms, and everything else as gauges.",
+          "",
+          "The optional query parameter 'timeout' determines the maximum",
+          "amount of time the endpoint will take to respond. If the timeout",
+          "is exceeded, some metrics may not be included in the response.",
+          "",
+          "This endpoint shares its rate limit with '/metrics/snapshot'."),
+      AUTHENTICATION(true));
+}
+
+
+Try<Option<Duration>> MetricsProcess::parseTimeout(const http::Request& request)
+{
+  if (!request.url.query.contains("timeout")) {
+    return None();
+  }
+
+  const string& parameter = request.url.query.at("timeout");
+
+  Try<Duration> duration = Duration::parse(parameter);
+
+  if (duration.isError()) {
+    return Error("Invalid timeout '" + parameter + "': " + duration.error());
+  }
+
+  return duration.get();
+}
+
+
+Future<Nothing> MetricsProcess::awaitAll(
+    const vector<Future<double>>& futures,
+    const Option<Duration>& timeout)
+{
+  Future<Nothing> timedout =
+    after(timeout.getOrElse(Duration::max()));
+
+  // Return once the futures complete or we time out.
+  Future<Future<Nothing>> waited =
+    select<Nothing>({
+      timedout,
+      process::await(futures).then([]{ return Nothing(); }) });
+
+  return waited
+    .onAny([=]() mutable { timedout.discard(); }) // Don't accumulate timers.
+    .then([]() { return Nothing(); });
+}
+
+
 Future<Nothing> MetricsProcess::add(Owned<Metric> metric)
 {
   bool inserted = metrics.emplace(metric->name(), metric).second;
@@ -145,6 +276,11 @@ Future<Nothing> MetricsProcess::remove(const string& name)
 Future<map<string, double>> MetricsProcess::snapshot(
     const Option<Duration>& timeout)
 {
+  // Metrics whose value can be read right away (e.g., counters and
+  // push gauges, see `Metric::peek()`) go straight into the snapshot.
+  // We only create and wait on futures for the remaining metrics.
+  map<string, double> snapshot;
+
   // To avoid creating a new vector when calling `await()` below, we use three
   // ordered vectors, where the Nth key in `keys` is associated with the Nth
   // items in each of `futures` and `statistics`.
@@ -152,36 +288,36 @@ Future<map<string, double>> MetricsProcess::snapshot(
   vector<Future<double>> futures;
   vector<Option<Statistics<double>>> statistics;
 
-  keys.reserve(metrics.size());
-  futures.reserve(metrics.size());
-  statistics.reserve(metrics.size());
-
   for (auto iter = metrics.begin(); iter != metrics.end(); ++iter) {
-    keys.emplace_back(iter->first);
-    futures.emplace_back(iter->second->value());
-    statistics.emplace_back(iter->second->statistics());
+    Option<double> value = iter->second->peek();
+
+    if (value.isSome()) {
+      insert(snapshot, iter->first, value, iter->second->statistics());
+    } else {
+      keys.emplace_back(iter->first);
+      futures.emplace_back(iter->second->value());
+      statistics.emplace_back(iter->second->statistics());
+    }
   }
 
-  Future<Nothing> timedout =
-    after(timeout.getOrElse(Duration::max()));
+  // Don't bother setting up a timer if there is nothing to wait for.
+  if (futures.empty()) {
+    return snapshot;
+  }
 
   // Return the response once it finishes or we time out.
   //
-  // NOTE: We assign the result of `select()` to a local variable to ensure that
-  // the `await()` call in this expression is evaluated before the call to
-  // `std::move(futures)` in the subsequent expression. Otherwise, it's possible
-  // that the `move()` could be evaluated first, causing an empty vector to be
-  // passed into `await()`.
-  Future<Future<Nothing>> waited =
-    select<Nothing>({
-      timedout,
-      await(futures).then([]{ return Nothing(); }) });
+  // NOTE: We assign the result of `awaitAll()` to a local variable to ensure
+  // that it is evaluated before the call to `std::move(futures)` in the
+  // subsequent expression. Otherwise, it's possible that the `move()` could
+  // be evaluated first, causing an empty vector to be passed into `await()`.
+  Future<Nothing> waited = awaitAll(futures, timeout);
 
   return waited
-    .onAny([=]() mutable { timedout.discard(); }) // Don't accumulate timers.
     .then(defer(self(),
                 &Self::__snapshot,
                 timeout,
+                std::move(snapshot),
                 std::move(keys),
                 std::move(futures),
                 std::move(statistics)));
@@ -192,20 +328,10 @@ Future<http::Response> MetricsProcess::_snapshot(
     const http::Request& request,
     const Option<http::authentication::Principal>&)
 {
-  // Parse the 'timeout' parameter.
-  Option<Duration> timeout;
-
-  if (request.url.query.contains("timeout")) {
-    string parameter = request.url.query.at("timeout");
-
-    Try<Duration> duration = Duration::parse(parameter);
-
-    if (duration.isError()) {
-      return http::BadRequest(
-          "Invalid timeout '" + parameter + "': " + duration.error() + ".\n");
-    }
+  Try<Option<Duration>> timeout = parseTimeout(request);
 
-    timeout = duration.get();
+  if (timeout.isError()) {
+    return http::BadRequest(timeout.error() + ".\n");
   }
 
   Future<Nothing> acquire = Nothing();
@@ -214,7 +340,7 @@ Future<http::Response> MetricsProcess::_snapshot(
     acquire = limiter.get()->acquire();
   }
 
-  return acquire.then(defer(self(), &Self::snapshot, timeout))
+  return acquire.then(defer(self(), &Self::snapshot, timeout.get()))
       .then([request](const map<string, double>& metrics)
             -> http::Response {
         return http::OK(jsonify(metrics), request.url.query.get("jsonp"));
@@ -222,44 +348,189 @@ Future<http::Response> MetricsProcess::_snapshot(
 }
 
 
+Future<http::Response> MetricsProcess::_prometheus(
+    const http::Request& request,
+    const Option<http::authentication::Principal>&)
+{
+  Try<Option<Duration>> timeout = parseTimeout(request);
+
+  if (timeout.isError()) {
+    return http::BadRequest(timeout.error() + ".\n");
+  }
+
+  Future<Nothing> acquire = Nothing();
+
+  if (limiter.isSome()) {
+    acquire = limiter.get()->acquire();
+  }
+
+  return acquire.then(defer(self(), &Self::prometheus, timeout.get()));
+}
+
+
+Future<http::Response> MetricsProcess::prometheus(
+    const Option<Duration>& timeout)
+{
+  vector<Sample> samples;
+  samples.reserve(metrics.size());
+
+  // The indices of the samples whose value we have to wait for, and
+  // the corresponding futures.
+  vector<size_t> pending;
+  vector<Future<double>> futures;
+
+  for (auto iter = metrics.begin(); iter != metrics.end(); ++iter) {
+    const Owned<Metric>& metric = iter->second;
+
+    Sample sample;
+    sample.name = iter->first;
+    sample.type = metric->type();
+
+    if (sample.type == Metric::Type::HISTOGRAM) {
+      sample.distribution = metric->distribution();
+    } else {
+      sample.value = metric->peek();
+
+      if (sample.value.isNone()) {
+        pending.push_back(samples.size());
+        futures.push_back(metric->value());
+      }
+    }
+
+    samples.push_back(std::move(sample));
+  }
+
+  if (futures.empty()) {
+    return __prometheus(
+        std::move(samples), std::move(pending), std::move(futures));
+  }
+
+  // NOTE: See `snapshot()` for why `awaitAll()` is evaluated first.
+  Future<Nothing> waited = awaitAll(futures, timeout);
+
+  return waited
+    .then(defer(self(),
+                &Self::__prometheus,
+                std::move(samples),
+                std::move(pending),
+                std::move(futures)));
+}
+
+
+Future<http::Response> MetricsProcess::__prometheus(
+    vector<Sample>&& samples,
+    vector<size_t>&& pending,
+    vector<Future<double>>&& futures)
+{
+  for (size_t i = 0; i < pending.size(); ++i) {
+    if (futures[i].isReady()) {
+      samples[pending[i]].value = futures[i].get();
+    }
+  }
+
+  // The text is rendered directly from the samples, without building
+  // an intermediate document. Names are sanitized, so different names
+  // might end up being the same, in which case we only keep the first
+  // one since Prometheus rejects duplicate metrics.
+  string body;
+  body.reserve(samples.size() * 96);
+
+  hashset<string> names;
+
+  foreach (const Sample& sample, samples) {
+    if (sample.value.isNone() && sample.distribution.isNone()) {
+      continue;
+    }
+
+    const string name = sanitize(sample.name);
+
+    if (names.contains(name)) {
+      VLOG(1) << "Skipping metric '" << sample.name << "' as its Prometheus"
+              << " name '" << name << "' is already used";
+      continue;
+    }
+
+    names.insert(name);
+
+    body.append("# TYPE ").append(name);
+
+    switch (sample.type) {
+      case Metric::Type::COUNTER:
+        body.append(" counter\n");
+        break;
+      case Metric::Type::GAUGE:
+        body.append(" gauge\n");
+        break;
+      case Metric::Type::HISTOGRAM:
+        body.append(" histogram\n");
+        break;
+    }
+
+    if (sample.distribution.isNone()) {
+      body.append(name).append(" ");
+      append(&body, sample.value.get());
+      body.append("\n");
+      continue;
+    }
+
+    const Distribution& distribution = sample.distribution.get();
+
+    // Prometheus buckets are cumulative.
+    uint64_t cumulative = 0;
+
+    for (size_t i = 0; i < distribution.counts.size(); ++i) {
+      cumulative += distribution.counts[i];
+
+      body.append(name).append("_bucket{le=\"");
+
+      if (i < distribution.bounds.size()) {
+        append(&body, distribution.bounds[i]);
+      } else {
+        body.append("+Inf");
+      }
+
+      body.append("\"} ");
+      append(&body, cumulative);
+      body.append("\n");
+    }
+
+    body.append(name).append("_sum ");
+    append(&body, distribution.sum);
+    body.append("\n");
+
+    body.append(name).append("_count ");
+    append(&body, distribution.count);
+    body.append("\n");
+  }
+
+  return http::OK(std::move(body), "text/plain; version=0.0.4; charset=utf-8");
+}
+
+
 Future<map<string, double>> MetricsProcess::__snapshot(
     const Option<Duration>& timeout,
+    map<string, double>&& snapshot,
     vector<string>&& keys,
     vector<Future<double>>&& metrics,
     vector<Option<Statistics<double>>>&& statistics)
 {
-  map<string, double> snapshot;
-
   for (size_t i = 0; i < metrics.size(); ++i) {
     // TODO(dhamon): Maybe add the failure message for this metric to the
     // response if value.isFailed().
     const string& key = keys[i];
     const Future<double>& value = metrics[i];
 
+    Option<double> value_;
+
     if (value.isPending()) {
       CHECK_SOME(timeout);
       VLOG(1) << "Exceeded timeout of " << timeout.get()
               << " when attempting to get metric '" << key << "'";
     } else if (value.isReady()) {
-      snapshot.emplace_hint(snapshot.end(), key, value.get());
+      value_ = value.get();
     }
 
-    if (statistics[i].isSome()) {
-      Statistics<double>& statistics_ = statistics[i].get();
-      snapshot.emplace_hint(
-          snapshot.end(),
-          key + "/count",
-          static_cast<double>(statistics_.count));
-      // TODO(alexr): Consider exposing p25 and p75 percentiles.
-      snapshot.emplace_hint(snapshot.end(), key + "/max", statistics_.max);
-      snapshot.emplace_hint(snapshot.end(), key + "/min", statistics_.min);
-      snapshot.emplace_hint(snapshot.end(), key + "/p50", statistics_.p50);
-      snapshot.emplace_hint(snapshot.end(), key + "/p90", statistics_.p90);
-      snapshot.emplace_hint(snapshot.end(), key + "/p95", statistics_.p95);
-      snapshot.emplace_hint(snapshot.end(), key + "/p99", statistics_.p99);
-      snapshot.emplace_hint(snapshot.end(), key + "/p999", statistics_.p999);
-      snapshot.emplace_hint(snapshot.end(), key + "/p9999", statistics_.p9999);
-    }
+    insert(snapshot, key, value_, statistics[i]);
   }
 
   // NOTE: Newer compilers (clang-3.9 and gcc-5.1) can perform
@@ -268,6 +539,31 @@ Future<map<string, double>> MetricsProcess::__snapshot(
   return std::move(snapshot);
 }
 
+
+void MetricsProcess::insert(
+    map<string, double>& snapshot,
+    const string& key,
+    const Option<double>& value,
+    const Option<Statistics<double>>& statistics)
+{
+  if (value.isSome()) {
+    snapshot.emplace(key, value.get());
+  }
+
+  if (statistics.isSome()) {
+    snapshot.emplace(key + "/count", static_cast<double>(statistics->count));
+    // TODO(alexr): Consider exposing p25 and p75 percentiles.
+    snapshot.emplace(key + "/max", statistics->max);
+    snapshot.emplace(key + "/min", statistics->min);
+    snapshot.emplace(key + "/p50", statistics->p50);
+    snapshot.emplace(key + "/p90", statistics->p90);
+    snapshot.emplace(key + "/p95", statistics->p95);
+    snapshot.emplace(key + "/p99", statistics->p99);
+    snapshot.emplace(key + "/p999", statistics->p999);
+    snapshot.emplace(key + "/p9999", statistics->p9999);
+  }
+}
+
 }  // namespace internal {
 
 }  // namespace metrics {
@@ -32,6 +32,7 @@
 #include <openssl/x509v3.h>
 
 #include <map>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <thread>
@@ -41,9 +42,11 @@
 #include <process/ssl/flags.hpp>
 #include <process/ssl/tls_config.hpp>
 
+#include <stout/cache.hpp>
 #include <stout/os.hpp>
 #include <stout/strings.hpp>
 #include <stout/stopwatch.hpp>
+#include <stout/synchronized.hpp>
 #include <stout/try.hpp>
 
 #ifdef __WINDOWS__
@@ -63,6 +66,10 @@
 // function in favor of `ASN1_STRING_get0_data()`. (OpenSSL 1.1.0)
 #define MIN_VERSION_ASN1_STRING_GET0 0x10100000L
 
+// Smallest OpenSSL version number that exports `SSL_SESSION_dup()`.
+// (OpenSSL 1.1.1)
+#define MIN_VERSION_SSL_SESSION_DUP 0x10101000L
+
 #if OPENSSL_VERSION_NUMBER < MIN_VERSION_ASN1_STRING_GET0
 #  define ASN1_STRING_get0_data ASN1_STRING_data
 #endif
@@ -225,6 +232,22 @@ Flags::Flags()
       "enable_tls_v1_3",
       "Enable TLSv1.3.",
       false);
+
+  add(&Flags::enable_ktls,
+      "enable_ktls",
+      "Hand the encryption of connections over to the kernel (kTLS) after "
+      "the handshake, so that sending a file or a buffer does not copy and "
+      "encrypt it in user space. This is only done if the kernel supports "
+      "the negotiated cipher, and requires OpenSSL 3.0 or higher built "
+      "with kTLS support.",
+      false);
+
+  add(&Flags::session_cache_size,
+      "session_cache_size",
+      "Maximum number of sessions of outgoing connections which are cached "
+      "so that reconnecting to the same server resumes the session rather "
+      "than doing a full handshake. Zero disables session resumption.",
+      1024);
 }
 
 
@@ -238,6 +261,16 @@ const Flags& flags()
 }
 
 
+// Sessions of outgoing connections by peer (see `resume_session`),
+// or null if session resumption is disabled.
+static Cache<string, std::shared_ptr<SSL_SESSION>>* sessions = nullptr;
+static std::mutex* sessions_mutex = new std::mutex();
+
+// Index of the peer of an outgoing connection in the "ex data" of its
+// SSL object, which tells the session callback where to cache it.
+static int peer_index = -1;
+
+
 // Mutexes necessary to support OpenSSL locking on shared data
 // structures. See 'locking_function' for more information.
 static std::mutex* mutexes = nullptr;
@@ -432,6 +465,88 @@ static Try<Nothing> initialize_ecdh_curve(SSL_CTX* ctx, const Flags& ssl_flags)
 }
 #endif // OPENSSL_VERSION_NUMBER >= 0x0090800fL && !OPENSSL_NO_ECDH
 
+
+// Frees the peer stored in the "ex data" of an SSL object.
+static void free_peer(
+    void* /*parent*/,
+    void* peer,
+    CRYPTO_EX_DATA* /*data*/,
+    int /*index*/,
+    long /*argl*/,
+    void* /*argp*/)
+{
+  delete static_cast<string*>(peer);
+}
+
+
+// OpenSSL callback for a new session of an outgoing connection. With
+// TLS 1.3 this is called once the server sends a ticket, which can be
+// after the handshake.
+static int cache_session(SSL* ssl, SSL_SESSION* session)
+{
+  const string* peer = static_cast<string*>(SSL_get_ex_data(ssl, peer_index));
+  if (peer == nullptr) {
+    return 0;
+  }
+
+#if OPENSSL_VERSION_NUMBER >= MIN_VERSION_SSL_SESSION_DUP
+  // OpenSSL marks the session of a connection which is freed without a
+  // TLS shutdown as not resumable, which is how most connections end,
+  // so we cache a copy of the session instead of the session itself.
+  SSL_SESSION* cached = SSL_SESSION_dup(session);
+  if (cached == nullptr) {
+    return 0;
+  }
+#else
+  SSL_SESSION* cached = session;
+#endif // OPENSSL_VERSION_NUMBER >= MIN_VERSION_SSL_SESSION_DUP
+
+  synchronized (sessions_mutex) {
+    if (sessions == nullptr) {
+#if OPENSSL_VERSION_NUMBER >= MIN_VERSION_SSL_SESSION_DUP
+      SSL_SESSION_free(cached);
+#endif // OPENSSL_VERSION_NUMBER >= MIN_VERSION_SSL_SESSION_DUP
+      return 0;
+    }
+
+    sessions->put(
+        *peer,
+        std::shared_ptr<SSL_SESSION>(cached, &SSL_SESSION_free));
+  }
+
+  // Tells OpenSSL whether we took over its reference to the session.
+  return cached == session ? 1 : 0;
+}
+
+
+#ifdef USE_HTTP2
+// Selects HTTP/2 during the handshake (ALPN, see RFC 7301) if the
+// client offers it, and HTTP/1.1 otherwise. Either way, the server
+// tells the protocol of a connection by the first bytes it receives.
+static int select_alpn(
+    SSL* ssl,
+    const unsigned char** out,
+    unsigned char* outlen,
+    const unsigned char* in,
+    unsigned int inlen,
+    void* arg)
+{
+  static const unsigned char protocols[] = "\x02h2\x08http/1.1";
+
+  if (SSL_select_next_proto(
+          const_cast<unsigned char**>(out),
+          outlen,
+          protocols,
+          sizeof(protocols) - 1,
+          in,
+          inlen) != OPENSSL_NPN_NEGOTIATED) {
+    return SSL_TLSEXT_ERR_NOACK;
+  }
+
+  return SSL_TLSEXT_ERR_OK;
+}
+#endif // USE_HTTP2
+
 // Tests can declare this function and use it to re-configure the SSL
 // environment variables programatically. Without explicitly declaring
 // this function, it is not visible. This is the preferred behavior as
@@ -513,6 +628,9 @@ void reinitialize()
     CRYPTO_set_dynlock_lock_callback(&dyn_lock_function);
     CRYPTO_set_dynlock_destroy_callback(&dyn_destroy_function);
 
+    peer_index = SSL_get_ex_new_index(0, nullptr, nullptr, nullptr, &free_peer);
+    CHECK_NE(-1, peer_index) << "Failed to allocate SSL ex data index";
+
     initialized_single_entry->done();
   }
 
@@ -529,12 +647,35 @@ void reinitialize()
   CHECK(ctx) << "Failed to create SSL context: "
              << ERR_error_string(ERR_get_error(), nullptr);
 
-  // Disable SSL session caching.
-  SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_OFF);
+  // We do not cache the sessions of incoming connections, since the
+  // server resumes them through session tickets (see RFC 5077 and
+  // RFC 8446, section 2.2) which the clients hold on to. We cache
+  // the sessions of outgoing connections ourselves, by peer rather
+  // than in the internal cache (see `resume_session`).
+  //
+  // NOTE: The previous sessions are bound to the previous context.
+  synchronized (sessions_mutex) {
+    delete sessions;
+    sessions = nullptr;
+
+    if (ssl_flags->session_cache_size > 0) {
+      sessions = new Cache<string, std::shared_ptr<SSL_SESSION>>(
+          ssl_flags->session_cache_size);
+    }
+  }
+
+  if (ssl_flags->session_cache_size > 0) {
+    SSL_CTX_set_session_cache_mode(
+        ctx, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+
+    SSL_CTX_sess_set_new_cb(ctx, &cache_session);
+  } else {
+    SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_OFF);
+  }
 
-  // Set a session id to avoid connection termination upon
-  // re-connect. We can use something more relevant when we care
-  // about session caching.
+  // Set a session id to avoid connection termination upon re-connect,
+  // which also lets the server resume sessions when it requires client
+  // certificates.
   const uint64_t session_ctx = 7;
 
   const unsigned char* session_id =
@@ -807,6 +948,23 @@ void reinitialize()
     EXIT(EXIT_FAILURE) << ecdh_initialized.error();
   }
 #endif // OPENSSL_VERSION_NUMBER >= 0x0090800fL && !OPENSSL_NO_ECDH
+
+#ifdef USE_HTTP2
+  SSL_CTX_set_alpn_select_cb(ctx, &select_alpn, nullptr);
+#endif // USE_HTTP2
+
+  if (ssl_flags->enable_ktls) {
+#ifdef SUPPORTS_KTLS
+    // NOTE: OpenSSL only enables kTLS for a connection if it reads and
+    // writes the socket itself, see `OpenSSLSocketImpl`.
+    SSL_CTX_set_options(ctx, SSL_OP_ENABLE_KTLS);
+
+    LOG(INFO) << "Will offload TLS encryption to the kernel where supported";
+#else
+    LOG(WARNING) << "Ignoring LIBPROCESS_SSL_ENABLE_KTLS, as the linked "
+                 << "OpenSSL does not support kTLS";
+#endif // SUPPORTS_KTLS
+  }
 }
 
 
@@ -833,6 +991,40 @@ SSL_CTX* context()
 }
 
 
+void resume_session(SSL* ssl, const string& peer)
+{
+  if (SSL_get_SSL_CTX(ssl) != ctx) {
+    return;
+  }
+
+  synchronized (sessions_mutex) {
+    if (sessions == nullptr) {
+      return;
+    }
+
+    // NOTE: OpenSSL frees the peer along with the SSL object.
+    SSL_set_ex_data(ssl, peer_index, new string(peer));
+
+    Option<std::shared_ptr<SSL_SESSION>> session = sessions->get(peer);
+    if (session.isSome()) {
+#if OPENSSL_VERSION_NUMBER >= MIN_VERSION_SSL_SESSION_DUP
+      // The connection gets a copy of the session as well, so that the
+      // cached session stays resumable however the connection ends
+      // (see `cache_session`).
+      SSL_SESSION* copy = SSL_SESSION_dup(session->get());
+      if (copy != nullptr) {
+        SSL_set_session(ssl, copy);
+        SSL_SESSION_free(copy);
+      }
+#else
+      // NOTE: This takes its own reference to the session.
+      SSL_set_session(ssl, session->get());
+#endif // OPENSSL_VERSION_NUMBER >= MIN_VERSION_SSL_SESSION_DUP
+    }
+  }
+}
+
+
 Try<Nothing> verify(
     const SSL* const ssl,
     Mode mode,
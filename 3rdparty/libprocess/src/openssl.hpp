@@ -32,6 +32,14 @@
 
 #include <process/ssl/tls_config.hpp>
 
+// OpenSSL 3.0 can hand the encryption of a connection over to the
+// kernel after the handshake (kTLS), if it was built with it.
+#if defined(__linux__) && \
+    defined(SSL_OP_ENABLE_KTLS) && \
+    !defined(OPENSSL_NO_KTLS)
+#define SUPPORTS_KTLS
+#endif
+
 namespace process {
 namespace network {
 namespace openssl {
@@ -59,6 +67,8 @@ namespace openssl {
 //    LIBPROCESS_SSL_ENABLE_TLS_V1_2=(false|0,true|1)
 //    LIBPROCESS_SSL_ENABLE_TLS_V1_3=(false|0,true|1)
 //    LIBPROCESS_SSL_ECDH_CURVES=(auto|list of curves separated by ':')
+//    LIBPROCESS_SSL_ENABLE_KTLS=(false|0,true|1)
+//    LIBPROCESS_SSL_SESSION_CACHE_SIZE=(1024)
 //
 // TODO(benh): When/If we need to support multiple contexts in the
 // same process, for example for Server Name Indication (SNI), then
@@ -95,6 +105,17 @@ Try<Nothing> configure_socket(
     const Address& peer,
     const Option<std::string>& peer_hostname);
 
+
+// Sets up the SSL object of an outbound connection to resume the
+// session cached for the peer, if any, rather than doing a full
+// handshake. The session which the peer issues on this connection is
+// cached in turn. The `peer` identifies the server, e.g., by its name
+// and address.
+//
+// NOTE: This does nothing unless the SSL object uses the _global_
+// context and session caching is enabled.
+void resume_session(SSL* ssl, const std::string& peer);
+
 } // namespace openssl {
 } // namespace network {
 } // namespace process {
@@ -0,0 +1,100 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License
+
+#ifndef __PROCESS_POSIX_EVENT_LOOPS_HPP__
+#define __PROCESS_POSIX_EVENT_LOOPS_HPP__
+
+#include <glog/logging.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+
+#include <stout/exit.hpp>
+#include <stout/numify.hpp>
+#include <stout/option.hpp>
+#include <stout/try.hpp>
+
+#include <stout/os/getenv.hpp>
+
+// Helpers shared by the event loop implementations which run one or
+// more event loops, each on its own thread (libev and io_uring).
+
+namespace process {
+namespace internal {
+
+// We need a latch (available in C++20 but not in C++11) to
+// wait for all loops to finish, so define a simple one here.
+// To keep this simple, this only allows 1 triggering thread
+// and 1 waiting thread.
+//
+// TODO(bmahler): Replace this with std::latch in C++20.
+class Latch
+{
+public:
+  void trigger()
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    triggered = true;
+    condition.notify_all();
+  }
+
+  void wait()
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!triggered) {
+      condition.wait(lock);
+    }
+  }
+
+private:
+  std::mutex mutex;
+  std::condition_variable condition;
+  bool triggered = false;
+};
+
+
+// Returns the number of event loops to run, which can be overridden
+// through the environment variable `env_var`. The `name` of the
+// event loop implementation is only used for logging.
+inline size_t num_event_loops(const char* env_var, const std::string& name)
+{
+  // TODO(bmahler): Since this is a new feature, we stick to the
+  // old behavior of a single event loop thread. But, once this
+  // code is known to be stable and helpful, we can consider
+  // increasing the default.
+  size_t num_loops = 1;
+
+  // TODO(bmahler): Load this via a Flag object to eliminate this boilerplate.
+  Option<std::string> value = os::getenv(env_var);
+  if (value.isSome()) {
+    constexpr size_t maxval = 1024;
+    Try<size_t> number = numify<size_t>(value->c_str());
+    if (number.isSome() && number.get() > 0 && number.get() <= maxval) {
+      VLOG(1) << "Overriding default number of " << name << " io threads"
+              << " (" << num_loops << "), using the value "
+              << env_var << "=" << *number << " instead";
+      num_loops = number.get();
+    } else {
+      EXIT(EXIT_FAILURE)
+          << "Invalid value '" << value.get() << "' for " << env_var
+          << "; Valid values are integers in the range 1 to " << maxval;
+    }
+  }
+
+  return num_loops;
+}
+
+} // namespace internal {
+} // namespace process {
+
+#endif // __PROCESS_POSIX_EVENT_LOOPS_HPP__
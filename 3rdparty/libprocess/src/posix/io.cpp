@@ -26,6 +26,10 @@
 
 #include "io_internal.hpp"
 
+#ifdef USE_IO_URING
+#include "posix/io_uring/io_uring.hpp"
+#endif // USE_IO_URING
+
 namespace process {
 namespace io {
 namespace internal {
@@ -38,6 +42,11 @@ Future<size_t> read(int_fd fd, void* data, size_t size)
     return 0;
   }
 
+#ifdef USE_IO_URING
+  // The read is submitted to the event loop, rather than waiting for
+  // it to poll the file descriptor before reading.
+  return uring::read(fd, data, size);
+#else
   return loop(
       None(),
       [=]() -> Future<Option<size_t>> {
@@ -77,6 +86,7 @@ Future<size_t> read(int_fd fd, void* data, size_t size)
         }
         return Break(length.get());
       });
+#endif // USE_IO_URING
 }
 
 
@@ -88,6 +98,9 @@ Future<size_t> write(int_fd fd, const void* data, size_t size)
     return 0;
   }
 
+#ifdef USE_IO_URING
+  return uring::write(fd, data, size);
+#else
   return loop(
       None(),
       [=]() -> Future<Option<size_t>> {
@@ -121,6 +134,7 @@ Future<size_t> write(int_fd fd, const void* data, size_t size)
         }
         return Break(length.get());
       });
+#endif // USE_IO_URING
 }
 
 
@@ -0,0 +1,664 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License
+
+#include <poll.h>
+
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <process/io.hpp>
+#include <process/loop.hpp>
+
+#include <stout/duration.hpp>
+#include <stout/error.hpp>
+#include <stout/foreach.hpp>
+#include <stout/lambda.hpp>
+#include <stout/nothing.hpp>
+#include <stout/stringify.hpp>
+
+#include <stout/os/close.hpp>
+#include <stout/os/socket.hpp>
+#include <stout/os/strerror.hpp>
+
+#include "event_loop.hpp"
+#include "io_uring.hpp"
+
+#include "posix/event_loops.hpp"
+
+using std::thread;
+using std::vector;
+
+namespace process {
+
+// Number of entries of the submission queue of each ring. The
+// completion queue is twice as large, and the kernel keeps the
+// completions which overflow it (`IORING_FEAT_NODROP`).
+constexpr unsigned RING_ENTRIES = 1024;
+
+size_t num_loops = 1L;
+
+UringLoop* loops = nullptr;
+
+internal::Latch* loop_destroy_latch = nullptr;
+
+thread_local UringLoop* _in_event_loop_ = nullptr;
+
+
+LoopIndex get_loop(int_fd fd)
+{
+  return LoopIndex(static_cast<size_t>(fd) % num_loops);
+}
+
+
+void notify(UringLoop* loop)
+{
+  if (!loop->notified.exchange(true)) {
+    CHECK_EQ(0, eventfd_write(loop->eventfd, 1))
+      << "Failed to interrupt the event loop: " << os::strerror(errno);
+  }
+}
+
+
+namespace uring {
+
+// Returns the poll mask for the given `io::poll` events.
+static unsigned poll_mask(short events)
+{
+  unsigned mask = 0;
+
+  if ((events & io::READ) != 0) {
+    mask |= POLLIN;
+  }
+
+  if ((events & io::WRITE) != 0) {
+    mask |= POLLOUT;
+  }
+
+  return mask;
+}
+
+
+// Returns `count` consecutive submission queue entries, submitting
+// what was queued so far if the queue is too full for them.
+static struct io_uring_sqe* get_sqe(UringLoop* loop, unsigned count = 1)
+{
+  while (loop->ring.space() < count) {
+    int result = loop->ring.submit();
+
+    if (result == -EBUSY || result == -EAGAIN) {
+      // The kernel does not take more submissions until we make room
+      // in the (overflown) completion queue. Since we may be within
+      // the callback of a completion, we only take the completions
+      // out of the queue here, and leave running their callbacks to
+      // the loop (see `complete`).
+      loop->ring.reap(&loop->reaped);
+    } else if (result < 0 && result != -EINTR) {
+      LOG(FATAL) << "Failed to submit to io_uring: " << os::strerror(-result);
+    }
+  }
+
+  return CHECK_NOTNULL(loop->ring.sqe());
+}
+
+
+uint64_t submit(
+    UringLoop* loop,
+    const lambda::function<void(struct io_uring_sqe*)>& prepare,
+    const lambda::function<void(int)>& completed,
+    short poll)
+{
+  CHECK_EQ(_in_event_loop_, loop);
+
+  const uint64_t id = loop->next_id++;
+
+  if (poll == 0) {
+    struct io_uring_sqe* sqe = get_sqe(loop);
+    prepare(sqe);
+    sqe->user_data = id;
+
+    loop->operations[id] = {completed, id};
+    return id;
+  }
+
+  // The poll and the operation must be submitted together for the
+  // link to hold, hence we get both entries at once.
+  struct io_uring_sqe* sqe = get_sqe(loop, 2);
+  struct io_uring_sqe* next = CHECK_NOTNULL(loop->ring.sqe());
+
+  prepare(next);
+  next->user_data = id;
+
+  // NOTE: The poll completes without a callback, and if it fails (or
+  // is cancelled) the kernel cancels the operation.
+  const uint64_t head = loop->next_id++;
+
+  io_uring_prep_poll_add(sqe, next->fd, poll_mask(poll));
+  sqe->user_data = head;
+  sqe->flags |= IOSQE_IO_LINK;
+
+  loop->operations[head] = {nullptr, head};
+  loop->operations[id] = {completed, head};
+  return id;
+}
+
+
+void cancel(UringLoop* loop, uint64_t id)
+{
+  CHECK_EQ(_in_event_loop_, loop);
+
+  auto operation = loop->operations.find(id);
+  if (operation == loop->operations.end()) {
+    return; // Already completed.
+  }
+
+  // Cancelling the poll which the operation waits for also cancels
+  // the operation, unless the poll already completed.
+  uint64_t target = id;
+  if (loop->operations.count(operation->second.head) > 0) {
+    target = operation->second.head;
+  }
+
+  // NOTE: The cancellation itself completes with a zero id, which we
+  // never give to an operation, hence it has no callback.
+  struct io_uring_sqe* sqe = get_sqe(loop);
+  io_uring_prep_cancel(sqe, reinterpret_cast<void*>(target), 0);
+  sqe->user_data = 0;
+}
+
+
+Future<int> execute(
+    int_fd fd,
+    const lambda::function<void(struct io_uring_sqe*)>& prepare,
+    short poll)
+{
+  const LoopIndex index = get_loop(fd);
+
+  return run_in_event_loop<int>(
+      index,
+      [=](UringLoop* loop) -> Future<int> {
+        std::shared_ptr<Promise<int>> promise(new Promise<int>());
+
+        Future<int> future = promise->future();
+
+        const uint64_t id = submit(
+            loop,
+            prepare,
+            [promise](int result) {
+              // NOTE: A cancelled operation fails with `ECANCELED`, or
+              // `EINTR` if the kernel already started it.
+              if (result < 0 && promise->future().hasDiscard()) {
+                promise->discard();
+              } else {
+                promise->set(result);
+              }
+            },
+            poll);
+
+        // We only discard the future once the operation completes,
+        // since the kernel may use its buffers until then.
+        future.onDiscard([index, id]() {
+          run_in_event_loop<Nothing>(
+              index,
+              [id](UringLoop* loop) -> Future<Nothing> {
+                cancel(loop, id);
+                return Nothing();
+              });
+        });
+
+        return future;
+      });
+}
+
+
+// Submits an operation which transfers data, until it does not fail
+// with `EAGAIN` or `EINTR`.
+//
+// NOTE: Since file descriptors are non-blocking (see
+// `io::prepare_async`), operations on them can fail with `EAGAIN`
+// rather than wait for them to become ready. We then retry the
+// operation linked to a poll, which still takes a single submission.
+static Future<size_t> transfer(
+    int_fd fd,
+    const lambda::function<void(struct io_uring_sqe*)>& prepare,
+    short events)
+{
+  std::shared_ptr<short> poll(new short(0));
+
+  return loop(
+      None(),
+      [=]() {
+        return execute(fd, prepare, *poll);
+      },
+      [=](int result) -> Future<ControlFlow<size_t>> {
+        if (result >= 0) {
+          return Break(static_cast<size_t>(result));
+        }
+
+        if (result == -EAGAIN || result == -EWOULDBLOCK) {
+          *poll = events;
+          return Continue();
+        }
+
+        if (result == -EINTR) {
+          return Continue();
+        }
+
+        return Failure(os::strerror(-result));
+      });
+}
+
+
+// Returns the length of a single transfer, since the result of an
+// operation is an `int`.
+static unsigned length(size_t size)
+{
+  return static_cast<unsigned>(
+      std::min<size_t>(size, std::numeric_limits<int>::max()));
+}
+
+
+Future<size_t> read(int_fd fd, void* data, size_t size)
+{
+  if (size == 0) {
+    return 0;
+  }
+
+  // NOTE: An offset of -1 reads from (and advances) the current
+  // position of the file, as `read` does.
+  return transfer(
+      fd,
+      [=](struct io_uring_sqe* sqe) {
+        io_uring_prep_read(sqe, fd, data, length(size), -1);
+      },
+      io::READ);
+}
+
+
+Future<size_t> write(int_fd fd, const void* data, size_t size)
+{
+  if (size == 0) {
+    return 0;
+  }
+
+  return transfer(
+      fd,
+      [=](struct io_uring_sqe* sqe) {
+        io_uring_prep_write(sqe, fd, data, length(size), -1);
+      },
+      io::WRITE);
+}
+
+
+Future<size_t> recv(int_fd fd, void* data, size_t size)
+{
+  if (size == 0) {
+    return 0;
+  }
+
+  return transfer(
+      fd,
+      [=](struct io_uring_sqe* sqe) {
+        io_uring_prep_recv(sqe, fd, data, length(size), 0);
+      },
+      io::READ);
+}
+
+
+Future<size_t> send(int_fd fd, const void* data, size_t size)
+{
+  if (size == 0) {
+    return 0;
+  }
+
+  return transfer(
+      fd,
+      [=](struct io_uring_sqe* sqe) {
+        io_uring_prep_send(sqe, fd, data, length(size), MSG_NOSIGNAL);
+      },
+      io::WRITE);
+}
+
+
+Future<int_fd> accept(int_fd fd)
+{
+  std::shared_ptr<short> poll(new short(0));
+
+  return loop(
+      None(),
+      [=]() {
+        return execute(
+            fd,
+            [fd](struct io_uring_sqe* sqe) {
+              io_uring_prep_accept(
+                  sqe, fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            },
+            *poll);
+      },
+      [=](int result) -> Future<ControlFlow<int_fd>> {
+        if (result >= 0) {
+          return Break(result);
+        }
+
+        if (result == -EAGAIN || result == -EWOULDBLOCK) {
+          *poll = io::READ;
+          return Continue();
+        }
+
+        if (result == -EINTR) {
+          return Continue();
+        }
+
+        return Failure("Failed to accept: " + os::strerror(-result));
+      });
+}
+
+
+Future<Nothing> connect(int_fd fd, const network::Address& address)
+{
+  // NOTE: The kernel may read the address after the submission, so
+  // we keep it until the operation completes.
+  std::shared_ptr<sockaddr_storage> storage(new sockaddr_storage(address));
+  const socklen_t size = static_cast<socklen_t>(address.size());
+
+  return execute(
+      fd,
+      [fd, storage, size](struct io_uring_sqe* sqe) {
+        io_uring_prep_connect(
+            sqe, fd, reinterpret_cast<sockaddr*>(storage.get()), size);
+      })
+    .then([fd, storage, address](int result) -> Future<Nothing> {
+      if (result == 0) {
+        return Nothing();
+      }
+
+      // The kernel may leave a non-blocking connect in progress, in
+      // which case we wait for it as `PollSocketImpl` does otherwise.
+      if (result != -EINPROGRESS &&
+          result != -EALREADY &&
+          result != -EAGAIN) {
+        return Failure(SocketError(
+            -result, "Failed to connect to " + stringify(address)));
+      }
+
+      return io::poll(fd, io::WRITE)
+        .then([fd, address]() -> Future<Nothing> {
+          int opt;
+          socklen_t optlen = sizeof(opt);
+
+          if (::getsockopt(fd, SOL_SOCKET, SO_ERROR, &opt, &optlen) < 0) {
+            return Failure(SocketError(
+                "Failed to get status of connect to " + stringify(address)));
+          }
+
+          if (opt != 0) {
+            return Failure(SocketError(
+                opt, "Failed to connect to " + stringify(address)));
+          }
+
+          return Nothing();
+        });
+    });
+}
+
+} // namespace uring {
+
+
+// Runs the callbacks of the completed operations. Submitting is left
+// to the next iteration of the loop, so that the operations which the
+// callbacks submit go to the kernel together.
+static void complete(UringLoop* loop)
+{
+  // We copy the completions out of the queue before running their
+  // callbacks, which may submit (and thus reap) in turn. This starts
+  // with the completions which were already reaped (see `get_sqe`).
+  thread_local vector<std::pair<uint64_t, int>>* completions =
+    new vector<std::pair<uint64_t, int>>();
+
+  completions->clear();
+  std::swap(*completions, loop->reaped);
+
+  loop->ring.reap(completions);
+
+  foreach (const auto& completion, *completions) {
+    auto operation = loop->operations.find(completion.first);
+    if (operation == loop->operations.end()) {
+      continue; // A cancellation.
+    }
+
+    lambda::function<void(int)> completed =
+      std::move(operation->second.completed);
+
+    loop->operations.erase(operation);
+
+    if (completed) {
+      completed(completion.second);
+    }
+  }
+}
+
+
+// Reads from the `eventfd` of the loop, and runs the functions which
+// were queued for the loop once it becomes readable.
+static void wait_for_functions(UringLoop* loop)
+{
+  uring::submit(
+      loop,
+      [loop](struct io_uring_sqe* sqe) {
+        io_uring_prep_read(
+            sqe,
+            loop->eventfd,
+            &loop->eventfd_value,
+            sizeof(loop->eventfd_value),
+            0);
+      },
+      [loop](int result) {
+        // NOTE: We reset this before taking the functions, so that
+        // functions queued after we take them interrupt the loop.
+        loop->notified.store(false);
+
+        std::queue<lambda::function<void()>> run_functions;
+
+        // Swap the functions into a temporary queue so that we can
+        // invoke them outside of the mutex (see `handle_async` of the
+        // libev event loop for why).
+        {
+          std::lock_guard<std::mutex> guard(loop->functions_mutex);
+          std::swap(run_functions, loop->functions);
+        }
+
+        while (!run_functions.empty()) {
+          (run_functions.front())();
+          run_functions.pop();
+        }
+
+        if (!loop->stopped.load()) {
+          wait_for_functions(loop);
+        }
+      });
+}
+
+
+static void run_loop(UringLoop* loop)
+{
+  _in_event_loop_ = loop;
+
+  wait_for_functions(loop);
+
+  while (!loop->stopped.load()) {
+    // Submit everything that was queued since the last iteration, and
+    // wait for at least one completion.
+    int result = loop->ring.submit(1);
+    if (result < 0 &&
+        result != -EINTR &&
+        result != -EBUSY &&
+        result != -EAGAIN) {
+      LOG(FATAL) << "Failed to submit to io_uring: " << os::strerror(-result);
+    }
+
+    complete(loop);
+  }
+
+  _in_event_loop_ = nullptr;
+}
+
+
+void EventLoop::initialize()
+{
+  num_loops = internal::num_event_loops(
+      "LIBPROCESS_IO_URING_NUM_IO_THREADS", "io_uring");
+
+  loops = new UringLoop[num_loops];
+
+  for (size_t i = 0; i < num_loops; ++i) {
+    Try<Nothing> initialize = loops[i].ring.initialize(RING_ENTRIES);
+    if (initialize.isError()) {
+      EXIT(EXIT_FAILURE)
+          << initialize.error()
+          << "; Is io_uring supported and allowed by the kernel?";
+    }
+
+    loops[i].eventfd = eventfd(0, EFD_CLOEXEC);
+    CHECK_NE(-1, loops[i].eventfd)
+      << "Failed to create eventfd: " << os::strerror(errno);
+
+    loops[i].notified.store(false);
+    loops[i].stopped.store(false);
+
+    // NOTE: Zero is the id of cancellations (see `uring::cancel`).
+    loops[i].next_id = 1;
+  }
+
+  loop_destroy_latch = new internal::Latch();
+}
+
+
+namespace internal {
+
+Future<Nothing> delay(
+    UringLoop* loop,
+    const Duration& duration,
+    const lambda::function<void()>& function)
+{
+  // Invoke 'function' right away (in the next iteration of the loop)
+  // if the duration is negative.
+  const Duration after = std::max(duration, Duration::zero());
+
+  // NOTE: The kernel may read the timeout after the submission, so we
+  // keep it until the timeout completes.
+  std::shared_ptr<struct __kernel_timespec> timeout(
+      new struct __kernel_timespec());
+
+  timeout->tv_sec = after.ns() / Seconds(1).ns();
+  timeout->tv_nsec = after.ns() % Seconds(1).ns();
+
+  uring::submit(
+      loop,
+      [timeout](struct io_uring_sqe* sqe) {
+        io_uring_prep_timeout(sqe, timeout.get(), 0, 0);
+      },
+      [timeout, function](int result) {
+        // NOTE: A timeout which expires completes with `ETIME`.
+        CHECK(result == -ETIME || result == 0)
+          << "Failed to wait for timeout: " << os::strerror(-result);
+
+        function();
+      });
+
+  return Nothing();
+}
+
+} // namespace internal {
+
+
+void EventLoop::delay(
+    const Duration& duration,
+    const lambda::function<void()>& function)
+{
+  // All timers go to loop 0, as they do for libev.
+  run_in_event_loop<Nothing>(
+      get_loop(0),
+      lambda::bind(&internal::delay, lambda::_1, duration, function));
+}
+
+
+double EventLoop::time()
+{
+  // Since a lot of logic in libprocess depends on time math, we want
+  // to log fatal rather than cause logic errors if the time fails.
+  timeval t;
+  if (gettimeofday(&t, nullptr) < 0) {
+    LOG(FATAL) << "Failed to get time, gettimeofday";
+  }
+
+  return Duration(t).secs();
+}
+
+
+void EventLoop::run()
+{
+  // UringLoop 0 runs on this thread, the others get their own threads.
+  vector<thread> threads;
+  threads.reserve(num_loops - 1);
+
+  for (size_t i = 1; i < num_loops; ++i) {
+    threads.push_back(thread([i]() {
+      run_loop(&loops[i]);
+    }));
+  }
+
+  run_loop(&loops[0]);
+
+  foreach (thread& t, threads) {
+    t.join();
+  }
+
+  loop_destroy_latch->trigger();
+}
+
+
+void EventLoop::stop()
+{
+  // Stop the loops and wait for them to finish before destroying them.
+  for (size_t i = 0; i < num_loops; ++i) {
+    loops[i].stopped.store(true);
+
+    CHECK_EQ(0, eventfd_write(loops[i].eventfd, 1))
+      << "Failed to interrupt the event loop: " << os::strerror(errno);
+  }
+
+  loop_destroy_latch->wait();
+
+  delete loop_destroy_latch;
+  loop_destroy_latch = nullptr;
+
+  // NOTE: Deleting the loops also tears down their rings.
+  for (size_t i = 0; i < num_loops; ++i) {
+    os::close(loops[i].eventfd);
+  }
+
+  delete[] loops;
+  loops = nullptr;
+}
+
+} // namespace process {
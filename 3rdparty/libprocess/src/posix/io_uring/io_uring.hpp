@@ -0,0 +1,213 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License
+
+#ifndef __IO_URING_HPP__
+#define __IO_URING_HPP__
+
+#include <atomic>
+#include <mutex>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <process/address.hpp>
+#include <process/future.hpp>
+#include <process/owned.hpp>
+
+#include <stout/lambda.hpp>
+#include <stout/nothing.hpp>
+
+#include <stout/os/int_fd.hpp>
+
+#include "posix/io_uring/ring.hpp"
+
+namespace process {
+
+// An event loop which submits operations to an io_uring and runs the
+// callbacks of the operations as they complete. Operations are only
+// submitted and completed on the thread running the loop, so none of
+// this needs to be synchronized except for the queue of functions.
+struct UringLoop
+{
+  uring::Ring ring;
+
+  // Interrupts the loop for running the functions (see
+  // `run_in_event_loop`) or for stopping it, by becoming readable.
+  int_fd eventfd;
+  uint64_t eventfd_value;
+
+  // Whether the loop was interrupted since it last ran its functions,
+  // so that we write to the `eventfd` once per batch of functions.
+  std::atomic_bool notified;
+  std::atomic_bool stopped;
+
+  std::mutex functions_mutex;
+  std::queue<lambda::function<void()>> functions;
+
+  // An operation which was submitted, keyed by its id, which is the
+  // user data of its submission queue entry.
+  struct Operation
+  {
+    // Invoked with the result of the operation (`cqe->res`), i.e., a
+    // negated `errno` on failure.
+    lambda::function<void(int)> completed;
+
+    // The operation to cancel for cancelling this one, which differs
+    // if this one is linked to (i.e., waits for) a poll.
+    uint64_t head;
+  };
+
+  uint64_t next_id;
+  std::unordered_map<uint64_t, Operation> operations;
+
+  // The user data and results of the completions which were taken
+  // out of the completion queue, but whose callbacks did not run yet.
+  std::vector<std::pair<uint64_t, int>> reaped;
+};
+
+
+// Array of event loops.
+extern UringLoop* loops;
+
+// Per thread loop pointer. If this thread is currently inside an
+// event loop, then this will be set to point to the loop that it's
+// executing inside. Otherwise, will be set to null.
+extern thread_local UringLoop* _in_event_loop_;
+
+// This is a wrapper type of the loop index to ensure that
+// `get_loop(fd)` is called to select the correct loop for
+// `run_in_event_loop(...)`.
+struct LoopIndex
+{
+  size_t index;
+
+private:
+  explicit LoopIndex(size_t index) : index(index) {}
+  LoopIndex() = delete;
+  friend LoopIndex get_loop(int_fd fd);
+};
+
+
+// Since multiple event loops are supported, and fds are assigned
+// to loops, callers must first get the loop based on the fd.
+LoopIndex get_loop(int_fd fd);
+
+
+// Interrupts the loop unless it was already since it last ran its
+// functions.
+void notify(UringLoop* loop);
+
+
+// Wrapper around function we want to run in the event loop.
+template <typename T>
+void _run_in_event_loop(
+    UringLoop* loop,
+    const lambda::function<Future<T>(UringLoop*)>& f,
+    const Owned<Promise<T>>& promise)
+{
+  // Don't bother running the function if the future has been discarded.
+  if (promise->future().hasDiscard()) {
+    promise->discard();
+  } else {
+    promise->set(f(loop));
+  }
+}
+
+
+// Helper for running a function in one of the event loops.
+template <typename T>
+Future<T> run_in_event_loop(
+    const LoopIndex loop_index,
+    const lambda::function<Future<T>(UringLoop*)>& f)
+{
+  UringLoop* loop = &loops[loop_index.index];
+
+  // If this is already the event loop that we're trying to run the
+  // function within, then just run the function.
+  if (_in_event_loop_ == loop) {
+    return f(loop);
+  }
+
+  Owned<Promise<T>> promise(new Promise<T>());
+
+  Future<T> future = promise->future();
+
+  // Enqueue the function.
+  {
+    std::lock_guard<std::mutex> guard(loop->functions_mutex);
+    loop->functions.push(
+        lambda::bind(&_run_in_event_loop<T>, loop, f, promise));
+  }
+
+  // Interrupt the loop.
+  notify(loop);
+
+  return future;
+}
+
+
+namespace uring {
+
+// Queues an operation, prepared by `prepare`, to be submitted along
+// with all the others queued in the same iteration of the loop, and
+// returns its id. Once the operation completes, `completed` is invoked
+// with its result. If `poll` is not zero, the operation is linked to
+// a poll for these events (see `io::poll`), so that it only starts
+// once the file descriptor is ready.
+//
+// NOTE: This must be called within the event loop.
+uint64_t submit(
+    UringLoop* loop,
+    const lambda::function<void(struct io_uring_sqe*)>& prepare,
+    const lambda::function<void(int)>& completed,
+    short poll = 0);
+
+
+// Requests to cancel the operation with the given id, if it did not
+// complete yet. The operation then completes with `-ECANCELED`.
+//
+// NOTE: This must be called within the event loop.
+void cancel(UringLoop* loop, uint64_t id);
+
+
+// Submits an operation on the file descriptor in its event loop, and
+// returns its result. Discarding the returned future cancels the
+// operation, and the future is discarded once the operation stops
+// using its buffers.
+Future<int> execute(
+    int_fd fd,
+    const lambda::function<void(struct io_uring_sqe*)>& prepare,
+    short poll = 0);
+
+
+// The counterparts of `io::read` and `io::write`, and of `recv` and
+// `send` (with `MSG_NOSIGNAL`) on a socket. These never complete with
+// `EAGAIN` but wait for the file descriptor to become ready instead.
+Future<size_t> read(int_fd fd, void* data, size_t size);
+Future<size_t> write(int_fd fd, const void* data, size_t size);
+Future<size_t> recv(int_fd fd, void* data, size_t size);
+Future<size_t> send(int_fd fd, const void* data, size_t size);
+
+
+// Accepts a connection on a listening socket, and returns the
+// non-blocking and close-on-exec socket of the connection.
+Future<int_fd> accept(int_fd fd);
+
+
+// Connects a socket to the given address.
+Future<Nothing> connect(int_fd fd, const network::Address& address);
+
+} // namespace uring {
+} // namespace process {
+
+#endif // __IO_URING_HPP__
@@ -0,0 +1,74 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License
+
+#include <poll.h>
+
+#include <process/future.hpp>
+#include <process/io.hpp>
+#include <process/process.hpp> // For process::initialize.
+
+#include <stout/os/strerror.hpp>
+
+#include "io_uring.hpp"
+
+namespace process {
+namespace io {
+
+Future<short> poll(int_fd fd, short events)
+{
+  process::initialize();
+
+  unsigned mask = 0;
+
+  if ((events & io::READ) != 0) {
+    mask |= POLLIN;
+  }
+
+  if ((events & io::WRITE) != 0) {
+    mask |= POLLOUT;
+  }
+
+  // TODO(benh): Check if the file descriptor is non-blocking?
+  return uring::execute(
+      fd,
+      [fd, mask](struct io_uring_sqe* sqe) {
+        io_uring_prep_poll_add(sqe, fd, mask);
+      })
+    .then([events](int result) -> Future<short> {
+      if (result < 0) {
+        return Failure("Failed to poll: " + os::strerror(-result));
+      }
+
+      // Like libev, we report errors and hang ups as readiness for the
+      // requested events, so that the following operation fails.
+      short revents = 0;
+
+      if ((events & io::READ) != 0 &&
+          (result & (POLLIN | POLLERR | POLLHUP)) != 0) {
+        revents |= io::READ;
+      }
+
+      if ((events & io::WRITE) != 0 &&
+          (result & (POLLOUT | POLLERR | POLLHUP)) != 0) {
+        revents |= io::WRITE;
+      }
+
+      if (revents == 0) {
+        return Failure("Failed to poll: Invalid file descriptor");
+      }
+
+      return revents;
+    });
+}
+
+} // namespace io {
+} // namespace process {
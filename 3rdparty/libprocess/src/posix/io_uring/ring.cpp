@@ -0,0 +1,79 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License
+
+#include <stout/error.hpp>
+
+#include <stout/os/strerror.hpp>
+
+#include "ring.hpp"
+
+using std::pair;
+using std::vector;
+
+namespace process {
+namespace uring {
+
+Ring::~Ring()
+{
+  if (initialized) {
+    io_uring_queue_exit(&ring);
+  }
+}
+
+
+Try<Nothing> Ring::initialize(unsigned entries)
+{
+  int result = io_uring_queue_init(entries, &ring, 0);
+  if (result < 0) {
+    return Error("Failed to set up io_uring: " + os::strerror(-result));
+  }
+
+  initialized = true;
+
+  return Nothing();
+}
+
+
+unsigned Ring::space()
+{
+  return io_uring_sq_space_left(&ring);
+}
+
+
+struct io_uring_sqe* Ring::sqe()
+{
+  return io_uring_get_sqe(&ring);
+}
+
+
+int Ring::submit(unsigned wait)
+{
+  return io_uring_submit_and_wait(&ring, wait);
+}
+
+
+void Ring::reap(vector<pair<uint64_t, int>>* completions)
+{
+  unsigned head;
+  unsigned count = 0;
+  struct io_uring_cqe* cqe;
+
+  io_uring_for_each_cqe(&ring, head, cqe) {
+    completions->emplace_back(cqe->user_data, cqe->res);
+    ++count;
+  }
+
+  io_uring_cq_advance(&ring, count);
+}
+
+} // namespace uring {
+} // namespace process {
@@ -0,0 +1,72 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License
+
+#ifndef __IO_URING_RING_HPP__
+#define __IO_URING_RING_HPP__
+
+#include <liburing.h>
+
+#include <stdint.h>
+
+#include <utility>
+#include <vector>
+
+#include <stout/nothing.hpp>
+#include <stout/try.hpp>
+
+namespace process {
+namespace uring {
+
+// An io_uring instance, i.e., the submission and completion queues
+// which are shared with the kernel, as set up by liburing. This only
+// covers what the event loop needs, and is not thread-safe. Entries
+// are prepared with the helpers of liburing (`io_uring_prep_*`).
+class Ring
+{
+public:
+  Ring() = default;
+  ~Ring();
+
+  Ring(const Ring&) = delete;
+  Ring& operator=(const Ring&) = delete;
+
+  // Sets up the ring with a submission queue of the given number of
+  // entries (rounded up to a power of 2 by the kernel).
+  Try<Nothing> initialize(unsigned entries);
+
+  // Returns the number of entries which can be queued before the
+  // submission queue is full.
+  unsigned space();
+
+  // Returns the next submission queue entry, or nullptr if the
+  // submission queue is full. The entry is submitted by the next
+  // call to `submit`.
+  struct io_uring_sqe* sqe();
+
+  // Submits the queued entries, and waits for at least `wait`
+  // completions. Returns the number of submitted entries, or a
+  // negated `errno` on failure.
+  int submit(unsigned wait = 0);
+
+  // Appends the user data and the result of each completion which
+  // is ready, and removes them from the completion queue.
+  void reap(std::vector<std::pair<uint64_t, int>>* completions);
+
+private:
+  struct io_uring ring;
+  bool initialized = false;
+};
+
+} // namespace uring {
+} // namespace process {
+
+#endif // __IO_URING_RING_HPP__
@@ -15,66 +15,25 @@
 
 #include <glog/logging.h>
 
-#include <condition_variable>
 #include <mutex>
 #include <queue>
-#include <string>
 #include <thread>
 #include <vector>
 
 #include <stout/duration.hpp>
-#include <stout/exit.hpp>
 #include <stout/lambda.hpp>
 #include <stout/nothing.hpp>
-#include <stout/numify.hpp>
-#include <stout/option.hpp>
-
-#include <stout/os/getenv.hpp>
 
 #include "event_loop.hpp"
 #include "libev.hpp"
 
-using std::string;
+#include "posix/event_loops.hpp"
+
 using std::thread;
 using std::vector;
 
 namespace process {
 
-namespace internal {
-
-// We need a latch (available in C++20 but not in C++11) to
-// wait for all loops to finish, so define a simple one here.
-// To keep this simple, this only allows 1 triggering thread
-// and 1 waiting thread.
-//
-// TODO(bmahler): Replace this with std::latch in C++20.
-class Latch
-{
-public:
-  void trigger()
-  {
-    std::unique_lock<std::mutex> lock(mutex);
-    triggered = true;
-    condition.notify_all();
-  }
-
-  void wait()
-  {
-    std::unique_lock<std::mutex> lock(mutex);
-    while (!triggered) {
-      condition.wait(lock);
-    }
-  }
-
-private:
-  std::mutex mutex;
-  std::condition_variable condition;
-  bool triggered = false;
-};
-
-} // namespace internal {
-
-
 size_t num_loops = 1L;
 
 // Array of async watchers to receive the request to shutdown
@@ -136,29 +95,8 @@ LoopIndex get_loop(int_fd fd)
 
 void EventLoop::initialize()
 {
-  // TODO(bmahler): Since this is a new feature, we stick to the
-  // old behavior of a single event loop thread. But, once this
-  // code is known to be stable and helpful, we can consider
-  // increasing the default.
-  num_loops = 1;
-
-  // TODO(bmahler): Load this via a Flag object to eliminate this boilerplate.
-  constexpr char env_var[] = "LIBPROCESS_LIBEV_NUM_IO_THREADS";
-  Option<string> value = os::getenv(env_var);
-  if (value.isSome()) {
-    constexpr size_t maxval = 1024;
-    Try<size_t> number = numify<size_t>(value->c_str());
-    if (number.isSome() && number.get() > 0 && number.get() <= maxval) {
-      VLOG(1) << "Overriding default number of libev io threads"
-              << " (" << num_loops << "), using the value "
-              << env_var << "=" << *number << " instead";
-      num_loops = number.get();
-    } else {
-      EXIT(EXIT_FAILURE)
-          << "Invalid value '" << value.get() << "' for " << env_var
-          << "; Valid values are integers in the range 1 to " << maxval;
-    }
-  }
+  num_loops = internal::num_event_loops(
+      "LIBPROCESS_LIBEV_NUM_IO_THREADS", "libev");
 
   loops = new struct ev_loop*[num_loops];
 
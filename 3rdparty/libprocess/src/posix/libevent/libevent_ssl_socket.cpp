@@ -553,6 +553,12 @@ Future<Nothing> LibeventSSLSocketImpl::connect(
     }
   }
 
+  // Resume the previous session with this server, if any, identified
+  // by the name we verify and the address we connect to.
+  openssl::resume_session(
+      ssl,
+      config.servername.getOrElse("") + "@" + stringify(address));
+
   // Construct the bufferevent in the connecting state.
   // We set 'BEV_OPT_DEFER_CALLBACKS' to avoid calling the
   // 'event_callback' before 'bufferevent_socket_connect' returns.
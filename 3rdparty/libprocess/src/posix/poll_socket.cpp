@@ -29,6 +29,10 @@
 #include "config.hpp"
 #include "poll_socket.hpp"
 
+#ifdef USE_IO_URING
+#include "posix/io_uring/io_uring.hpp"
+#endif // USE_IO_URING
+
 using std::string;
 
 namespace process {
@@ -56,8 +60,13 @@ Future<std::shared_ptr<SocketImpl>> PollSocketImpl::accept()
   // socket has changed (i.e. closed) before we return from `io::poll`.
   std::weak_ptr<SocketImpl> weak_self(shared(this));
 
-  return io::poll(get(), io::READ)
-    .then([weak_self]() -> Future<std::shared_ptr<SocketImpl>> {
+#ifdef USE_IO_URING
+  // The accept is submitted to the event loop, and the accepted socket
+  // is already non-blocking and close-on-exec.
+  Future<int_fd> accepted = uring::accept(get());
+#else
+  Future<int_fd> accepted = io::poll(get(), io::READ)
+    .then([weak_self]() -> Future<int_fd> {
       std::shared_ptr<SocketImpl> self(weak_self.lock());
       if (self == nullptr) {
         return Failure("Socket destroyed while accepting");
@@ -81,6 +90,18 @@ Future<std::shared_ptr<SocketImpl>> PollSocketImpl::accept()
         return Failure("Failed to accept, cloexec: " + cloexec.error());
       }
 
+      return s;
+    });
+#endif // USE_IO_URING
+
+  return accepted
+    .then([weak_self](int_fd s) -> Future<std::shared_ptr<SocketImpl>> {
+      std::shared_ptr<SocketImpl> self(weak_self.lock());
+      if (self == nullptr) {
+        os::close(s);
+        return Failure("Socket destroyed while accepting");
+      }
+
       Try<Address> address = network::address(s);
       if (address.isError()) {
         os::close(s);
@@ -120,6 +141,16 @@ Future<std::shared_ptr<SocketImpl>> PollSocketImpl::accept()
 Future<Nothing> PollSocketImpl::connect(
     const Address& address)
 {
+#ifdef USE_IO_URING
+  // Need to hold a copy of `this` so that the underlying socket
+  // doesn't end up getting reused before we return.
+  auto self = shared(this);
+
+  return uring::connect(get(), address)
+    .then([self]() {
+      return Nothing();
+    });
+#else
   Try<Nothing, SocketError> connect = network::connect(get(), address);
   if (connect.isError()) {
     if (net::is_inprogress_error(connect.error().code)) {
@@ -161,6 +192,7 @@ Future<Nothing> PollSocketImpl::connect(
   }
 
   return Nothing();
+#endif // USE_IO_URING
 }
 
 #ifdef USE_SSL_SOCKET
@@ -179,10 +211,17 @@ Future<size_t> PollSocketImpl::recv(char* data, size_t size)
   // `io::read` and end up reading data incorrectly.
   auto self = shared(this);
 
+#ifdef USE_IO_URING
+  return uring::recv(get(), data, size)
+    .then([self](size_t length) {
+      return length;
+    });
+#else
   return io::read(get(), data, size)
     .then([self](size_t length) {
       return length;
     });
+#endif // USE_IO_URING
 }
 
 
@@ -194,6 +233,12 @@ Future<size_t> PollSocketImpl::send(const char* data, size_t size)
   // doesn't end up getting reused before we return.
   auto self = shared(this);
 
+#ifdef USE_IO_URING
+  return uring::send(get(), data, size)
+    .then([self](size_t length) {
+      return length;
+    });
+#else
   // TODO(benh): Reuse `io::write`? Or is `net::send` and
   // `MSG_NOSIGNAL` critical here?
   return loop(
@@ -236,6 +281,7 @@ Future<size_t> PollSocketImpl::send(const char* data, size_t size)
         }
         return Break(length.get());
       });
+#endif // USE_IO_URING
 }
 
 
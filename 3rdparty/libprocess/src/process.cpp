@@ -117,6 +117,9 @@
 #include "event_queue.hpp"
 #include "gate.hpp"
 #include "http_proxy.hpp"
+#ifdef USE_HTTP2
+#include "http2.hpp"
+#endif // USE_HTTP2
 #include "memory_profiler.hpp"
 #include "process_reference.hpp"
 #include "socket_manager.hpp"
@@ -798,16 +801,30 @@ static Future<MessageEvent*> parse(const Request& request)
 
 namespace internal {
 
-void receive(Socket socket)
+// Decodes the HTTP/1.1 requests read from the socket, starting with
+// the bytes which have already been read, if any.
+static void receive(Socket socket, const string& buffered)
 {
   StreamingRequestDecoder* decoder = new StreamingRequestDecoder();
 
   const size_t size = 80 * 1024;
   char* data = new char[size];
 
+  string pending = buffered;
+
   Future<Nothing> recv_loop = process::loop(
       None(),
-      [=] {
+      [=]() mutable -> Future<size_t> {
+        // NOTE: The bytes read while looking for the HTTP/2 preface
+        // can exceed the buffer (see `receive(Socket)`), in which case
+        // they are decoded a buffer at a time.
+        if (!pending.empty()) {
+          const size_t length = std::min(size, pending.size());
+          memcpy(data, pending.data(), length);
+          pending.erase(0, length);
+          return length;
+        }
+
         return socket.recv(data, size);
       },
       [=](size_t length) -> Future<ControlFlow<Nothing>> {
@@ -855,6 +872,121 @@ void receive(Socket socket)
   });
 }
 
+
+#ifdef USE_HTTP2
+// Hands the bytes read from the socket, starting with the ones which
+// have already been read, to an `Http2Proxy` which takes over the
+// connection.
+static void receive_http2(Socket socket, const string& buffered)
+{
+  Http2Proxy* http2 = new Http2Proxy(socket, [socket](Request* request) {
+    process_manager->handle(socket, request);
+  });
+
+  PID<Http2Proxy> proxy(http2);
+
+  if (socket_manager->proxy(socket, http2) == PID<HttpProxy>()) {
+    socket_manager->close(socket);
+    return;
+  }
+
+  const size_t size = 80 * 1024;
+  char* data = new char[size];
+
+  Future<Nothing> recv_loop = dispatch(proxy, &Http2Proxy::receive, buffered)
+    .then([=]() {
+      return process::loop(
+          None(),
+          [=] {
+            return socket.recv(data, size);
+          },
+          [=](size_t length) -> Future<ControlFlow<Nothing>> {
+            if (length == 0) {
+              return Break(); // EOF.
+            }
+
+            return dispatch(proxy, &Http2Proxy::receive, string(data, length))
+              .then([]() -> ControlFlow<Nothing> {
+                return Continue();
+              });
+          });
+    });
+
+  auto cleanup = [=](const Option<string>& failure) {
+    if (failure.isSome()) {
+      Try<Address> peer = socket.peer();
+
+      LOG(WARNING)
+        << "Failed to recv on socket " << socket.get() << " to peer '"
+        << (peer.isSome() ? stringify(peer.get()) : "unknown")
+        << "': " << failure.get();
+    }
+
+    socket_manager->close(socket);
+    delete[] data;
+  };
+
+  // NOTE: The loop gets abandoned if the proxy has been terminated
+  // (e.g., because the socket got closed) while data was dispatched
+  // to it.
+  recv_loop
+    .onAny([=](const Future<Nothing>& f) {
+      cleanup(f.isFailed() ? Option<string>(f.failure()) : None());
+    })
+    .onAbandoned([=]() {
+      cleanup(None());
+    });
+}
+#endif // USE_HTTP2
+
+
+void receive(Socket socket)
+{
+#ifdef USE_HTTP2
+  // An HTTP/2 client starts with the connection preface, which tells it
+  // apart from an HTTP/1.1 client. We only need to read more before
+  // deciding while the bytes read so far could be a partial preface.
+  const string preface = http2::PREFACE;
+
+  string buffered;
+
+  process::loop(
+      None(),
+      [=]() mutable {
+        return socket.recv();
+      },
+      [=](const string& data) mutable -> ControlFlow<string> {
+        buffered += data;
+
+        if (!data.empty() &&
+            buffered.size() < preface.size() &&
+            strings::startsWith(preface, buffered)) {
+          return Continue();
+        }
+
+        return Break(buffered);
+      })
+    .onAny([=](const Future<string>& buffered) {
+      if (!buffered.isReady()) {
+        Try<Address> peer = socket.peer();
+
+        LOG(WARNING)
+          << "Failed to recv on socket " << socket.get() << " to peer '"
+          << (peer.isSome() ? stringify(peer.get()) : "unknown") << "': "
+          << (buffered.isFailed() ? buffered.failure() : "discarded");
+
+        socket_manager->close(socket);
+      } else if (strings::startsWith(buffered.get(), preface)) {
+        receive_http2(socket, buffered.get());
+      } else {
+        receive(socket, buffered.get());
+      }
+    });
+#else
+  receive(socket, "");
+#endif // USE_HTTP2
+}
+
 } // namespace internal {
 
 
@@ -1760,6 +1892,24 @@ PID<HttpProxy> SocketManager::proxy(const Socket& socket)
 }
 
 
+PID<HttpProxy> SocketManager::proxy(const Socket& socket, HttpProxy* proxy)
+{
+  synchronized (mutex) {
+    if (sockets.count(socket) == 0) {
+      delete proxy;
+      return PID<HttpProxy>();
+    }
+
+    CHECK(proxies.count(socket) == 0);
+    proxies[socket] = proxy;
+  }
+
+  // NOTE: We spawn outside of the synchronized block above for the
+  // same reason as in the overload above.
+  return spawn(proxy, true);
+}
+
+
 void SocketManager::unproxy(const Socket& socket)
 {
   synchronized (mutex) {
@@ -3662,7 +3812,7 @@ void ProcessBase::consume(MessageEvent&& event)
 
 void ProcessBase::consume(DispatchEvent&& event)
 {
-  std::move(*event.f)(this);
+  std::move(event.f)(this);
 }
 
 
@@ -4125,7 +4275,7 @@ namespace internal {
 
 void dispatch(
     const UPID& pid,
-    std::unique_ptr<lambda::CallableOnce<void(ProcessBase*)>> f,
+    lambda::CallableOnce<void(ProcessBase*)>&& f,
     const Option<const std::type_info*>& functionType)
 {
   process::initialize();
@@ -59,6 +59,12 @@ public:
 
   PID<HttpProxy> proxy(const network::inet::Socket& socket);
 
+  // Makes `proxy` handle the responses on the socket in place of an
+  // `HttpProxy`, e.g., an `Http2Proxy` once the client turns out to
+  // speak HTTP/2. Takes ownership of `proxy`, and returns an empty
+  // PID if the socket has been closed in the meantime.
+  PID<HttpProxy> proxy(const network::inet::Socket& socket, HttpProxy* proxy);
+
   // Used to clean up the pointer to an `HttpProxy` in case the
   // `HttpProxy` is killed outside the control of the `SocketManager`.
   // This generally happens when `process::finalize` is called.
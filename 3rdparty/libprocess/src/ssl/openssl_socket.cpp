@@ -359,6 +359,12 @@ Future<Nothing> OpenSSLSocketImpl::connect(
     }
   }
 
+  // Resume the previous session with this server, if any, identified
+  // by the name we verify and the address we connect to.
+  openssl::resume_session(
+      ssl,
+      config.servername.getOrElse("") + "@" + stringify(address));
+
   // Set the SSL context in client mode.
   SSL_set_connect_state(ssl);
 
@@ -512,6 +518,46 @@ Future<size_t> OpenSSLSocketImpl::sendfile(
     return Failure("Failed to make FD asynchronous: " + async.error());
   }
 
+#ifdef SUPPORTS_KTLS
+  // Once the kernel encrypts what we send, we can let it send the file
+  // directly rather than copying it into user space to encrypt it.
+  if (BIO_get_ktls_send(SSL_get_wbio(ssl))) {
+    std::shared_ptr<size_t> sent(new size_t(0));
+
+    return process::loop(
+        compute_thread,
+        [weak_self, fd, offset, size, sent]() -> Future<ossl_ssize_t> {
+          std::shared_ptr<OpenSSLSocketImpl> self(weak_self.lock());
+          if (self == nullptr) {
+            return Failure("Socket destroyed while sending file");
+          }
+
+          ERR_clear_error();
+          return SSL_sendfile(
+              self->ssl, fd, offset + *sent, size - *sent, 0);
+        },
+        [weak_self, size, sent](ossl_ssize_t result)
+            -> Future<ControlFlow<size_t>> {
+          std::shared_ptr<OpenSSLSocketImpl> self(weak_self.lock());
+          if (self == nullptr) {
+            return Failure("Socket destroyed while sending file");
+          }
+
+          if (result <= 0) {
+            return self->handle_ssl_return_result(result, false);
+          }
+
+          *sent += result;
+
+          if (*sent < size) {
+            return Continue();
+          }
+
+          return Break(size);
+        });
+  }
+#endif // SUPPORTS_KTLS
+
   size_t remaining_size = size;
   boost::shared_array<char> data(new char[io::BUFFERED_READ_SIZE]);
 
@@ -829,7 +875,25 @@ Future<size_t> OpenSSLSocketImpl::set_ssl_and_do_handshake(SSL* _ssl)
   //
   // NOTE: This transfers ownership of the BIO to the SSL object.
   // The BIO will be freed upon calling `SSL_free(ssl)`.
-  BIO* bio = BIO_new_libprocess(get());
+  BIO* bio = nullptr;
+
+#ifdef SUPPORTS_KTLS
+  // OpenSSL can only hand the encryption over to the kernel if it
+  // reads and writes the socket itself, hence we use its socket BIO
+  // when kTLS is enabled, and wait for the socket to become readable
+  // or writable whenever it would block (see
+  // `handle_ssl_return_result`). If the kernel does not support the
+  // negotiated cipher, OpenSSL keeps encrypting in user space.
+  if ((SSL_get_options(ssl) & SSL_OP_ENABLE_KTLS) != 0) {
+    bio = BIO_new_socket(get(), BIO_NOCLOSE);
+    CHECK_NOTNULL(bio);
+  }
+#endif // SUPPORTS_KTLS
+
+  if (bio == nullptr) {
+    bio = BIO_new_libprocess(get());
+  }
+
   SSL_set_bio(ssl, bio, bio);
 
   // Hold a weak pointer since the handshake may potentially never complete.
@@ -874,13 +938,25 @@ Future<ControlFlow<size_t>> OpenSSLSocketImpl::handle_ssl_return_result(
   }
 
   // Not a success, so we'll need to have the BIO and associated data handy.
+  //
+  // NOTE: There is no such data when OpenSSL reads and writes the
+  // socket itself (see `set_ssl_and_do_handshake`), in which case we
+  // wait for the socket instead.
   BIO* bio = SSL_get_rbio(ssl);
-  SocketBIOData* data = reinterpret_cast<SocketBIOData*>(BIO_get_data(bio));
-  CHECK_NOTNULL(data);
+  SocketBIOData* data = BIO_method_type(bio) == BIO_TYPE_SOCKET
+    ? nullptr
+    : reinterpret_cast<SocketBIOData*>(BIO_get_data(bio));
 
   int error = SSL_get_error(ssl, result);
   switch (error) {
     case SSL_ERROR_WANT_READ: {
+      if (data == nullptr) {
+        return io::poll(get(), io::READ)
+          .then([]() -> Future<ControlFlow<size_t>> {
+            return Continue();
+          });
+      }
+
       synchronized (data->lock) {
         if (data->recv_request.get() != nullptr) {
           return data->recv_request->future
@@ -893,6 +969,13 @@ Future<ControlFlow<size_t>> OpenSSLSocketImpl::handle_ssl_return_result(
       return Continue();
     }
     case SSL_ERROR_WANT_WRITE: {
+      if (data == nullptr) {
+        return io::poll(get(), io::WRITE)
+          .then([]() -> Future<ControlFlow<size_t>> {
+            return Continue();
+          });
+      }
+
       synchronized (data->lock) {
         if (data->send_request.get() != nullptr) {
           return data->send_request->future
@@ -18,6 +18,8 @@
 
 #include <gmock/gmock.h>
 
+#include <algorithm>
+#include <ctime>
 #include <deque>
 #include <iostream>
 #include <memory>
@@ -25,30 +27,61 @@
 #include <thread>
 #include <vector>
 
+#include <process/after.hpp>
 #include <process/collect.hpp>
 #include <process/count_down_latch.hpp>
 #include <process/future.hpp>
 #include <process/gmock.hpp>
 #include <process/gtest.hpp>
+#include <process/http.hpp>
+#include <process/loop.hpp>
 #include <process/owned.hpp>
 #include <process/process.hpp>
 #include <process/protobuf.hpp>
+#include <process/socket.hpp>
+#include <process/statistics.hpp>
+#include <process/timeseries.hpp>
 
 #include <process/metrics/counter.hpp>
+#include <process/metrics/histogram.hpp>
 #include <process/metrics/metrics.hpp>
 
+#include <process/ssl/gtest.hpp>
+
+#include <stout/bytes.hpp>
 #include <stout/duration.hpp>
+#include <stout/foreach.hpp>
 #include <stout/gtest.hpp>
 #include <stout/hashset.hpp>
+#include <stout/os.hpp>
+#include <stout/path.hpp>
 #include <stout/stopwatch.hpp>
+#include <stout/stringify.hpp>
+#include <stout/strings.hpp>
 
 #include "benchmarks.pb.h"
 
 #include "mpsc_linked_queue.hpp"
 
+#ifdef USE_SSL_SOCKET
+#include "openssl.hpp"
+#endif // USE_SSL_SOCKET
+
 namespace http = process::http;
+namespace inet = process::network::inet;
+namespace inet4 = process::network::inet4;
 namespace metrics = process::metrics;
+namespace network = process::network;
+
+using inet::Socket;
 
+using network::internal::SocketImpl;
+
+using process::Break;
+using process::Clock;
+using process::collect;
+using process::Continue;
+using process::ControlFlow;
 using process::CountDownLatch;
 using process::Future;
 using process::MessageEvent;
@@ -56,6 +89,9 @@ using process::Owned;
 using process::Process;
 using process::ProcessBase;
 using process::Promise;
+using process::Statistics;
+using process::Time;
+using process::TimeSeries;
 using process::UPID;
 
 using std::cout;
@@ -774,6 +810,181 @@ TEST(ProcessTest, Process_BENCHMARK_MpscLinkedQueue)
 }
 
 
+// Measures the cost of chaining continuations onto futures, most of
+// which is the allocation of the futures, promises and callbacks.
+TEST(ProcessTest, Process_BENCHMARK_FutureChain)
+{
+  const size_t chains = 10000;
+  const size_t length = 100;
+
+  Stopwatch watch;
+  watch.start();
+
+  for (size_t i = 0; i < chains; i++) {
+    Promise<size_t> promise;
+
+    Future<size_t> future = promise.future();
+    for (size_t j = 0; j < length; j++) {
+      future = future.then([](size_t value) { return value + 1; });
+    }
+
+    promise.set(0);
+
+    CHECK_EQ(length, future.get());
+  }
+
+  watch.stop();
+
+  cout << "Completed " << chains << " chains of " << length
+       << " continuations in " << watch.elapsed() << endl;
+}
+
+
+// Measures the cost of collecting many futures.
+TEST(ProcessTest, Process_BENCHMARK_FutureCollect)
+{
+  const size_t count = 100000;
+
+  vector<Promise<size_t>> promises(count);
+
+  vector<Future<size_t>> futures;
+  futures.reserve(count);
+
+  foreach (const Promise<size_t>& promise, promises) {
+    futures.push_back(promise.future());
+  }
+
+  Stopwatch watch;
+  watch.start();
+
+  Future<vector<size_t>> collected = collect(futures);
+
+  for (size_t i = 0; i < count; i++) {
+    promises[i].set(i);
+  }
+
+  collected.await();
+
+  watch.stop();
+
+  ASSERT_TRUE(collected.isReady());
+  EXPECT_EQ(count, collected->size());
+
+  cout << "Collected " << count << " futures in " << watch.elapsed() << endl;
+}
+
+
+class Dispatch_BENCHMARK_Test : public ::testing::Test,
+                                public WithParamInterface<size_t> {};
+
+
+// Parameterized by the number of threads dispatching concurrently.
+INSTANTIATE_TEST_CASE_P(
+    ThreadsCount,
+    Dispatch_BENCHMARK_Test,
+    ::testing::Values(1u, 2u, 4u, 8u));
+
+
+class CountingProcess : public Process<CountingProcess>
+{
+public:
+  void increment() { count++; }
+
+  size_t next() { return ++count; }
+
+private:
+  size_t count = 0;
+};
+
+
+// Measures the rate of dispatches of a method returning `void`, for
+// which nothing but the dispatch itself gets allocated.
+TEST_P(Dispatch_BENCHMARK_Test, Void)
+{
+  const size_t threads = GetParam();
+  const size_t dispatches = 1000000 / threads;
+
+  CountingProcess process;
+  spawn(process);
+
+  Stopwatch watch;
+  watch.start();
+
+  vector<std::thread> senders;
+  for (size_t i = 0; i < threads; i++) {
+    senders.emplace_back([&]() {
+      for (size_t j = 0; j < dispatches; j++) {
+        dispatch(process, &CountingProcess::increment);
+      }
+    });
+  }
+
+  foreach (std::thread& sender, senders) {
+    sender.join();
+  }
+
+  // Dispatches are processed in order, hence all of the above have
+  // been processed once this one is.
+  Future<size_t> count = dispatch(process, &CountingProcess::next);
+  AWAIT_READY(count);
+
+  watch.stop();
+
+  EXPECT_EQ(threads * dispatches + 1, count.get());
+
+  cout << "Dispatched " << threads * dispatches << " calls from " << threads
+       << " threads in " << watch.elapsed() << " ("
+       << static_cast<uint64_t>(threads * dispatches / watch.elapsed().secs())
+       << " dispatches/s)" << endl;
+
+  terminate(process);
+  wait(process);
+}
+
+
+// Measures the rate of dispatches of a method returning a value, which
+// also allocates the promise of each result.
+TEST_P(Dispatch_BENCHMARK_Test, Future)
+{
+  const size_t threads = GetParam();
+  const size_t dispatches = 1000000 / threads;
+
+  CountingProcess process;
+  spawn(process);
+
+  Stopwatch watch;
+  watch.start();
+
+  vector<Future<size_t>> lasts(threads);
+  vector<std::thread> senders;
+  for (size_t i = 0; i < threads; i++) {
+    senders.emplace_back([&, i]() {
+      for (size_t j = 0; j < dispatches; j++) {
+        lasts[i] = dispatch(process, &CountingProcess::next);
+      }
+    });
+  }
+
+  foreach (std::thread& sender, senders) {
+    sender.join();
+  }
+
+  foreach (const Future<size_t>& last, lasts) {
+    AWAIT_READY(last);
+  }
+
+  watch.stop();
+
+  cout << "Dispatched " << threads * dispatches << " calls from " << threads
+       << " threads in " << watch.elapsed() << " ("
+       << static_cast<uint64_t>(threads * dispatches / watch.elapsed().secs())
+       << " dispatches/s)" << endl;
+
+  terminate(process);
+  wait(process);
+}
+
+
 class Metrics_BENCHMARK_Test : public ::testing::Test,
                                public WithParamInterface<size_t>{};
 
@@ -839,6 +1050,748 @@ TEST_P(Metrics_BENCHMARK_Test, Scalability)
 }
 
 
+// Tests the cost of recording values into histograms, and of
+// collecting a large number of histograms through the JSON snapshot
+// and the Prometheus endpoint.
+TEST_P(Metrics_BENCHMARK_Test, Histogram)
+{
+  size_t metrics_count = GetParam();
+
+  // Buckets from 1 to about 250k, as for a typical latency histogram.
+  const vector<double> bounds = metrics::Histogram::exponential(1, 4, 10);
+
+  vector<metrics::Histogram> histograms;
+  histograms.reserve(metrics_count);
+
+  for (size_t i = 0; i < metrics_count; ++i) {
+    histograms.push_back(
+        metrics::Histogram("metrics/keys/can/be/somewhat/long/"
+                           "so/we/use/a/fairly/long/key/here/"
+                           "to/test/a/more/pathological/case/" +
+                           stringify(i),
+                           bounds));
+  }
+
+  for (size_t i = 0; i < metrics_count; ++i) {
+    metrics::add(histograms[i]).get();
+  }
+
+  // Spread the values over all the buckets.
+  const size_t records = 1000000;
+
+  Stopwatch watch;
+  watch.start();
+  for (size_t i = 0; i < records; ++i) {
+    histograms[i % metrics_count].record(static_cast<double>(i % 500000));
+  }
+  watch.stop();
+
+  cout << "Recorded " << records << " values into " << metrics_count
+       << " histograms in " << watch.elapsed() << " ("
+       << watch.elapsed() / records << " per value)" << endl;
+
+  watch.start();
+  metrics::snapshot(None()).get();
+  watch.stop();
+
+  cout << "Snapshot of " << metrics_count << " histograms in "
+       << watch.elapsed() << endl;
+
+  UPID upid("metrics", process::address());
+
+  watch.start();
+  http::Response response = http::get(upid, "prometheus").get();
+  watch.stop();
+
+  cout << "HTTP /prometheus of " << metrics_count << " histograms ("
+       << Bytes(response.body.size()) << ") in " << watch.elapsed() << endl;
+
+  for (size_t i = 0; i < metrics_count; ++i) {
+    metrics::remove(histograms[i]).get();
+  }
+}
+
+
+class TimeSeries_BENCHMARK_Test : public ::testing::Test,
+                                  public WithParamInterface<size_t> {};
+
+
+// Parameterized by the capacity of the time series.
+INSTANTIATE_TEST_CASE_P(
+    Capacity,
+    TimeSeries_BENCHMARK_Test,
+    ::testing::Values(100u, 1000u, 10000u, 100000u));
+
+
+// Tests the cost of adding a value to a time series which is at its
+// capacity (i.e., which is sparsified), as a metric timer does for
+// each sample, and of computing its statistics, as a metrics
+// snapshot does for each timer.
+TEST_P(TimeSeries_BENCHMARK_Test, SetAndStatistics)
+{
+  const size_t capacity = GetParam();
+
+  TimeSeries<double> timeseries(Duration::max(), capacity);
+
+  Time time = Clock::now();
+
+  // Fill the time series first so that we only measure insertions
+  // which sparsify.
+  for (size_t i = 0; i < capacity; ++i) {
+    time += Milliseconds(1);
+    timeseries.set(static_cast<double>(i % 1000), time);
+  }
+
+  const size_t samples = 1000000;
+
+  Stopwatch watch;
+  watch.start();
+  for (size_t i = 0; i < samples; ++i) {
+    time += Milliseconds(1);
+    timeseries.set(static_cast<double>(i % 1000), time);
+  }
+  watch.stop();
+
+  cout << "Set " << samples << " values into a time series with capacity "
+       << capacity << " in " << watch.elapsed() << " ("
+       << watch.elapsed() / samples << " per value)" << endl;
+
+  const size_t scrapes = 1000;
+
+  double p99 = 0.0;
+
+  watch.start();
+  for (size_t i = 0; i < scrapes; ++i) {
+    Option<Statistics<double>> statistics =
+      Statistics<double>::from(timeseries);
+
+    ASSERT_SOME(statistics);
+    p99 += statistics->p99;
+  }
+  watch.stop();
+
+  EXPECT_LT(0.0, p99);
+
+  cout << "Computed the statistics of a time series with capacity "
+       << capacity << " " << scrapes << " times in " << watch.elapsed()
+       << " (" << watch.elapsed() / scrapes << " per scrape)" << endl;
+}
+
+
+class HttpCompression_BENCHMARK_Test
+  : public ::testing::Test,
+    public WithParamInterface<Bytes> {};
+
+
+// Parameterized by the size of the response body.
+INSTANTIATE_TEST_CASE_P(
+    ResponseSize,
+    HttpCompression_BENCHMARK_Test,
+    ::testing::Values(Megabytes(1), Megabytes(10), Megabytes(100)));
+
+
+// Streams a JSON body resembling the tasks of the master's '/state'
+// in 64KB chunks, which is how the master streams it.
+class StateProcess : public Process<StateProcess>
+{
+public:
+  explicit StateProcess(const Bytes& size)
+  {
+    const string framework = "4a1b4d4b-8f0e-4f6b-9b1b-8e2a4a9c3f11-0000";
+
+    string chunk = "{\"tasks\":[";
+    size_t total = 0;
+    for (size_t i = 0; total + chunk.size() < size.bytes(); ++i) {
+      chunk += (i == 0 ? "" : ",") + strings::format(
+          "{\"id\":\"task-%zu\",\"name\":\"worker %zu\","
+          "\"framework_id\":\"%s\",\"executor_id\":\"\","
+          "\"slave_id\":\"4a1b4d4b-8f0e-4f6b-9b1b-8e2a4a9c3f11-S%zu\","
+          "\"state\":\"TASK_RUNNING\",\"resources\":{\"cpus\":%.1f,"
+          "\"mem\":%zu.0,\"disk\":0.0,\"ports\":\"[%zu-%zu]\"},"
+          "\"role\":\"*\",\"statuses\":[{\"state\":\"TASK_RUNNING\","
+          "\"timestamp\":%.6f,\"container_status\":{\"network_infos\":"
+          "[{\"ip_addresses\":[{\"ip_address\":\"10.%zu.%zu.%zu\"}]}]}}]}",
+          i, i % 97, framework.c_str(), i % 1013, 0.1 * (1 + i % 16),
+          32 * (1 + i % 64), 31000 + i % 1000, 31000 + i % 1000,
+          1560000000.0 + i * 0.37, i % 7, (i / 7) % 256, i % 256).get();
+
+      if (chunk.size() >= Kilobytes(64).bytes()) {
+        total += chunk.size();
+        chunks.push_back(std::move(chunk));
+        chunk.clear();
+      }
+    }
+
+    chunks.push_back(chunk + "]}");
+  }
+
+protected:
+  void initialize() override
+  {
+    route("/state", None(), &StateProcess::state);
+  }
+
+private:
+  Future<http::Response> state(const http::Request& request)
+  {
+    http::Pipe pipe;
+    http::OK ok;
+    ok.type = http::Response::PIPE;
+    ok.reader = pipe.reader();
+
+    http::Pipe::Writer writer = pipe.writer();
+    foreach (const string& chunk, chunks) {
+      writer.write(chunk);
+    }
+    writer.close();
+
+    return ok;
+  }
+
+  vector<string> chunks;
+};
+
+
+// Measures the throughput and the CPU time per (uncompressed) byte of
+// streaming a state sized response with each of the content codings.
+// The client reads the raw response off a socket, so that the CPU time
+// is mostly spent by the server, and the bytes read are the ones which
+// went on the wire.
+TEST_P(HttpCompression_BENCHMARK_Test, Pipe)
+{
+  StateProcess state(GetParam());
+  const UPID pid = spawn(state);
+
+  vector<string> encodings = {"identity", "gzip"};
+#ifdef USE_ZSTD
+  encodings.push_back("zstd");
+#endif // USE_ZSTD
+
+  foreach (const string& encoding, encodings) {
+    Try<process::network::inet::Socket> socket =
+      process::network::inet::Socket::create();
+    ASSERT_SOME(socket);
+
+    AWAIT_READY(socket->connect(pid.address));
+
+    const string request =
+      "GET /" + pid.id + "/state HTTP/1.1\r\n"
+      "Host: " + stringify(pid.address) + "\r\n"
+      "Accept-Encoding: " + encoding + "\r\n"
+      "\r\n";
+
+    Stopwatch watch;
+    watch.start();
+    const std::clock_t start = std::clock();
+
+    AWAIT_READY(socket->send(request));
+
+    // Read until the last chunk of the body.
+    const string last = "\r\n0\r\n\r\n";
+
+    Bytes read;
+    string tail;
+    while (tail.size() < last.size() ||
+           tail.compare(tail.size() - last.size(), last.size(), last) != 0) {
+      Future<string> data = socket->recv();
+      AWAIT_READY(data);
+      ASSERT_FALSE(data->empty());
+
+      read += Bytes(data->size());
+      tail = tail.substr(tail.size() - std::min(tail.size(), last.size()));
+      tail += data.get();
+    }
+
+    const double cpu = static_cast<double>(std::clock() - start) /
+      CLOCKS_PER_SEC;
+
+    watch.stop();
+
+    cout << encoding << ": streamed " << GetParam() << " as " << read
+         << " in " << watch.elapsed() << " ("
+         << GetParam().bytes() / watch.elapsed().secs() / Megabytes(1).bytes()
+         << " MB/s, " << cpu * 1e9 / GetParam().bytes()
+         << " ns of CPU per byte)" << endl;
+  }
+
+  terminate(state);
+  wait(state);
+}
+
+
+class HttpMultiplexing_BENCHMARK_Test
+  : public ::testing::Test,
+    public WithParamInterface<size_t> {};
+
+
+// Parameterized by the number of requests sent behind a slow request.
+INSTANTIATE_TEST_CASE_P(
+    Requests,
+    HttpMultiplexing_BENCHMARK_Test,
+    ::testing::Values(100U, 1000U, 10000U));
+
+
+class LatencyProcess : public Process<LatencyProcess>
+{
+protected:
+  void initialize() override
+  {
+    route("/fast", None(), &LatencyProcess::fast);
+    route("/slow", None(), &LatencyProcess::slow);
+  }
+
+private:
+  Future<http::Response> fast(const http::Request& request)
+  {
+    return http::OK("fast");
+  }
+
+  Future<http::Response> slow(const http::Request& request)
+  {
+    return process::after(Milliseconds(500))
+      .then([]() -> http::Response { return http::OK("slow"); });
+  }
+};
+
+
+// Measures how long the responses to many cheap requests take when
+// they are sent on a single connection right after a slow request.
+// Over HTTP/1.1 the responses are pipelined and thus wait for the slow
+// one (head-of-line blocking), while over HTTP/2 each request has its
+// own stream. HTTP/2 only helps while the cheap requests take less in
+// total than the slow one; past that, both protocols are bound by the
+// cost of handling each request.
+TEST_P(HttpMultiplexing_BENCHMARK_Test, SlowRequest)
+{
+  LatencyProcess process;
+  const UPID pid = spawn(process);
+
+  vector<http::Protocol> protocols = {http::Protocol::HTTP_1_1};
+#ifdef USE_HTTP2
+  protocols.push_back(http::Protocol::HTTP_2);
+#endif // USE_HTTP2
+
+  foreach (const http::Protocol& protocol, protocols) {
+    Future<http::Connection> connect =
+      http::connect(pid.address, http::Scheme::HTTP, None(), protocol);
+    AWAIT_READY(connect);
+
+    http::Connection connection = connect.get();
+
+    http::Request request;
+    request.method = "GET";
+    request.keepAlive = true;
+    request.url = http::URL(
+        "http", pid.address.ip, pid.address.port, pid.id + "/slow");
+
+    Stopwatch watch;
+    watch.start();
+
+    Future<http::Response> slow = connection.send(request);
+
+    request.url.path = pid.id + "/fast";
+
+    vector<Future<http::Response>> responses;
+    responses.reserve(GetParam());
+    for (size_t i = 0; i < GetParam(); ++i) {
+      responses.push_back(connection.send(request));
+    }
+
+    AWAIT_READY(collect(responses));
+
+    const Duration fast = watch.elapsed();
+
+    AWAIT_READY(slow);
+
+    cout << (protocol == http::Protocol::HTTP_2 ? "HTTP/2" : "HTTP/1.1")
+         << ": " << GetParam() << " requests took " << fast
+         << " behind a request taking " << watch.elapsed() << endl;
+
+    AWAIT_READY(connection.disconnect());
+  }
+
+  terminate(process);
+  wait(process);
+}
+
+
+#ifdef USE_SSL_SOCKET
+class SSLHandshake_BENCHMARK_Test
+  : public SSLTest,
+    public WithParamInterface<size_t> {};
+
+
+// Parameterized by the size of the session cache, i.e., without
+// session resumption and with it.
+INSTANTIATE_TEST_CASE_P(
+    SessionCacheSize,
+    SSLHandshake_BENCHMARK_Test,
+    ::testing::Values(0U, 1024U));
+
+
+// Measures the rate at which a client connects to the same server.
+TEST_P(SSLHandshake_BENCHMARK_Test, Reconnect)
+{
+  const size_t connections = 1000;
+
+  set_environment_variables({
+      {"LIBPROCESS_SSL_ENABLED", "true"},
+      {"LIBPROCESS_SSL_KEY_FILE", key_path().string()},
+      {"LIBPROCESS_SSL_CERT_FILE", certificate_path().string()},
+      {"LIBPROCESS_SSL_SESSION_CACHE_SIZE", stringify(GetParam())}});
+
+  Try<Socket> server = Socket::create(SocketImpl::Kind::SSL);
+  ASSERT_SOME(server);
+
+  ASSERT_SOME(server->bind(inet4::Address::LOOPBACK_ANY()));
+  ASSERT_SOME(server->listen(BACKLOG));
+
+  Try<inet::Address> address = server->address();
+  ASSERT_SOME(address);
+
+  Stopwatch watch;
+  watch.start();
+
+  for (size_t i = 0; i < connections; i++) {
+    Try<Socket> client = Socket::create(SocketImpl::Kind::SSL);
+    ASSERT_SOME(client);
+
+    Future<Socket> accept = server->accept();
+
+    AWAIT_READY(client->connect(
+        address.get(),
+        network::openssl::create_tls_client_config(None())));
+
+    AWAIT_READY(accept);
+
+    // Read past the handshake, which is when a TLS 1.3 client gets
+    // the session to resume.
+    AWAIT_READY(Socket(accept.get()).send(data));
+    AWAIT_EQ(data, client->recv(data.size()));
+  }
+
+  watch.stop();
+
+  cout << connections << " connections took " << watch.elapsed() << " ("
+       << connections / watch.elapsed().secs() << " connections/s, "
+       << SSL_CTX_sess_hits(network::openssl::context())
+       << " sessions resumed)" << endl;
+
+  set_environment_variables({});
+}
+
+
+class SSLThroughput_BENCHMARK_Test
+  : public SSLTest,
+    public WithParamInterface<bool> {};
+
+
+// Parameterized by whether kTLS is enabled.
+INSTANTIATE_TEST_CASE_P(
+    KernelTLS,
+    SSLThroughput_BENCHMARK_Test,
+    ::testing::Bool());
+
+
+// Measures the throughput and the CPU time per byte of sending data
+// from memory and from a file over a TLS connection.
+TEST_P(SSLThroughput_BENCHMARK_Test, Send)
+{
+  const Bytes size = Megabytes(256);
+  const Bytes chunk = Megabytes(1);
+
+  set_environment_variables({
+      {"LIBPROCESS_SSL_ENABLED", "true"},
+      {"LIBPROCESS_SSL_KEY_FILE", key_path().string()},
+      {"LIBPROCESS_SSL_CERT_FILE", certificate_path().string()},
+      {"LIBPROCESS_SSL_CIPHERS", "AES128-GCM-SHA256"},
+      {"LIBPROCESS_SSL_ENABLE_KTLS", GetParam() ? "true" : "false"}});
+
+  Try<Socket> server = Socket::create(SocketImpl::Kind::SSL);
+  ASSERT_SOME(server);
+
+  ASSERT_SOME(server->bind(inet4::Address::LOOPBACK_ANY()));
+  ASSERT_SOME(server->listen(BACKLOG));
+
+  Try<inet::Address> address = server->address();
+  ASSERT_SOME(address);
+
+  Try<Socket> client = Socket::create(SocketImpl::Kind::SSL);
+  ASSERT_SOME(client);
+
+  Future<Socket> accept = server->accept();
+
+  AWAIT_READY(client->connect(
+      address.get(),
+      network::openssl::create_tls_client_config(None())));
+
+  AWAIT_READY(accept);
+
+  Socket socket = accept.get();
+
+  const string buffer(chunk.bytes(), 'x');
+  const string path = path::join(sandbox.get(), "file");
+
+  string contents;
+  for (Bytes written; written < size; written += chunk) {
+    contents += buffer;
+  }
+
+  ASSERT_SOME(os::write(path, contents));
+  contents.clear();
+
+  Try<int_fd> fd = os::open(path, O_RDONLY | O_CLOEXEC);
+  ASSERT_SOME(fd);
+
+  // Receives everything that is sent, without keeping it.
+  auto receive = [&client, size]() {
+    std::shared_ptr<size_t> received(new size_t(0));
+    std::shared_ptr<string> data(new string(Kilobytes(64).bytes(), '\0'));
+
+    return process::loop(
+        [=]() {
+          return client->recv(&(*data)[0], data->size());
+        },
+        [=](size_t length) -> ControlFlow<Nothing> {
+          *received += length;
+          if (length == 0 || *received >= size.bytes()) {
+            return Break();
+          }
+          return Continue();
+        });
+  };
+
+  foreach (const string& source, vector<string>({"memory", "file"})) {
+    Stopwatch watch;
+    watch.start();
+    const std::clock_t start = std::clock();
+
+    Future<Nothing> received = receive();
+
+    if (source == "memory") {
+      for (Bytes sent; sent < size; sent += chunk) {
+        AWAIT_READY(socket.send(buffer));
+      }
+    } else {
+      AWAIT_EXPECT_EQ(size.bytes(), socket.sendfile(fd.get(), 0, size.bytes()));
+    }
+
+    AWAIT_READY(received);
+
+    const double cpu = static_cast<double>(std::clock() - start) /
+      CLOCKS_PER_SEC;
+
+    watch.stop();
+
+    cout << "kTLS " << (GetParam() ? "enabled" : "disabled") << ": sent "
+         << size << " from " << source << " in " << watch.elapsed() << " ("
+         << size.bytes() / watch.elapsed().secs() / Megabytes(1).bytes()
+         << " MB/s, " << cpu * 1e9 / size.bytes()
+         << " ns of CPU per byte)" << endl;
+  }
+
+  ASSERT_SOME(os::close(fd.get()));
+
+  set_environment_variables({});
+}
+#endif // USE_SSL_SOCKET
+
+
+// The event loop which the socket benchmarks below run on, so that
+// their results can be compared across builds.
+#if defined(USE_IO_URING)
+static const char EVENT_LOOP[] = "io_uring";
+#elif defined(USE_LIBEVENT)
+static const char EVENT_LOOP[] = "libevent";
+#elif defined(ENABLE_LIBWINIO)
+static const char EVENT_LOOP[] = "libwinio";
+#else
+static const char EVENT_LOOP[] = "libev";
+#endif
+
+
+// Receives exactly `size` bytes from the socket.
+static Future<Nothing> receive(Socket socket, size_t size)
+{
+  std::shared_ptr<size_t> received(new size_t(0));
+  std::shared_ptr<string> data(new string(size, '\0'));
+
+  return process::loop(
+      [=]() {
+        return socket.recv(&(*data)[*received], size - *received);
+      },
+      [=](size_t length) -> Future<ControlFlow<Nothing>> {
+        if (length == 0) {
+          return process::Failure("Unexpected EOF");
+        }
+
+        *received += length;
+        if (*received < size) {
+          return Continue();
+        }
+
+        return Break();
+      });
+}
+
+
+// Sends back whatever is received on the socket, until EOF.
+static Future<Nothing> echo(Socket socket, size_t size)
+{
+  std::shared_ptr<string> data(new string(size, '\0'));
+
+  return process::loop(
+      [=]() {
+        return socket.recv(&(*data)[0], data->size());
+      },
+      [=](size_t length) mutable -> Future<ControlFlow<Nothing>> {
+        if (length == 0) {
+          return Break();
+        }
+
+        return socket.send(data->substr(0, length))
+          .then([]() -> ControlFlow<Nothing> {
+            return Continue();
+          });
+      });
+}
+
+
+class SocketRPC_BENCHMARK_Test
+  : public ::testing::Test,
+    public WithParamInterface<size_t> {};
+
+
+// Parameterized by the number of concurrent connections.
+INSTANTIATE_TEST_CASE_P(
+    Connections,
+    SocketRPC_BENCHMARK_Test,
+    ::testing::Values(1U, 16U, 256U));
+
+
+// Measures the rate of small request/response round trips over
+// loopback connections, each of which has one request in flight.
+TEST_P(SocketRPC_BENCHMARK_Test, SmallMessages)
+{
+  const size_t connections = GetParam();
+  const size_t requests = 100000;
+  const string message(64, 'x');
+
+  Try<Socket> server = Socket::create(SocketImpl::Kind::POLL);
+  ASSERT_SOME(server);
+
+  ASSERT_SOME(server->bind(inet4::Address::LOOPBACK_ANY()));
+  ASSERT_SOME(server->listen(static_cast<int>(connections)));
+
+  Try<inet::Address> address = server->address();
+  ASSERT_SOME(address);
+
+  vector<Socket> clients;
+  vector<Future<Nothing>> echoes;
+
+  for (size_t i = 0; i < connections; i++) {
+    Try<Socket> client = Socket::create(SocketImpl::Kind::POLL);
+    ASSERT_SOME(client);
+
+    Future<Socket> accept = server->accept();
+
+    AWAIT_READY(client->connect(address.get()));
+    AWAIT_READY(accept);
+
+    clients.push_back(client.get());
+    echoes.push_back(echo(accept.get(), message.size()));
+  }
+
+  Stopwatch watch;
+  watch.start();
+
+  vector<Future<Nothing>> rpcs;
+
+  foreach (Socket client, clients) {
+    std::shared_ptr<size_t> remaining(
+        new size_t(requests / connections));
+
+    rpcs.push_back(process::loop(
+        [=]() mutable {
+          return client.send(message)
+            .then([=]() {
+              return receive(client, message.size());
+            });
+        },
+        [=](const Nothing&) -> ControlFlow<Nothing> {
+          if (--(*remaining) == 0) {
+            return Break();
+          }
+          return Continue();
+        }));
+  }
+
+  AWAIT_READY_FOR(collect(rpcs), Minutes(5));
+
+  watch.stop();
+
+  const size_t total = (requests / connections) * connections;
+
+  cout << EVENT_LOOP << ": " << total << " round trips of "
+       << message.size() << " bytes over " << connections
+       << " connections took " << watch.elapsed() << " ("
+       << total / watch.elapsed().secs() << " round trips/s)" << endl;
+
+  foreach (Socket client, clients) {
+    ASSERT_SOME(client.shutdown(Socket::Shutdown::WRITE));
+  }
+
+  AWAIT_READY(collect(echoes));
+}
+
+
+// Measures the throughput of a large transfer over a loopback
+// connection.
+TEST(SocketThroughput_BENCHMARK_Test, LargeTransfer)
+{
+  const Bytes size = Gigabytes(1);
+  const Bytes chunk = Megabytes(1);
+
+  Try<Socket> server = Socket::create(SocketImpl::Kind::POLL);
+  ASSERT_SOME(server);
+
+  ASSERT_SOME(server->bind(inet4::Address::LOOPBACK_ANY()));
+  ASSERT_SOME(server->listen(1));
+
+  Try<inet::Address> address = server->address();
+  ASSERT_SOME(address);
+
+  Try<Socket> client = Socket::create(SocketImpl::Kind::POLL);
+  ASSERT_SOME(client);
+
+  Future<Socket> accept = server->accept();
+
+  AWAIT_READY(client->connect(address.get()));
+  AWAIT_READY(accept);
+
+  Socket socket = accept.get();
+
+  const string buffer(chunk.bytes(), 'x');
+
+  Stopwatch watch;
+  watch.start();
+
+  Future<Nothing> received = receive(client.get(), size.bytes());
+
+  for (Bytes sent; sent < size; sent += chunk) {
+    AWAIT_READY(socket.send(buffer));
+  }
+
+  AWAIT_READY_FOR(received, Minutes(5));
+
+  watch.stop();
+
+  cout << EVENT_LOOP << ": sent " << size << " in " << watch.elapsed()
+       << " (" << size.bytes() / watch.elapsed().secs() / Megabytes(1).bytes()
+       << " MB/s)" << endl;
+}
+
+
 TEST(ProcessTest, Process_BENCHMARK_MpscLinkedQueueEmpty)
 {
   const int messageCount = 1000000000;
@@ -12,6 +12,10 @@
 
 #include <gmock/gmock.h>
 
+#ifdef USE_ZSTD
+#include <zstd.h>
+#endif // USE_ZSTD
+
 #include <deque>
 #include <string>
 #include <vector>
@@ -20,13 +24,17 @@
 #include <process/owned.hpp>
 #include <process/socket.hpp>
 
+#include <stout/foreach.hpp>
 #include <stout/gtest.hpp>
+#include <stout/gzip.hpp>
+#include <stout/try.hpp>
 
 #include "encoder.hpp"
 #include "decoder.hpp"
 
 namespace http = process::http;
 
+using process::Compressor;
 using process::HttpResponseEncoder;
 using process::Owned;
 using process::ResponseDecoder;
@@ -115,3 +123,174 @@ TEST(EncoderTest, AcceptableEncodings)
       << gzipRequest.headers.get("Accept-Encoding").get() << "'";
   }
 }
+
+
+TEST(EncoderTest, EncodingQuality)
+{
+  http::Request request;
+  EXPECT_DOUBLE_EQ(0.0, request.encodingQuality("gzip"));
+
+  request.headers["Accept-Encoding"] = "GZIP;q=0.5, *;q=0.1";
+  EXPECT_DOUBLE_EQ(0.5, request.encodingQuality("gzip"));
+  EXPECT_DOUBLE_EQ(0.1, request.encodingQuality("zstd"));
+  EXPECT_DOUBLE_EQ(0.0, request.encodingQuality("zstd", false));
+
+  // A missing q value means 1.
+  request.headers["Accept-Encoding"] = "compress, gzip";
+  EXPECT_DOUBLE_EQ(1.0, request.encodingQuality("gzip"));
+
+  // A q value of 0 refuses the coding, even if "*" is acceptable.
+  request.headers["Accept-Encoding"] = "gzip;q=0, *";
+  EXPECT_DOUBLE_EQ(0.0, request.encodingQuality("gzip"));
+  EXPECT_FALSE(request.acceptsEncoding("gzip"));
+  EXPECT_NONE(Compressor::negotiate(request));
+
+  // A q value which is not a number refuses the coding as well.
+  request.headers["Accept-Encoding"] = "gzip;q=high, *";
+  EXPECT_DOUBLE_EQ(0.0, request.encodingQuality("gzip"));
+  EXPECT_FALSE(request.acceptsEncoding("gzip"));
+  EXPECT_NONE(Compressor::negotiate(request));
+
+  // Multiple q values are ignored, as if there was none.
+  request.headers["Accept-Encoding"] = "gzip;q=0;q=0.5";
+  EXPECT_DOUBLE_EQ(1.0, request.encodingQuality("gzip"));
+  EXPECT_TRUE(request.acceptsEncoding("gzip"));
+  EXPECT_SOME_EQ("gzip", Compressor::negotiate(request));
+}
+
+
+static Try<string> decompress(const string& encoding, const string& data)
+{
+#ifdef USE_ZSTD
+  if (encoding == "zstd") {
+    ZSTD_DCtx* context = ZSTD_createDCtx();
+    ZSTD_inBuffer input = {data.data(), data.size(), 0};
+
+    string result;
+    ZSTD_outBuffer output;
+    do {
+      char buffer[4096];
+      output = {buffer, sizeof(buffer), 0};
+
+      size_t code = ZSTD_decompressStream(context, &output, &input);
+      if (ZSTD_isError(code)) {
+        ZSTD_freeDCtx(context);
+        return Error(ZSTD_getErrorName(code));
+      }
+
+      result.append(buffer, output.pos);
+    } while (input.pos < input.size || output.pos == output.size);
+
+    ZSTD_freeDCtx(context);
+    return result;
+  }
+#endif // USE_ZSTD
+
+  CHECK_EQ("gzip", encoding);
+  return gzip::decompress(data);
+}
+
+
+TEST(EncoderTest, Compressor)
+{
+  http::Request request;
+  EXPECT_NONE(Compressor::negotiate(request));
+
+  request.headers["Accept-Encoding"] = "compress, gzip";
+  EXPECT_SOME_EQ("gzip", Compressor::negotiate(request));
+
+  request.headers["Accept-Encoding"] = "gzip;q=0, *";
+  EXPECT_NONE(Compressor::negotiate(request));
+
+  request.headers["Accept-Encoding"] = "compress;q=0.5, *;q=0.1";
+  EXPECT_SOME_EQ("gzip", Compressor::negotiate(request));
+
+  vector<string> encodings = {"gzip"};
+
+#ifdef USE_ZSTD
+  request.headers["Accept-Encoding"] = "gzip, zstd";
+  EXPECT_SOME_EQ("zstd", Compressor::negotiate(request));
+
+  // The client's ranking takes precedence over ours.
+  request.headers["Accept-Encoding"] = "zstd;q=0.5, gzip";
+  EXPECT_SOME_EQ("gzip", Compressor::negotiate(request));
+
+  request.headers["Accept-Encoding"] = "zstd;q=0";
+  EXPECT_NONE(Compressor::negotiate(request));
+
+  // A wildcard does not select zstd.
+  request.headers["Accept-Encoding"] = "*";
+  EXPECT_SOME_EQ("gzip", Compressor::negotiate(request));
+
+  encodings.push_back("zstd");
+#endif // USE_ZSTD
+
+  const vector<string> chunks = {"hello", "", "world"};
+
+  foreach (const string& encoding, encodings) {
+    Owned<Compressor> compressor = Compressor::create(encoding);
+
+    // Each chunk gets flushed, so that what was compressed so far
+    // can be decompressed before the stream ends.
+    string compressed;
+    string expected;
+    foreach (const string& chunk, chunks) {
+      Try<string> data = compressor->compress(chunk);
+      ASSERT_SOME(data);
+      EXPECT_EQ(chunk.empty(), data->empty());
+
+      compressed += data.get();
+      expected += chunk;
+
+      Try<string> decompressed = decompress(encoding, compressed);
+      if (encoding == "gzip") {
+        // `gzip::decompress` expects a complete stream.
+        EXPECT_ERROR(decompressed);
+      } else {
+        EXPECT_SOME_EQ(expected, decompressed);
+      }
+    }
+
+    Try<string> last = compressor->finish("!");
+    ASSERT_SOME(last);
+
+    EXPECT_SOME_EQ(
+        expected + "!",
+        decompress(encoding, compressed + last.get()));
+  }
+}
+
+
+TEST(EncoderTest, CompressedResponse)
+{
+  http::Request request;
+  request.headers["Accept-Encoding"] = "gzip";
+
+  // Small bodies are not worth compressing.
+  string encoded = HttpResponseEncoder::encode(http::OK("body"), request);
+
+  ResponseDecoder decoder;
+  deque<http::Response*> responses =
+    decoder.decode(encoded.data(), encoded.length());
+
+  ASSERT_FALSE(decoder.failed());
+  ASSERT_EQ(1u, responses.size());
+
+  Owned<http::Response> decoded(responses[0]);
+  EXPECT_EQ("body", decoded->body);
+  EXPECT_NONE(decoded->headers.get("Content-Encoding"));
+
+  const string body(process::GZIP_MINIMUM_BODY_LENGTH, 'a');
+
+  encoded = HttpResponseEncoder::encode(http::OK(body), request);
+  EXPECT_GT(body.size(), encoded.size());
+
+  responses = decoder.decode(encoded.data(), encoded.length());
+
+  ASSERT_FALSE(decoder.failed());
+  ASSERT_EQ(1u, responses.size());
+
+  decoded.reset(responses[0]);
+  EXPECT_EQ(body, decoded->body);
+  EXPECT_SOME_EQ("gzip", decoded->headers.get("Content-Encoding"));
+}
@@ -13,6 +13,7 @@
 #include <gtest/gtest.h>
 
 #include <string>
+#include <vector>
 
 #include <process/clock.hpp>
 #include <process/future.hpp>
@@ -32,6 +33,7 @@ using process::Promise;
 using process::undiscardable;
 
 using std::string;
+using std::vector;
 
 
 TEST(FutureTest, Future)
@@ -172,6 +174,32 @@ TEST(FutureTest, OnAny)
 }
 
 
+// Tests that callbacks run in the order they were added, whether or
+// not they fit in the inline storage of the future.
+TEST(FutureTest, CallbackOrder)
+{
+  Promise<int> promise;
+
+  vector<string> calls;
+
+  for (int i = 0; i < 3; i++) {
+    promise.future()
+      .onAny([&calls, i](const Future<int>&) {
+        calls.push_back("any" + stringify(i));
+      })
+      .onReady([&calls, i](int) {
+        calls.push_back("ready" + stringify(i));
+      });
+  }
+
+  promise.set(42);
+
+  EXPECT_EQ(
+      vector<string>({"ready0", "ready1", "ready2", "any0", "any1", "any2"}),
+      calls);
+}
+
+
 static Future<string> itoa1(int* const& i)
 {
   std::ostringstream out;
@@ -21,7 +21,12 @@
 #include <netinet/tcp.h>
 #endif // __WINDOWS__
 
+#ifdef USE_ZSTD
+#include <zstd.h>
+#endif // USE_ZSTD
+
 #include <algorithm>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -620,6 +625,84 @@ TEST_P(HTTPTest, PipeReaderCloses)
 }
 
 
+TEST_P(HTTPTest, PipeDrained)
+{
+  http::Pipe pipe;
+  http::Pipe::Reader reader = pipe.reader();
+  http::Pipe::Writer writer = pipe.writer();
+
+  // The pipe is not drained until the reader waits for data.
+  Future<Nothing> drained = writer.drained();
+  EXPECT_TRUE(drained.isPending());
+
+  Future<string> read = reader.read();
+  AWAIT_READY(drained);
+
+  // Writing to a waiting reader does not buffer any data.
+  EXPECT_TRUE(writer.write("hello"));
+  AWAIT_EQ("hello", read);
+
+  // Buffered data needs to be read before the pipe is drained.
+  EXPECT_TRUE(writer.write("world"));
+
+  drained = writer.drained();
+  EXPECT_TRUE(drained.isPending());
+
+  AWAIT_EQ("world", reader.read());
+  EXPECT_TRUE(drained.isPending());
+
+  read = reader.read();
+  AWAIT_READY(drained);
+
+  // The pipe is drained when the read end is closed.
+  EXPECT_TRUE(writer.write("!"));
+  AWAIT_EQ("!", read);
+
+  drained = writer.drained();
+  EXPECT_TRUE(drained.isPending());
+
+  EXPECT_TRUE(reader.close());
+  AWAIT_READY(drained);
+
+  // Waiting for the pipe to be drained is given up on when
+  // the write end is closed.
+  http::Pipe pipe2;
+  http::Pipe::Writer writer2 = pipe2.writer();
+
+  drained = writer2.drained();
+  EXPECT_TRUE(drained.isPending());
+
+  EXPECT_TRUE(writer2.close());
+  AWAIT_DISCARDED(drained);
+  AWAIT_DISCARDED(writer2.drained());
+}
+
+
+TEST_P(HTTPTest, PipePaced)
+{
+  http::Pipe pipe;
+  http::Pipe::Reader reader = pipe.reader();
+  http::Pipe::Writer writer = pipe.writer();
+
+  // A pipe is not paced unless its writer waits for it to be drained.
+  EXPECT_TRUE(writer.write("hello"));
+  EXPECT_FALSE(reader.paced());
+
+  AWAIT_EQ("hello", reader.read());
+  EXPECT_FALSE(reader.paced());
+
+  Future<Nothing> drained = writer.drained();
+  EXPECT_TRUE(reader.paced());
+
+  Future<string> read = reader.read();
+  AWAIT_READY(drained);
+
+  EXPECT_TRUE(writer.close());
+  AWAIT_EQ("", read);
+  EXPECT_TRUE(reader.paced());
+}
+
+
 TEST_P(HTTPTest, Encode)
 {
   string unencoded = "a$&+,/:;=?@ \"<>#%{}|\\^~[]`\x19\x80\xFF";
@@ -847,6 +930,176 @@ TEST_P(HTTPTest, StreamingGetComplete)
 }
 
 
+// This test verifies that a streamed response gets compressed chunk
+// by chunk when the client accepts gzip, so that each chunk can be
+// read before the response is complete.
+TEST_P(HTTPTest, StreamingGetGzip)
+{
+  Http http;
+
+  http::Pipe pipe;
+  http::OK ok;
+  ok.type = http::Response::PIPE;
+  ok.reader = pipe.reader();
+
+  EXPECT_CALL(*http.process, pipe(_))
+    .WillOnce(Return(ok));
+
+  http::Headers headers;
+  headers["Accept-Encoding"] = "gzip";
+
+  Future<http::Response> response = http::streaming::get(
+      http.process->self(), "pipe", None(), headers, GetParam());
+
+  AWAIT_READY(response);
+
+  EXPECT_SOME_EQ("chunked", response->headers.get("Transfer-Encoding"));
+  EXPECT_SOME_EQ("gzip", response->headers.get("Content-Encoding"));
+  ASSERT_EQ(http::Response::PIPE, response->type);
+  ASSERT_SOME(response->reader);
+
+  http::Pipe::Reader reader = response->reader.get();
+  http::Pipe::Writer writer = pipe.writer();
+
+  // NOTE: A chunk may be decompressed in more than one read.
+  vector<string> chunks = {"hello", string(1024 * 1024, 'a'), "goodbye"};
+  foreach (const string& chunk, chunks) {
+    EXPECT_TRUE(writer.write(chunk));
+
+    string read;
+    while (read.size() < chunk.size()) {
+      Future<string> future = reader.read();
+      AWAIT_READY(future);
+      ASSERT_FALSE(future->empty());
+
+      read += future.get();
+    }
+
+    EXPECT_EQ(chunk, read);
+  }
+
+  // Complete the response.
+  EXPECT_TRUE(writer.close());
+  AWAIT_EQ("", reader.read()); // EOF.
+
+  // A non-streaming request gets the whole body decompressed.
+  http::Pipe pipe2;
+  ok.reader = pipe2.reader();
+
+  EXPECT_CALL(*http.process, pipe(_))
+    .WillOnce(Return(ok));
+
+  EXPECT_TRUE(pipe2.writer().write("hello"));
+  EXPECT_TRUE(pipe2.writer().write("goodbye"));
+  EXPECT_TRUE(pipe2.writer().close());
+
+  response =
+    http::get(http.process->self(), "pipe", None(), headers, GetParam());
+
+  AWAIT_READY(response);
+  EXPECT_SOME_EQ("gzip", response->headers.get("Content-Encoding"));
+  EXPECT_EQ("hellogoodbye", response->body);
+}
+
+
+#ifdef USE_ZSTD
+// This test verifies that a streamed response gets compressed chunk
+// by chunk when the client prefers zstd, so that each chunk can be
+// decompressed before the response is complete.
+TEST_P(HTTPTest, StreamingGetZstd)
+{
+  Http http;
+
+  http::Pipe pipe;
+  http::OK ok;
+  ok.type = http::Response::PIPE;
+  ok.reader = pipe.reader();
+
+  EXPECT_CALL(*http.process, pipe(_))
+    .WillOnce(Return(ok));
+
+  http::Headers headers;
+  headers["Accept-Encoding"] = "gzip;q=0.5, zstd";
+
+  Future<http::Response> response = http::streaming::get(
+      http.process->self(), "pipe", None(), headers, GetParam());
+
+  AWAIT_READY(response);
+
+  EXPECT_SOME_EQ("chunked", response->headers.get("Transfer-Encoding"));
+  EXPECT_SOME_EQ("zstd", response->headers.get("Content-Encoding"));
+  ASSERT_EQ(http::Response::PIPE, response->type);
+  ASSERT_SOME(response->reader);
+
+  http::Pipe::Reader reader = response->reader.get();
+  http::Pipe::Writer writer = pipe.writer();
+
+  // NOTE: The client does not decompress zstd, so we decompress what
+  // we read so far ourselves.
+  std::shared_ptr<ZSTD_DCtx> context(ZSTD_createDCtx(), &ZSTD_freeDCtx);
+  ASSERT_NE(nullptr, context.get());
+
+  auto decompress = [&context](const string& data) -> Try<string> {
+    ZSTD_inBuffer input = {data.data(), data.size(), 0};
+
+    string result;
+    vector<char> buffer(ZSTD_DStreamOutSize());
+
+    ZSTD_outBuffer output;
+    do {
+      output = {buffer.data(), buffer.size(), 0};
+
+      size_t code = ZSTD_decompressStream(context.get(), &output, &input);
+      if (ZSTD_isError(code)) {
+        return Error(ZSTD_getErrorName(code));
+      }
+
+      result.append(buffer.data(), output.pos);
+    } while (input.pos < input.size || output.pos == output.size);
+
+    return result;
+  };
+
+  // NOTE: A chunk may be decompressed in more than one read.
+  vector<string> chunks = {"hello", string(1024 * 1024, 'a'), "goodbye"};
+  foreach (const string& chunk, chunks) {
+    EXPECT_TRUE(writer.write(chunk));
+
+    string read;
+    while (read.size() < chunk.size()) {
+      Future<string> future = reader.read();
+      AWAIT_READY(future);
+      ASSERT_FALSE(future->empty());
+
+      Try<string> decompressed = decompress(future.get());
+      ASSERT_SOME(decompressed);
+
+      read += decompressed.get();
+    }
+
+    EXPECT_EQ(chunk, read);
+  }
+
+  // Complete the response.
+  EXPECT_TRUE(writer.close());
+
+  string rest;
+  while (true) {
+    Future<string> future = reader.read();
+    AWAIT_READY(future);
+
+    if (future->empty()) {
+      break; // EOF.
+    }
+
+    rest += future.get();
+  }
+
+  EXPECT_SOME_EQ("", decompress(rest));
+}
+#endif // USE_ZSTD
+
+
 TEST_P(HTTPTest, StreamingGetFailure)
 {
   Http http;
@@ -1553,6 +1806,192 @@ TEST(HTTPConnectionTest, RequestStreaming)
 }
 
 
+#ifdef USE_HTTP2
+// Tests that responses on an HTTP/2 connection complete as soon as
+// they are ready, rather than in the order of the requests as they
+// do when pipelining over HTTP/1.1.
+TEST(HTTP2ConnectionTest, Multiplexing)
+{
+  Http http;
+
+  http::URL url = http::URL(
+      "http",
+      http.process->self().address.ip,
+      http.process->self().address.port,
+      http.process->self().id + "/get");
+
+  Future<http::Connection> connect = http::connect(
+      http.process->self().address,
+      http::Scheme::HTTP,
+      None(),
+      http::Protocol::HTTP_2);
+
+  AWAIT_READY(connect);
+
+  http::Connection connection = connect.get();
+
+  Promise<http::Response> promise1, promise2;
+  Future<http::Request> get1, get2;
+
+  EXPECT_CALL(*http.process, get(_))
+    .WillOnce(DoAll(FutureArg<0>(&get1), Return(promise1.future())))
+    .WillOnce(DoAll(FutureArg<0>(&get2), Return(promise2.future())));
+
+  http::Request request1, request2;
+
+  request1.method = "GET";
+  request2.method = "GET";
+
+  request1.url = url;
+  request2.url = url;
+
+  request1.body = "1";
+  request2.body = "2";
+
+  Future<http::Response> response1 = connection.send(request1, true);
+  Future<http::Response> response2 = connection.send(request2);
+
+  AWAIT_READY(get1);
+  AWAIT_READY(get2);
+
+  EXPECT_EQ("1", get1->body);
+  EXPECT_EQ("2", get2->body);
+
+  // Start a streaming response for the first request (e.g., as for a
+  // SUBSCRIBE call) which stays open while the second request gets
+  // its response.
+  http::Pipe pipe;
+  http::OK ok;
+  ok.type = http::Response::PIPE;
+  ok.reader = pipe.reader();
+
+  promise1.set(ok);
+
+  AWAIT_READY(response1);
+  EXPECT_EQ(http::Status::OK, response1->code);
+  ASSERT_SOME(response1->reader);
+
+  http::Pipe::Reader reader = response1->reader.get();
+
+  pipe.writer().write("event");
+  AWAIT_EQ("event", reader.read());
+
+  promise2.set(http::OK("2"));
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(http::OK().status, response2);
+  EXPECT_EQ("2", response2->body);
+
+  // The streaming response is still open.
+  pipe.writer().write("another event");
+  AWAIT_EQ("another event", reader.read());
+
+  pipe.writer().close();
+  AWAIT_EQ("", reader.read());
+
+  AWAIT_READY(connection.disconnect());
+  AWAIT_READY(connection.disconnected());
+
+  // After disconnection, sends should fail.
+  AWAIT_FAILED(connection.send(request1));
+}
+
+
+TEST(HTTP2ConnectionTest, RequestStreaming)
+{
+  Http http;
+
+  http::URL url = http::URL(
+      "http",
+      http.process->self().address.ip,
+      http.process->self().address.port,
+      http.process->self().id + "/requeststreaming");
+
+  Future<http::Connection> connect = http::connect(
+      http.process->self().address,
+      http::Scheme::HTTP,
+      None(),
+      http::Protocol::HTTP_2);
+
+  AWAIT_READY(connect);
+
+  http::Connection connection = connect.get();
+
+  Promise<http::Response> promise;
+  Future<http::Request> expected;
+
+  EXPECT_CALL(*http.process, requestStreaming(_))
+    .WillOnce(DoAll(FutureArg<0>(&expected), Return(promise.future())));
+
+  http::Pipe pipe;
+
+  http::Request request;
+  request.method = "POST";
+  request.url = url;
+  request.type = http::Request::PIPE;
+  request.reader = pipe.reader();
+
+  Future<http::Response> response = connection.send(request);
+
+  AWAIT_READY(expected);
+  ASSERT_EQ(http::Request::PIPE, expected->type);
+  ASSERT_SOME(expected->reader);
+
+  http::Pipe::Reader reader = expected->reader.get();
+
+  pipe.writer().write("Hello");
+  pipe.writer().write(" world");
+  pipe.writer().close();
+
+  AWAIT_EXPECT_EQ("Hello world", reader.readAll());
+
+  promise.set(http::OK("1"));
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(http::OK().status, response);
+  EXPECT_EQ("1", response->body);
+
+  AWAIT_READY(connection.disconnect());
+  AWAIT_READY(connection.disconnected());
+}
+
+
+// Tests that a server which accepts HTTP/2 connections still serves
+// HTTP/1.1 connections, and that an HTTP/2 request to an unknown
+// endpoint gets a 404 like an HTTP/1.1 request does.
+TEST(HTTP2ConnectionTest, NotFound)
+{
+  Http http;
+
+  Future<http::Connection> connect = http::connect(
+      http.process->self().address,
+      http::Scheme::HTTP,
+      None(),
+      http::Protocol::HTTP_2);
+
+  AWAIT_READY(connect);
+
+  http::Connection connection = connect.get();
+
+  http::Request request;
+  request.method = "GET";
+  request.url = http::URL(
+      "http",
+      http.process->self().address.ip,
+      http.process->self().address.port,
+      http.process->self().id + "/unknown");
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(
+      http::NotFound().status,
+      connection.send(request));
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(
+      http::NotFound().status,
+      http::get(http.process->self(), "unknown"));
+
+  AWAIT_READY(connection.disconnect());
+}
+#endif // USE_HTTP2
+
+
 TEST_P(HTTPTest, QueryEncodeDecode)
 {
   // If we use Type<a, b> directly inside a macro without surrounding
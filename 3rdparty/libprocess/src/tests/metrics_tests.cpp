@@ -19,6 +19,7 @@
 #include <stout/base64.hpp>
 #include <stout/duration.hpp>
 #include <stout/gtest.hpp>
+#include <stout/strings.hpp>
 
 #include <process/authenticator.hpp>
 #include <process/clock.hpp>
@@ -30,6 +31,7 @@
 #include <process/time.hpp>
 
 #include <process/metrics/counter.hpp>
+#include <process/metrics/histogram.hpp>
 #include <process/metrics/metrics.hpp>
 #include <process/metrics/pull_gauge.hpp>
 #include <process/metrics/push_gauge.hpp>
@@ -48,6 +50,8 @@ using http::Response;
 using http::Unauthorized;
 
 using metrics::Counter;
+using metrics::Distribution;
+using metrics::Histogram;
 using metrics::PullGauge;
 using metrics::PushGauge;
 using metrics::Timer;
@@ -84,9 +88,17 @@ public:
     return promise.future();
   }
 
+  // Returns how many times it has been called.
+  double calls()
+  {
+    return ++count;
+  }
+
   // Need to use a promise for the call to pending instead of just a
   // `Future<double>()` so we don't return an abandoned future.
   Promise<double> promise;
+
+  double count = 0.0;
 };
 
 
@@ -174,6 +186,63 @@ TEST_F(MetricsTest, PullGauge)
 }
 
 
+// Tests that snapshots are served from the cache of a cached pull
+// gauge, and that the cache is refreshed in the background once it
+// gets stale.
+TEST_F(MetricsTest, CachedPullGauge)
+{
+  Clock::pause();
+
+  PullGaugeProcess process;
+  PID<PullGaugeProcess> pid = spawn(&process);
+  ASSERT_TRUE(pid);
+
+  PullGauge gauge(
+      "test/cached_gauge",
+      defer(pid, &PullGaugeProcess::calls),
+      Seconds(1));
+
+  AWAIT_READY(metrics::add(gauge));
+
+  // Nothing is cached yet, so the first snapshot waits for the value.
+  Future<map<string, double>> snapshot = metrics::snapshot(None());
+  AWAIT_READY(snapshot);
+  EXPECT_EQ(1.0, snapshot->at("test/cached_gauge"));
+
+  // The cached value is still fresh, so the gauge is not called again.
+  snapshot = metrics::snapshot(None());
+  AWAIT_READY(snapshot);
+  EXPECT_EQ(1.0, snapshot->at("test/cached_gauge"));
+
+  Clock::settle();
+
+  snapshot = metrics::snapshot(None());
+  AWAIT_READY(snapshot);
+  EXPECT_EQ(1.0, snapshot->at("test/cached_gauge"));
+
+  // Once the cached value is stale, the snapshot still returns it but
+  // triggers a refresh.
+  Clock::advance(Seconds(1));
+
+  snapshot = metrics::snapshot(None());
+  AWAIT_READY(snapshot);
+  EXPECT_EQ(1.0, snapshot->at("test/cached_gauge"));
+
+  Clock::settle();
+
+  snapshot = metrics::snapshot(None());
+  AWAIT_READY(snapshot);
+  EXPECT_EQ(2.0, snapshot->at("test/cached_gauge"));
+
+  AWAIT_READY(metrics::remove(gauge));
+
+  terminate(process);
+  wait(process);
+
+  Clock::resume();
+}
+
+
 TEST_F(MetricsTest, PushGauge)
 {
   // Gauge with a value.
@@ -600,6 +669,129 @@ TEST_F(MetricsTest, AsyncTimer)
 }
 
 
+TEST_F(MetricsTest, Histogram)
+{
+  EXPECT_EQ(vector<double>({1.0, 2.0, 4.0}), Histogram::exponential(1, 2, 3));
+  EXPECT_EQ(vector<double>({1.0, 3.0, 5.0}), Histogram::linear(1, 2, 3));
+
+  Histogram histogram("test/histogram", {1.0, 2.0});
+
+  AWAIT_READY(metrics::add(histogram));
+
+  histogram.record(0.5);
+  histogram.record(1.0); // The bounds are inclusive.
+  histogram.record(1.5);
+  histogram.record(3.0);
+
+  AWAIT_EXPECT_EQ(4.0, histogram.value());
+
+  Option<Distribution> distribution = histogram.distribution();
+  ASSERT_SOME(distribution);
+
+  EXPECT_EQ(vector<double>({1.0, 2.0}), distribution->bounds);
+  EXPECT_EQ(vector<uint64_t>({2, 1, 1}), distribution->counts);
+  EXPECT_EQ(4u, distribution->count);
+  EXPECT_DOUBLE_EQ(6.0, distribution->sum);
+
+  AWAIT_READY(metrics::remove(histogram));
+}
+
+
+// Tests that the `/metrics/prometheus` endpoint renders each type of
+// metric as per the Prometheus text format.
+TEST_F(MetricsTest, Prometheus)
+{
+  // Advance the clock to avoid rate limit problems.
+  Clock::pause();
+  Clock::advance(Seconds(1));
+
+  UPID upid("metrics", process::address());
+
+  Counter counter("test/counter");
+  AWAIT_READY(metrics::add(counter));
+  counter += 2;
+
+  PushGauge pushGauge("test/push_gauge");
+  AWAIT_READY(metrics::add(pushGauge));
+  pushGauge = 42.5;
+
+  PullGaugeProcess process;
+  PID<PullGaugeProcess> pid = spawn(&process);
+  ASSERT_TRUE(pid);
+
+  // The '.' is not allowed in Prometheus metric names.
+  PullGauge pullGauge("test/pull.gauge", defer(pid, &PullGaugeProcess::get));
+  AWAIT_READY(metrics::add(pullGauge));
+
+  Histogram histogram("test/histogram", {0.1, 2.0});
+  AWAIT_READY(metrics::add(histogram));
+  histogram.record(0.1);
+  histogram.record(1.0);
+  histogram.record(3.0);
+
+  metrics::Timer<Milliseconds> timer("test/timer");
+  AWAIT_READY(metrics::add(timer));
+  timer.start();
+  Clock::advance(Milliseconds(1));
+  timer.stop();
+
+  Future<Response> response = http::get(upid, "prometheus");
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(OK().status, response);
+  AWAIT_EXPECT_RESPONSE_HEADER_EQ(
+      "text/plain; version=0.0.4; charset=utf-8",
+      "Content-Type",
+      response);
+
+  const string& body = response->body;
+
+  EXPECT_TRUE(strings::contains(
+      body,
+      "# TYPE test_counter counter\n"
+      "test_counter 2\n")) << body;
+
+  EXPECT_TRUE(strings::contains(
+      body,
+      "# TYPE test_push_gauge gauge\n"
+      "test_push_gauge 42.5\n")) << body;
+
+  EXPECT_TRUE(strings::contains(
+      body,
+      "# TYPE test_pull_gauge gauge\n"
+      "test_pull_gauge 42\n")) << body;
+
+  EXPECT_TRUE(strings::contains(
+      body,
+      "# TYPE test_histogram histogram\n"
+      "test_histogram_bucket{le=\"0.1\"} 1\n"
+      "test_histogram_bucket{le=\"2\"} 2\n"
+      "test_histogram_bucket{le=\"+Inf\"} 3\n"
+      "test_histogram_sum 4.1\n"
+      "test_histogram_count 3\n")) << body;
+
+  // Timers are exposed as histograms of their durations.
+  EXPECT_TRUE(strings::contains(
+      body,
+      "# TYPE test_timer_ms histogram\n")) << body;
+  EXPECT_TRUE(strings::contains(
+      body,
+      "test_timer_ms_bucket{le=\"+Inf\"} 1\n"
+      "test_timer_ms_sum 1\n"
+      "test_timer_ms_count 1\n")) << body;
+
+  AWAIT_READY(metrics::remove(counter));
+  AWAIT_READY(metrics::remove(pushGauge));
+  AWAIT_READY(metrics::remove(pullGauge));
+  AWAIT_READY(metrics::remove(histogram));
+  AWAIT_READY(metrics::remove(timer));
+
+  terminate(process);
+  wait(process);
+
+  Clock::resume();
+}
+
+
 // Tests that the `/metrics/snapshot` endpoint rejects unauthenticated requests
 // when HTTP authentication is enabled.
 TEST_F(MetricsTest, THREADSAFE_SnapshotAuthenticationEnabled)
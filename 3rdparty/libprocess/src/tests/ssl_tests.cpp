@@ -1292,3 +1292,180 @@ TEST_F(SSLTest, CustomSSLContextVerifyFails)
 
   AWAIT_ASSERT_FAILED(connected);
 }
+
+
+// Ensures that reconnecting to a server resumes the session of the
+// previous connection rather than doing a full handshake.
+TEST_F(SSLTest, SessionResumption)
+{
+  vector<string> versions = {"LIBPROCESS_SSL_ENABLE_TLS_V1_2"};
+#ifdef SSL_OP_NO_TLSv1_3
+  versions.push_back("LIBPROCESS_SSL_ENABLE_TLS_V1_3");
+#endif
+
+  foreach (const string& version, versions) {
+    map<string, string> environment = {
+      {"LIBPROCESS_SSL_ENABLED", "true"},
+      {"LIBPROCESS_SSL_KEY_FILE", key_path().string()},
+      {"LIBPROCESS_SSL_CERT_FILE", certificate_path().string()},
+      {"LIBPROCESS_SSL_ENABLE_TLS_V1_2", "false"}};
+
+    environment[version] = "true";
+
+    set_environment_variables(environment);
+
+    Try<Socket> server = Socket::create(SocketImpl::Kind::SSL);
+    ASSERT_SOME(server);
+
+    ASSERT_SOME(server->bind(Address(net::IP(process::address().ip), 0)));
+    ASSERT_SOME(server->listen(BACKLOG));
+
+    Try<Address> address = server->address();
+    ASSERT_SOME(address);
+
+    long hits = 0;
+
+    for (int i = 0; i < 3; i++) {
+      Try<Socket> client = Socket::create(SocketImpl::Kind::SSL);
+      ASSERT_SOME(client);
+
+      Future<Socket> accept = server->accept();
+
+      AWAIT_ASSERT_READY(client->connect(
+          address.get(),
+          openssl::create_tls_client_config(None())));
+
+      AWAIT_ASSERT_READY(accept);
+
+      Socket socket = accept.get();
+
+      // With TLS 1.3, the client only gets the session from the server
+      // once it reads past the handshake.
+      AWAIT_ASSERT_READY(socket.send(data));
+      AWAIT_ASSERT_EQ(data, client->recv(data.size()));
+
+      // All but the first connection resumed a session.
+      //
+      // NOTE: We do not expect an exact number of hits, since OpenSSL
+      // counts a TLS 1.3 resumption more than once.
+      const long previous = hits;
+      hits = SSL_CTX_sess_hits(openssl::context());
+
+      if (i == 0) {
+        EXPECT_EQ(0, hits) << version;
+      } else {
+        EXPECT_LT(previous, hits) << version;
+      }
+    }
+  }
+
+  set_environment_variables({});
+}
+
+
+// Ensures that a session is not resumed once session caching is
+// disabled.
+TEST_F(SSLTest, NoSessionResumption)
+{
+  set_environment_variables({
+      {"LIBPROCESS_SSL_ENABLED", "true"},
+      {"LIBPROCESS_SSL_KEY_FILE", key_path().string()},
+      {"LIBPROCESS_SSL_CERT_FILE", certificate_path().string()},
+      {"LIBPROCESS_SSL_SESSION_CACHE_SIZE", "0"}});
+
+  Try<Socket> server = Socket::create(SocketImpl::Kind::SSL);
+  ASSERT_SOME(server);
+
+  ASSERT_SOME(server->bind(Address(net::IP(process::address().ip), 0)));
+  ASSERT_SOME(server->listen(BACKLOG));
+
+  Try<Address> address = server->address();
+  ASSERT_SOME(address);
+
+  for (int i = 0; i < 2; i++) {
+    Try<Socket> client = Socket::create(SocketImpl::Kind::SSL);
+    ASSERT_SOME(client);
+
+    Future<Socket> accept = server->accept();
+
+    AWAIT_ASSERT_READY(client->connect(
+        address.get(),
+        openssl::create_tls_client_config(None())));
+
+    AWAIT_ASSERT_READY(accept);
+
+    Socket socket = accept.get();
+
+    AWAIT_ASSERT_READY(socket.send(data));
+    AWAIT_ASSERT_EQ(data, client->recv(data.size()));
+  }
+
+  EXPECT_EQ(0, SSL_CTX_sess_hits(openssl::context()));
+
+  set_environment_variables({});
+}
+
+
+// Ensures that sockets work with kTLS enabled, whether or not the
+// kernel takes over the encryption.
+TEST_F(SSLTest, KernelTLS)
+{
+  set_environment_variables({
+      {"LIBPROCESS_SSL_ENABLED", "true"},
+      {"LIBPROCESS_SSL_KEY_FILE", key_path().string()},
+      {"LIBPROCESS_SSL_CERT_FILE", certificate_path().string()},
+      {"LIBPROCESS_SSL_CIPHERS", "AES128-GCM-SHA256"},
+      {"LIBPROCESS_SSL_ENABLE_KTLS", "true"}});
+
+  Try<Socket> server = Socket::create(SocketImpl::Kind::SSL);
+  ASSERT_SOME(server);
+
+  ASSERT_SOME(server->bind(Address(net::IP(process::address().ip), 0)));
+  ASSERT_SOME(server->listen(BACKLOG));
+
+  Try<Address> address = server->address();
+  ASSERT_SOME(address);
+
+  Try<Socket> client = Socket::create(SocketImpl::Kind::SSL);
+  ASSERT_SOME(client);
+
+  Future<Socket> accept = server->accept();
+
+  AWAIT_ASSERT_READY(client->connect(
+      address.get(),
+      openssl::create_tls_client_config(None())));
+
+  AWAIT_ASSERT_READY(accept);
+
+  Socket socket = accept.get();
+
+  AWAIT_ASSERT_READY(client->send(data));
+  AWAIT_ASSERT_EQ(data, socket.recv(data.size()));
+
+  // Send a file which spans a number of TLS records.
+  const string contents(Megabytes(1).bytes() + 1, 'x');
+  const string path = path::join(sandbox.get(), "file");
+  ASSERT_SOME(os::write(path, contents));
+
+  Try<int_fd> fd = os::open(path, O_RDONLY | O_CLOEXEC);
+  ASSERT_SOME(fd);
+
+  AWAIT_ASSERT_EQ(
+      contents.size(),
+      socket.sendfile(fd.get(), 0, contents.size()));
+
+  string received;
+  while (received.size() < contents.size()) {
+    Future<string> chunk = client->recv();
+    AWAIT_ASSERT_READY(chunk);
+    ASSERT_FALSE(chunk->empty());
+
+    received += chunk.get();
+  }
+
+  EXPECT_EQ(contents, received);
+
+  ASSERT_SOME(os::close(fd.get()));
+
+  set_environment_variables({});
+}
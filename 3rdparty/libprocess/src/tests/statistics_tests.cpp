@@ -13,6 +13,7 @@
 #include <gtest/gtest.h>
 
 #include <list>
+#include <vector>
 
 #include <process/clock.hpp>
 #include <process/statistics.hpp>
@@ -26,6 +27,7 @@ using process::Time;
 using process::TimeSeries;
 
 using std::list;
+using std::vector;
 
 TEST(StatisticsTest, Empty)
 {
@@ -98,3 +100,35 @@ TEST(StatisticsTest, StatisticsFromDurationList)
   EXPECT_EQ(Seconds(75), statistics->p75);
   EXPECT_EQ(Seconds(90), statistics->p90);
 }
+
+
+TEST(StatisticsTest, StatisticsFromUnsortedValues)
+{
+  // The values 0 to 1000 in a shuffled order, each twice.
+  vector<double> values;
+  for (int i = 0; i <= 1000; ++i) {
+    values.push_back((i * 389) % 1001);
+    values.push_back((i * 577) % 1001);
+  }
+
+  Option<Statistics<double>> statistics = Statistics<double>::from(
+      values.cbegin(), values.cend());
+
+  EXPECT_SOME(statistics);
+
+  EXPECT_EQ(2002u, statistics->count);
+
+  EXPECT_DOUBLE_EQ(0.0, statistics->min);
+  EXPECT_DOUBLE_EQ(1000.0, statistics->max);
+
+  // The sorted values are 0, 0, 1, 1, ..., so the value at position
+  // p * 2001 is half of that position, rounded down.
+  EXPECT_DOUBLE_EQ(250.0, statistics->p25);
+  EXPECT_DOUBLE_EQ(500.0, statistics->p50);
+  EXPECT_DOUBLE_EQ(750.0, statistics->p75);
+  EXPECT_DOUBLE_EQ(900.0, statistics->p90);
+  EXPECT_DOUBLE_EQ(950.0, statistics->p95);
+  EXPECT_DOUBLE_EQ(990.0, statistics->p99);
+  EXPECT_DOUBLE_EQ(999.0, statistics->p999);
+  EXPECT_DOUBLE_EQ(1000.0, statistics->p9999);
+}
@@ -215,3 +215,52 @@ TEST(TimeSeriesTest, Truncate)
   // Done!
   Clock::resume();
 }
+
+
+TEST(TimeSeriesTest, OutOfOrder)
+{
+  Clock::pause();
+  Time now = Clock::now();
+
+  TimeSeries<int> series(Duration::max(), 10);
+
+  series.set(0, now);
+  series.set(2, now + Seconds(2));
+  series.set(4, now + Seconds(4));
+
+  // Insert values before the latest one, and overwrite one.
+  series.set(3, now + Seconds(3));
+  series.set(1, now + Seconds(1));
+  series.set(-1, now - Seconds(1));
+  series.set(5, now + Seconds(2));
+
+  ASSERT_EQ(list<int>({-1, 0, 1, 5, 3, 4}), toList(series));
+
+  Option<TimeSeries<int>::Value> latest = series.latest();
+  ASSERT_SOME(latest);
+  EXPECT_EQ(4, latest->data);
+
+  // Only return the values within the range.
+  list<int> values;
+  foreach (const TimeSeries<int>::Value& value,
+           series.get(now + Seconds(1), now + Seconds(3))) {
+    values.push_back(value.data);
+  }
+  EXPECT_EQ(list<int>({1, 5, 3}), values);
+
+  // Sparsification starts from the beginning once we exceed the
+  // capacity after an out-of-order insertion.
+  series.set(6, now + Seconds(6));
+  series.set(7, now + Seconds(7));
+  series.set(8, now + Seconds(8));
+  series.set(9, now + Seconds(9));
+  ASSERT_EQ(list<int>({-1, 0, 1, 5, 3, 4, 6, 7, 8, 9}), toList(series));
+
+  series.set(10, now + Seconds(10));
+  ASSERT_EQ(list<int>({-1, 1, 5, 3, 4, 6, 7, 8, 9, 10}), toList(series));
+
+  series.set(-2, now - Seconds(2));
+  ASSERT_EQ(list<int>({-2, 1, 5, 3, 4, 6, 7, 8, 9, 10}), toList(series));
+
+  Clock::resume();
+}
@@ -87,6 +87,16 @@ public:
     return keys_.contains(key);
   }
 
+  // Returns the entry with the given key, or `end()` if there is none.
+  typename list::const_iterator find(const Key& key) const
+  {
+    typename map::const_iterator iter = keys_.find(key);
+    if (iter == keys_.end()) {
+      return entries_.cend();
+    }
+    return iter->second;
+  }
+
   size_t erase(const Key& key)
   {
     if (keys_.contains(key)) {
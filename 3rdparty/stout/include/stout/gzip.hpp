@@ -25,7 +25,6 @@
 
 
 // Compression utilities.
-// TODO(bmahler): Provide streaming compression as well.
 namespace gzip {
 
 namespace internal {
@@ -169,6 +168,123 @@ private:
 };
 
 
+// Provides the ability to incrementally compress
+// a stream of input data.
+class Compressor
+{
+public:
+  // The compression level should be within the range [-1, 9],
+  // see `compress()` below.
+  explicit Compressor(int level = Z_DEFAULT_COMPRESSION)
+    : _finished(false)
+  {
+    stream.zalloc = Z_NULL;
+    stream.zfree = Z_NULL;
+    stream.opaque = Z_NULL;
+    stream.next_in = Z_NULL;
+    stream.avail_in = 0;
+
+    int code = deflateInit2(
+        &stream,
+        level,          // Compression level.
+        Z_DEFLATED,     // Compression method.
+        MAX_WBITS + 16, // Zlib magic for gzip compression / decompression.
+        8,              // Default memLevel value.
+        Z_DEFAULT_STRATEGY);
+
+    if (code != Z_OK) {
+      Error error = internal::GzipError("Failed to deflateInit2", stream, code);
+      ABORT(error.message);
+    }
+  }
+
+  Compressor(const Compressor&) = delete;
+  Compressor& operator=(const Compressor&) = delete;
+
+  ~Compressor()
+  {
+    // NOTE: `deflateEnd` returns `Z_DATA_ERROR` if the stream
+    // was not finished, which is not an error for us.
+    if (deflateEnd(&stream) == Z_STREAM_ERROR) {
+      ABORT("Failed to deflateEnd");
+    }
+  }
+
+  // Returns the next compressed chunk of data, or an Error if
+  // compression fails. The chunk may be empty since zlib buffers
+  // the input, unless `flush` is set: all the input provided so far
+  // can then be decompressed from the returned chunks.
+  Try<std::string> compress(const std::string& decompressed, bool flush = false)
+  {
+    if (_finished) {
+      return Error("Stream already finished");
+    }
+
+    stream.next_in =
+      const_cast<Bytef*>(reinterpret_cast<const Bytef*>(decompressed.data()));
+    stream.avail_in = static_cast<uInt>(decompressed.length());
+
+    return deflate(flush ? Z_SYNC_FLUSH : Z_NO_FLUSH);
+  }
+
+  // Returns the last compressed chunk of data, which completes
+  // the stream, or an Error if compression fails.
+  Try<std::string> finish()
+  {
+    if (_finished) {
+      return Error("Stream already finished");
+    }
+
+    stream.next_in = Z_NULL;
+    stream.avail_in = 0;
+
+    Try<std::string> result = deflate(Z_FINISH);
+    _finished = result.isSome();
+    return result;
+  }
+
+  // Returns whether the compression stream is finished.
+  bool finished() const
+  {
+    return _finished;
+  }
+
+private:
+  Try<std::string> deflate(int flush)
+  {
+    // Build up the compressed result.
+    Bytef buffer[GZIP_BUFFER_SIZE];
+    std::string result;
+
+    // NOTE: zlib only guarantees that all pending output was produced
+    // once `deflate` leaves some room in the output buffer.
+    int code;
+    do {
+      stream.next_out = buffer;
+      stream.avail_out = GZIP_BUFFER_SIZE;
+
+      code = ::deflate(&stream, flush);
+
+      // `Z_BUF_ERROR` only means that no progress was possible,
+      // e.g., when flushing twice in a row.
+      if (code != Z_OK && code != Z_STREAM_END && code != Z_BUF_ERROR) {
+        return internal::GzipError("Failed to deflate", stream, code);
+      }
+
+      // Consume output and reset the buffer.
+      result.append(
+          reinterpret_cast<char*>(buffer),
+          GZIP_BUFFER_SIZE - stream.avail_out);
+    } while (stream.avail_out == 0 && code != Z_STREAM_END);
+
+    return result;
+  }
+
+  z_stream_s stream;
+  bool _finished;
+};
+
+
 // Returns a gzip compressed version of the provided string.
 // The compression level should be within the range [-1, 9].
 // See zlib.h:
@@ -16,6 +16,7 @@
 #include <algorithm>
 #include <functional>
 #include <memory>
+#include <new>
 #include <type_traits>
 #include <utility>
 #include <vector>
@@ -405,11 +406,11 @@ struct Invoke<void>
 // This is similar to `std::function`, but it can only be called once.
 // The "called once" semantics is enforced by having rvalue-ref qualifier
 // on `operator()`, so instances of `CallableOnce` must be `std::move`'d
-// in order to be invoked. Similar to `std::function`, this has heap
-// allocation overhead due to type erasure.
+// in order to be invoked.
 //
-// Note: Heap allocation can be avoided in some cases by implementing
-// small buffer optimization. This is currently not implemented.
+// Similar to `std::function`, small callables (e.g., a lambda capturing
+// a few pointers) are stored inline, and only larger ones (or ones which
+// might throw when moved) are allocated on the heap.
 template <typename F>
 class CallableOnce;
 
@@ -429,12 +430,27 @@ public:
                  R>::value),
           int>::type = 0>
   CallableOnce(F&& f)
-    : f(new CallableFn<typename std::decay<F>::type>(std::forward<F>(f))) {}
+    : f(create<typename std::decay<F>::type>(std::forward<F>(f))) {}
+
+  CallableOnce(CallableOnce&& that) noexcept
+    : f(that.release(&storage)) {}
 
-  CallableOnce(CallableOnce&&) = default;
   CallableOnce(const CallableOnce&) = delete;
 
-  CallableOnce& operator=(CallableOnce&&) = default;
+  ~CallableOnce()
+  {
+    destroy();
+  }
+
+  CallableOnce& operator=(CallableOnce&& that) noexcept
+  {
+    if (this != &that) {
+      destroy();
+      f = that.release(&storage);
+    }
+    return *this;
+  }
+
   CallableOnce& operator=(const CallableOnce&) = delete;
 
   R operator()(Args... args) &&
@@ -448,6 +464,10 @@ private:
   {
     virtual ~Callable() = default;
     virtual R operator()(Args&&...) && = 0;
+
+    // Move constructs this callable into `storage`, which is only done
+    // for callables that are stored inline.
+    virtual Callable* move(void* storage) && noexcept = 0;
   };
 
   template <typename F>
@@ -462,9 +482,78 @@ private:
     {
       return internal::Invoke<R>{}(std::move(f), std::forward<Args>(args)...);
     }
+
+    Callable* move(void* storage) && noexcept override
+    {
+      return ::new (storage) CallableFn(std::move(f));
+    }
   };
 
-  std::unique_ptr<Callable> f;
+  // Enough for a lambda capturing a handful of pointers, or a member
+  // function pointer and a couple of arguments, as for a dispatch.
+  // Callables which need a stricter alignment than a pointer are rare
+  // enough to be allocated on the heap rather than padding every
+  // `CallableOnce` (e.g., the callbacks held by each future).
+  typedef typename std::aligned_storage<
+      6 * sizeof(void*), alignof(void*)>::type Storage;
+
+  template <typename F>
+  struct Inline
+    : std::integral_constant<
+          bool,
+          sizeof(CallableFn<F>) <= sizeof(Storage) &&
+            alignof(CallableFn<F>) <= alignof(Storage) &&
+            std::is_nothrow_move_constructible<F>::value> {};
+
+  template <typename F, typename G>
+  typename std::enable_if<Inline<F>::value, Callable*>::type create(G&& g)
+  {
+    return ::new (&storage) CallableFn<F>(std::forward<G>(g));
+  }
+
+  template <typename F, typename G>
+  typename std::enable_if<!Inline<F>::value, Callable*>::type create(G&& g)
+  {
+    return new CallableFn<F>(std::forward<G>(g));
+  }
+
+  bool inlined() const
+  {
+    const char* begin = reinterpret_cast<const char*>(&storage);
+    const char* callable = reinterpret_cast<const char*>(f);
+
+    return std::less_equal<const char*>()(begin, callable) &&
+      std::less<const char*>()(callable, begin + sizeof(Storage));
+  }
+
+  // Hands the callable over to another `CallableOnce` whose storage is
+  // `storage`, leaving this one empty.
+  Callable* release(void* storage) noexcept
+  {
+    Callable* callable = f;
+
+    if (callable != nullptr && inlined()) {
+      callable = std::move(*f).move(storage);
+      f->~Callable();
+    }
+
+    f = nullptr;
+    return callable;
+  }
+
+  void destroy()
+  {
+    if (f != nullptr && inlined()) {
+      f->~Callable();
+    } else {
+      delete f;
+    }
+
+    f = nullptr;
+  }
+
+  Storage storage;
+  Callable* f;
 };
 
 } // namespace lambda {
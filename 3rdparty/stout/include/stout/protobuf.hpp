@@ -22,8 +22,12 @@
 
 #include <sys/types.h>
 
+#include <functional>
+#include <limits>
 #include <string>
+#include <tuple>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 #include <google/protobuf/descriptor.h>
@@ -34,11 +38,17 @@
 
 #include <google/protobuf/io/zero_copy_stream_impl.h>
 
+// NOTE: <stout/jsonify.hpp> configures rapidjson (e.g., it defines
+// `RAPIDJSON_HAS_STDSTRING`), hence it must be included before any of
+// the rapidjson headers.
+#include <stout/jsonify.hpp>
+
+#include <rapidjson/reader.h>
+
 #include <stout/abort.hpp>
 #include <stout/base64.hpp>
 #include <stout/error.hpp>
 #include <stout/json.hpp>
-#include <stout/jsonify.hpp>
 #include <stout/none.hpp>
 #include <stout/nothing.hpp>
 #include <stout/representation.hpp>
@@ -796,6 +806,449 @@ struct Parse<google::protobuf::RepeatedPtrField<T>>
   }
 };
 
+
+// A rapidjson handler which sets the fields of protobuf messages while
+// the JSON gets parsed, rather than building a `JSON::Value` first. The
+// values are converted by a `Parser`, so the result is the same as the
+// one of `Parse<T>`, except that all the values of a duplicate key are
+// applied (in order) rather than only the last one.
+//
+// Once the JSON does not match the message, the error is kept and the
+// rest of the JSON only gets validated, so that malformed JSON is still
+// reported as such.
+class Handler
+  : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, Handler>
+{
+public:
+  // Parses a single message into `message`.
+  explicit Handler(google::protobuf::Message* message)
+    : root(message) {}
+
+  // Parses an array of messages, each of which is added by `add`.
+  explicit Handler(std::function<google::protobuf::Message*()> _add)
+    : root(nullptr), add(std::move(_add)) {}
+
+  const Option<Error>& error() const { return error_; }
+
+  bool Null() { return value(JSON::Null()); }
+  bool Bool(bool b) { return value(JSON::Boolean(b)); }
+  bool Int(int i) { return value(JSON::Number(static_cast<int64_t>(i))); }
+  bool Int64(int64_t i) { return value(JSON::Number(i)); }
+  bool Double(double d) { return value(JSON::Number(d)); }
+
+  bool Uint(unsigned i)
+  {
+    return value(JSON::Number(static_cast<int64_t>(i)));
+  }
+
+  // Like `JSON::parse`, we only keep the integers which fit into an
+  // `int64_t`, see the note on `JSON::Number`.
+  bool Uint64(uint64_t i)
+  {
+    if (i > static_cast<uint64_t>(std::numeric_limits<int64_t>::max())) {
+      return value(JSON::Number(static_cast<double>(i)));
+    }
+
+    return value(JSON::Number(static_cast<int64_t>(i)));
+  }
+
+  bool String(const char* string, rapidjson::SizeType length, bool)
+  {
+    return value(JSON::String(std::string(string, length)));
+  }
+
+  bool Key(const char* key, rapidjson::SizeType length, bool)
+  {
+    if (skip > 0 || error_.isSome()) {
+      return true;
+    }
+
+    Frame& frame = frames.back();
+
+    if (frame.type == Frame::OBJECT) {
+      frame.field = frame.message->GetDescriptor()->FindFieldByName(
+          std::string(key, length));
+    } else {
+      CHECK_EQ(Frame::MAP, frame.type);
+
+      // See the comment on maps in `Parser`.
+      frame.entry =
+        frame.message->GetReflection()->AddMessage(frame.message, frame.field);
+
+      Try<Nothing> apply = Parser(
+          frame.entry,
+          frame.entry->GetDescriptor()->FindFieldByNumber(1))(
+              JSON::String(std::string(key, length)));
+
+      if (apply.isError()) {
+        error_ = Error(apply.error());
+      }
+    }
+
+    return true;
+  }
+
+  bool StartObject()
+  {
+    if (!enter()) {
+      return false;
+    }
+
+    if (skip > 0 || error_.isSome()) {
+      ++skip;
+      return true;
+    }
+
+    if (frames.empty()) {
+      if (root == nullptr) {
+        error_ = Error("Expecting a JSON array");
+        return true;
+      }
+
+      frames.push_back(Frame(Frame::OBJECT, root, nullptr, true));
+      return true;
+    }
+
+    if (frames.back().type == Frame::ROOT) {
+      frames.push_back(Frame(Frame::OBJECT, add(), nullptr, true));
+      return true;
+    }
+
+    google::protobuf::Message* message;
+    const google::protobuf::FieldDescriptor* field;
+    std::tie(message, field) = target();
+
+    if (field == nullptr) {
+      ++skip;
+      return true;
+    }
+
+    if (field->type() != google::protobuf::FieldDescriptor::TYPE_MESSAGE) {
+      error_ = Error(
+          "Not expecting a JSON object for field '" + field->name() + "'");
+      return true;
+    }
+
+    const google::protobuf::Reflection* reflection = message->GetReflection();
+
+    if (field->is_map()) {
+      frames.push_back(Frame(Frame::MAP, message, field));
+    } else if (field->is_repeated()) {
+      frames.push_back(
+          Frame(Frame::OBJECT, reflection->AddMessage(message, field)));
+    } else {
+      frames.push_back(
+          Frame(Frame::OBJECT, reflection->MutableMessage(message, field)));
+    }
+
+    return true;
+  }
+
+  bool EndObject(rapidjson::SizeType)
+  {
+    return leave();
+  }
+
+  bool StartArray()
+  {
+    if (!enter()) {
+      return false;
+    }
+
+    if (skip > 0 || error_.isSome()) {
+      ++skip;
+      return true;
+    }
+
+    if (frames.empty()) {
+      if (root != nullptr) {
+        error_ = Error("Expecting a JSON object");
+        return true;
+      }
+
+      frames.push_back(Frame(Frame::ROOT));
+      return true;
+    }
+
+    if (frames.back().type == Frame::ROOT) {
+      error_ = Error("Expecting a JSON object");
+      return true;
+    }
+
+    google::protobuf::Message* message;
+    const google::protobuf::FieldDescriptor* field;
+    std::tie(message, field) = target();
+
+    if (field == nullptr) {
+      ++skip;
+      return true;
+    }
+
+    if (!field->is_repeated()) {
+      error_ = Error(
+          "Not expecting a JSON array for field '" + field->name() + "'");
+      return true;
+    }
+
+    frames.push_back(Frame(Frame::ARRAY, message, field));
+    return true;
+  }
+
+  bool EndArray(rapidjson::SizeType)
+  {
+    return leave();
+  }
+
+private:
+  struct Frame
+  {
+    enum Type
+    {
+      OBJECT, // A message.
+      MAP,    // The entries of a map field of a message.
+      ARRAY,  // The values of a repeated field of a message.
+      ROOT,   // The messages parsed by a `Handler` with an `add`.
+    };
+
+    explicit Frame(
+        Type _type,
+        google::protobuf::Message* _message = nullptr,
+        const google::protobuf::FieldDescriptor* _field = nullptr,
+        bool _top = false)
+      : type(_type),
+        message(_message),
+        field(_field),
+        entry(nullptr),
+        top(_top) {}
+
+    Type type;
+
+    // The message, and either the field of the map or of the array,
+    // or for an object, the field of the last key (if there is one).
+    google::protobuf::Message* message;
+    const google::protobuf::FieldDescriptor* field;
+
+    // The entry of the last key of a map.
+    google::protobuf::Message* entry;
+
+    // Whether this is one of the messages being parsed, whose
+    // required fields need to be checked.
+    bool top;
+  };
+
+  // Returns the message and the field which a value applies to. The
+  // field is null for the value of an unknown key.
+  std::pair<
+      google::protobuf::Message*,
+      const google::protobuf::FieldDescriptor*> target() const
+  {
+    const Frame& frame = frames.back();
+
+    if (frame.type == Frame::MAP) {
+      return std::make_pair(
+          frame.entry,
+          frame.entry->GetDescriptor()->FindFieldByNumber(2));
+    }
+
+    return std::make_pair(frame.message, frame.field);
+  }
+
+  template <typename V>
+  bool value(const V& value)
+  {
+    if (skip > 0 || error_.isSome()) {
+      return true;
+    }
+
+    if (frames.empty() && root == nullptr) {
+      error_ = Error("Expecting a JSON array");
+      return true;
+    }
+
+    if (frames.empty() || frames.back().type == Frame::ROOT) {
+      error_ = Error("Expecting a JSON object");
+      return true;
+    }
+
+    google::protobuf::Message* message;
+    const google::protobuf::FieldDescriptor* field;
+    std::tie(message, field) = target();
+
+    if (field != nullptr) {
+      Try<Nothing> apply = Parser(message, field)(value);
+      if (apply.isError()) {
+        error_ = Error(apply.error());
+      }
+    }
+
+    return true;
+  }
+
+  // Limits the nesting like `JSON::parse` does, returning false to
+  // stop the parsing once the JSON is nested too deeply.
+  bool enter()
+  {
+    return ++depth <= ::JSON::internal::STOUT_JSON_MAX_DEPTH;
+  }
+
+  bool leave()
+  {
+    --depth;
+
+    if (skip > 0) {
+      --skip;
+      return true;
+    }
+
+    if (error_.isSome()) {
+      return true;
+    }
+
+    const Frame frame = frames.back();
+    frames.pop_back();
+
+    if (frame.top && !frame.message->IsInitialized()) {
+      error_ = Error("Missing required fields: " +
+                     frame.message->InitializationErrorString());
+    }
+
+    return true;
+  }
+
+  google::protobuf::Message* root;
+  std::function<google::protobuf::Message*()> add;
+
+  std::vector<Frame> frames;
+
+  // The nesting of the value being parsed, and the nesting within the
+  // value of an unknown key or of the value which did not match.
+  size_t depth = 0;
+  size_t skip = 0;
+
+  Option<Error> error_;
+};
+
+
+// Returns false if `json` is not valid JSON, in which case the handler
+// may have only seen part of it.
+inline bool read(const std::string& json, Handler* handler)
+{
+  // NOTE: The reader stops at the first NUL character, which only
+  // ends valid JSON if it is the terminator of the string.
+  rapidjson::StringStream stream(json.c_str());
+  rapidjson::Reader reader;
+
+  // We use the iterative parser so that deeply nested JSON can not
+  // overflow the stack, and a full precision parse of floating point
+  // numbers, as `JSON::parse` does.
+  rapidjson::ParseResult result = reader.Parse<
+      rapidjson::kParseIterativeFlag |
+      rapidjson::kParseFullPrecisionFlag>(stream, *handler);
+
+  return !result.IsError() && stream.Tell() == json.size();
+}
+
+
+// Parses a protobuf message from a JSON string into the (empty)
+// `message`, see `parseJSON` below.
+inline Try<Try<Nothing>> parseJSON(
+    const std::string& json,
+    google::protobuf::Message* message)
+{
+  Handler handler(message);
+
+  // For JSON which rapidjson does not accept, we return the result
+  // of `JSON::parse`, so that the errors are the ones it reports.
+  if (!read(json, &handler)) {
+    Try<JSON::Value> value = JSON::parse(json);
+    if (value.isError()) {
+      return Error(value.error());
+    }
+
+    const JSON::Object* object = boost::get<JSON::Object>(&value.get());
+    if (object == nullptr) {
+      return Try<Nothing>(Error("Expecting a JSON object"));
+    }
+
+    // The handler may have parsed part of the message already.
+    message->Clear();
+
+    Try<Nothing> parse = internal::parse(message, *object);
+    if (parse.isError()) {
+      return Try<Nothing>(Error(parse.error()));
+    }
+
+    if (!message->IsInitialized()) {
+      return Try<Nothing>(Error("Missing required fields: " +
+                                message->InitializationErrorString()));
+    }
+
+    return Try<Nothing>(Nothing());
+  }
+
+  if (handler.error().isSome()) {
+    return Try<Nothing>(handler.error().get());
+  }
+
+  return Try<Nothing>(Nothing());
+}
+
+
+// Parses protobuf message(s) from a JSON string, see `parseJSON` below.
+template <typename T>
+struct ParseJSON
+{
+  Try<Try<T>> operator()(const std::string& json)
+  {
+    static_assert(std::is_convertible<T*, google::protobuf::Message*>::value,
+                  "T must be a protobuf message");
+
+    T message;
+
+    Try<Try<Nothing>> parse = parseJSON(json, &message);
+    if (parse.isError()) {
+      return Error(parse.error());
+    }
+
+    if (parse->isError()) {
+      return Try<T>(Error(parse->error()));
+    }
+
+    return Try<T>(std::move(message));
+  }
+};
+
+
+template <typename T>
+struct ParseJSON<google::protobuf::RepeatedPtrField<T>>
+{
+  Try<Try<google::protobuf::RepeatedPtrField<T>>> operator()(
+      const std::string& json)
+  {
+    static_assert(std::is_convertible<T*, google::protobuf::Message*>::value,
+                  "T must be a protobuf message");
+
+    google::protobuf::RepeatedPtrField<T> collection;
+    Handler handler([&collection]() { return collection.Add(); });
+
+    if (!read(json, &handler)) {
+      Try<JSON::Value> value = JSON::parse(json);
+      if (value.isError()) {
+        return Error(value.error());
+      }
+
+      return Parse<google::protobuf::RepeatedPtrField<T>>()(value.get());
+    }
+
+    if (handler.error().isSome()) {
+      return Try<google::protobuf::RepeatedPtrField<T>>(
+          handler.error().get());
+    }
+
+    return Try<google::protobuf::RepeatedPtrField<T>>(std::move(collection));
+  }
+};
+
 } // namespace internal {
 
 // A dispatch wrapper which parses protobuf messages(s) from a given JSON value.
@@ -812,6 +1265,29 @@ Try<T> parse(const JSON::Value& value)
   return internal::Parse<T>()(value);
 }
 
+
+// Parses protobuf message(s) like `parse` does, but directly from a
+// JSON string, without building the intermediate `JSON::Value`. The
+// outer `Try` holds an error if `json` is not valid JSON (the same
+// error as `JSON::parse`), the inner one if it does not match T.
+template <typename T>
+Try<Try<T>> parseJSON(const std::string& json)
+{
+  return internal::ParseJSON<T>()(json);
+}
+
+
+// Like `parseJSON` above, but parses a single message into the given
+// `message` (which is cleared first), e.g., one allocated on an arena,
+// rather than returning a new message which would have to be copied.
+inline Try<Try<Nothing>> parseJSON(
+    const std::string& json,
+    google::protobuf::Message* message)
+{
+  message->Clear();
+  return internal::parseJSON(json, message);
+}
+
 } // namespace protobuf {
 
 namespace JSON {
@@ -83,6 +83,33 @@ TEST(BoundedHashmapTest, Contains)
 }
 
 
+TEST(BoundedHashmapTest, Find)
+{
+  BoundedHashMap<string, int> map(2);
+
+  map.set("foo", 1);
+  map.set("bar", 2);
+
+  const BoundedHashMap<string, int>& constMap = map;
+
+  auto iter = constMap.find("foo");
+  ASSERT_TRUE(iter != constMap.end());
+  EXPECT_EQ("foo", iter->first);
+  EXPECT_EQ(1, iter->second);
+
+  // Iteration continues in insertion order after the entry found.
+  ++iter;
+  ASSERT_TRUE(iter != constMap.end());
+  EXPECT_EQ("bar", iter->first);
+
+  EXPECT_TRUE(constMap.find("caz") == constMap.end());
+
+  // This should evict key "foo".
+  map.set("baz", 3);
+  EXPECT_TRUE(constMap.find("foo") == constMap.end());
+}
+
+
 TEST(BoundedHashmapTest, Erase)
 {
   BoundedHashMap<string, int> map(2);
@@ -11,15 +11,19 @@
 // limitations under the License
 
 #include <string>
+#include <vector>
 
 #include <gtest/gtest.h>
 
 #include <gmock/gmock.h>
 
+#include <stout/foreach.hpp>
 #include <stout/gtest.hpp>
 #include <stout/gzip.hpp>
+#include <stout/strings.hpp>
 
 using std::string;
+using std::vector;
 
 
 #ifdef HAVE_LIBZ
@@ -99,4 +103,71 @@ TEST(GzipTest, Decompressor)
 
   ASSERT_EQ(s, decompressed);
 }
+
+
+TEST(GzipTest, Compressor)
+{
+  vector<string> chunks = {
+    "Lorem ipsum dolor sit amet, consectetur adipisicing elit, sed do ",
+    "eiusmod tempor incididunt ut labore et dolore magna aliqua. Ut enim ad ",
+    "",
+    "minim veniam, quis nostrud exercitation ullamco laboris nisi ut "};
+
+  // Add a 1MB random chunk, which compresses into more than one buffer.
+  string random;
+  while (random.length() < (1024 * 1024)) {
+    random.append(1, ' ' + (rand() % ('~' - ' ')));
+  }
+  chunks.push_back(random);
+
+  gzip::Compressor compressor;
+  gzip::Decompressor decompressor;
+
+  // Everything compressed so far must be decompressible after a flush.
+  // Flushing without any new input produces nothing.
+  foreach (const string& chunk, chunks) {
+    Try<string> compressed = compressor.compress(chunk, true);
+    ASSERT_SOME(compressed);
+    EXPECT_EQ(chunk.empty(), compressed->empty());
+
+    Try<string> decompressedChunk = decompressor.decompress(compressed.get());
+    ASSERT_SOME(decompressedChunk);
+    EXPECT_EQ(chunk, decompressedChunk.get());
+  }
+
+  // Without a flush, zlib may hold on to the input.
+  string s = "Excepteur sint occaecat cupidatat non proident.";
+
+  Try<string> compressed = compressor.compress(s);
+  ASSERT_SOME(compressed);
+
+  Try<string> last = compressor.finish();
+  ASSERT_SOME(last);
+  EXPECT_TRUE(compressor.finished());
+
+  Try<string> decompressedChunk =
+    decompressor.decompress(compressed.get() + last.get());
+  ASSERT_SOME(decompressedChunk);
+  EXPECT_EQ(s, decompressedChunk.get());
+  EXPECT_TRUE(decompressor.finished());
+
+  EXPECT_ERROR(compressor.compress(s));
+  EXPECT_ERROR(compressor.finish());
+
+  // The stream is also a valid gzip "file".
+  gzip::Compressor compressor2(Z_BEST_SPEED);
+
+  string stream;
+  foreach (const string& chunk, chunks) {
+    compressed = compressor2.compress(chunk);
+    ASSERT_SOME(compressed);
+    stream += compressed.get();
+  }
+
+  last = compressor2.finish();
+  ASSERT_SOME(last);
+  stream += last.get();
+
+  EXPECT_SOME_EQ(strings::join("", chunks), gzip::decompress(stream));
+}
 #endif // HAVE_LIBZ
@@ -11,6 +11,7 @@
 // limitations under the License
 
 #include <list>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -250,3 +251,105 @@ TEST(PartialTest, Test)
   mp2();
   std::move(mp2)();
 }
+
+
+
+namespace {
+
+// Counts how many times the instances it was moved from got destroyed,
+// so that we can check that a `CallableOnce` destroys the callable it
+// holds exactly once.
+struct Counted
+{
+  explicit Counted(int* _destroyed) : destroyed(_destroyed) {}
+
+  Counted(Counted&& that) noexcept : destroyed(that.destroyed)
+  {
+    that.destroyed = nullptr;
+  }
+
+  ~Counted()
+  {
+    if (destroyed != nullptr) {
+      ++(*destroyed);
+    }
+  }
+
+  int* destroyed;
+};
+
+} // namespace {
+
+
+TEST(CallableOnceTest, Move)
+{
+  // A small callable, which is stored inline.
+  int destroyed = 0;
+
+  {
+    lambda::CallableOnce<int(int)> f(lambda::partial(
+        [](const Counted&, int i) { return i + 1; },
+        Counted(&destroyed),
+        lambda::_1));
+
+    lambda::CallableOnce<int(int)> g(std::move(f));
+    EXPECT_EQ(0, destroyed);
+
+    lambda::CallableOnce<int(int)> h([](int i) { return i; });
+    h = std::move(g);
+    EXPECT_EQ(0, destroyed);
+
+    EXPECT_EQ(2, std::move(h)(1));
+  }
+
+  EXPECT_EQ(1, destroyed);
+
+  // A callable which is too large to be stored inline.
+  destroyed = 0;
+
+  {
+    struct Large
+    {
+      char padding[256];
+    };
+
+    lambda::CallableOnce<size_t()> f(lambda::partial(
+        [](const Counted&, const Large& large) { return sizeof(large); },
+        Counted(&destroyed),
+        Large()));
+
+    lambda::CallableOnce<size_t()> g(std::move(f));
+    lambda::CallableOnce<size_t()> h([]() { return size_t(0); });
+    h = std::move(g);
+    EXPECT_EQ(0, destroyed);
+
+    EXPECT_EQ(256u, std::move(h)());
+  }
+
+  EXPECT_EQ(1, destroyed);
+}
+
+
+TEST(CallableOnceTest, OnlyMoveable)
+{
+  // `OnlyMoveable` might throw when moved, hence it is not stored
+  // inline, but it still needs to be moved into the callable.
+  lambda::CallableOnce<int(int)> f(lambda::partial(
+      [](OnlyMoveable&& m, int i) {
+        EXPECT_TRUE(m.valid);
+        return m.i + i;
+      },
+      OnlyMoveable(1),
+      lambda::_1));
+
+  lambda::CallableOnce<int(int)> g(std::move(f));
+  EXPECT_EQ(3, std::move(g)(2));
+
+  // A move-only argument which is stored inline.
+  lambda::CallableOnce<int()> h(lambda::partial(
+      [](std::unique_ptr<int>&& i) { return *i; },
+      std::unique_ptr<int>(new int(42))));
+
+  lambda::CallableOnce<int()> k(std::move(h));
+  EXPECT_EQ(42, std::move(k)());
+}
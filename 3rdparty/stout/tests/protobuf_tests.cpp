@@ -17,9 +17,13 @@
 #include <algorithm>
 #include <limits>
 #include <string>
+#include <vector>
+
+#include <google/protobuf/arena.h>
 
 #include <google/protobuf/util/message_differencer.h>
 
+#include <stout/foreach.hpp>
 #include <stout/gtest.hpp>
 #include <stout/json.hpp>
 #include <stout/jsonify.hpp>
@@ -541,6 +545,187 @@ TEST(ProtobufTest, ParseJSONUnrecognizedEnum)
 }
 
 
+// Tests that parsing protobuf messages directly from a JSON string
+// gives the same results as parsing them from a `JSON::Value`.
+TEST(ProtobufTest, ParseJSONString)
+{
+  const string message =
+    R"~(
+    {
+      "b": "true",
+      "str": "string",
+      "bytes": "Ynl0ZXM=",
+      "int32": -1,
+      "int64": "-9223372036854775807",
+      "uint64": 18446744073709551615,
+      "f": "Infinity",
+      "d": 1.5e300,
+      "e": "ONE",
+      "nested": { "str": "nested", "optional_str": null },
+      "repeated_double": [1, 2.5, "-Infinity"],
+      "repeated_enum": ["TWO", "XXX"],
+      "repeated_nested": [ { "str": "a" }, { "str": "bé" } ],
+      "unknown": { "a": [1, { "b": [] }], "c": null },
+      "repeated_string": null
+    })~";
+
+  Try<JSON::Value> json = JSON::parse(message);
+  ASSERT_SOME(json);
+
+  Try<tests::Message> expected = protobuf::parse<tests::Message>(json.get());
+  ASSERT_SOME(expected);
+
+  Try<Try<tests::Message>> parse =
+    protobuf::parseJSON<tests::Message>(message);
+
+  ASSERT_SOME(parse);
+  ASSERT_SOME(parse.get());
+
+  EXPECT_TRUE(google::protobuf::util::MessageDifferencer::Equals(
+      expected.get(), parse->get()));
+
+  const string map =
+    R"~(
+    {
+      "string_to_string": { "key1": "value1", "key2": "value2" },
+      "string_to_bytes": { "key": "Ynl0ZXM=" },
+      "string_to_nested": { "key": { "str": "nested" } },
+      "bool_to_string": { "true": "value1", "false": "value2" },
+      "uint64_to_string": { "9223372036854775807": "value" },
+      "sint64_to_string": { "-1234567890123456789": "value" }
+    })~";
+
+  json = JSON::parse(map);
+  ASSERT_SOME(json);
+
+  Try<tests::MapMessage> expectedMap =
+    protobuf::parse<tests::MapMessage>(json.get());
+
+  ASSERT_SOME(expectedMap);
+
+  Try<Try<tests::MapMessage>> parseMap =
+    protobuf::parseJSON<tests::MapMessage>(map);
+
+  ASSERT_SOME(parseMap);
+  ASSERT_SOME(parseMap.get());
+
+  EXPECT_TRUE(google::protobuf::util::MessageDifferencer::Equals(
+      expectedMap.get(), parseMap->get()));
+
+  const string array =
+    R"~([{ "id": "message1", "numbers": [1, 2] }, { "id": "message2" }])~";
+
+  Try<Try<RepeatedPtrField<tests::SimpleMessage>>> parseArray =
+    protobuf::parseJSON<RepeatedPtrField<tests::SimpleMessage>>(array);
+
+  ASSERT_SOME(parseArray);
+  ASSERT_SOME(parseArray.get());
+  ASSERT_EQ(2, parseArray->get().size());
+
+  tests::SimpleMessage message1;
+  message1.set_id("message1");
+  message1.add_numbers(1);
+  message1.add_numbers(2);
+
+  tests::SimpleMessage message2;
+  message2.set_id("message2");
+
+  EXPECT_EQ(message1, parseArray->get().Get(0));
+  EXPECT_EQ(message2, parseArray->get().Get(1));
+
+  // A message can also be parsed into a given message, e.g., one which
+  // is owned by an arena. Its previous content is cleared.
+  google::protobuf::Arena arena;
+  tests::SimpleMessage* arenaMessage =
+    google::protobuf::Arena::Create<tests::SimpleMessage>(&arena);
+
+  arenaMessage->set_id("previous");
+  arenaMessage->add_numbers(3);
+
+  Try<Try<Nothing>> parseInto = protobuf::parseJSON(
+      R"~({ "id": "message1", "numbers": [1, 2] })~", arenaMessage);
+
+  ASSERT_SOME(parseInto);
+  ASSERT_SOME(parseInto.get());
+  EXPECT_EQ(message1, *arenaMessage);
+
+  // JSON which is not an object is reported as for `JSON::Value`s.
+  parseInto = protobuf::parseJSON("[]", arenaMessage);
+
+  ASSERT_SOME(parseInto);
+  ASSERT_ERROR(parseInto.get());
+  EXPECT_EQ("Expecting a JSON object", parseInto->error());
+}
+
+
+// Tests that malformed JSON, and JSON which does not match the message,
+// lead to the same errors as for parsing a `JSON::Value`.
+TEST(ProtobufTest, ParseJSONStringError)
+{
+  // Malformed JSON is reported as `JSON::parse` does, even if the JSON
+  // does not match the message before it gets malformed.
+  const std::vector<string> malformeds = {
+    "",
+    "MALFORMED",
+    "{\"id\": \"id\"",
+    "{\"id\": 1} trailing",
+    "{\"id\": 1, \"numbers\": [1,]}",
+    string("{\"id\": \"id\"}\0{", 14),
+    string(500, '[') + string(500, ']')};
+
+  foreach (const string& malformed, malformeds) {
+    Try<JSON::Value> json = JSON::parse(malformed);
+    ASSERT_ERROR(json);
+
+    Try<Try<tests::SimpleMessage>> parse =
+      protobuf::parseJSON<tests::SimpleMessage>(malformed);
+
+    ASSERT_ERROR(parse);
+    EXPECT_EQ(json.error(), parse.error());
+  }
+
+  // JSON which does not match the message.
+  const std::vector<string> mismatches = {
+    "[]",
+    "\"id\"",
+    "{}",
+    "{\"id\": {}}",
+    "{\"id\": []}",
+    "{\"id\": \"id\", \"numbers\": [\"one\"]}",
+    "{\"id\": \"id\", \"numbers\": [[1, 2], true]}"};
+
+  foreach (const string& mismatch, mismatches) {
+    Try<JSON::Value> json = JSON::parse(mismatch);
+    ASSERT_SOME(json);
+
+    Try<tests::SimpleMessage> expected =
+      protobuf::parse<tests::SimpleMessage>(json.get());
+
+    ASSERT_ERROR(expected);
+
+    Try<Try<tests::SimpleMessage>> parse =
+      protobuf::parseJSON<tests::SimpleMessage>(mismatch);
+
+    ASSERT_SOME(parse);
+    ASSERT_ERROR(parse.get());
+    EXPECT_EQ(expected.error(), parse->error());
+  }
+
+  Try<Try<RepeatedPtrField<tests::SimpleMessage>>> parse =
+    protobuf::parseJSON<RepeatedPtrField<tests::SimpleMessage>>("[{}]");
+
+  ASSERT_SOME(parse);
+  ASSERT_ERROR(parse.get());
+  EXPECT_EQ("Missing required fields: id", parse->error());
+
+  parse = protobuf::parseJSON<RepeatedPtrField<tests::SimpleMessage>>("{}");
+
+  ASSERT_SOME(parse);
+  ASSERT_ERROR(parse.get());
+  EXPECT_EQ("Expecting a JSON array", parse->error());
+}
+
+
 TEST(ProtobufTest, Jsonify)
 {
   tests::Message message;
@@ -122,6 +122,19 @@ if (ENABLE_LIBEVENT)
     "Specify the path to libevent, e.g. \"C:\\libevent-Win64\".")
 endif()
 
+option(
+  ENABLE_IO_URING
+  "Use io_uring instead of libev as the core event loop implementation (Linux only)."
+  FALSE)
+
+if (ENABLE_IO_URING)
+  set(
+    LIBURING_ROOT_DIR
+    ""
+    CACHE STRING
+    "Specify the path to liburing.")
+endif ()
+
 set(
   BOOST_ROOT_DIR
   ""
@@ -180,6 +193,32 @@ option(
   "Build libprocess with LIFO fixed size semaphore."
   FALSE)
 
+option(
+  ENABLE_HTTP2
+  "Serve HTTP/2 connections and allow HTTP/2 client connections."
+  FALSE)
+
+if (ENABLE_HTTP2)
+  set(
+    NGHTTP2_ROOT_DIR
+    ""
+    CACHE STRING
+    "Specify the path to nghttp2, e.g. \"C:\\nghttp2-Win64\".")
+endif ()
+
+option(
+  ENABLE_ZSTD
+  "Compress HTTP responses with an installed zstd for clients accepting it."
+  FALSE)
+
+if (ENABLE_ZSTD)
+  set(
+    ZSTD_ROOT_DIR
+    ""
+    CACHE STRING
+    "Specify the path to zstd, e.g. \"C:\\zstd-Win64\".")
+endif ()
+
 option(
   ENABLE_NVML
   "Whether to use the NVML headers."
@@ -287,6 +326,14 @@ if (WIN32 AND REBUNDLED)
     "the Internet, even though the `REBUNDLED` flag was set.")
 endif ()
 
+if (ENABLE_IO_URING AND
+    (NOT CMAKE_SYSTEM_NAME STREQUAL "Linux" OR ENABLE_LIBEVENT))
+  message(
+    FATAL_ERROR
+    "The io_uring event loop is only supported on Linux, and cannot be "
+    "combined with `ENABLE_LIBEVENT`.")
+endif ()
+
 if (WIN32 AND ENABLE_LIBEVENT)
   message(
     WARNING
@@ -678,6 +725,18 @@ if (ENABLE_LIBEVENT)
   add_definitions(-DUSE_LIBEVENT=1)
 endif ()
 
+if (ENABLE_IO_URING)
+  add_definitions(-DUSE_IO_URING=1)
+endif ()
+
+if (ENABLE_ZSTD)
+  add_definitions(-DUSE_ZSTD=1)
+endif ()
+
+if (ENABLE_HTTP2)
+  add_definitions(-DUSE_HTTP2=1)
+endif ()
+
 # Calculate some build information.
 string(TIMESTAMP BUILD_DATE "%Y-%m-%d %H:%M:%S UTC" UTC)
 string(TIMESTAMP BUILD_TIME "%s" UTC)
@@ -80,6 +80,22 @@ struct ContainerIO
       }
     }
 
+    Type type() const { return type_; }
+
+    // Only valid if `type()` is `Type::FD`.
+    int_fd fd() const
+    {
+      CHECK(type_ == Type::FD);
+      return *fd_;
+    }
+
+    // Only valid if `type()` is `Type::PATH`.
+    const std::string& path() const
+    {
+      CHECK(type_ == Type::PATH);
+      return path_.get();
+    }
+
   private:
     // A simple abstraction to wrap an FD and (optionally) close it
     // on destruction. We know that we never copy instances of this
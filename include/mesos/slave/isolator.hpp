@@ -54,6 +54,16 @@ public:
     return false;
   }
 
+  // Returns true if `prepare` of this isolator neither depends on nor
+  // affects what the other isolators do in `prepare`. The containerizer
+  // prepares the isolators one after another in the order in which they
+  // are specified, except that adjacent isolators which return true here
+  // are prepared concurrently.
+  virtual bool supportsParallelPrepare()
+  {
+    return false;
+  }
+
   // Recover containers from the run states and the orphan containers
   // (known to the launcher but not known to the slave) detected by
   // the launcher.
@@ -97,6 +97,10 @@ public:
   // events without ever being sent to the master. This includes when
   // calls are sent but no master is currently detected (i.e., we're
   // disconnected).
+  //
+  // Note: The results of the items of a `BATCH` call are not returned
+  // to the scheduler (items which were dropped by the master are only
+  // logged), use `call()` to receive them.
   void send(const Call& call) override;
 
   // Attempts to send a call to the master, returning the response.
@@ -119,12 +119,12 @@ Try<Message> deserialize(
       return message;
     }
     case ContentType::JSON: {
-      Try<JSON::Value> value = JSON::parse(body);
-      if (value.isError()) {
-        return Error("Failed to parse body into JSON: " + value.error());
+      Try<Try<Message>> message = ::protobuf::parseJSON<Message>(body);
+      if (message.isError()) {
+        return Error("Failed to parse body into JSON: " + message.error());
       }
 
-      return ::protobuf::parse<Message>(value.get());
+      return message.get();
     }
     case ContentType::RECORDIO: {
       return Error("Deserializing a RecordIO stream is not supported");
@@ -663,6 +663,9 @@ struct Capabilities
         case FrameworkInfo::Capability::REGION_AWARE:
           regionAware = true;
           break;
+        case FrameworkInfo::Capability::OFFER_DELTAS:
+          offerDeltas = true;
+          break;
       }
     }
   }
@@ -676,6 +679,7 @@ struct Capabilities
   bool multiRole = false;
   bool reservationRefinement = false;
   bool regionAware = false;
+  bool offerDeltas = false;
 };
 
 
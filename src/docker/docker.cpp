@@ -22,6 +22,7 @@
 
 #include <stout/error.hpp>
 #include <stout/foreach.hpp>
+#include <stout/hashmap.hpp>
 #include <stout/json.hpp>
 #include <stout/lambda.hpp>
 #include <stout/os.hpp>
@@ -39,9 +40,12 @@
 #include <stout/os/windows/jobobject.hpp>
 #endif // __WINDOWS__
 
+#include <process/after.hpp>
 #include <process/check.hpp>
 #include <process/collect.hpp>
+#include <process/http.hpp>
 #include <process/io.hpp>
+#include <process/loop.hpp>
 
 #ifdef __WINDOWS__
 #include <process/windows/jobobject.hpp>
@@ -67,6 +71,10 @@ using namespace mesos::internal::slave;
 
 using namespace process;
 
+#ifndef __WINDOWS__
+namespace unix = process::network::unix;
+#endif // __WINDOWS__
+
 using std::map;
 using std::mutex;
 using std::pair;
@@ -1415,9 +1423,341 @@ Future<Nothing> Docker::rm(
 }
 
 
+#ifndef __WINDOWS__
+// Helpers for talking to the Docker daemon through the Docker Engine
+// API over its unix domain socket, which saves forking a Docker CLI
+// process (that in turn does the same) for every 'inspect' and 'ps'.
+// See https://docs.docker.com/engine/api/ for the endpoints.
+namespace api {
+
+// Returns the address of the daemon's unix domain socket, or None if
+// the daemon is not listening on one.
+static Option<unix::Address> address(const string& socket)
+{
+  if (!strings::startsWith(socket, DEFAULT_DOCKER_HOST_PREFIX)) {
+    return None();
+  }
+
+  Try<unix::Address> address = unix::Address::create(
+      strings::remove(socket, DEFAULT_DOCKER_HOST_PREFIX, strings::PREFIX));
+
+  if (address.isError()) {
+    VLOG(1) << "Invalid Docker socket '" << socket << "': " << address.error();
+    return None();
+  }
+
+  return address.get();
+}
+
+
+// Returns None if the daemon can't be reached, in which case callers
+// fall back to the Docker CLI.
+static Future<Option<http::Connection>> connect(const unix::Address& address)
+{
+  return http::connect(address, http::Scheme::HTTP)
+    .then([](const http::Connection& connection) {
+      return Option<http::Connection>(connection);
+    })
+    .repair([address](const Future<Option<http::Connection>>& future) {
+      VLOG(1) << "Failed to connect to the Docker daemon at '"
+              << address.path() << "', falling back to the Docker CLI: "
+              << future.failure();
+
+      return Option<http::Connection>::none();
+    });
+}
+
+
+static http::Request request(
+    const string& path,
+    const hashmap<string, string>& query = {})
+{
+  http::Request request;
+  request.method = "GET";
+  request.url = http::URL("http", "localhost", 80, path, query);
+  request.keepAlive = true;
+
+  return request;
+}
+
+
+// Returns the body of the response, or None if the daemon responded
+// with '404 Not Found'.
+static Future<Option<string>> get(
+    http::Connection connection,
+    const string& path,
+    const hashmap<string, string>& query = {})
+{
+  return connection.send(request(path, query))
+    .then([path](const http::Response& response) -> Future<Option<string>> {
+      if (response.code == http::Status::NOT_FOUND) {
+        return None();
+      }
+
+      if (response.code != http::Status::OK) {
+        return Failure(
+            "Unexpected response to 'GET " + path + "': " +
+            response.status + " '" + response.body + "'");
+      }
+
+      return Option<string>(response.body);
+    });
+}
+
+
+// Returns None if the container does not exist.
+static Future<Option<Docker::Container>> inspect(
+    http::Connection connection,
+    const string& containerName)
+{
+  return get(connection, "/containers/" + containerName + "/json")
+    .then([](const Option<string>& body)
+        -> Future<Option<Docker::Container>> {
+      if (body.isNone()) {
+        return None();
+      }
+
+      // 'docker inspect' prints the same object wrapped in an array.
+      Try<Docker::Container> container =
+        Docker::Container::create("[" + body.get() + "]");
+
+      if (container.isError()) {
+        return Failure("Unable to create container: " + container.error());
+      }
+
+      return Option<Docker::Container>(container.get());
+    });
+}
+
+
+// Inspects the container until it has started. Rather than polling,
+// we subscribe to the daemon's event stream for the container's
+// 'start' event (before the first inspect, so it can't be missed) and
+// only inspect again once an event arrives or `interval` elapsed.
+static Future<Docker::Container> wait(
+    const unix::Address& address,
+    http::Connection connection,
+    const string& containerName,
+    const Duration& interval)
+{
+  const JSON::Object filters{
+    {"type", JSON::Array{JSON::String("container")}},
+    {"container", JSON::Array{JSON::String(containerName)}},
+    {"event", JSON::Array{JSON::String("start")}}};
+
+  // The event stream never ends, hence it needs its own connection.
+  return api::connect(address)
+    .then([=](Option<http::Connection> events)
+        -> Future<Docker::Container> {
+      Future<Option<http::Pipe::Reader>> subscribe = None();
+
+      if (events.isSome()) {
+        subscribe = events->send(
+            request("/events", {{"filters", stringify(filters)}}), true)
+          .then([](const http::Response& response)
+              -> Option<http::Pipe::Reader> {
+            if (response.code != http::Status::OK ||
+                response.type != http::Response::PIPE) {
+              return None();
+            }
+
+            return response.reader;
+          })
+          .repair([](const Future<Option<http::Pipe::Reader>>&) {
+            return Option<http::Pipe::Reader>::none();
+          });
+      }
+
+      return subscribe
+        .then([=](Option<http::Pipe::Reader> reader) {
+          if (reader.isNone()) {
+            VLOG(1) << "Failed to subscribe to Docker events, polling "
+                    << "container '" << containerName << "' instead";
+          }
+
+          std::shared_ptr<Future<string>> event(new Future<string>(
+              reader.isSome()
+                ? reader->read()
+                : Failure("Not subscribed to Docker events")));
+
+          return loop(
+              None(),
+              [=]() {
+                return inspect(connection, containerName);
+              },
+              [=](const Option<Docker::Container>& container) mutable
+                  -> Future<ControlFlow<Docker::Container>> {
+                if (container.isSome() && container->started) {
+                  return Break(container.get());
+                }
+
+                // Consume the event which woke us up, if any.
+                if (event->isReady() && !event->get().empty()) {
+                  CHECK_SOME(reader);
+                  *event = reader->read();
+                }
+
+                // Back to polling if the event stream has ended.
+                if (!event->isPending()) {
+                  return process::after(interval)
+                    .then([]() -> ControlFlow<Docker::Container> {
+                      return Continue();
+                    });
+                }
+
+                return event->after(
+                    interval,
+                    [](const Future<string>&) { return string(); })
+                  .then([](const string&) -> ControlFlow<Docker::Container> {
+                    return Continue();
+                  });
+              })
+            .onAny([=]() mutable {
+              if (reader.isSome()) {
+                reader->close();
+              }
+            });
+        })
+        .onAny([=]() mutable {
+          if (events.isSome()) {
+            events->disconnect();
+          }
+        });
+    });
+}
+
+
+static Future<vector<Docker::Container>> ps(
+    http::Connection connection,
+    bool all,
+    const Option<string>& prefix)
+{
+  hashmap<string, string> query;
+  if (all) {
+    query["all"] = "1";
+  }
+
+  return get(connection, "/containers/json", query)
+    .then([=](const Option<string>& body)
+        -> Future<vector<Docker::Container>> {
+      if (body.isNone()) {
+        return Failure("Failed to list containers: '404 Not Found'");
+      }
+
+      Try<JSON::Array> parse = JSON::parse<JSON::Array>(body.get());
+      if (parse.isError()) {
+        return Failure("Failed to parse JSON: " + parse.error());
+      }
+
+      // The listing lacks most of what `Docker::Container` needs (e.g.,
+      // the pid), so we still inspect each container. The requests are
+      // pipelined on the same connection, hence there's no need to limit
+      // them like the Docker CLI calls (see DOCKER_PS_MAX_INSPECT_CALLS).
+      vector<Future<Option<Docker::Container>>> inspects;
+
+      foreach (const JSON::Value& value, parse->values) {
+        if (!value.is<JSON::Object>()) {
+          return Failure("Malformed container list: " + body.get());
+        }
+
+        const JSON::Object& object = value.as<JSON::Object>();
+
+        Result<JSON::String> id = object.find<JSON::String>("Id");
+        Result<JSON::Array> names = object.find<JSON::Array>("Names");
+
+        if (!id.isSome() || !names.isSome()) {
+          return Failure("Malformed container list: " + body.get());
+        }
+
+        bool matches = prefix.isNone();
+
+        foreach (const JSON::Value& name, names->values) {
+          if (!matches && name.is<JSON::String>()) {
+            // Names are prefixed with '/', unlike in 'docker ps'.
+            matches = strings::startsWith(
+                strings::remove(
+                    name.as<JSON::String>().value, "/", strings::PREFIX),
+                prefix.get());
+          }
+        }
+
+        if (matches) {
+          inspects.push_back(inspect(connection, id->value));
+        }
+      }
+
+      return collect(inspects)
+        .then([](const vector<Option<Docker::Container>>& results) {
+          vector<Docker::Container> containers;
+
+          // Skip containers removed since they were listed, as a later
+          // 'docker ps' wouldn't have listed them either.
+          foreach (const Option<Docker::Container>& container, results) {
+            if (container.isSome()) {
+              containers.push_back(container.get());
+            }
+          }
+
+          return containers;
+        });
+    });
+}
+
+} // namespace api {
+#endif // __WINDOWS__
+
+
 Future<Docker::Container> Docker::inspect(
     const string& containerName,
     const Option<Duration>& retryInterval) const
+{
+#ifdef __WINDOWS__
+  return inspectCLI(containerName, retryInterval);
+#else
+  Option<unix::Address> address = api::address(socket);
+  if (address.isNone()) {
+    return inspectCLI(containerName, retryInterval);
+  }
+
+  const Docker docker = *this;
+
+  return api::connect(address.get())
+    .then([=](Option<http::Connection> connection) -> Future<Container> {
+      if (connection.isNone()) {
+        return docker.inspectCLI(containerName, retryInterval);
+      }
+
+      Future<Container> container;
+
+      if (retryInterval.isSome()) {
+        container = api::wait(
+            address.get(),
+            connection.get(),
+            containerName,
+            retryInterval.get());
+      } else {
+        container = api::inspect(connection.get(), containerName)
+          .then([=](const Option<Container>& inspected) -> Future<Container> {
+            if (inspected.isNone()) {
+              return Failure("No such container: " + containerName);
+            }
+
+            return inspected.get();
+          });
+      }
+
+      return container
+        .onAny([=]() mutable {
+          connection->disconnect();
+        });
+    });
+#endif // __WINDOWS__
+}
+
+
+Future<Docker::Container> Docker::inspectCLI(
+    const string& containerName,
+    const Option<Duration>& retryInterval) const
 {
   Owned<Promise<Docker::Container>> promise(new Promise<Docker::Container>());
 
@@ -1599,6 +1939,36 @@ void Docker::___inspect(
 Future<vector<Docker::Container>> Docker::ps(
     bool all,
     const Option<string>& prefix) const
+{
+#ifdef __WINDOWS__
+  return psCLI(all, prefix);
+#else
+  Option<unix::Address> address = api::address(socket);
+  if (address.isNone()) {
+    return psCLI(all, prefix);
+  }
+
+  const Docker docker = *this;
+
+  return api::connect(address.get())
+    .then([=](Option<http::Connection> connection)
+        -> Future<vector<Container>> {
+      if (connection.isNone()) {
+        return docker.psCLI(all, prefix);
+      }
+
+      return api::ps(connection.get(), all, prefix)
+        .onAny([=]() mutable {
+          connection->disconnect();
+        });
+    });
+#endif // __WINDOWS__
+}
+
+
+Future<vector<Docker::Container>> Docker::psCLI(
+    bool all,
+    const Option<string>& prefix) const
 {
   vector<string> argv;
   argv.push_back(path);
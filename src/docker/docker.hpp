@@ -302,11 +302,19 @@ public:
   // Performs 'docker inspect CONTAINER'. If retryInterval is set,
   // we will keep retrying inspect until the container is started or
   // the future is discarded.
+  //
+  // NOTE: When the daemon listens on a unix domain socket, this talks
+  // to the Docker Engine API directly rather than running the Docker
+  // CLI, and waits for the container to start by subscribing to the
+  // daemon's event stream; `retryInterval` then only bounds how long
+  // we wait for an event before inspecting again.
   virtual process::Future<Container> inspect(
       const std::string& containerName,
       const Option<Duration>& retryInterval = None()) const;
 
-  // Performs 'docker ps (-a)'.
+  // Performs 'docker ps (-a)'. When talking to the Docker Engine API
+  // (see above), the containers are listed and then inspected over a
+  // single connection.
   virtual process::Future<std::vector<Container>> ps(
       bool all = false,
       const Option<std::string>& prefix = None()) const;
@@ -353,6 +361,11 @@ private:
       const process::Subprocess& s,
       bool remove);
 
+  // Runs 'docker inspect' through the Docker CLI.
+  process::Future<Container> inspectCLI(
+      const std::string& containerName,
+      const Option<Duration>& retryInterval) const;
+
   static void _inspect(
       const std::vector<std::string>& argv,
       const process::Owned<process::Promise<Container>>& promise,
@@ -377,6 +390,11 @@ private:
       std::shared_ptr<std::pair<lambda::function<void()>, std::mutex>>
         callback);
 
+  // Runs 'docker ps' through the Docker CLI.
+  process::Future<std::vector<Container>> psCLI(
+      bool all,
+      const Option<std::string>& prefix) const;
+
   static process::Future<std::vector<Container>> _ps(
       const Docker& docker,
       const std::string& cmd,
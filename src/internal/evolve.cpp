@@ -164,6 +164,12 @@ v1::Offer evolve(const Offer& offer)
 }
 
 
+v1::Offer::Delta evolve(const Offer::Delta& delta)
+{
+  return evolve<v1::Offer::Delta>(delta);
+}
+
+
 v1::OfferID evolve(const OfferID& offerId)
 {
   return evolve<v1::OfferID>(offerId);
@@ -401,6 +407,8 @@ v1::scheduler::Event evolve(const ResourceOffersMessage& message)
 
   v1::scheduler::Event::Offers* offers = event.mutable_offers();
   *offers->mutable_offers() = evolve<v1::Offer>(message.offers());
+  *offers->mutable_offer_deltas() =
+    evolve<v1::Offer::Delta>(message.offer_deltas());
 
   return event;
 }
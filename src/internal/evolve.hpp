@@ -75,6 +75,7 @@ v1::KillPolicy evolve(const KillPolicy& killPolicy);
 v1::MachineID evolve(const MachineID& machineId);
 v1::MasterInfo evolve(const MasterInfo& masterInfo);
 v1::Offer evolve(const Offer& offer);
+v1::Offer::Delta evolve(const Offer::Delta& delta);
 v1::OfferID evolve(const OfferID& offerId);
 v1::OperationStatus evolve(const OperationStatus& status);
 v1::Resource evolve(const Resource& resource);
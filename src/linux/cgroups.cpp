@@ -1289,6 +1289,80 @@ Try<Nothing> state(
 
 } // namespace freezer {
 
+
+// Forward declaration.
+Result<string> cgroup(pid_t pid, const string& subsystem);
+
+
+namespace pidfd {
+
+// The system call numbers are the same on all architectures since they
+// were added after the system call tables were unified (Linux 5.1/5.3).
+#ifndef __NR_pidfd_send_signal
+#define __NR_pidfd_send_signal 424
+#endif
+
+#ifndef __NR_pidfd_open
+#define __NR_pidfd_open 434
+#endif
+
+
+// Returns a pidfd referring to the process, or None if the process does
+// not exist (anymore).
+Result<int> open(pid_t pid)
+{
+  int fd = ::syscall(__NR_pidfd_open, pid, 0);
+  if (fd < 0) {
+    if (errno == ESRCH) {
+      return None();
+    }
+
+    return ErrnoError("Failed to open pidfd for process " + stringify(pid));
+  }
+
+  Try<Nothing> cloexec = os::cloexec(fd);
+  if (cloexec.isError()) {
+    os::close(fd);
+    return Error("Failed to set cloexec on pidfd: " + cloexec.error());
+  }
+
+  return fd;
+}
+
+
+// Sends the signal to the process referred to by the pidfd. Unlike
+// `::kill()` this can not hit an unrelated process which has been
+// assigned the pid of the exited one.
+Try<Nothing> signal(int fd, int signal)
+{
+  if (::syscall(__NR_pidfd_send_signal, fd, signal, nullptr, 0) < 0 &&
+      errno != ESRCH) {
+    return ErrnoError();
+  }
+
+  return Nothing();
+}
+
+
+// Returns whether the kernel supports pidfds (Linux 5.3+).
+bool supported()
+{
+  static const bool result = []() {
+    Result<int> fd = open(::getpid());
+    if (!fd.isSome()) {
+      return false;
+    }
+
+    os::close(fd.get());
+    return true;
+  }();
+
+  return result;
+}
+
+} // namespace pidfd {
+
+
 class Freezer : public Process<Freezer>
 {
 public:
@@ -1385,13 +1459,25 @@ private:
 
 
 // The process used to atomically kill all tasks in a cgroup.
+//
+// If the kernel supports pidfds, the processes are killed through them
+// without freezing the cgroup first, and their exits are awaited by
+// polling the pidfds rather than relying on the (interval based)
+// reaper. Processes forked in the meantime are still members of the
+// cgroup and will be killed in the next round. If the cgroup is not
+// empty after `PIDFD_KILL_ROUNDS` rounds (e.g., due to a fork bomb),
+// or if a pidfd cannot be opened (e.g., because the agent ran out of
+// file descriptors), we fall back to freezing the cgroup before
+// killing.
 class TasksKiller : public Process<TasksKiller>
 {
 public:
   TasksKiller(const string& _hierarchy, const string& _cgroup)
     : ProcessBase(ID::generate("cgroups-tasks-killer")),
       hierarchy(_hierarchy),
-      cgroup(_cgroup) {}
+      cgroup(_cgroup),
+      rounds(0),
+      fallback(false) {}
 
   ~TasksKiller() override {}
 
@@ -1439,6 +1525,43 @@ private:
   }
 
   void killTasks() {
+    // We need a subsystem attached to the hierarchy to be able to
+    // verify that a pid still refers to a process in the cgroup.
+    Try<set<string>> attached = cgroups::subsystems(hierarchy);
+    if (attached.isSome() && !attached->empty() && pidfd::supported()) {
+      subsystem = *attached->begin();
+
+      chain = process::loop(
+          self(),
+          [=]() { return signal(); },
+          [=](bool empty) -> Future<ControlFlow<Nothing>> {
+            if (empty) {
+              return Break();
+            }
+
+            if (fallback) {
+              LOG(WARNING) << "Freezing cgroup "
+                           << path::join(hierarchy, cgroup)
+                           << " to kill the rest of its processes";
+            } else if (++rounds < PIDFD_KILL_ROUNDS) {
+              return Continue();
+            } else {
+              LOG(WARNING) << "Cgroup " << path::join(hierarchy, cgroup)
+                           << " is still populated after " << rounds
+                           << " rounds of killing, freezing it";
+            }
+
+            return freeze()
+              .then(defer(self(), &Self::kill))
+              .then(defer(self(), &Self::thaw))
+              .then([]() -> ControlFlow<Nothing> { return Break(); });
+          })
+        .then(defer(self(), &Self::reap));
+
+      chain.onAny(defer(self(), &Self::finished, lambda::_1));
+      return;
+    }
+
     // Chain together the steps needed to kill all tasks in the cgroup.
     chain = freeze()                     // Freeze the cgroup.
       .then(defer(self(), &Self::kill))  // Send kill signal.
@@ -1448,6 +1571,77 @@ private:
     chain.onAny(defer(self(), &Self::finished, lambda::_1));
   }
 
+  // Kills the processes currently in the cgroup through pidfds and
+  // waits for them to exit. Returns true if the cgroup was empty.
+  // If a pidfd cannot be opened, it sets `fallback` and returns false
+  // without waiting, so that the rest of the processes are killed by
+  // freezing the cgroup.
+  Future<bool> signal()
+  {
+    // Don't start another round if we've been asked to stop.
+    if (promise.future().hasDiscard()) {
+      terminate(self());
+      return true;
+    }
+
+    Try<set<pid_t>> processes = cgroups::processes(hierarchy, cgroup);
+    if (processes.isError()) {
+      return Failure(processes.error());
+    }
+
+    if (processes->empty()) {
+      return true;
+    }
+
+    vector<Future<short>> exits;
+
+    foreach (const pid_t pid, processes.get()) {
+      Result<int> fd = pidfd::open(pid);
+      if (fd.isError()) {
+        LOG(WARNING) << fd.error() << "; falling back to the freezer to kill"
+                     << " the processes in cgroup "
+                     << path::join(hierarchy, cgroup);
+
+        fallback = true;
+        return false;
+      } else if (fd.isNone()) {
+        continue; // The process has already exited.
+      }
+
+      // Make sure the pid was not reused by an unrelated process
+      // between reading the cgroup and opening the pidfd. Once we hold
+      // the pidfd, it keeps referring to the process we checked.
+      Result<string> current = internal::cgroup(pid, subsystem.get());
+      if (!current.isSome() ||
+          strings::trim(current.get(), "/") != strings::trim(cgroup, "/")) {
+        os::close(fd.get());
+        continue;
+      }
+
+      Try<Nothing> kill = pidfd::signal(fd.get(), SIGKILL);
+      if (kill.isError()) {
+        os::close(fd.get());
+        return Failure(
+            "Failed to kill process " + stringify(pid) + ": " +
+            kill.error());
+      }
+
+      // A pidfd becomes readable once the process has exited.
+      const int _fd = fd.get();
+      Future<short> exit = io::poll(_fd, io::READ)
+        .onAny([_fd]() { os::close(_fd); });
+
+      exits.push_back(exit);
+
+      // Reap our own children so that the exit status is observed by
+      // anyone else reaping them as well.
+      statuses.push_back(exit.then([pid]() { return process::reap(pid); }));
+    }
+
+    return collect(exits)
+      .then([]() { return false; });
+  }
+
   Future<Nothing> freeze()
   {
     // Don't start another `killTasks` cycle if we've been asked to stop.
@@ -1537,6 +1731,15 @@ private:
   Promise<Nothing> promise;
   vector<Future<Option<int>>> statuses; // List of statuses for processes.
   Future<vector<Option<int>>> chain; // Used to discard all operations.
+
+  // A subsystem attached to the hierarchy, if the tasks are killed
+  // through pidfds.
+  Option<string> subsystem;
+  unsigned int rounds;
+
+  // Whether a pidfd could not be opened, in which case the rest of the
+  // processes are killed by freezing the cgroup.
+  bool fallback;
 };
 
 
@@ -47,6 +47,11 @@ const Duration FREEZE_RETRY_INTERVAL = Seconds(10);
 // Default number of assign attempts when moving threads to a cgroup.
 const unsigned int THREAD_ASSIGN_RETRIES = 100;
 
+
+// Number of rounds of killing the processes of a cgroup through pidfds
+// before `destroy()` falls back to freezing the cgroup first.
+const unsigned int PIDFD_KILL_ROUNDS = 10;
+
 // We use the following notations throughout the cgroups code. The notations
 // here are derived from the kernel documentation. More details can be found in
 // <kernel-source>/Documentation/cgroups/cgroups.txt.
@@ -0,0 +1,494 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <signal.h>
+
+#include <algorithm>
+#include <list>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <process/after.hpp>
+#include <process/clock.hpp>
+#include <process/loop.hpp>
+#include <process/time.hpp>
+
+#include <stout/error.hpp>
+#include <stout/foreach.hpp>
+#include <stout/numify.hpp>
+#include <stout/os.hpp>
+#include <stout/path.hpp>
+#include <stout/stringify.hpp>
+#include <stout/strings.hpp>
+
+#include <stout/os/exists.hpp>
+#include <stout/os/ls.hpp>
+#include <stout/os/read.hpp>
+#include <stout/os/stat.hpp>
+#include <stout/os/write.hpp>
+
+#include "linux/cgroups2.hpp"
+#include "linux/fs.hpp"
+
+using mesos::PressureStallInformation;
+
+using process::Break;
+using process::Clock;
+using process::Continue;
+using process::ControlFlow;
+using process::Failure;
+using process::Future;
+using process::Time;
+
+using std::set;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace cgroups2 {
+
+// The interval at which `destroy()` starts polling 'cgroup.events' for
+// the cgroup to become unpopulated; it backs off up to the maximum.
+static const Duration DESTROY_POLL_INTERVAL = Milliseconds(1);
+static const Duration DESTROY_MAX_POLL_INTERVAL = Milliseconds(100);
+
+
+bool enabled()
+{
+  return mountpoint().isSome();
+}
+
+
+Try<string> mountpoint()
+{
+  Try<mesos::internal::fs::MountTable> table =
+    mesos::internal::fs::MountTable::read("/proc/mounts");
+
+  if (table.isError()) {
+    return Error("Failed to read mount table: " + table.error());
+  }
+
+  foreach (const mesos::internal::fs::MountTable::Entry& entry,
+           table->entries) {
+    if (entry.type == FILE_SYSTEM) {
+      return entry.dir;
+    }
+  }
+
+  return Error("No '" + FILE_SYSTEM + "' file system is mounted");
+}
+
+
+Try<Nothing> create(const string& root, const string& cgroup, bool recursive)
+{
+  string path = path::join(root, cgroup);
+
+  Try<Nothing> mkdir = os::mkdir(path, recursive);
+  if (mkdir.isError()) {
+    return Error(
+        "Failed to create directory '" + path + "': " + mkdir.error());
+  }
+
+  return Nothing();
+}
+
+
+bool exists(const string& root, const string& cgroup, const string& control)
+{
+  return os::exists(path::join(root, cgroup, control));
+}
+
+
+Try<vector<string>> get(const string& root, const string& cgroup)
+{
+  Try<std::list<string>> entries = os::ls(path::join(root, cgroup));
+  if (entries.isError()) {
+    return Error(
+        "Failed to list '" + path::join(root, cgroup) + "': " +
+        entries.error());
+  }
+
+  vector<string> result;
+
+  foreach (const string& entry, entries.get()) {
+    const string child = path::join(cgroup, entry);
+    if (!os::stat::isdir(path::join(root, child))) {
+      continue;
+    }
+
+    Try<vector<string>> descendants = get(root, child);
+    if (descendants.isError()) {
+      return Error(descendants.error());
+    }
+
+    result.insert(result.end(), descendants->begin(), descendants->end());
+    result.push_back(strings::trim(child, "/"));
+  }
+
+  return result;
+}
+
+
+Try<Nothing> remove(const string& root, const string& cgroup)
+{
+  Try<vector<string>> cgroups = get(root, cgroup);
+  if (cgroups.isError()) {
+    return Error("Failed to get nested cgroups: " + cgroups.error());
+  }
+
+  vector<string> candidates = cgroups.get();
+  candidates.push_back(cgroup);
+
+  foreach (const string& candidate, candidates) {
+    const string path = path::join(root, candidate);
+
+    // NOTE: Control files of a cgroup can not be removed, so we use
+    // `rmdir` directly rather than `os::rmdir` which would first try
+    // to remove the contents of the directory.
+    if (::rmdir(path.c_str()) < 0 && errno != ENOENT) {
+      return ErrnoError("Failed to remove cgroup '" + path + "'");
+    }
+  }
+
+  return Nothing();
+}
+
+
+Try<string> read(
+    const string& root,
+    const string& cgroup,
+    const string& control)
+{
+  return os::read(path::join(root, cgroup, control));
+}
+
+
+Try<Nothing> write(
+    const string& root,
+    const string& cgroup,
+    const string& control,
+    const string& value)
+{
+  return os::write(path::join(root, cgroup, control), value);
+}
+
+
+Try<Nothing> assign(const string& root, const string& cgroup, pid_t pid)
+{
+  return write(root, cgroup, "cgroup.procs", stringify(pid));
+}
+
+
+Try<set<pid_t>> processes(const string& root, const string& cgroup)
+{
+  Try<string> value = read(root, cgroup, "cgroup.procs");
+  if (value.isError()) {
+    return Error("Failed to read 'cgroup.procs': " + value.error());
+  }
+
+  set<pid_t> pids;
+  foreach (const string& line, strings::tokenize(value.get(), "\n")) {
+    Try<pid_t> pid = numify<pid_t>(strings::trim(line));
+    if (pid.isError()) {
+      return Error("Failed to parse '" + line + "': " + pid.error());
+    }
+
+    pids.insert(pid.get());
+  }
+
+  return pids;
+}
+
+
+namespace controllers {
+
+Try<set<string>> available(const string& root, const string& cgroup)
+{
+  Try<string> value = read(root, cgroup, "cgroup.controllers");
+  if (value.isError()) {
+    return Error("Failed to read 'cgroup.controllers': " + value.error());
+  }
+
+  vector<string> tokens = strings::tokenize(value.get(), " \n");
+  return set<string>(tokens.begin(), tokens.end());
+}
+
+
+Try<Nothing> enable(
+    const string& root,
+    const string& cgroup,
+    const set<string>& controllers)
+{
+  vector<string> tokens;
+  foreach (const string& controller, controllers) {
+    tokens.push_back("+" + controller);
+  }
+
+  Try<Nothing> write = cgroups2::write(
+      root, cgroup, "cgroup.subtree_control", strings::join(" ", tokens));
+
+  if (write.isError()) {
+    return Error(
+        "Failed to enable controllers " + stringify(controllers) +
+        " in '" + path::join(root, cgroup) + "': " + write.error());
+  }
+
+  return Nothing();
+}
+
+} // namespace controllers {
+
+
+Try<hashmap<string, uint64_t>> stat(
+    const string& root,
+    const string& cgroup,
+    const string& control)
+{
+  Try<string> value = read(root, cgroup, control);
+  if (value.isError()) {
+    return Error(
+        "Failed to read '" + control + "': " + value.error());
+  }
+
+  hashmap<string, uint64_t> result;
+
+  foreach (const string& line, strings::tokenize(value.get(), "\n")) {
+    vector<string> tokens = strings::tokenize(line, " ");
+    if (tokens.size() != 2) {
+      return Error("Unexpected line '" + line + "' in '" + control + "'");
+    }
+
+    Try<uint64_t> number = numify<uint64_t>(tokens[1]);
+    if (number.isError()) {
+      return Error(
+          "Failed to parse '" + tokens[1] + "' in '" + control + "': " +
+          number.error());
+    }
+
+    result[tokens[0]] = number.get();
+  }
+
+  return result;
+}
+
+
+Try<PressureStallInformation> parsePressure(const string& value)
+{
+  PressureStallInformation result;
+
+  // Each line looks like:
+  //   some avg10=0.00 avg60=0.00 avg300=0.00 total=0
+  foreach (const string& line, strings::tokenize(value, "\n")) {
+    vector<string> tokens = strings::tokenize(line, " ");
+    if (tokens.empty()) {
+      continue;
+    }
+
+    PressureStallInformation::Stall* stall = nullptr;
+    if (tokens[0] == "some") {
+      stall = result.mutable_some();
+    } else if (tokens[0] == "full") {
+      stall = result.mutable_full();
+    } else {
+      return Error("Unexpected line '" + line + "'");
+    }
+
+    for (size_t i = 1; i < tokens.size(); i++) {
+      vector<string> pair = strings::split(tokens[i], "=");
+      if (pair.size() != 2) {
+        return Error("Unexpected field '" + tokens[i] + "'");
+      }
+
+      if (pair[0] == "total") {
+        Try<uint64_t> total = numify<uint64_t>(pair[1]);
+        if (total.isError()) {
+          return Error(
+              "Failed to parse '" + tokens[i] + "': " + total.error());
+        }
+
+        stall->set_total(total.get());
+        continue;
+      }
+
+      Try<double> average = numify<double>(pair[1]);
+      if (average.isError()) {
+        return Error(
+            "Failed to parse '" + tokens[i] + "': " + average.error());
+      }
+
+      if (pair[0] == "avg10") {
+        stall->set_avg10(average.get());
+      } else if (pair[0] == "avg60") {
+        stall->set_avg60(average.get());
+      } else if (pair[0] == "avg300") {
+        stall->set_avg300(average.get());
+      }
+    }
+  }
+
+  return result;
+}
+
+
+Try<PressureStallInformation> pressure(
+    const string& root,
+    const string& cgroup,
+    const string& control)
+{
+  Try<string> value = read(root, cgroup, control);
+  if (value.isError()) {
+    return Error("Failed to read '" + control + "': " + value.error());
+  }
+
+  Try<PressureStallInformation> result = parsePressure(value.get());
+  if (result.isError()) {
+    return Error(
+        "Failed to parse '" + control + "': " + result.error());
+  }
+
+  return result;
+}
+
+
+namespace internal {
+
+// Returns whether the cgroup or any of its descendants has processes.
+Try<bool> populated(const string& root, const string& cgroup)
+{
+  Try<hashmap<string, uint64_t>> events = stat(root, cgroup, "cgroup.events");
+  if (events.isError()) {
+    return Error(events.error());
+  }
+
+  if (!events->contains("populated")) {
+    return Error("Missing 'populated' in 'cgroup.events'");
+  }
+
+  return events->at("populated") != 0;
+}
+
+
+// Sends SIGKILL to all the processes in the cgroup and its descendants.
+// Used on kernels without 'cgroup.kill'.
+Try<Nothing> kill(const string& root, const string& cgroup)
+{
+  Try<vector<string>> cgroups = get(root, cgroup);
+  if (cgroups.isError()) {
+    return Error("Failed to get nested cgroups: " + cgroups.error());
+  }
+
+  vector<string> candidates = cgroups.get();
+  candidates.push_back(cgroup);
+
+  foreach (const string& candidate, candidates) {
+    Try<set<pid_t>> pids = processes(root, candidate);
+    if (pids.isError()) {
+      return Error(pids.error());
+    }
+
+    foreach (pid_t pid, pids.get()) {
+      // NOTE: A process may exit on its own in the meantime, which
+      // is fine. SIGKILL is delivered to frozen processes as well.
+      if (::kill(pid, SIGKILL) < 0 && errno != ESRCH) {
+        return ErrnoError("Failed to kill process " + stringify(pid));
+      }
+    }
+  }
+
+  return Nothing();
+}
+
+} // namespace internal {
+
+
+Future<Nothing> destroy(
+    const string& root,
+    const string& cgroup,
+    const Duration& timeout)
+{
+  if (!exists(root, cgroup)) {
+    return Nothing();
+  }
+
+  // 'cgroup.kill' kills the whole subtree atomically with respect to
+  // forks, so a single write suffices. Otherwise we freeze the cgroup
+  // to stop it from forking and keep killing until it is unpopulated.
+  const bool killable = exists(root, cgroup, "cgroup.kill");
+
+  if (killable) {
+    Try<Nothing> kill = write(root, cgroup, "cgroup.kill", "1");
+    if (kill.isError()) {
+      return Failure("Failed to write 'cgroup.kill': " + kill.error());
+    }
+  } else if (exists(root, cgroup, "cgroup.freeze")) {
+    Try<Nothing> freeze = write(root, cgroup, "cgroup.freeze", "1");
+    if (freeze.isError()) {
+      return Failure("Failed to write 'cgroup.freeze': " + freeze.error());
+    }
+  }
+
+  const Time deadline = Clock::now() + timeout;
+  shared_ptr<Duration> interval(new Duration(DESTROY_POLL_INTERVAL));
+  shared_ptr<bool> first(new bool(true));
+
+  return process::loop(
+      [=]() -> Future<Nothing> {
+        if (*first) {
+          *first = false;
+          return Nothing();
+        }
+
+        Duration wait = *interval;
+        *interval = std::min(*interval * 2, DESTROY_MAX_POLL_INTERVAL);
+        return process::after(wait);
+      },
+      [=](const Nothing&) -> Future<ControlFlow<Nothing>> {
+        Try<bool> populated = internal::populated(root, cgroup);
+        if (populated.isError()) {
+          return Failure(
+              "Failed to check whether cgroup '" + cgroup +
+              "' is populated: " + populated.error());
+        }
+
+        if (!populated.get()) {
+          Try<Nothing> remove = cgroups2::remove(root, cgroup);
+          if (remove.isError()) {
+            return Failure(remove.error());
+          }
+
+          return Break();
+        }
+
+        if (Clock::now() > deadline) {
+          return Failure(
+              "Timed out after " + stringify(timeout) +
+              " waiting for cgroup '" + cgroup + "' to become empty");
+        }
+
+        if (!killable) {
+          Try<Nothing> kill = internal::kill(root, cgroup);
+          if (kill.isError()) {
+            return Failure(kill.error());
+          }
+        }
+
+        return Continue();
+      });
+}
+
+} // namespace cgroups2 {
@@ -0,0 +1,163 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __CGROUPS2_HPP__
+#define __CGROUPS2_HPP__
+
+#include <stdint.h>
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include <sys/types.h>
+
+#include <mesos/mesos.hpp>
+
+#include <process/future.hpp>
+
+#include <stout/duration.hpp>
+#include <stout/hashmap.hpp>
+#include <stout/nothing.hpp>
+#include <stout/try.hpp>
+
+// Helpers for the cgroup v2 unified hierarchy. Unlike cgroups v1
+// (see linux/cgroups.hpp) there is a single hierarchy which all
+// controllers are attached to, so every function takes the mount
+// point of that hierarchy (see `cgroups2::mountpoint()`) as `root`
+// and a cgroup path relative to it. More details can be found in
+// <kernel-source>/Documentation/admin-guide/cgroup-v2.rst.
+namespace cgroups2 {
+
+// File system type of the unified hierarchy.
+const std::string FILE_SYSTEM = "cgroup2";
+
+
+// Returns true if a cgroup2 file system is mounted.
+bool enabled();
+
+
+// Returns the mount point of the unified hierarchy.
+Try<std::string> mountpoint();
+
+
+// Creates a cgroup. If `recursive` is true, missing ancestors are
+// created as well.
+Try<Nothing> create(
+    const std::string& root,
+    const std::string& cgroup,
+    bool recursive = false);
+
+
+// Returns true if the cgroup (or the given control of it) exists.
+bool exists(
+    const std::string& root,
+    const std::string& cgroup,
+    const std::string& control = "");
+
+
+// Returns all the descendants of the cgroup, ordered such that every
+// cgroup appears before its ancestors (i.e. safe for removal).
+Try<std::vector<std::string>> get(
+    const std::string& root,
+    const std::string& cgroup = "/");
+
+
+// Removes an empty cgroup along with all of its (empty) descendants.
+Try<Nothing> remove(const std::string& root, const std::string& cgroup);
+
+
+// Reads/writes a control file of the cgroup.
+Try<std::string> read(
+    const std::string& root,
+    const std::string& cgroup,
+    const std::string& control);
+
+
+Try<Nothing> write(
+    const std::string& root,
+    const std::string& cgroup,
+    const std::string& control,
+    const std::string& value);
+
+
+// Moves the process into the cgroup.
+Try<Nothing> assign(
+    const std::string& root,
+    const std::string& cgroup,
+    pid_t pid);
+
+
+// Returns the processes in the cgroup (not including descendants).
+Try<std::set<pid_t>> processes(
+    const std::string& root,
+    const std::string& cgroup);
+
+
+namespace controllers {
+
+// Returns the controllers available to the cgroup ('cgroup.controllers').
+Try<std::set<std::string>> available(
+    const std::string& root,
+    const std::string& cgroup);
+
+
+// Enables the controllers for the children of the cgroup by writing
+// to its 'cgroup.subtree_control'. Due to the "no internal process"
+// constraint, this fails for non-root cgroups which have processes.
+Try<Nothing> enable(
+    const std::string& root,
+    const std::string& cgroup,
+    const std::set<std::string>& controllers);
+
+} // namespace controllers {
+
+
+// Parses a flat keyed control file, e.g., 'cpu.stat', 'memory.stat'
+// or 'memory.events', in which each line is a "<key> <value>" pair.
+Try<hashmap<std::string, uint64_t>> stat(
+    const std::string& root,
+    const std::string& cgroup,
+    const std::string& control);
+
+
+// Parses a '<resource>.pressure' control file, e.g., 'cpu.pressure',
+// 'memory.pressure' or 'io.pressure'. Returns an error if the kernel
+// does not have PSI enabled.
+Try<mesos::PressureStallInformation> pressure(
+    const std::string& root,
+    const std::string& cgroup,
+    const std::string& control);
+
+
+// Parses the contents of a '<resource>.pressure' control file.
+Try<mesos::PressureStallInformation> parsePressure(const std::string& value);
+
+
+// Kills all the processes in the cgroup and its descendants, waits
+// for the cgroup to become unpopulated and then removes it along
+// with its descendants. Uses 'cgroup.kill' (Linux 5.14+) when
+// available, otherwise freezes the cgroup with 'cgroup.freeze' and
+// kills the processes one by one. The returned future fails if the
+// cgroup is still populated after `timeout`.
+process::Future<Nothing> destroy(
+    const std::string& root,
+    const std::string& cgroup,
+    const Duration& timeout = Seconds(60));
+
+} // namespace cgroups2 {
+
+#endif // __CGROUPS2_HPP__
@@ -14,14 +14,20 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <fcntl.h>
 #include <signal.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 
+#include <linux/perf_event.h>
+
 #include <sys/prctl.h>
+#include <sys/syscall.h>
 #include <sys/types.h>
 #include <sys/wait.h>
 
+#include <algorithm>
 #include <list>
 #include <sstream>
 #include <string>
@@ -36,6 +42,7 @@
 #include <process/process.hpp>
 #include <process/subprocess.hpp>
 
+#include <stout/numify.hpp>
 #include <stout/os.hpp>
 #include <stout/strings.hpp>
 
@@ -51,6 +58,7 @@ using process::await;
 
 using std::list;
 using std::ostringstream;
+using std::pair;
 using std::set;
 using std::string;
 using std::tuple;
@@ -349,6 +357,410 @@ bool valid(const set<string>& events)
 }
 
 
+namespace internal {
+
+// The type and configuration of a perf_event_open(2) event and the
+// `PerfStatistics` field it is reported in.
+struct Event
+{
+  uint32_t type;
+  uint64_t config;
+  string field;
+};
+
+
+// Returns the events that can be counted with `Counters`, keyed by
+// their normalized name, including the aliases known to perf(1).
+static const hashmap<string, Event>& events()
+{
+  static const hashmap<string, Event>* events = []() {
+    hashmap<string, Event>* events = new hashmap<string, Event>({
+      {"cycles", {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, "cycles"}},
+      {"cpu_cycles", {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, "cycles"}},
+      {"instructions",
+       {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, "instructions"}},
+      {"cache_references",
+       {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES,
+        "cache_references"}},
+      {"cache_misses",
+       {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, "cache_misses"}},
+      {"branches",
+       {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_INSTRUCTIONS, "branches"}},
+      {"branch_instructions",
+       {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_INSTRUCTIONS, "branches"}},
+      {"branch_misses",
+       {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, "branch_misses"}},
+      {"bus_cycles",
+       {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BUS_CYCLES, "bus_cycles"}},
+      {"stalled_cycles_frontend",
+       {PERF_TYPE_HARDWARE, PERF_COUNT_HW_STALLED_CYCLES_FRONTEND,
+        "stalled_cycles_frontend"}},
+      {"idle_cycles_frontend",
+       {PERF_TYPE_HARDWARE, PERF_COUNT_HW_STALLED_CYCLES_FRONTEND,
+        "stalled_cycles_frontend"}},
+      {"stalled_cycles_backend",
+       {PERF_TYPE_HARDWARE, PERF_COUNT_HW_STALLED_CYCLES_BACKEND,
+        "stalled_cycles_backend"}},
+      {"idle_cycles_backend",
+       {PERF_TYPE_HARDWARE, PERF_COUNT_HW_STALLED_CYCLES_BACKEND,
+        "stalled_cycles_backend"}},
+      {"ref_cycles",
+       {PERF_TYPE_HARDWARE, PERF_COUNT_HW_REF_CPU_CYCLES, "ref_cycles"}},
+      {"cpu_clock", {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CPU_CLOCK, "cpu_clock"}},
+      {"task_clock",
+       {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK, "task_clock"}},
+      {"page_faults",
+       {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS, "page_faults"}},
+      {"faults",
+       {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS, "page_faults"}},
+      {"minor_faults",
+       {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS_MIN, "minor_faults"}},
+      {"major_faults",
+       {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS_MAJ, "major_faults"}},
+      {"context_switches",
+       {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES,
+        "context_switches"}},
+      {"cs",
+       {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES,
+        "context_switches"}},
+      {"cpu_migrations",
+       {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CPU_MIGRATIONS, "cpu_migrations"}},
+      {"migrations",
+       {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CPU_MIGRATIONS, "cpu_migrations"}},
+      {"alignment_faults",
+       {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_ALIGNMENT_FAULTS,
+        "alignment_faults"}},
+      {"emulation_faults",
+       {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_EMULATION_FAULTS,
+        "emulation_faults"}},
+    });
+
+    // Hardware cache events are named `<cache>-<op>s` for accesses
+    // and `<cache>-<op>-misses` for misses, see perf_event_open(2).
+    const vector<pair<string, uint64_t>> caches = {
+      {"l1_dcache", PERF_COUNT_HW_CACHE_L1D},
+      {"l1_icache", PERF_COUNT_HW_CACHE_L1I},
+      {"llc", PERF_COUNT_HW_CACHE_LL},
+      {"dtlb", PERF_COUNT_HW_CACHE_DTLB},
+      {"itlb", PERF_COUNT_HW_CACHE_ITLB},
+      {"branch", PERF_COUNT_HW_CACHE_BPU},
+      {"node", PERF_COUNT_HW_CACHE_NODE},
+    };
+
+    const vector<pair<string, uint64_t>> ops = {
+      {"load", PERF_COUNT_HW_CACHE_OP_READ},
+      {"store", PERF_COUNT_HW_CACHE_OP_WRITE},
+      {"prefetch", PERF_COUNT_HW_CACHE_OP_PREFETCH},
+    };
+
+    const vector<pair<string, uint64_t>> results = {
+      {"s", PERF_COUNT_HW_CACHE_RESULT_ACCESS},
+      {"_misses", PERF_COUNT_HW_CACHE_RESULT_MISS},
+    };
+
+    foreach (const auto& cache, caches) {
+      foreach (const auto& op, ops) {
+        foreach (const auto& result, results) {
+          const string name = cache.first + "_" + op.first + result.first;
+
+          // Only keep the combinations that `PerfStatistics` can hold.
+          if (mesos::PerfStatistics::descriptor()->FindFieldByName(name) !=
+              nullptr) {
+            events->put(name, {
+                PERF_TYPE_HW_CACHE,
+                cache.second | (op.second << 8) | (result.second << 16),
+                name});
+          }
+        }
+      }
+    }
+
+    return events;
+  }();
+
+  return *events;
+}
+
+
+// Returns the online CPUs, see cpu(4) in the kernel documentation
+// ('Documentation/ABI/testing/sysfs-devices-system-cpu').
+static Try<vector<int>> cpus()
+{
+  Try<string> online = os::read("/sys/devices/system/cpu/online");
+  if (online.isError()) {
+    return Error("Failed to read online CPUs: " + online.error());
+  }
+
+  // The format is a list of ranges, e.g., "0-3,5,7-8".
+  vector<int> cpus;
+  foreach (const string& range, strings::tokenize(online.get(), ",\n")) {
+    vector<string> bounds = strings::split(range, "-");
+
+    Try<int> first = numify<int>(bounds.front());
+    Try<int> last = numify<int>(bounds.back());
+
+    if (bounds.size() > 2 || first.isError() || last.isError()) {
+      return Error("Failed to parse online CPUs '" + online.get() + "'");
+    }
+
+    for (int cpu = first.get(); cpu <= last.get(); cpu++) {
+      cpus.push_back(cpu);
+    }
+  }
+
+  return cpus;
+}
+
+} // namespace internal {
+
+
+Counters::Counters(
+    const vector<const google::protobuf::FieldDescriptor*>& _fields)
+  : start(Clock::now()),
+    fields(_fields) {}
+
+
+Counters::~Counters()
+{
+  foreach (int fd, fds) {
+    os::close(fd);
+  }
+}
+
+
+Try<Owned<Counters>> Counters::create(
+    const set<string>& events,
+    const string& cgroup,
+    const Option<size_t>& limit)
+{
+  vector<internal::Event> _events;
+  vector<const google::protobuf::FieldDescriptor*> fields;
+
+  foreach (const string& event, events) {
+    Option<internal::Event> _event =
+      internal::events().get(internal::normalize(event));
+
+    if (_event.isNone()) {
+      return Error("Unsupported event '" + event + "'");
+    }
+
+    const google::protobuf::FieldDescriptor* field =
+      mesos::PerfStatistics::descriptor()->FindFieldByName(_event->field);
+
+    CHECK_NOTNULL(field);
+
+    // Skip aliases of events that are already counted.
+    if (std::find(fields.begin(), fields.end(), field) != fields.end()) {
+      continue;
+    }
+
+    _events.push_back(_event.get());
+    fields.push_back(field);
+  }
+
+  if (_events.empty()) {
+    return Error("No events to count");
+  }
+
+  Try<vector<int>> cpus = internal::cpus();
+  if (cpus.isError()) {
+    return Error(cpus.error());
+  }
+
+  const size_t size = _events.size() * cpus->size();
+  if (limit.isSome() && size > limit.get()) {
+    return Error(
+        "Counting " + stringify(_events.size()) + " events on " +
+        stringify(cpus->size()) + " CPUs takes " + stringify(size) +
+        " file descriptors, more than the limit of " +
+        stringify(limit.get()));
+  }
+
+  // NOTE: The kernel holds a reference to the cgroup for as long as
+  // the events are open, the file descriptor is only needed to open
+  // them.
+  int cgroupFd = ::open(cgroup.c_str(), O_RDONLY | O_CLOEXEC);
+  if (cgroupFd < 0) {
+    return ErrnoError("Failed to open cgroup '" + cgroup + "'");
+  }
+
+  Owned<Counters> counters(new Counters(fields));
+
+  foreach (int cpu, cpus.get()) {
+    int leader = -1;
+
+    foreach (const internal::Event& event, _events) {
+      struct perf_event_attr attr;
+      memset(&attr, 0, sizeof(attr));
+
+      attr.size = sizeof(attr);
+      attr.type = event.type;
+      attr.config = event.config;
+      attr.read_format = PERF_FORMAT_GROUP |
+                         PERF_FORMAT_TOTAL_TIME_ENABLED |
+                         PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+      int fd = ::syscall(
+          __NR_perf_event_open,
+          &attr,
+          cgroupFd,
+          cpu,
+          leader,
+          PERF_FLAG_PID_CGROUP | PERF_FLAG_FD_CLOEXEC);
+
+      if (fd < 0) {
+        ErrnoError error(
+            "Failed to open event '" + event.field + "'"
+            " on CPU " + stringify(cpu) + " for cgroup '" + cgroup + "'");
+
+        os::close(cgroupFd);
+        return error;
+      }
+
+      counters->fds.push_back(fd);
+
+      if (leader == -1) {
+        leader = fd;
+        counters->leaders.push_back(fd);
+      }
+    }
+  }
+
+  os::close(cgroupFd);
+
+  return counters;
+}
+
+
+Try<Nothing> Counters::supported(
+    const set<string>& events,
+    const string& hierarchy)
+{
+  Try<Owned<Counters>> counters = create(events, hierarchy);
+  if (counters.isError()) {
+    return Error(counters.error());
+  }
+
+  return Nothing();
+}
+
+
+Try<mesos::PerfStatistics> Counters::read() const
+{
+  // With PERF_FORMAT_GROUP and the total times, a read returns the
+  // number of events, the time the group was enabled and the time it
+  // was running, followed by the value of each event.
+  vector<uint64_t> buffer(3 + fields.size());
+  vector<double> values(fields.size(), 0.0);
+
+  foreach (int leader, leaders) {
+    ssize_t length =
+      ::read(leader, buffer.data(), buffer.size() * sizeof(uint64_t));
+
+    if (length < 0) {
+      return ErrnoError("Failed to read perf events");
+    }
+
+    if (static_cast<size_t>(length) != buffer.size() * sizeof(uint64_t) ||
+        buffer[0] != fields.size()) {
+      return Error("Unexpected perf event group of " + stringify(length) +
+                   " bytes");
+    }
+
+    const uint64_t enabled = buffer[1];
+    const uint64_t running = buffer[2];
+
+    // The group has not been counted yet on this CPU.
+    if (running == 0) {
+      continue;
+    }
+
+    // Extrapolate the values if the group has been multiplexed.
+    const double scale = static_cast<double>(enabled) / running;
+
+    for (size_t i = 0; i < fields.size(); i++) {
+      values[i] += buffer[3 + i] * scale;
+    }
+  }
+
+  mesos::PerfStatistics statistics;
+  statistics.set_timestamp(start.secs());
+  statistics.set_duration((Clock::now() - start).secs());
+
+  const google::protobuf::Reflection* reflection = statistics.GetReflection();
+
+  for (size_t i = 0; i < fields.size(); i++) {
+    switch (fields[i]->type()) {
+      case google::protobuf::FieldDescriptor::TYPE_DOUBLE:
+        // The clocks are counted in nanoseconds, whereas `perf stat`
+        // reports them in milliseconds.
+        reflection->SetDouble(&statistics, fields[i], values[i] / 1000000.0);
+        break;
+      case google::protobuf::FieldDescriptor::TYPE_UINT64:
+        reflection->SetUInt64(
+            &statistics, fields[i], static_cast<uint64_t>(values[i]));
+        break;
+      default:
+        return Error("Unsupported perf field type of '" +
+                     fields[i]->name() + "'");
+    }
+  }
+
+  return statistics;
+}
+
+
+size_t Counters::size() const
+{
+  return fds.size();
+}
+
+
+mesos::PerfStatistics delta(
+    const mesos::PerfStatistics& previous,
+    const mesos::PerfStatistics& current)
+{
+  mesos::PerfStatistics statistics;
+  statistics.set_timestamp(previous.timestamp() + previous.duration());
+  statistics.set_duration(current.duration() - previous.duration());
+
+  const google::protobuf::Reflection* reflection = current.GetReflection();
+
+  vector<const google::protobuf::FieldDescriptor*> fields;
+  reflection->ListFields(current, &fields);
+
+  foreach (const google::protobuf::FieldDescriptor* field, fields) {
+    if (field->name() == "timestamp" || field->name() == "duration") {
+      continue;
+    }
+
+    // NOTE: Extrapolated values can decrease slightly between two
+    // readings, in which case we report zero.
+    switch (field->type()) {
+      case google::protobuf::FieldDescriptor::TYPE_DOUBLE: {
+        double value = reflection->GetDouble(current, field) -
+                       reflection->GetDouble(previous, field);
+
+        reflection->SetDouble(&statistics, field, std::max(value, 0.0));
+        break;
+      }
+      case google::protobuf::FieldDescriptor::TYPE_UINT64: {
+        uint64_t now = reflection->GetUInt64(current, field);
+        uint64_t before = reflection->GetUInt64(previous, field);
+
+        reflection->SetUInt64(
+            &statistics, field, now > before ? now - before : 0);
+        break;
+      }
+      default:
+        break;
+    }
+  }
+
+  return statistics;
+}
+
+
 struct Sample
 {
   const string value;
@@ -21,11 +21,17 @@
 
 #include <set>
 #include <string>
+#include <vector>
 
 #include <process/future.hpp>
+#include <process/owned.hpp>
+#include <process/time.hpp>
 
 #include <stout/duration.hpp>
 #include <stout/hashmap.hpp>
+#include <stout/nothing.hpp>
+#include <stout/option.hpp>
+#include <stout/try.hpp>
 #include <stout/version.hpp>
 
 // For PerfStatistics protobuf.
@@ -43,6 +49,76 @@ process::Future<hashmap<std::string, mesos::PerfStatistics>> sample(
     const Duration& duration);
 
 
+// Counts perf events for the process(es) in a perf_event cgroup
+// in-process using perf_event_open(2), i.e., without running the
+// `perf` binary.
+//
+// The events are opened in per-cgroup mode on every online CPU, as
+// one event group per CPU so that all counters of a CPU are read with
+// a single read(2) (see PERF_FORMAT_GROUP). The counters are kept
+// enabled until the `Counters` are destroyed, which makes reading
+// cheap enough to sample continuously. Note that this requires one
+// file descriptor per event and CPU (see `limit`), and that the events
+// of a group are only counted while they can all be scheduled on the
+// PMU at the same time.
+class Counters
+{
+public:
+  // Returns an error, without opening any event, if the counters
+  // would take more than `limit` file descriptors.
+  //
+  // NOTE: `cgroup` should be the absolute path of the cgroup, e.g.,
+  // /sys/fs/cgroup/perf_event/mesos/test.
+  static Try<process::Owned<Counters>> create(
+      const std::set<std::string>& events,
+      const std::string& cgroup,
+      const Option<size_t>& limit = None());
+
+  // Returns an error if the events cannot be counted with `Counters`
+  // on this host, e.g., because an event is unknown, the kernel lacks
+  // support or perf_event_paranoid(5) does not allow it.
+  static Try<Nothing> supported(
+      const std::set<std::string>& events,
+      const std::string& hierarchy);
+
+  ~Counters();
+
+  // Returns the counts since the counters were opened, scaled to
+  // account for multiplexing. The timestamp is the time the counters
+  // were opened and the duration is the time elapsed since then; see
+  // `perf::delta()` to obtain the counts of an interval.
+  Try<mesos::PerfStatistics> read() const;
+
+  // Returns the number of opened events, i.e., of file descriptors.
+  size_t size() const;
+
+private:
+  explicit Counters(
+      const std::vector<const google::protobuf::FieldDescriptor*>& fields);
+
+  Counters(const Counters&) = delete;
+  Counters& operator=(const Counters&) = delete;
+
+  const process::Time start;
+
+  // The `PerfStatistics` fields in the order of the events of a group.
+  const std::vector<const google::protobuf::FieldDescriptor*> fields;
+
+  // The group leaders, one per CPU.
+  std::vector<int> leaders;
+
+  // All the opened events, including the group leaders.
+  std::vector<int> fds;
+};
+
+
+// Returns the counts of the interval between two readings of the same
+// `Counters`.
+mesos::PerfStatistics delta(
+    const mesos::PerfStatistics& previous,
+    const mesos::PerfStatistics& current);
+
+
 // Validate a set of events are accepted by `perf stat`.
 bool valid(const std::set<std::string>& events);
 
@@ -271,21 +271,12 @@ inline Try<Nothing> attach(
 }
 
 
-// Generates the handle for the given filter on the link. Returns none
-// if we decide to let the kernel choose the handle.
-template <typename Classifier>
-Result<U32Handle> generateU32Handle(
+// Returns all the libnl filters (rtnl_cls) attached to the given
+// parent on the link.
+inline Try<std::vector<Netlink<struct rtnl_cls>>> getClses(
     const Netlink<struct rtnl_link>& link,
-    const Filter<Classifier>& filter)
+    const Handle& parent)
 {
-  // If the user does not specify a priority, we have no choice but
-  // let the kernel choose the handle because we do not know the
-  // 'htid' that is associated with that priority.
-  if (filter.priority.isNone()) {
-    return None();
-  }
-
-  // Scan all the filters attached to the given parent on the link.
   Try<Netlink<struct nl_sock>> socket = routing::socket();
   if (socket.isError()) {
     return Error(socket.error());
@@ -297,7 +288,7 @@ Result<U32Handle> generateU32Handle(
   int error = rtnl_cls_alloc_cache(
       socket->get(),
       rtnl_link_get_ifindex(link.get()),
-      filter.parent.get(),
+      parent.get(),
       &c);
 
   if (error != 0) {
@@ -308,22 +299,50 @@ Result<U32Handle> generateU32Handle(
 
   Netlink<struct nl_cache> cache(c);
 
+  std::vector<Netlink<struct rtnl_cls>> results;
+
+  for (struct nl_object* o = nl_cache_get_first(cache.get());
+       o != nullptr; o = nl_cache_get_next(o)) {
+    // NOTE: We increment the reference counter here because 'cache'
+    // will be freed when this function finishes and we want this
+    // object's life to be longer than this function.
+    nl_object_get(o);
+
+    results.push_back(Netlink<struct rtnl_cls>((struct rtnl_cls*) o));
+  }
+
+  return results;
+}
+
+
+// Generates the handle for the given filter given all the libnl
+// filters (rtnl_cls) currently attached to its parent. Returns none
+// if we decide to let the kernel choose the handle.
+template <typename Classifier>
+Result<U32Handle> generateU32Handle(
+    const std::vector<Netlink<struct rtnl_cls>>& clses,
+    const Filter<Classifier>& filter)
+{
+  // If the user does not specify a priority, we have no choice but
+  // let the kernel choose the handle because we do not know the
+  // 'htid' that is associated with that priority.
+  if (filter.priority.isNone()) {
+    return None();
+  }
+
   // A map from priority to the corresponding 'htid'.
   hashmap<uint16_t, uint32_t> htids;
 
   // A map from 'htid' to a set of already used nodes.
   hashmap<uint32_t, hashset<uint32_t>> nodes;
 
-  for (struct nl_object* o = nl_cache_get_first(cache.get());
-       o != nullptr; o = nl_cache_get_next(o)) {
-    struct rtnl_cls* cls = (struct rtnl_cls*) o;
-
+  foreach (const Netlink<struct rtnl_cls>& cls, clses) {
     // Only look at u32 filters. For other type of filters, their
     // handles are generated by the kernel correctly.
-    if (rtnl_tc_get_kind(TC_CAST(cls)) == std::string("u32")) {
-      U32Handle handle(rtnl_tc_get_handle(TC_CAST(cls)));
+    if (rtnl_tc_get_kind(TC_CAST(cls.get())) == std::string("u32")) {
+      U32Handle handle(rtnl_tc_get_handle(TC_CAST(cls.get())));
 
-      htids[rtnl_cls_get_prio(cls)] = handle.htid();
+      htids[rtnl_cls_get_prio(cls.get())] = handle.htid();
       nodes[handle.htid()].insert(handle.node());
     }
   }
@@ -350,13 +369,39 @@ Result<U32Handle> generateU32Handle(
 }
 
 
+// Generates the handle for the given filter on the link. Returns none
+// if we decide to let the kernel choose the handle.
+template <typename Classifier>
+Result<U32Handle> generateU32Handle(
+    const Netlink<struct rtnl_link>& link,
+    const Filter<Classifier>& filter)
+{
+  if (filter.priority.isNone()) {
+    return None();
+  }
+
+  // Scan all the filters attached to the given parent on the link.
+  Try<std::vector<Netlink<struct rtnl_cls>>> clses =
+    getClses(link, filter.parent);
+
+  if (clses.isError()) {
+    return Error(clses.error());
+  }
+
+  return generateU32Handle(clses.get(), filter);
+}
+
+
 // Encodes a filter (in our representation) to a libnl filter
-// (rtnl_cls). We use template here so that it works for any type of
-// classifier.
+// (rtnl_cls). If the libnl filters currently attached to the parent
+// are known (i.e., 'clses' is some), they are used to pick the handle
+// of a u32 filter instead of dumping them from the kernel. We use
+// template here so that it works for any type of classifier.
 template <typename Classifier>
 Try<Netlink<struct rtnl_cls>> encodeFilter(
     const Netlink<struct rtnl_link>& link,
-    const Filter<Classifier>& filter)
+    const Filter<Classifier>& filter,
+    const Option<std::vector<Netlink<struct rtnl_cls>>>& clses = None())
 {
   struct rtnl_cls* c = rtnl_cls_alloc();
   if (c == nullptr) {
@@ -400,7 +445,10 @@ Try<Netlink<struct rtnl_cls>> encodeFilter(
     // handle of the filter by picking an unused handle.
     // TODO(jieyu): Revisit this once the kernel bug is fixed.
     if (rtnl_tc_get_kind(TC_CAST(cls.get())) == std::string("u32")) {
-      Result<U32Handle> handle = generateU32Handle(link, filter);
+      Result<U32Handle> handle = clses.isSome()
+        ? generateU32Handle(clses.get(), filter)
+        : generateU32Handle(link, filter);
+
       if (handle.isError()) {
         return Error("Failed to find an unused u32 handle: " + handle.error());
       }
@@ -483,50 +531,6 @@ Result<Filter<Classifier>> decodeFilter(const Netlink<struct rtnl_cls>& cls)
 // Helpers for internal APIs.
 /////////////////////////////////////////////////
 
-// Returns all the libnl filters (rtnl_cls) attached to the given
-// parent on the link.
-inline Try<std::vector<Netlink<struct rtnl_cls>>> getClses(
-    const Netlink<struct rtnl_link>& link,
-    const Handle& parent)
-{
-  Try<Netlink<struct nl_sock>> socket = routing::socket();
-  if (socket.isError()) {
-    return Error(socket.error());
-  }
-
-  // Dump all the libnl filters (i.e., rtnl_cls) attached to the given
-  // parent on the link.
-  struct nl_cache* c = nullptr;
-  int error = rtnl_cls_alloc_cache(
-      socket->get(),
-      rtnl_link_get_ifindex(link.get()),
-      parent.get(),
-      &c);
-
-  if (error != 0) {
-    return Error(
-        "Failed to get filter info from kernel: " +
-        std::string(nl_geterror(error)));
-  }
-
-  Netlink<struct nl_cache> cache(c);
-
-  std::vector<Netlink<struct rtnl_cls>> results;
-
-  for (struct nl_object* o = nl_cache_get_first(cache.get());
-       o != nullptr; o = nl_cache_get_next(o)) {
-    // NOTE: We increment the reference counter here because 'cache'
-    // will be freed when this function finishes and we want this
-    // object's life to be longer than this function.
-    nl_object_get(o);
-
-    results.push_back(Netlink<struct rtnl_cls>((struct rtnl_cls*) o));
-  }
-
-  return results;
-}
-
-
 // Returns the libnl filter (rtnl_cls) attached to the given parent
 // that matches the specified classifier on the link. Returns None if
 // no match has been found. We use template here so that it works for
@@ -640,6 +644,157 @@ Try<bool> create(const std::string& _link, const Filter<Classifier>& filter)
 }
 
 
+// Creates a batch of new filters on the link. Compared to calling the
+// function above for each filter, the filters already attached to
+// each parent are dumped from the kernel once for the whole batch
+// (rather than twice per filter) and the new filters are sent to the
+// kernel in batched netlink transactions. Returns false, without
+// creating any filter, if a filter attached to the same parent with
+// the same classifier as one of the new filters already exists. If
+// the kernel rejects some of the filters, the ones before them will
+// have been created. We use template here so that it works for any
+// type of classifier.
+template <typename Classifier>
+Try<bool> create(
+    const std::string& _link,
+    const std::vector<Filter<Classifier>>& filters)
+{
+  if (filters.empty()) {
+    return true;
+  }
+
+  Result<Netlink<struct rtnl_link>> link = link::internal::get(_link);
+  if (link.isError()) {
+    return Error(link.error());
+  } else if (link.isNone()) {
+    return Error("Link '" + _link + "' is not found");
+  }
+
+  // The libnl filters attached to each parent (keyed by the parent
+  // handle), which we keep up to date with the filters of this batch
+  // so that we can pick unused u32 handles locally.
+  hashmap<uint32_t, std::vector<Netlink<struct rtnl_cls>>> clses;
+
+  // The classifiers of all the filters attached to each parent,
+  // including the ones of this batch.
+  hashmap<uint32_t, std::vector<Classifier>> classifiers;
+
+  foreach (const Filter<Classifier>& filter, filters) {
+    const uint32_t parent = filter.parent.get();
+
+    if (!clses.contains(parent)) {
+      Try<std::vector<Netlink<struct rtnl_cls>>> _clses =
+        getClses(link.get(), filter.parent);
+
+      if (_clses.isError()) {
+        return Error(_clses.error());
+      }
+
+      clses[parent] = _clses.get();
+      classifiers[parent] = std::vector<Classifier>();
+
+      foreach (const Netlink<struct rtnl_cls>& cls, _clses.get()) {
+        Result<Filter<Classifier>> existing = decodeFilter<Classifier>(cls);
+        if (existing.isError()) {
+          return Error("Failed to decode: " + existing.error());
+        } else if (existing.isSome()) {
+          classifiers[parent].push_back(existing->classifier);
+        }
+      }
+    }
+
+    // TODO(jieyu): Similar to above, the existence check and the
+    // following add operation are not atomic.
+    foreach (const Classifier& classifier, classifiers[parent]) {
+      if (classifier == filter.classifier) {
+        return false;
+      }
+    }
+
+    classifiers[parent].push_back(filter.classifier);
+  }
+
+  Try<Netlink<struct nl_sock>> socket = routing::socket();
+  if (socket.isError()) {
+    return Error(socket.error());
+  }
+
+  std::vector<Netlink<struct nl_msg>> requests;
+
+  // Sends the pending requests to the kernel.
+  auto flush = [&]() -> Try<bool> {
+    Try<std::vector<int>> results = transact(socket.get(), requests);
+    requests.clear();
+
+    if (results.isError()) {
+      return Error(results.error());
+    }
+
+    foreach (int error, results.get()) {
+      if (error == -NLE_EXIST) {
+        return false;
+      } else if (error != 0) {
+        return Error(std::string(nl_geterror(error)));
+      }
+    }
+
+    return true;
+  };
+
+  foreach (const Filter<Classifier>& filter, filters) {
+    const uint32_t parent = filter.parent.get();
+
+    Try<Netlink<struct rtnl_cls>> cls =
+      encodeFilter(link.get(), filter, clses[parent]);
+
+    if (cls.isError()) {
+      return Error("Failed to encode the filter: " + cls.error());
+    }
+
+    struct nl_msg* msg = nullptr;
+    int error = rtnl_cls_build_add_request(
+        cls->get(),
+        NLM_F_CREATE | NLM_F_EXCL,
+        &msg);
+
+    if (error != 0) {
+      return Error(
+          "Failed to build the netlink request: " +
+          std::string(nl_geterror(error)));
+    }
+
+    requests.push_back(Netlink<struct nl_msg>(msg));
+
+    if (filter.handle.isNone() &&
+        rtnl_tc_get_kind(TC_CAST(cls->get())) == std::string("u32") &&
+        rtnl_tc_get_handle(TC_CAST(cls->get())) == 0) {
+      // This is the first u32 filter with its priority, so the kernel
+      // chooses its handle (see 'generateU32Handle'). We need to know
+      // that handle before we can pick the handles of the following
+      // filters with the same priority, so we send the pending
+      // requests and dump the filters of the parent again.
+      Try<bool> flushed = flush();
+      if (flushed.isError() || !flushed.get()) {
+        return flushed;
+      }
+
+      Try<std::vector<Netlink<struct rtnl_cls>>> _clses =
+        getClses(link.get(), filter.parent);
+
+      if (_clses.isError()) {
+        return Error(_clses.error());
+      }
+
+      clses[parent] = _clses.get();
+    } else {
+      clses[parent].push_back(cls.get());
+    }
+  }
+
+  return flush();
+}
+
+
 // Removes the filter attached to the given parent that matches the
 // specified classifier from the link. Returns false if such a filter
 // is not found. We use template here so that it works for any type of
@@ -682,6 +837,97 @@ Try<bool> remove(
 }
 
 
+// Removes the filters attached to the given parent that match any of
+// the specified classifiers from the link. The filters on the link are
+// dumped from the kernel once and the removals are sent to the kernel
+// in batched netlink transactions. Returns the number of filters that
+// were removed; classifiers without a matching filter are skipped. We
+// use template here so that it works for any type of classifier.
+template <typename Classifier>
+Try<size_t> remove(
+    const std::string& _link,
+    const Handle& parent,
+    const std::vector<Classifier>& classifiers)
+{
+  if (classifiers.empty()) {
+    return 0;
+  }
+
+  Result<Netlink<struct rtnl_link>> link = link::internal::get(_link);
+  if (link.isError()) {
+    return Error(link.error());
+  } else if (link.isNone()) {
+    return 0;
+  }
+
+  Try<std::vector<Netlink<struct rtnl_cls>>> clses =
+    getClses(link.get(), parent);
+
+  if (clses.isError()) {
+    return Error(clses.error());
+  }
+
+  std::vector<Netlink<struct nl_msg>> requests;
+
+  foreach (const Netlink<struct rtnl_cls>& cls, clses.get()) {
+    Result<Filter<Classifier>> filter = decodeFilter<Classifier>(cls);
+    if (filter.isError()) {
+      return Error("Failed to decode: " + filter.error());
+    } else if (filter.isNone()) {
+      continue;
+    }
+
+    bool matched = false;
+    foreach (const Classifier& classifier, classifiers) {
+      if (filter->classifier == classifier) {
+        matched = true;
+        break;
+      }
+    }
+
+    if (!matched) {
+      continue;
+    }
+
+    struct nl_msg* msg = nullptr;
+    int error = rtnl_cls_build_delete_request(cls.get(), 0, &msg);
+    if (error != 0) {
+      return Error(
+          "Failed to build the netlink request: " +
+          std::string(nl_geterror(error)));
+    }
+
+    requests.push_back(Netlink<struct nl_msg>(msg));
+  }
+
+  if (requests.empty()) {
+    return 0;
+  }
+
+  Try<Netlink<struct nl_sock>> socket = routing::socket();
+  if (socket.isError()) {
+    return Error(socket.error());
+  }
+
+  Try<std::vector<int>> results = transact(socket.get(), requests);
+  if (results.isError()) {
+    return Error(results.error());
+  }
+
+  size_t removed = 0;
+
+  foreach (int error, results.get()) {
+    if (error == 0) {
+      removed++;
+    } else if (error != -NLE_OBJ_NOTFOUND) {
+      return Error(std::string(nl_geterror(error)));
+    }
+  }
+
+  return removed;
+}
+
+
 // Updates the action of the filter attached to the given parent that
 // matches the specified classifier on the link. Returns false if such
 // a filter is not found. We use template here so that it works for
@@ -174,6 +174,16 @@ Try<bool> create(
     const Option<Handle>& classid);
 
 
+// Creates a batch of IP packet filters on the link using batched
+// netlink transactions, which is much cheaper than creating them one
+// by one. Returns false, without creating any filter, if an IP packet
+// filter attached to the same parent with the same classifier as one
+// of the filters already exists.
+Try<bool> create(
+    const std::string& link,
+    const std::vector<Filter<Classifier>>& filters);
+
+
 // Removes the IP packet filter attached to the given parent that
 // matches the specified classifier from the link. Returns false if
 // such a filter is not found.
@@ -183,6 +193,15 @@ Try<bool> remove(
     const Classifier& classifier);
 
 
+// Removes the IP packet filters attached to the given parent that
+// match any of the specified classifiers from the link using batched
+// netlink transactions. Returns the number of filters removed.
+Try<size_t> remove(
+    const std::string& link,
+    const Handle& parent,
+    const std::vector<Classifier>& classifiers);
+
+
 // Returns all the IP packet filters attached to the given parent on
 // the link. Returns none if the link or the parent is not found.
 Result<std::vector<Filter<Classifier>>> filters(
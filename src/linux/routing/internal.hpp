@@ -19,11 +19,13 @@
 
 #include <netlink/cache.h>
 #include <netlink/errno.h>
+#include <netlink/msg.h>
 #include <netlink/netlink.h>
 #include <netlink/socket.h>
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <stout/error.hpp>
 #include <stout/try.hpp>
@@ -49,6 +51,13 @@ inline void cleanup(struct nl_sock* sock)
 }
 
 
+template <>
+inline void cleanup(struct nl_msg* msg)
+{
+  nlmsg_free(msg);
+}
+
+
 // A helper class for managing netlink objects (e.g., rtnl_link,
 // nl_sock, etc.). It manages the life cycle of a netlink object. It
 // is copyable and assignable, and multiple copies share the same
@@ -107,6 +116,74 @@ inline Try<Netlink<struct nl_sock>> socket(int protocol = NETLINK_ROUTE)
   return sock;
 }
 
+
+// Sends the given netlink requests (e.g., built by one of the libnl
+// 'rtnl_*_build_*_request' functions) to the kernel and waits for
+// their acknowledgements. Unlike the libnl helpers which send a
+// request and wait for its acknowledgement one at a time (e.g.,
+// 'rtnl_cls_add'), the requests are packed into as few sendmsg calls
+// as possible, so the cost of a round-trip is paid once per batch
+// rather than once per request. The kernel still handles each request
+// independently, i.e., a failed request does not prevent the ones
+// after it from being applied. Returns the libnl error code (0 on
+// success) of each request, in the same order as 'requests'.
+inline Try<std::vector<int>> transact(
+    const Netlink<struct nl_sock>& sock,
+    const std::vector<Netlink<struct nl_msg>>& requests)
+{
+  // We bound the number of requests in a batch so that all of their
+  // acknowledgements fit into the receive buffer of the socket at the
+  // same time, otherwise the kernel drops them. Note that the kernel
+  // charges each acknowledgement for the whole socket buffer it lives
+  // in (which is much larger than the message itself), and that the
+  // acknowledgement of a failed request carries a copy of the request.
+  const size_t MAX_BATCH_REQUESTS = 32;
+  const size_t MAX_BATCH_SIZE = 16 * 1024;
+
+  std::vector<int> results;
+  results.reserve(requests.size());
+
+  size_t next = 0;
+  while (next < requests.size()) {
+    std::string batch;
+    size_t count = 0;
+
+    for (; next < requests.size(); next++) {
+      struct nl_msg* msg = requests[next].get();
+      const size_t length = nlmsg_hdr(msg)->nlmsg_len;
+
+      if (count == MAX_BATCH_REQUESTS ||
+          (count > 0 &&
+           NLMSG_ALIGN(batch.size() + length) > MAX_BATCH_SIZE)) {
+        break;
+      }
+
+      // Fill in the sequence number and the port, and ask the kernel
+      // to acknowledge the request.
+      nl_complete_msg(sock.get(), msg);
+
+      batch.append((const char*) nlmsg_hdr(msg), length);
+      batch.resize(NLMSG_ALIGN(batch.size()), '\0');
+      count++;
+    }
+
+    int error = nl_sendto(sock.get(), &batch[0], batch.size());
+    if (error < 0) {
+      return Error(
+          "Failed to send netlink requests: " +
+          std::string(nl_geterror(error)));
+    }
+
+    // NOTE: The kernel acknowledges each request in a separate
+    // message, in the order of the requests.
+    for (size_t i = 0; i < count; i++) {
+      results.push_back(nl_wait_for_ack(sock.get()));
+    }
+  }
+
+  return results;
+}
+
 } // namespace routing {
 
 #endif // __LINUX_ROUTING_INTERNAL_HPP__
@@ -120,6 +120,22 @@ constexpr Duration WHITELIST_WATCH_INTERVAL = Seconds(5);
 // Default number of tasks (limit) for /master/tasks endpoint.
 constexpr size_t TASK_LIMIT = 100;
 
+// Approximate size of the chunks in which the body of streamed
+// responses (e.g. /master/state) is produced, one chunk per turn of
+// the master actor.
+constexpr Bytes STREAM_CHUNK_SIZE = Kilobytes(64);
+
+// Number of tasks of a page of a streamed `GET_TASKS` response that are
+// selected per scan over the tasks of the master. Each scan only holds
+// on to this many tasks, and they are written in the same turn.
+constexpr size_t STREAM_TASKS_PER_SCAN = 100;
+
+// Maximum time to wait for a client to be ready for the next chunk of
+// a streamed response before failing the response. This bounds how
+// long a client which stops reading holds up the other clients which
+// share the response.
+constexpr Duration STREAM_CHUNK_TIMEOUT = Seconds(5);
+
 constexpr Duration DEFAULT_REGISTRY_GC_INTERVAL = Minutes(15);
 
 constexpr Duration DEFAULT_REGISTRY_MAX_AGENT_AGE = Weeks(2);
@@ -722,6 +722,29 @@ mesos::internal::master::Flags::Flags()
       "frameworks.",
       true);
 
+  add(&Flags::metrics_cache_interval,
+      "metrics_cache_interval",
+      "If set, the metrics computed by the master actor (e.g.,\n"
+      "`master/tasks_running`) are served from a cache, so that\n"
+      "`/metrics/snapshot` does not have to wait for a busy master.\n"
+      "Once a cached value is older than this interval, the next snapshot\n"
+      "refreshes it in the background, which means the values can be\n"
+      "stale by this interval plus the time the master takes to process\n"
+      "the refresh.");
+
+  add(&Flags::stream_state_responses,
+      "stream_state_responses",
+      "If true, large responses of the read-only endpoints (`/state`,\n"
+      "`/frameworks`, `/tasks`) and of the `GET_STATE`, `GET_FRAMEWORKS`\n"
+      "and `GET_TASKS` operator calls are streamed in chunks, each of\n"
+      "which is produced in a separate turn of the master actor. This\n"
+      "bounds the time the master is blocked and the memory held per\n"
+      "response, but the response is no longer a consistent snapshot:\n"
+      "e.g., a framework that completes while its response is streamed\n"
+      "may be listed both as active and as completed, or not at all.\n"
+      "If false, the whole response is produced in one master turn.",
+      false);
+
   add(&Flags::domain,
       "domain",
       "Domain that the master belongs to. Mesos currently only supports\n"
@@ -103,6 +103,8 @@ public:
   size_t registry_max_agent_count;
   bool require_agent_domain;
   bool publish_per_framework_metrics;
+  Option<Duration> metrics_cache_interval;
+  bool stream_state_responses;
   Option<DomainInfo> domain;
 
   // The following flags are executable specific (e.g., since we only
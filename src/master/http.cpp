@@ -25,6 +25,7 @@
 #include <utility>
 #include <vector>
 
+#include <google/protobuf/arena.h>
 #include <google/protobuf/descriptor.h>
 #include <google/protobuf/wire_format_lite.h>
 
@@ -48,6 +49,7 @@
 #include <process/future.hpp>
 #include <process/help.hpp>
 #include <process/logging.hpp>
+#include <process/loop.hpp>
 
 #include <process/metrics/metrics.hpp>
 
@@ -101,7 +103,10 @@ using google::protobuf::internal::WireFormatLite;
 
 using process::AUTHENTICATION;
 using process::AUTHORIZATION;
+using process::Break;
 using process::Clock;
+using process::Continue;
+using process::ControlFlow;
 using process::DESCRIPTION;
 using process::Failure;
 using process::Future;
@@ -231,7 +236,12 @@ Future<Response> Master::Http::api(
     return MethodNotAllowed({"POST"}, request.method);
   }
 
-  v1::master::Call v1Call;
+  // The v1 call is only needed until it has been devolved, so we parse it
+  // on an arena which releases all of its memory at once when the handler
+  // returns, instead of freeing every field individually.
+  google::protobuf::Arena arena;
+  v1::master::Call* v1Call =
+    google::protobuf::Arena::CreateMessage<v1::master::Call>(&arena);
 
   // TODO(anand): Content type values are case-insensitive.
   Option<string> contentType = request.headers.get("Content-Type");
@@ -241,32 +251,27 @@ Future<Response> Master::Http::api(
   }
 
   if (contentType.get() == APPLICATION_PROTOBUF) {
-    if (!v1Call.ParseFromString(request.body)) {
+    if (!v1Call->ParseFromString(request.body)) {
       return BadRequest("Failed to parse body into Call protobuf");
     }
   } else if (contentType.get() == APPLICATION_JSON) {
-    Try<JSON::Value> value = JSON::parse(request.body);
+    Try<Try<Nothing>> parse = ::protobuf::parseJSON(request.body, v1Call);
 
-    if (value.isError()) {
-      return BadRequest("Failed to parse body into JSON: " + value.error());
+    if (parse.isError()) {
+      return BadRequest("Failed to parse body into JSON: " + parse.error());
     }
 
-    Try<v1::master::Call> parse =
-      ::protobuf::parse<v1::master::Call>(value.get());
-
-    if (parse.isError()) {
+    if (parse->isError()) {
       return BadRequest("Failed to convert JSON into Call protobuf: " +
-                        parse.error());
+                        parse->error());
     }
-
-    v1Call = parse.get();
   } else {
     return UnsupportedMediaType(
         string("Expecting 'Content-Type' of ") +
         APPLICATION_JSON + " or " + APPLICATION_PROTOBUF);
   }
 
-  mesos::master::Call call = devolve(v1Call);
+  mesos::master::Call call = devolve(*v1Call);
 
   Option<Error> error = validation::master::call::validate(call);
 
@@ -500,7 +505,11 @@ Future<Response> Master::Http::scheduler(
     return MethodNotAllowed({"POST"}, request.method);
   }
 
-  v1::scheduler::Call v1Call;
+  // Parsed on an arena for the same reason as in `api()`; scheduler calls
+  // such as ACCEPT can carry large numbers of operations and task infos.
+  google::protobuf::Arena arena;
+  v1::scheduler::Call* v1Call =
+    google::protobuf::Arena::CreateMessage<v1::scheduler::Call>(&arena);
 
   // TODO(anand): Content type values are case-insensitive.
   Option<string> contentType = request.headers.get("Content-Type");
@@ -510,32 +519,27 @@ Future<Response> Master::Http::scheduler(
   }
 
   if (contentType.get() == APPLICATION_PROTOBUF) {
-    if (!v1Call.ParseFromString(request.body)) {
+    if (!v1Call->ParseFromString(request.body)) {
       return BadRequest("Failed to parse body into Call protobuf");
     }
   } else if (contentType.get() == APPLICATION_JSON) {
-    Try<JSON::Value> value = JSON::parse(request.body);
+    Try<Try<Nothing>> parse = ::protobuf::parseJSON(request.body, v1Call);
 
-    if (value.isError()) {
-      return BadRequest("Failed to parse body into JSON: " + value.error());
+    if (parse.isError()) {
+      return BadRequest("Failed to parse body into JSON: " + parse.error());
     }
 
-    Try<v1::scheduler::Call> parse =
-      ::protobuf::parse<v1::scheduler::Call>(value.get());
-
-    if (parse.isError()) {
+    if (parse->isError()) {
       return BadRequest("Failed to convert JSON into Call protobuf: " +
-                        parse.error());
+                        parse->error());
     }
-
-    v1Call = parse.get();
   } else {
     return UnsupportedMediaType(
         string("Expecting 'Content-Type' of ") +
         APPLICATION_JSON + " or " + APPLICATION_PROTOBUF);
   }
 
-  scheduler::Call call = devolve(v1Call);
+  scheduler::Call call = devolve(*v1Call);
 
   Option<Error> error = validation::scheduler::call::validate(call, principal);
 
@@ -551,7 +555,8 @@ Future<Response> Master::Http::scheduler(
   // However, to maintain backwards compatibility, it determines the accept
   // type only if the response will not be empty.
   if (call.type() == scheduler::Call::SUBSCRIBE ||
-      call.type() == scheduler::Call::RECONCILE_OPERATIONS) {
+      call.type() == scheduler::Call::RECONCILE_OPERATIONS ||
+      call.type() == scheduler::Call::BATCH) {
     if (request.acceptsMediaType(APPLICATION_JSON)) {
       acceptType = ContentType::JSON;
     } else if (request.acceptsMediaType(APPLICATION_PROTOBUF)) {
@@ -723,6 +728,16 @@ Future<Response> Master::Http::scheduler(
       return master->updateFramework(
           std::move(*call.mutable_update_framework()));
 
+    case scheduler::Call::BATCH: {
+      scheduler::Response response;
+      response.set_type(scheduler::Response::BATCH);
+      *response.mutable_batch() =
+        master->batch(framework, std::move(*call.mutable_batch()));
+
+      return OK(serialize(acceptType, evolve(response)),
+                stringify(acceptType));
+    }
+
     case scheduler::Call::UNKNOWN:
       LOG(WARNING) << "Received 'UNKNOWN' call";
       return NotImplemented();
@@ -1256,52 +1271,79 @@ Future<Response> Master::Http::frameworks(
 
 
 mesos::master::Response::GetFrameworks::Framework model(
-    const Framework& framework)
+    const Framework& framework,
+    const Option<hashset<int>>& fields)
 {
-  mesos::master::Response::GetFrameworks::Framework _framework;
+  typedef mesos::master::Response::GetFrameworks::Framework Model;
 
-  _framework.mutable_framework_info()->CopyFrom(framework.info);
+  auto selected = [&fields](int field) {
+    return fields.isNone() || fields->contains(field);
+  };
 
-  _framework.set_active(framework.active());
-  _framework.set_connected(framework.connected());
-  _framework.set_recovered(framework.recovered());
+  Model _framework;
+
+  if (selected(Model::kFrameworkInfoFieldNumber)) {
+    _framework.mutable_framework_info()->CopyFrom(framework.info);
+  }
+
+  if (selected(Model::kActiveFieldNumber)) {
+    _framework.set_active(framework.active());
+  }
+
+  if (selected(Model::kConnectedFieldNumber)) {
+    _framework.set_connected(framework.connected());
+  }
+
+  if (selected(Model::kRecoveredFieldNumber)) {
+    _framework.set_recovered(framework.recovered());
+  }
 
   int64_t time = framework.registeredTime.duration().ns();
-  if (time != 0) {
+  if (time != 0 && selected(Model::kRegisteredTimeFieldNumber)) {
     _framework.mutable_registered_time()->set_nanoseconds(time);
   }
 
   time = framework.unregisteredTime.duration().ns();
-  if (time != 0) {
+  if (time != 0 && selected(Model::kUnregisteredTimeFieldNumber)) {
     _framework.mutable_unregistered_time()->set_nanoseconds(time);
   }
 
   time = framework.reregisteredTime.duration().ns();
-  if (time != 0) {
+  if (time != 0 && selected(Model::kReregisteredTimeFieldNumber)) {
     _framework.mutable_reregistered_time()->set_nanoseconds(time);
   }
 
-  foreach (const Offer* offer, framework.offers) {
-    _framework.mutable_offers()->Add()->CopyFrom(*offer);
+  if (selected(Model::kOffersFieldNumber)) {
+    foreach (const Offer* offer, framework.offers) {
+      _framework.mutable_offers()->Add()->CopyFrom(*offer);
+    }
   }
 
-  foreach (const InverseOffer* offer, framework.inverseOffers) {
-    _framework.mutable_inverse_offers()->Add()->CopyFrom(*offer);
+  if (selected(Model::kInverseOffersFieldNumber)) {
+    foreach (const InverseOffer* offer, framework.inverseOffers) {
+      _framework.mutable_inverse_offers()->Add()->CopyFrom(*offer);
+    }
   }
 
-  foreach (Resource resource, framework.totalUsedResources) {
-    convertResourceFormat(&resource, ENDPOINT);
+  if (selected(Model::kAllocatedResourcesFieldNumber)) {
+    foreach (Resource resource, framework.totalUsedResources) {
+      convertResourceFormat(&resource, ENDPOINT);
 
-    _framework.mutable_allocated_resources()->Add()->CopyFrom(resource);
+      _framework.mutable_allocated_resources()->Add()->CopyFrom(resource);
+    }
   }
 
-  foreach (Resource resource, framework.totalOfferedResources) {
-    convertResourceFormat(&resource, ENDPOINT);
+  if (selected(Model::kOfferedResourcesFieldNumber)) {
+    foreach (Resource resource, framework.totalOfferedResources) {
+      convertResourceFormat(&resource, ENDPOINT);
 
-    _framework.mutable_offered_resources()->Add()->CopyFrom(resource);
+      _framework.mutable_offered_resources()->Add()->CopyFrom(resource);
+    }
   }
 
-  *_framework.mutable_offer_constraints() = framework.offerConstraints();
+  if (selected(Model::kOfferConstraintsFieldNumber)) {
+    *_framework.mutable_offer_constraints() = framework.offerConstraints();
+  }
 
   return _framework;
 }
@@ -1314,19 +1356,25 @@ Future<Response> Master::Http::getFrameworks(
 {
   CHECK_EQ(mesos::master::Call::GET_FRAMEWORKS, call.type());
 
+  // See `getTasks()` for why the parameters are passed this way.
+  hashmap<string, string> parameters;
+  if (call.has_get_frameworks()) {
+    parameters["get_frameworks"] = call.get_frameworks().SerializeAsString();
+  }
+
   return ObjectApprovers::create(
       master->authorizer,
       principal,
       {VIEW_FRAMEWORK})
     .then(defer(
           master->self(),
-          [this, principal, outputContentType](
+          [this, principal, outputContentType, parameters](
               const Owned<ObjectApprovers>& approvers) {
             return deferBatchedRequest(
                 &Master::ReadOnlyHandler::getFrameworks,
                 principal,
                 outputContentType,
-                {},
+                parameters,
                 approvers);
           }));
 }
@@ -1364,19 +1412,25 @@ Future<Response> Master::Http::getState(
 {
   CHECK_EQ(mesos::master::Call::GET_STATE, call.type());
 
+  // See `getTasks()` for why the parameters are passed this way.
+  hashmap<string, string> parameters;
+  if (call.has_get_state()) {
+    parameters["get_state"] = call.get_state().SerializeAsString();
+  }
+
   return ObjectApprovers::create(
       master->authorizer,
       principal,
       {VIEW_FRAMEWORK, VIEW_TASK, VIEW_EXECUTOR, VIEW_ROLE})
     .then(defer(
           master->self(),
-          [this, principal, outputContentType](
+          [this, principal, outputContentType, parameters](
               const Owned<ObjectApprovers>& approvers) {
             return deferBatchedRequest(
                 &Master::ReadOnlyHandler::getState,
                 principal,
                 outputContentType,
-                {},
+                parameters,
                 approvers);
           }));
 }
@@ -2353,35 +2407,33 @@ Future<Response> Master::Http::deferBatchedRequest(
                queryParameters == batchedRequest.queryParameters;
       });
 
-  Future<Response> future;
+  Promise<Response> promise;
+  Future<Response> future = promise.future();
 
   // Note that we do not de-duplicate the SUBSCRIBE responses,
   // since the http server in libprocess assumes there's only
   // 1 reader of the pipe.
+  //
+  // Streamed responses on the other hand are de-duplicated: each
+  // request gets its own pipe and the chunks are written to all of
+  // them, see `processRequestsBatch()`.
   if (handler == &Master::ReadOnlyHandler::subscribe ||
       it == batchedRequests.end()) {
     // Add an element to the batched state requests.
-    Promise<Response> promise;
-    future = promise.future();
+    vector<Promise<Response>> promises;
+    promises.push_back(std::move(promise));
+
     batchedRequests.push_back(BatchedRequest{
         handler,
         outputContentType,
         queryParameters,
         principal,
         approvers,
-        std::move(promise)});
+        std::move(promises)});
   } else {
-    // Return the existing future if we have a matching request.
-    future = it->promise.future();
+    // Share the response of the matching request.
+    it->promises.push_back(std::move(promise));
     ++master->metrics->http_cache_hits;
-
-    // NOTE: The returned response should be either of type
-    // `BODY` or `PATH`, since `PIPE`-type responses cannot
-    // be de-duplicated currently.
-    it->promise.future()
-      .onReady([](const Response& r) {
-        CHECK_NE(r.type, Response::PIPE);
-      });
   }
 
   // Schedule processing of batched requests if not yet scheduled.
@@ -2395,6 +2447,91 @@ Future<Response> Master::Http::deferBatchedRequest(
 }
 
 
+// Writes the body produced by `stream` into the `writers` of the
+// responses to a batch of identical requests, starting with the
+// already produced `chunk`.
+//
+// The remaining chunks are produced on the master actor (`pid`), one
+// chunk per turn, and only once all of the readers wait for more data
+// (see `Pipe::Writer::drained()`). Hence only a single chunk of the
+// body is held in memory and the master actor is not blocked while the
+// body is written. Readers which are not ready within
+// `STREAM_CHUNK_TIMEOUT` are failed, so that a client which stops
+// reading does not hold up the others.
+static void writeStream(
+    const process::UPID& pid,
+    const vector<Pipe::Writer>& writers,
+    const Master::ReadOnlyHandler::PostProcessing::Stream& stream,
+    const string& chunk)
+{
+  // The writers whose readers are still reading.
+  std::shared_ptr<vector<Pipe::Writer>> open(
+      new vector<Pipe::Writer>(writers));
+
+  auto write = [open](const string& chunk) {
+    vector<Pipe::Writer> writers;
+
+    foreach (Pipe::Writer writer, *open) {
+      // The reader is gone if the pipe was closed in the meantime.
+      if (writer.write(chunk)) {
+        writers.push_back(writer);
+      }
+    }
+
+    *open = std::move(writers);
+  };
+
+  write(chunk);
+
+  process::loop(
+      pid,
+      [open]() {
+        vector<Future<Nothing>> drained;
+
+        foreach (Pipe::Writer writer, *open) {
+          drained.push_back(writer.drained()
+            .after(
+                STREAM_CHUNK_TIMEOUT,
+                [writer](Future<Nothing> drained) mutable -> Future<Nothing> {
+                  drained.discard();
+
+                  // The next write to this writer fails, so it is dropped.
+                  writer.fail(
+                      "Failed to stream the response: the client did not"
+                      " read it within " + stringify(STREAM_CHUNK_TIMEOUT));
+
+                  return Nothing();
+                }));
+        }
+
+        return process::collect(drained);
+      },
+      [open, stream, write](const vector<Nothing>&) -> ControlFlow<Nothing> {
+        Option<string> chunk = open->empty() ? None() : stream.next();
+
+        if (chunk.isNone()) {
+          foreach (Pipe::Writer writer, *open) {
+            writer.close();
+          }
+
+          return Break();
+        }
+
+        write(chunk.get());
+
+        return Continue();
+      })
+    .onAny([open](const Future<Nothing>& future) {
+      // Fail the remaining writers if the master terminated meanwhile.
+      if (!future.isReady()) {
+        foreach (Pipe::Writer writer, *open) {
+          writer.fail("Failed to stream the response: the master terminated");
+        }
+      }
+    });
+}
+
+
 void Master::Http::processRequestsBatch() const
 {
   CHECK(!batchedRequests.empty())
@@ -2405,34 +2542,84 @@ void Master::Http::processRequestsBatch() const
 
   // Produce the responses in parallel.
   //
+  // NOTE: The workers set the promises themselves rather than having
+  // them associated with their results, since the bodies of streamed
+  // responses are written after the responses have been handed out.
+  // Referring to the batched requests from the workers is safe because
+  // they are not modified until all of them have completed.
+  //
   // TODO(alexr): Consider abstracting this into `parallel_async` or
   // `foreach_parallel`, see MESOS-8587.
-  //
-  // TODO(alexr): Consider moving `BatchedStateRequest`'s fields into
-  // `process::async` once it supports moving.
-  foreach (BatchedRequest& request, batchedRequests) {
+  for (size_t i = 0; i < batchedRequests.size(); ++i) {
+    BatchedRequest& request = batchedRequests[i];
+
     Future<pair<Response, Option<ReadOnlyHandler::PostProcessing>>>
-      f = process::async(
-          [this](ReadOnlyRequestHandler handler,
-                 ContentType outputContentType,
-                 const hashmap<std::string, std::string>& queryParameters,
-                 const process::Owned<ObjectApprovers>& approvers) {
-            return (readonlyHandler.*handler)(
-                outputContentType,
-                queryParameters,
-                approvers);
-          },
-          request.handler,
-          request.outputContentType,
-          request.queryParameters,
-          request.approvers);
-
-    request.promise.associate(
-      f.then([](const pair<
-          Response,
-          Option<ReadOnlyHandler::PostProcessing>>& result) {
-        return result.first;
-      }));
+      f = process::async([this, &request]() {
+        pair<Response, Option<ReadOnlyHandler::PostProcessing>> result =
+          (readonlyHandler.*request.handler)(
+              request.outputContentType,
+              request.queryParameters,
+              request.approvers);
+
+        Option<ReadOnlyHandler::PostProcessing::Stream> stream;
+        if (result.second.isSome()) {
+          result.second->state.visit(
+              [](const ReadOnlyHandler::PostProcessing::Subscribe&) {},
+              [&stream](const ReadOnlyHandler::PostProcessing::Stream& s) {
+                stream = s;
+              });
+        }
+
+        // Unless streaming is enabled, produce the whole body while the
+        // master actor is blocked, so that it is a consistent snapshot
+        // of the master state.
+        if (stream.isSome() && !master->flags.stream_state_responses) {
+          Response& response = result.first;
+          response.type = Response::BODY;
+
+          Option<string> chunk;
+          while ((chunk = stream->next()).isSome()) {
+            response.body += chunk.get();
+          }
+
+          response.headers["Content-Length"] = stringify(response.body.size());
+
+          stream = None();
+        }
+
+        if (stream.isNone()) {
+          foreach (Promise<Response>& promise, request.promises) {
+            promise.set(result.first);
+          }
+
+          return result;
+        }
+
+        // Produce the first chunk of the body while the master actor is
+        // blocked, the remaining chunks are produced by the master actor
+        // once the clients are ready for them.
+        vector<Pipe::Writer> writers;
+
+        foreach (Promise<Response>& promise, request.promises) {
+          Pipe pipe;
+
+          Response response = result.first;
+          response.type = Response::PIPE;
+          response.reader = pipe.reader();
+
+          promise.set(response);
+
+          writers.push_back(pipe.writer());
+        }
+
+        writeStream(
+            master->self(),
+            writers,
+            stream.get(),
+            stream->next().getOrElse(""));
+
+        return result;
+      });
 
     results.push_back(f);
   }
@@ -2445,6 +2632,15 @@ void Master::Http::processRequestsBatch() const
   // thread here, see MESOS-8256.
   process::await(results).await();
 
+  for (size_t i = 0; i < results.size(); ++i) {
+    if (!results[i].isReady()) {
+      foreach (Promise<Response>& promise, batchedRequests[i].promises) {
+        promise.fail(
+            results[i].isFailed() ? results[i].failure() : "discarded");
+      }
+    }
+  }
+
   batchedRequests.clear();
 
   // Now perform the post-processing "writes" synchronously.
@@ -2462,6 +2658,9 @@ void Master::Http::processRequestsBatch() const
     postProcessing.state.visit(
         [&](const ReadOnlyHandler::PostProcessing::Subscribe& s) {
           master->subscribe(s.connection, s.approvers);
+        },
+        [](const ReadOnlyHandler::PostProcessing::Stream&) {
+          // The body is produced or written by the workers.
         });
   }
 }
@@ -2949,19 +3148,27 @@ Future<Response> Master::Http::getTasks(
 {
   CHECK_EQ(mesos::master::Call::GET_TASKS, call.type());
 
+  // The parameters of the call are passed to the handler as a query
+  // parameter, since batched requests are de-duplicated based on
+  // their query parameters.
+  hashmap<string, string> parameters;
+  if (call.has_get_tasks()) {
+    parameters["get_tasks"] = call.get_tasks().SerializeAsString();
+  }
+
   return ObjectApprovers::create(
       master->authorizer,
       principal,
       {VIEW_FRAMEWORK, VIEW_TASK})
     .then(defer(
           master->self(),
-          [this, principal, outputContentType](
+          [this, principal, outputContentType, parameters](
              const Owned<ObjectApprovers>& approvers) {
             return deferBatchedRequest(
                 &Master::ReadOnlyHandler::getTasks,
                 principal,
                 outputContentType,
-                {},
+                parameters,
                 approvers);
           }));
 }
@@ -2488,6 +2488,10 @@ void Master::receive(
       updateFramework(from, std::move(*call.mutable_update_framework()));
       break;
 
+    case scheduler::Call::BATCH:
+      drop(from, call, "'BATCH' is not supported by the v0 API");
+      break;
+
     case scheduler::Call::UNKNOWN:
       LOG(WARNING) << "'UNKNOWN' call";
       break;
@@ -3943,6 +3947,36 @@ void Master::accept(
     error = validation::offer::validate(accept.offer_ids(), this, framework);
   }
 
+  // Frameworks with the OFFER_DELTAS capability may specify the offer
+  // versions the operations were computed against, in which case we
+  // reject the call if any of the offers has changed since.
+  if (error.isNone() && !accept.offer_versions().empty()) {
+    if (accept.offer_versions().size() != accept.offer_ids().size()) {
+      error = Error(
+          "Expecting " + stringify(accept.offer_ids().size()) +
+          " offer versions but got " +
+          stringify(accept.offer_versions().size()));
+    } else {
+      for (int i = 0; i < accept.offer_ids().size(); ++i) {
+        const Offer* offer = CHECK_NOTNULL(getOffer(accept.offer_ids(i)));
+
+        if (!offer->has_version()) {
+          error = Error(
+              "Offer " + stringify(offer->id()) + " is not versioned");
+          break;
+        }
+
+        if (offer->version() != accept.offer_versions(i)) {
+          error = Error(
+              "Offer " + stringify(offer->id()) + " is at version " +
+              stringify(offer->version()) + " but version " +
+              stringify(accept.offer_versions(i)) + " was used");
+          break;
+        }
+      }
+    }
+  }
+
   if (error.isSome()) {
     // TODO(jieyu): Consider adding a 'drop' overload for ACCEPT call to
     // consistently handle message dropping. It would be ideal if the
@@ -4455,6 +4489,11 @@ void Master::_accept(
   Resources offeredResources;
   size_t offersAccepted = 0;
 
+  // For frameworks with the OFFER_DELTAS capability, the first accepted
+  // offer of each role is kept as the standing offer holding the unused
+  // resources of that role.
+  hashmap<string, Offer> standingOffers;
+
   foreach (const OfferID& offerId, accept.offer_ids()) {
     Offer* offer = getOffer(offerId);
     if (offer == nullptr) {
@@ -4465,6 +4504,11 @@ void Master::_accept(
     offeredResources += offer->resources();
     ++offersAccepted;
 
+    if (offer->has_version() &&
+        !standingOffers.contains(offer->allocation_info().role())) {
+      standingOffers[offer->allocation_info().role()] = *offer;
+    }
+
     _removeOffer(framework, offer);
   }
 
@@ -5340,6 +5384,54 @@ void Master::_accept(
     remainingResources + resizedResources - offeredResources;
   Resources implicitlyDeclined = remainingResources - speculativelyConverted;
 
+  // Rather than declining the unused resources, keep them in the
+  // standing offer of their role and tell the framework what was
+  // consumed.
+  if (!standingOffers.empty() &&
+      !implicitlyDeclined.empty() &&
+      slave->active &&
+      framework->active()) {
+    const hashmap<string, Resources> unused = implicitlyDeclined.allocations();
+
+    ResourceOffersMessage message;
+
+    foreachpair (
+        const string& role, const Offer& standingOffer, standingOffers) {
+      if (!unused.contains(role)) {
+        continue;
+      }
+
+      Offer* offer = new Offer(standingOffer);
+
+      offers[offer->id()] = offer;
+
+      framework->addOffer(offer);
+      slave->addOffer(offer);
+
+      if (flags.offer_timeout.isSome()) {
+        offerTimers[offer->id()] =
+          delay(flags.offer_timeout.get(),
+                self(),
+                &Self::offerTimeout,
+                offer->id());
+      }
+
+      *message.add_offer_deltas() =
+        updateOffer(framework, slave, offer, unused.at(role));
+
+      VLOG(2) << "Keeping resources " << unused.at(role)
+              << " of offer " << offer->id()
+              << " on agent " << *slave
+              << " for framework " << *framework;
+
+      implicitlyDeclined -= unused.at(role);
+    }
+
+    if (message.offer_deltas_size() > 0) {
+      framework->send(message);
+    }
+  }
+
   // Prevent any allocations from occurring during resource recovery below.
   //
   // TODO(asekretenko): Ideally, we should be able to inform the allocator about
@@ -5686,7 +5778,9 @@ void Master::killTask(
 }
 
 
-void Master::kill(Framework* framework, const scheduler::Call::Kill& kill)
+Option<Error> Master::kill(
+    Framework* framework,
+    const scheduler::Call::Kill& kill)
 {
   CHECK_NOTNULL(framework);
 
@@ -5715,7 +5809,7 @@ void Master::kill(Framework* framework, const scheduler::Call::Kill& kill)
     }
 
     reconcile(framework, std::move(message));
-    return;
+    return None();
   }
 
   if (slaveId.isSome() && slaveId.get() != task->slave_id()) {
@@ -5725,7 +5819,10 @@ void Master::kill(Framework* framework, const scheduler::Call::Kill& kill)
                  << task->slave_id();
 
     // TODO(vinod): Return a "Bad Request" when using HTTP API.
-    return;
+    return Error(
+        "Task " + stringify(taskId) + " belongs to agent " +
+        stringify(task->slave_id()) + " rather than " +
+        stringify(slaveId.get()));
   }
 
   Slave* slave = slaves.registered.get(task->slave_id());
@@ -5760,6 +5857,8 @@ void Master::kill(Framework* framework, const scheduler::Call::Kill& kill)
                  << " because the agent " << *slave << " is disconnected."
                  << " Kill will be retried if the agent reregisters";
   }
+
+  return None();
 }
 
 
@@ -5831,7 +5930,7 @@ void Master::statusUpdateAcknowledgement(
 }
 
 
-void Master::acknowledge(
+Option<Error> Master::acknowledge(
     Framework* framework,
     scheduler::Call::Acknowledge&& acknowledge)
 {
@@ -5855,7 +5954,7 @@ void Master::acknowledge(
       << " to agent " << slaveId << " because agent is not registered";
 
     metrics->invalid_status_update_acknowledgements++;
-    return;
+    return Error("Agent " + stringify(slaveId) + " is not registered");
   }
 
   if (!slave->connected) {
@@ -5865,7 +5964,7 @@ void Master::acknowledge(
       << " to agent " << *slave << " because agent is disconnected";
 
     metrics->invalid_status_update_acknowledgements++;
-    return;
+    return Error("Agent " + stringify(slaveId) + " is disconnected");
   }
 
   LOG(INFO)
@@ -5897,7 +5996,8 @@ void Master::acknowledge(
         << " sent by this master";
 
       metrics->invalid_status_update_acknowledgements++;
-      return;
+      return Error("Status update " + stringify(uuid) + " of task " +
+                   stringify(taskId) + " was not sent by this master");
     }
 
     // Remove the task once the terminal update is acknowledged.
@@ -5918,6 +6018,61 @@ void Master::acknowledge(
   metrics->valid_status_update_acknowledgements++;
 
   checkAndTransitionDrainingAgent(slave);
+
+  return None();
+}
+
+
+scheduler::Response::Batch Master::batch(
+    Framework* framework,
+    scheduler::Call::Batch&& batch)
+{
+  CHECK_NOTNULL(framework);
+
+  LOG(INFO) << "Processing BATCH call with " << batch.declines_size()
+            << " declines, " << batch.kills_size() << " kills and "
+            << batch.acknowledges_size() << " acknowledgements"
+            << " for framework " << *framework;
+
+  scheduler::Response::Batch result;
+
+  foreach (scheduler::Call::Decline& decline_, *batch.mutable_declines()) {
+    // NOTE: Offers which are no longer valid are ignored, the same as
+    // for a standalone DECLINE call.
+    decline(framework, std::move(decline_));
+    result.add_declines();
+  }
+
+  foreach (const scheduler::Call::Kill& kill_, batch.kills()) {
+    Option<Error> error = kill(framework, kill_);
+
+    scheduler::Response::Batch::Result* item = result.add_kills();
+    if (error.isSome()) {
+      item->set_error(error->message);
+    }
+  }
+
+  foreach (
+      scheduler::Call::Acknowledge& acknowledge_,
+      *batch.mutable_acknowledges()) {
+    scheduler::Response::Batch::Result* item = result.add_acknowledges();
+
+    // Unlike a standalone ACKNOWLEDGE call the UUID is validated per
+    // item here, so that a single bad item doesn't reject the batch.
+    Try<id::UUID> uuid = id::UUID::fromBytes(acknowledge_.uuid());
+    if (uuid.isError()) {
+      metrics->invalid_status_update_acknowledgements++;
+      item->set_error(uuid.error());
+      continue;
+    }
+
+    Option<Error> error = acknowledge(framework, std::move(acknowledge_));
+    if (error.isSome()) {
+      item->set_error(error->message);
+    }
+  }
+
+  return result;
 }
 
 
@@ -9380,6 +9535,44 @@ void Master::frameworkFailoverTimeout(const FrameworkID& frameworkId,
 }
 
 
+// Converts offered resources into the format expected by the framework.
+static void prepareOfferedResources(
+    const Framework& framework,
+    RepeatedPtrField<Resource>* resources)
+{
+  // TODO(jieyu): For now, we strip 'ephemeral_ports' resource from
+  // offers so that frameworks do not see this resource. This is a
+  // short term workaround. Revisit this once we resolve MESOS-1654.
+  for (int i = 0; i < resources->size();) {
+    if (resources->Get(i).name() == "ephemeral_ports") {
+      resources->SwapElements(i, resources->size() - 1);
+      resources->RemoveLast();
+    } else {
+      ++i;
+    }
+  }
+
+  // Per MESOS-8237, it is problematic to show the
+  // `Resource.allocation_info` for pre-MULTI_ROLE schedulers.
+  // Pre-MULTI_ROLE schedulers are not `AllocationInfo` aware,
+  // and since they may be performing operations that
+  // implicitly uses all of Resource's state (e.g. equality
+  // comparison), we strip the `AllocationInfo` from `Resource`,
+  // as well as Offer. The idea here is that since the
+  // information doesn't provide any value to a pre-MULTI_ROLE
+  // scheduler, we preserve the old `Offer` format for them.
+  if (!framework.capabilities.multiRole) {
+    foreach (Resource& resource, *resources) {
+      resource.clear_allocation_info();
+    }
+  }
+
+  if (!framework.capabilities.reservationRefinement) {
+    convertResourceFormat(resources, PRE_RESERVATION_REFINEMENT);
+  }
+}
+
+
 void Master::offer(
     const FrameworkID& frameworkId,
     const hashmap<string, hashmap<SlaveID, Resources>>& resources)
@@ -9476,6 +9669,43 @@ void Master::offer(
       }
   #endif // ENABLE_PORT_MAPPING_ISOLATOR
 
+      // If the framework already holds an offer for this role on the
+      // agent, grow that offer instead of sending a new one.
+      Offer* standingOffer = getStandingOffer(framework, slave, role);
+
+      if (standingOffer != nullptr) {
+        Offer::Delta delta = updateOffer(
+            framework,
+            slave,
+            standingOffer,
+            Resources(standingOffer->resources()) + offered);
+
+        VLOG(2) << "Adding resources " << offered
+                << " to offer " << standingOffer->id()
+                << " on agent " << *slave
+                << " for framework " << *framework;
+
+        // Restart the offer timeout, so that the framework has as long
+        // to use the added resources as for those of a new offer.
+        if (offerTimers.contains(standingOffer->id())) {
+          Clock::cancel(offerTimers.at(standingOffer->id()));
+          offerTimers.erase(standingOffer->id());
+        }
+
+        if (flags.offer_timeout.isSome()) {
+          offerTimers[standingOffer->id()] =
+            delay(flags.offer_timeout.get(),
+                  self(),
+                  &Self::offerTimeout,
+                  standingOffer->id());
+        }
+
+        offerIds.push_back(standingOffer->id());
+
+        *message.add_offer_deltas() = std::move(delta);
+        continue;
+      }
+
       // TODO(vinod): Split regular and revocable resources into
       // separate offers, so that rescinding offers with revocable
       // resources does not affect offers with regular resources.
@@ -9491,6 +9721,11 @@ void Master::offer(
       Offer* offer = new Offer();
       offer->mutable_id()->MergeFrom(newOfferId());
       offer->mutable_framework_id()->MergeFrom(framework->id());
+
+      if (framework->http().isSome() && framework->capabilities.offerDeltas) {
+        offer->set_version(0);
+      }
+
       offer->mutable_slave_id()->MergeFrom(slave->id);
       offer->set_hostname(slave->info.hostname());
       offer->mutable_url()->MergeFrom(url);
@@ -9533,41 +9768,14 @@ void Master::offer(
                 offer->id());
       }
 
-      // TODO(jieyu): For now, we strip 'ephemeral_ports' resource from
-      // offers so that frameworks do not see this resource. This is a
-      // short term workaround. Revisit this once we resolve MESOS-1654.
       Offer offer_ = *offer;
 
-      for (int i = 0; i < offer_.resources_size();) {
-        if (offer_.resources(i).name() == "ephemeral_ports") {
-          offer_.mutable_resources()->SwapElements(
-              i, offer_.resources_size() - 1);
-          offer_.mutable_resources()->RemoveLast();
-        } else {
-          ++i;
-        }
-      }
+      prepareOfferedResources(*framework, offer_.mutable_resources());
 
-      // Per MESOS-8237, it is problematic to show the
-      // `Resource.allocation_info` for pre-MULTI_ROLE schedulers.
-      // Pre-MULTI_ROLE schedulers are not `AllocationInfo` aware,
-      // and since they may be performing operations that
-      // implicitly uses all of Resource's state (e.g. equality
-      // comparison), we strip the `AllocationInfo` from `Resource`,
-      // as well as Offer. The idea here is that since the
-      // information doesn't provide any value to a pre-MULTI_ROLE
-      // scheduler, we preserve the old `Offer` format for them.
+      // See `prepareOfferedResources()` for why the `AllocationInfo` is
+      // stripped for pre-MULTI_ROLE schedulers.
       if (!framework->capabilities.multiRole) {
         offer_.clear_allocation_info();
-
-        foreach (Resource& resource, *offer_.mutable_resources()) {
-          resource.clear_allocation_info();
-        }
-      }
-
-      if (!framework->capabilities.reservationRefinement) {
-        convertResourceFormat(
-            offer_.mutable_resources(), PRE_RESERVATION_REFINEMENT);
       }
 
       VLOG(2) << "Sending offer " << offer_.id()
@@ -9583,7 +9791,7 @@ void Master::offer(
     }
   }
 
-  if (message.offers().size() == 0) {
+  if (message.offers().size() == 0 && message.offer_deltas().size() == 0) {
     return;
   }
 
@@ -9594,6 +9802,65 @@ void Master::offer(
 }
 
 
+Offer* Master::getStandingOffer(
+    Framework* framework,
+    Slave* slave,
+    const string& role)
+{
+  // Offer deltas are only understood by the v1 scheduler API.
+  if (framework->http().isNone() || !framework->capabilities.offerDeltas) {
+    return nullptr;
+  }
+
+  // NOTE: Offers made before the framework gained the capability
+  // through UPDATE_FRAMEWORK carry no version, and are not standing
+  // offers; they are left to be accepted, declined or rescinded.
+  foreach (Offer* offer, slave->offers) {
+    if (offer->framework_id() == framework->id() &&
+        offer->allocation_info().role() == role &&
+        offer->has_version()) {
+      return offer;
+    }
+  }
+
+  return nullptr;
+}
+
+
+Offer::Delta Master::updateOffer(
+    Framework* framework,
+    Slave* slave,
+    Offer* offer,
+    const Resources& resources)
+{
+  CHECK(offer->has_version()) << offer->id();
+
+  const Resources previous = offer->resources();
+
+  // Remove and re-add the offer so that the offered resources
+  // tracked by the framework and the agent stay consistent.
+  framework->removeOffer(offer);
+  slave->removeOffer(offer);
+
+  *offer->mutable_resources() = resources;
+  offer->set_version(offer->version() + 1);
+
+  framework->addOffer(offer);
+  slave->addOffer(offer);
+
+  Offer::Delta delta;
+  *delta.mutable_offer_id() = offer->id();
+  delta.set_version(offer->version());
+  *delta.mutable_added() = resources - previous;
+  *delta.mutable_removed() = previous - resources;
+
+  prepareOfferedResources(*framework, delta.mutable_added());
+  prepareOfferedResources(*framework, delta.mutable_removed());
+
+  return delta;
+}
+
+
 void Master::inverseOffer(
     const FrameworkID& frameworkId,
     const hashmap<SlaveID, UnavailableResources>& resources)
@@ -840,6 +840,25 @@ protected:
   // The offer must belong to the framework.
   void _removeOffer(Framework* framework, Offer* offer);
 
+  // Helpers for frameworks with the OFFER_DELTAS capability, see
+  // `Offer.Delta` in mesos.proto.
+  //
+  // Returns the offer which the framework holds for the role on the
+  // agent, or nullptr if there is none or the framework should not
+  // receive offer deltas.
+  Offer* getStandingOffer(
+      Framework* framework,
+      Slave* slave,
+      const std::string& role);
+
+  // Replaces the resources of the offer and bumps its version. Returns
+  // the delta to be sent to the framework.
+  Offer::Delta updateOffer(
+      Framework* framework,
+      Slave* slave,
+      Offer* offer,
+      const Resources& resources);
+
   // Remove an inverse offer after specified timeout
   void inverseOfferTimeout(const OfferID& inverseOfferId);
 
@@ -969,7 +988,8 @@ private:
       Framework* framework,
       const mesos::scheduler::Call::Revive& revive);
 
-  void kill(
+  // Returns an error if the kill was dropped rather than processed.
+  Option<Error> kill(
       Framework* framework,
       const mesos::scheduler::Call::Kill& kill);
 
@@ -977,7 +997,9 @@ private:
       Framework* framework,
       const mesos::scheduler::Call::Shutdown& shutdown);
 
-  void acknowledge(
+  // Returns an error if the acknowledgement was dropped rather than
+  // forwarded to the agent.
+  Option<Error> acknowledge(
       Framework* framework,
       mesos::scheduler::Call::Acknowledge&& acknowledge);
 
@@ -1005,6 +1027,12 @@ private:
       Framework* framework,
       const mesos::scheduler::Call::Suppress& suppress);
 
+  // Processes all items of a `BATCH` call as part of a single event
+  // and returns the result of each item.
+  mesos::scheduler::Response::Batch batch(
+      Framework* framework,
+      mesos::scheduler::Call::Batch&& batch);
+
   bool elected() const
   {
     return leader.isSome() && leader.get() == info_;
@@ -1307,9 +1335,25 @@ public:
         StreamingHttpConnection<v1::master::Event> connection;
       };
 
+      // The response body is produced in chunks by `next`, which
+      // returns `None` once the body is complete.
+      //
+      // By default all chunks are produced in the same turn of the
+      // master actor, so that the body is a consistent snapshot. With
+      // `--stream_state_responses`, each chunk is produced in a separate
+      // turn instead, once the previous one has been sent to the
+      // clients (see `processRequestsBatch()`), hence the memory used
+      // does not grow with the size of the body. Either way `next` may
+      // read master state directly but must not hold on to it between
+      // chunks.
+      struct Stream
+      {
+        std::function<Option<std::string>()> next;
+      };
+
       // Any additional post-processing cases will add additional
       // cases into this variant.
-      Variant<Subscribe> state;
+      Variant<Subscribe, Stream> state;
     };
 
     explicit ReadOnlyHandler(const Master* _master) : master(_master) {}
@@ -1399,40 +1443,74 @@ public:
         const process::Owned<ObjectApprovers>& approvers) const;
 
   private:
-    std::string serializeGetState(
-        const process::Owned<ObjectApprovers>& approvers) const;
-    std::string serializeGetAgents(
-        const process::Owned<ObjectApprovers>& approvers) const;
-    std::string serializeGetFrameworks(
-        const process::Owned<ObjectApprovers>& approvers) const;
-    std::string serializeGetExecutors(
-        const process::Owned<ObjectApprovers>& approvers) const;
+    // Implement the optional filtering, pagination and field masks of
+    // the `GET_TASKS` and `GET_FRAMEWORKS` calls (and the corresponding
+    // parts of `GET_STATE`), see `mesos::master::Call::GetTasks` and
+    // `mesos::master::Call::GetFrameworks`. Default constructed
+    // selectors select everything.
+    class TaskSelector;
+    class FrameworkSelector;
+
+    // Note that the fields of the `GET_STATE`, `GET_AGENTS`,
+    // `GET_FRAMEWORKS`, `GET_EXECUTORS` and `GET_TASKS` responses are
+    // written by a sequence of steps, wrapped into the embedded message
+    // fields of `path`. Each invocation of a step writes about
+    // `STREAM_CHUNK_SIZE` bytes and returns whether the step is done,
+    // so that these responses can be streamed without holding them in
+    // memory (see `streamProtobuf()` in readonly_handler.cpp).
+    std::vector<std::function<bool(std::string*)>> serializeGetState(
+        const process::Owned<ObjectApprovers>& approvers,
+        const TaskSelector& taskSelector,
+        const FrameworkSelector& frameworkSelector,
+        const std::vector<int>& path) const;
+    std::vector<std::function<bool(std::string*)>> serializeGetAgents(
+        const process::Owned<ObjectApprovers>& approvers,
+        const std::vector<int>& path) const;
+    std::vector<std::function<bool(std::string*)>> serializeGetFrameworks(
+        const process::Owned<ObjectApprovers>& approvers,
+        const FrameworkSelector& selector,
+        const std::vector<int>& path) const;
+    std::vector<std::function<bool(std::string*)>> serializeGetExecutors(
+        const process::Owned<ObjectApprovers>& approvers,
+        const std::vector<int>& path) const;
     std::string serializeGetOperations(
         const process::Owned<ObjectApprovers>& approvers) const;
-    std::string serializeGetTasks(
-        const process::Owned<ObjectApprovers>& approvers) const;
+    std::vector<std::function<bool(std::string*)>> serializeGetTasks(
+        const process::Owned<ObjectApprovers>& approvers,
+        const TaskSelector& selector,
+        const std::vector<int>& path) const;
     std::string serializeGetRoles(
         const process::Owned<ObjectApprovers>& approvers) const;
     std::string serializeSubscribe(
         const process::Owned<ObjectApprovers>& approvers) const;
 
     std::function<void(JSON::ObjectWriter*)> jsonifyGetState(
-        const process::Owned<ObjectApprovers>& approvers) const;
+        const process::Owned<ObjectApprovers>& approvers,
+        const TaskSelector& taskSelector,
+        const FrameworkSelector& frameworkSelector) const;
     std::function<void(JSON::ObjectWriter*)> jsonifyGetAgents(
         const process::Owned<ObjectApprovers>& approvers) const;
     std::function<void(JSON::ObjectWriter*)> jsonifyGetFrameworks(
-        const process::Owned<ObjectApprovers>& approvers) const;
+        const process::Owned<ObjectApprovers>& approvers,
+        const FrameworkSelector& selector) const;
     std::function<void(JSON::ObjectWriter*)> jsonifyGetExecutors(
         const process::Owned<ObjectApprovers>& approvers) const;
     std::function<void(JSON::ObjectWriter*)> jsonifyGetOperations(
         const process::Owned<ObjectApprovers>& approvers) const;
     std::function<void(JSON::ObjectWriter*)> jsonifyGetTasks(
-        const process::Owned<ObjectApprovers>& approvers) const;
+        const process::Owned<ObjectApprovers>& approvers,
+        const TaskSelector& selector) const;
     std::function<void(JSON::ObjectWriter*)> jsonifyGetRoles(
         const process::Owned<ObjectApprovers>& approvers) const;
     std::function<void(JSON::ObjectWriter*)> jsonifySubscribe(
         const process::Owned<ObjectApprovers>& approvers) const;
 
+    // Returns the registered or completed framework with the given ID,
+    // if any. Streamed responses are written across several turns of
+    // the master actor, hence they look up the entities to be written
+    // by their IDs each time.
+    const Framework* findFramework(const FrameworkID& frameworkId) const;
+
     const Master* master;
   };
 
@@ -1944,7 +2022,11 @@ private:
       hashmap<std::string, std::string> queryParameters;
       Option<process::http::authentication::Principal> principal;
       process::Owned<ObjectApprovers> approvers;
-      process::Promise<process::http::Response> promise;
+
+      // The first promise belongs to the request that created this
+      // entry, the remaining ones to the identical requests that were
+      // de-duplicated into it.
+      std::vector<process::Promise<process::http::Response>> promises;
     };
 
     mutable std::vector<BatchedRequest> batchedRequests;
@@ -2093,6 +2175,11 @@ private:
       const_iterator begin() const { return ids.begin(); }
       const_iterator end()   const { return ids.end();   }
 
+      const_iterator find(const SlaveID& slaveId) const
+      {
+        return ids.find(slaveId);
+      }
+
     private:
       hashmap<SlaveID, Slave*> ids;
       hashmap<process::UPID, Slave*> pids;
@@ -2771,8 +2858,11 @@ struct Role
 };
 
 
+// Returns the model of `framework`. If `fields` is set, only the
+// top-level fields with the given numbers are set.
 mesos::master::Response::GetFrameworks::Framework model(
-    const Framework& framework);
+    const Framework& framework,
+    const Option<hashset<int>>& fields = None());
 
 
 } // namespace master {
@@ -46,59 +46,76 @@ namespace master {
 Metrics::Metrics(const Master& master)
   : uptime_secs(
         "master/uptime_secs",
-        defer(master, &Master::_uptime_secs)),
+        defer(master, &Master::_uptime_secs),
+        master.flags.metrics_cache_interval),
     elected(
         "master/elected",
-        defer(master, &Master::_elected)),
+        defer(master, &Master::_elected),
+        master.flags.metrics_cache_interval),
     slaves_connected(
         "master/slaves_connected",
-        defer(master, &Master::_slaves_connected)),
+        defer(master, &Master::_slaves_connected),
+        master.flags.metrics_cache_interval),
     slaves_disconnected(
         "master/slaves_disconnected",
-        defer(master, &Master::_slaves_disconnected)),
+        defer(master, &Master::_slaves_disconnected),
+        master.flags.metrics_cache_interval),
     slaves_active(
         "master/slaves_active",
-        defer(master, &Master::_slaves_active)),
+        defer(master, &Master::_slaves_active),
+        master.flags.metrics_cache_interval),
     slaves_inactive(
         "master/slaves_inactive",
-        defer(master, &Master::_slaves_inactive)),
+        defer(master, &Master::_slaves_inactive),
+        master.flags.metrics_cache_interval),
     slaves_unreachable(
         "master/slaves_unreachable",
-        defer(master, &Master::_slaves_unreachable)),
+        defer(master, &Master::_slaves_unreachable),
+        master.flags.metrics_cache_interval),
     frameworks_connected(
         "master/frameworks_connected",
-        defer(master, &Master::_frameworks_connected)),
+        defer(master, &Master::_frameworks_connected),
+        master.flags.metrics_cache_interval),
     frameworks_disconnected(
         "master/frameworks_disconnected",
-        defer(master, &Master::_frameworks_disconnected)),
+        defer(master, &Master::_frameworks_disconnected),
+        master.flags.metrics_cache_interval),
     frameworks_active(
         "master/frameworks_active",
-        defer(master, &Master::_frameworks_active)),
+        defer(master, &Master::_frameworks_active),
+        master.flags.metrics_cache_interval),
     frameworks_inactive(
         "master/frameworks_inactive",
-        defer(master, &Master::_frameworks_inactive)),
+        defer(master, &Master::_frameworks_inactive),
+        master.flags.metrics_cache_interval),
     outstanding_offers(
         "master/outstanding_offers",
-        defer(master, &Master::_outstanding_offers)),
+        defer(master, &Master::_outstanding_offers),
+        master.flags.metrics_cache_interval),
     operation_states(
         "master/operations/"),
     operator_event_stream_subscribers(
         "master/operator_event_stream_subscribers"),
     tasks_staging(
         "master/tasks_staging",
-        defer(master, &Master::_tasks_staging)),
+        defer(master, &Master::_tasks_staging),
+        master.flags.metrics_cache_interval),
     tasks_starting(
         "master/tasks_starting",
-        defer(master, &Master::_tasks_starting)),
+        defer(master, &Master::_tasks_starting),
+        master.flags.metrics_cache_interval),
     tasks_running(
         "master/tasks_running",
-        defer(master, &Master::_tasks_running)),
+        defer(master, &Master::_tasks_running),
+        master.flags.metrics_cache_interval),
     tasks_unreachable(
         "master/tasks_unreachable",
-        defer(master, &Master::_tasks_unreachable)),
+        defer(master, &Master::_tasks_unreachable),
+        master.flags.metrics_cache_interval),
     tasks_killing(
         "master/tasks_killing",
-        defer(master, &Master::_tasks_killing)),
+        defer(master, &Master::_tasks_killing),
+        master.flags.metrics_cache_interval),
     tasks_finished(
         "master/tasks_finished"),
     tasks_failed(
@@ -195,13 +212,16 @@ Metrics::Metrics(const Master& master)
         "master/recovery_slave_removals"),
     event_queue_messages(
         "master/event_queue_messages",
-        defer(master, &Master::_event_queue_messages)),
+        defer(master, &Master::_event_queue_messages),
+        master.flags.metrics_cache_interval),
     event_queue_dispatches(
         "master/event_queue_dispatches",
-        defer(master, &Master::_event_queue_dispatches)),
+        defer(master, &Master::_event_queue_dispatches),
+        master.flags.metrics_cache_interval),
     event_queue_http_requests(
         "master/event_queue_http_requests",
-        defer(master, &Master::_event_queue_http_requests)),
+        defer(master, &Master::_event_queue_http_requests),
+        master.flags.metrics_cache_interval),
     slave_registrations(
         "master/slave_registrations"),
     slave_reregistrations(
@@ -340,15 +360,18 @@ Metrics::Metrics(const Master& master)
   foreach (const string& resource, resources) {
     PullGauge total(
         "master/" + resource + "_total",
-        defer(master, &Master::_resources_total, resource));
+        defer(master, &Master::_resources_total, resource),
+        master.flags.metrics_cache_interval);
 
     PullGauge used(
         "master/" + resource + "_used",
-        defer(master, &Master::_resources_used, resource));
+        defer(master, &Master::_resources_used, resource),
+        master.flags.metrics_cache_interval);
 
     PullGauge percent(
         "master/" + resource + "_percent",
-        defer(master, &Master::_resources_percent, resource));
+        defer(master, &Master::_resources_percent, resource),
+        master.flags.metrics_cache_interval);
 
     resources_total.push_back(total);
     resources_used.push_back(used);
@@ -362,15 +385,18 @@ Metrics::Metrics(const Master& master)
   foreach (const string& resource, resources) {
     PullGauge total(
         "master/" + resource + "_revocable_total",
-        defer(master, &Master::_resources_revocable_total, resource));
+        defer(master, &Master::_resources_revocable_total, resource),
+        master.flags.metrics_cache_interval);
 
     PullGauge used(
         "master/" + resource + "_revocable_used",
-        defer(master, &Master::_resources_revocable_used, resource));
+        defer(master, &Master::_resources_revocable_used, resource),
+        master.flags.metrics_cache_interval);
 
     PullGauge percent(
         "master/" + resource + "_revocable_percent",
-        defer(master, &Master::_resources_revocable_percent, resource));
+        defer(master, &Master::_resources_revocable_percent, resource),
+        master.flags.metrics_cache_interval);
 
     resources_revocable_total.push_back(total);
     resources_revocable_used.push_back(used);
@@ -16,15 +16,23 @@
 
 #include "master/master.hpp"
 
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <set>
 #include <string>
+#include <tuple>
 #include <vector>
 
 #include <google/protobuf/descriptor.h>
+#include <google/protobuf/field_mask.pb.h>
 #include <google/protobuf/wire_format_lite.h>
 
 #include <google/protobuf/io/coded_stream.h>
 #include <google/protobuf/io/zero_copy_stream_impl_lite.h>
 
+#include <google/protobuf/util/field_mask_util.h>
+
 #include <mesos/mesos.hpp>
 
 #include <mesos/authorizer/authorizer.hpp>
@@ -32,12 +40,19 @@
 #include <process/http.hpp>
 #include <process/owned.hpp>
 
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+
+#include <stout/base64.hpp>
 #include <stout/foreach.hpp>
 #include <stout/hashmap.hpp>
 #include <stout/hashset.hpp>
 #include <stout/jsonify.hpp>
+#include <stout/numify.hpp>
 #include <stout/option.hpp>
 #include <stout/representation.hpp>
+#include <stout/strings.hpp>
+#include <stout/try.hpp>
 
 #include "common/build.hpp"
 #include "common/http.hpp"
@@ -46,6 +61,7 @@ using google::protobuf::internal::WireFormatLite;
 
 using process::Owned;
 
+using process::http::BadRequest;
 using process::http::NotAcceptable;
 using process::http::OK;
 using process::http::Response;
@@ -88,24 +104,6 @@ struct Full : Representation<T>
 };
 
 
-// Filtered representation of Full<Framework>.
-// Executors and Tasks are filtered based on whether the
-// user is authorized to view them.
-//
-// TODO(bevers): Consider moving writers and other json-related
-// code into a separate file.
-struct FullFrameworkWriter {
-  FullFrameworkWriter(
-      const process::Owned<ObjectApprovers>& approvers,
-      const Framework* framework);
-
-  void operator()(JSON::ObjectWriter* writer) const;
-
-  const process::Owned<ObjectApprovers>& approvers_;
-  const Framework* framework_;
-};
-
-
 struct SlaveWriter
 {
   SlaveWriter(
@@ -140,129 +138,6 @@ struct SlavesWriter
 };
 
 
-void json(JSON::ObjectWriter* writer, const Summary<Framework>& summary);
-
-
-FullFrameworkWriter::FullFrameworkWriter(
-    const Owned<ObjectApprovers>& approvers,
-    const Framework* framework)
-  : approvers_(approvers),
-    framework_(framework)
-{}
-
-
-void FullFrameworkWriter::operator()(JSON::ObjectWriter* writer) const
-{
-  json(writer, Summary<Framework>(*framework_));
-
-  // Add additional fields to those generated by the
-  // `Summary<Framework>` overload.
-  writer->field("user", framework_->info.user());
-  writer->field("failover_timeout", framework_->info.failover_timeout());
-  writer->field("checkpoint", framework_->info.checkpoint());
-  writer->field("registered_time", framework_->registeredTime.secs());
-  writer->field("unregistered_time", framework_->unregisteredTime.secs());
-
-  if (framework_->info.has_principal()) {
-    writer->field("principal", framework_->info.principal());
-  }
-
-  // TODO(bmahler): Consider deprecating this in favor of the split
-  // used and offered resources added in `Summary<Framework>`.
-  writer->field(
-      "resources",
-      framework_->totalUsedResources + framework_->totalOfferedResources);
-
-  // TODO(benh): Consider making reregisteredTime an Option.
-  if (framework_->registeredTime != framework_->reregisteredTime) {
-    writer->field("reregistered_time", framework_->reregisteredTime.secs());
-  }
-
-  // For multi-role frameworks the `role` field will be unset.
-  // Note that we could set `roles` here for both cases, which
-  // would make tooling simpler (only need to look for `roles`).
-  // However, we opted to just mirror the protobuf akin to how
-  // generic protobuf -> JSON translation works.
-  if (framework_->capabilities.multiRole) {
-    writer->field("roles", framework_->info.roles());
-  } else {
-    writer->field("role", framework_->info.role());
-  }
-
-  // Model all of the tasks associated with a framework.
-  writer->field("tasks", [this](JSON::ArrayWriter* writer) {
-    foreachvalue (Task* task, framework_->tasks) {
-      // Skip unauthorized tasks.
-      if (!approvers_->approved<VIEW_TASK>(*task, framework_->info)) {
-        continue;
-      }
-
-      writer->element(*task);
-    }
-  });
-
-  writer->field("unreachable_tasks", [this](JSON::ArrayWriter* writer) {
-    foreachvalue (const Owned<Task>& task, framework_->unreachableTasks) {
-      // Skip unauthorized tasks.
-      if (!approvers_->approved<VIEW_TASK>(*task, framework_->info)) {
-        continue;
-      }
-
-      writer->element(*task);
-    }
-  });
-
-  writer->field("completed_tasks", [this](JSON::ArrayWriter* writer) {
-    foreach (const Owned<Task>& task, framework_->completedTasks) {
-      // Skip unauthorized tasks.
-      if (!approvers_->approved<VIEW_TASK>(*task, framework_->info)) {
-        continue;
-      }
-
-      writer->element(*task);
-    }
-  });
-
-  // Model all of the offers associated with a framework.
-  writer->field("offers", [this](JSON::ArrayWriter* writer) {
-    foreach (Offer* offer, framework_->offers) {
-      writer->element(*offer);
-    }
-  });
-
-  // Model all of the executors of a framework.
-  writer->field("executors", [this](JSON::ArrayWriter* writer) {
-    foreachpair (
-        const SlaveID& slaveId,
-        const auto& executorsMap,
-        framework_->executors) {
-      foreachvalue (const ExecutorInfo& executor, executorsMap) {
-        writer->element([this,
-                         &executor,
-                         &slaveId](JSON::ObjectWriter* writer) {
-          // Skip unauthorized executors.
-          if (!approvers_->approved<VIEW_EXECUTOR>(
-                  executor, framework_->info)) {
-            return;
-          }
-
-          json(writer, executor);
-          writer->field("slave_id", slaveId.value());
-        });
-      }
-    }
-  });
-
-  // Model all of the labels associated with a framework.
-  if (framework_->info.has_labels()) {
-    writer->field("labels", framework_->info.labels());
-  }
-
-  writer->field(
-      "offer_constraints", JSON::Protobuf(framework_->offerConstraints()));
-}
-
-
 SlaveWriter::SlaveWriter(
     const Slave& slave,
     const Option<DrainInfo>& drainInfo,
@@ -437,10 +312,13 @@ void SlavesWriter::writeSlave(
 }
 
 
-void json(JSON::ObjectWriter* writer, const Summary<Framework>& summary)
+// Writes the fields of the summary representation of `framework`, see
+// `json(JSON::ObjectWriter*, const Summary<Framework>&)`. The `writer`
+// is either a `JSON::ObjectWriter` or a `JsonOutput`, which allows
+// writing the full representation in parts (see `jsonFullFramework()`).
+template <typename Writer>
+static void jsonSummaryFields(Writer* writer, const Framework& framework)
 {
-  const Framework& framework = summary;
-
   writer->field("id", framework.id().value());
   writer->field("name", framework.info.name());
 
@@ -461,6 +339,13 @@ void json(JSON::ObjectWriter* writer, const Summary<Framework>& summary)
 }
 
 
+void json(JSON::ObjectWriter* writer, const Summary<Framework>& summary)
+{
+  const Framework& framework = summary;
+  jsonSummaryFields(writer, framework);
+}
+
+
 // This abstraction has no side-effects. It factors out computing the
 // mapping from 'slaves' to 'frameworks' to answer the questions 'what
 // frameworks are running on a given slave?' and 'what slaves are
@@ -626,844 +511,2150 @@ private:
 };
 
 
-pair<Response, Option<Master::ReadOnlyHandler::PostProcessing>>
-  Master::ReadOnlyHandler::frameworks(
-      ContentType outputContentType,
-      const hashmap<std::string, std::string>& query,
-      const process::Owned<ObjectApprovers>& approvers) const
+// Returns the key of an entry of one of the containers of the master,
+// by which a `Walk` over the container is resumed.
+template <typename Key, typename Value>
+static const Key& walkKey(const std::pair<Key, Value>& entry)
 {
-  CHECK_EQ(outputContentType, ContentType::JSON);
-
-  IDAcceptor<FrameworkID> selectFrameworkId(
-      query.get("framework_id"));
+  return entry.first;
+}
 
-  // This lambda is consumed before the outer lambda
-  // returns, hence capture by reference is fine here.
-  const Master* master = this->master;
-  auto frameworks = [master, &approvers, &selectFrameworkId](
-      JSON::ObjectWriter* writer) {
-    // Model all of the frameworks.
-    writer->field(
-        "frameworks",
-        [master, &approvers, &selectFrameworkId](
-            JSON::ArrayWriter* writer) {
-          foreachvalue (
-              Framework* framework, master->frameworks.registered) {
-            // Skip unauthorized frameworks or frameworks
-            // without a matching ID.
-            if (!selectFrameworkId.accept(framework->id()) ||
-                !approvers->approved<VIEW_FRAMEWORK>(framework->info)) {
-              continue;
-            }
 
-            writer->element(FullFrameworkWriter(approvers, framework));
-          }
-        });
+static const TaskID& walkKey(const Owned<Task>& task)
+{
+  return task->task_id();
+}
 
-    // Model all of the completed frameworks.
-    writer->field(
-        "completed_frameworks",
-        [master, &approvers, &selectFrameworkId](
-            JSON::ArrayWriter* writer) {
-          foreachvalue (const Owned<Framework>& framework,
-                        master->frameworks.completed) {
-            // Skip unauthorized frameworks or frameworks
-            // without a matching ID.
-            if (!selectFrameworkId.accept(framework->id()) ||
-                !approvers->approved<VIEW_FRAMEWORK>(framework->info)) {
-              continue;
-            }
 
-            writer->element(
-                FullFrameworkWriter(approvers, framework.get()));
-          }
-        });
+// Returns the entry of `container` with the given key, if any.
+template <typename Container, typename Key>
+static auto walkFind(const Container& container, const Key& key)
+  -> decltype(container.find(key))
+{
+  return container.find(key);
+}
 
-    // Unregistered frameworks are no longer possible. We emit an
-    // empty array for the sake of backward compatibility.
-    writer->field("unregistered_frameworks", [](JSON::ArrayWriter*) {});
-  };
 
-  return pair<Response, Option<Master::ReadOnlyHandler::PostProcessing>>(
-      OK(jsonify(frameworks), query.get("jsonp")),
-      None());
+// The completed tasks of a framework are not indexed by their IDs, but
+// there are at most `--max_completed_tasks_per_framework` of them and
+// they are only searched once per chunk.
+static circular_buffer<Owned<Task>>::const_iterator walkFind(
+    const circular_buffer<Owned<Task>>& tasks,
+    const TaskID& taskId)
+{
+  return std::find_if(
+      tasks.begin(),
+      tasks.end(),
+      [&taskId](const Owned<Task>& task) {
+        return task->task_id() == taskId;
+      });
 }
 
 
-pair<Response, Option<Master::ReadOnlyHandler::PostProcessing>>
-  Master::ReadOnlyHandler::roles(
-      ContentType outputContentType,
-      const hashmap<std::string, std::string>& query,
-      const process::Owned<ObjectApprovers>& approvers) const
+// A walk over the entries of one of the containers of the master (e.g.,
+// the tasks of a framework) in iteration order, which is resumed in each
+// chunk of a streamed body, see `jsonArray()` and `protobufRepeated()`.
+//
+// Iterators may be invalidated between chunks, hence the walk remembers
+// the key of the last entry visited and resumes after that entry. If it
+// is gone in the meantime, the walk resumes at the same position, so an
+// entry may then be skipped or visited twice. This is in line with the
+// consistency of streamed responses, see `--stream_state_responses`.
+template <typename Container>
+class Walk
 {
-  CHECK_EQ(outputContentType, ContentType::JSON);
-
-  const Master* master = this->master;
+public:
+  typedef decltype(std::declval<const Container&>().begin()) Iterator;
+  typedef typename std::iterator_traits<Iterator>::value_type Entry;
 
-  const vector<string> knownRoles = master->knownRoles();
+  Walk() : count(0) {}
 
-  auto roles = [&](JSON::ObjectWriter* writer) {
-    writer->field(
-        "roles",
-        [&](JSON::ArrayWriter* writer) {
-          foreach (const string& name, knownRoles) {
-            if (!approvers->approved<VIEW_ROLE>(name)) {
-              continue;
-            }
+  // Returns the next entry of `container` to visit.
+  Iterator resume(const Container& container) const
+  {
+    if (last.isSome()) {
+      Iterator entry = walkFind(container, last.get());
+      if (entry != container.end()) {
+        return ++entry;
+      }
+    }
 
-            writer->element([&](JSON::ObjectWriter* writer) {
-              writer->field("name", name);
+    // The last entry visited (if any) is gone.
+    Iterator entry = container.begin();
+    std::advance(
+        entry,
+        std::min(last.isSome() ? count - 1 : count, container.size()));
 
-              writer->field(
-                  "weight",
-                  master->weights.get(name).getOrElse(DEFAULT_WEIGHT));
+    return entry;
+  }
 
-              Option<Role*> role = master->roles.get(name);
+  void visit(const Entry& entry)
+  {
+    last = walkKey(entry);
+    ++count;
+  }
 
-              RoleResourceBreakdown resourceBreakdown(master, name);
+private:
+  typedef typename std::decay<
+      decltype(walkKey(std::declval<const Entry&>()))>::type Key;
 
-              // Prior to Mesos 1.9, this field is filled based on
-              // `QuotaInfo` which is now deprecated. For backward
-              // compatibility reasons, we do not use any formatter
-              // for the new struct but construct the response by hand.
-              // Specifically:
-              //
-              //  - We keep the `role` field which was present in the
-              //    `QuotaInfo`.
-              //
-              //  - We name the field using singular `guarantee` and `limit`
-              //    which is different from the plural used in `QuotaConfig`.
-              const Quota quota = master->quotas.get(name).getOrElse(Quota());
+  Option<Key> last;
+  size_t count;
+};
 
-              writer->field("quota", [&](JSON::ObjectWriter* writer) {
-                writer->field("role", name);
 
-                writer->field("guarantee", quota.guarantees);
-                writer->field("limit", quota.limits);
-                writer->field("consumed", resourceBreakdown.consumedQuota());
-              });
+// Returns the task of an entry of one of the task containers of a
+// framework.
+template <typename Key, typename Value>
+static const Task& walkTask(const std::pair<Key, Value>& entry)
+{
+  return *entry.second;
+}
 
-              ResourceQuantities allocated = resourceBreakdown.allocated();
-              ResourceQuantities offered = resourceBreakdown.offered();
 
-              // Deprecated by allocated, offered, reserved.
-              writer->field("resources", allocated + offered);
+static const Task& walkTask(const Owned<Task>& task)
+{
+  return *task;
+}
 
-              writer->field("allocated", allocated);
-              writer->field("offered", offered);
-              writer->field("reserved", resourceBreakdown.reserved());
 
-              if (role.isNone()) {
-                writer->field("frameworks", [](JSON::ArrayWriter*) {});
-              } else {
-                writer->field("frameworks", [&](JSON::ArrayWriter* writer) {
-                  foreachkey (const FrameworkID& id, (*role)->frameworks) {
-                    writer->element(id.value());
-                  }
-                });
-              }
-            });
-          }
-        });
+// Returns a function which looks up the framework with the given ID in
+// `frameworks` (either the registered or the completed frameworks of
+// the master). It returns `nullptr` once the framework is gone.
+template <typename Frameworks>
+static function<const Framework*()> frameworkLookup(
+    const Frameworks* frameworks,
+    const FrameworkID& frameworkId)
+{
+  return [frameworks, frameworkId]() -> const Framework* {
+    auto framework = frameworks->get(frameworkId);
+    return framework.isSome() ? &**framework : nullptr;
   };
-
-  return pair<Response, Option<Master::ReadOnlyHandler::PostProcessing>>(
-      OK(jsonify(roles), query.get("jsonp")),
-      None());
 }
 
 
-pair<Response, Option<Master::ReadOnlyHandler::PostProcessing>>
-  Master::ReadOnlyHandler::slaves(
-      ContentType outputContentType,
-      const hashmap<std::string, std::string>& query,
-      const process::Owned<ObjectApprovers>& approvers) const
+// Returns a function which returns the member `member` (e.g., the tasks)
+// of the framework returned by `lookup`, or `nullptr` once the framework
+// is gone.
+template <typename T>
+static function<const T*()> frameworkMember(
+    const function<const Framework*()>& lookup,
+    T Framework::*member)
 {
-  CHECK_EQ(outputContentType, ContentType::JSON);
-
-  IDAcceptor<SlaveID> selectSlaveId(query.get("slave_id"));
-
-  return pair<Response, Option<Master::ReadOnlyHandler::PostProcessing>>(
-      OK(jsonify(SlavesWriter(master->slaves, approvers, selectSlaveId)),
-         query.get("jsonp")),
-      None());
+  return [lookup, member]() -> const T* {
+    const Framework* framework = lookup();
+    return framework != nullptr ? &(framework->*member) : nullptr;
+  };
 }
 
 
-pair<Response, Option<Master::ReadOnlyHandler::PostProcessing>>
-  Master::ReadOnlyHandler::state(
-      ContentType outputContentType,
-      const hashmap<std::string, std::string>& query,
-      const process::Owned<ObjectApprovers>& approvers) const
+// The output of a streamed JSON body, see `streamJson()`.
+struct JsonOutput
 {
-  CHECK_EQ(outputContentType, ContentType::JSON);
+  JsonOutput() : writer(buffer) {}
 
-  const Master* master = this->master;
-  auto calculateState = [master, &approvers](JSON::ObjectWriter* writer) {
-    writer->field("version", MESOS_VERSION);
+  // Returns whether a chunk's worth of output has accumulated, in
+  // which case the steps writing the body should yield.
+  bool full() const
+  {
+    return buffer.GetSize() >= STREAM_CHUNK_SIZE.bytes();
+  }
 
-    if (build::GIT_SHA.isSome()) {
-      writer->field("git_sha", build::GIT_SHA.get());
-    }
+  // Returns the output accumulated so far, the buffer is reused.
+  string take()
+  {
+    string output(buffer.GetString(), buffer.GetSize());
+    buffer.Clear();
+    return output;
+  }
 
-    if (build::GIT_BRANCH.isSome()) {
-      writer->field("git_branch", build::GIT_BRANCH.get());
-    }
+  // Writes the field `key` of the object being written, which allows
+  // writing the fields of the streamed object like those of any other
+  // object, see `JSON::ObjectWriter`.
+  template <typename T>
+  void field(const string& key, const T& value)
+  {
+    CHECK(writer.Key(key.c_str(), key.size()));
+    jsonify(value).write(&writer);
+  }
 
-    if (build::GIT_TAG.isSome()) {
-      writer->field("git_tag", build::GIT_TAG.get());
-    }
+  // Writes the next element of the array being written.
+  template <typename T>
+  void element(const T& value)
+  {
+    jsonify(value).write(&writer);
+  }
 
-    writer->field("build_date", build::DATE);
-    writer->field("build_time", build::TIME);
-    writer->field("build_user", build::USER);
-    writer->field("start_time", master->startTime.secs());
+  rapidjson::StringBuffer buffer;
+  rapidjson::Writer<rapidjson::StringBuffer> writer;
+};
 
-    if (master->electedTime.isSome()) {
-      writer->field("elected_time", master->electedTime->secs());
-    }
 
-    writer->field("id", master->info().id());
-    writer->field("pid", string(master->self()));
-    writer->field("hostname", master->info().hostname());
-    writer->field("capabilities", master->info().capabilities());
+// A step of writing a streamed JSON body, see `streamJson()`. Returns
+// whether it is done, otherwise (once the output is full) it is invoked
+// again in the next chunk.
+typedef function<bool(JsonOutput*)> JsonStep;
+
+
+// Returns a step which writes the fields written by `f`.
+static JsonStep jsonFields(const function<void(JsonOutput*)>& f)
+{
+  return [f](JsonOutput* output) {
+    f(output);
+    return true;
+  };
+}
+
+
+// Returns a step which runs `steps` in order.
+static JsonStep jsonSequence(const vector<JsonStep>& steps)
+{
+  std::shared_ptr<std::deque<JsonStep>> remaining(
+      new std::deque<JsonStep>(steps.begin(), steps.end()));
+
+  return [remaining](JsonOutput* output) {
+    while (!remaining->empty() && !output->full()) {
+      if (remaining->front()(output)) {
+        remaining->pop_front();
+      }
+    }
+
+    return remaining->empty();
+  };
+}
+
+
+// Returns a step which writes the field `key` holding an array with the
+// elements written by `write` for the entries of the container returned
+// by `container`, which is walked across several chunks (see `Walk`).
+// The container may be gone in a later chunk (e.g., the tasks of a
+// removed framework), in which case `container` returns `nullptr`.
+//
+// A large element may be written in parts, in which case `write` writes
+// the first part and returns the step which writes the rest. The entry
+// handed to `write` must not be held on to.
+template <typename Container>
+static JsonStep jsonArray(
+    const string& key,
+    const function<const Container*()>& container,
+    const function<Option<JsonStep>(
+        const typename Walk<Container>::Entry&, JsonOutput*)>& write)
+{
+  bool started = false;
+  Walk<Container> walk;
+  Option<JsonStep> rest;
+
+  return [key, container, write, started, walk, rest](
+      JsonOutput* output) mutable {
+    if (!started) {
+      CHECK(output->writer.Key(key.c_str(), key.size()));
+      CHECK(output->writer.StartArray());
+      started = true;
+    }
+
+    if (rest.isSome()) {
+      if (!rest.get()(output)) {
+        return false;
+      }
+
+      rest = None();
+    }
+
+    const Container* entries = container();
+
+    if (entries != nullptr) {
+      typename Walk<Container>::Iterator entry = walk.resume(*entries);
+
+      while (entry != entries->end()) {
+        if (output->full()) {
+          return false;
+        }
+
+        walk.visit(*entry);
+        rest = write(*entry++, output);
+
+        if (rest.isSome()) {
+          if (!rest.get()(output)) {
+            return false;
+          }
+
+          rest = None();
+        }
+      }
+    }
+
+    CHECK(output->writer.EndArray());
+    return true;
+  };
+}
+
+
+// Returns an (unset) `OK` response along with the post-processing that
+// streams the JSON object whose fields are written by `steps` as the
+// response body.
+//
+// The body is produced in chunks (see
+// `Master::ReadOnlyHandler::PostProcessing::Stream`): the steps are run
+// in order until `STREAM_CHUNK_SIZE` of output has accumulated, and a
+// step which is not done is resumed in the next chunk. When streaming is
+// enabled, each chunk is produced in a separate turn of the master
+// actor, hence steps must not hold on to master state between chunks.
+static pair<Response, Option<Master::ReadOnlyHandler::PostProcessing>>
+  streamJson(const vector<JsonStep>& steps, const Option<string>& jsonp)
+{
+  OK response;
+  response.headers["Content-Type"] =
+    jsonp.isSome() ? "text/javascript" : "application/json";
+
+  struct State
+  {
+    JsonOutput output;
+    JsonStep steps;
+    bool started;
+    bool done;
+  };
+
+  std::shared_ptr<State> state(new State());
+  state->steps = jsonSequence(steps);
+  state->started = false;
+  state->done = false;
+
+  Master::ReadOnlyHandler::PostProcessing::Stream stream;
+  stream.next = [state, jsonp]() -> Option<string> {
+    if (state->done) {
+      return None();
+    }
+
+    string chunk;
+
+    if (!state->started) {
+      if (jsonp.isSome()) {
+        chunk = jsonp.get() + "(";
+      }
+
+      CHECK(state->output.writer.StartObject());
+      state->started = true;
+    }
+
+    if (state->steps(&state->output)) {
+      CHECK(state->output.writer.EndObject());
+      state->done = true;
+    }
+
+    chunk += state->output.take();
+
+    if (state->done && jsonp.isSome()) {
+      chunk += ")";
+    }
+
+    return chunk;
+  };
+
+  return pair<Response, Option<Master::ReadOnlyHandler::PostProcessing>>(
+      response,
+      Master::ReadOnlyHandler::PostProcessing{std::move(stream)});
+}
+
+
+// Returns the fields written by `f` as a string.
+static string serializeFields(
+    const function<void(google::protobuf::io::CodedOutputStream*)>& f)
+{
+  string output;
+  google::protobuf::io::StringOutputStream stream(&output);
+  google::protobuf::io::CodedOutputStream writer(&stream);
+
+  f(&writer);
+
+  // We must manually trim the unused buffer space since
+  // we use the string before the coded output stream is
+  // destructed.
+  writer.Trim();
+
+  return output;
+}
+
+
+// Appends `fields` to `output`, wrapped into the embedded message
+// fields of `path`, e.g. for the path [get_state, get_tasks]:
+//
+//   get_state { get_tasks { <fields> } }
+static void appendFragment(
+    const vector<int>& path,
+    const string& fields,
+    string* output)
+{
+  // The size of the payload of each of the fields of `path`.
+  vector<size_t> sizes(path.size());
+
+  size_t size = fields.size();
+  for (size_t i = path.size(); i > 0; --i) {
+    sizes[i - 1] = size;
+
+    size += WireFormatLite::TagSize(path[i - 1], WireFormatLite::TYPE_BYTES) +
+            google::protobuf::io::CodedOutputStream::VarintSize32(
+                static_cast<uint32_t>(size));
+  }
+
+  google::protobuf::io::StringOutputStream stream(output);
+
+  {
+    google::protobuf::io::CodedOutputStream writer(&stream);
+
+    for (size_t i = 0; i < path.size(); ++i) {
+      WireFormatLite::WriteTag(
+          path[i], WireFormatLite::WIRETYPE_LENGTH_DELIMITED, &writer);
+
+      writer.WriteVarint32(static_cast<uint32_t>(sizes[i]));
+    }
+
+    writer.WriteRaw(fields.data(), static_cast<int>(fields.size()));
+
+    // The unused buffer space must be trimmed before `output` is used.
+    writer.Trim();
+  }
+}
+
+
+// A step of writing a streamed protobuf body, see `streamProtobuf()`.
+// It appends to the given chunk and returns whether it is done,
+// otherwise it is invoked again, in the same chunk if the chunk is
+// not full yet.
+typedef function<bool(string*)> ProtobufStep;
+
+
+// Returns a step which writes the fields written by `write`, wrapped
+// into the embedded message fields of `path` (see `appendFragment()`).
+static ProtobufStep protobufFields(
+    const vector<int>& path,
+    const function<void(google::protobuf::io::CodedOutputStream*)>& write)
+{
+  return [path, write](string* chunk) {
+    appendFragment(path, serializeFields(write), chunk);
+    return true;
+  };
+}
+
+
+// Returns a step which runs `steps` in order.
+static ProtobufStep protobufSequence(const vector<ProtobufStep>& steps)
+{
+  std::shared_ptr<std::deque<ProtobufStep>> remaining(
+      new std::deque<ProtobufStep>(steps.begin(), steps.end()));
+
+  return [remaining](string* chunk) {
+    while (!remaining->empty() && chunk->size() < STREAM_CHUNK_SIZE.bytes()) {
+      if (remaining->front()(chunk)) {
+        remaining->pop_front();
+      }
+    }
+
+    return remaining->empty();
+  };
+}
+
+
+// Returns a step which writes the fields written by `write` for each of
+// the entries of the container returned by `container`, wrapped into
+// the embedded message fields of `path`. Like for `jsonArray()`, the
+// container is walked across several chunks, it may be gone in a later
+// chunk, and `write` may return the step which writes the rest of the
+// fields of a large entry.
+template <typename Container>
+static ProtobufStep protobufRepeated(
+    const vector<int>& path,
+    const function<const Container*()>& container,
+    const function<Option<ProtobufStep>(
+        const typename Walk<Container>::Entry&,
+        google::protobuf::io::CodedOutputStream*)>& write)
+{
+  Walk<Container> walk;
+  Option<ProtobufStep> rest;
+
+  return [path, container, write, walk, rest](string* chunk) mutable {
+    if (rest.isSome()) {
+      if (!rest.get()(chunk)) {
+        return false;
+      }
+
+      rest = None();
+    }
+
+    const Container* entries = container();
+    bool done = true;
+
+    // NOTE: A fragment is appended even if there are no fields, so
+    // that the embedded messages are always present in the response.
+    appendFragment(
+        path,
+        serializeFields([&](google::protobuf::io::CodedOutputStream* writer) {
+          if (entries == nullptr) {
+            return;
+          }
+
+          typename Walk<Container>::Iterator entry = walk.resume(*entries);
+
+          while (entry != entries->end() && rest.isNone()) {
+            if (chunk->size() + writer->ByteCount() >=
+                  STREAM_CHUNK_SIZE.bytes()) {
+              done = false;
+              return;
+            }
+
+            walk.visit(*entry);
+            rest = write(*entry++, writer);
+          }
+
+          // The remaining entries are walked once the rest is written.
+          done = rest.isNone();
+        }),
+        chunk);
+
+    if (rest.isSome()) {
+      if (rest.get()(chunk)) {
+        rest = None();
+      }
+    }
+
+    return done;
+  };
+}
+
+
+// Returns an (unset) `OK` response along with the post-processing that
+// streams the following message as the response body:
+//
+//   mesos::master::Response response;
+//   response.set_type(type);
+//   <fields written by `steps`>
+//
+// Like for `streamJson()`, the body is produced in chunks.
+//
+// Since embedded messages are length-prefixed, an embedded message
+// cannot be written before its size is known. Rather than serializing
+// the embedded messages in full, the steps write them in fragments of
+// at most about `STREAM_CHUNK_SIZE` each, see `appendFragment()`.
+// This relies on protobuf parsers merging multiple occurrences of an
+// embedded message field, which concatenates their repeated fields.
+static pair<Response, Option<Master::ReadOnlyHandler::PostProcessing>>
+  streamProtobuf(
+      v1::master::Response::Type type,
+      const vector<ProtobufStep>& steps)
+{
+  OK response;
+  response.headers["Content-Type"] = stringify(ContentType::PROTOBUF);
+
+  struct State
+  {
+    ProtobufStep steps;
+    bool started;
+    bool done;
+  };
+
+  std::shared_ptr<State> state(new State());
+  state->steps = protobufSequence(steps);
+  state->started = false;
+  state->done = false;
+
+  Master::ReadOnlyHandler::PostProcessing::Stream stream;
+  stream.next = [state, type]() -> Option<string> {
+    if (state->done) {
+      return None();
+    }
+
+    string chunk;
+
+    if (!state->started) {
+      chunk = serializeFields(
+          [type](google::protobuf::io::CodedOutputStream* writer) {
+            WireFormatLite::WriteEnum(
+                mesos::v1::master::Response::kTypeFieldNumber, type, writer);
+          });
+
+      state->started = true;
+    }
+
+    state->done = state->steps(&chunk);
+
+    return chunk;
+  };
+
+  return pair<Response, Option<Master::ReadOnlyHandler::PostProcessing>>(
+      response,
+      Master::ReadOnlyHandler::PostProcessing{std::move(stream)});
+}
+
+
+// Returns the output of `steps` run to completion, for messages which
+// are not streamed (e.g., the `SUBSCRIBED` event).
+static string serializeSteps(const vector<ProtobufStep>& steps)
+{
+  ProtobufStep step = protobufSequence(steps);
+
+  string output;
+  string chunk;
+
+  while (!step(&chunk)) {
+    output += chunk;
+    chunk.clear();
+  }
+
+  output += chunk;
+
+  return output;
+}
+
+
+// Returns a step which writes the field `key` holding those tasks of
+// the framework returned by `lookup` in its member `tasks` (e.g., the
+// completed tasks) which are authorized.
+template <typename Tasks>
+static JsonStep jsonTasks(
+    const string& key,
+    const function<const Framework*()>& lookup,
+    Tasks Framework::*tasks,
+    const Owned<ObjectApprovers>& approvers)
+{
+  return jsonArray<Tasks>(
+      key,
+      frameworkMember(lookup, tasks),
+      [lookup, approvers](
+          const typename Walk<Tasks>::Entry& entry,
+          JsonOutput* writer) -> Option<JsonStep> {
+        const Task& task = walkTask(entry);
+
+        // Skip unauthorized tasks.
+        if (approvers->approved<VIEW_TASK>(task, lookup()->info)) {
+          writer->element(task);
+        }
+
+        return None();
+      });
+}
+
+
+// Writes the full representation of `framework` to support the `/state`
+// and `/frameworks` endpoints. Executors and tasks are filtered based on
+// whether the user is authorized to view them.
+//
+// A framework may have a large number of tasks, hence only the first
+// fields are written here, and the returned step writes the rest across
+// several chunks. It looks up the framework using `lookup`, and skips
+// the remaining fields once the framework is gone.
+//
+// TODO(bevers): Consider moving writers and other json-related
+// code into a separate file.
+static JsonStep jsonFullFramework(
+    const Framework& framework,
+    const function<const Framework*()>& lookup,
+    const Owned<ObjectApprovers>& approvers,
+    JsonOutput* writer)
+{
+  CHECK(writer->writer.StartObject());
+
+  jsonSummaryFields(writer, framework);
+
+  // Add additional fields to those generated by the
+  // `Summary<Framework>` overload.
+  writer->field("user", framework.info.user());
+  writer->field("failover_timeout", framework.info.failover_timeout());
+  writer->field("checkpoint", framework.info.checkpoint());
+  writer->field("registered_time", framework.registeredTime.secs());
+  writer->field("unregistered_time", framework.unregisteredTime.secs());
+
+  if (framework.info.has_principal()) {
+    writer->field("principal", framework.info.principal());
+  }
+
+  // TODO(bmahler): Consider deprecating this in favor of the split
+  // used and offered resources added in `Summary<Framework>`.
+  writer->field(
+      "resources",
+      framework.totalUsedResources + framework.totalOfferedResources);
+
+  // TODO(benh): Consider making reregisteredTime an Option.
+  if (framework.registeredTime != framework.reregisteredTime) {
+    writer->field("reregistered_time", framework.reregisteredTime.secs());
+  }
+
+  // For multi-role frameworks the `role` field will be unset.
+  // Note that we could set `roles` here for both cases, which
+  // would make tooling simpler (only need to look for `roles`).
+  // However, we opted to just mirror the protobuf akin to how
+  // generic protobuf -> JSON translation works.
+  if (framework.capabilities.multiRole) {
+    writer->field("roles", framework.info.roles());
+  } else {
+    writer->field("role", framework.info.role());
+  }
+
+  typedef decltype(Framework::executors) Executors;
+
+  return jsonSequence({
+    // Model all of the tasks associated with a framework.
+    jsonTasks("tasks", lookup, &Framework::tasks, approvers),
+    jsonTasks(
+        "unreachable_tasks", lookup, &Framework::unreachableTasks, approvers),
+    jsonTasks(
+        "completed_tasks", lookup, &Framework::completedTasks, approvers),
+
+    // Model all of the offers associated with a framework.
+    jsonFields([lookup](JsonOutput* writer) {
+      const Framework* framework = lookup();
+      if (framework == nullptr) {
+        return;
+      }
+
+      writer->field("offers", [framework](JSON::ArrayWriter* writer) {
+        foreach (Offer* offer, framework->offers) {
+          writer->element(*offer);
+        }
+      });
+    }),
+
+    // Model all of the executors of a framework, one agent at a time.
+    jsonArray<Executors>(
+        "executors",
+        frameworkMember(lookup, &Framework::executors),
+        [lookup, approvers](
+            const Walk<Executors>::Entry& executors,
+            JsonOutput* writer) -> Option<JsonStep> {
+          const Framework* framework = lookup();
+          const SlaveID& slaveId = executors.first;
+
+          foreachvalue (const ExecutorInfo& executor, executors.second) {
+            writer->element([&](JSON::ObjectWriter* writer) {
+              // Skip unauthorized executors.
+              if (!approvers->approved<VIEW_EXECUTOR>(
+                      executor, framework->info)) {
+                return;
+              }
+
+              json(writer, executor);
+              writer->field("slave_id", slaveId.value());
+            });
+          }
+
+          return None();
+        }),
+
+    jsonFields([lookup](JsonOutput* writer) {
+      const Framework* framework = lookup();
+
+      if (framework != nullptr) {
+        // Model all of the labels associated with a framework.
+        if (framework->info.has_labels()) {
+          writer->field("labels", framework->info.labels());
+        }
+
+        writer->field(
+            "offer_constraints",
+            JSON::Protobuf(framework->offerConstraints()));
+      }
+
+      CHECK(writer->writer.EndObject());
+    })
+  });
+}
+
+
+// Returns a step which writes the field `key` holding those of
+// `frameworks` (either the registered or the completed frameworks of
+// the master) that are authorized and accepted by `selectFrameworkId`.
+template <typename Frameworks>
+static JsonStep jsonFrameworks(
+    const string& key,
+    const Frameworks* frameworks,
+    const IDAcceptor<FrameworkID>& selectFrameworkId,
+    const Owned<ObjectApprovers>& approvers)
+{
+  return jsonArray<Frameworks>(
+      key,
+      [frameworks]() { return frameworks; },
+      [frameworks, selectFrameworkId, approvers](
+          const typename Walk<Frameworks>::Entry& entry,
+          JsonOutput* writer) -> Option<JsonStep> {
+        // Skip unauthorized frameworks or frameworks
+        // without a matching ID.
+        if (!selectFrameworkId.accept(entry.first) ||
+            !approvers->approved<VIEW_FRAMEWORK>(entry.second->info)) {
+          return None();
+        }
+
+        return jsonFullFramework(
+            *entry.second,
+            frameworkLookup(frameworks, entry.first),
+            approvers,
+            writer);
+      });
+}
+
+
+const Framework* Master::ReadOnlyHandler::findFramework(
+    const FrameworkID& frameworkId) const
+{
+  Option<Framework*> framework = master->frameworks.registered.get(frameworkId);
+  if (framework.isSome()) {
+    return framework.get();
+  }
+
+  Option<Owned<Framework>> completed =
+    master->frameworks.completed.get(frameworkId);
+
+  return completed.isSome() ? completed->get() : nullptr;
+}
+
+
+pair<Response, Option<Master::ReadOnlyHandler::PostProcessing>>
+  Master::ReadOnlyHandler::frameworks(
+      ContentType outputContentType,
+      const hashmap<std::string, std::string>& query,
+      const process::Owned<ObjectApprovers>& approvers) const
+{
+  CHECK_EQ(outputContentType, ContentType::JSON);
+
+  IDAcceptor<FrameworkID> selectFrameworkId(
+      query.get("framework_id"));
+
+  vector<JsonStep> steps = {
+    // Model all of the frameworks.
+    jsonFrameworks(
+        "frameworks",
+        &master->frameworks.registered,
+        selectFrameworkId,
+        approvers),
+
+    // Model all of the completed frameworks.
+    jsonFrameworks(
+        "completed_frameworks",
+        &master->frameworks.completed,
+        selectFrameworkId,
+        approvers),
+
+    // Unregistered frameworks are no longer possible. We emit an
+    // empty array for the sake of backward compatibility.
+    jsonFields([](JsonOutput* writer) {
+      writer->field("unregistered_frameworks", [](JSON::ArrayWriter*) {});
+    })
+  };
+
+  return streamJson(steps, query.get("jsonp"));
+}
+
+
+pair<Response, Option<Master::ReadOnlyHandler::PostProcessing>>
+  Master::ReadOnlyHandler::roles(
+      ContentType outputContentType,
+      const hashmap<std::string, std::string>& query,
+      const process::Owned<ObjectApprovers>& approvers) const
+{
+  CHECK_EQ(outputContentType, ContentType::JSON);
+
+  const Master* master = this->master;
+
+  const vector<string> knownRoles = master->knownRoles();
+
+  auto roles = [&](JSON::ObjectWriter* writer) {
+    writer->field(
+        "roles",
+        [&](JSON::ArrayWriter* writer) {
+          foreach (const string& name, knownRoles) {
+            if (!approvers->approved<VIEW_ROLE>(name)) {
+              continue;
+            }
+
+            writer->element([&](JSON::ObjectWriter* writer) {
+              writer->field("name", name);
+
+              writer->field(
+                  "weight",
+                  master->weights.get(name).getOrElse(DEFAULT_WEIGHT));
+
+              Option<Role*> role = master->roles.get(name);
+
+              RoleResourceBreakdown resourceBreakdown(master, name);
+
+              // Prior to Mesos 1.9, this field is filled based on
+              // `QuotaInfo` which is now deprecated. For backward
+              // compatibility reasons, we do not use any formatter
+              // for the new struct but construct the response by hand.
+              // Specifically:
+              //
+              //  - We keep the `role` field which was present in the
+              //    `QuotaInfo`.
+              //
+              //  - We name the field using singular `guarantee` and `limit`
+              //    which is different from the plural used in `QuotaConfig`.
+              const Quota quota = master->quotas.get(name).getOrElse(Quota());
+
+              writer->field("quota", [&](JSON::ObjectWriter* writer) {
+                writer->field("role", name);
+
+                writer->field("guarantee", quota.guarantees);
+                writer->field("limit", quota.limits);
+                writer->field("consumed", resourceBreakdown.consumedQuota());
+              });
+
+              ResourceQuantities allocated = resourceBreakdown.allocated();
+              ResourceQuantities offered = resourceBreakdown.offered();
+
+              // Deprecated by allocated, offered, reserved.
+              writer->field("resources", allocated + offered);
+
+              writer->field("allocated", allocated);
+              writer->field("offered", offered);
+              writer->field("reserved", resourceBreakdown.reserved());
+
+              if (role.isNone()) {
+                writer->field("frameworks", [](JSON::ArrayWriter*) {});
+              } else {
+                writer->field("frameworks", [&](JSON::ArrayWriter* writer) {
+                  foreachkey (const FrameworkID& id, (*role)->frameworks) {
+                    writer->element(id.value());
+                  }
+                });
+              }
+            });
+          }
+        });
+  };
+
+  return pair<Response, Option<Master::ReadOnlyHandler::PostProcessing>>(
+      OK(jsonify(roles), query.get("jsonp")),
+      None());
+}
+
+
+pair<Response, Option<Master::ReadOnlyHandler::PostProcessing>>
+  Master::ReadOnlyHandler::slaves(
+      ContentType outputContentType,
+      const hashmap<std::string, std::string>& query,
+      const process::Owned<ObjectApprovers>& approvers) const
+{
+  CHECK_EQ(outputContentType, ContentType::JSON);
+
+  IDAcceptor<SlaveID> selectSlaveId(query.get("slave_id"));
+
+  return pair<Response, Option<Master::ReadOnlyHandler::PostProcessing>>(
+      OK(jsonify(SlavesWriter(master->slaves, approvers, selectSlaveId)),
+         query.get("jsonp")),
+      None());
+}
+
+
+pair<Response, Option<Master::ReadOnlyHandler::PostProcessing>>
+  Master::ReadOnlyHandler::state(
+      ContentType outputContentType,
+      const hashmap<std::string, std::string>& query,
+      const process::Owned<ObjectApprovers>& approvers) const
+{
+  CHECK_EQ(outputContentType, ContentType::JSON);
+
+  // The body is streamed after this handler has returned, hence
+  // `approvers` is captured by value.
+  const Master* master = this->master;
+  auto calculateState = [master, approvers](JsonOutput* writer) {
+    writer->field("version", MESOS_VERSION);
+
+    if (build::GIT_SHA.isSome()) {
+      writer->field("git_sha", build::GIT_SHA.get());
+    }
+
+    if (build::GIT_BRANCH.isSome()) {
+      writer->field("git_branch", build::GIT_BRANCH.get());
+    }
+
+    if (build::GIT_TAG.isSome()) {
+      writer->field("git_tag", build::GIT_TAG.get());
+    }
+
+    writer->field("build_date", build::DATE);
+    writer->field("build_time", build::TIME);
+    writer->field("build_user", build::USER);
+    writer->field("start_time", master->startTime.secs());
+
+    if (master->electedTime.isSome()) {
+      writer->field("elected_time", master->electedTime->secs());
+    }
+
+    writer->field("id", master->info().id());
+    writer->field("pid", string(master->self()));
+    writer->field("hostname", master->info().hostname());
+    writer->field("capabilities", master->info().capabilities());
     writer->field("activated_slaves", master->_const_slaves_active());
     writer->field("deactivated_slaves", master->_const_slaves_inactive());
     writer->field("unreachable_slaves", master->_const_slaves_unreachable());
 
-    if (master->info().has_domain()) {
-      writer->field("domain", master->info().domain());
+    if (master->info().has_domain()) {
+      writer->field("domain", master->info().domain());
+    }
+
+    // TODO(haosdent): Deprecated this in favor of `leader_info` below.
+    if (master->leader.isSome()) {
+      writer->field("leader", master->leader->pid());
+    }
+
+    if (master->leader.isSome()) {
+      writer->field("leader_info", [master](JSON::ObjectWriter* writer) {
+        json(writer, master->leader.get());
+      });
+    }
+
+    if (approvers->approved<VIEW_FLAGS>()) {
+      if (master->flags.cluster.isSome()) {
+        writer->field("cluster", master->flags.cluster.get());
+      }
+
+      if (master->flags.log_dir.isSome()) {
+        writer->field("log_dir", master->flags.log_dir.get());
+      }
+
+      if (master->flags.external_log_file.isSome()) {
+        writer->field("external_log_file",
+                      master->flags.external_log_file.get());
+      }
+
+      writer->field("flags", [master](JSON::ObjectWriter* writer) {
+          foreachvalue (const flags::Flag& flag, master->flags) {
+            Option<string> value = flag.stringify(master->flags);
+            if (value.isSome()) {
+              writer->field(flag.effective_name().value, value.get());
+            }
+          }
+        });
+    }
+  };
+
+  vector<JsonStep> steps = {
+    jsonFields(calculateState),
+
+    // Model all of the registered slaves.
+    jsonArray<decltype(master->slaves.registered)>(
+        "slaves",
+        [master]() { return &master->slaves.registered; },
+        [master, approvers](
+            const pair<const SlaveID, Slave*>& slave,
+            JsonOutput* writer) -> Option<JsonStep> {
+          writer->element(SlaveWriter(
+              *slave.second,
+              master->slaves.draining.get(slave.first),
+              master->slaves.deactivated.contains(slave.first),
+              approvers));
+
+          return None();
+        }),
+
+    // Model all of the recovered slaves.
+    jsonArray<hashmap<SlaveID, SlaveInfo>>(
+        "recovered_slaves",
+        [master]() { return &master->slaves.recovered; },
+        [](const pair<const SlaveID, SlaveInfo>& slaveInfo,
+           JsonOutput* writer) -> Option<JsonStep> {
+          writer->element([&slaveInfo](JSON::ObjectWriter* writer) {
+            json(writer, slaveInfo.second);
+          });
+
+          return None();
+        }),
+
+    // Model all of the frameworks.
+    jsonFrameworks(
+        "frameworks",
+        &master->frameworks.registered,
+        IDAcceptor<FrameworkID>(),
+        approvers),
+
+    // Model all of the completed frameworks.
+    jsonFrameworks(
+        "completed_frameworks",
+        &master->frameworks.completed,
+        IDAcceptor<FrameworkID>(),
+        approvers),
+
+    jsonFields([](JsonOutput* writer) {
+      // Orphan tasks are no longer possible. We emit an empty array
+      // for the sake of backward compatibility.
+      writer->field("orphan_tasks", [](JSON::ArrayWriter*) {});
+
+      // Unregistered frameworks are no longer possible. We emit an
+      // empty array for the sake of backward compatibility.
+      writer->field("unregistered_frameworks", [](JSON::ArrayWriter*) {});
+    })
+  };
+
+  return streamJson(steps, query.get("jsonp"));
+}
+
+
+pair<Response, Option<Master::ReadOnlyHandler::PostProcessing>>
+  Master::ReadOnlyHandler::stateSummary(
+      ContentType outputContentType,
+      const hashmap<std::string, std::string>& query,
+      const process::Owned<ObjectApprovers>& approvers) const
+{
+  CHECK_EQ(outputContentType, ContentType::JSON);
+
+  const Master* master = this->master;
+  auto stateSummary = [master, &approvers](JSON::ObjectWriter* writer) {
+    writer->field("hostname", master->info().hostname());
+
+    if (master->flags.cluster.isSome()) {
+      writer->field("cluster", master->flags.cluster.get());
+    }
+
+    // We use the tasks in the 'Frameworks' struct to compute summaries
+    // for this endpoint. This is done 1) for consistency between the
+    // 'slaves' and 'frameworks' subsections below 2) because we want to
+    // provide summary information for frameworks that are currently
+    // registered 3) the frameworks keep a circular buffer of completed
+    // tasks that we can use to keep a limited view on the history of
+    // recent completed / failed tasks.
+
+    // Generate mappings from 'slave' to 'framework' and reverse.
+    SlaveFrameworkMapping slaveFrameworkMapping(
+        master->frameworks.registered);
+
+    // Generate 'TaskState' summaries for all framework and slave ids.
+    TaskStateSummaries taskStateSummaries(
+        master->frameworks.registered);
+
+    // Model all of the slaves.
+    writer->field(
+        "slaves",
+        [master,
+         &slaveFrameworkMapping,
+         &taskStateSummaries,
+         &approvers](JSON::ArrayWriter* writer) {
+          foreachvalue (Slave* slave, master->slaves.registered) {
+            writer->element(
+                [&slave,
+                 &master,
+                 &slaveFrameworkMapping,
+                 &taskStateSummaries,
+                 &approvers](JSON::ObjectWriter* writer) {
+                  SlaveWriter slaveWriter(
+                      *slave,
+                      master->slaves.draining.get(slave->id),
+                      master->slaves.deactivated.contains(slave->id),
+                      approvers);
+                  slaveWriter(writer);
+
+                  // Add the 'TaskState' summary for this slave.
+                  const TaskStateSummary& summary =
+                      taskStateSummaries.slave(slave->id);
+
+                  // Certain per-agent status totals will always be zero
+                  // (e.g., TASK_ERROR, TASK_UNREACHABLE). We report
+                  // them here anyway, for completeness.
+                  //
+                  // TODO(neilc): Update for TASK_GONE and
+                  // TASK_GONE_BY_OPERATOR.
+                  writer->field("TASK_STAGING", summary.staging);
+                  writer->field("TASK_STARTING", summary.starting);
+                  writer->field("TASK_RUNNING", summary.running);
+                  writer->field("TASK_KILLING", summary.killing);
+                  writer->field("TASK_FINISHED", summary.finished);
+                  writer->field("TASK_KILLED", summary.killed);
+                  writer->field("TASK_FAILED", summary.failed);
+                  writer->field("TASK_LOST", summary.lost);
+                  writer->field("TASK_ERROR", summary.error);
+                  writer->field(
+                      "TASK_UNREACHABLE",
+                      summary.unreachable);
+
+                  // Add the ids of all the frameworks running on this
+                  // slave.
+                  const hashset<FrameworkID>& frameworks =
+                      slaveFrameworkMapping.frameworks(slave->id);
+
+                  writer->field(
+                      "framework_ids",
+                      [&frameworks](JSON::ArrayWriter* writer) {
+                        foreach (
+                            const FrameworkID& frameworkId,
+                            frameworks) {
+                          writer->element(frameworkId.value());
+                        }
+                      });
+                });
+          }
+        });
+
+    // Model all of the frameworks.
+    writer->field(
+        "frameworks",
+        [master,
+         &slaveFrameworkMapping,
+         &taskStateSummaries,
+         &approvers](JSON::ArrayWriter* writer) {
+          foreachpair (const FrameworkID& frameworkId,
+                       Framework* framework,
+                       master->frameworks.registered) {
+            // Skip unauthorized frameworks.
+            if (!approvers->approved<VIEW_FRAMEWORK>(framework->info)) {
+              continue;
+            }
+
+            writer->element(
+                [&frameworkId,
+                 &framework,
+                 &slaveFrameworkMapping,
+                 &taskStateSummaries](JSON::ObjectWriter* writer) {
+                  json(writer, Summary<Framework>(*framework));
+
+                  // Add the 'TaskState' summary for this framework.
+                  const TaskStateSummary& summary =
+                      taskStateSummaries.framework(frameworkId);
+
+                  // TODO(neilc): Update for TASK_GONE and
+                  // TASK_GONE_BY_OPERATOR.
+                  writer->field("TASK_STAGING", summary.staging);
+                  writer->field("TASK_STARTING", summary.starting);
+                  writer->field("TASK_RUNNING", summary.running);
+                  writer->field("TASK_KILLING", summary.killing);
+                  writer->field("TASK_FINISHED", summary.finished);
+                  writer->field("TASK_KILLED", summary.killed);
+                  writer->field("TASK_FAILED", summary.failed);
+                  writer->field("TASK_LOST", summary.lost);
+                  writer->field("TASK_ERROR", summary.error);
+                  writer->field(
+                      "TASK_UNREACHABLE",
+                      summary.unreachable);
+
+                  // Add the ids of all the slaves running
+                  // this framework.
+                  const hashset<SlaveID>& slaves =
+                      slaveFrameworkMapping.slaves(frameworkId);
+
+                  writer->field(
+                      "slave_ids",
+                      [&slaves](JSON::ArrayWriter* writer) {
+                        foreach (const SlaveID& slaveId, slaves) {
+                          writer->element(slaveId.value());
+                        }
+                      });
+                });
+          }
+        });
+    };
+
+  return pair<Response, Option<Master::ReadOnlyHandler::PostProcessing>>(
+      OK(jsonify(stateSummary), query.get("jsonp")),
+      None());
+}
+
+
+struct TaskComparator
+{
+  static bool ascending(const Task* lhs, const Task* rhs)
+  {
+    size_t lhsSize = lhs->statuses().size();
+    size_t rhsSize = rhs->statuses().size();
+
+    if ((lhsSize == 0) && (rhsSize == 0)) {
+      return false;
+    }
+
+    if (lhsSize == 0) {
+      return true;
+    }
+
+    if (rhsSize == 0) {
+      return false;
+    }
+
+    return (lhs->statuses(0).timestamp() < rhs->statuses(0).timestamp());
+  }
+
+  static bool descending(const Task* lhs, const Task* rhs)
+  {
+    size_t lhsSize = lhs->statuses().size();
+    size_t rhsSize = rhs->statuses().size();
+
+    if ((lhsSize == 0) && (rhsSize == 0)) {
+      return false;
+    }
+
+    if (rhsSize == 0) {
+      return true;
+    }
+
+    if (lhsSize == 0) {
+      return false;
+    }
+
+    return (lhs->statuses(0).timestamp() > rhs->statuses(0).timestamp());
+  }
+};
+
+
+// Returns the active, unreachable or completed task of `framework`
+// with the given ID, if any.
+static const Task* findTask(const Framework& framework, const TaskID& taskId)
+{
+  Option<Task*> task = framework.tasks.get(taskId);
+  if (task.isSome()) {
+    return task.get();
+  }
+
+  Option<Owned<Task>> unreachable = framework.unreachableTasks.get(taskId);
+  if (unreachable.isSome()) {
+    return unreachable->get();
+  }
+
+  foreach (const Owned<Task>& completed, framework.completedTasks) {
+    if (completed->task_id() == taskId) {
+      return completed.get();
+    }
+  }
+
+  return nullptr;
+}
+
+
+pair<Response, Option<Master::ReadOnlyHandler::PostProcessing>>
+  Master::ReadOnlyHandler::tasks(
+      ContentType outputContentType,
+      const hashmap<std::string, std::string>& query,
+      const process::Owned<ObjectApprovers>& approvers) const
+{
+  CHECK_EQ(outputContentType, ContentType::JSON);
+
+  // Get list options (limit and offset).
+  Result<int> result = numify<int>(query.get("limit"));
+  size_t limit = result.isSome() ? result.get() : TASK_LIMIT;
+
+  result = numify<int>(query.get("offset"));
+  size_t offset = result.isSome() ? result.get() : 0;
+
+  Option<string> order = query.get("order");
+  string _order = order.isSome() && (order.get() == "asc") ? "asc" : "des";
+
+  Option<string> frameworkId = query.get("framework_id");
+  Option<string> taskId = query.get("task_id");
+
+  IDAcceptor<FrameworkID> selectFrameworkId(frameworkId);
+  IDAcceptor<TaskID> selectTaskId(taskId);
+
+  // Construct framework list with both active and completed frameworks.
+  vector<const Framework*> frameworks;
+  foreachvalue (const Framework* framework, master->frameworks.registered) {
+    // Skip unauthorized frameworks or frameworks without matching
+    // framework ID.
+    if (!selectFrameworkId.accept(framework->id()) ||
+        !approvers->approved<VIEW_FRAMEWORK>(framework->info)) {
+      continue;
+    }
+
+    frameworks.push_back(framework);
+  }
+
+  foreachvalue (const Owned<Framework>& framework,
+                master->frameworks.completed) {
+    // Skip unauthorized frameworks or frameworks without matching
+    // framework ID.
+    if (!selectFrameworkId.accept(framework->id()) ||
+        !approvers->approved<VIEW_FRAMEWORK>(framework->info)) {
+     continue;
+    }
+
+    frameworks.push_back(framework.get());
+  }
+
+  // Construct task list with both running,
+  // completed and unreachable tasks.
+  vector<const Task*> tasks;
+  foreach (const Framework* framework, frameworks) {
+    foreachvalue (Task* task, framework->tasks) {
+      // Skip unauthorized tasks or tasks without matching task ID.
+      if (!selectTaskId.accept(task->task_id()) ||
+          !approvers->approved<VIEW_TASK>(*task, framework->info)) {
+        continue;
+      }
+
+      tasks.push_back(task);
     }
 
-    // TODO(haosdent): Deprecated this in favor of `leader_info` below.
-    if (master->leader.isSome()) {
-      writer->field("leader", master->leader->pid());
-    }
+    foreachvalue (
+        const Owned<Task>& task,
+        framework->unreachableTasks) {
+      // Skip unauthorized tasks or tasks without matching task ID.
+      if (!selectTaskId.accept(task->task_id()) ||
+          !approvers->approved<VIEW_TASK>(*task, framework->info)) {
+        continue;
+      }
 
-    if (master->leader.isSome()) {
-      writer->field("leader_info", [master](JSON::ObjectWriter* writer) {
-        json(writer, master->leader.get());
-      });
+      tasks.push_back(task.get());
     }
 
-    if (approvers->approved<VIEW_FLAGS>()) {
-      if (master->flags.cluster.isSome()) {
-        writer->field("cluster", master->flags.cluster.get());
+    foreach (const Owned<Task>& task, framework->completedTasks) {
+      // Skip unauthorized tasks or tasks without matching task ID.
+      if (!selectTaskId.accept(task->task_id()) ||
+          !approvers->approved<VIEW_TASK>(*task, framework->info)) {
+        continue;
       }
 
-      if (master->flags.log_dir.isSome()) {
-        writer->field("log_dir", master->flags.log_dir.get());
+      tasks.push_back(task.get());
+    }
+  }
+
+  // Sort tasks by task status timestamp. Default order is descending.
+  // The earliest timestamp is chosen for comparison when
+  // multiple are present.
+  if (_order == "asc") {
+    sort(tasks.begin(), tasks.end(), TaskComparator::ascending);
+  } else {
+    sort(tasks.begin(), tasks.end(), TaskComparator::descending);
+  }
+
+  // Collect 'limit' number of tasks starting from 'offset'. The tasks
+  // are written after this handler has returned, across several turns
+  // of the master actor, hence they are looked up again by their IDs.
+  vector<pair<FrameworkID, TaskID>> taskIds;
+  for (size_t i = offset; i < std::min(offset + limit, tasks.size()); i++) {
+    taskIds.emplace_back(tasks[i]->framework_id(), tasks[i]->task_id());
+  }
+
+  bool started = false;
+  size_t index = 0;
+
+  vector<JsonStep> steps = {
+    [this, taskIds, started, index](JsonOutput* writer) mutable {
+      if (!started) {
+        CHECK(writer->writer.Key("tasks"));
+        CHECK(writer->writer.StartArray());
+        started = true;
       }
 
-      if (master->flags.external_log_file.isSome()) {
-        writer->field("external_log_file",
-                      master->flags.external_log_file.get());
+      while (index < taskIds.size()) {
+        if (writer->full()) {
+          return false;
+        }
+
+        const pair<FrameworkID, TaskID>& taskId = taskIds[index++];
+
+        const Framework* framework = findFramework(taskId.first);
+        const Task* task = framework != nullptr
+          ? findTask(*framework, taskId.second)
+          : nullptr;
+
+        if (task != nullptr) {
+          writer->element(*task);
+        }
       }
 
-      writer->field("flags", [master](JSON::ObjectWriter* writer) {
-          foreachvalue (const flags::Flag& flag, master->flags) {
-            Option<string> value = flag.stringify(master->flags);
-            if (value.isSome()) {
-              writer->field(flag.effective_name().value, value.get());
-            }
-          }
-        });
+      CHECK(writer->writer.EndArray());
+      return true;
     }
+  };
 
-    // Model all of the registered slaves.
+  return streamJson(steps, query.get("jsonp"));
+}
+
+
+function<void(JSON::ObjectWriter*)> Master::ReadOnlyHandler::jsonifyGetAgents(
+    const Owned<ObjectApprovers>& approvers) const
+{
+  // Serialize the following:
+  //
+  //   mesos::master::Response::GetAgents getAgents;
+  //   for each registered agent:
+  //     *getAgents.add_agents() = protobuf::master::event::createAgentResponse(
+  //         agent,
+  //         master->slaves.draining.get(slave->id),
+  //         master->slaves.deactivated.contains(slave->id),
+  //         approvers);
+  //   for each recovered agent:
+  //     SlaveInfo* agent = getAgents.add_recovered_agents();
+  //     agent->CopyFrom(slaveInfo);
+  //     agent->clear_resources();
+  //     foreach (const Resource& resource, slaveInfo.resources()):
+  //       if (approvers->approved<VIEW_ROLE>(resource)):
+  //         *agent->add_resources() = resource;
+
+  // TODO(bmahler): This copies the Owned object approvers.
+  return [=](JSON::ObjectWriter* writer) {
+    const google::protobuf::Descriptor* descriptor =
+      v1::master::Response::GetAgents::descriptor();
+
+    int field;
+
+    field = v1::master::Response::GetAgents::kAgentsFieldNumber;
     writer->field(
-        "slaves",
-        [master, &approvers](JSON::ArrayWriter* writer) {
-          foreachvalue (Slave* slave, master->slaves.registered) {
-            writer->element(SlaveWriter(
+        descriptor->FindFieldByNumber(field)->name(),
+        [&](JSON::ArrayWriter* writer) {
+      foreachvalue (const Slave* slave, master->slaves.registered) {
+        // TODO(bmahler): Consider not constructing the temporary
+        // agent object and instead serialize directly.
+        mesos::master::Response::GetAgents::Agent agent =
+            protobuf::master::event::createAgentResponse(
                 *slave,
                 master->slaves.draining.get(slave->id),
                 master->slaves.deactivated.contains(slave->id),
-                approvers));
-          }
-        });
+                approvers);
 
-    // Model all of the recovered slaves.
+        writer->element(asV1Protobuf(agent));
+      }
+    });
+
+    field = v1::master::Response::GetAgents::kRecoveredAgentsFieldNumber;
     writer->field(
-        "recovered_slaves",
-        [master](JSON::ArrayWriter* writer) {
-          foreachvalue (
-              const SlaveInfo& slaveInfo, master->slaves.recovered) {
-            writer->element([&slaveInfo](JSON::ObjectWriter* writer) {
-              json(writer, slaveInfo);
-            });
+        descriptor->FindFieldByNumber(field)->name(),
+        [&](JSON::ArrayWriter* writer) {
+      foreachvalue (const SlaveInfo& slaveInfo, master->slaves.recovered) {
+        // TODO(bmahler): Consider not constructing the temporary
+        // SlaveInfo object and instead serialize directly.
+        SlaveInfo agent = slaveInfo;
+        agent.clear_resources();
+        foreach (const Resource& resource, slaveInfo.resources()) {
+          if (approvers->approved<VIEW_ROLE>(resource)) {
+            *agent.add_resources() = resource;
           }
-        });
+        }
 
-    // Model all of the frameworks.
-    writer->field(
-        "frameworks",
-        [master, &approvers](JSON::ArrayWriter* writer) {
-          foreachvalue (
-              Framework* framework, master->frameworks.registered) {
-            // Skip unauthorized frameworks.
-            if (!approvers->approved<VIEW_FRAMEWORK>(framework->info)) {
-              continue;
-            }
+        writer->element(asV1Protobuf(agent));
+      }
+    });
+  };
+}
 
-            writer->element(FullFrameworkWriter(approvers, framework));
-          }
-        });
 
-    // Model all of the completed frameworks.
-    writer->field(
-        "completed_frameworks",
-        [master, &approvers](JSON::ArrayWriter* writer) {
-          foreachvalue (
-              const Owned<Framework>& framework,
-              master->frameworks.completed) {
-            // Skip unauthorized frameworks.
-            if (!approvers->approved<VIEW_FRAMEWORK>(framework->info)) {
-              continue;
-            }
+vector<ProtobufStep> Master::ReadOnlyHandler::serializeGetAgents(
+    const Owned<ObjectApprovers>& approvers,
+    const vector<int>& path) const
+{
+  // Serialize the following:
+  //
+  //   mesos::master::Response::GetAgents getAgents;
+  //   for each registered agent:
+  //     *getAgents.add_agents() = protobuf::master::event::createAgentResponse(
+  //         agent,
+  //         master->slaves.draining.get(slave->id),
+  //         master->slaves.deactivated.contains(slave->id),
+  //         approvers);
+  //   for each recovered agent:
+  //     SlaveInfo* agent = getAgents.add_recovered_agents();
+  //     agent->CopyFrom(slaveInfo);
+  //     agent->clear_resources();
+  //     foreach (const Resource& resource, slaveInfo.resources()):
+  //       if (approvers->approved<VIEW_ROLE>(resource)):
+  //         *agent->add_resources() = resource;
 
-            writer->element(
-                FullFrameworkWriter(approvers, framework.get()));
+  const Master* master = this->master;
+
+  return {
+    protobufRepeated<decltype(master->slaves.registered)>(
+        path,
+        [master]() { return &master->slaves.registered; },
+        [master, approvers](
+            const pair<const SlaveID, Slave*>& slave,
+            google::protobuf::io::CodedOutputStream* writer)
+              -> Option<ProtobufStep> {
+          // TODO(bmahler): Consider not constructing the temporary
+          // agent object and instead serialize directly.
+          WireFormatLite2::WriteMessageWithoutCachedSizes(
+              mesos::master::Response::GetAgents::kAgentsFieldNumber,
+              protobuf::master::event::createAgentResponse(
+                  *slave.second,
+                  master->slaves.draining.get(slave.first),
+                  master->slaves.deactivated.contains(slave.first),
+                  approvers),
+              writer);
+
+          return None();
+        }),
+
+    protobufRepeated<hashmap<SlaveID, SlaveInfo>>(
+        path,
+        [master]() { return &master->slaves.recovered; },
+        [approvers](
+            const pair<const SlaveID, SlaveInfo>& slaveInfo,
+            google::protobuf::io::CodedOutputStream* writer)
+              -> Option<ProtobufStep> {
+          // TODO(bmahler): Consider not constructing the temporary
+          // SlaveInfo object and instead serialize directly.
+          SlaveInfo agent = slaveInfo.second;
+          agent.clear_resources();
+          foreach (const Resource& resource, slaveInfo.second.resources()) {
+            if (approvers->approved<VIEW_ROLE>(resource)) {
+              *agent.add_resources() = resource;
+            }
           }
-        });
 
-    // Orphan tasks are no longer possible. We emit an empty array
-    // for the sake of backward compatibility.
-    writer->field("orphan_tasks", [](JSON::ArrayWriter*) {});
+          WireFormatLite2::WriteMessageWithoutCachedSizes(
+              mesos::master::Response::GetAgents::kRecoveredAgentsFieldNumber,
+              agent,
+              writer);
 
-    // Unregistered frameworks are no longer possible. We emit an
-    // empty array for the sake of backward compatibility.
-    writer->field("unregistered_frameworks", [](JSON::ArrayWriter*) {});
+          return None();
+        })
   };
-
-  return pair<Response, Option<Master::ReadOnlyHandler::PostProcessing>>(
-      OK(jsonify(calculateState), query.get("jsonp")),
-      None());
 }
 
 
 pair<Response, Option<Master::ReadOnlyHandler::PostProcessing>>
-  Master::ReadOnlyHandler::stateSummary(
+  Master::ReadOnlyHandler::getAgents(
       ContentType outputContentType,
       const hashmap<std::string, std::string>& query,
       const process::Owned<ObjectApprovers>& approvers) const
 {
-  CHECK_EQ(outputContentType, ContentType::JSON);
-
-  const Master* master = this->master;
-  auto stateSummary = [master, &approvers](JSON::ObjectWriter* writer) {
-    writer->field("hostname", master->info().hostname());
+  // Serialize the following message:
+  //
+  //   mesos::master::Response response;
+  //   response.set_type(mesos::master::Response::GET_AGENTS);
+  //   *response.mutable_get_agents() = _getAgents(approvers);
 
-    if (master->flags.cluster.isSome()) {
-      writer->field("cluster", master->flags.cluster.get());
+  switch (outputContentType) {
+    case ContentType::PROTOBUF: {
+      return streamProtobuf(
+          mesos::v1::master::Response::GET_AGENTS,
+          serializeGetAgents(
+              approvers,
+              {mesos::v1::master::Response::kGetAgentsFieldNumber}));
     }
 
-    // We use the tasks in the 'Frameworks' struct to compute summaries
-    // for this endpoint. This is done 1) for consistency between the
-    // 'slaves' and 'frameworks' subsections below 2) because we want to
-    // provide summary information for frameworks that are currently
-    // registered 3) the frameworks keep a circular buffer of completed
-    // tasks that we can use to keep a limited view on the history of
-    // recent completed / failed tasks.
+    case ContentType::JSON: {
+      string body = jsonify([&](JSON::ObjectWriter* writer) {
+        const google::protobuf::Descriptor* descriptor =
+          v1::master::Response::descriptor();
 
-    // Generate mappings from 'slave' to 'framework' and reverse.
-    SlaveFrameworkMapping slaveFrameworkMapping(
-        master->frameworks.registered);
+        int field;
 
-    // Generate 'TaskState' summaries for all framework and slave ids.
-    TaskStateSummaries taskStateSummaries(
-        master->frameworks.registered);
+        field = v1::master::Response::kTypeFieldNumber;
+        writer->field(
+            descriptor->FindFieldByNumber(field)->name(),
+            v1::master::Response::Type_Name(
+                v1::master::Response::GET_AGENTS));
+
+        field = v1::master::Response::kGetAgentsFieldNumber;
+        writer->field(
+            descriptor->FindFieldByNumber(field)->name(),
+            jsonifyGetAgents(approvers));
+      });
+
+      // TODO(bmahler): Pass jsonp query parameter through here.
+      return pair<Response, Option<Master::ReadOnlyHandler::PostProcessing>>(
+          OK(std::move(body), stringify(outputContentType)),
+          None());
+    }
+
+    default:
+      return pair<Response, Option<Master::ReadOnlyHandler::PostProcessing>>(
+          NotAcceptable("Request must accept json or protobuf"), None());
+  }
+}
 
-    // Model all of the slaves.
-    writer->field(
-        "slaves",
-        [master,
-         &slaveFrameworkMapping,
-         &taskStateSummaries,
-         &approvers](JSON::ArrayWriter* writer) {
-          foreachvalue (Slave* slave, master->slaves.registered) {
-            writer->element(
-                [&slave,
-                 &master,
-                 &slaveFrameworkMapping,
-                 &taskStateSummaries,
-                 &approvers](JSON::ObjectWriter* writer) {
-                  SlaveWriter slaveWriter(
-                      *slave,
-                      master->slaves.draining.get(slave->id),
-                      master->slaves.deactivated.contains(slave->id),
-                      approvers);
-                  slaveWriter(writer);
 
-                  // Add the 'TaskState' summary for this slave.
-                  const TaskStateSummary& summary =
-                      taskStateSummaries.slave(slave->id);
+// Translates a field mask given in terms of the v1 message `from` into
+// the field names of the corresponding (wire compatible) v0 message
+// `to`, e.g. "agent_id" of `v1::Task` into "slave_id" of `Task`.
+//
+// The required fields of the messages along each path are always
+// included, so that the projected messages remain initialized.
+static Try<google::protobuf::FieldMask> devolve(
+    const google::protobuf::FieldMask& mask,
+    const google::protobuf::Descriptor* from,
+    const google::protobuf::Descriptor* to)
+{
+  using google::protobuf::Descriptor;
+  using google::protobuf::FieldDescriptor;
+  using google::protobuf::util::FieldMaskUtil;
+
+  std::set<string> paths;
+
+  // Adds the required fields of `descriptor` under `prefix`.
+  auto addRequired = [&paths](
+      const Descriptor* descriptor, const string& prefix) {
+    for (int i = 0; i < descriptor->field_count(); ++i) {
+      if (descriptor->field(i)->is_required()) {
+        paths.insert(prefix + descriptor->field(i)->name());
+      }
+    }
+  };
 
-                  // Certain per-agent status totals will always be zero
-                  // (e.g., TASK_ERROR, TASK_UNREACHABLE). We report
-                  // them here anyway, for completeness.
-                  //
-                  // TODO(neilc): Update for TASK_GONE and
-                  // TASK_GONE_BY_OPERATOR.
-                  writer->field("TASK_STAGING", summary.staging);
-                  writer->field("TASK_STARTING", summary.starting);
-                  writer->field("TASK_RUNNING", summary.running);
-                  writer->field("TASK_KILLING", summary.killing);
-                  writer->field("TASK_FINISHED", summary.finished);
-                  writer->field("TASK_KILLED", summary.killed);
-                  writer->field("TASK_FAILED", summary.failed);
-                  writer->field("TASK_LOST", summary.lost);
-                  writer->field("TASK_ERROR", summary.error);
-                  writer->field(
-                      "TASK_UNREACHABLE",
-                      summary.unreachable);
+  addRequired(to, "");
 
-                  // Add the ids of all the frameworks running on this
-                  // slave.
-                  const hashset<FrameworkID>& frameworks =
-                      slaveFrameworkMapping.frameworks(slave->id);
+  foreach (const string& path, mask.paths()) {
+    vector<const FieldDescriptor*> fields;
+    if (!FieldMaskUtil::GetFieldDescriptors(from, path, &fields)) {
+      return Error(
+          "Invalid path '" + path + "' for '" + from->full_name() + "'");
+    }
 
-                  writer->field(
-                      "framework_ids",
-                      [&frameworks](JSON::ArrayWriter* writer) {
-                        foreach (
-                            const FrameworkID& frameworkId,
-                            frameworks) {
-                          writer->element(frameworkId.value());
-                        }
-                      });
-                });
-          }
-        });
+    const Descriptor* descriptor = to;
+    string devolved;
 
-    // Model all of the frameworks.
-    writer->field(
-        "frameworks",
-        [master,
-         &slaveFrameworkMapping,
-         &taskStateSummaries,
-         &approvers](JSON::ArrayWriter* writer) {
-          foreachpair (const FrameworkID& frameworkId,
-                       Framework* framework,
-                       master->frameworks.registered) {
-            // Skip unauthorized frameworks.
-            if (!approvers->approved<VIEW_FRAMEWORK>(framework->info)) {
-              continue;
-            }
+    foreach (const FieldDescriptor* field, fields) {
+      // Sub-fields are only valid for singular message fields.
+      CHECK_NOTNULL(descriptor);
 
-            writer->element(
-                [&frameworkId,
-                 &framework,
-                 &slaveFrameworkMapping,
-                 &taskStateSummaries](JSON::ObjectWriter* writer) {
-                  json(writer, Summary<Framework>(*framework));
+      const FieldDescriptor* devolvedField =
+        descriptor->FindFieldByNumber(field->number());
 
-                  // Add the 'TaskState' summary for this framework.
-                  const TaskStateSummary& summary =
-                      taskStateSummaries.framework(frameworkId);
+      if (devolvedField == nullptr) {
+        return Error(
+            "Field '" + field->full_name() + "' is not supported here");
+      }
 
-                  // TODO(neilc): Update for TASK_GONE and
-                  // TASK_GONE_BY_OPERATOR.
-                  writer->field("TASK_STAGING", summary.staging);
-                  writer->field("TASK_STARTING", summary.starting);
-                  writer->field("TASK_RUNNING", summary.running);
-                  writer->field("TASK_KILLING", summary.killing);
-                  writer->field("TASK_FINISHED", summary.finished);
-                  writer->field("TASK_KILLED", summary.killed);
-                  writer->field("TASK_FAILED", summary.failed);
-                  writer->field("TASK_LOST", summary.lost);
-                  writer->field("TASK_ERROR", summary.error);
-                  writer->field(
-                      "TASK_UNREACHABLE",
-                      summary.unreachable);
+      if (!devolved.empty()) {
+        addRequired(descriptor, devolved + ".");
+        devolved += ".";
+      }
 
-                  // Add the ids of all the slaves running
-                  // this framework.
-                  const hashset<SlaveID>& slaves =
-                      slaveFrameworkMapping.slaves(frameworkId);
+      devolved += devolvedField->name();
+      descriptor = devolvedField->message_type();
+    }
 
-                  writer->field(
-                      "slave_ids",
-                      [&slaves](JSON::ArrayWriter* writer) {
-                        foreach (const SlaveID& slaveId, slaves) {
-                          writer->element(slaveId.value());
-                        }
-                      });
-                });
-          }
-        });
-    };
+    paths.insert(devolved);
+  }
 
-  return pair<Response, Option<Master::ReadOnlyHandler::PostProcessing>>(
-      OK(jsonify(stateSummary), query.get("jsonp")),
-      None());
+  google::protobuf::FieldMask result;
+  foreach (const string& path, paths) {
+    result.add_paths(path);
+  }
+
+  return result;
 }
 
 
-struct TaskComparator
+// Returns `message` restricted to the fields of `mask` (if any),
+// using `scratch` to hold the projected message.
+template <typename T>
+static const T& applyFieldMask(
+    const T& message,
+    const Option<google::protobuf::FieldMask>& mask,
+    T* scratch)
 {
-  static bool ascending(const Task* lhs, const Task* rhs)
+  if (mask.isNone()) {
+    return message;
+  }
+
+  scratch->Clear();
+
+  google::protobuf::util::FieldMaskUtil::MergeMessageTo(
+      message,
+      mask.get(),
+      google::protobuf::util::FieldMaskUtil::MergeOptions(),
+      scratch);
+
+  return *scratch;
+}
+
+
+class Master::ReadOnlyHandler::TaskSelector
+{
+public:
+  // The kinds of tasks, in the order in which they are paginated.
+  enum Kind
   {
-    size_t lhsSize = lhs->statuses().size();
-    size_t rhsSize = rhs->statuses().size();
+    ACTIVE = 0,
+    UNREACHABLE = 1,
+    COMPLETED = 2
+  };
 
-    if ((lhsSize == 0) && (rhsSize == 0)) {
-      return false;
-    }
+  struct Selection
+  {
+    // The tasks to be returned, by kind.
+    vector<const Task*> tasks[3];
 
-    if (lhsSize == 0) {
-      return true;
+    Option<string> nextCursor;
+  };
+
+  static Try<TaskSelector> create(const mesos::master::Call::GetTasks& call)
+  {
+    TaskSelector selector;
+
+    foreach (const FrameworkID& frameworkId, call.framework_ids()) {
+      selector.frameworkIds.insert(frameworkId);
     }
 
-    if (rhsSize == 0) {
-      return false;
+    foreach (const SlaveID& agentId, call.agent_ids()) {
+      selector.agentIds.insert(agentId);
     }
 
-    return (lhs->statuses(0).timestamp() < rhs->statuses(0).timestamp());
-  }
+    foreach (int state, call.states()) {
+      selector.states.insert(static_cast<TaskState>(state));
+    }
 
-  static bool descending(const Task* lhs, const Task* rhs)
-  {
-    size_t lhsSize = lhs->statuses().size();
-    size_t rhsSize = rhs->statuses().size();
+    if (call.has_limit()) {
+      if (call.limit() == 0) {
+        return Error("'limit' must be positive");
+      }
 
-    if ((lhsSize == 0) && (rhsSize == 0)) {
-      return false;
+      selector.limit = call.limit();
     }
 
-    if (rhsSize == 0) {
-      return true;
+    if (call.has_cursor()) {
+      Try<string> decoded = base64::decode(call.cursor());
+      if (decoded.isError()) {
+        return Error("Invalid cursor: " + decoded.error());
+      }
+
+      vector<string> tokens = strings::split(decoded.get(), "\n", 3);
+      Try<int> kind = tokens.size() == 3
+        ? numify<int>(tokens[0])
+        : Try<int>(Error("Expected 3 tokens"));
+
+      if (kind.isError() || kind.get() < ACTIVE || kind.get() > COMPLETED) {
+        return Error("Invalid cursor '" + call.cursor() + "'");
+      }
+
+      selector.cursor = Cursor{kind.get(), tokens[1], tokens[2]};
     }
 
-    if (lhsSize == 0) {
-      return false;
+    if (call.has_field_mask()) {
+      Try<google::protobuf::FieldMask> fieldMask = devolve(
+          call.field_mask(), v1::Task::descriptor(), Task::descriptor());
+
+      if (fieldMask.isError()) {
+        return Error("Invalid field mask: " + fieldMask.error());
+      }
+
+      selector.fieldMask = fieldMask.get();
     }
 
-    return (lhs->statuses(0).timestamp() > rhs->statuses(0).timestamp());
+    return selector;
   }
-};
 
+  // The position of a task in the order of pagination.
+  struct Cursor
+  {
+    int kind;
+    string frameworkId;
+    string taskId;
+  };
 
-pair<Response, Option<Master::ReadOnlyHandler::PostProcessing>>
-  Master::ReadOnlyHandler::tasks(
-      ContentType outputContentType,
-      const hashmap<std::string, std::string>& query,
-      const process::Owned<ObjectApprovers>& approvers) const
-{
-  CHECK_EQ(outputContentType, ContentType::JSON);
+  // The next tasks of the page in the order of pagination, see `next()`.
+  struct Batch
+  {
+    vector<pair<int, const Task*>> tasks;
 
-  // Get list options (limit and offset).
-  Result<int> result = numify<int>(query.get("limit"));
-  size_t limit = result.isSome() ? result.get() : TASK_LIMIT;
+    // Whether the page is complete after these tasks.
+    bool done;
 
-  result = numify<int>(query.get("offset"));
-  size_t offset = result.isSome() ? result.get() : 0;
+    // The cursor of the next page, once the page is complete.
+    Option<string> nextCursor;
+  };
 
-  Option<string> order = query.get("order");
-  string _order = order.isSome() && (order.get() == "asc") ? "asc" : "des";
+  // Returns whether the selected tasks have to be returned in order,
+  // i.e., ordered by their kinds, their framework IDs and their IDs.
+  bool ordered() const
+  {
+    return limit.isSome() || cursor.isSome();
+  }
 
-  Option<string> frameworkId = query.get("framework_id");
-  Option<string> taskId = query.get("task_id");
+  // Returns whether the tasks of the given (authorized) framework are
+  // selected at all.
+  bool accept(const Framework& framework) const
+  {
+    return frameworkIds.empty() || frameworkIds.contains(framework.id());
+  }
 
-  IDAcceptor<FrameworkID> selectFrameworkId(frameworkId);
-  IDAcceptor<TaskID> selectTaskId(taskId);
+  // Returns whether the given task of the given kind of an accepted
+  // framework is selected.
+  bool accept(
+      int kind,
+      const Task& task,
+      const Framework& framework,
+      const Owned<ObjectApprovers>& approvers) const
+  {
+    return (agentIds.empty() || agentIds.contains(task.slave_id())) &&
+           (states.empty() || states.count(task.state()) > 0) &&
+           (cursor.isNone() || after(kind, task, cursor.get())) &&
+           approvers->approved<VIEW_TASK>(task, framework.info);
+  }
 
-  // Construct framework list with both active and completed frameworks.
-  vector<const Framework*> frameworks;
-  foreachvalue (const Framework* framework, master->frameworks.registered) {
-    // Skip unauthorized frameworks or frameworks without matching
-    // framework ID.
-    if (!selectFrameworkId.accept(framework->id()) ||
-        !approvers->approved<VIEW_FRAMEWORK>(framework->info)) {
-      continue;
+  // Returns the (at most) `count` next tasks of the page in the order of
+  // pagination, among the selected tasks of the given (authorized)
+  // frameworks, given that `written` tasks of the page up to `position`
+  // precede them.
+  //
+  // This scans all of the tasks, but only holds on to `count` of them,
+  // so that a page can be written in batches with bounded memory.
+  Batch next(
+      const vector<const Framework*>& frameworks,
+      const Owned<ObjectApprovers>& approvers,
+      const Option<Cursor>& position,
+      size_t written,
+      size_t count) const
+  {
+    CHECK(ordered());
+
+    if (limit.isSome()) {
+      count = std::min(count, limit.get() - written);
     }
 
-    frameworks.push_back(framework);
-  }
+    // A max-heap of the first tasks after `position` seen so far.
+    vector<pair<int, const Task*>> tasks;
+    bool more = false;
 
-  foreachvalue (const Owned<Framework>& framework,
-                master->frameworks.completed) {
-    // Skip unauthorized frameworks or frameworks without matching
-    // framework ID.
-    if (!selectFrameworkId.accept(framework->id()) ||
-        !approvers->approved<VIEW_FRAMEWORK>(framework->info)) {
-     continue;
+    foreach (const Framework* framework, frameworks) {
+      visit(*framework, approvers, [&](int kind, const Task& task) {
+        if (position.isSome() && !after(kind, task, position.get())) {
+          return;
+        }
+
+        pair<int, const Task*> candidate(kind, &task);
+
+        if (tasks.size() < count) {
+          tasks.push_back(candidate);
+          std::push_heap(tasks.begin(), tasks.end(), before);
+          return;
+        }
+
+        more = true;
+
+        if (!tasks.empty() && before(candidate, tasks.front())) {
+          std::pop_heap(tasks.begin(), tasks.end(), before);
+          tasks.back() = candidate;
+          std::push_heap(tasks.begin(), tasks.end(), before);
+        }
+      });
     }
 
-    frameworks.push_back(framework.get());
+    std::sort_heap(tasks.begin(), tasks.end(), before);
+
+    Batch batch;
+    batch.tasks = std::move(tasks);
+    batch.done = !more ||
+      (limit.isSome() && written + batch.tasks.size() == limit.get());
+
+    if (more && batch.done) {
+      batch.nextCursor = encode(positionOf(batch.tasks.back()));
+    }
+
+    return batch;
   }
 
-  // Construct task list with both running,
-  // completed and unreachable tasks.
-  vector<const Task*> tasks;
-  foreach (const Framework* framework, frameworks) {
-    foreachvalue (Task* task, framework->tasks) {
-      // Skip unauthorized tasks or tasks without matching task ID.
-      if (!selectTaskId.accept(task->task_id()) ||
-          !approvers->approved<VIEW_TASK>(*task, framework->info)) {
-        continue;
+  // Selects the tasks of the given (authorized) frameworks.
+  Selection select(
+      const vector<const Framework*>& frameworks,
+      const Owned<ObjectApprovers>& approvers) const
+  {
+    Selection selection;
+
+    if (!ordered()) {
+      foreach (const Framework* framework, frameworks) {
+        visit(*framework, approvers, [&](int kind, const Task& task) {
+          selection.tasks[kind].push_back(&task);
+        });
       }
 
-      tasks.push_back(task);
+      return selection;
     }
 
-    foreachvalue (
-        const Owned<Task>& task,
-        framework->unreachableTasks) {
-      // Skip unauthorized tasks or tasks without matching task ID.
-      if (!selectTaskId.accept(task->task_id()) ||
-          !approvers->approved<VIEW_TASK>(*task, framework->info)) {
-        continue;
-      }
+    Batch batch = next(
+        frameworks,
+        approvers,
+        None(),
+        0,
+        std::numeric_limits<size_t>::max());
 
-      tasks.push_back(task.get());
+    foreach (const auto& task, batch.tasks) {
+      selection.tasks[task.first].push_back(task.second);
+    }
+
+    selection.nextCursor = batch.nextCursor;
+
+    return selection;
+  }
+
+  // Returns the position of the given task of the given kind.
+  static Cursor positionOf(const pair<int, const Task*>& task)
+  {
+    return Cursor{
+      task.first,
+      task.second->framework_id().value(),
+      task.second->task_id().value()};
+  }
+
+  // Returns `task` restricted to the selected fields.
+  const Task& project(const Task& task, Task* scratch) const
+  {
+    return applyFieldMask(task, fieldMask, scratch);
+  }
+
+private:
+  // Invokes `f` with the kind of each selected task of the given
+  // (authorized) framework.
+  void visit(
+      const Framework& framework,
+      const Owned<ObjectApprovers>& approvers,
+      const std::function<void(int, const Task&)>& f) const
+  {
+    if (!accept(framework)) {
+      return;
+    }
+
+    foreachvalue (const Task* task, framework.tasks) {
+      if (accept(ACTIVE, *task, framework, approvers)) {
+        f(ACTIVE, *task);
+      }
     }
 
-    foreach (const Owned<Task>& task, framework->completedTasks) {
-      // Skip unauthorized tasks or tasks without matching task ID.
-      if (!selectTaskId.accept(task->task_id()) ||
-          !approvers->approved<VIEW_TASK>(*task, framework->info)) {
-        continue;
+    foreachvalue (const Owned<Task>& task, framework.unreachableTasks) {
+      if (accept(UNREACHABLE, *task, framework, approvers)) {
+        f(UNREACHABLE, *task);
       }
+    }
 
-      tasks.push_back(task.get());
+    foreach (const Owned<Task>& task, framework.completedTasks) {
+      if (accept(COMPLETED, *task, framework, approvers)) {
+        f(COMPLETED, *task);
+      }
     }
   }
 
-  // Sort tasks by task status timestamp. Default order is descending.
-  // The earliest timestamp is chosen for comparison when
-  // multiple are present.
-  if (_order == "asc") {
-    sort(tasks.begin(), tasks.end(), TaskComparator::ascending);
-  } else {
-    sort(tasks.begin(), tasks.end(), TaskComparator::descending);
+  static string encode(const Cursor& cursor)
+  {
+    return base64::encode(
+        stringify(cursor.kind) + "\n" +
+        cursor.frameworkId + "\n" +
+        cursor.taskId);
   }
 
-  auto tasksWriter =
-    [&tasks, limit, offset](JSON::ObjectWriter* writer) {
-      writer->field(
-          "tasks",
-          [&tasks, limit, offset](JSON::ArrayWriter* writer) {
-            // Collect 'limit' number of tasks starting from 'offset'.
-            size_t end = std::min(offset + limit, tasks.size());
-            for (size_t i = offset; i < end; i++) {
-              writer->element(*tasks[i]);
-            }
-          });
-  };
+  static bool before(
+      const pair<int, const Task*>& left,
+      const pair<int, const Task*>& right)
+  {
+    return std::tie(
+               left.first,
+               left.second->framework_id().value(),
+               left.second->task_id().value()) <
+           std::tie(
+               right.first,
+               right.second->framework_id().value(),
+               right.second->task_id().value());
+  }
 
-  return pair<Response, Option<Master::ReadOnlyHandler::PostProcessing>>(
-      OK(jsonify(tasksWriter), query.get("jsonp")),
-      None());
-}
+  static bool after(int kind, const Task& task, const Cursor& cursor)
+  {
+    return std::tie(
+               kind,
+               task.framework_id().value(),
+               task.task_id().value()) >
+           std::tie(cursor.kind, cursor.frameworkId, cursor.taskId);
+  }
 
+  hashset<FrameworkID> frameworkIds;
+  hashset<SlaveID> agentIds;
+  std::set<TaskState> states;
+  Option<size_t> limit;
+  Option<Cursor> cursor;
+  Option<google::protobuf::FieldMask> fieldMask;
+};
 
-function<void(JSON::ObjectWriter*)> Master::ReadOnlyHandler::jsonifyGetAgents(
-    const Owned<ObjectApprovers>& approvers) const
-{
-  // Serialize the following:
-  //
-  //   mesos::master::Response::GetAgents getAgents;
-  //   for each registered agent:
-  //     *getAgents.add_agents() = protobuf::master::event::createAgentResponse(
-  //         agent,
-  //         master->slaves.draining.get(slave->id),
-  //         master->slaves.deactivated.contains(slave->id),
-  //         approvers);
-  //   for each recovered agent:
-  //     SlaveInfo* agent = getAgents.add_recovered_agents();
-  //     agent->CopyFrom(slaveInfo);
-  //     agent->clear_resources();
-  //     foreach (const Resource& resource, slaveInfo.resources()):
-  //       if (approvers->approved<VIEW_ROLE>(resource)):
-  //         *agent->add_resources() = resource;
 
-  // TODO(bmahler): This copies the Owned object approvers.
-  return [=](JSON::ObjectWriter* writer) {
-    const google::protobuf::Descriptor* descriptor =
-      v1::master::Response::GetAgents::descriptor();
+class Master::ReadOnlyHandler::FrameworkSelector
+{
+public:
+  static Try<FrameworkSelector> create(
+      const mesos::master::Call::GetFrameworks& call)
+  {
+    FrameworkSelector selector;
 
-    int field;
+    foreach (const FrameworkID& frameworkId, call.framework_ids()) {
+      selector.frameworkIds.insert(frameworkId);
+    }
 
-    field = v1::master::Response::GetAgents::kAgentsFieldNumber;
-    writer->field(
-        descriptor->FindFieldByNumber(field)->name(),
-        [&](JSON::ArrayWriter* writer) {
-      foreachvalue (const Slave* slave, master->slaves.registered) {
-        // TODO(bmahler): Consider not constructing the temporary
-        // agent object and instead serialize directly.
-        mesos::master::Response::GetAgents::Agent agent =
-            protobuf::master::event::createAgentResponse(
-                *slave,
-                master->slaves.draining.get(slave->id),
-                master->slaves.deactivated.contains(slave->id),
-                approvers);
+    if (call.has_field_mask()) {
+      Try<google::protobuf::FieldMask> fieldMask = devolve(
+          call.field_mask(),
+          v1::master::Response::GetFrameworks::Framework::descriptor(),
+          mesos::master::Response::GetFrameworks::Framework::descriptor());
 
-        writer->element(asV1Protobuf(agent));
+      if (fieldMask.isError()) {
+        return Error("Invalid field mask: " + fieldMask.error());
       }
-    });
 
-    field = v1::master::Response::GetAgents::kRecoveredAgentsFieldNumber;
-    writer->field(
-        descriptor->FindFieldByNumber(field)->name(),
-        [&](JSON::ArrayWriter* writer) {
-      foreachvalue (const SlaveInfo& slaveInfo, master->slaves.recovered) {
-        // TODO(bmahler): Consider not constructing the temporary
-        // SlaveInfo object and instead serialize directly.
-        SlaveInfo agent = slaveInfo;
-        agent.clear_resources();
-        foreach (const Resource& resource, slaveInfo.resources()) {
-          if (approvers->approved<VIEW_ROLE>(resource)) {
-            *agent.add_resources() = resource;
-          }
-        }
+      // Collect the top-level fields which are (partially) selected, so
+      // that the others are never constructed; only the masks which
+      // select nested fields need to be applied to the model.
+      const google::protobuf::Descriptor* descriptor =
+        mesos::master::Response::GetFrameworks::Framework::descriptor();
 
-        writer->element(asV1Protobuf(agent));
-      }
-    });
-  };
-}
+      hashset<int> fields;
+      bool nested = false;
 
+      foreach (const string& path, fieldMask->paths()) {
+        vector<string> components = strings::split(path, ".", 2);
 
-string Master::ReadOnlyHandler::serializeGetAgents(
-    const Owned<ObjectApprovers>& approvers) const
-{
-  // Serialize the following:
-  //
-  //   mesos::master::Response::GetAgents getAgents;
-  //   for each registered agent:
-  //     *getAgents.add_agents() = protobuf::master::event::createAgentResponse(
-  //         agent,
-  //         master->slaves.draining.get(slave->id),
-  //         master->slaves.deactivated.contains(slave->id),
-  //         approvers);
-  //   for each recovered agent:
-  //     SlaveInfo* agent = getAgents.add_recovered_agents();
-  //     agent->CopyFrom(slaveInfo);
-  //     agent->clear_resources();
-  //     foreach (const Resource& resource, slaveInfo.resources()):
-  //       if (approvers->approved<VIEW_ROLE>(resource)):
-  //         *agent->add_resources() = resource;
+        const google::protobuf::FieldDescriptor* field =
+          descriptor->FindFieldByName(components[0]);
 
-  string output;
-  google::protobuf::io::StringOutputStream stream(&output);
-  google::protobuf::io::CodedOutputStream writer(&stream);
+        CHECK_NOTNULL(field);
 
-  foreachvalue (const Slave* slave, master->slaves.registered) {
-    // TODO(bmahler): Consider not constructing the temporary
-    // agent object and instead serialize directly.
-    WireFormatLite2::WriteMessageWithoutCachedSizes(
-        mesos::master::Response::GetAgents::kAgentsFieldNumber,
-        protobuf::master::event::createAgentResponse(
-            *slave,
-            master->slaves.draining.get(slave->id),
-            master->slaves.deactivated.contains(slave->id),
-            approvers),
-        &writer);
-  }
+        fields.insert(field->number());
+        nested = nested || components.size() > 1;
+      }
 
-  foreachvalue (const SlaveInfo& slaveInfo, master->slaves.recovered) {
-    // TODO(bmahler): Consider not constructing the temporary
-    // SlaveInfo object and instead serialize directly.
-    SlaveInfo agent = slaveInfo;
-    agent.clear_resources();
-    foreach (const Resource& resource, slaveInfo.resources()) {
-      if (approvers->approved<VIEW_ROLE>(resource)) {
-        *agent.add_resources() = resource;
+      selector.fields = fields;
+
+      if (nested) {
+        selector.fieldMask = fieldMask.get();
       }
     }
 
-    WireFormatLite2::WriteMessageWithoutCachedSizes(
-        mesos::master::Response::GetAgents::kRecoveredAgentsFieldNumber,
-        agent,
-        &writer);
+    return selector;
   }
 
-  // While an explicit Trim() isn't necessary (since the coded
-  // output stream is destructed before the string is returned),
-  // it's a quite tricky bug to diagnose if Trim() is missed, so
-  // we always do it explicitly to signal the reader about this
-  // subtlety.
-  writer.Trim();
-
-  return output;
-}
-
-
-
-pair<Response, Option<Master::ReadOnlyHandler::PostProcessing>>
-  Master::ReadOnlyHandler::getAgents(
-      ContentType outputContentType,
-      const hashmap<std::string, std::string>& query,
-      const process::Owned<ObjectApprovers>& approvers) const
-{
-  // Serialize the following message:
-  //
-  //   mesos::master::Response response;
-  //   response.set_type(mesos::master::Response::GET_AGENTS);
-  //   *response.mutable_get_agents() = _getAgents(approvers);
-
-  switch (outputContentType) {
-    case ContentType::PROTOBUF: {
-      string output;
-      google::protobuf::io::StringOutputStream stream(&output);
-      google::protobuf::io::CodedOutputStream writer(&stream);
-
-      WireFormatLite::WriteEnum(
-          mesos::v1::master::Response::kTypeFieldNumber,
-          mesos::v1::master::Response::GET_AGENTS,
-          &writer);
-
-      WireFormatLite::WriteBytes(
-          mesos::v1::master::Response::kGetAgentsFieldNumber,
-          serializeGetAgents(approvers),
-          &writer);
+  bool accept(const FrameworkID& frameworkId) const
+  {
+    return frameworkIds.empty() || frameworkIds.contains(frameworkId);
+  }
 
-      // We must manually trim the unused buffer space since
-      // we use the string before the coded output stream is
-      // destructed.
-      writer.Trim();
+  // Returns the model of `framework` restricted to the selected fields.
+  mesos::master::Response::GetFrameworks::Framework model(
+      const Framework& framework) const
+  {
+    mesos::master::Response::GetFrameworks::Framework selected =
+      mesos::internal::master::model(framework, fields);
 
-      return pair<Response, Option<Master::ReadOnlyHandler::PostProcessing>>(
-          OK(std::move(output), stringify(outputContentType)),
-          None());
+    if (fieldMask.isNone()) {
+      return selected;
     }
 
-    case ContentType::JSON: {
-      string body = jsonify([&](JSON::ObjectWriter* writer) {
-        const google::protobuf::Descriptor* descriptor =
-          v1::master::Response::descriptor();
+    mesos::master::Response::GetFrameworks::Framework projected;
+    applyFieldMask(selected, fieldMask, &projected);
+    return projected;
+  }
 
-        int field;
+private:
+  hashset<FrameworkID> frameworkIds;
 
-        field = v1::master::Response::kTypeFieldNumber;
-        writer->field(
-            descriptor->FindFieldByNumber(field)->name(),
-            v1::master::Response::Type_Name(
-                v1::master::Response::GET_AGENTS));
+  // The numbers of the top-level fields to construct, if restricted.
+  Option<hashset<int>> fields;
 
-        field = v1::master::Response::kGetAgentsFieldNumber;
-        writer->field(
-            descriptor->FindFieldByNumber(field)->name(),
-            jsonifyGetAgents(approvers));
-      });
+  // The mask to apply to the constructed fields, if any of them are
+  // only partially selected.
+  Option<google::protobuf::FieldMask> fieldMask;
+};
 
-      // TODO(bmahler): Pass jsonp query parameter through here.
-      return pair<Response, Option<Master::ReadOnlyHandler::PostProcessing>>(
-          OK(std::move(body), stringify(outputContentType)),
-          None());
-    }
 
-    default:
-      return pair<Response, Option<Master::ReadOnlyHandler::PostProcessing>>(
-          NotAcceptable("Request must accept json or protobuf"), None());
+// Creates the selector for the parameters of a v1 call, which are passed
+// to the batched handlers in serialized form as the query parameter `key`
+// (see e.g. `Master::Http::getTasks()`), since batched requests are
+// de-duplicated based on their query parameters.
+template <typename Selector, typename Parameters>
+static Try<Selector> createSelector(
+    const hashmap<string, string>& query,
+    const string& key)
+{
+  Parameters parameters;
+
+  Option<string> serialized = query.get(key);
+  if (serialized.isSome() && !parameters.ParseFromString(serialized.get())) {
+    return Error("Failed to parse '" + key + "'");
   }
+
+  return Selector::create(parameters);
 }
 
 
 function<void(JSON::ObjectWriter*)>
   Master::ReadOnlyHandler::jsonifyGetFrameworks(
-      const Owned<ObjectApprovers>& approvers) const
+      const Owned<ObjectApprovers>& approvers,
+      const FrameworkSelector& selector) const
 {
   // Serialize the following:
   //
@@ -1491,12 +2682,14 @@ function<void(JSON::ObjectWriter*)>
         [&](JSON::ArrayWriter* writer) {
       foreachvalue (const Framework* framework,
                     master->frameworks.registered) {
-        // Skip unauthorized frameworks.
-        if (!approvers->approved<VIEW_FRAMEWORK>(framework->info)) {
+        // Skip unselected or unauthorized frameworks.
+        if (!selector.accept(framework->id()) ||
+            !approvers->approved<VIEW_FRAMEWORK>(framework->info)) {
           continue;
         }
 
-        mesos::master::Response::GetFrameworks::Framework f = model(*framework);
+        mesos::master::Response::GetFrameworks::Framework f =
+          selector.model(*framework);
         writer->element(asV1Protobuf(f));
       }
     });
@@ -1508,12 +2701,14 @@ function<void(JSON::ObjectWriter*)>
         [&](JSON::ArrayWriter* writer) {
       foreachvalue (const Owned<Framework>& framework,
                     master->frameworks.completed) {
-        // Skip unauthorized frameworks.
-        if (!approvers->approved<VIEW_FRAMEWORK>(framework->info)) {
+        // Skip unselected or unauthorized frameworks.
+        if (!selector.accept(framework->id()) ||
+            !approvers->approved<VIEW_FRAMEWORK>(framework->info)) {
           continue;
         }
 
-        mesos::master::Response::GetFrameworks::Framework f = model(*framework);
+        mesos::master::Response::GetFrameworks::Framework f =
+          selector.model(*framework);
         writer->element(asV1Protobuf(f));
       }
     });
@@ -1521,51 +2716,61 @@ function<void(JSON::ObjectWriter*)>
 }
 
 
-string Master::ReadOnlyHandler::serializeGetFrameworks(
-    const Owned<ObjectApprovers>& approvers) const
+// Returns a step which writes the field `field` for each of those of
+// `frameworks` (either the registered or the completed frameworks of
+// the master) that are authorized and accepted by `selector`, wrapped
+// into the embedded message fields of `path`.
+template <typename Frameworks, typename Selector>
+static ProtobufStep protobufFrameworks(
+    const vector<int>& path,
+    int field,
+    const Frameworks* frameworks,
+    const Selector& selector,
+    const Owned<ObjectApprovers>& approvers)
 {
-  // Serialize the following:
-  //
-  //   mesos::master::Response::GetFrameworks getFrameworks;
-  //   for each framework:
-  //     *getFrameworks.add_frameworks() = model(*framework);
-  //   for each completed framework:
-  //     *getFrameworks.add_completed_frameworks() = model(*framework);
+  return protobufRepeated<Frameworks>(
+      path,
+      [frameworks]() { return frameworks; },
+      [field, selector, approvers](
+          const typename Walk<Frameworks>::Entry& entry,
+          google::protobuf::io::CodedOutputStream* writer)
+            -> Option<ProtobufStep> {
+        // Skip unselected or unauthorized frameworks.
+        if (selector.accept(entry.first) &&
+            approvers->approved<VIEW_FRAMEWORK>(entry.second->info)) {
+          WireFormatLite2::WriteMessageWithoutCachedSizes(
+              field, selector.model(*entry.second), writer);
+        }
+
+        return None();
+      });
+}
+
 
+// Returns the following message serialized:
+//
+//   mesos::master::Response::GetExecutors::Executor executor;
+//   *executor.mutable_executor_info() = executorInfo;
+//   *executor.mutable_slave_id() = slaveId;
+static string serializeExecutor(
+    const ExecutorInfo& executorInfo,
+    const SlaveID& slaveId)
+{
   string output;
   google::protobuf::io::StringOutputStream stream(&output);
   google::protobuf::io::CodedOutputStream writer(&stream);
 
-  // TODO(bmahler): Consider not constructing the temporary framework
-  // objects and instead serialize directly, but since we don't
-  // expect a large number of pending tasks, we currently don't
-  // bother with the more efficient approach.
-
-  foreachvalue (const Framework* framework,
-                master->frameworks.registered) {
-    // Skip unauthorized frameworks.
-    if (!approvers->approved<VIEW_FRAMEWORK>(framework->info)) {
-      continue;
-    }
-
-    WireFormatLite2::WriteMessageWithoutCachedSizes(
-        mesos::master::Response::GetFrameworks::kFrameworksFieldNumber,
-        model(*framework),
-        &writer);
-  }
-
-  foreachvalue (const Owned<Framework>& framework,
-                master->frameworks.completed) {
-    // Skip unauthorized frameworks.
-    if (!approvers->approved<VIEW_FRAMEWORK>(framework->info)) {
-      continue;
-    }
+  WireFormatLite2::WriteMessageWithoutCachedSizes(
+      mesos::v1::master::Response::GetExecutors::Executor
+        ::kExecutorInfoFieldNumber,
+      executorInfo,
+      &writer);
 
-    WireFormatLite2::WriteMessageWithoutCachedSizes(
-        mesos::master::Response::GetFrameworks::kCompletedFrameworksFieldNumber,
-        model(*framework),
-        &writer);
-  }
+  WireFormatLite2::WriteMessageWithoutCachedSizes(
+      mesos::v1::master::Response::GetExecutors::Executor
+        ::kAgentIdFieldNumber,
+      slaveId,
+      &writer);
 
   // While an explicit Trim() isn't necessary (since the coded
   // output stream is destructed before the string is returned),
@@ -1574,7 +2779,101 @@ string Master::ReadOnlyHandler::serializeGetFrameworks(
   // subtlety.
   writer.Trim();
 
-  return output;
+  return output;
+}
+
+
+// Returns a step which writes the `executors` field for each of the
+// authorized executors of the authorized `frameworks` (either the
+// registered or the completed frameworks of the master), wrapped into
+// the embedded message fields of `path`.
+template <typename Frameworks>
+static ProtobufStep protobufExecutors(
+    const vector<int>& path,
+    const Frameworks* frameworks,
+    const Owned<ObjectApprovers>& approvers)
+{
+  typedef decltype(Framework::executors) Executors;
+
+  return protobufRepeated<Frameworks>(
+      path,
+      [frameworks]() { return frameworks; },
+      [path, frameworks, approvers](
+          const typename Walk<Frameworks>::Entry& entry,
+          google::protobuf::io::CodedOutputStream*) -> Option<ProtobufStep> {
+        // Skip unauthorized frameworks.
+        if (!approvers->approved<VIEW_FRAMEWORK>(entry.second->info)) {
+          return None();
+        }
+
+        // A framework may have a large number of executors, hence they
+        // are written across several chunks, one agent at a time.
+        function<const Framework*()> lookup =
+          frameworkLookup(frameworks, entry.first);
+
+        return protobufRepeated<Executors>(
+            path,
+            frameworkMember(lookup, &Framework::executors),
+            [lookup, approvers](
+                const typename Walk<Executors>::Entry& executors,
+                google::protobuf::io::CodedOutputStream* writer)
+                  -> Option<ProtobufStep> {
+              const Framework* framework = lookup();
+
+              foreachvalue (const ExecutorInfo& executorInfo,
+                            executors.second) {
+                // Skip unauthorized executors.
+                if (!approvers->approved<VIEW_EXECUTOR>(
+                        executorInfo, framework->info)) {
+                  continue;
+                }
+
+                WireFormatLite::WriteBytes(
+                    mesos::v1::master::Response::GetExecutors
+                      ::kExecutorsFieldNumber,
+                    serializeExecutor(executorInfo, executors.first),
+                    writer);
+              }
+
+              return None();
+            });
+      });
+}
+
+
+vector<ProtobufStep> Master::ReadOnlyHandler::serializeGetFrameworks(
+    const Owned<ObjectApprovers>& approvers,
+    const FrameworkSelector& selector,
+    const vector<int>& path) const
+{
+  // Serialize the following:
+  //
+  //   mesos::master::Response::GetFrameworks getFrameworks;
+  //   for each framework:
+  //     *getFrameworks.add_frameworks() = model(*framework);
+  //   for each completed framework:
+  //     *getFrameworks.add_completed_frameworks() = model(*framework);
+
+  // TODO(bmahler): Consider not constructing the temporary framework
+  // objects and instead serialize directly, but since we don't
+  // expect a large number of pending tasks, we currently don't
+  // bother with the more efficient approach.
+
+  return {
+    protobufFrameworks(
+        path,
+        mesos::master::Response::GetFrameworks::kFrameworksFieldNumber,
+        &master->frameworks.registered,
+        selector,
+        approvers),
+
+    protobufFrameworks(
+        path,
+        mesos::master::Response::GetFrameworks::kCompletedFrameworksFieldNumber,
+        &master->frameworks.completed,
+        selector,
+        approvers)
+  };
 }
 
 
@@ -1590,30 +2889,23 @@ pair<Response, Option<Master::ReadOnlyHandler::PostProcessing>>
   //   response.set_type(mesos::master::Response::GET_FRAMEWORKS);
   //   *response.mutable_get_frameworks() = _getFrameworks(approvers);
 
+  Try<FrameworkSelector> selector =
+    createSelector<FrameworkSelector, mesos::master::Call::GetFrameworks>(
+        query, "get_frameworks");
+
+  if (selector.isError()) {
+    return pair<Response, Option<Master::ReadOnlyHandler::PostProcessing>>(
+        BadRequest(selector.error()), None());
+  }
+
   switch (outputContentType) {
     case ContentType::PROTOBUF: {
-      string output;
-      google::protobuf::io::StringOutputStream stream(&output);
-      google::protobuf::io::CodedOutputStream writer(&stream);
-
-      WireFormatLite::WriteEnum(
-          mesos::v1::master::Response::kTypeFieldNumber,
+      return streamProtobuf(
           mesos::v1::master::Response::GET_FRAMEWORKS,
-          &writer);
-
-      WireFormatLite::WriteBytes(
-          mesos::v1::master::Response::kGetFrameworksFieldNumber,
-          serializeGetFrameworks(approvers),
-          &writer);
-
-      // We must manually trim the unused buffer space since
-      // we use the string before the coded output stream is
-      // destructed.
-      writer.Trim();
-
-      return pair<Response, Option<Master::ReadOnlyHandler::PostProcessing>>(
-          OK(std::move(output), stringify(outputContentType)),
-          None());
+          serializeGetFrameworks(
+              approvers,
+              selector.get(),
+              {mesos::v1::master::Response::kGetFrameworksFieldNumber}));
     }
 
     case ContentType::JSON: {
@@ -1632,7 +2924,7 @@ pair<Response, Option<Master::ReadOnlyHandler::PostProcessing>>
         field = v1::master::Response::kGetFrameworksFieldNumber;
         writer->field(
             descriptor->FindFieldByNumber(field)->name(),
-            jsonifyGetFrameworks(approvers));
+            jsonifyGetFrameworks(approvers, selector.get()));
       });
 
       // TODO(bmahler): Pass jsonp query parameter through here.
@@ -1731,61 +3023,10 @@ function<void(JSON::ObjectWriter*)>
 }
 
 
-string Master::ReadOnlyHandler::serializeGetExecutors(
-    const Owned<ObjectApprovers>& approvers) const
+vector<ProtobufStep> Master::ReadOnlyHandler::serializeGetExecutors(
+    const Owned<ObjectApprovers>& approvers,
+    const vector<int>& path) const
 {
-  // Construct framework list with both active and completed frameworks.
-  vector<const Framework*> frameworks;
-  foreachvalue (const Framework* framework, master->frameworks.registered) {
-    // Skip unauthorized frameworks.
-    if (approvers->approved<VIEW_FRAMEWORK>(framework->info)) {
-      frameworks.push_back(framework);
-    }
-  }
-  foreachvalue (const Owned<Framework>& framework,
-                master->frameworks.completed) {
-    // Skip unauthorized frameworks.
-    if (approvers->approved<VIEW_FRAMEWORK>(framework->info)) {
-      frameworks.push_back(framework.get());
-    }
-  }
-
-  // Lambda for serializing the following message:
-  //
-  //   mesos::master::Response::GetExecutors::Executor executor;
-  //   *executor.mutable_executor_info() = executorInfo;
-  //   *executor.mutable_slave_id() = slaveId;
-  auto serializeExecutor = [](const ExecutorInfo& e, const SlaveID& s) {
-    string output;
-    google::protobuf::io::StringOutputStream stream(&output);
-    google::protobuf::io::CodedOutputStream writer(&stream);
-
-    WireFormatLite2::WriteMessageWithoutCachedSizes(
-        mesos::v1::master::Response::GetExecutors::Executor
-          ::kExecutorInfoFieldNumber,
-        e,
-        &writer);
-
-    WireFormatLite2::WriteMessageWithoutCachedSizes(
-        mesos::v1::master::Response::GetExecutors::Executor
-          ::kAgentIdFieldNumber,
-        s,
-        &writer);
-
-    // While an explicit Trim() isn't necessary (since the coded
-    // output stream is destructed before the string is returned),
-    // it's a quite tricky bug to diagnose if Trim() is missed, so
-    // we always do it explicitly to signal the reader about this
-    // subtlety.
-    writer.Trim();
-
-    return output;
-  };
-
-  string output;
-  google::protobuf::io::StringOutputStream stream(&output);
-  google::protobuf::io::CodedOutputStream writer(&stream);
-
   // Serialize the following:
   //
   //   mesos::master::Response::GetExecutors getExecutors;
@@ -1796,33 +3037,10 @@ string Master::ReadOnlyHandler::serializeGetExecutors(
   //     *executor->mutable_executor_info() = executorInfo;
   //     *executor->mutable_slave_id() = slaveId;
 
-  foreach (const Framework* framework, frameworks) {
-    foreachpair (const SlaveID& slaveId,
-                 const auto& executorsMap,
-                 framework->executors) {
-      foreachvalue (const ExecutorInfo& executorInfo, executorsMap) {
-        // Skip unauthorized executors.
-        if (!approvers->approved<VIEW_EXECUTOR>(
-                executorInfo, framework->info)) {
-          continue;
-        }
-
-        WireFormatLite::WriteBytes(
-            mesos::v1::master::Response::GetExecutors::kExecutorsFieldNumber,
-            serializeExecutor(executorInfo, slaveId),
-            &writer);
-      }
-    }
-  }
-
-  // While an explicit Trim() isn't necessary (since the coded
-  // output stream is destructed before the string is returned),
-  // it's a quite tricky bug to diagnose if Trim() is missed, so
-  // we always do it explicitly to signal the reader about this
-  // subtlety.
-  writer.Trim();
-
-  return output;
+  return {
+    protobufExecutors(path, &master->frameworks.registered, approvers),
+    protobufExecutors(path, &master->frameworks.completed, approvers)
+  };
 }
 
 
@@ -1840,28 +3058,11 @@ pair<Response, Option<Master::ReadOnlyHandler::PostProcessing>>
 
   switch (outputContentType) {
     case ContentType::PROTOBUF: {
-      string output;
-      google::protobuf::io::StringOutputStream stream(&output);
-      google::protobuf::io::CodedOutputStream writer(&stream);
-
-      WireFormatLite::WriteEnum(
-          mesos::v1::master::Response::kTypeFieldNumber,
+      return streamProtobuf(
           mesos::v1::master::Response::GET_EXECUTORS,
-          &writer);
-
-      WireFormatLite::WriteBytes(
-          mesos::v1::master::Response::kGetExecutorsFieldNumber,
-          serializeGetExecutors(approvers),
-          &writer);
-
-      // We must manually trim the unused buffer space since
-      // we use the string before the coded output stream is
-      // destructed.
-      writer.Trim();
-
-      return pair<Response, Option<Master::ReadOnlyHandler::PostProcessing>>(
-          OK(std::move(output), stringify(outputContentType)),
-          None());
+          serializeGetExecutors(
+              approvers,
+              {mesos::v1::master::Response::kGetExecutorsFieldNumber}));
     }
 
     case ContentType::JSON: {
@@ -1897,7 +3098,8 @@ pair<Response, Option<Master::ReadOnlyHandler::PostProcessing>>
 
 
 function<void(JSON::ObjectWriter*)> Master::ReadOnlyHandler::jsonifyGetTasks(
-    const Owned<ObjectApprovers>& approvers) const
+    const Owned<ObjectApprovers>& approvers,
+    const TaskSelector& selector) const
 {
   // Jsonify the following message:
   //
@@ -1911,6 +3113,7 @@ function<void(JSON::ObjectWriter*)> Master::ReadOnlyHandler::jsonifyGetTasks(
   //    *getTasks.add_unreachable_tasks() = *task;
   //  for each completed task:
   //    *getTasks.add_completed_tasks() = *task;
+  //  getTasks.set_next_cursor(...);
 
   // TODO(bmahler): This copies the Owned object approvers.
   return [=](JSON::ObjectWriter* writer) {
@@ -1930,85 +3133,92 @@ function<void(JSON::ObjectWriter*)> Master::ReadOnlyHandler::jsonifyGetTasks(
       }
     }
 
+    const TaskSelector::Selection selection =
+      selector.select(frameworks, approvers);
+
     const google::protobuf::Descriptor* descriptor =
       v1::master::Response::GetTasks::descriptor();
 
-    int field;
-
-    // Active tasks.
-    field = v1::master::Response::GetTasks::kTasksFieldNumber;
-    writer->field(
-        descriptor->FindFieldByNumber(field)->name(),
-        [&](JSON::ArrayWriter* writer) {
-          foreach (const Framework* framework, frameworks) {
-            foreachvalue (const Task* task, framework->tasks) {
-              // Skip unauthorized tasks.
-              if (!approvers->approved<VIEW_TASK>(*task, framework->info)) {
-                continue;
-              }
+    // Used to hold the projected tasks if there is a field mask.
+    Task scratch;
 
-              writer->element(asV1Protobuf(*task));
+    auto writeTasks = [&](TaskSelector::Kind kind, int field) {
+      writer->field(
+          descriptor->FindFieldByNumber(field)->name(),
+          [&](JSON::ArrayWriter* writer) {
+            foreach (const Task* task, selection.tasks[kind]) {
+              writer->element(
+                  asV1Protobuf(selector.project(*task, &scratch)));
             }
-          }
-        });
+          });
+    };
 
-    // Unreachable tasks.
-    field = v1::master::Response::GetTasks::kUnreachableTasksFieldNumber;
-    writer->field(
-        descriptor->FindFieldByNumber(field)->name(),
-        [&](JSON::ArrayWriter* writer) {
-          foreach (const Framework* framework, frameworks) {
-            foreachvalue (const Owned<Task>& task,
-                          framework->unreachableTasks) {
-              // Skip unauthorized tasks.
-              if (!approvers->approved<VIEW_TASK>(*task, framework->info)) {
-                continue;
-              }
+    // Active tasks.
+    writeTasks(
+        TaskSelector::ACTIVE,
+        v1::master::Response::GetTasks::kTasksFieldNumber);
 
-              writer->element(asV1Protobuf(*task));
-            }
-          }
-        });
+    // Unreachable tasks.
+    writeTasks(
+        TaskSelector::UNREACHABLE,
+        v1::master::Response::GetTasks::kUnreachableTasksFieldNumber);
 
     // Completed tasks.
-    field = v1::master::Response::GetTasks::kCompletedTasksFieldNumber;
-    writer->field(
-        descriptor->FindFieldByNumber(field)->name(),
-        [&](JSON::ArrayWriter* writer) {
-          foreach (const Framework* framework, frameworks) {
-            foreach (const Owned<Task>& task, framework->completedTasks) {
-              // Skip unauthorized tasks.
-              if (!approvers->approved<VIEW_TASK>(*task, framework->info)) {
-                continue;
-              }
+    writeTasks(
+        TaskSelector::COMPLETED,
+        v1::master::Response::GetTasks::kCompletedTasksFieldNumber);
 
-              writer->element(asV1Protobuf(*task));
-            }
-          }
-        });
+    if (selection.nextCursor.isSome()) {
+      int field = v1::master::Response::GetTasks::kNextCursorFieldNumber;
+      writer->field(
+          descriptor->FindFieldByNumber(field)->name(),
+          selection.nextCursor.get());
+    }
   };
 }
 
 
-string Master::ReadOnlyHandler::serializeGetTasks(
-    const Owned<ObjectApprovers>& approvers) const
+// Returns a step which writes the field `field` for each of the tasks
+// of the given kind (i.e., the `member` tasks) of the framework returned
+// by `lookup` that are selected by `selector`, wrapped into the embedded
+// message fields of `path`.
+template <typename Tasks, typename Selector>
+static ProtobufStep protobufTasks(
+    const vector<int>& path,
+    int field,
+    int kind,
+    const function<const Framework*()>& lookup,
+    Tasks Framework::*member,
+    const Selector& selector,
+    const Owned<ObjectApprovers>& approvers)
 {
-  // Construct framework list with both active and completed frameworks.
-  vector<const Framework*> frameworks;
-  foreachvalue (const Framework* framework, master->frameworks.registered) {
-    // Skip unauthorized frameworks.
-    if (approvers->approved<VIEW_FRAMEWORK>(framework->info)) {
-      frameworks.push_back(framework);
-    }
-  }
-  foreachvalue (const Owned<Framework>& framework,
-                master->frameworks.completed) {
-    // Skip unauthorized frameworks.
-    if (!approvers->approved<VIEW_FRAMEWORK>(framework->info)) {
-      frameworks.push_back(framework.get());
-    }
-  }
+  return protobufRepeated<Tasks>(
+      path,
+      frameworkMember(lookup, member),
+      [field, kind, lookup, selector, approvers](
+          const typename Walk<Tasks>::Entry& entry,
+          google::protobuf::io::CodedOutputStream* writer)
+            -> Option<ProtobufStep> {
+        const Task& task = walkTask(entry);
+
+        if (selector.accept(kind, task, *lookup(), approvers)) {
+          // Used to hold the projected task if there is a field mask.
+          Task scratch;
+
+          WireFormatLite2::WriteMessageWithoutCachedSizes(
+              field, selector.project(task, &scratch), writer);
+        }
+
+        return None();
+      });
+}
 
+
+vector<ProtobufStep> Master::ReadOnlyHandler::serializeGetTasks(
+    const Owned<ObjectApprovers>& approvers,
+    const TaskSelector& selector,
+    const vector<int>& path) const
+{
   // Serialize the following message:
   //
   //  mesos::master::Response::GetTasks getTasks;
@@ -2021,60 +3231,163 @@ string Master::ReadOnlyHandler::serializeGetTasks(
   //    *getTasks.add_unreachable_tasks() = *task;
   //  for each completed task:
   //    *getTasks.add_completed_tasks() = *task;
+  //  getTasks.set_next_cursor(...);
+
+  if (!selector.ordered()) {
+    // The tasks are written framework by framework, walking the tasks
+    // of each framework across several chunks.
+    auto tasks = [path, selector, approvers](
+        const function<const Framework*()>& lookup) {
+      return protobufSequence({
+        protobufTasks(
+            path,
+            mesos::v1::master::Response::GetTasks::kTasksFieldNumber,
+            TaskSelector::ACTIVE,
+            lookup,
+            &Framework::tasks,
+            selector,
+            approvers),
+        protobufTasks(
+            path,
+            mesos::v1::master::Response::GetTasks::kUnreachableTasksFieldNumber,
+            TaskSelector::UNREACHABLE,
+            lookup,
+            &Framework::unreachableTasks,
+            selector,
+            approvers),
+        protobufTasks(
+            path,
+            mesos::v1::master::Response::GetTasks::kCompletedTasksFieldNumber,
+            TaskSelector::COMPLETED,
+            lookup,
+            &Framework::completedTasks,
+            selector,
+            approvers)
+      });
+    };
 
-  string output;
-  google::protobuf::io::StringOutputStream stream(&output);
-  google::protobuf::io::CodedOutputStream writer(&stream);
+    auto frameworks = [selector, approvers, tasks](
+        const function<const Framework*()>& lookup) -> Option<ProtobufStep> {
+      const Framework* framework = lookup();
 
-  foreach (const Framework* framework, frameworks) {
-    // Active tasks.
-    foreachvalue (const Task* task, framework->tasks) {
-      // Skip unauthorized tasks.
-      if (!approvers->approved<VIEW_TASK>(*task, framework->info)) {
-        continue;
+      // Skip unselected or unauthorized frameworks.
+      if (!selector.accept(*framework) ||
+          !approvers->approved<VIEW_FRAMEWORK>(framework->info)) {
+        return None();
       }
 
-      WireFormatLite2::WriteMessageWithoutCachedSizes(
-          mesos::v1::master::Response::GetTasks::kTasksFieldNumber,
-          *task,
-          &writer);
-    }
+      return tasks(lookup);
+    };
 
-    // Unreachable tasks.
-    foreachvalue (const Owned<Task>& task, framework->unreachableTasks) {
-      // Skip unauthorized tasks.
-      if (!approvers->approved<VIEW_TASK>(*task, framework->info)) {
-        continue;
-      }
+    typedef decltype(master->frameworks.registered) Registered;
+    typedef decltype(master->frameworks.completed) Completed;
+
+    const Registered* registered = &master->frameworks.registered;
+    const Completed* completed = &master->frameworks.completed;
+
+    return {
+      protobufRepeated<Registered>(
+          path,
+          [registered]() { return registered; },
+          [registered, frameworks](
+              const typename Walk<Registered>::Entry& entry,
+              google::protobuf::io::CodedOutputStream*) {
+            return frameworks(frameworkLookup(registered, entry.first));
+          }),
+
+      protobufRepeated<Completed>(
+          path,
+          [completed]() { return completed; },
+          [completed, frameworks](
+              const typename Walk<Completed>::Entry& entry,
+              google::protobuf::io::CodedOutputStream*) {
+            return frameworks(frameworkLookup(completed, entry.first));
+          })
+    };
+  }
 
-      WireFormatLite2::WriteMessageWithoutCachedSizes(
-          mesos::v1::master::Response::GetTasks::kUnreachableTasksFieldNumber,
-          *task,
-          &writer);
-    }
+  // The page of tasks is written in the order of pagination, in batches
+  // of the next `STREAM_TASKS_PER_SCAN` tasks after the last task
+  // written, see `TaskSelector::next()`.
+  std::shared_ptr<Option<TaskSelector::Cursor>> position(
+      new Option<TaskSelector::Cursor>());
+  std::shared_ptr<size_t> written(new size_t(0));
+  std::shared_ptr<Option<string>> nextCursor(new Option<string>());
 
-    // Completed tasks.
-    foreach (const Owned<Task>& task, framework->completedTasks) {
-      // Skip unauthorized tasks.
-      if (!approvers->approved<VIEW_TASK>(*task, framework->info)) {
-        continue;
+  auto tasks = [this, approvers, selector, path, position, written, nextCursor](
+      string* chunk) {
+    // Construct framework list with both active and completed frameworks.
+    vector<const Framework*> frameworks;
+    foreachvalue (const Framework* framework, master->frameworks.registered) {
+      // Skip unauthorized frameworks.
+      if (approvers->approved<VIEW_FRAMEWORK>(framework->info)) {
+        frameworks.push_back(framework);
+      }
+    }
+    foreachvalue (const Owned<Framework>& framework,
+                  master->frameworks.completed) {
+      // Skip unauthorized frameworks.
+      if (approvers->approved<VIEW_FRAMEWORK>(framework->info)) {
+        frameworks.push_back(framework.get());
       }
+    }
 
-      WireFormatLite2::WriteMessageWithoutCachedSizes(
-          mesos::v1::master::Response::GetTasks::kCompletedTasksFieldNumber,
-          *task,
-          &writer);
+    const TaskSelector::Batch batch = selector.next(
+        frameworks, approvers, *position, *written, STREAM_TASKS_PER_SCAN);
+
+    appendFragment(
+        path,
+        serializeFields([&](google::protobuf::io::CodedOutputStream* writer) {
+          // Used to hold the projected task if there is a field mask.
+          Task scratch;
+
+          foreach (const auto& task, batch.tasks) {
+            int field = 0;
+            switch (task.first) {
+              case TaskSelector::ACTIVE:
+                field =
+                  mesos::v1::master::Response::GetTasks::kTasksFieldNumber;
+                break;
+              case TaskSelector::UNREACHABLE:
+                field = mesos::v1::master::Response::GetTasks
+                  ::kUnreachableTasksFieldNumber;
+                break;
+              case TaskSelector::COMPLETED:
+                field = mesos::v1::master::Response::GetTasks
+                  ::kCompletedTasksFieldNumber;
+                break;
+            }
+
+            WireFormatLite2::WriteMessageWithoutCachedSizes(
+                field, selector.project(*task.second, &scratch), writer);
+          }
+        }),
+        chunk);
+
+    if (!batch.tasks.empty()) {
+      *position = TaskSelector::positionOf(batch.tasks.back());
+      *written += batch.tasks.size();
     }
-  }
 
-  // While an explicit Trim() isn't necessary (since the coded
-  // output stream is destructed before the string is returned),
-  // it's a quite tricky bug to diagnose if Trim() is missed, so
-  // we always do it explicitly to signal the reader about this
-  // subtlety.
-  writer.Trim();
+    *nextCursor = batch.nextCursor;
 
-  return output;
+    return batch.done;
+  };
+
+  return {
+    tasks,
+
+    protobufFields(
+        path,
+        [nextCursor](google::protobuf::io::CodedOutputStream* writer) {
+          if (nextCursor->isSome()) {
+            WireFormatLite::WriteString(
+                mesos::v1::master::Response::GetTasks::kNextCursorFieldNumber,
+                nextCursor->get(),
+                writer);
+          }
+        })
+  };
 }
 
 
@@ -2090,30 +3403,23 @@ pair<Response, Option<Master::ReadOnlyHandler::PostProcessing>>
   //    response.set_type(mesos::master::Response::GET_TASKS);
   //    *response.mutable_get_tasks() = _getTasks(approvers);
 
+  Try<TaskSelector> selector =
+    createSelector<TaskSelector, mesos::master::Call::GetTasks>(
+        query, "get_tasks");
+
+  if (selector.isError()) {
+    return pair<Response, Option<Master::ReadOnlyHandler::PostProcessing>>(
+        BadRequest(selector.error()), None());
+  }
+
   switch (outputContentType) {
     case ContentType::PROTOBUF: {
-      string output;
-      google::protobuf::io::StringOutputStream stream(&output);
-      google::protobuf::io::CodedOutputStream writer(&stream);
-
-      WireFormatLite::WriteEnum(
-          mesos::v1::master::Response::kTypeFieldNumber,
+      return streamProtobuf(
           mesos::v1::master::Response::GET_TASKS,
-          &writer);
-
-      WireFormatLite::WriteBytes(
-          mesos::v1::master::Response::kGetTasksFieldNumber,
-          serializeGetTasks(approvers),
-          &writer);
-
-      // We must manually trim the unused buffer space since
-      // we use the string before the coded output stream is
-      // destructed.
-      writer.Trim();
-
-      return pair<Response, Option<Master::ReadOnlyHandler::PostProcessing>>(
-          OK(std::move(output), stringify(outputContentType)),
-          None());
+          serializeGetTasks(
+              approvers,
+              selector.get(),
+              {mesos::v1::master::Response::kGetTasksFieldNumber}));
     }
 
     case ContentType::JSON: {
@@ -2132,7 +3438,7 @@ pair<Response, Option<Master::ReadOnlyHandler::PostProcessing>>
         field = v1::master::Response::kGetTasksFieldNumber;
         writer->field(
             descriptor->FindFieldByNumber(field)->name(),
-            jsonifyGetTasks(approvers));
+            jsonifyGetTasks(approvers, selector.get()));
       });
 
       // TODO(bmahler): Pass jsonp query parameter through here.
@@ -2271,7 +3577,9 @@ pair<Response, Option<Master::ReadOnlyHandler::PostProcessing>>
 
 
 function<void(JSON::ObjectWriter*)> Master::ReadOnlyHandler::jsonifyGetState(
-    const Owned<ObjectApprovers>& approvers) const
+    const Owned<ObjectApprovers>& approvers,
+    const TaskSelector& taskSelector,
+    const FrameworkSelector& frameworkSelector) const
 {
   // Jsonify the following message:
   //
@@ -2291,7 +3599,7 @@ function<void(JSON::ObjectWriter*)> Master::ReadOnlyHandler::jsonifyGetState(
     field = v1::master::Response::GetState::kGetTasksFieldNumber;
     writer->field(
         descriptor->FindFieldByNumber(field)->name(),
-        jsonifyGetTasks(approvers));
+        jsonifyGetTasks(approvers, taskSelector));
 
     field = v1::master::Response::GetState::kGetExecutorsFieldNumber;
     writer->field(
@@ -2301,7 +3609,7 @@ function<void(JSON::ObjectWriter*)> Master::ReadOnlyHandler::jsonifyGetState(
     field = v1::master::Response::GetState::kGetFrameworksFieldNumber;
     writer->field(
         descriptor->FindFieldByNumber(field)->name(),
-        jsonifyGetFrameworks(approvers));
+        jsonifyGetFrameworks(approvers, frameworkSelector));
 
     field = v1::master::Response::GetState::kGetAgentsFieldNumber;
     writer->field(
@@ -2311,8 +3619,11 @@ function<void(JSON::ObjectWriter*)> Master::ReadOnlyHandler::jsonifyGetState(
 }
 
 
-string Master::ReadOnlyHandler::serializeGetState(
-    const Owned<ObjectApprovers>& approvers) const
+vector<ProtobufStep> Master::ReadOnlyHandler::serializeGetState(
+    const Owned<ObjectApprovers>& approvers,
+    const TaskSelector& taskSelector,
+    const FrameworkSelector& frameworkSelector,
+    const vector<int>& path) const
 {
   // Serialize the following message:
   //
@@ -2322,38 +3633,34 @@ string Master::ReadOnlyHandler::serializeGetState(
   //   *getState.mutable_get_frameworks() = _getFrameworks(approvers);
   //   *getState.mutable_get_agents() = _getAgents(approvers);
 
-  string output;
-  google::protobuf::io::StringOutputStream stream(&output);
-  google::protobuf::io::CodedOutputStream writer(&stream);
-
-  WireFormatLite::WriteBytes(
-      mesos::v1::master::Response::GetState::kGetTasksFieldNumber,
-      serializeGetTasks(approvers),
-      &writer);
-
-  WireFormatLite::WriteBytes(
-      mesos::v1::master::Response::GetState::kGetExecutorsFieldNumber,
-      serializeGetExecutors(approvers),
-      &writer);
+  typedef mesos::v1::master::Response::GetState GetState;
 
-  WireFormatLite::WriteBytes(
-      mesos::v1::master::Response::GetState::kGetFrameworksFieldNumber,
-      serializeGetFrameworks(approvers),
-      &writer);
+  // Returns the path of the given field of the `GetState` message.
+  auto field = [&path](int number) {
+    vector<int> result = path;
+    result.push_back(number);
+    return result;
+  };
 
-  WireFormatLite::WriteBytes(
-      mesos::v1::master::Response::GetState::kGetAgentsFieldNumber,
-      serializeGetAgents(approvers),
-      &writer);
+  const vector<vector<ProtobufStep>> fields = {
+    serializeGetTasks(
+        approvers, taskSelector, field(GetState::kGetTasksFieldNumber)),
+    serializeGetExecutors(
+        approvers, field(GetState::kGetExecutorsFieldNumber)),
+    serializeGetFrameworks(
+        approvers,
+        frameworkSelector,
+        field(GetState::kGetFrameworksFieldNumber)),
+    serializeGetAgents(
+        approvers, field(GetState::kGetAgentsFieldNumber))
+  };
 
-  // While an explicit Trim() isn't necessary (since the coded
-  // output stream is destructed before the string is returned),
-  // it's a quite tricky bug to diagnose if Trim() is missed, so
-  // we always do it explicitly to signal the reader about this
-  // subtlety.
-  writer.Trim();
+  vector<ProtobufStep> steps;
+  foreach (const vector<ProtobufStep>& fieldSteps, fields) {
+    steps.insert(steps.end(), fieldSteps.begin(), fieldSteps.end());
+  }
 
-  return output;
+  return steps;
 }
 
 
@@ -2369,30 +3676,39 @@ pair<Response, Option<Master::ReadOnlyHandler::PostProcessing>>
   //   response.set_type(mesos::master::Response::GET_STATE);
   //   *response.mutable_get_state() = _getState(approvers);
 
-  switch (outputContentType) {
-    case ContentType::PROTOBUF: {
-      string output;
-      google::protobuf::io::StringOutputStream stream(&output);
-      google::protobuf::io::CodedOutputStream writer(&stream);
+  Option<string> serialized = query.get("get_state");
 
-      WireFormatLite::WriteEnum(
-          mesos::v1::master::Response::kTypeFieldNumber,
-          mesos::v1::master::Response::GET_STATE,
-          &writer);
+  mesos::master::Call::GetState parameters;
+  if (serialized.isSome() && !parameters.ParseFromString(serialized.get())) {
+    return pair<Response, Option<Master::ReadOnlyHandler::PostProcessing>>(
+        BadRequest("Failed to parse 'get_state'"), None());
+  }
 
-      WireFormatLite::WriteBytes(
-          mesos::v1::master::Response::kGetStateFieldNumber,
-          serializeGetState(approvers),
-          &writer);
+  Try<TaskSelector> taskSelector =
+    TaskSelector::create(parameters.get_tasks());
 
-      // We must manually trim the unused buffer space since
-      // we use the string before the coded output stream is
-      // destructed.
-      writer.Trim();
+  if (taskSelector.isError()) {
+    return pair<Response, Option<Master::ReadOnlyHandler::PostProcessing>>(
+        BadRequest(taskSelector.error()), None());
+  }
 
-      return pair<Response, Option<Master::ReadOnlyHandler::PostProcessing>>(
-          OK(std::move(output), stringify(outputContentType)),
-          None());
+  Try<FrameworkSelector> frameworkSelector =
+    FrameworkSelector::create(parameters.get_frameworks());
+
+  if (frameworkSelector.isError()) {
+    return pair<Response, Option<Master::ReadOnlyHandler::PostProcessing>>(
+        BadRequest(frameworkSelector.error()), None());
+  }
+
+  switch (outputContentType) {
+    case ContentType::PROTOBUF: {
+      return streamProtobuf(
+          mesos::v1::master::Response::GET_STATE,
+          serializeGetState(
+              approvers,
+              taskSelector.get(),
+              frameworkSelector.get(),
+              {mesos::v1::master::Response::kGetStateFieldNumber}));
     }
 
     case ContentType::JSON: {
@@ -2411,7 +3727,8 @@ pair<Response, Option<Master::ReadOnlyHandler::PostProcessing>>
         field = v1::master::Response::kGetStateFieldNumber;
         writer->field(
             descriptor->FindFieldByNumber(field)->name(),
-            jsonifyGetState(approvers));
+            jsonifyGetState(
+                approvers, taskSelector.get(), frameworkSelector.get()));
       });
 
       // TODO(bmahler): Pass jsonp query parameter through here.
@@ -2544,7 +3861,7 @@ function<void(JSON::ObjectWriter*)> Master::ReadOnlyHandler::jsonifySubscribe(
     field = v1::master::Event::Subscribed::kGetStateFieldNumber;
     writer->field(
         descriptor->FindFieldByNumber(field)->name(),
-        jsonifyGetState(approvers));
+        jsonifyGetState(approvers, TaskSelector(), FrameworkSelector()));
 
     field = v1::master::Event::Subscribed::kHeartbeatIntervalSecondsFieldNumber;
     writer->field(
@@ -2570,7 +3887,8 @@ string Master::ReadOnlyHandler::serializeSubscribe(
 
   WireFormatLite::WriteBytes(
       mesos::v1::master::Event::Subscribed::kGetStateFieldNumber,
-      serializeGetState(approvers),
+      serializeSteps(serializeGetState(
+          approvers, TaskSelector(), FrameworkSelector(), {})),
       &writer);
 
   WireFormatLite::WriteDouble(
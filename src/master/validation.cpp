@@ -887,6 +887,15 @@ Option<Error> validate(
       }
       return None();
 
+    case mesos::scheduler::Call::BATCH:
+      if (!call.has_batch()) {
+        return Error("Expecting 'batch' to be present");
+      }
+
+      // NOTE: The acknowledgement UUIDs are validated per item by the
+      // master so that a single malformed item doesn't reject the batch.
+      return None();
+
     case mesos::scheduler::Call::UNKNOWN:
       return None();
   }
@@ -297,21 +297,20 @@ Future<http::Response> ResourceProviderManagerProcess::api(
             return BadRequest("Failed to parse body into Call protobuf");
           }
         } else if (contentType.get() == APPLICATION_JSON) {
-          Try<JSON::Value> value = JSON::parse(request.body);
-          if (value.isError()) {
+          Try<Try<v1::resource_provider::Call>> parse =
+            ::protobuf::parseJSON<v1::resource_provider::Call>(request.body);
+
+          if (parse.isError()) {
             return BadRequest(
-                "Failed to parse body into JSON: " + value.error());
+                "Failed to parse body into JSON: " + parse.error());
           }
 
-          Try<v1::resource_provider::Call> parse =
-            ::protobuf::parse<v1::resource_provider::Call>(value.get());
-
-          if (parse.isError()) {
+          if (parse->isError()) {
             return BadRequest(
-                "Failed to convert JSON into Call protobuf: " + parse.error());
+                "Failed to convert JSON into Call protobuf: " + parse->error());
           }
 
-          v1Call = parse.get();
+          v1Call = parse->get();
         } else {
           return UnsupportedMediaType(
               string("Expecting 'Content-Type' of ") + APPLICATION_JSON +
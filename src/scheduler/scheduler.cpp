@@ -645,8 +645,40 @@ protected:
       return;
     }
 
+    if (response->code == process::http::Status::OK &&
+        call.type() == Call::BATCH) {
+      // The results of the items of a batch are only returned to the
+      // scheduler by `call()`, so we just log the dropped items here.
+      Try<Response> result = deserialize<Response>(contentType, response->body);
+
+      if (result.isError()) {
+        LOG(WARNING) << "Failed to deserialize the response '"
+                     << response->status << "' for " << call.type() << ": "
+                     << result.error();
+        return;
+      }
+
+      auto log = [](
+          const string& type,
+          const google::protobuf::RepeatedPtrField<
+              Response::Batch::Result>& results) {
+        for (int i = 0; i < results.size(); ++i) {
+          if (results.Get(i).has_error()) {
+            LOG(WARNING) << "Dropped " << type << " " << i << " of "
+                         << Call::BATCH << ": " << results.Get(i).error();
+          }
+        }
+      };
+
+      log("kill", result->batch().kills());
+      log("acknowledgement", result->batch().acknowledges());
+      log("decline", result->batch().declines());
+
+      return;
+    }
+
     if (response->code == process::http::Status::OK) {
-      // Only SUBSCRIBE call should get a "200 OK" response.
+      // Only SUBSCRIBE and BATCH calls should get a "200 OK" response.
       CHECK_EQ(Call::SUBSCRIBE, call.type());
       CHECK_EQ(response->type, process::http::Response::PIPE);
       CHECK_SOME(response->reader);
@@ -0,0 +1,834 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "slave/checkpoint_log.hpp"
+
+#include <stdint.h>
+#include <string.h>
+
+#include <zlib.h>
+
+#include <list>
+#include <utility>
+#include <vector>
+
+#include <glog/logging.h>
+
+#include <stout/bytes.hpp>
+#include <stout/error.hpp>
+#include <stout/foreach.hpp>
+#include <stout/none.hpp>
+#include <stout/path.hpp>
+#include <stout/result.hpp>
+#include <stout/stringify.hpp>
+#include <stout/strings.hpp>
+
+#include <stout/os/close.hpp>
+#include <stout/os/exists.hpp>
+#include <stout/os/fsync.hpp>
+#include <stout/os/ftruncate.hpp>
+#include <stout/os/ls.hpp>
+#include <stout/os/lseek.hpp>
+#include <stout/os/mkdir.hpp>
+#include <stout/os/mktemp.hpp>
+#include <stout/os/open.hpp>
+#include <stout/os/read.hpp>
+#include <stout/os/rename.hpp>
+#include <stout/os/rm.hpp>
+#include <stout/os/stat.hpp>
+#include <stout/os/write.hpp>
+
+#include "slave/constants.hpp"
+#include "slave/paths.hpp"
+#include "slave/state.pb.h"
+
+using std::list;
+using std::map;
+using std::string;
+using std::vector;
+
+namespace mesos {
+namespace internal {
+namespace slave {
+
+// Every record of the log is preceded by its size and the CRC32 of its
+// serialized bytes, both in host byte order (like `protobuf::write`).
+static const size_t HEADER_SIZE = 2 * sizeof(uint32_t);
+
+
+static string encode(const CheckpointRecord& record)
+{
+  const string bytes = record.SerializeAsString();
+
+  const uint32_t size = bytes.size();
+  const uint32_t crc = ::crc32(
+      0L, reinterpret_cast<const Bytef*>(bytes.data()), bytes.size());
+
+  string result;
+  result.reserve(HEADER_SIZE + bytes.size());
+  result.append(reinterpret_cast<const char*>(&size), sizeof(size));
+  result.append(reinterpret_cast<const char*>(&crc), sizeof(crc));
+  result.append(bytes);
+
+  return result;
+}
+
+
+// Reads `length` bytes at `offset` of the log.
+static Try<string> read(int_fd fd, size_t offset, size_t length)
+{
+  Try<off_t> seek = os::lseek(fd, offset, SEEK_SET);
+  if (seek.isError()) {
+    return Error(seek.error());
+  }
+
+  Result<string> read = os::read(fd, length);
+  if (read.isError()) {
+    return Error(read.error());
+  }
+
+  if (read.isNone() || read->size() != length) {
+    return Error("Unexpected end of file");
+  }
+
+  return read.get();
+}
+
+
+// Decodes the record encoded in `data` (see `encode()`). Returns none
+// if the record is corrupted.
+static Option<CheckpointRecord> decode(const string& data)
+{
+  if (data.size() < HEADER_SIZE) {
+    return None();
+  }
+
+  uint32_t size;
+  uint32_t crc;
+  memcpy(&size, data.data(), sizeof(size));
+  memcpy(&crc, data.data() + sizeof(size), sizeof(crc));
+
+  if (data.size() - HEADER_SIZE != size) {
+    return None();
+  }
+
+  const char* bytes = data.data() + HEADER_SIZE;
+
+  if (::crc32(0L, reinterpret_cast<const Bytef*>(bytes), size) != crc) {
+    return None();
+  }
+
+  CheckpointRecord record;
+  if (!record.ParseFromArray(bytes, size)) {
+    return None();
+  }
+
+  return record;
+}
+
+
+// Applies the record found at `offset` of the log, taking up `length`
+// bytes, to the files held by the log and keeps track of the number of
+// bytes they take up in `live`.
+template <typename File>
+static void apply(
+    const CheckpointRecord& record,
+    size_t offset,
+    size_t length,
+    map<string, File>* files,
+    size_t* live)
+{
+  const string& path = record.path();
+
+  switch (record.type()) {
+    case CheckpointRecord::WRITE: {
+      auto file = files->find(path);
+      if (file != files->end()) {
+        *live -= file->first.size() + file->second.size;
+      }
+
+      File& _file = (*files)[path];
+      _file.records.assign(1, std::make_pair(offset, length));
+      _file.size = record.data().size();
+
+      *live += path.size() + record.data().size();
+      break;
+    }
+    case CheckpointRecord::APPEND: {
+      auto file = files->find(path);
+      if (file == files->end()) {
+        file = files->emplace(path, File()).first;
+        file->second.size = 0;
+        *live += path.size();
+      }
+
+      file->second.records.push_back(std::make_pair(offset, length));
+      file->second.size += record.data().size();
+
+      *live += record.data().size();
+      break;
+    }
+    case CheckpointRecord::REMOVE: {
+      auto file = files->find(path);
+      if (file != files->end()) {
+        *live -= file->first.size() + file->second.size;
+        files->erase(file);
+      }
+
+      // NOTE: We look for the files under `path` separately since
+      // e.g. 'path.info' sorts in between 'path' and 'path/...'.
+      const string prefix = path + "/";
+
+      file = files->lower_bound(prefix);
+      while (file != files->end() && strings::startsWith(file->first, prefix)) {
+        *live -= file->first.size() + file->second.size;
+        file = files->erase(file);
+      }
+      break;
+    }
+  }
+}
+
+
+// Collects the files under `directory` (skipping symlinks) into
+// `files`, keyed by their path relative to `rootDir`.
+static Try<Nothing> collect(
+    const string& rootDir,
+    const string& directory,
+    map<string, string>* files)
+{
+  Try<list<string>> entries = os::ls(directory);
+  if (entries.isError()) {
+    return Error(
+        "Failed to list '" + directory + "': " + entries.error());
+  }
+
+  foreach (const string& entry, entries.get()) {
+    const string path = path::join(directory, entry);
+
+    if (os::stat::islink(path)) {
+      continue;
+    }
+
+    if (os::stat::isdir(path)) {
+      Try<Nothing> collect = slave::collect(rootDir, path, files);
+      if (collect.isError()) {
+        return collect;
+      }
+
+      continue;
+    }
+
+    Try<string> read = os::read(path);
+    if (read.isError()) {
+      return Error("Failed to read '" + path + "': " + read.error());
+    }
+
+    (*files)[path.substr(rootDir.size() + 1)] = read.get();
+  }
+
+  return Nothing();
+}
+
+
+Try<std::shared_ptr<CheckpointLog>> CheckpointLog::open(
+    const string& _rootDir,
+    bool strict)
+{
+  const string rootDir = strings::remove(_rootDir, "/", strings::SUFFIX);
+  const string path = paths::getCheckpointLogPath(rootDir);
+
+  if (!os::exists(path)) {
+    Try<Nothing> mkdir = os::mkdir(rootDir);
+    if (mkdir.isError()) {
+      return Error(
+          "Failed to create directory '" + rootDir + "': " + mkdir.error());
+    }
+
+    // Migrate the checkpointed files of all the agents to the log.
+    map<string, string> files;
+
+    const string slavesDir = path::join(rootDir, paths::SLAVES_DIR);
+    if (os::exists(slavesDir)) {
+      Try<list<string>> entries = os::ls(slavesDir);
+      if (entries.isError()) {
+        return Error(
+            "Failed to list '" + slavesDir + "': " + entries.error());
+      }
+
+      foreach (const string& entry, entries.get()) {
+        const string frameworksDir =
+          path::join(slavesDir, entry, paths::FRAMEWORKS_DIR);
+
+        if (os::stat::islink(path::join(slavesDir, entry)) ||
+            !os::stat::isdir(frameworksDir)) {
+          continue;
+        }
+
+        Try<Nothing> collect = slave::collect(rootDir, frameworksDir, &files);
+        if (collect.isError()) {
+          return Error(collect.error());
+        }
+      }
+    }
+
+    string data;
+    foreachpair (const string& file, const string& contents, files) {
+      CheckpointRecord record;
+      record.set_type(CheckpointRecord::WRITE);
+      record.set_path(file);
+      record.set_data(contents);
+
+      data += encode(record);
+    }
+
+    // The log replaces the files only once it has been committed, so
+    // an agent which crashes during the migration retries it.
+    Try<string> temp = os::mktemp(path + ".XXXXXX");
+    if (temp.isError()) {
+      return Error("Failed to create temporary file: " + temp.error());
+    }
+
+    Try<Nothing> write = os::write(temp.get(), data, true);
+    if (write.isError()) {
+      os::rm(temp.get());
+      return Error(
+          "Failed to write temporary file '" + temp.get() + "': " +
+          write.error());
+    }
+
+    Try<Nothing> rename = os::rename(temp.get(), path, true);
+    if (rename.isError()) {
+      os::rm(temp.get());
+      return Error(
+          "Failed to rename '" + temp.get() + "' to '" + path + "': " +
+          rename.error());
+    }
+
+    foreachkey (const string& file, files) {
+      Try<Nothing> rm = os::rm(path::join(rootDir, file));
+      if (rm.isError()) {
+        LOG(WARNING) << "Failed to remove checkpointed file '"
+                     << path::join(rootDir, file) << "' after moving it"
+                     << " to the checkpoint log: " << rm.error();
+      }
+    }
+
+    LOG(INFO) << "Moved " << files.size() << " checkpointed files to '"
+              << path << "'";
+  }
+
+  Try<int_fd> fd = os::open(path, O_RDWR | O_APPEND | O_CLOEXEC);
+  if (fd.isError()) {
+    return Error("Failed to open '" + path + "': " + fd.error());
+  }
+
+  Try<off_t> end = os::lseek(fd.get(), 0, SEEK_END);
+  if (end.isError()) {
+    os::close(fd.get());
+    return Error("Failed to seek '" + path + "': " + end.error());
+  }
+
+  map<string, File> files;
+  size_t live = 0;
+  size_t offset = 0;
+  size_t corrupted = 0;
+
+  // Replay the records one at a time rather than reading the whole log
+  // into memory. A record which extends past the end of the log has
+  // been torn by a crash, while a record that fails its checksum in
+  // the middle of the log can be skipped based on its size.
+  while (static_cast<size_t>(end.get()) - offset >= HEADER_SIZE) {
+    Try<string> header = slave::read(fd.get(), offset, HEADER_SIZE);
+    if (header.isError()) {
+      os::close(fd.get());
+      return Error("Failed to read '" + path + "': " + header.error());
+    }
+
+    uint32_t size;
+    memcpy(&size, header->data(), sizeof(size));
+
+    const size_t length = HEADER_SIZE + size;
+
+    if (static_cast<size_t>(end.get()) - offset < length) {
+      break;
+    }
+
+    Try<string> data = slave::read(fd.get(), offset, length);
+    if (data.isError()) {
+      os::close(fd.get());
+      return Error("Failed to read '" + path + "': " + data.error());
+    }
+
+    Option<CheckpointRecord> record = decode(data.get());
+    if (record.isNone()) {
+      if (strict) {
+        os::close(fd.get());
+        return Error(
+            "Found a corrupted record at offset " + stringify(offset) +
+            " of '" + path + "'");
+      }
+
+      LOG(WARNING) << "Skipping a corrupted record of " << Bytes(length)
+                   << " at offset " << offset << " of '" << path << "'";
+
+      corrupted++;
+      offset += length;
+      continue;
+    }
+
+    apply(record.get(), offset, length, &files, &live);
+
+    offset += length;
+  }
+
+  // Drop whatever follows the last valid record, which is a record
+  // torn by a crash while it was being appended, so that the records
+  // appended from now on can be replayed.
+  if (offset < static_cast<size_t>(end.get())) {
+    LOG(WARNING) << "Truncating " << (end.get() - offset) << " bytes of"
+                 << " invalid records at the end of '" << path << "'";
+
+    Try<Nothing> truncate = os::ftruncate(fd.get(), offset);
+    if (truncate.isError()) {
+      os::close(fd.get());
+      return Error("Failed to truncate '" + path + "': " + truncate.error());
+    }
+  }
+
+  std::shared_ptr<CheckpointLog> log(
+      new CheckpointLog(rootDir, fd.get(), std::move(files), offset, live));
+
+  // Rewrite the log without the corrupted records, so that they are
+  // not skipped again on every restart.
+  if (corrupted > 0) {
+    Try<Nothing> compact = log->compact();
+    if (compact.isError()) {
+      return Error("Failed to compact '" + path + "': " + compact.error());
+    }
+  }
+
+  return log;
+}
+
+
+Try<Nothing> CheckpointLog::restore(const string& rootDir, bool strict)
+{
+  const string path = paths::getCheckpointLogPath(rootDir);
+
+  if (!os::exists(path)) {
+    return Nothing();
+  }
+
+  Try<std::shared_ptr<CheckpointLog>> log = open(rootDir, strict);
+  if (log.isError()) {
+    return Error(log.error());
+  }
+
+  size_t restored = 0;
+
+  foreachpair (const string& file, const File& _file, log.get()->files) {
+    const string filePath = path::join(log.get()->rootDir, file);
+
+    // The directory of the file has been garbage collected.
+    if (!os::exists(Path(filePath).dirname())) {
+      continue;
+    }
+
+    Try<string> data = log.get()->_read(_file);
+    if (data.isError()) {
+      return Error(
+          "Failed to read '" + filePath + "' from '" + path + "': " +
+          data.error());
+    }
+
+    Try<Nothing> write = os::write(filePath, data.get(), true);
+    if (write.isError()) {
+      return Error("Failed to write '" + filePath + "': " + write.error());
+    }
+
+    restored++;
+  }
+
+  Try<Nothing> rm = os::rm(path);
+  if (rm.isError()) {
+    return Error("Failed to remove '" + path + "': " + rm.error());
+  }
+
+  LOG(INFO) << "Moved " << restored << " checkpointed files out of '"
+            << path << "'";
+
+  return Nothing();
+}
+
+
+CheckpointLog::CheckpointLog(
+    const string& _rootDir,
+    int_fd _fd,
+    map<string, File>&& _files,
+    size_t _size,
+    size_t _live)
+  : rootDir(_rootDir),
+    path(paths::getCheckpointLogPath(_rootDir)),
+    fd(_fd),
+    files(std::move(_files)),
+    size(_size),
+    live(_live),
+    synced(_size) {}
+
+
+CheckpointLog::~CheckpointLog()
+{
+  os::close(fd);
+}
+
+
+bool CheckpointLog::covers(const string& path) const
+{
+  Option<string> relative = this->relative(path);
+  if (relative.isNone()) {
+    return false;
+  }
+
+  // Only the files under 'slaves/<slave_id>/frameworks' are held by
+  // the log, see `paths.hpp` for the layout of the meta directory.
+  const vector<string> components = strings::tokenize(relative.get(), "/");
+
+  return components.size() > 3 &&
+         components[0] == paths::SLAVES_DIR &&
+         components[2] == paths::FRAMEWORKS_DIR;
+}
+
+
+Try<Nothing> CheckpointLog::write(
+    const string& path,
+    const string& data,
+    bool sync)
+{
+  Option<string> relative = this->relative(path);
+  if (relative.isNone()) {
+    return Error("'" + path + "' is not under '" + rootDir + "'");
+  }
+
+  CheckpointRecord record;
+  record.set_type(CheckpointRecord::WRITE);
+  record.set_path(relative.get());
+  record.set_data(data);
+
+  return log(record, sync);
+}
+
+
+Try<Nothing> CheckpointLog::append(
+    const string& path,
+    const string& data,
+    bool sync)
+{
+  Option<string> relative = this->relative(path);
+  if (relative.isNone()) {
+    return Error("'" + path + "' is not under '" + rootDir + "'");
+  }
+
+  CheckpointRecord record;
+  record.set_type(CheckpointRecord::APPEND);
+  record.set_path(relative.get());
+  record.set_data(data);
+
+  return log(record, sync);
+}
+
+
+Try<Nothing> CheckpointLog::remove(const string& path, bool sync)
+{
+  Option<string> relative = this->relative(path);
+  if (relative.isNone()) {
+    return Error("'" + path + "' is not under '" + rootDir + "'");
+  }
+
+  // Most of the directories removed by the agent (e.g., the sandboxes)
+  // do not hold any checkpointed files, so we avoid logging a record.
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    const string prefix = relative.get() + "/";
+    auto file = files.lower_bound(prefix);
+
+    if (files.count(relative.get()) == 0 &&
+        (file == files.end() || !strings::startsWith(file->first, prefix))) {
+      return Nothing();
+    }
+  }
+
+  CheckpointRecord record;
+  record.set_type(CheckpointRecord::REMOVE);
+  record.set_path(relative.get());
+
+  return log(record, sync);
+}
+
+
+bool CheckpointLog::exists(const string& path) const
+{
+  Option<string> relative = this->relative(path);
+  if (relative.isNone()) {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
+
+  return files.count(relative.get()) > 0;
+}
+
+
+Result<string> CheckpointLog::read(const string& path) const
+{
+  Option<string> relative = this->relative(path);
+  if (relative.isNone()) {
+    return None();
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
+
+  auto file = files.find(relative.get());
+  if (file == files.end()) {
+    return None();
+  }
+
+  Try<string> data = _read(file->second);
+  if (data.isError()) {
+    return Error(
+        "Failed to read '" + path + "' from '" + this->path + "': " +
+        data.error());
+  }
+
+  return data.get();
+}
+
+
+Try<Nothing> CheckpointLog::compact()
+{
+  std::lock_guard<std::mutex> syncLock(syncMutex);
+  std::lock_guard<std::mutex> lock(mutex);
+
+  return _compact();
+}
+
+
+Try<Nothing> CheckpointLog::log(const CheckpointRecord& record, bool sync)
+{
+  const string bytes = encode(record);
+
+  size_t offset;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    Try<Nothing> write = os::write(fd, bytes);
+    if (write.isError()) {
+      // Drop the partially written record, since the records appended
+      // after it could not be replayed otherwise.
+      os::ftruncate(fd, size);
+
+      return Error("Failed to append to '" + path + "': " + write.error());
+    }
+
+    apply(record, size, bytes.size(), &files, &live);
+
+    size += bytes.size();
+    offset = size;
+  }
+
+  if (sync) {
+    std::lock_guard<std::mutex> lock(syncMutex);
+
+    // Unless another writer has already flushed this record along with
+    // its own, flush everything appended so far on behalf of the
+    // writers waiting behind us.
+    if (synced < offset) {
+      size_t flushed;
+
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        flushed = size;
+      }
+
+      Try<Nothing> fsync = os::fsync(fd);
+      if (fsync.isError()) {
+        return Error("Failed to sync '" + path + "': " + fsync.error());
+      }
+
+      synced = flushed;
+    }
+  }
+
+  maybeCompact();
+
+  return Nothing();
+}
+
+
+Try<string> CheckpointLog::_read(const File& file) const
+{
+  string data;
+  data.reserve(file.size);
+
+  foreach (const auto& location, file.records) {
+    Try<string> bytes = slave::read(fd, location.first, location.second);
+    if (bytes.isError()) {
+      return Error(bytes.error());
+    }
+
+    Option<CheckpointRecord> record = decode(bytes.get());
+    if (record.isNone()) {
+      return Error(
+          "Found a corrupted record at offset " + stringify(location.first));
+    }
+
+    data += record->data();
+  }
+
+  return data;
+}
+
+
+Option<string> CheckpointLog::relative(const string& path) const
+{
+  if (!strings::startsWith(path, rootDir + "/")) {
+    return None();
+  }
+
+  return path.substr(rootDir.size() + 1);
+}
+
+
+void CheckpointLog::maybeCompact()
+{
+  auto due = [this]() {
+    return size >= CHECKPOINT_LOG_COMPACTION_MIN_SIZE.bytes() &&
+           size >= CHECKPOINT_LOG_COMPACTION_RATIO * live;
+  };
+
+  // Check the thresholds first, so that writers only wait for those
+  // flushing the log when the log is actually compacted.
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (!due()) {
+      return;
+    }
+  }
+
+  std::lock_guard<std::mutex> syncLock(syncMutex);
+  std::lock_guard<std::mutex> lock(mutex);
+
+  // Another writer may have compacted the log in the meantime.
+  if (!due()) {
+    return;
+  }
+
+  Try<Nothing> compact = _compact();
+  if (compact.isError()) {
+    LOG(WARNING) << "Failed to compact '" << path << "': " << compact.error();
+  }
+}
+
+
+Try<Nothing> CheckpointLog::_compact()
+{
+  Try<string> temp = os::mktemp(path + ".XXXXXX");
+  if (temp.isError()) {
+    return Error("Failed to create temporary file: " + temp.error());
+  }
+
+  Try<int_fd> compacted = os::open(temp.get(), O_RDWR | O_APPEND | O_CLOEXEC);
+  if (compacted.isError()) {
+    os::rm(temp.get());
+    return Error(
+        "Failed to open temporary file '" + temp.get() + "': " +
+        compacted.error());
+  }
+
+  // Write a single record per file, one file at a time, and keep track
+  // of their locations in the compacted log.
+  map<string, File> _files;
+  size_t _size = 0;
+
+  foreachpair (const string& file, const File& _file, files) {
+    Try<string> contents = _read(_file);
+    if (contents.isError()) {
+      os::close(compacted.get());
+      os::rm(temp.get());
+      return Error(
+          "Failed to read '" + file + "': " + contents.error());
+    }
+
+    CheckpointRecord record;
+    record.set_type(CheckpointRecord::WRITE);
+    record.set_path(file);
+    record.set_data(contents.get());
+
+    const string bytes = encode(record);
+
+    Try<Nothing> write = os::write(compacted.get(), bytes);
+    if (write.isError()) {
+      os::close(compacted.get());
+      os::rm(temp.get());
+      return Error(
+          "Failed to write temporary file '" + temp.get() + "': " +
+          write.error());
+    }
+
+    File& compactedFile = _files[file];
+    compactedFile.records.assign(1, std::make_pair(_size, bytes.size()));
+    compactedFile.size = _file.size;
+
+    _size += bytes.size();
+  }
+
+  Try<Nothing> fsync = os::fsync(compacted.get());
+  if (fsync.isError()) {
+    os::close(compacted.get());
+    os::rm(temp.get());
+    return Error(
+        "Failed to sync temporary file '" + temp.get() + "': " +
+        fsync.error());
+  }
+
+  Try<Nothing> rename = os::rename(temp.get(), path, true);
+  if (rename.isError()) {
+    os::close(compacted.get());
+    os::rm(temp.get());
+    return Error(
+        "Failed to rename '" + temp.get() + "' to '" + path + "': " +
+        rename.error());
+  }
+
+  VLOG(1) << "Compacted '" << path << "' from " << Bytes(size) << " to "
+          << Bytes(_size);
+
+  os::close(fd);
+
+  fd = compacted.get();
+  files = std::move(_files);
+  size = _size;
+  synced = size;
+
+  return Nothing();
+}
+
+} // namespace slave {
+} // namespace internal {
+} // namespace mesos {
@@ -0,0 +1,179 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __SLAVE_CHECKPOINT_LOG_HPP__
+#define __SLAVE_CHECKPOINT_LOG_HPP__
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <stout/nothing.hpp>
+#include <stout/option.hpp>
+#include <stout/result.hpp>
+#include <stout/try.hpp>
+
+#include <stout/os/int_fd.hpp>
+
+namespace mesos {
+namespace internal {
+namespace slave {
+
+// Forward declarations.
+class CheckpointRecord;
+
+
+// Stores the contents of the files that the agent checkpoints for its
+// frameworks, executors and tasks (i.e., everything under
+// 'slaves/<slave_id>/frameworks' of the meta directory) in a single
+// append-only log instead of one file each. Every record of the log is
+// checksummed, so a record torn by a crash is detected and dropped
+// when the log is replayed. Only the locations of the records are kept
+// in memory; the contents of the files are read back from the log. The
+// directories and the 'latest' symlinks of the meta directory stay on
+// disk, which keeps the recovery and the garbage collection of the
+// agent walking the same tree.
+//
+// Writes which ask for `sync` are group committed: a single
+// `fdatasync` covers all the records appended before it, so the
+// checkpoints of concurrent task launches share the cost of flushing
+// the log. The log is compacted once it has grown to several times the
+// size of the data it holds.
+//
+// NOTE: This class is thread-safe, since the agent recovers its state
+// on multiple threads (see `state::recover`).
+class CheckpointLog
+{
+public:
+  // Opens the log of the meta directory `rootDir`, replaying it and
+  // truncating any torn record at its end. A corrupted record in the
+  // middle of the log is skipped, unless `strict` is set in which case
+  // opening the log fails. If there is no log yet, it is created from
+  // the checkpointed files found under `rootDir` which are then
+  // removed, i.e., the agent's checkpoints are migrated to the log.
+  static Try<std::shared_ptr<CheckpointLog>> open(
+      const std::string& rootDir,
+      bool strict);
+
+  // Writes the files held by the log of the meta directory `rootDir`
+  // back to disk and removes the log, i.e., migrates the checkpoints
+  // back to one file each. This is a no-op if there is no log.
+  static Try<Nothing> restore(const std::string& rootDir, bool strict);
+
+  ~CheckpointLog();
+
+  // Returns true if the file at `path` is stored in this log.
+  bool covers(const std::string& path) const;
+
+  // Replaces the contents of the file at `path`. If `sync` is true,
+  // this returns once the write has been flushed to disk.
+  Try<Nothing> write(
+      const std::string& path,
+      const std::string& data,
+      bool sync = false);
+
+  // Appends `data` to the file at `path`, creating it if needed.
+  Try<Nothing> append(
+      const std::string& path,
+      const std::string& data,
+      bool sync = false);
+
+  // Removes the file at `path` along with all the files under it.
+  Try<Nothing> remove(const std::string& path, bool sync = false);
+
+  bool exists(const std::string& path) const;
+
+  // Returns the contents of the file at `path`, or none if the log
+  // does not hold it.
+  Result<std::string> read(const std::string& path) const;
+
+  // Rewrites the log such that it holds a single record per file.
+  Try<Nothing> compact();
+
+private:
+  // A file held by the log.
+  struct File
+  {
+    // The offsets and lengths of the records holding the contents of
+    // the file, i.e., of its last write and the appends following it.
+    std::vector<std::pair<size_t, size_t>> records;
+
+    // Size of the contents of the file.
+    size_t size;
+  };
+
+  CheckpointLog(
+      const std::string& rootDir,
+      int_fd fd,
+      std::map<std::string, File>&& files,
+      size_t size,
+      size_t live);
+
+  CheckpointLog(const CheckpointLog&) = delete;
+  CheckpointLog& operator=(const CheckpointLog&) = delete;
+
+  // Appends the record to the log and applies it to `files`.
+  Try<Nothing> log(const CheckpointRecord& record, bool sync);
+
+  // Reads the contents of the file from the log; requires `mutex` to
+  // be held.
+  Try<std::string> _read(const File& file) const;
+
+  // Returns the path relative to `rootDir`, which is the key of the
+  // file in `files`.
+  Option<std::string> relative(const std::string& path) const;
+
+  // Compacts the log if it has grown past the thresholds.
+  void maybeCompact();
+
+  // Rewrites the log; requires both `syncMutex` and `mutex` to be held.
+  Try<Nothing> _compact();
+
+  const std::string rootDir;
+  const std::string path;
+
+  // Guards `fd` (including its offset, which reads move), `files`,
+  // `size` and `live`.
+  mutable std::mutex mutex;
+
+  int_fd fd;
+
+  // The files held by the log, keyed by their path relative to
+  // `rootDir`. We use an ordered map so that removing a directory only
+  // visits the files under it.
+  std::map<std::string, File> files;
+
+  // Size of the log and of the data it holds, which together decide
+  // when to compact.
+  size_t size;
+  size_t live;
+
+  // Serializes flushing the log. It is acquired before `mutex` by
+  // compaction, which replaces `fd`.
+  std::mutex syncMutex;
+
+  // Size of the log known to be flushed to disk; guarded by `syncMutex`.
+  size_t synced;
+};
+
+} // namespace slave {
+} // namespace internal {
+} // namespace mesos {
+
+#endif // __SLAVE_CHECKPOINT_LOG_HPP__
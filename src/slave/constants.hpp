@@ -86,6 +86,15 @@ constexpr Duration DISK_WATCH_INTERVAL = Minutes(1);
 // Minimum free disk capacity enforced by the garbage collector.
 constexpr double GC_DISK_HEADROOM = 0.1;
 
+// Default number of paths the garbage collector removes in parallel.
+constexpr size_t GC_PARALLELISM = 4;
+
+// The checkpoint log is compacted once it is larger than this size and
+// `CHECKPOINT_LOG_COMPACTION_RATIO` times larger than the checkpointed
+// data it holds.
+constexpr Bytes CHECKPOINT_LOG_COMPACTION_MIN_SIZE = Megabytes(4);
+constexpr size_t CHECKPOINT_LOG_COMPACTION_RATIO = 4;
+
 // Maximum number of completed frameworks to store in memory.
 constexpr size_t MAX_COMPLETED_FRAMEWORKS = 50;
 
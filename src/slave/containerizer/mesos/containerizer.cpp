@@ -24,6 +24,7 @@
 
 #include <mesos/slave/isolator.hpp>
 
+#include <process/async.hpp>
 #include <process/collect.hpp>
 #include <process/defer.hpp>
 #include <process/http.hpp>
@@ -102,6 +103,7 @@
 
 #include "slave/containerizer/mesos/isolators/appc/runtime.hpp"
 #include "slave/containerizer/mesos/isolators/cgroups/cgroups.hpp"
+#include "slave/containerizer/mesos/isolators/cgroups2/cgroups2.hpp"
 #include "slave/containerizer/mesos/isolators/docker/runtime.hpp"
 #include "slave/containerizer/mesos/isolators/docker/volume/isolator.hpp"
 #include "slave/containerizer/mesos/isolators/filesystem/linux.hpp"
@@ -134,6 +136,7 @@
 #include "slave/containerizer/mesos/isolators/xfs/disk.hpp"
 #endif
 
+using process::async;
 using process::collect;
 using process::dispatch;
 using process::defer;
@@ -368,7 +371,9 @@ Try<MesosContainerizer*> MesosContainerizer::create(
   // The order of the entries in this table specifies the ordering of the
   // isolators. Specifically, the `create` and `prepare` calls for each
   // isolator are run serially in the order in which they appear in the
-  // table, while the `cleanup` call is serialized in reverse order.
+  // table (except that adjacent isolators supporting parallel preparation
+  // are prepared concurrently), while the `cleanup` call is serialized in
+  // reverse order.
   //
   // The ordering of isolators below is:
   //  - filesystem
@@ -436,6 +441,8 @@ Try<MesosContainerizer*> MesosContainerizer::create(
     {"cgroups/perf_event", &CgroupsIsolatorProcess::create},
     {"cgroups/pids", &CgroupsIsolatorProcess::create},
 
+    {"cgroups2/all", &Cgroups2IsolatorProcess::create},
+
     {"appc/runtime", &AppcRuntimeIsolatorProcess::create},
     {"docker/runtime", &DockerRuntimeIsolatorProcess::create},
 
@@ -1151,15 +1158,50 @@ Future<Nothing> MesosContainerizerProcess::recover(
 }
 
 
+// Reads the launch information checkpointed for the containers.
+static Try<hashmap<ContainerID, ContainerLaunchInfo>> getContainerLaunchInfos(
+    const string& runtimeDir,
+    const vector<ContainerState>& containers)
+{
+  hashmap<ContainerID, ContainerLaunchInfo> launchInfos;
+
+  foreach (const ContainerState& container, containers) {
+    const ContainerID& containerId = container.container_id();
+
+    Result<ContainerLaunchInfo> launchInfo =
+      containerizer::paths::getContainerLaunchInfo(runtimeDir, containerId);
+
+    if (launchInfo.isError()) {
+      return Error(
+          "Failed to recover launch information of container " +
+          stringify(containerId) + ": " + launchInfo.error());
+    }
+
+    if (launchInfo.isSome()) {
+      launchInfos.put(containerId, launchInfo.get());
+    }
+  }
+
+  return launchInfos;
+}
+
+
 Future<Nothing> MesosContainerizerProcess::_recover(
     const vector<ContainerState>& recoverable,
     const hashset<ContainerID>& orphans)
 {
+  // Read the launch information of the containers while the isolators
+  // and the provisioner recover, rather than one container after the
+  // other on this actor once they are done.
+  Future<Try<hashmap<ContainerID, ContainerLaunchInfo>>> launchInfos =
+    async(&getContainerLaunchInfos, flags.runtime_dir, recoverable);
+
   // Recover isolators first then recover the provisioner, because of
   // possible cleanups on unknown containers.
   return recoverIsolators(recoverable, orphans)
     .then(defer(self(), &Self::recoverProvisioner, recoverable, orphans))
-    .then(defer(self(), &Self::__recover, recoverable, orphans));
+    .then([launchInfos]() { return launchInfos; })
+    .then(defer(self(), &Self::__recover, recoverable, orphans, lambda::_1));
 }
 
 
@@ -1222,26 +1264,18 @@ Future<Nothing> MesosContainerizerProcess::recoverProvisioner(
 
 Future<Nothing> MesosContainerizerProcess::__recover(
     const vector<ContainerState>& recovered,
-    const hashset<ContainerID>& orphans)
+    const hashset<ContainerID>& orphans,
+    const Try<hashmap<ContainerID, ContainerLaunchInfo>>& launchInfos)
 {
-  // Recover containers' launch information.
-  foreach (const ContainerState& run, recovered) {
-    const ContainerID& containerId = run.container_id();
-
-    // Attempt to read container's launch information.
-    Result<ContainerLaunchInfo> containerLaunchInfo =
-      containerizer::paths::getContainerLaunchInfo(
-          flags.runtime_dir, containerId);
-
-    if (containerLaunchInfo.isError()) {
-      return Failure(
-          "Failed to recover launch information of container " +
-          stringify(containerId) + ": " + containerLaunchInfo.error());
-    }
+  if (launchInfos.isError()) {
+    return Failure(launchInfos.error());
+  }
 
-    if (containerLaunchInfo.isSome()) {
-      containers_[containerId]->launchInfo = containerLaunchInfo.get();
-    }
+  // Recover containers' launch information.
+  foreachpair (const ContainerID& containerId,
+               const ContainerLaunchInfo& launchInfo,
+               launchInfos.get()) {
+    containers_[containerId]->launchInfo = launchInfo;
   }
 
   foreach (const ContainerState& run, recovered) {
@@ -1587,9 +1621,10 @@ Future<Nothing> MesosContainerizerProcess::prepare(
 
   // We prepare the isolators sequentially according to their ordering
   // to permit basic dependency specification, e.g., preparing a
-  // filesystem isolator before other isolators.
-  Future<vector<Option<ContainerLaunchInfo>>> f =
-    vector<Option<ContainerLaunchInfo>>();
+  // filesystem isolator before other isolators. Adjacent isolators
+  // which support parallel preparation are batched and prepared
+  // concurrently, since they do not depend on each other.
+  vector<vector<Owned<Isolator>>> batches;
 
   foreach (const Owned<Isolator>& isolator, isolators) {
     if (!isSupportedByIsolator(
@@ -1599,11 +1634,35 @@ Future<Nothing> MesosContainerizerProcess::prepare(
       continue;
     }
 
-    // Chain together preparing each isolator.
+    if (batches.empty() ||
+        !isolator->supportsParallelPrepare() ||
+        !batches.back().back()->supportsParallelPrepare()) {
+      batches.emplace_back();
+    }
+
+    batches.back().push_back(isolator);
+  }
+
+  Future<vector<Option<ContainerLaunchInfo>>> f =
+    vector<Option<ContainerLaunchInfo>>();
+
+  foreach (const vector<Owned<Isolator>>& batch, batches) {
+    // Chain together preparing each batch of isolators.
     f = f.then([=](vector<Option<ContainerLaunchInfo>> launchInfos) {
-      return isolator->prepare(containerId, containerConfig)
-        .then([=](const Option<ContainerLaunchInfo>& launchInfo) mutable {
-          launchInfos.push_back(launchInfo);
+      vector<Future<Option<ContainerLaunchInfo>>> futures;
+      futures.reserve(batch.size());
+
+      foreach (const Owned<Isolator>& isolator, batch) {
+        futures.push_back(isolator->prepare(containerId, containerConfig));
+      }
+
+      // NOTE: `collect` preserves the order of the futures, so the
+      // launch infos are still merged in the order of the isolators.
+      return collect(futures)
+        .then([=](const vector<Option<ContainerLaunchInfo>>& _launchInfos)
+            mutable {
+          launchInfos.insert(
+              launchInfos.end(), _launchInfos.begin(), _launchInfos.end());
           return launchInfos;
         });
       });
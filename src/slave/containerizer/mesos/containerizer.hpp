@@ -34,6 +34,7 @@
 
 #include <stout/hashmap.hpp>
 #include <stout/multihashmap.hpp>
+#include <stout/try.hpp>
 #include <stout/os/int_fd.hpp>
 
 #include "slave/csi_server.hpp"
@@ -261,7 +262,9 @@ private:
 
   process::Future<Nothing> __recover(
       const std::vector<mesos::slave::ContainerState>& recovered,
-      const hashset<ContainerID>& orphans);
+      const hashset<ContainerID>& orphans,
+      const Try<hashmap<ContainerID, mesos::slave::ContainerLaunchInfo>>&
+        launchInfos);
 
   process::Future<Nothing> prepare(
       const ContainerID& containerId,
@@ -58,6 +58,12 @@ bool MesosIsolator::supportsStandalone()
 }
 
 
+bool MesosIsolator::supportsParallelPrepare()
+{
+  return process->supportsParallelPrepare();
+}
+
+
 Future<Nothing> MesosIsolator::recover(
     const vector<ContainerState>& state,
     const hashset<ContainerID>& orphans)
@@ -57,6 +57,12 @@ bool IsolatorTracker::supportsStandalone()
 }
 
 
+bool IsolatorTracker::supportsParallelPrepare()
+{
+  return isolator->supportsParallelPrepare();
+}
+
+
 Future<Nothing> IsolatorTracker::recover(
     const vector<ContainerState>& state,
     const hashset<ContainerID>& orphans)
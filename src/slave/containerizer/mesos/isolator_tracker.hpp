@@ -36,6 +36,7 @@ public:
 
   bool supportsNesting() override;
   bool supportsStandalone() override;
+  bool supportsParallelPrepare() override;
 
   process::Future<Nothing> recover(
       const std::vector<mesos::slave::ContainerState>& states,
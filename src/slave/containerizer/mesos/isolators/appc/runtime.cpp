@@ -68,6 +68,12 @@ bool AppcRuntimeIsolatorProcess::supportsStandalone()
 }
 
 
+bool AppcRuntimeIsolatorProcess::supportsParallelPrepare()
+{
+  return true;
+}
+
+
 Try<Isolator*> AppcRuntimeIsolatorProcess::create(const Flags& flags)
 {
   process::Owned<MesosIsolatorProcess> process(
@@ -199,6 +199,12 @@ bool CgroupsIsolatorProcess::supportsStandalone()
 }
 
 
+bool CgroupsIsolatorProcess::supportsParallelPrepare()
+{
+  return true;
+}
+
+
 Future<Nothing> CgroupsIsolatorProcess::recover(
     const vector<ContainerState>& states,
     const hashset<ContainerID>& orphans)
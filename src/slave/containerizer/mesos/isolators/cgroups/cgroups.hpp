@@ -52,6 +52,7 @@ public:
 
   bool supportsNesting() override;
   bool supportsStandalone() override;
+  bool supportsParallelPrepare() override;
 
   process::Future<Nothing> recover(
       const std::vector<mesos::slave::ContainerState>& states,
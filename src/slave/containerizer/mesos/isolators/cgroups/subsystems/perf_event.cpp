@@ -21,6 +21,7 @@
 
 #include <stout/duration.hpp>
 #include <stout/error.hpp>
+#include <stout/path.hpp>
 
 #include "linux/perf.hpp"
 
@@ -48,9 +49,30 @@ Try<Owned<SubsystemProcess>> PerfEventSubsystemProcess::create(
   // at all, so this subsystem is just like a no-op in this case.
   if (flags.perf_events.isNone()) {
     return Owned<SubsystemProcess>(
-        new PerfEventSubsystemProcess(flags, hierarchy, set<string>{}));
+        new PerfEventSubsystemProcess(flags, hierarchy, set<string>{}, false));
   }
 
+  set<string> events;
+  foreach (const string& event,
+           strings::tokenize(flags.perf_events.get(), ",")) {
+    events.insert(event);
+  }
+
+  // Prefer counting the events in-process, which neither requires the
+  // `perf` binary nor limits the sample to `--perf_duration`.
+  Try<Nothing> native = perf::Counters::supported(events, hierarchy);
+  if (native.isSome()) {
+    LOG(INFO) << "perf_event subsystem will count "
+              << "every '" << flags.perf_interval << "' "
+              << "for events: " << stringify(events);
+
+    return Owned<SubsystemProcess>(
+        new PerfEventSubsystemProcess(flags, hierarchy, events, true));
+  }
+
+  LOG(INFO) << "perf_event subsystem cannot count events in-process, "
+            << "falling back to 'perf stat': " << native.error();
+
   if (!perf::supported()) {
     return Error("Perf is not supported");
   }
@@ -61,12 +83,6 @@ Try<Owned<SubsystemProcess>> PerfEventSubsystemProcess::create(
         "interval (" + stringify(flags.perf_interval) + ") is not supported.");
   }
 
-  set<string> events;
-  foreach (const string& event,
-           strings::tokenize(flags.perf_events.get(), ",")) {
-    events.insert(event);
-  }
-
   if (!perf::valid(events)) {
     return Error("Invalid perf events: " + stringify(events));
   }
@@ -77,24 +93,30 @@ Try<Owned<SubsystemProcess>> PerfEventSubsystemProcess::create(
             << "for events: " << stringify(events);
 
   return Owned<SubsystemProcess>(
-      new PerfEventSubsystemProcess(flags, hierarchy, events));
+      new PerfEventSubsystemProcess(flags, hierarchy, events, false));
 }
 
 
 PerfEventSubsystemProcess::PerfEventSubsystemProcess(
     const Flags& _flags,
     const string& _hierarchy,
-    const set<string>& _events)
+    const set<string>& _events,
+    bool _native)
   : ProcessBase(process::ID::generate("cgroups-perf-event-subsystem")),
     SubsystemProcess(_flags, _hierarchy),
-    events(_events) {}
+    events(_events),
+    native(_native) {}
 
 
 void PerfEventSubsystemProcess::initialize()
 {
   // Start sampling.
   if (!events.empty()) {
-    sample();
+    if (native) {
+      count();
+    } else {
+      sample();
+    }
   }
 }
 
@@ -109,6 +131,10 @@ Future<Nothing> PerfEventSubsystemProcess::recover(
 
   infos.put(containerId, Owned<Info>(new Info(cgroup)));
 
+  if (native) {
+    openCounters(infos[containerId].get());
+  }
+
   return Nothing();
 }
 
@@ -124,6 +150,10 @@ Future<Nothing> PerfEventSubsystemProcess::prepare(
 
   infos.put(containerId, Owned<Info>(new Info(cgroup)));
 
+  if (native) {
+    openCounters(infos[containerId].get());
+  }
+
   return Nothing();
 }
 
@@ -156,12 +186,79 @@ Future<Nothing> PerfEventSubsystemProcess::cleanup(
     return Nothing();
   }
 
+  if (infos[containerId]->counters.isSome()) {
+    openEvents -= infos[containerId]->counters.get()->size();
+  }
+
   infos.erase(containerId);
 
   return Nothing();
 }
 
 
+void PerfEventSubsystemProcess::openCounters(Info* info)
+{
+  CHECK_LE(openEvents, flags.perf_max_events);
+
+  Try<Owned<perf::Counters>> counters = perf::Counters::create(
+      events,
+      path::join(hierarchy, info->cgroup),
+      flags.perf_max_events - openEvents);
+
+  // We do not fail the container if its events cannot be counted,
+  // e.g., because `--perf_max_events` or the file descriptor limit
+  // has been reached.
+  if (counters.isError()) {
+    LOG(ERROR) << "Failed to open the perf counters of cgroup '"
+               << info->cgroup << "': " << counters.error();
+    return;
+  }
+
+  info->counters = counters.get();
+  openEvents += counters.get()->size();
+
+  // Take a baseline reading, so that the first sample is the delta
+  // of a `--perf_interval` like the following ones.
+  Try<PerfStatistics> statistics = counters.get()->read();
+  if (statistics.isError()) {
+    LOG(ERROR) << "Failed to read the perf counters of cgroup '"
+               << info->cgroup << "': " << statistics.error();
+    return;
+  }
+
+  info->last = statistics.get();
+}
+
+
+void PerfEventSubsystemProcess::count()
+{
+  foreachvalue (const Owned<Info>& info, infos) {
+    if (info->counters.isNone()) {
+      continue;
+    }
+
+    Try<PerfStatistics> statistics = info->counters.get()->read();
+    if (statistics.isError()) {
+      LOG(ERROR) << "Failed to read the perf counters of cgroup '"
+                 << info->cgroup << "': " << statistics.error();
+      continue;
+    }
+
+    // Without a baseline (see `openCounters`) this reading becomes
+    // the baseline of the next sample.
+    if (info->last.isSome()) {
+      info->statistics = perf::delta(info->last.get(), statistics.get());
+    }
+
+    info->last = statistics.get();
+  }
+
+  delay(flags.perf_interval,
+        PID<PerfEventSubsystemProcess>(this),
+        &PerfEventSubsystemProcess::count);
+}
+
+
 void PerfEventSubsystemProcess::sample()
 {
   // Collect a perf sample for all cgroups that are not being
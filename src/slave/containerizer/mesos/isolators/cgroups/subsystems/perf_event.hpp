@@ -28,6 +28,9 @@
 #include <process/time.hpp>
 
 #include <stout/hashmap.hpp>
+#include <stout/option.hpp>
+
+#include "linux/perf.hpp"
 
 #include "slave/flags.hpp"
 
@@ -79,7 +82,8 @@ private:
   PerfEventSubsystemProcess(
       const Flags& flags,
       const std::string& hierarchy,
-      const std::set<std::string>& events);
+      const std::set<std::string>& events,
+      bool native);
 
   struct Info
   {
@@ -96,8 +100,22 @@ private:
 
     const std::string cgroup;
     PerfStatistics statistics;
+
+    // The in-process counters of the cgroup and their last reading,
+    // only used when counting natively. The first reading is taken
+    // when the counters are opened, so that every sample is a delta.
+    Option<process::Owned<perf::Counters>> counters;
+    Option<PerfStatistics> last;
   };
 
+  // Opens the in-process counters for the container's cgroup, unless
+  // that exceeds `--perf_max_events`.
+  void openCounters(Info* info);
+
+  // Reads the in-process counters of all cgroups, the statistics are
+  // the counts since the previous reading.
+  void count();
+
   void sample();
 
   void _sample(
@@ -107,6 +125,14 @@ private:
   // Set of events to sample.
   std::set<std::string> events;
 
+  // Whether the events are counted in-process with `perf::Counters`
+  // rather than sampled with `perf stat`.
+  const bool native;
+
+  // The number of events (i.e., file descriptors) opened by the
+  // counters of all containers.
+  size_t openEvents = 0;
+
   // Stores cgroups associated information for container.
   hashmap<ContainerID, process::Owned<Info>> infos;
 };
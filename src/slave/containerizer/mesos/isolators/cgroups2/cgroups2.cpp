@@ -0,0 +1,798 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <sys/mount.h>
+
+#include <algorithm>
+#include <cmath>
+#include <set>
+#include <sstream>
+#include <vector>
+
+#include <process/collect.hpp>
+#include <process/defer.hpp>
+#include <process/delay.hpp>
+#include <process/id.hpp>
+#include <process/pid.hpp>
+
+#include <stout/error.hpp>
+#include <stout/foreach.hpp>
+#include <stout/numify.hpp>
+#include <stout/os.hpp>
+#include <stout/path.hpp>
+#include <stout/stringify.hpp>
+#include <stout/strings.hpp>
+
+#include "common/protobuf_utils.hpp"
+
+#include "linux/cgroups2.hpp"
+
+#include "slave/containerizer/mesos/paths.hpp"
+
+#include "slave/containerizer/mesos/isolators/cgroups/constants.hpp"
+
+#include "slave/containerizer/mesos/isolators/cgroups2/cgroups2.hpp"
+
+using mesos::slave::ContainerConfig;
+using mesos::slave::ContainerLaunchInfo;
+using mesos::slave::ContainerLimitation;
+using mesos::slave::ContainerState;
+using mesos::slave::Isolator;
+
+using process::Failure;
+using process::Future;
+using process::Owned;
+using process::PID;
+
+using std::ostringstream;
+using std::set;
+using std::string;
+using std::vector;
+
+namespace mesos {
+namespace internal {
+namespace slave {
+
+// Interval at which 'memory.events' is checked for OOM kills.
+static const Duration OOM_CHECK_INTERVAL = Seconds(1);
+
+
+// Controllers used by this isolator. 'cpu' and 'memory' are required,
+// the others are enabled if the kernel provides them.
+static const set<string> REQUIRED_CONTROLLERS = {"cpu", "memory"};
+static const set<string> OPTIONAL_CONTROLLERS = {"io", "pids"};
+
+
+// Converts cgroups v1 'cpu.shares' ([2, 262144]) to cgroups v2
+// 'cpu.weight' ([1, 10000]) the same way runc and systemd do, so that
+// the relative weights of containers are preserved.
+static uint64_t sharesToWeight(uint64_t shares)
+{
+  shares = std::min(std::max(shares, MIN_CPU_SHARES), (uint64_t) 262144);
+  return 1 + ((shares - MIN_CPU_SHARES) * 9999) / 262142;
+}
+
+
+Cgroups2IsolatorProcess::Cgroups2IsolatorProcess(
+    const Flags& _flags,
+    const string& _root,
+    const set<string>& _controllers)
+  : ProcessBase(process::ID::generate("cgroups2-isolator")),
+    flags(_flags),
+    root(_root),
+    controllers(_controllers) {}
+
+
+Try<Isolator*> Cgroups2IsolatorProcess::create(const Flags& flags)
+{
+  if (strings::contains(flags.isolation, "cgroups/")) {
+    return Error(
+        "The 'cgroups2/all' isolator can not be used together with the "
+        "cgroups v1 isolators");
+  }
+
+  Try<string> root = cgroups2::mountpoint();
+  if (root.isError()) {
+    return Error(
+        "Failed to locate the cgroup v2 unified hierarchy: " + root.error());
+  }
+
+  Try<set<string>> available =
+    cgroups2::controllers::available(root.get(), "/");
+  if (available.isError()) {
+    return Error(
+        "Failed to determine the available cgroup v2 controllers: " +
+        available.error());
+  }
+
+  set<string> controllers;
+  foreach (const string& controller, REQUIRED_CONTROLLERS) {
+    if (available->count(controller) == 0) {
+      return Error(
+          "The '" + controller + "' controller is not available in the "
+          "cgroup v2 hierarchy at '" + root.get() + "'");
+    }
+
+    controllers.insert(controller);
+  }
+
+  foreach (const string& controller, OPTIONAL_CONTROLLERS) {
+    if (available->count(controller) > 0) {
+      controllers.insert(controller);
+    }
+  }
+
+  // Enable the controllers all the way down to the cgroups root so
+  // that they are available to the container cgroups. The cgroups
+  // root and its non-root ancestors must not contain any processes.
+  Try<Nothing> create =
+    cgroups2::create(root.get(), flags.cgroups_root, true);
+
+  if (create.isError()) {
+    return Error("Failed to create the cgroups root: " + create.error());
+  }
+
+  string current = "/";
+  Try<Nothing> enable =
+    cgroups2::controllers::enable(root.get(), current, controllers);
+
+  if (enable.isError()) {
+    return Error(enable.error());
+  }
+
+  foreach (const string& component,
+           strings::tokenize(flags.cgroups_root, "/")) {
+    current = path::join(current, component);
+
+    enable = cgroups2::controllers::enable(root.get(), current, controllers);
+    if (enable.isError()) {
+      return Error(enable.error());
+    }
+  }
+
+  LOG(INFO) << "Using cgroup v2 controllers " << stringify(controllers)
+            << " under '" << path::join(root.get(), flags.cgroups_root)
+            << "'";
+
+  Owned<MesosIsolatorProcess> process(
+      new Cgroups2IsolatorProcess(flags, root.get(), controllers));
+
+  return new MesosIsolator(process);
+}
+
+
+bool Cgroups2IsolatorProcess::supportsNesting()
+{
+  return true;
+}
+
+
+bool Cgroups2IsolatorProcess::supportsStandalone()
+{
+  return true;
+}
+
+
+bool Cgroups2IsolatorProcess::supportsParallelPrepare()
+{
+  return true;
+}
+
+
+Future<Nothing> Cgroups2IsolatorProcess::recover(
+    const vector<ContainerState>& states,
+    const hashset<ContainerID>& orphans)
+{
+  foreach (const ContainerState& state, states) {
+    // Nested containers always share the cgroup of their ancestor.
+    if (state.container_id().has_parent()) {
+      continue;
+    }
+
+    const ContainerID& containerId = state.container_id();
+    const string cgroup =
+      containerizer::paths::getCgroupPath(flags.cgroups_root, containerId);
+
+    if (!cgroups2::exists(root, cgroup)) {
+      // This may occur if the executor has exited and the isolator
+      // has destroyed the cgroup but the agent dies before noticing
+      // this. This will be detected when the containerizer tries to
+      // monitor the executor's pid.
+      LOG(WARNING) << "Couldn't find the cgroup '" << cgroup << "' "
+                   << "in the unified hierarchy for container "
+                   << containerId;
+      continue;
+    }
+
+    infos[containerId] = Owned<Info>(new Info(containerId, cgroup));
+  }
+
+  return _recover(orphans);
+}
+
+
+Future<Nothing> Cgroups2IsolatorProcess::_recover(
+    const hashset<ContainerID>& orphans)
+{
+  Try<vector<string>> cgroups = cgroups2::get(root, flags.cgroups_root);
+  if (cgroups.isError()) {
+    return Failure(
+        "Failed to list cgroups under '" +
+        path::join(root, flags.cgroups_root) + "': " + cgroups.error());
+  }
+
+  vector<Future<Nothing>> destroys;
+
+  foreach (const string& cgroup, cgroups.get()) {
+    Option<ContainerID> containerId =
+      containerizer::paths::parseCgroupPath(flags.cgroups_root, cgroup);
+
+    if (containerId.isNone() || containerId->has_parent()) {
+      continue;
+    }
+
+    if (infos.contains(containerId.get())) {
+      continue;
+    }
+
+    // Known orphans will be destroyed by the containerizer using the
+    // normal cleanup path, see MESOS-2367 for details.
+    if (orphans.contains(containerId.get())) {
+      infos[containerId.get()] =
+        Owned<Info>(new Info(containerId.get(), cgroup));
+      continue;
+    }
+
+    LOG(INFO) << "Cleaning up unknown orphan container " << containerId.get();
+
+    destroys.push_back(cgroups2::destroy(root, cgroup));
+  }
+
+  foreachvalue (const Owned<Info>& info, infos) {
+    Try<hashmap<string, uint64_t>> events =
+      cgroups2::stat(root, info->cgroup, "memory.events");
+
+    if (events.isSome() && events->contains("oom_kill")) {
+      info->oomKills = events->at("oom_kill");
+    }
+
+    // The memory limits of recovered containers are already in place.
+    info->memoryMaxSet = true;
+  }
+
+  return await(destroys)
+    .then([](const vector<Future<Nothing>>& futures) -> Future<Nothing> {
+      vector<string> errors;
+      foreach (const Future<Nothing>& future, futures) {
+        if (!future.isReady()) {
+          errors.push_back((future.isFailed()
+              ? future.failure()
+              : "discarded"));
+        }
+      }
+
+      if (!errors.empty()) {
+        return Failure(
+            "Failed to destroy unknown orphan cgroups: " +
+            strings::join(";", errors));
+      }
+
+      return Nothing();
+    });
+}
+
+
+Future<Option<ContainerLaunchInfo>> Cgroups2IsolatorProcess::prepare(
+    const ContainerID& containerId,
+    const ContainerConfig& containerConfig)
+{
+  // Nested containers share the cgroup of their top-level ancestor.
+  // Giving them their own cgroup would require the ancestor's cgroup
+  // to be free of processes (the "no internal processes" rule).
+  if (containerId.has_parent()) {
+    const bool shareCgroups =
+      (containerConfig.has_container_info() &&
+       containerConfig.container_info().has_linux_info() &&
+       containerConfig.container_info().linux_info().has_share_cgroups())
+        ? containerConfig.container_info().linux_info().share_cgroups()
+        : true;
+
+    if (!shareCgroups) {
+      return Failure(
+          "The 'cgroups2/all' isolator does not support nested containers "
+          "with 'share_cgroups' set to false");
+    }
+
+    return None();
+  }
+
+  if (infos.contains(containerId)) {
+    return Failure("Container has already been prepared");
+  }
+
+  const string cgroup =
+    containerizer::paths::getCgroupPath(flags.cgroups_root, containerId);
+
+  if (cgroups2::exists(root, cgroup)) {
+    return Failure(
+        "The cgroup at '" + path::join(root, cgroup) + "' already exists");
+  }
+
+  Try<Nothing> create = cgroups2::create(root, cgroup);
+  if (create.isError()) {
+    return Failure("Failed to create the cgroup: " + create.error());
+  }
+
+  infos[containerId] = Owned<Info>(new Info(containerId, cgroup));
+
+  // We only mount the container's cgroup for containers with a rootfs,
+  // see the cgroups v1 isolator for the analogous mounts.
+  if (!containerConfig.has_rootfs()) {
+    return None();
+  }
+
+  ContainerLaunchInfo launchInfo;
+  launchInfo.add_clone_namespaces(CLONE_NEWNS);
+
+  *launchInfo.add_mounts() = protobuf::slave::createContainerMount(
+      path::join(root, cgroup),
+      path::join(containerConfig.rootfs(), "/sys/fs/cgroup"),
+      MS_BIND | MS_REC);
+
+  return launchInfo;
+}
+
+
+Future<Nothing> Cgroups2IsolatorProcess::isolate(
+    const ContainerID& containerId,
+    pid_t pid)
+{
+  Owned<Info> info = findCgroupInfo(containerId);
+  if (!info.get()) {
+    return Failure(
+        "Failed to find cgroup for container " +
+        stringify(containerId));
+  }
+
+  // Nested containers are launched from within their ancestor's
+  // cgroup and thus are already in the right place.
+  if (containerId != info->containerId) {
+    return Nothing();
+  }
+
+  Try<Nothing> assign = cgroups2::assign(root, info->cgroup, pid);
+  if (assign.isError()) {
+    string message =
+      "Failed to assign container " + stringify(containerId) +
+      " pid " + stringify(pid) + " to cgroup at '" +
+      path::join(root, info->cgroup) + "': " + assign.error();
+
+    LOG(ERROR) << message;
+
+    return Failure(message);
+  }
+
+  return Nothing();
+}
+
+
+Future<ContainerLimitation> Cgroups2IsolatorProcess::watch(
+    const ContainerID& containerId)
+{
+  if (!infos.contains(containerId)) {
+    // NOTE: We return a pending future for a nested container whose
+    // ancestor is known to the isolator.
+    if (findCgroupInfo(containerId).get()) {
+      return Future<ContainerLimitation>();
+    } else {
+      return Failure("Unknown container");
+    }
+  }
+
+  oomCheck(containerId);
+
+  return infos[containerId]->limitation.future();
+}
+
+
+void Cgroups2IsolatorProcess::oomCheck(const ContainerID& containerId)
+{
+  if (!infos.contains(containerId)) {
+    return;
+  }
+
+  const Owned<Info>& info = infos[containerId];
+
+  if (!info->limitation.future().isPending()) {
+    return;
+  }
+
+  Try<hashmap<string, uint64_t>> events =
+    cgroups2::stat(root, info->cgroup, "memory.events");
+
+  if (events.isError()) {
+    LOG(ERROR) << "Failed to read 'memory.events' for container "
+               << containerId << ": " << events.error();
+  } else if (events->contains("oom_kill") &&
+             events->at("oom_kill") > info->oomKills) {
+    LOG(INFO) << "OOM detected for container " << containerId;
+
+    ostringstream message;
+    message << "Memory limit exceeded: ";
+
+    Try<string> max = cgroups2::read(root, info->cgroup, "memory.max");
+    if (max.isSome()) {
+      message << "Requested: " << strings::trim(max.get()) << " ";
+    }
+
+    Try<string> peak = cgroups2::read(root, info->cgroup, "memory.peak");
+    Try<uint64_t> maximum = peak.isSome()
+      ? numify<uint64_t>(strings::trim(peak.get()))
+      : Try<uint64_t>(Error(peak.error()));
+
+    if (maximum.isSome()) {
+      message << "Maximum Used: " << Bytes(maximum.get()) << "\n";
+    }
+
+    Try<string> read = cgroups2::read(root, info->cgroup, "memory.stat");
+    if (read.isSome()) {
+      message << "\nMEMORY STATISTICS: \n" << read.get() << "\n";
+    }
+
+    LOG(INFO) << strings::trim(message.str());
+
+    Resources mem = Resources::parse(
+        "mem",
+        stringify(maximum.isSome()
+          ? (double) maximum.get() / Bytes::MEGABYTES : 0),
+        "*").get();
+
+    info->limitation.set(
+        protobuf::slave::createContainerLimitation(
+            mem,
+            message.str(),
+            TaskStatus::REASON_CONTAINER_LIMITATION_MEMORY));
+
+    return;
+  }
+
+  process::delay(
+      OOM_CHECK_INTERVAL,
+      PID<Cgroups2IsolatorProcess>(this),
+      &Cgroups2IsolatorProcess::oomCheck,
+      containerId);
+}
+
+
+Future<Nothing> Cgroups2IsolatorProcess::update(
+    const ContainerID& containerId,
+    const Resources& resourceRequests,
+    const google::protobuf::Map<string, Value::Scalar>& resourceLimits)
+{
+  if (!infos.contains(containerId)) {
+    return Failure("Unknown container");
+  }
+
+  const Owned<Info>& info = infos[containerId];
+
+  Option<double> cpuLimit;
+  Option<double> memLimit;
+  foreach (auto&& limit, resourceLimits) {
+    if (limit.first == "cpus") {
+      cpuLimit = limit.second.value();
+    } else if (limit.first == "mem") {
+      memLimit = limit.second.value();
+    }
+  }
+
+  if (resourceRequests.cpus().isSome()) {
+    double cpuRequest = resourceRequests.cpus().get();
+
+    uint64_t shares;
+    if (flags.revocable_cpu_low_priority &&
+        resourceRequests.revocable().cpus().isSome()) {
+      shares = std::max(
+          (uint64_t) (CPU_SHARES_PER_CPU_REVOCABLE * cpuRequest),
+          MIN_CPU_SHARES);
+    } else {
+      shares = std::max(
+          (uint64_t) (CPU_SHARES_PER_CPU * cpuRequest),
+          MIN_CPU_SHARES);
+    }
+
+    const uint64_t weight = sharesToWeight(shares);
+
+    Try<Nothing> write =
+      cgroups2::write(root, info->cgroup, "cpu.weight", stringify(weight));
+
+    if (write.isError()) {
+      return Failure("Failed to update 'cpu.weight': " + write.error());
+    }
+
+    LOG(INFO) << "Updated 'cpu.weight' to " << weight
+              << " (cpus " << cpuRequest << ")"
+              << " for container " << containerId;
+
+    // Set the bandwidth to the CPU limit (if any) or to the CPU request
+    // (if the flag `--cgroups_enable_cfs` is true).
+    if (cpuLimit.isSome() || flags.cgroups_enable_cfs) {
+      const uint64_t period = CPU_CFS_PERIOD.us();
+
+      string max;
+      if (cpuLimit.isSome() && std::isinf(cpuLimit.get())) {
+        max = "max " + stringify(period);
+      } else {
+        const double quota = cpuLimit.isSome() ? cpuLimit.get() : cpuRequest;
+        Duration duration =
+          std::max(CPU_CFS_PERIOD * quota, MIN_CPU_CFS_QUOTA);
+
+        max = stringify((uint64_t) duration.us()) + " " + stringify(period);
+      }
+
+      write = cgroups2::write(root, info->cgroup, "cpu.max", max);
+      if (write.isError()) {
+        return Failure("Failed to update 'cpu.max': " + write.error());
+      }
+
+      LOG(INFO) << "Updated 'cpu.max' to '" << max << "'"
+                << " for container " << containerId;
+    }
+  }
+
+  if (resourceRequests.mem().isSome()) {
+    const Bytes request = std::max(resourceRequests.mem().get(), MIN_MEMORY);
+
+    // Rather than trying to represent an infinite limit with the
+    // `Bytes` type, we represent it with NONE.
+    Option<Bytes> limit = request;
+    if (memLimit.isSome()) {
+      if (std::isinf(memLimit.get())) {
+        limit = None();
+      } else {
+        limit = std::max(
+            Megabytes(static_cast<uint64_t>(memLimit.get())), MIN_MEMORY);
+      }
+    }
+
+    // Containers which may burst above their request are throttled and
+    // put under reclaim pressure once above it ('memory.high'), instead
+    // of the v1 soft limit which only applies under global pressure.
+    const string high = limit.isNone() || request < limit.get()
+      ? stringify(request.bytes())
+      : "max";
+
+    Try<Nothing> write =
+      cgroups2::write(root, info->cgroup, "memory.high", high);
+
+    if (write.isError()) {
+      return Failure("Failed to update 'memory.high': " + write.error());
+    }
+
+    LOG(INFO) << "Updated 'memory.high' to " << high
+              << " for container " << containerId;
+
+    // Like the cgroups v1 memory subsystem, we only lower 'memory.max'
+    // the first time since doing so later may OOM the container.
+    Try<string> current = cgroups2::read(root, info->cgroup, "memory.max");
+    if (current.isError()) {
+      return Failure("Failed to read 'memory.max': " + current.error());
+    }
+
+    Try<uint64_t> currentMax = numify<uint64_t>(strings::trim(current.get()));
+
+    const bool raising = limit.isNone()
+      ? currentMax.isSome()
+      : currentMax.isError() || limit->bytes() > currentMax.get();
+
+    if (!info->memoryMaxSet || raising) {
+      const string max =
+        limit.isNone() ? "max" : stringify(limit->bytes());
+
+      write = cgroups2::write(root, info->cgroup, "memory.max", max);
+      if (write.isError()) {
+        return Failure("Failed to update 'memory.max': " + write.error());
+      }
+
+      info->memoryMaxSet = true;
+
+      LOG(INFO) << "Updated 'memory.max' to " << max
+                << " for container " << containerId;
+    }
+  }
+
+  return Nothing();
+}
+
+
+Future<ResourceStatistics> Cgroups2IsolatorProcess::usage(
+    const ContainerID& containerId)
+{
+  if (!infos.contains(containerId)) {
+    return Failure("Unknown container");
+  }
+
+  const string& cgroup = infos[containerId]->cgroup;
+
+  ResourceStatistics result;
+
+  // All the statistics come from the same cgroup, so unlike the v1
+  // isolator there is no need to fan out to the different hierarchies.
+  Try<hashmap<string, uint64_t>> cpu =
+    cgroups2::stat(root, cgroup, "cpu.stat");
+  if (cpu.isError()) {
+    return Failure("Failed to read 'cpu.stat': " + cpu.error());
+  }
+
+  result.set_cpus_user_time_secs(
+      (double) cpu->get("user_usec").getOrElse(0) / Seconds(1).us());
+  result.set_cpus_system_time_secs(
+      (double) cpu->get("system_usec").getOrElse(0) / Seconds(1).us());
+
+  if (cpu->contains("nr_periods")) {
+    result.set_cpus_nr_periods(cpu->at("nr_periods"));
+    result.set_cpus_nr_throttled(cpu->get("nr_throttled").getOrElse(0));
+    result.set_cpus_throttled_time_secs(
+        (double) cpu->get("throttled_usec").getOrElse(0) / Seconds(1).us());
+  }
+
+  Try<string> current = cgroups2::read(root, cgroup, "memory.current");
+  if (current.isError()) {
+    return Failure("Failed to read 'memory.current': " + current.error());
+  }
+
+  Try<uint64_t> total = numify<uint64_t>(strings::trim(current.get()));
+  if (total.isError()) {
+    return Failure("Failed to parse 'memory.current': " + total.error());
+  }
+
+  result.set_mem_total_bytes(total.get());
+
+  Try<hashmap<string, uint64_t>> memory =
+    cgroups2::stat(root, cgroup, "memory.stat");
+
+  if (memory.isError()) {
+    return Failure("Failed to read 'memory.stat': " + memory.error());
+  }
+
+  const uint64_t anon = memory->get("anon").getOrElse(0);
+  const uint64_t file = memory->get("file").getOrElse(0);
+
+  result.set_mem_anon_bytes(anon);
+  result.set_mem_rss_bytes(anon);
+  result.set_mem_file_bytes(file);
+  result.set_mem_cache_bytes(file);
+  result.set_mem_mapped_file_bytes(memory->get("file_mapped").getOrElse(0));
+  result.set_mem_unevictable_bytes(memory->get("unevictable").getOrElse(0));
+
+  Try<string> swap = cgroups2::read(root, cgroup, "memory.swap.current");
+  if (swap.isSome()) {
+    Try<uint64_t> bytes = numify<uint64_t>(strings::trim(swap.get()));
+    if (bytes.isSome()) {
+      result.set_mem_swap_bytes(bytes.get());
+      result.set_mem_total_memsw_bytes(total.get() + bytes.get());
+    }
+  }
+
+  Try<string> max = cgroups2::read(root, cgroup, "memory.max");
+  if (max.isSome()) {
+    Try<uint64_t> bytes = numify<uint64_t>(strings::trim(max.get()));
+    if (bytes.isSome()) {
+      result.set_mem_limit_bytes(bytes.get());
+    }
+  }
+
+  Try<string> high = cgroups2::read(root, cgroup, "memory.high");
+  if (high.isSome()) {
+    Try<uint64_t> bytes = numify<uint64_t>(strings::trim(high.get()));
+    if (bytes.isSome()) {
+      result.set_mem_soft_limit_bytes(bytes.get());
+    }
+  }
+
+  if (controllers.count("pids") > 0) {
+    Try<string> pids = cgroups2::read(root, cgroup, "pids.current");
+    if (pids.isSome()) {
+      Try<uint32_t> threads = numify<uint32_t>(strings::trim(pids.get()));
+      if (threads.isSome()) {
+        result.set_threads(threads.get());
+      }
+    }
+  }
+
+  // Pressure stall information is only available on kernels built with
+  // CONFIG_PSI (and not booted with 'psi=0').
+  if (cgroups2::exists(root, cgroup, "cpu.pressure")) {
+    Try<PressureStallInformation> pressure =
+      cgroups2::pressure(root, cgroup, "cpu.pressure");
+
+    if (pressure.isError()) {
+      return Failure(pressure.error());
+    }
+
+    result.mutable_cpu_pressure()->CopyFrom(pressure.get());
+  }
+
+  if (cgroups2::exists(root, cgroup, "memory.pressure")) {
+    Try<PressureStallInformation> pressure =
+      cgroups2::pressure(root, cgroup, "memory.pressure");
+
+    if (pressure.isError()) {
+      return Failure(pressure.error());
+    }
+
+    result.mutable_mem_pressure()->CopyFrom(pressure.get());
+  }
+
+  if (cgroups2::exists(root, cgroup, "io.pressure")) {
+    Try<PressureStallInformation> pressure =
+      cgroups2::pressure(root, cgroup, "io.pressure");
+
+    if (pressure.isError()) {
+      return Failure(pressure.error());
+    }
+
+    result.mutable_io_pressure()->CopyFrom(pressure.get());
+  }
+
+  return result;
+}
+
+
+Future<Nothing> Cgroups2IsolatorProcess::cleanup(
+    const ContainerID& containerId)
+{
+  if (!infos.contains(containerId)) {
+    VLOG(1) << "Ignoring cleanup request for unknown container " << containerId;
+    return Nothing();
+  }
+
+  const string cgroup = infos[containerId]->cgroup;
+
+  infos.erase(containerId);
+
+  return cgroups2::destroy(root, cgroup)
+    .repair([=](const Future<Nothing>& future) -> Future<Nothing> {
+      return Failure(
+          "Failed to destroy cgroup '" + path::join(root, cgroup) +
+          "' for container " + stringify(containerId) + ": " +
+          (future.isFailed() ? future.failure() : "discarded"));
+    });
+}
+
+
+Owned<Cgroups2IsolatorProcess::Info> Cgroups2IsolatorProcess::findCgroupInfo(
+    const ContainerID& containerId) const
+{
+  Option<ContainerID> current = containerId;
+  while (current.isSome()) {
+    Option<Owned<Info>> info = infos.get(current.get());
+    if (info.isSome()) {
+      return info.get();
+    }
+
+    if (!current->has_parent()) {
+      break;
+    }
+
+    current = current->parent();
+  }
+
+  return nullptr;
+}
+
+} // namespace slave {
+} // namespace internal {
+} // namespace mesos {
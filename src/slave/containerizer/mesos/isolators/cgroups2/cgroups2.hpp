@@ -0,0 +1,146 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __CGROUPS2_ISOLATOR_HPP__
+#define __CGROUPS2_ISOLATOR_HPP__
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include <mesos/resources.hpp>
+
+#include <process/future.hpp>
+#include <process/owned.hpp>
+
+#include <stout/hashmap.hpp>
+#include <stout/hashset.hpp>
+#include <stout/nothing.hpp>
+#include <stout/option.hpp>
+#include <stout/try.hpp>
+
+#include "slave/flags.hpp"
+
+#include "slave/containerizer/mesos/isolator.hpp"
+
+namespace mesos {
+namespace internal {
+namespace slave {
+
+// This isolator places each top-level container into its own cgroup of
+// the cgroup v2 unified hierarchy and uses the 'cpu', 'memory', 'io'
+// and 'pids' controllers from that single cgroup for both limiting and
+// accounting. Nested containers share the cgroup of their top-level
+// ancestor. Besides the usual CPU and memory statistics, it reports
+// pressure stall information (PSI) for CPU, memory and IO.
+//
+// NOTE: The Linux launcher relies on the cgroups v1 freezer, so on
+// hosts with only the unified hierarchy mounted the agent needs to use
+// `--launcher=posix` together with this isolator; the isolator itself
+// destroys the container's cgroup using 'cgroup.kill'.
+class Cgroups2IsolatorProcess : public MesosIsolatorProcess
+{
+public:
+  static Try<mesos::slave::Isolator*> create(const Flags& flags);
+
+  ~Cgroups2IsolatorProcess() override {}
+
+  bool supportsNesting() override;
+  bool supportsStandalone() override;
+  bool supportsParallelPrepare() override;
+
+  process::Future<Nothing> recover(
+      const std::vector<mesos::slave::ContainerState>& states,
+      const hashset<ContainerID>& orphans) override;
+
+  process::Future<Option<mesos::slave::ContainerLaunchInfo>> prepare(
+      const ContainerID& containerId,
+      const mesos::slave::ContainerConfig& containerConfig) override;
+
+  process::Future<Nothing> isolate(
+      const ContainerID& containerId,
+      pid_t pid) override;
+
+  process::Future<mesos::slave::ContainerLimitation> watch(
+      const ContainerID& containerId) override;
+
+  process::Future<Nothing> update(
+      const ContainerID& containerId,
+      const Resources& resourceRequests,
+      const google::protobuf::Map<
+          std::string, Value::Scalar>& resourceLimits = {}) override;
+
+  process::Future<ResourceStatistics> usage(
+      const ContainerID& containerId) override;
+
+  process::Future<Nothing> cleanup(
+      const ContainerID& containerId) override;
+
+private:
+  struct Info
+  {
+    Info(const ContainerID& _containerId, const std::string& _cgroup)
+      : containerId(_containerId),
+        cgroup(_cgroup),
+        oomKills(0),
+        memoryMaxSet(false) {}
+
+    const ContainerID containerId;
+    const std::string cgroup;
+
+    // This promise will complete if a container is impacted by a resource
+    // limitation and should be terminated.
+    process::Promise<mesos::slave::ContainerLimitation> limitation;
+
+    // The value of 'oom_kill' in 'memory.events' when the container's
+    // cgroup was created or recovered.
+    uint64_t oomKills;
+
+    // Whether 'memory.max' has been set; it is only ever lowered the
+    // first time to avoid OOMing a running container.
+    bool memoryMaxSet;
+  };
+
+  Cgroups2IsolatorProcess(
+      const Flags& _flags,
+      const std::string& _root,
+      const std::set<std::string>& _controllers);
+
+  process::Future<Nothing> _recover(
+      const hashset<ContainerID>& orphans);
+
+  // Periodically checks 'memory.events' of the container's cgroup and
+  // fails the container's limitation if the kernel OOM killer fired.
+  void oomCheck(const ContainerID& containerId);
+
+  process::Owned<Info> findCgroupInfo(const ContainerID& containerId) const;
+
+  const Flags flags;
+
+  // Mount point of the unified hierarchy.
+  const std::string root;
+
+  // Controllers enabled for the container cgroups.
+  const std::set<std::string> controllers;
+
+  hashmap<ContainerID, process::Owned<Info>> infos;
+};
+
+} // namespace slave {
+} // namespace internal {
+} // namespace mesos {
+
+#endif // __CGROUPS2_ISOLATOR_HPP__
@@ -71,6 +71,12 @@ bool DockerRuntimeIsolatorProcess::supportsStandalone()
 }
 
 
+bool DockerRuntimeIsolatorProcess::supportsParallelPrepare()
+{
+  return true;
+}
+
+
 Try<Isolator*> DockerRuntimeIsolatorProcess::create(const Flags& flags)
 {
   process::Owned<MesosIsolatorProcess> process(
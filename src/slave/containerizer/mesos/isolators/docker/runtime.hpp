@@ -35,6 +35,7 @@ public:
 
   bool supportsNesting() override;
   bool supportsStandalone() override;
+  bool supportsParallelPrepare() override;
 
   process::Future<Option<mesos::slave::ContainerLaunchInfo>> prepare(
       const ContainerID& containerId,
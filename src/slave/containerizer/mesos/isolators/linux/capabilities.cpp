@@ -86,6 +86,12 @@ bool LinuxCapabilitiesIsolatorProcess::supportsStandalone()
 }
 
 
+bool LinuxCapabilitiesIsolatorProcess::supportsParallelPrepare()
+{
+  return true;
+}
+
+
 Future<Option<ContainerLaunchInfo>> LinuxCapabilitiesIsolatorProcess::prepare(
     const ContainerID& containerId,
     const ContainerConfig& containerConfig)
@@ -135,6 +135,12 @@ bool LinuxDevicesIsolatorProcess::supportsStandalone()
 }
 
 
+bool LinuxDevicesIsolatorProcess::supportsParallelPrepare()
+{
+  return true;
+}
+
+
 Future<Option<ContainerLaunchInfo>> LinuxDevicesIsolatorProcess::prepare(
     const ContainerID& containerId,
     const ContainerConfig& containerConfig)
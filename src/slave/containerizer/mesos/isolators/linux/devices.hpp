@@ -39,6 +39,7 @@ public:
 
   bool supportsNesting() override;
   bool supportsStandalone() override;
+  bool supportsParallelPrepare() override;
 
   process::Future<Option<mesos::slave::ContainerLaunchInfo>> prepare(
       const ContainerID& containerId,
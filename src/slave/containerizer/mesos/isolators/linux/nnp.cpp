@@ -62,6 +62,12 @@ bool LinuxNNPIsolatorProcess::supportsStandalone()
 }
 
 
+bool LinuxNNPIsolatorProcess::supportsParallelPrepare()
+{
+  return true;
+}
+
+
 Future<Option<ContainerLaunchInfo>> LinuxNNPIsolatorProcess::prepare(
     const ContainerID& containerId,
     const ContainerConfig& containerConfig)
@@ -95,6 +95,12 @@ bool NamespacesPidIsolatorProcess::supportsStandalone()
 }
 
 
+bool NamespacesPidIsolatorProcess::supportsParallelPrepare()
+{
+  return true;
+}
+
+
 Future<Option<ContainerLaunchInfo>> NamespacesPidIsolatorProcess::prepare(
     const ContainerID& containerId,
     const ContainerConfig& containerConfig)
@@ -2396,6 +2396,7 @@ PortMappingIsolatorProcess::_recover(pid_t pid)
 
   IntervalSet<uint16_t> nonEphemeralPorts;
   IntervalSet<uint16_t> ephemeralPorts;
+  hashset<PortRange> portRanges;
   Option<uint16_t> flowId;
 
   foreach (const ip::Classifier& classifier, vethIngressClassifiers.get()) {
@@ -2429,6 +2430,8 @@ PortMappingIsolatorProcess::_recover(pid_t pid)
       (Bound<uint16_t>::closed(sourcePorts->begin()),
        Bound<uint16_t>::closed(sourcePorts->end()));
 
+    portRanges.insert(sourcePorts.get());
+
     if (managedNonEphemeralPorts.contains(ports)) {
       nonEphemeralPorts += ports;
     } else if (ephemeralPortsAllocator->isManaged(ports)) {
@@ -2473,6 +2476,8 @@ PortMappingIsolatorProcess::_recover(pid_t pid)
             << " and ephemeral port range " << *ephemeralPorts.begin();
   }
 
+  info->portRanges = portRanges;
+
   if (flowId.isSome()) {
     freeFlowIds.erase(flowId.get());
     info->flowId = flowId.get();
@@ -2668,8 +2673,10 @@ Future<Nothing> PortMappingIsolatorProcess::isolate(
 
   // For each port range, add a set of IP packet filters to properly
   // redirect IP traffic to/from containers.
-  foreach (const PortRange& range,
-           getPortRanges(info->nonEphemeralPorts + info->ephemeralPorts)) {
+  vector<PortRange> ranges =
+    getPortRanges(info->nonEphemeralPorts + info->ephemeralPorts);
+
+  foreach (const PortRange& range, ranges) {
     if (info->flowId.isSome()) {
       LOG(INFO) << "Adding IP packet filters with ports " << range
                 << " with flow ID " << info->flowId.get()
@@ -2679,13 +2686,18 @@ Future<Nothing> PortMappingIsolatorProcess::isolate(
                 << " for container " << containerId;
     }
 
-    Try<Nothing> add = addHostIPFilters(range, info->flowId, veth(pid));
-    if (add.isError()) {
-      return Failure(
-          "Failed to add IP packet filter with ports " +
-          stringify(range) + " for container with pid " +
-          stringify(pid) + ": " + add.error());
-    }
+    // NOTE: We record the port range before adding the filters so
+    // that 'cleanup' removes whatever filters got installed in case
+    // we fail half way.
+    info->portRanges.insert(range);
+  }
+
+  Try<Nothing> add = addHostIPFilters(ranges, info->flowId, veth(pid));
+  if (add.isError()) {
+    return Failure(
+        "Failed to add IP packet filters with ports " +
+        stringify(info->nonEphemeralPorts + info->ephemeralPorts) +
+        " for container with pid " + stringify(pid) + ": " + add.error());
   }
 
   // Relay ICMP packets from veth of the container to host eth0.
@@ -3010,35 +3022,18 @@ Future<Nothing> PortMappingIsolatorProcess::update(
             << containerId << " from " << info->nonEphemeralPorts
             << " to " << nonEphemeralPorts;
 
-  Result<vector<ip::Classifier>> classifiers =
-    ip::classifiers(veth(pid), ingress::HANDLE);
-
-  if (classifiers.isError()) {
-    return Failure(
-        "Failed to get all the IP filters on " + veth(pid) +
-        ": " + classifiers.error());
-  } else if (classifiers.isNone()) {
-    return Failure("Failed to find " + veth(pid));
-  }
-
   // We first decide what port ranges need to be removed. Any filter
   // whose port range is not within the new non-ephemeral ports should
-  // be removed.
-  hashset<PortRange> portsToRemove;
+  // be removed. We look at the port ranges we have set up filters for
+  // rather than dumping the filters on veth so that the cost of an
+  // update only depends on the change of the ports.
+  vector<PortRange> portsToRemove;
   IntervalSet<uint16_t> remaining = info->nonEphemeralPorts;
 
-  foreach (const ip::Classifier& classifier, classifiers.get()) {
-    Option<PortRange> sourcePorts = classifier.sourcePorts;
-    Option<PortRange> destinationPorts = classifier.destinationPorts;
-
-    // All the IP filters on veth used by us only have source ports.
-    if (sourcePorts.isNone() || destinationPorts.isSome()) {
-      return Failure("Unexpected IP filter detected on " + veth(pid));
-    }
-
+  foreach (const PortRange& range, info->portRanges) {
     Interval<uint16_t> ports =
-      (Bound<uint16_t>::closed(sourcePorts->begin()),
-       Bound<uint16_t>::closed(sourcePorts->end()));
+      (Bound<uint16_t>::closed(range.begin()),
+       Bound<uint16_t>::closed(range.end()));
 
     // Skip the ephemeral ports.
     if (ports == info->ephemeralPorts) {
@@ -3047,7 +3042,7 @@ Future<Nothing> PortMappingIsolatorProcess::update(
 
     if (!nonEphemeralPorts.contains(ports)) {
       remaining -= ports;
-      portsToRemove.insert(sourcePorts.get());
+      portsToRemove.push_back(range);
     }
   }
 
@@ -3064,28 +3059,33 @@ Future<Nothing> PortMappingIsolatorProcess::update(
                 << " for container " << containerId;
     }
 
-    // All IP packets from a container will be assigned a single flow
-    // on host eth0.
-    Try<Nothing> add = addHostIPFilters(range, info->flowId, veth(pid));
-    if (add.isError()) {
-      return Failure(
-          "Failed to add IP packet filter with ports " +
-          stringify(range) + " for container with pid " +
-          stringify(pid) + ": " + add.error());
-    }
+    info->portRanges.insert(range);
+  }
+
+  // All IP packets from a container will be assigned a single flow
+  // on host eth0.
+  Try<Nothing> add = addHostIPFilters(portsToAdd, info->flowId, veth(pid));
+  if (add.isError()) {
+    return Failure(
+        "Failed to add IP packet filters with ports " +
+        stringify(nonEphemeralPorts - remaining) + " for container " +
+        "with pid " + stringify(pid) + ": " + add.error());
   }
 
   foreach (const PortRange& range, portsToRemove) {
     LOG(INFO) << "Removing IP packet filters with ports " << range
               << " for container with pid " << pid;
+  }
 
-    Try<Nothing> removing = removeHostIPFilters(range, veth(pid));
-    if (removing.isError()) {
-      return Failure(
-          "Failed to remove IP packet filter with ports " +
-          stringify(range) + " for container with pid " +
-          stringify(pid) + ": " + removing.error());
-    }
+  Try<Nothing> removing = removeHostIPFilters(portsToRemove, veth(pid));
+  if (removing.isError()) {
+    return Failure(
+        "Failed to remove IP packet filters for container with pid " +
+        stringify(pid) + ": " + removing.error());
+  }
+
+  foreach (const PortRange& range, portsToRemove) {
+    info->portRanges.erase(range);
   }
 
   // Update the non-ephemeral ports of this container.
@@ -3391,20 +3391,21 @@ Try<Nothing> PortMappingIsolatorProcess::_cleanup(
 
   // Remove the IP filters on eth0 and lo for non-ephemeral port
   // ranges and the ephemeral port range.
-  foreach (const PortRange& range,
-           getPortRanges(info->nonEphemeralPorts + info->ephemeralPorts)) {
+  vector<PortRange> ranges;
+  foreach (const PortRange& range, info->portRanges) {
     LOG(INFO) << "Removing IP packet filters with ports " << range
               << " for container with pid " << pid;
 
-    // No need to remove filters on veth as they will be automatically
-    // removed by the kernel when we remove the link below.
-    Try<Nothing> removing = removeHostIPFilters(range, veth(pid), false);
-    if (removing.isError()) {
-      errors.push_back(
-          "Failed to remove IP packet filter with ports " +
-          stringify(range) + " for container with pid " +
-          stringify(pid) + ": " + removing.error());
-    }
+    ranges.push_back(range);
+  }
+
+  // No need to remove filters on veth as they will be automatically
+  // removed by the kernel when we remove the link below.
+  Try<Nothing> removing = removeHostIPFilters(ranges, veth(pid), false);
+  if (removing.isError()) {
+    errors.push_back(
+        "Failed to remove IP packet filters for container with pid " +
+        stringify(pid) + ": " + removing.error());
   }
 
   if (info->flowId.isSome()) {
@@ -3622,247 +3623,268 @@ Try<Nothing> PortMappingIsolatorProcess::_cleanup(
 }
 
 
-// Helper function to set up IP filters on the host side for a given
-// port range.
+// Helper function to set up IP filters on the host side for the given
+// port ranges. The filters of all the port ranges are created on each
+// link in a single batch.
 Try<Nothing> PortMappingIsolatorProcess::addHostIPFilters(
-    const PortRange& range,
+    const vector<PortRange>& ranges,
     const Option<uint16_t>& flowId,
     const string& veth)
 {
   // NOTE: The order in which these filters are added is important!
-  // For each port range, we need to make sure that we don't try to
-  // add filters on host eth0 and host lo until we have successfully
-  // added filters on veth. This is because the slave could crash
+  // We need to make sure that we don't try to add filters on host
+  // eth0 and host lo until we have successfully added filters on veth
+  // for all the port ranges. This is because the slave could crash
   // while we are adding filters, we want to make sure we don't leak
   // any filters on host eth0 and host lo.
+  vector<filter::Filter<ip::Classifier>> vethFilters;
+  vector<filter::Filter<ip::Classifier>> hostEth0Filters;
+  vector<filter::Filter<ip::Classifier>> hostLoFilters;
+  vector<filter::Filter<ip::Classifier>> hostEth0EgressFilters;
 
-  // Add an IP packet filter from veth of the container to host eth0
-  // to properly redirect IP packets sent from one container to
-  // external hosts. This filter has a lower priority compared to the
-  // 'vethToHostLo' filter because it does not check the destination
-  // IP. Notice that here we also check the source port of a packet.
-  // If the source port is not within the port ranges allocated for
-  // the container, the packet will get dropped.
-  Try<bool> vethToHostEth0 = filter::ip::create(
-      veth,
-      ingress::HANDLE,
-      ip::Classifier(None(), None(), range, None()),
-      Priority(IP_FILTER_PRIORITY, LOW),
-      action::Redirect(eth0));
-
-  if (vethToHostEth0.isError()) {
-    ++metrics.adding_veth_ip_filters_errors;
-
-    return Error(
-        "Failed to create an IP packet filter from " + veth +
-        " to host " + eth0 + ": " + vethToHostEth0.error());
-  } else if (!vethToHostEth0.get()) {
-    ++metrics.adding_veth_ip_filters_already_exist;
-
-    return Error(
-        "The IP packet filter from " + veth +
-        " to host " + eth0 + " already exists");
-  }
-
-  // Add two IP packet filters (one for public IP and one for loopback
-  // IP) from veth of the container to host lo to properly redirect IP
-  // packets sent from one container to either the host or another
-  // container. Notice that here we also check the source port of a
-  // packet. If the source port is not within the port ranges
-  // allocated for the container, the packet will get dropped.
-  Try<bool> vethToHostLoPublic = filter::ip::create(
-      veth,
-      ingress::HANDLE,
-      ip::Classifier(None(), hostIPNetwork.address(), range, None()),
-      Priority(IP_FILTER_PRIORITY, NORMAL),
-      action::Redirect(lo));
-
-  if (vethToHostLoPublic.isError()) {
-    ++metrics.adding_veth_ip_filters_errors;
-
-    return Error(
-        "Failed to create an IP packet filter (for public IP) from " +
-        veth + " to host " + lo + ": " + vethToHostLoPublic.error());
-  } else if (!vethToHostLoPublic.get()) {
-    ++metrics.adding_veth_ip_filters_already_exist;
-
-    return Error(
-        "The IP packet filter (for public IP) from " +
-        veth + " to host " + lo + " already exists");
-  }
+  foreach (const PortRange& range, ranges) {
+    // Add an IP packet filter from veth of the container to host eth0
+    // to properly redirect IP packets sent from one container to
+    // external hosts. This filter has a lower priority compared to
+    // the 'vethToHostLo' filters because it does not check the
+    // destination IP. Notice that here we also check the source port
+    // of a packet. If the source port is not within the port ranges
+    // allocated for the container, the packet will get dropped.
+    vethFilters.push_back(filter::Filter<ip::Classifier>(
+        ingress::HANDLE,
+        ip::Classifier(None(), None(), range, None()),
+        Priority(IP_FILTER_PRIORITY, LOW),
+        None(),
+        None(),
+        action::Redirect(eth0)));
+
+    // Add two IP packet filters (one for public IP and one for
+    // loopback IP) from veth of the container to host lo to properly
+    // redirect IP packets sent from one container to either the host
+    // or another container. Notice that here we also check the source
+    // port of a packet. If the source port is not within the port
+    // ranges allocated for the container, the packet will get
+    // dropped.
+    vethFilters.push_back(filter::Filter<ip::Classifier>(
+        ingress::HANDLE,
+        ip::Classifier(None(), hostIPNetwork.address(), range, None()),
+        Priority(IP_FILTER_PRIORITY, NORMAL),
+        None(),
+        None(),
+        action::Redirect(lo)));
 
-  Try<bool> vethToHostLoLoopback = filter::ip::create(
-      veth,
-      ingress::HANDLE,
-      ip::Classifier(
+    vethFilters.push_back(filter::Filter<ip::Classifier>(
+        ingress::HANDLE,
+        ip::Classifier(
+            None(),
+            net::IP::Network::LOOPBACK_V4().address(),
+            range,
+            None()),
+        Priority(IP_FILTER_PRIORITY, NORMAL),
+        None(),
+        None(),
+        action::Redirect(lo)));
+
+    // Add an IP packet filter from host eth0 to veth of the container
+    // such that any incoming IP packet will be properly redirected to
+    // the corresponding container based on its destination port.
+    hostEth0Filters.push_back(filter::Filter<ip::Classifier>(
+        ingress::HANDLE,
+        ip::Classifier(hostMAC, hostIPNetwork.address(), None(), range),
+        Priority(IP_FILTER_PRIORITY, NORMAL),
+        None(),
+        None(),
+        action::Redirect(veth)));
+
+    // Add an IP packet filter from host lo to veth of the container
+    // such that any internally generated IP packet will be properly
+    // redirected to the corresponding container based on its
+    // destination port.
+    hostLoFilters.push_back(filter::Filter<ip::Classifier>(
+        ingress::HANDLE,
+        ip::Classifier(None(), None(), None(), range),
+        Priority(IP_FILTER_PRIORITY, NORMAL),
+        None(),
+        None(),
+        action::Redirect(veth)));
+
+    if (flowId.isSome()) {
+      // Add IP packet filters to classify traffic sending to eth0
+      // in the same way so that traffic of each container will be
+      // classified to different flows defined by fq_codel.
+      hostEth0EgressFilters.push_back(filter::Filter<ip::Classifier>(
+          hostTxFqCodelHandle,
+          ip::Classifier(None(), None(), range, None()),
+          Priority(IP_FILTER_PRIORITY, LOW),
           None(),
-          net::IP::Network::LOOPBACK_V4().address(),
-          range,
-          None()),
-      Priority(IP_FILTER_PRIORITY, NORMAL),
-      action::Redirect(lo));
+          Handle(hostTxFqCodelHandle, flowId.get()),
+          action::Terminal()));
+    }
+  }
 
-  if (vethToHostLoLoopback.isError()) {
+  Try<bool> vethToHost = filter::ip::create(veth, vethFilters);
+  if (vethToHost.isError()) {
     ++metrics.adding_veth_ip_filters_errors;
 
     return Error(
-        "Failed to create an IP packet filter (for loopback IP) from " +
-        veth + " to host " + lo + ": " + vethToHostLoLoopback.error());
-  } else if (!vethToHostLoLoopback.get()) {
+        "Failed to create IP packet filters from " + veth +
+        " to host " + eth0 + " and host " + lo + ": " + vethToHost.error());
+  } else if (!vethToHost.get()) {
     ++metrics.adding_veth_ip_filters_already_exist;
 
     return Error(
-        "The IP packet filter (for loopback IP) from " +
-        veth + " to host " + lo + " already exists");
+        "Some IP packet filters from " + veth + " to host " + eth0 +
+        " and host " + lo + " already exist");
   }
 
-  // Add an IP packet filter from host eth0 to veth of the container
-  // such that any incoming IP packet will be properly redirected to
-  // the corresponding container based on its destination port.
-  Try<bool> hostEth0ToVeth = filter::ip::create(
-      eth0,
-      ingress::HANDLE,
-      ip::Classifier(hostMAC, hostIPNetwork.address(), None(), range),
-      Priority(IP_FILTER_PRIORITY, NORMAL),
-      action::Redirect(veth));
-
+  Try<bool> hostEth0ToVeth = filter::ip::create(eth0, hostEth0Filters);
   if (hostEth0ToVeth.isError()) {
     ++metrics.adding_eth0_ip_filters_errors;
 
     return Error(
-        "Failed to create an IP packet filter from host " +
+        "Failed to create IP packet filters from host " +
         eth0 + " to " + veth + ": " + hostEth0ToVeth.error());
   } else if (!hostEth0ToVeth.get()) {
     ++metrics.adding_eth0_ip_filters_already_exist;
 
     return Error(
-        "The IP packet filter from host " + eth0 + " to " +
-        veth + " already exists");
+        "Some IP packet filters from host " + eth0 + " to " +
+        veth + " already exist");
   }
 
-  // Add an IP packet filter from host lo to veth of the container
-  // such that any internally generated IP packet will be properly
-  // redirected to the corresponding container based on its
-  // destination port.
-  Try<bool> hostLoToVeth = filter::ip::create(
-      lo,
-      ingress::HANDLE,
-      ip::Classifier(None(), None(), None(), range),
-      Priority(IP_FILTER_PRIORITY, NORMAL),
-      action::Redirect(veth));
-
+  Try<bool> hostLoToVeth = filter::ip::create(lo, hostLoFilters);
   if (hostLoToVeth.isError()) {
     ++metrics.adding_lo_ip_filters_errors;
 
     return Error(
-        "Failed to create an IP packet filter from host " +
+        "Failed to create IP packet filters from host " +
         lo + " to " + veth + ": " + hostLoToVeth.error());
   } else if (!hostLoToVeth.get()) {
     ++metrics.adding_lo_ip_filters_already_exist;
 
     return Error(
-        "The IP packet filter from host " + lo + " to " +
-        veth + " already exists");
+        "Some IP packet filters from host " + lo + " to " +
+        veth + " already exist");
   }
 
-  if (flowId.isSome()) {
-    // Add IP packet filters to classify traffic sending to eth0
-    // in the same way so that traffic of each container will be
-    // classified to different flows defined by fq_codel.
-    Try<bool> hostEth0Egress = filter::ip::create(
-        eth0,
-        hostTxFqCodelHandle,
-        ip::Classifier(None(), None(), range, None()),
-        Priority(IP_FILTER_PRIORITY, LOW),
-        Handle(hostTxFqCodelHandle, flowId.get()));
-
-    if (hostEth0Egress.isError()) {
-      ++metrics.adding_eth0_egress_filters_errors;
+  Try<bool> hostEth0Egress = filter::ip::create(eth0, hostEth0EgressFilters);
+  if (hostEth0Egress.isError()) {
+    ++metrics.adding_eth0_egress_filters_errors;
 
-      return Error(
-          "Failed to create a flow classifier for " + veth +
-          " on host " + eth0 + ": " + hostEth0Egress.error());
-    } else if (!hostEth0Egress.get()) {
-      ++metrics.adding_eth0_egress_filters_already_exist;
+    return Error(
+        "Failed to create flow classifiers for " + veth +
+        " on host " + eth0 + ": " + hostEth0Egress.error());
+  } else if (!hostEth0Egress.get()) {
+    ++metrics.adding_eth0_egress_filters_already_exist;
 
-      return Error(
-          "The flow classifier for veth " + veth +
-          " on host " + eth0 + " already exists");
-    }
+    return Error(
+        "Some flow classifiers for veth " + veth +
+        " on host " + eth0 + " already exist");
   }
 
   return Nothing();
 }
 
 
-// Helper function to remove IP filters from the host side for a given
-// port range. The boolean flag 'removeFiltersOnVeth' indicates if we
-// need to remove filters on veth.
+// Helper function to remove IP filters from the host side for the
+// given port ranges. The filters of all the port ranges are removed
+// from each link in a single batch. The boolean flag
+// 'removeFiltersOnVeth' indicates if we need to remove filters on
+// veth.
 Try<Nothing> PortMappingIsolatorProcess::removeHostIPFilters(
-    const PortRange& range,
+    const vector<PortRange>& ranges,
     const string& veth,
     bool removeFiltersOnVeth)
 {
   // NOTE: Similar to above. The order in which these filters are
   // removed is important. We need to remove filters on host eth0 and
   // host lo first before we remove filters on veth.
+  vector<ip::Classifier> hostEth0Classifiers;
+  vector<ip::Classifier> hostLoClassifiers;
+  vector<ip::Classifier> hostEth0EgressClassifiers;
+  vector<ip::Classifier> vethClassifiers;
 
-  // Remove the IP packet filter from host eth0 to veth of the container.
-  Try<bool> hostEth0ToVeth = filter::ip::remove(
-      eth0,
-      ingress::HANDLE,
-      ip::Classifier(hostMAC, hostIPNetwork.address(), None(), range));
+  foreach (const PortRange& range, ranges) {
+    hostEth0Classifiers.push_back(
+        ip::Classifier(hostMAC, hostIPNetwork.address(), None(), range));
+
+    hostLoClassifiers.push_back(
+        ip::Classifier(None(), None(), None(), range));
+
+    hostEth0EgressClassifiers.push_back(
+        ip::Classifier(None(), None(), range, None()));
+
+    vethClassifiers.push_back(
+        ip::Classifier(None(), hostIPNetwork.address(), range, None()));
+
+    vethClassifiers.push_back(
+        ip::Classifier(
+            None(),
+            net::IP::Network::LOOPBACK_V4().address(),
+            range,
+            None()));
+
+    vethClassifiers.push_back(
+        ip::Classifier(None(), None(), range, None()));
+  }
+
+  // Remove the IP packet filters from host eth0 to veth of the
+  // container.
+  Try<size_t> hostEth0ToVeth =
+    filter::ip::remove(eth0, ingress::HANDLE, hostEth0Classifiers);
 
   if (hostEth0ToVeth.isError()) {
     ++metrics.removing_eth0_ip_filters_errors;
 
     return Error(
-        "Failed to remove the IP packet filter from host " +
+        "Failed to remove the IP packet filters from host " +
         eth0 + " to " + veth + ": " + hostEth0ToVeth.error());
-  } else if (!hostEth0ToVeth.get()) {
-    ++metrics.removing_eth0_ip_filters_do_not_exist;
+  } else if (hostEth0ToVeth.get() < hostEth0Classifiers.size()) {
+    metrics.removing_eth0_ip_filters_do_not_exist +=
+      hostEth0Classifiers.size() - hostEth0ToVeth.get();
 
-    LOG(ERROR) << "The IP packet filter from host " << eth0
-               << " to " << veth << " does not exist";
+    LOG(ERROR) << "Some IP packet filters from host " << eth0
+               << " to " << veth << " do not exist";
   }
 
-  // Remove the IP packet filter from host lo to veth of the container.
-  Try<bool> hostLoToVeth = filter::ip::remove(
-      lo,
-      ingress::HANDLE,
-      ip::Classifier(None(), None(), None(), range));
+  // Remove the IP packet filters from host lo to veth of the
+  // container.
+  Try<size_t> hostLoToVeth =
+    filter::ip::remove(lo, ingress::HANDLE, hostLoClassifiers);
 
   if (hostLoToVeth.isError()) {
     ++metrics.removing_lo_ip_filters_errors;
 
     return Error(
-        "Failed to remove the IP packet filter from host " +
+        "Failed to remove the IP packet filters from host " +
         lo + " to " + veth + ": " + hostLoToVeth.error());
-  } else if (!hostLoToVeth.get()) {
-    ++metrics.removing_lo_ip_filters_do_not_exist;
+  } else if (hostLoToVeth.get() < hostLoClassifiers.size()) {
+    metrics.removing_lo_ip_filters_do_not_exist +=
+      hostLoClassifiers.size() - hostLoToVeth.get();
 
-    LOG(ERROR) << "The IP packet filter from host " << lo
-               << " to " << veth << " does not exist";
+    LOG(ERROR) << "Some IP packet filters from host " << lo
+               << " to " << veth << " do not exist";
   }
 
   if (flags.egress_unique_flow_per_container) {
-    // Remove the egress flow classifier on host eth0.
-    Try<bool> hostEth0Egress = filter::ip::remove(
+    // Remove the egress flow classifiers on host eth0.
+    Try<size_t> hostEth0Egress = filter::ip::remove(
         eth0,
         hostTxFqCodelHandle,
-        ip::Classifier(None(), None(), range, None()));
+        hostEth0EgressClassifiers);
 
     if (hostEth0Egress.isError()) {
       ++metrics.removing_eth0_egress_filters_errors;
 
       return Error(
-          "Failed to remove the flow classifier from host " +
+          "Failed to remove the flow classifiers from host " +
           eth0 + " for " + veth + ": " + hostEth0Egress.error());
-    } else if (!hostEth0Egress.get()) {
-      ++metrics.removing_eth0_egress_filters_do_not_exist;
+    } else if (hostEth0Egress.get() < hostEth0EgressClassifiers.size()) {
+      metrics.removing_eth0_egress_filters_do_not_exist +=
+        hostEth0EgressClassifiers.size() - hostEth0Egress.get();
 
-      LOG(ERROR) << "The flow classifier from host " << eth0
-                 << " for " << range << " does not exist";
+      LOG(ERROR) << "Some flow classifiers from host " << eth0
+                 << " for " << veth << " do not exist";
     }
   }
 
@@ -3872,68 +3894,24 @@ Try<Nothing> PortMappingIsolatorProcess::removeHostIPFilters(
     return Nothing();
   }
 
-  // Remove the IP packet filter from veth of the container to
-  // host lo for the public IP.
-  Try<bool> vethToHostLoPublic = filter::ip::remove(
-      veth,
-      ingress::HANDLE,
-      ip::Classifier(None(), hostIPNetwork.address(), range, None()));
-
-  if (vethToHostLoPublic.isError()) {
-    ++metrics.removing_lo_ip_filters_errors;
+  // Remove the IP packet filters from veth of the container to host
+  // lo (for both the public IP and the loopback IP) and host eth0.
+  Try<size_t> vethToHost =
+    filter::ip::remove(veth, ingress::HANDLE, vethClassifiers);
 
-    return Error(
-        "Failed to remove the IP packet filter (for public IP) from " +
-        veth + " to host " + lo + ": " + vethToHostLoPublic.error());
-  } else if (!vethToHostLoPublic.get()) {
-    ++metrics.removing_lo_ip_filters_do_not_exist;
-
-    LOG(ERROR) << "The IP packet filter (for public IP) from "
-               << veth << " to host " << lo << " does not exist";
-  }
-
-  // Remove the IP packet filter from veth of the container to
-  // host lo for the loopback IP.
-  Try<bool> vethToHostLoLoopback = filter::ip::remove(
-      veth,
-      ingress::HANDLE,
-      ip::Classifier(
-          None(),
-          net::IP::Network::LOOPBACK_V4().address(),
-          range,
-          None()));
-
-  if (vethToHostLoLoopback.isError()) {
-    ++metrics.removing_veth_ip_filters_errors;
-
-    return Error(
-        "Failed to remove the IP packet filter (for loopback IP) from " +
-        veth + " to host " + lo + ": " + vethToHostLoLoopback.error());
-  } else if (!vethToHostLoLoopback.get()) {
-    ++metrics.removing_veth_ip_filters_do_not_exist;
-
-    LOG(ERROR) << "The IP packet filter (for loopback IP) from "
-               << veth << " to host " << lo << " does not exist";
-  }
-
-  // Remove the IP packet filter from veth of the container to
-  // host eth0.
-  Try<bool> vethToHostEth0 = filter::ip::remove(
-      veth,
-      ingress::HANDLE,
-      ip::Classifier(None(), None(), range, None()));
-
-  if (vethToHostEth0.isError()) {
+  if (vethToHost.isError()) {
     ++metrics.removing_veth_ip_filters_errors;
 
     return Error(
-        "Failed to remove the IP packet filter from " + veth +
-        " to host " + eth0 + ": " + vethToHostEth0.error());
-  } else if (!vethToHostEth0.get()) {
-    ++metrics.removing_veth_ip_filters_do_not_exist;
-
-    LOG(ERROR) << "The IP packet filter from " << veth
-               << " to host " << eth0 << " does not exist";
+        "Failed to remove the IP packet filters from " + veth +
+        " to host " + eth0 + " and host " + lo + ": " + vethToHost.error());
+  } else if (vethToHost.get() < vethClassifiers.size()) {
+    metrics.removing_veth_ip_filters_do_not_exist +=
+      vethClassifiers.size() - vethToHost.get();
+
+    LOG(ERROR) << "Some IP packet filters from " << veth
+               << " to host " << eth0 << " and host " << lo
+               << " do not exist";
   }
 
   return Nothing();
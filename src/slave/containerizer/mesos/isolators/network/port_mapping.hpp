@@ -201,6 +201,13 @@ private:
     // ports used by the container.
     const Interval<uint16_t> ephemeralPorts;
 
+    // The port ranges (both non-ephemeral and ephemeral) for which IP
+    // packet filters have been set up for the container. This mirrors
+    // the filters installed in the kernel so that 'update' and
+    // 'cleanup' can work out which filters to add or remove without
+    // dumping the filters of the container from the kernel.
+    hashset<routing::filter::ip::PortRange> portRanges;
+
     Option<pid_t> pid;
     Option<uint16_t> flowId;
   };
@@ -297,12 +304,12 @@ private:
 
   // Helper functions.
   Try<Nothing> addHostIPFilters(
-      const routing::filter::ip::PortRange& range,
+      const std::vector<routing::filter::ip::PortRange>& ranges,
       const Option<uint16_t>& flowId,
       const std::string& veth);
 
   Try<Nothing> removeHostIPFilters(
-      const routing::filter::ip::PortRange& range,
+      const std::vector<routing::filter::ip::PortRange>& ranges,
       const std::string& veth,
       bool removeFiltersOnVeth = true);
 
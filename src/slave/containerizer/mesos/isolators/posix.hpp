@@ -41,6 +41,11 @@ namespace slave {
 class PosixIsolatorProcess : public MesosIsolatorProcess
 {
 public:
+  bool supportsParallelPrepare() override
+  {
+    return true;
+  }
+
   process::Future<Nothing> recover(
       const std::vector<mesos::slave::ContainerState>& state,
       const hashset<ContainerID>& orphans) override
@@ -40,6 +40,12 @@ bool PosixRLimitsIsolatorProcess::supportsStandalone()
 }
 
 
+bool PosixRLimitsIsolatorProcess::supportsParallelPrepare()
+{
+  return true;
+}
+
+
 process::Future<Option<ContainerLaunchInfo>>
 PosixRLimitsIsolatorProcess::prepare(
     const ContainerID& containerId,
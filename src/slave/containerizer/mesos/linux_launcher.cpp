@@ -39,10 +39,12 @@
 
 #include "slave/containerizer/mesos/linux_launcher.hpp"
 #include "slave/containerizer/mesos/paths.hpp"
+#include "slave/containerizer/mesos/zygote.hpp"
 
 using namespace process;
 
 using std::map;
+using std::pair;
 using std::set;
 using std::string;
 using std::vector;
@@ -61,7 +63,8 @@ public:
   LinuxLauncherProcess(
       const Flags& flags,
       const string& freezerHierarchy,
-      const Option<string>& systemdHierarchy);
+      const Option<string>& systemdHierarchy,
+      const Owned<Zygote>& zygote);
 
   virtual process::Future<hashset<ContainerID>> recover(
       const vector<mesos::slave::ContainerState>& states);
@@ -109,6 +112,11 @@ private:
   const string freezerHierarchy;
   const Option<string> systemdHierarchy;
   hashmap<ContainerID, Container> containers;
+
+  // Clones the processes of containers if `--launcher_zygote` is set.
+  // Reset if the zygote goes away, in which case we fall back to
+  // cloning from the agent.
+  Owned<Zygote> zygote;
 };
 
 
@@ -172,10 +180,23 @@ Try<Launcher*> LinuxLauncher::create(const Flags& flags)
               << " as the systemd hierarchy for the Linux launcher";
   }
 
+  Owned<Zygote> zygote;
+
+  if (flags.launcher_zygote) {
+    Try<Owned<Zygote>> _zygote = Zygote::create(flags.launcher_dir);
+    if (_zygote.isError()) {
+      return Error(
+          "Failed to create zygote for Linux launcher: " + _zygote.error());
+    }
+
+    zygote = _zygote.get();
+  }
+
   return new LinuxLauncher(
       flags,
       freezerHierarchy.get(),
-      systemdHierarchy);
+      systemdHierarchy,
+      zygote);
 }
 
 
@@ -192,8 +213,13 @@ bool LinuxLauncher::available()
 LinuxLauncher::LinuxLauncher(
     const Flags& flags,
     const string& freezerHierarchy,
-    const Option<string>& systemdHierarchy)
-  : process(new LinuxLauncherProcess(flags, freezerHierarchy, systemdHierarchy))
+    const Option<string>& systemdHierarchy,
+    const Owned<Zygote>& zygote)
+  : process(new LinuxLauncherProcess(
+        flags,
+        freezerHierarchy,
+        systemdHierarchy,
+        zygote))
 {
   process::spawn(process.get());
 }
@@ -256,10 +282,12 @@ Future<ContainerStatus> LinuxLauncher::status(
 LinuxLauncherProcess::LinuxLauncherProcess(
     const Flags& _flags,
     const string& _freezerHierarchy,
-    const Option<string>& _systemdHierarchy)
+    const Option<string>& _systemdHierarchy,
+    const Owned<Zygote>& _zygote)
   : flags(_flags),
     freezerHierarchy(_freezerHierarchy),
-    systemdHierarchy(_systemdHierarchy) {}
+    systemdHierarchy(_systemdHierarchy),
+    zygote(_zygote) {}
 
 
 Future<hashset<ContainerID>> LinuxLauncherProcess::recover(
@@ -479,6 +507,64 @@ Try<pid_t> LinuxLauncherProcess::fork(
 
   cloneFlags |= SIGCHLD; // Specify SIGCHLD as child termination signal.
 
+  if (zygote.get() != nullptr) {
+    // The zygote places the child into the same cgroups as the parent
+    // hooks below do, in the same order.
+    vector<pair<string, string>> cgroups;
+
+    const string cgroup =
+      containerizer::paths::getCgroupPath(this->flags.cgroups_root, containerId);
+
+    cgroups.emplace_back(freezerHierarchy, cgroup);
+
+    if (systemdHierarchy.isSome()) {
+      cgroups.emplace_back(systemdHierarchy.get(), cgroup);
+    }
+
+    // Pass the flags as arguments, in the same way as `subprocess`.
+    vector<string> arguments = argv;
+    if (flags != nullptr) {
+      foreachvalue (const flags::Flag& flag, *flags) {
+        Option<string> value = flag.stringify(*flags);
+        if (value.isSome()) {
+          arguments.push_back(
+              "--" + flag.effective_name().value + "=" + value.get());
+        }
+      }
+    }
+
+    Try<pid_t> pid = zygote->fork(
+        path,
+        arguments,
+        containerIO,
+        environment.isSome() ? environment.get() : os::environment(),
+        target,
+        enterFlags,
+        cloneFlags,
+        cgroups,
+        whitelistFds);
+
+    if (pid.isSome()) {
+      Container container;
+      container.id = containerId;
+      container.pid = pid.get();
+
+      containers.put(container.id, container);
+
+      return pid.get();
+    }
+
+    if (zygote->connected()) {
+      return Error("Failed to clone child process: " + pid.error());
+    }
+
+    LOG(WARNING) << "Falling back to cloning from the agent since the zygote"
+                 << " with pid " << zygote->pid() << " is gone: "
+                 << pid.error();
+
+    zygote.reset();
+  }
+
   // The ordering of the hooks is:
   // (1) Create the freezer cgroup, and add the child to the cgroup.
   // (2) Create the systemd cgroup, and add the child to the cgroup.
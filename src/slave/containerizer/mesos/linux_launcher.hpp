@@ -26,9 +26,12 @@ namespace internal {
 namespace slave {
 
 class LinuxLauncherProcess;
+class Zygote;
 
 // Launcher for Linux systems with cgroups. Uses a freezer cgroup to
-// track pids.
+// track pids. If `--launcher_zygote` is set, the processes of the
+// containers are cloned by a zygote (see `Zygote`) rather than by the
+// agent itself.
 class LinuxLauncher : public Launcher
 {
 public:
@@ -62,7 +65,8 @@ private:
   LinuxLauncher(
       const Flags& flags,
       const std::string& freezerHierarchy,
-      const Option<std::string>& systemdHierarchy);
+      const Option<std::string>& systemdHierarchy,
+      const process::Owned<Zygote>& zygote);
 
   process::Owned<LinuxLauncherProcess> process;
 };
@@ -0,0 +1,815 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "slave/containerizer/mesos/zygote.hpp"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include <algorithm>
+#include <array>
+#include <iostream>
+
+#include <glog/logging.h>
+
+#include <stout/error.hpp>
+#include <stout/foreach.hpp>
+#include <stout/json.hpp>
+#include <stout/lambda.hpp>
+#include <stout/nothing.hpp>
+#include <stout/numify.hpp>
+#include <stout/os.hpp>
+#include <stout/path.hpp>
+#include <stout/result.hpp>
+#include <stout/stringify.hpp>
+#include <stout/strings.hpp>
+
+#include <stout/os/close.hpp>
+#include <stout/os/constants.hpp>
+#include <stout/os/socket.hpp>
+#include <stout/os/strerror.hpp>
+
+#include <stout/os/raw/argv.hpp>
+#include <stout/os/raw/environment.hpp>
+
+#include "linux/cgroups.hpp"
+#include "linux/ns.hpp"
+
+#include "slave/containerizer/mesos/constants.hpp"
+
+using process::Owned;
+using process::Subprocess;
+
+using std::array;
+using std::cerr;
+using std::endl;
+using std::map;
+using std::pair;
+using std::string;
+using std::vector;
+
+using mesos::slave::ContainerIO;
+
+namespace mesos {
+namespace internal {
+namespace slave {
+
+namespace {
+
+// The largest number of file descriptors that can be sent along with a
+// request, i.e., the standard streams, the executable and the
+// whitelisted file descriptors.
+constexpr size_t MAX_FDS = 64;
+
+
+Try<Nothing> sendAll(int_fd socket, const char* data, size_t size)
+{
+  while (size > 0) {
+    ssize_t length = ::send(socket, data, size, MSG_NOSIGNAL);
+    if (length < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+
+      return ErrnoError();
+    }
+
+    data += length;
+    size -= length;
+  }
+
+  return Nothing();
+}
+
+
+Try<Nothing> receiveAll(int_fd socket, char* data, size_t size)
+{
+  while (size > 0) {
+    ssize_t length = ::recv(socket, data, size, 0);
+    if (length < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+
+      return ErrnoError();
+    } else if (length == 0) {
+      return Error("Unexpected EOF");
+    }
+
+    data += length;
+    size -= length;
+  }
+
+  return Nothing();
+}
+
+
+// Sends a message prefixed by its size, passing `fds` along with the
+// size so that they are received together with the message.
+Try<Nothing> send(int_fd socket, const string& data, const vector<int_fd>& fds)
+{
+  if (fds.size() > MAX_FDS) {
+    return Error("Too many file descriptors");
+  }
+
+  uint32_t size = data.size();
+
+  iovec iov;
+  iov.iov_base = &size;
+  iov.iov_len = sizeof(size);
+
+  alignas(cmsghdr) char control[CMSG_SPACE(MAX_FDS * sizeof(int))];
+
+  msghdr message;
+  memset(&message, 0, sizeof(message));
+  message.msg_iov = &iov;
+  message.msg_iovlen = 1;
+
+  if (!fds.empty()) {
+    message.msg_control = control;
+    message.msg_controllen = CMSG_SPACE(fds.size() * sizeof(int));
+
+    cmsghdr* cmessage = CMSG_FIRSTHDR(&message);
+    cmessage->cmsg_level = SOL_SOCKET;
+    cmessage->cmsg_type = SCM_RIGHTS;
+    cmessage->cmsg_len = CMSG_LEN(fds.size() * sizeof(int));
+
+    memcpy(CMSG_DATA(cmessage), fds.data(), fds.size() * sizeof(int));
+  }
+
+  ssize_t length;
+  do {
+    length = ::sendmsg(socket, &message, MSG_NOSIGNAL);
+  } while (length < 0 && errno == EINTR);
+
+  if (length < 0) {
+    return ErrnoError();
+  }
+
+  Try<Nothing> header = sendAll(
+      socket,
+      reinterpret_cast<char*>(&size) + length,
+      sizeof(size) - length);
+
+  if (header.isError()) {
+    return header;
+  }
+
+  return sendAll(socket, data.data(), data.size());
+}
+
+
+// Receives a message sent by `send` and appends the file descriptors
+// passed along with it to `fds`. Returns none if the peer has closed
+// the socket.
+Result<string> receive(int_fd socket, vector<int_fd>* fds)
+{
+  uint32_t size = 0;
+
+  iovec iov;
+  iov.iov_base = &size;
+  iov.iov_len = sizeof(size);
+
+  alignas(cmsghdr) char control[CMSG_SPACE(MAX_FDS * sizeof(int))];
+
+  msghdr message;
+  memset(&message, 0, sizeof(message));
+  message.msg_iov = &iov;
+  message.msg_iovlen = 1;
+  message.msg_control = control;
+  message.msg_controllen = sizeof(control);
+
+  ssize_t length;
+  do {
+    length = ::recvmsg(socket, &message, MSG_CMSG_CLOEXEC);
+  } while (length < 0 && errno == EINTR);
+
+  if (length < 0) {
+    return ErrnoError();
+  } else if (length == 0) {
+    return None();
+  }
+
+  for (cmsghdr* cmessage = CMSG_FIRSTHDR(&message);
+       cmessage != nullptr;
+       cmessage = CMSG_NXTHDR(&message, cmessage)) {
+    if (cmessage->cmsg_level == SOL_SOCKET &&
+        cmessage->cmsg_type == SCM_RIGHTS) {
+      const size_t count = (cmessage->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+      const int* data = reinterpret_cast<const int*>(CMSG_DATA(cmessage));
+
+      fds->insert(fds->end(), data, data + count);
+    }
+  }
+
+  if (message.msg_flags & MSG_CTRUNC) {
+    return Error("Too many file descriptors");
+  }
+
+  Try<Nothing> header = receiveAll(
+      socket,
+      reinterpret_cast<char*>(&size) + length,
+      sizeof(size) - length);
+
+  if (header.isError()) {
+    return Error(header.error());
+  }
+
+  string data(size, '\0');
+
+  Try<Nothing> body = receiveAll(socket, &data[0], size);
+  if (body.isError()) {
+    return Error(body.error());
+  }
+
+  return data;
+}
+
+
+void close(const vector<int_fd>& fds)
+{
+  foreach (int_fd fd, fds) {
+    os::close(fd);
+  }
+}
+
+
+// Clones the process described by `data` (see `Zygote::fork`) which
+// inherits `fds`. The process is executed with the signal `mask`.
+//
+// NOTE: The zygote is single threaded, so unlike `subprocess` the
+// cloned process may do more than async signal safe calls. We still
+// prepare everything up front and only make system calls after the
+// clone.
+Try<pid_t> launch(
+    const string& data,
+    const vector<int_fd>& fds,
+    const sigset_t& mask)
+{
+  Try<JSON::Object> request = JSON::parse<JSON::Object>(data);
+  if (request.isError()) {
+    return Error("Failed to parse request: " + request.error());
+  }
+
+  Result<JSON::String> path = request->at<JSON::String>("path");
+  Result<JSON::Array> arguments = request->at<JSON::Array>("argv");
+  Result<JSON::Object> environment = request->at<JSON::Object>("environment");
+  Result<JSON::Number> target = request->at<JSON::Number>("target");
+  Result<JSON::Number> enterFlags = request->at<JSON::Number>("enter_flags");
+  Result<JSON::Number> cloneFlags = request->at<JSON::Number>("clone_flags");
+  Result<JSON::Array> cgroups = request->at<JSON::Array>("cgroups");
+  Result<JSON::Array> targets = request->at<JSON::Array>("fds");
+
+  if (!path.isSome() ||
+      !arguments.isSome() ||
+      !environment.isSome() ||
+      target.isError() ||
+      !enterFlags.isSome() ||
+      !cloneFlags.isSome() ||
+      !cgroups.isSome() ||
+      !targets.isSome()) {
+    return Error("Malformed request");
+  }
+
+  vector<string> argv;
+  foreach (const JSON::Value& value, arguments->values) {
+    if (!value.is<JSON::String>()) {
+      return Error("Malformed request");
+    }
+
+    argv.push_back(value.as<JSON::String>().value);
+  }
+
+  foreachvalue (const JSON::Value& value, environment->values) {
+    if (!value.is<JSON::String>()) {
+      return Error("Malformed request");
+    }
+  }
+
+  vector<pair<string, string>> _cgroups;
+  foreach (const JSON::Value& value, cgroups->values) {
+    if (!value.is<JSON::Object>()) {
+      return Error("Malformed request");
+    }
+
+    Result<JSON::String> hierarchy =
+      value.as<JSON::Object>().at<JSON::String>("hierarchy");
+
+    Result<JSON::String> cgroup =
+      value.as<JSON::Object>().at<JSON::String>("cgroup");
+
+    if (!hierarchy.isSome() || !cgroup.isSome()) {
+      return Error("Malformed request");
+    }
+
+    _cgroups.emplace_back(hierarchy->value, cgroup->value);
+  }
+
+  if (targets->values.size() != fds.size()) {
+    return Error(
+        "Expected " + stringify(targets->values.size()) +
+        " file descriptors but received " + stringify(fds.size()));
+  }
+
+  // The number at which each of `fds` is open in the cloned process,
+  // and whether it is closed when the process is executed.
+  vector<int> numbers;
+  vector<bool> cloexecs;
+
+  // The lowest number above all of `numbers`.
+  int floor = STDERR_FILENO + 1;
+
+  foreach (const JSON::Value& value, targets->values) {
+    if (!value.is<JSON::Object>()) {
+      return Error("Malformed request");
+    }
+
+    Result<JSON::Number> number =
+      value.as<JSON::Object>().at<JSON::Number>("fd");
+
+    Result<JSON::Boolean> cloexec =
+      value.as<JSON::Object>().at<JSON::Boolean>("cloexec");
+
+    if (!number.isSome() || !cloexec.isSome() || number->as<int>() < 0) {
+      return Error("Malformed request");
+    }
+
+    numbers.push_back(number->as<int>());
+    cloexecs.push_back(cloexec->value);
+
+    floor = std::max(floor, number->as<int>() + 1);
+  }
+
+  const string executable = path->value;
+
+  os::raw::Argv _argv(argv);
+  os::raw::Envp envp(environment.get());
+
+  vector<int_fd> moved(fds.size(), -1);
+
+  int pipes[2];
+  if (::pipe2(pipes, O_CLOEXEC) == -1) {
+    return ErrnoError("Failed to create pipe");
+  }
+
+  lambda::function<int()> child = [&]() -> int {
+    ::close(pipes[1]);
+
+    // Wait until the zygote has moved us into the cgroups.
+    char dummy;
+    ssize_t length;
+    while ((length = ::read(pipes[0], &dummy, sizeof(dummy))) == -1 &&
+           errno == EINTR);
+
+    if (length != sizeof(dummy)) {
+      ::_exit(EXIT_FAILURE);
+    }
+
+    ::close(pipes[0]);
+
+    if (::setsid() == -1) {
+      ::_exit(EXIT_FAILURE);
+    }
+
+    // Move the file descriptors out of the way first, so that none of
+    // them is closed by duplicating another one onto its number.
+    for (size_t i = 0; i < fds.size(); i++) {
+      moved[i] = ::fcntl(fds[i], F_DUPFD_CLOEXEC, floor);
+      if (moved[i] == -1) {
+        ::_exit(EXIT_FAILURE);
+      }
+    }
+
+    for (size_t i = 0; i < fds.size(); i++) {
+      if (::dup2(moved[i], numbers[i]) == -1) {
+        ::_exit(EXIT_FAILURE);
+      }
+
+      if (cloexecs[i] && ::fcntl(numbers[i], F_SETFD, FD_CLOEXEC) == -1) {
+        ::_exit(EXIT_FAILURE);
+      }
+    }
+
+    ::sigprocmask(SIG_SETMASK, &mask, nullptr);
+
+    ::execve(executable.c_str(), _argv, envp);
+
+    const char message[] = "Failed to execute the container init process\n";
+    while (::write(STDERR_FILENO, message, sizeof(message) - 1) == -1 &&
+           errno == EINTR);
+
+    ::_exit(EXIT_FAILURE);
+  };
+
+  Try<pid_t> pid = [&]() -> Try<pid_t> {
+    if (target.isSome()) {
+      return ns::clone(
+          target->as<pid_t>(),
+          enterFlags->as<int>(),
+          child,
+          cloneFlags->as<int>());
+    }
+
+    pid_t pid = os::clone(child, cloneFlags->as<int>());
+    if (pid == -1) {
+      return ErrnoError();
+    }
+
+    return pid;
+  }();
+
+  ::close(pipes[0]);
+
+  if (pid.isError()) {
+    ::close(pipes[1]);
+    return Error("Failed to clone: " + pid.error());
+  }
+
+  foreach (const auto& cgroup, _cgroups) {
+    Try<Nothing> isolate =
+      cgroups::isolate(cgroup.first, cgroup.second, pid.get());
+
+    if (isolate.isError()) {
+      ::kill(pid.get(), SIGKILL);
+      ::close(pipes[1]);
+
+      return Error(
+          "Failed to move process " + stringify(pid.get()) + " into cgroup '" +
+          cgroup.second + "' of hierarchy '" + cgroup.first + "': " +
+          isolate.error());
+    }
+  }
+
+  // Let the process run.
+  char dummy = 0;
+  ssize_t length;
+  while ((length = ::write(pipes[1], &dummy, sizeof(dummy))) == -1 &&
+         errno == EINTR);
+
+  ::close(pipes[1]);
+
+  if (length != sizeof(dummy)) {
+    ::kill(pid.get(), SIGKILL);
+    return ErrnoError("Failed to synchronize with process");
+  }
+
+  return pid.get();
+}
+
+
+// Reaps all the exited processes which we cloned. Their exit status is
+// checkpointed by the container init process, so we discard it.
+void reap()
+{
+  while (::waitpid(-1, nullptr, WNOHANG) > 0);
+}
+
+} // namespace {
+
+
+Try<Owned<Zygote>> Zygote::create(const string& launcherDir)
+{
+  Try<array<int_fd, 2>> sockets = net::socketpair(AF_UNIX, SOCK_STREAM, 0);
+  if (sockets.isError()) {
+    return Error("Failed to create socket pair: " + sockets.error());
+  }
+
+  MesosContainerizerZygote::Flags flags;
+  flags.socket = sockets->at(1);
+
+  const string path = path::join(launcherDir, MESOS_CONTAINERIZER);
+
+  Try<Subprocess> zygote = process::subprocess(
+      path,
+      {path, MesosContainerizerZygote::NAME},
+      Subprocess::PATH(os::DEV_NULL),
+      Subprocess::FD(STDOUT_FILENO),
+      Subprocess::FD(STDERR_FILENO),
+      &flags,
+      None(),
+      None(),
+      {},
+      {Subprocess::ChildHook::SETSID()},
+      {sockets->at(1)});
+
+  os::close(sockets->at(1));
+
+  if (zygote.isError()) {
+    os::close(sockets->at(0));
+    return Error("Failed to launch zygote: " + zygote.error());
+  }
+
+  LOG(INFO) << "Launched zygote with pid " << zygote->pid();
+
+  return Owned<Zygote>(new Zygote(zygote.get(), sockets->at(0)));
+}
+
+
+Zygote::Zygote(const Subprocess& _zygote, int_fd _socket)
+  : zygote(_zygote),
+    socket(_socket),
+    disconnected(false) {}
+
+
+Zygote::~Zygote()
+{
+  os::close(socket);
+}
+
+
+Try<pid_t> Zygote::fork(
+    const string& path,
+    const vector<string>& argv,
+    const ContainerIO& containerIO,
+    const map<string, string>& environment,
+    const Option<pid_t>& target,
+    int enterFlags,
+    int cloneFlags,
+    const vector<pair<string, string>>& cgroups,
+    const vector<int_fd>& whitelistFds)
+{
+  if (disconnected) {
+    return Error("Zygote is disconnected");
+  }
+
+  // The file descriptors sent along with the request, and the ones
+  // among them which we open here and have to close once sent.
+  vector<int_fd> fds;
+  vector<int_fd> opened;
+
+  JSON::Array targets;
+
+  auto add = [&fds, &targets](int_fd fd, int_fd number, bool cloexec) {
+    JSON::Object object;
+    object.values["fd"] = number;
+    object.values["cloexec"] = cloexec;
+
+    fds.push_back(fd);
+    targets.values.emplace_back(std::move(object));
+  };
+
+  const ContainerIO::IO* ios[] = {
+    &containerIO.in,
+    &containerIO.out,
+    &containerIO.err
+  };
+
+  for (int_fd number = 0; number <= STDERR_FILENO; number++) {
+    const ContainerIO::IO& io = *ios[number];
+
+    if (io.type() == ContainerIO::IO::Type::FD) {
+      add(io.fd(), number, false);
+      continue;
+    }
+
+    // Open the path in the same way as `Subprocess::PATH` does.
+    Try<int_fd> fd = number == STDIN_FILENO
+      ? os::open(io.path(), O_RDONLY | O_CLOEXEC)
+      : os::open(
+            io.path(),
+            O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC,
+            S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+
+    if (fd.isError()) {
+      close(opened);
+      return Error("Failed to open '" + io.path() + "': " + fd.error());
+    }
+
+    opened.push_back(fd.get());
+    add(fd.get(), number, false);
+  }
+
+  foreach (int_fd fd, whitelistFds) {
+    add(fd, fd, false);
+  }
+
+  // The launcher executes the init process through a file descriptor
+  // when the binary is sealed (see `ENABLE_LAUNCHER_SEALING`), in which
+  // case the file descriptor has to be open in the cloned process too.
+  const string procSelfFd = "/proc/self/fd/";
+  if (strings::startsWith(path, procSelfFd)) {
+    Try<int_fd> fd = numify<int_fd>(path.substr(procSelfFd.size()));
+
+    if (fd.isSome() &&
+        std::find(whitelistFds.begin(), whitelistFds.end(), fd.get()) ==
+          whitelistFds.end()) {
+      add(fd.get(), fd.get(), true);
+    }
+  }
+
+  JSON::Array _argv;
+  foreach (const string& argument, argv) {
+    _argv.values.emplace_back(argument);
+  }
+
+  JSON::Object _environment;
+  foreachpair (const string& name, const string& value, environment) {
+    _environment.values[name] = value;
+  }
+
+  JSON::Array _cgroups;
+  foreach (const auto& cgroup, cgroups) {
+    JSON::Object object;
+    object.values["hierarchy"] = cgroup.first;
+    object.values["cgroup"] = cgroup.second;
+
+    _cgroups.values.emplace_back(std::move(object));
+  }
+
+  JSON::Object request;
+  request.values["path"] = path;
+  request.values["argv"] = std::move(_argv);
+  request.values["environment"] = std::move(_environment);
+  request.values["enter_flags"] = enterFlags;
+  request.values["clone_flags"] = cloneFlags;
+  request.values["cgroups"] = std::move(_cgroups);
+  request.values["fds"] = std::move(targets);
+
+  if (target.isSome()) {
+    request.values["target"] = target.get();
+  }
+
+  Try<Nothing> sent = send(socket, stringify(request), fds);
+
+  close(opened);
+
+  if (sent.isError()) {
+    disconnected = true;
+    return Error("Failed to send request to zygote: " + sent.error());
+  }
+
+  vector<int_fd> received;
+  Result<string> data = receive(socket, &received);
+
+  close(received);
+
+  if (!data.isSome()) {
+    disconnected = true;
+    return Error(
+        "Failed to receive reply from zygote: " +
+        (data.isError() ? data.error() : "Zygote has exited"));
+  }
+
+  Try<JSON::Object> reply = JSON::parse<JSON::Object>(data.get());
+  if (reply.isError()) {
+    disconnected = true;
+    return Error("Failed to parse reply from zygote: " + reply.error());
+  }
+
+  Result<JSON::String> error = reply->at<JSON::String>("error");
+  if (error.isSome()) {
+    return Error(error->value);
+  }
+
+  Result<JSON::Number> pid = reply->at<JSON::Number>("pid");
+  if (!pid.isSome()) {
+    disconnected = true;
+    return Error("Malformed reply from zygote");
+  }
+
+  return pid->as<pid_t>();
+}
+
+
+const string MesosContainerizerZygote::NAME = "zygote";
+
+
+MesosContainerizerZygote::Flags::Flags()
+{
+  add(&Flags::socket,
+      "socket",
+      "The Unix domain socket over which the launcher sends its requests.\n"
+      "The zygote exits once the launcher closes its end of the socket.");
+}
+
+
+int MesosContainerizerZygote::execute()
+{
+  if (flags.help) {
+    cerr << flags.usage();
+    return EXIT_SUCCESS;
+  }
+
+  if (flags.socket.isNone()) {
+    cerr << "Flag --socket is not specified" << endl;
+    return EXIT_FAILURE;
+  }
+
+  const int_fd socket = flags.socket.get();
+
+  // Don't leak the socket into the processes we clone.
+  Try<Nothing> cloexec = os::cloexec(socket);
+  if (cloexec.isError()) {
+    cerr << "Failed to set FD_CLOEXEC on the socket: "
+         << cloexec.error() << endl;
+    return EXIT_FAILURE;
+  }
+
+  // We block SIGCHLD and wait for it on a signalfd along with the
+  // requests, so that the processes we clone are reaped as soon as
+  // they exit. The agent checks for the exit of a process which is not
+  // its child by polling whether its pid exists, which includes the
+  // time the process spends as a zombie.
+  sigset_t mask;
+  sigset_t original;
+  sigemptyset(&mask);
+  sigaddset(&mask, SIGCHLD);
+
+  if (::sigprocmask(SIG_BLOCK, &mask, &original) == -1) {
+    cerr << "Failed to block SIGCHLD: " << os::strerror(errno) << endl;
+    return EXIT_FAILURE;
+  }
+
+  int signals = ::signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+  if (signals == -1) {
+    cerr << "Failed to create signalfd: " << os::strerror(errno) << endl;
+    return EXIT_FAILURE;
+  }
+
+  while (true) {
+    pollfd fds[2];
+    fds[0].fd = socket;
+    fds[0].events = POLLIN;
+    fds[0].revents = 0;
+    fds[1].fd = signals;
+    fds[1].events = POLLIN;
+    fds[1].revents = 0;
+
+    if (::poll(fds, 2, -1) == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+
+      cerr << "Failed to poll: " << os::strerror(errno) << endl;
+      return EXIT_FAILURE;
+    }
+
+    if (fds[1].revents != 0) {
+      signalfd_siginfo info;
+      while (::read(signals, &info, sizeof(info)) > 0);
+
+      reap();
+    }
+
+    if (fds[0].revents == 0) {
+      continue;
+    }
+
+    vector<int_fd> received;
+    Result<string> request = receive(socket, &received);
+
+    if (request.isNone()) {
+      // The launcher has closed the socket.
+      return EXIT_SUCCESS;
+    } else if (request.isError()) {
+      close(received);
+
+      cerr << "Failed to receive request: " << request.error() << endl;
+      return EXIT_FAILURE;
+    }
+
+    Try<pid_t> pid = launch(request.get(), received, original);
+
+    close(received);
+
+    JSON::Object reply;
+    if (pid.isError()) {
+      reply.values["error"] = pid.error();
+    } else {
+      reply.values["pid"] = pid.get();
+    }
+
+    Try<Nothing> sent = send(socket, stringify(reply), {});
+    if (sent.isError()) {
+      cerr << "Failed to send reply: " << sent.error() << endl;
+      return EXIT_FAILURE;
+    }
+  }
+}
+
+} // namespace slave {
+} // namespace internal {
+} // namespace mesos {
@@ -0,0 +1,131 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __MESOS_CONTAINERIZER_ZYGOTE_HPP__
+#define __MESOS_CONTAINERIZER_ZYGOTE_HPP__
+
+#include <sys/types.h>
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <mesos/slave/containerizer.hpp>
+
+#include <process/owned.hpp>
+#include <process/subprocess.hpp>
+
+#include <stout/option.hpp>
+#include <stout/subcommand.hpp>
+#include <stout/try.hpp>
+
+#include <stout/os/int_fd.hpp>
+
+namespace mesos {
+namespace internal {
+namespace slave {
+
+// A small helper process, forked once by the Linux launcher, which
+// clones the processes of containers on behalf of the agent. Cloning
+// from the agent gets slower as the agent's address space and thread
+// count grow, whereas the zygote is a single threaded process that
+// only ever holds a few pages, so the latency of a launch does not
+// depend on the size of the agent.
+//
+// The launcher sends each request over a Unix domain socket along with
+// the file descriptors the process should inherit. The zygote clones
+// the process (entering the namespaces of a target if asked to), moves
+// it into the requested cgroups before letting it run and replies with
+// its pid. The zygote also reaps the processes it cloned; the agent
+// learns about their exit in the same way as for the processes of
+// recovered containers.
+//
+// NOTE: This class is not thread-safe, it is meant to be used from a
+// single actor.
+class Zygote
+{
+public:
+  // Forks a zygote by executing `mesos-containerizer zygote` from
+  // `launcherDir`.
+  static Try<process::Owned<Zygote>> create(const std::string& launcherDir);
+
+  // Closes the socket, which makes the zygote exit.
+  ~Zygote();
+
+  // Clones a process which executes `path` with `argv` and
+  // `environment`, redirecting its standard streams as specified by
+  // `containerIO` and keeping the `whitelistFds` open. If `target` is
+  // set, the `enterFlags` namespaces of `target` are entered first.
+  // The process is placed into each of the (hierarchy, cgroup) pairs
+  // of `cgroups` before it is executed.
+  Try<pid_t> fork(
+      const std::string& path,
+      const std::vector<std::string>& argv,
+      const mesos::slave::ContainerIO& containerIO,
+      const std::map<std::string, std::string>& environment,
+      const Option<pid_t>& target,
+      int enterFlags,
+      int cloneFlags,
+      const std::vector<std::pair<std::string, std::string>>& cgroups,
+      const std::vector<int_fd>& whitelistFds);
+
+  // Returns false once the zygote can no longer be talked to, e.g.,
+  // because it has exited.
+  bool connected() const { return !disconnected; }
+
+  pid_t pid() const { return zygote.pid(); }
+
+private:
+  Zygote(const process::Subprocess& zygote, int_fd socket);
+
+  Zygote(const Zygote&) = delete;
+  Zygote& operator=(const Zygote&) = delete;
+
+  const process::Subprocess zygote;
+  const int_fd socket;
+  bool disconnected;
+};
+
+
+// The "zygote" subcommand runs the zygote: it serves the requests sent
+// by a `Zygote` over the `--socket` until the socket is closed.
+class MesosContainerizerZygote : public Subcommand
+{
+public:
+  static const std::string NAME;
+
+  struct Flags : public virtual flags::FlagsBase
+  {
+    Flags();
+
+    Option<int_fd> socket;
+  };
+
+  MesosContainerizerZygote() : Subcommand(NAME) {}
+
+  Flags flags;
+
+protected:
+  int execute() override;
+  flags::FlagsBase* getFlags() override { return &flags; }
+};
+
+} // namespace slave {
+} // namespace internal {
+} // namespace mesos {
+
+#endif // __MESOS_CONTAINERIZER_ZYGOTE_HPP__
@@ -173,7 +173,10 @@ mesos::internal::slave::Flags::Flags()
       "flag. if `cgroups/all` is specified, any other cgroups related\n"
       "isolation options (e.g., `cgroups/cpu`) will be ignored, and all\n"
       "the local enabled cgroups subsystems on the agent host will be\n"
-      "automatically loaded by the cgroups isolator. Note that this flag\n"
+      "automatically loaded by the cgroups isolator. On hosts with the\n"
+      "cgroup v2 unified hierarchy, `cgroups2/all` can be used instead\n"
+      "of the `cgroups/` isolators (together with `--launcher=posix` if\n"
+      "no cgroups v1 freezer hierarchy is mounted). Note that this flag\n"
       "is only relevant for the Mesos Containerizer.",
 #ifndef __WINDOWS__
       "posix/cpu,posix/mem"
@@ -557,6 +560,30 @@ mesos::internal::slave::Flags::Flags()
       "and can still be used.",
       false);
 
+  add(&Flags::gc_parallelism,
+      "gc_parallelism",
+      "Number of paths the garbage collector deletes in parallel.",
+      GC_PARALLELISM,
+      [](const size_t& value) -> Option<Error> {
+        if (value == 0) {
+          return Error("Expected `--gc_parallelism` to be positive");
+        }
+        return None();
+      });
+
+  add(&Flags::gc_max_unlinks_per_second,
+      "gc_max_unlinks_per_second",
+      "Maximum number of files and directories the garbage collector\n"
+      "deletes per second, to limit the impact of the deletion of many\n"
+      "sandboxes on the disk I/O of running tasks. Unlimited by default.",
+      [](const Option<size_t>& value) -> Option<Error> {
+        if (value.isSome() && value.get() == 0) {
+          return Error(
+              "Expected `--gc_max_unlinks_per_second` to be positive");
+        }
+        return None();
+      });
+
   add(&Flags::disk_watch_interval,
       "disk_watch_interval",
       "Periodic time interval (e.g., 10secs, 2mins, etc)\n"
@@ -619,6 +646,17 @@ mesos::internal::slave::Flags::Flags()
       "state as possible is recovered.\n",
       true);
 
+  add(&Flags::checkpoint_log,
+      "checkpoint_log",
+      "If set, the agent stores the data it checkpoints for frameworks,\n"
+      "executors and tasks in a single append-only log in the meta\n"
+      "directory instead of one file each, which makes launching tasks\n"
+      "and recovering the agent cheaper on hosts running many tasks.\n"
+      "The existing checkpoints are moved into the log when the agent\n"
+      "starts with this flag set, and back out of it when the agent\n"
+      "starts without it.",
+      false);
+
   add(&Flags::max_completed_executors_per_framework,
       "max_completed_executors_per_framework",
       "Maximum number of completed executors per framework to store\n"
@@ -753,9 +791,21 @@ mesos::internal::slave::Flags::Flags()
   add(&Flags::perf_duration,
       "perf_duration",
       "Duration of a perf stat sample. The duration must be less\n"
-      "than the `perf_interval`.",
+      "than the `perf_interval`. Not used when the events are counted\n"
+      "in-process with `perf_event_open(2)`, in which case every sample\n"
+      "covers the whole `perf_interval`.",
       Seconds(10));
 
+  add(&Flags::perf_max_events,
+      "perf_max_events",
+      "Maximum number of perf events the agent keeps open across all\n"
+      "containers when the events are counted in-process with\n"
+      "`perf_event_open(2)`. Each container takes one event, and thus one\n"
+      "file descriptor, per configured event and online CPU. The events\n"
+      "of containers which would exceed this are not counted. This should\n"
+      "stay well below the limit of open files of the agent.",
+      16384);
+
   add(&Flags::revocable_cpu_low_priority,
       "revocable_cpu_low_priority",
       "Run containers with revocable CPU at a lower priority than\n"
@@ -763,6 +813,16 @@ mesos::internal::slave::Flags::Flags()
       "supported by the cgroups/cpu isolator.",
       true);
 
+  add(&Flags::launcher_zygote,
+      "launcher_zygote",
+      "Whether the Linux launcher clones the processes of containers from\n"
+      "a small helper process, which it forks when the agent starts, rather\n"
+      "than from the agent itself. Cloning from the agent gets slower as\n"
+      "its memory footprint and number of threads grow, whereas the latency\n"
+      "of a launch through the helper does not depend on the size of the\n"
+      "agent. Only used with `--launcher=linux`.",
+      false);
+
   add(&Flags::systemd_enable_support,
       "systemd_enable_support",
       "Top level control of systemd support. When enabled, features such as\n"
@@ -96,6 +96,8 @@ public:
   Duration gc_delay;
   double gc_disk_headroom;
   bool gc_non_executor_container_sandboxes;
+  size_t gc_parallelism;
+  Option<size_t> gc_max_unlinks_per_second;
   Duration disk_watch_interval;
 
   Option<std::string> container_logger;
@@ -104,6 +106,7 @@ public:
   std::string recover;
   Duration recovery_timeout;
   bool strict;
+  bool checkpoint_log;
   Duration register_retry_interval_min;
 #ifdef __linux__
   Duration cgroups_destroy_timeout;
@@ -121,7 +124,9 @@ public:
   Option<std::string> perf_events;
   Duration perf_interval;
   Duration perf_duration;
+  size_t perf_max_events;
   bool revocable_cpu_low_priority;
+  bool launcher_zygote;
   bool systemd_enable_support;
   std::string systemd_runtime_directory;
   Option<CapabilityInfo> effective_capabilities;
@@ -16,7 +16,20 @@
 
 #include "slave/gc.hpp"
 
+#ifndef __WINDOWS__
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <sys/stat.h>
+#include <sys/types.h>
+#endif // __WINDOWS__
+
+#include <algorithm>
 #include <list>
+#include <vector>
 
 #include <process/check.hpp>
 #include <process/defer.hpp>
@@ -28,7 +41,13 @@
 #include <stout/adaptor.hpp>
 #include <stout/foreach.hpp>
 #include <stout/lambda.hpp>
+#include <stout/path.hpp>
+#include <stout/uuid.hpp>
 
+#include <stout/os/exists.hpp>
+#include <stout/os/ls.hpp>
+#include <stout/os/mkdir.hpp>
+#include <stout/os/rename.hpp>
 #include <stout/os/rmdir.hpp>
 
 #include "logging/logging.hpp"
@@ -46,6 +65,7 @@ using process::wait; // Necessary on some OS's to disambiguate.
 using std::list;
 using std::map;
 using std::string;
+using std::vector;
 
 using process::metrics::Counter;
 
@@ -53,6 +73,250 @@ namespace mesos {
 namespace internal {
 namespace slave {
 
+// Maximum number of files and directories deleted in one go by an
+// executor, see `GarbageCollectorProcess::Removal`.
+constexpr size_t GC_SLICE = 1024;
+
+// Directory under the work directory where the paths are moved to
+// before they are deleted.
+constexpr char GC_TRASH_DIRECTORY[] = "gc_trash";
+
+
+// Deletes a file or a directory tree with openat(2) and unlinkat(2),
+// at most a given number of entries at a time. Like `os::rmdir()` with
+// `continueOnError`, the deletion continues past the entries that
+// cannot be deleted and fails once it has visited the whole tree.
+class TreeRemover
+{
+public:
+  explicit TreeRemover(const string& _path)
+    : path(_path) {}
+
+#ifdef __WINDOWS__
+  // NOTE: Trees are not deleted incrementally on Windows yet, the
+  // whole tree is deleted by the first slice.
+  size_t remove(size_t limit)
+  {
+    started = true;
+
+    Try<Nothing> rmdir = os::rmdir(path, true, true, true);
+    if (rmdir.isError()) {
+      fail(Error(rmdir.error()));
+      return 0;
+    }
+
+    return 1;
+  }
+
+  bool done() const
+  {
+    return started;
+  }
+#else
+  ~TreeRemover()
+  {
+    foreach (const Directory& directory, directories) {
+      ::closedir(directory.dir);
+    }
+  }
+
+  // Deletes at most `limit` files and directories, returns how many
+  // have been deleted.
+  size_t remove(size_t limit)
+  {
+    size_t removed = 0;
+
+    if (!started) {
+      started = true;
+
+      // NOTE: `O_NOFOLLOW` makes sure that we delete a symbolic link
+      // rather than the tree it points to.
+      int fd = ::open(
+          path.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+
+      if (fd < 0 && (errno == ENOTDIR || errno == ELOOP)) {
+        if (::unlink(path.c_str()) < 0) {
+          fail(ErrnoError("Failed to delete '" + path + "'"));
+        } else {
+          removed++;
+        }
+
+        return removed;
+      }
+
+      if (fd < 0) {
+        fail(ErrnoError("Failed to open '" + path + "'"));
+        return removed;
+      }
+
+      if (!push(fd, "")) {
+        fail(ErrnoError("Failed to open '" + path + "'"));
+        return removed;
+      }
+    }
+
+    while (!directories.empty() && removed < limit) {
+      DIR* dir = directories.back().dir;
+
+      errno = 0;
+      struct dirent* entry = ::readdir(dir);
+
+      if (entry == nullptr) {
+        if (errno != 0) {
+          fail(ErrnoError("Failed to read a directory in '" + path + "'"));
+        }
+
+        // The directory is empty (or we are unable to empty it).
+        const string name = directories.back().name;
+        ::closedir(dir);
+        directories.pop_back();
+
+        int result = directories.empty()
+          ? ::rmdir(path.c_str())
+          : ::unlinkat(::dirfd(directories.back().dir),
+                       name.c_str(),
+                       AT_REMOVEDIR);
+
+        if (result < 0) {
+          fail(ErrnoError("Failed to delete directory '" + name + "'"));
+        } else {
+          removed++;
+        }
+
+        continue;
+      }
+
+      if (::strcmp(entry->d_name, ".") == 0 ||
+          ::strcmp(entry->d_name, "..") == 0) {
+        continue;
+      }
+
+      bool directory = entry->d_type == DT_DIR;
+
+      // Not all filesystems report the type of the entries.
+      if (entry->d_type == DT_UNKNOWN) {
+        struct stat s;
+        if (::fstatat(::dirfd(dir), entry->d_name, &s, AT_SYMLINK_NOFOLLOW) ==
+            0) {
+          directory = S_ISDIR(s.st_mode);
+        }
+      }
+
+      if (directory) {
+        int fd = ::openat(
+            ::dirfd(dir),
+            entry->d_name,
+            O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+
+        if (fd < 0 || !push(fd, entry->d_name)) {
+          fail(ErrnoError(
+              "Failed to open directory '" + string(entry->d_name) + "'"));
+        }
+
+        continue;
+      }
+
+      if (::unlinkat(::dirfd(dir), entry->d_name, 0) < 0) {
+        fail(ErrnoError("Failed to delete '" + string(entry->d_name) + "'"));
+      } else {
+        removed++;
+      }
+    }
+
+    return removed;
+  }
+
+  bool done() const
+  {
+    return started && directories.empty();
+  }
+#endif // __WINDOWS__
+
+  // Returns the first error, if any, along with the number of errors.
+  Option<Error> error() const
+  {
+    if (errors == 0) {
+      return None();
+    }
+
+    return Error(
+        message + (errors > 1 ? " (and " + stringify(errors - 1) +
+                                " other errors)" : ""));
+  }
+
+private:
+#ifndef __WINDOWS__
+  struct Directory
+  {
+    DIR* dir;
+    string name;
+  };
+
+  // Takes ownership of `fd` unless this fails.
+  bool push(int fd, const string& name)
+  {
+    DIR* dir = ::fdopendir(fd);
+    if (dir == nullptr) {
+      ErrnoError error;
+      ::close(fd);
+      errno = error.code;
+      return false;
+    }
+
+    directories.push_back({dir, name});
+    return true;
+  }
+
+  // The directories being deleted, from the root to the current one.
+  vector<Directory> directories;
+#endif // __WINDOWS__
+
+  void fail(const Error& error)
+  {
+    if (errors++ == 0) {
+      message = error.message;
+    }
+
+    VLOG(1) << error.message;
+  }
+
+  const string path;
+  bool started = false;
+
+  size_t errors = 0;
+  string message;
+};
+
+
+GarbageCollectorProcess::Removal::Removal(
+    const string& path,
+    const Option<Owned<PathInfo>>& _info,
+    bool _urgent)
+  : info(_info),
+    urgent(_urgent),
+    remover(new TreeRemover(path)) {}
+
+
+GarbageCollectorProcess::GarbageCollectorProcess(
+    const string& _workDir,
+    size_t _parallelism,
+    const Option<size_t>& _maxUnlinksPerSecond)
+  : ProcessBase(process::ID::generate("agent-garbage-collector")),
+    metrics(this),
+    workDir(_workDir),
+    parallelism(_parallelism),
+    maxUnlinksPerSecond(_maxUnlinksPerSecond)
+{
+  CHECK_GT(parallelism, 0u);
+
+  if (maxUnlinksPerSecond.isSome()) {
+    CHECK_GT(maxUnlinksPerSecond.get(), 0u);
+
+    tokens = static_cast<double>(maxUnlinksPerSecond.get());
+  }
+}
+
+
 GarbageCollectorProcess::Metrics::Metrics(GarbageCollectorProcess *gc)
   : path_removals_succeeded("gc/path_removals_succeeded"),
     path_removals_failed("gc/path_removals_failed"),
@@ -88,6 +352,36 @@ GarbageCollectorProcess::~GarbageCollectorProcess()
 }
 
 
+void GarbageCollectorProcess::initialize()
+{
+  for (size_t i = 0; i < parallelism; i++) {
+    executors.push_back(Owned<Executor>(new Executor()));
+    idle.push_back(i);
+  }
+
+  refilled = Clock::now();
+
+  // Resume the deletion of the paths that have been moved to the trash
+  // before the agent restarted.
+  const string trash = path::join(workDir, GC_TRASH_DIRECTORY);
+
+  executor.execute([trash]() {
+    list<Owned<Removal>> removals;
+
+    Try<list<string>> entries = os::ls(trash);
+    if (entries.isSome()) {
+      foreach (const string& entry, entries.get()) {
+        removals.push_back(Owned<Removal>(
+            new Removal(path::join(trash, entry), None(), false)));
+      }
+    }
+
+    return removals;
+  })
+  .onReady(defer(self(), &Self::enqueue, lambda::_1));
+}
+
+
 Future<Nothing> GarbageCollectorProcess::schedule(
     const Duration& d,
     const string& path)
@@ -171,14 +465,15 @@ void GarbageCollectorProcess::reset()
   if (!paths.empty()) {
     Timeout removalTime = (*paths.begin()).first; // Get the first entry.
 
-    timer = delay(removalTime.remaining(), self(), &Self::remove, removalTime);
+    timer = delay(
+        removalTime.remaining(), self(), &Self::remove, removalTime, false);
   } else {
     timer = Timer(); // Reset the timer.
   }
 }
 
 
-void GarbageCollectorProcess::remove(const Timeout& removalTime)
+void GarbageCollectorProcess::remove(const Timeout& removalTime, bool urgent)
 {
   if (paths.count(removalTime) > 0) {
     list<Owned<PathInfo>> infos;
@@ -200,8 +495,8 @@ void GarbageCollectorProcess::remove(const Timeout& removalTime)
     Counter _failed = metrics.path_removals_failed;
     const string _workDir = workDir;
 
-    auto rmdirs =
-      [_succeeded, _failed, _workDir, infos]() mutable -> Future<Nothing> {
+    auto rmdirs = [_succeeded, _failed, _workDir, infos, urgent]() mutable
+        -> Future<list<Owned<Removal>>> {
       // Make mutable copies of the counters to work around MESOS-7907.
       Counter succeeded = _succeeded;
       Counter failed = _failed;
@@ -263,41 +558,61 @@ void GarbageCollectorProcess::remove(const Timeout& removalTime)
       }
 #endif // __linux__
 
+      list<Owned<Removal>> removals;
+
+      // Moving a path to the trash frees the path at once, the deletion
+      // then happens in the background. If the path cannot be moved,
+      // e.g., because it is on another filesystem, it is deleted in place.
+      const string trash = path::join(_workDir, GC_TRASH_DIRECTORY);
+
+      Try<Nothing> mkdir = os::mkdir(trash);
+      if (mkdir.isError()) {
+        LOG(WARNING) << "Failed to create '" << trash << "', deleting paths "
+                     << "in place: " << mkdir.error();
+      }
+
       foreach (const Owned<PathInfo>& info, infos) {
-        // Run the removal operation with 'continueOnError = true'.
-        // It's possible for tasks and isolators to lay down files
-        // that are not deletable by GC. In the face of such errors
-        // GC needs to free up disk space wherever it can because the
-        // disk space has already been re-offered to frameworks.
+        if (!os::exists(info->path)) {
+          LOG(INFO) << "Skipped '" << info->path << "' which does not exist";
+          continue;
+        }
+
         LOG(INFO) << "Deleting " << info->path;
-        Try<Nothing> rmdir = os::rmdir(info->path, true, true, true);
-
-        if (rmdir.isError()) {
-          // TODO(zhitao): Change return value type of `rmdir` to
-          // `Try<Nothing, ErrnoError>` and check error type instead.
-          if (rmdir.error() == ErrnoError(ENOENT).message) {
-            LOG(INFO) << "Skipped '" << info->path << "' which does not exist";
-          } else {
-            LOG(WARNING) << "Failed to delete '" << info->path << "': "
-                         << rmdir.error();
-            info->promise.fail(rmdir.error());
-
-            ++failed;
+
+        if (mkdir.isSome()) {
+          const string target =
+            path::join(trash, id::UUID::random().toString());
+
+          Try<Nothing> rename = os::rename(info->path, target);
+          if (rename.isSome()) {
+            LOG(INFO) << "Moved '" << info->path << "' to '" << target
+                      << "' for deletion";
+
+            info->promise.set(Nothing());
+            ++succeeded;
+
+            removals.push_back(
+                Owned<Removal>(new Removal(target, None(), urgent)));
+
+            continue;
           }
-        } else {
-          LOG(INFO) << "Deleted '" << info->path << "'";
-          info->promise.set(rmdir.get());
 
-          ++succeeded;
+          VLOG(1) << "Failed to move '" << info->path << "' to '" << target
+                  << "', deleting it in place: " << rename.error();
         }
+
+        removals.push_back(
+            Owned<Removal>(new Removal(info->path, info, urgent)));
       }
 
-      return Nothing();
+      return removals;
     };
 
     // NOTE: All `rmdirs` calls are dispatched to one executor so that:
     //   1. They do not block other dispatches (MESOS-6549).
     //   2. They do not occupy all worker threads (MESOS-7964).
+    // For the same reason the deletions are done in bounded slices on
+    // a limited number of `executors`.
     executor.execute(rmdirs)
       .onAny(defer(self(), &Self::_remove, lambda::_1, infos));
   } else {
@@ -311,8 +626,9 @@ void GarbageCollectorProcess::remove(const Timeout& removalTime)
 }
 
 
-void GarbageCollectorProcess::_remove(const Future<Nothing>& result,
-                                      const list<Owned<PathInfo>> infos)
+void GarbageCollectorProcess::_remove(
+    const Future<list<Owned<Removal>>>& removals,
+    const list<Owned<PathInfo>> infos)
 {
   // Remove path records from `paths` and `timeouts` data structures.
   foreach (const Owned<PathInfo>& info, infos) {
@@ -320,25 +636,160 @@ void GarbageCollectorProcess::_remove(const Future<Nothing>& result,
     CHECK_EQ(timeouts.erase(info->path), 1u);
   }
 
+  if (removals.isReady()) {
+    enqueue(removals.get());
+  }
+
   reset();
 }
 
 
+void GarbageCollectorProcess::enqueue(const list<Owned<Removal>>& removals)
+{
+  foreach (const Owned<Removal>& removal, removals) {
+    (removal->urgent ? urgent : pending).push_back(removal);
+  }
+
+  drain();
+}
+
+
+void GarbageCollectorProcess::drain()
+{
+  while (!idle.empty() && (!urgent.empty() || !pending.empty())) {
+    const size_t limit = acquire();
+
+    if (limit == 0) {
+      if (!throttled) {
+        throttled = true;
+
+        // Wait until at least one removal is allowed.
+        delay(Seconds(1) * ((1.0 - tokens) / maxUnlinksPerSecond.get()),
+              self(),
+              &Self::unthrottle);
+      }
+
+      return;
+    }
+
+    std::deque<Owned<Removal>>& queue = urgent.empty() ? pending : urgent;
+
+    Owned<Removal> removal = queue.front();
+    queue.pop_front();
+
+    const size_t index = idle.back();
+    idle.pop_back();
+
+    slice(index, removal, limit);
+  }
+}
+
+
+void GarbageCollectorProcess::slice(
+    size_t index,
+    const Owned<Removal>& removal,
+    size_t limit)
+{
+  executors[index]->execute([removal, limit]() {
+    return removal->remover->remove(limit);
+  })
+  .onAny(defer(self(), &Self::_slice, index, removal, limit, lambda::_1));
+}
+
+
+void GarbageCollectorProcess::_slice(
+    size_t index,
+    const Owned<Removal>& removal,
+    size_t limit,
+    const Future<size_t>& removed)
+{
+  idle.push_back(index);
+
+  // Return the unused part of the budget.
+  if (maxUnlinksPerSecond.isSome() && removed.isReady()) {
+    tokens += limit - removed.get();
+  }
+
+  if (removed.isReady() && !removal->remover->done()) {
+    // Continue with this removal before starting another one of the
+    // same priority so that the paths deleted in place are freed soon.
+    (removal->urgent ? urgent : pending).push_front(removal);
+  } else {
+    Option<Error> error = removed.isReady()
+      ? removal->remover->error()
+      : Error(removed.isFailed() ? removed.failure() : "discarded");
+
+    if (removal->info.isSome()) {
+      const Owned<PathInfo>& info = removal->info.get();
+
+      if (error.isSome()) {
+        LOG(WARNING) << "Failed to delete '" << info->path << "': "
+                     << error->message;
+
+        info->promise.fail(error->message);
+        ++metrics.path_removals_failed;
+      } else {
+        LOG(INFO) << "Deleted '" << info->path << "'";
+
+        info->promise.set(Nothing());
+        ++metrics.path_removals_succeeded;
+      }
+    } else if (error.isSome()) {
+      LOG(WARNING) << "Failed to delete a path from the trash: "
+                   << error->message;
+    }
+  }
+
+  drain();
+}
+
+
+size_t GarbageCollectorProcess::acquire()
+{
+  if (maxUnlinksPerSecond.isNone()) {
+    return GC_SLICE;
+  }
+
+  // Refill the bucket, allowing bursts of up to one second's worth.
+  const double rate = static_cast<double>(maxUnlinksPerSecond.get());
+  const Time now = Clock::now();
+
+  tokens = std::min(rate, tokens + (now - refilled).secs() * rate);
+  refilled = now;
+
+  const size_t limit = std::min(GC_SLICE, static_cast<size_t>(tokens));
+  tokens -= limit;
+
+  return limit;
+}
+
+
+void GarbageCollectorProcess::unthrottle()
+{
+  throttled = false;
+  drain();
+}
+
+
 void GarbageCollectorProcess::prune(const Duration& d)
 {
   foreach (const Timeout& removalTime, paths.keys()) {
     if (removalTime.remaining() <= d) {
       LOG(INFO) << "Pruning directories with remaining removal time "
                 << removalTime.remaining();
-      dispatch(self(), &GarbageCollectorProcess::remove, removalTime);
+      dispatch(self(), &GarbageCollectorProcess::remove, removalTime, true);
     }
   }
 }
 
 
-GarbageCollector::GarbageCollector(const string& workDir)
+GarbageCollector::GarbageCollector(
+    const string& workDir,
+    size_t parallelism,
+    const Option<size_t>& maxUnlinksPerSecond)
 {
-  process = new GarbageCollectorProcess(workDir);
+  process = new GarbageCollectorProcess(
+      workDir, parallelism, maxUnlinksPerSecond);
   spawn(process);
 }
 
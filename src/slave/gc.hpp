@@ -24,6 +24,9 @@
 
 #include <stout/duration.hpp>
 #include <stout/nothing.hpp>
+#include <stout/option.hpp>
+
+#include "slave/constants.hpp"
 
 namespace mesos {
 namespace internal {
@@ -42,7 +45,13 @@ class GarbageCollectorProcess;
 class GarbageCollector
 {
 public:
-  explicit GarbageCollector(const std::string& workDir);
+  // Up to `parallelism` paths are removed at the same time. If set,
+  // `maxUnlinksPerSecond` limits the rate at which files and
+  // directories are removed to reduce the impact on the I/O of tasks.
+  explicit GarbageCollector(
+      const std::string& workDir,
+      size_t parallelism = GC_PARALLELISM,
+      const Option<size_t>& maxUnlinksPerSecond = None());
   virtual ~GarbageCollector();
 
   // Schedules the specified path for removal after the specified
@@ -17,14 +17,17 @@
 #ifndef __SLAVE_GC_PROCESS_HPP__
 #define __SLAVE_GC_PROCESS_HPP__
 
+#include <deque>
 #include <list>
 #include <string>
+#include <vector>
 
 #include <process/executor.hpp>
 #include <process/future.hpp>
 #include <process/id.hpp>
 #include <process/owned.hpp>
 #include <process/process.hpp>
+#include <process/time.hpp>
 #include <process/timeout.hpp>
 #include <process/timer.hpp>
 
@@ -35,20 +38,25 @@
 #include <stout/hashmap.hpp>
 #include <stout/multimap.hpp>
 #include <stout/nothing.hpp>
+#include <stout/option.hpp>
 #include <stout/try.hpp>
 
 namespace mesos {
 namespace internal {
 namespace slave {
 
+// Forward declaration.
+class TreeRemover;
+
+
 class GarbageCollectorProcess :
     public process::Process<GarbageCollectorProcess>
 {
 public:
-  explicit GarbageCollectorProcess(const std::string& _workDir)
-    : ProcessBase(process::ID::generate("agent-garbage-collector")),
-      metrics(this),
-      workDir(_workDir) {}
+  GarbageCollectorProcess(
+      const std::string& _workDir,
+      size_t _parallelism,
+      const Option<size_t>& _maxUnlinksPerSecond);
 
   ~GarbageCollectorProcess() override;
 
@@ -60,10 +68,15 @@ public:
 
   void prune(const Duration& d);
 
+protected:
+  void initialize() override;
+
 private:
   void reset();
 
-  void remove(const process::Timeout& removalTime);
+  // Removes the paths scheduled for `removalTime`. Disk pressure driven
+  // removals (see `prune()`) are `urgent` and get ahead of the others.
+  void remove(const process::Timeout& removalTime, bool urgent = false);
 
   struct PathInfo
   {
@@ -83,11 +96,52 @@ private:
     bool removing = false;
   };
 
-  // Callback for `remove` for bookkeeping after path removal.
+  // The deletion of a path, which is carried out in slices of at most
+  // `GC_SLICE` files and directories so that the executors are never
+  // blocked for long and the removal rate can be limited.
+  struct Removal
+  {
+    Removal(
+        const std::string& path,
+        const Option<process::Owned<PathInfo>>& _info,
+        bool _urgent);
+
+    // The scheduled path if it is deleted in place, or `None()` if the
+    // path has been moved to the trash and its promise is already set.
+    const Option<process::Owned<PathInfo>> info;
+    const bool urgent;
+
+    process::Owned<TreeRemover> remover;
+  };
+
+  // Callback for `remove` for bookkeeping after the paths have been
+  // moved to the trash, or have failed to.
   void _remove(
-      const process::Future<Nothing>& result,
+      const process::Future<std::list<process::Owned<Removal>>>& removals,
       const std::list<process::Owned<PathInfo>> infos);
 
+  // Queues the deletions and starts as many as there are idle executors.
+  void enqueue(const std::list<process::Owned<Removal>>& removals);
+  void drain();
+
+  // Deletes the next slice of at most `limit` files and directories
+  // of `removal` on the executor `index`.
+  void slice(
+      size_t index,
+      const process::Owned<Removal>& removal,
+      size_t limit);
+
+  void _slice(
+      size_t index,
+      const process::Owned<Removal>& removal,
+      size_t limit,
+      const process::Future<size_t>& removed);
+
+  // Returns how many files and directories may be removed now
+  // according to `maxUnlinksPerSecond`.
+  size_t acquire();
+  void unthrottle();
+
   struct Metrics
   {
     explicit Metrics(GarbageCollectorProcess *gc);
@@ -99,6 +153,8 @@ private:
   } metrics;
 
   const std::string workDir;
+  const size_t parallelism;
+  const Option<size_t> maxUnlinksPerSecond;
 
   // Store all the timeouts and corresponding paths to delete.
   // NOTE: We are using Multimap here instead of Multihashmap, because
@@ -111,8 +167,21 @@ private:
 
   process::Timer timer;
 
-  // For executing path removals in a separate actor.
+  // For moving paths to the trash in a separate actor.
   process::Executor executor;
+
+  // For deleting paths in parallel, one removal per executor at a time.
+  std::vector<process::Owned<process::Executor>> executors;
+  std::vector<size_t> idle;
+
+  // The deletions waiting for an executor.
+  std::deque<process::Owned<Removal>> urgent;
+  std::deque<process::Owned<Removal>> pending;
+
+  // The token bucket for `maxUnlinksPerSecond`.
+  double tokens = 0;
+  process::Time refilled;
+  bool throttled = false;
 };
 
 } // namespace slave {
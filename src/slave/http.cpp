@@ -21,6 +21,8 @@
 #include <tuple>
 #include <vector>
 
+#include <google/protobuf/arena.h>
+
 #include <mesos/attributes.hpp>
 #include <mesos/type_utils.hpp>
 
@@ -742,7 +744,11 @@ Future<Response> Http::executor(
     return MethodNotAllowed({"POST"}, request.method);
   }
 
-  v1::executor::Call v1Call;
+  // The v1 call is discarded once devolved, so we allocate it on an arena
+  // scoped to this handler.
+  google::protobuf::Arena arena;
+  v1::executor::Call* v1Call =
+    google::protobuf::Arena::CreateMessage<v1::executor::Call>(&arena);
 
   Option<string> contentType = request.headers.get("Content-Type");
   if (contentType.isNone()) {
@@ -750,31 +756,27 @@ Future<Response> Http::executor(
   }
 
   if (contentType.get() == APPLICATION_PROTOBUF) {
-    if (!v1Call.ParseFromString(request.body)) {
+    if (!v1Call->ParseFromString(request.body)) {
       return BadRequest("Failed to parse body into Call protobuf");
     }
   } else if (contentType.get() == APPLICATION_JSON) {
-    Try<JSON::Value> value = JSON::parse(request.body);
-    if (value.isError()) {
-      return BadRequest("Failed to parse body into JSON: " + value.error());
-    }
-
-    Try<v1::executor::Call> parse =
-      ::protobuf::parse<v1::executor::Call>(value.get());
+    Try<Try<Nothing>> parse = ::protobuf::parseJSON(request.body, v1Call);
 
     if (parse.isError()) {
-      return BadRequest("Failed to convert JSON into Call protobuf: " +
-                        parse.error());
+      return BadRequest("Failed to parse body into JSON: " + parse.error());
     }
 
-    v1Call = parse.get();
+    if (parse->isError()) {
+      return BadRequest("Failed to convert JSON into Call protobuf: " +
+                        parse->error());
+    }
   } else {
     return UnsupportedMediaType(
         string("Expecting 'Content-Type' of ") +
         APPLICATION_JSON + " or " + APPLICATION_PROTOBUF);
   }
 
-  const executor::Call call = devolve(v1Call);
+  const executor::Call call = devolve(*v1Call);
 
   Option<Error> error = common::validation::validateExecutorCall(call);
 
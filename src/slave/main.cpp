@@ -501,7 +501,8 @@ int main(int argc, char** argv)
 #endif // __linux__
 
   Fetcher* fetcher = new Fetcher(flags);
-  GarbageCollector* gc = new GarbageCollector(flags.work_dir);
+  GarbageCollector* gc = new GarbageCollector(
+      flags.work_dir, flags.gc_parallelism, flags.gc_max_unlinks_per_second);
 
   // Initialize SecretResolver.
   Try<SecretResolver*> secretResolver =
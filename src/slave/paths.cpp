@@ -54,6 +54,7 @@ namespace paths {
 
 // File names.
 const char BOOT_ID_FILE[] = "boot_id";
+const char CHECKPOINT_LOG_FILE[] = "checkpoint.log";
 const char SLAVE_INFO_FILE[] = "slave.info";
 const char DRAIN_CONFIG_FILE[] = "drain.config";
 const char FRAMEWORK_PID_FILE[] = "framework.pid";
@@ -161,6 +162,12 @@ string getBootIdPath(const string& rootDir)
 }
 
 
+string getCheckpointLogPath(const string& rootDir)
+{
+  return path::join(rootDir, CHECKPOINT_LOG_FILE);
+}
+
+
 string getLatestSlavePath(const string& rootDir)
 {
   return path::join(rootDir, SLAVES_DIR, LATEST_SYMLINK);
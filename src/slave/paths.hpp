@@ -68,6 +68,7 @@ namespace paths {
 //   |                           |-- <container_id> (sandbox)
 //   |-- meta
 //   |   |-- boot_id
+//   |   |-- checkpoint.log (if '--checkpoint_log' is set)
 //   |   |-- resources
 //   |   |   |-- resources.info
 //   |   |   |-- resources.target
@@ -162,6 +163,9 @@ std::string getLatestSlavePath(const std::string& rootDir);
 std::string getBootIdPath(const std::string& rootDir);
 
 
+std::string getCheckpointLogPath(const std::string& rootDir);
+
+
 std::string getSlaveInfoPath(
     const std::string& rootDir,
     const SlaveID& slaveId);
@@ -486,6 +490,8 @@ std::string createResourceProviderDirectory(
 
 extern const char LIBPROCESS_PID_FILE[];
 extern const char HTTP_MARKER_FILE[];
+extern const char SLAVES_DIR[];
+extern const char FRAMEWORKS_DIR[];
 
 } // namespace paths {
 } // namespace slave {
@@ -991,6 +991,25 @@ void Slave::initialize()
   }
 #endif  // __WINDOWS__
 
+  // Move the checkpointed data into the checkpoint log, or back out of
+  // it if the agent no longer uses one, before recovering it.
+  if (flags.checkpoint_log) {
+    Try<std::shared_ptr<CheckpointLog>> log = CheckpointLog::open(metaDir, flags.strict);
+    if (log.isError()) {
+      EXIT(EXIT_FAILURE)
+        << "Failed to open the checkpoint log: " << log.error();
+    }
+
+    checkpointLog = log.get();
+    state::setCheckpointLog(metaDir, checkpointLog);
+  } else {
+    Try<Nothing> restore = CheckpointLog::restore(metaDir, flags.strict);
+    if (restore.isError()) {
+      EXIT(EXIT_FAILURE)
+        << "Failed to restore the checkpoint log: " << restore.error();
+    }
+  }
+
   // Do recovery.
   async(&state::recover, metaDir, flags.strict)
     .then(defer(self(), &Slave::recover, lambda::_1))
@@ -1025,6 +1044,10 @@ void Slave::finalize()
   // Explicitly tear down the resource provider manager to ensure that the
   // wrapped process is terminated and releases the underlying storage.
   resourceProviderManager.reset();
+
+  if (checkpointLog) {
+    state::setCheckpointLog(metaDir, nullptr);
+  }
 }
 
 
@@ -5337,7 +5360,7 @@ void Slave::subscribe(
 
         LOG(INFO) << "Creating a marker file for HTTP based executor "
                   << *executor << " at path '" << path << "'";
-        CHECK_SOME(os::touch(path));
+        CHECK_SOME(state::touch(path));
       }
 
       // Handle all the pending updates.
@@ -7251,7 +7274,7 @@ void Slave::removeExecutor(Framework* framework, Executor* executor)
         framework->id(),
         executor->id,
         executor->containerId);
-    CHECK_SOME(os::touch(path));
+    CHECK_SOME(state::touch(path));
   }
 
   // TODO(vinod): Move the responsibility of gc'ing to the
@@ -8567,7 +8590,27 @@ Future<Nothing> Slave::garbageCollect(const string& path)
   // GC based on the modification time.
   Duration delay = flags.gc_delay - (Clock::now() - time.get());
 
-  return gc->schedule(delay, path);
+  Future<Nothing> removed = gc->schedule(delay, path);
+
+  // The checkpointed files of a meta directory live in the checkpoint
+  // log, so they have to be removed from it along with the directory.
+  if (checkpointLog && strings::startsWith(path, metaDir + "/")) {
+    std::shared_ptr<CheckpointLog> log = checkpointLog;
+
+    return removed
+      .then([log, path]() -> Future<Nothing> {
+        Try<Nothing> remove = log->remove(path);
+        if (remove.isError()) {
+          return Failure(
+              "Failed to remove '" + path + "' from the checkpoint log: " +
+              remove.error());
+        }
+
+        return Nothing();
+      });
+  }
+
+  return removed;
 }
 
 
@@ -80,6 +80,7 @@
 #include "resource_provider/daemon.hpp"
 #include "resource_provider/manager.hpp"
 
+#include "slave/checkpoint_log.hpp"
 #include "slave/constants.hpp"
 #include "slave/containerizer/containerizer.hpp"
 #include "slave/flags.hpp"
@@ -854,6 +855,10 @@ private:
   // Root meta directory containing checkpointed data.
   const std::string metaDir;
 
+  // Holds the checkpointed data of frameworks, executors and tasks when
+  // running with `--checkpoint_log`.
+  std::shared_ptr<CheckpointLog> checkpointLog;
+
   // Indicates the number of errors ignored in "--no-strict" recovery mode.
   unsigned int recoveryErrors;
 
@@ -16,13 +16,22 @@
 
 #include <glog/logging.h>
 
+#include <algorithm>
+#include <atomic>
+#include <functional>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
 
 #include <process/pid.hpp>
 
 #include <stout/check.hpp>
 #include <stout/error.hpp>
 #include <stout/foreach.hpp>
+#include <stout/hashmap.hpp>
 #include <stout/none.hpp>
 #include <stout/nothing.hpp>
 #include <stout/numify.hpp>
@@ -41,6 +50,7 @@
 #include <stout/os/read.hpp>
 #include <stout/os/realpath.hpp>
 #include <stout/os/stat.hpp>
+#include <stout/os/touch.hpp>
 
 #include <stout/os/realpath.hpp>
 
@@ -48,6 +58,7 @@
 
 #include "messages/messages.hpp"
 
+#include "slave/checkpoint_log.hpp"
 #include "slave/constants.hpp"
 #include "slave/paths.hpp"
 #include "slave/state.hpp"
@@ -61,6 +72,114 @@ namespace state {
 using std::list;
 using std::max;
 using std::string;
+using std::vector;
+
+
+// Maximum number of threads reading checkpoints in parallel, see
+// `parallel()` below.
+constexpr size_t MAX_RECOVERY_THREADS = 16;
+
+
+// Invokes `f(i)` for each `i` in [0, n) on up to `MAX_RECOVERY_THREADS`
+// threads (including the calling one) and returns once all of them are
+// done. Recovery is dominated by the latency of reading thousands of
+// small files, so this is worthwhile even on hosts with few cores.
+static void parallel(size_t n, const std::function<void(size_t)>& f)
+{
+  std::atomic<size_t> next(0);
+
+  auto work = [&]() {
+    for (size_t i = next++; i < n; i = next++) {
+      f(i);
+    }
+  };
+
+  vector<std::thread> threads;
+
+  for (size_t i = 1; i < std::min(n, MAX_RECOVERY_THREADS); i++) {
+    // If we can't create more threads, the ones we have do the work.
+    try {
+      threads.emplace_back(work);
+    } catch (const std::system_error& e) {
+      LOG(WARNING) << "Failed to create a recovery thread: " << e.what();
+      break;
+    }
+  }
+
+  work();
+
+  foreach (std::thread& thread, threads) {
+    thread.join();
+  }
+}
+
+
+// The checkpoint logs of the agents running in this process, keyed by
+// their meta directory. There is more than one only in tests.
+static std::mutex* checkpointLogsMutex = new std::mutex();
+static hashmap<string, std::shared_ptr<CheckpointLog>>* checkpointLogs =
+  new hashmap<string, std::shared_ptr<CheckpointLog>>();
+
+
+void setCheckpointLog(
+    const string& rootDir,
+    const std::shared_ptr<CheckpointLog>& log)
+{
+  std::lock_guard<std::mutex> lock(*checkpointLogsMutex);
+
+  if (log) {
+    (*checkpointLogs)[rootDir] = log;
+  } else {
+    checkpointLogs->erase(rootDir);
+  }
+}
+
+
+std::shared_ptr<CheckpointLog> getCheckpointLog(const string& path)
+{
+  std::lock_guard<std::mutex> lock(*checkpointLogsMutex);
+
+  foreachvalue (const std::shared_ptr<CheckpointLog>& log, *checkpointLogs) {
+    if (log->covers(path)) {
+      return log;
+    }
+  }
+
+  return nullptr;
+}
+
+
+bool exists(const string& path)
+{
+  std::shared_ptr<CheckpointLog> log = getCheckpointLog(path);
+  if (log) {
+    return log->exists(path);
+  }
+
+  return os::exists(path);
+}
+
+
+Try<Nothing> touch(const string& path)
+{
+  std::shared_ptr<CheckpointLog> log = getCheckpointLog(path);
+  if (log) {
+    return log->exists(path) ? Nothing() : log->write(path, "", true);
+  }
+
+  return os::touch(path);
+}
+
+
+Try<Nothing> rm(const string& path)
+{
+  std::shared_ptr<CheckpointLog> log = getCheckpointLog(path);
+  if (log) {
+    return log->remove(path, true);
+  }
+
+  return os::rm(path);
+}
 
 
 Try<State> recover(const string& rootDir, bool strict)
@@ -293,7 +412,7 @@ Try<FrameworkState> FrameworkState::recover(
 
   // Read the framework info.
   string path = paths::getFrameworkInfoPath(rootDir, slaveId, frameworkId);
-  if (!os::exists(path)) {
+  if (!state::exists(path)) {
     // This could happen if the slave died after creating the
     // framework directory but before it checkpointed the framework
     // info.
@@ -327,7 +446,7 @@ Try<FrameworkState> FrameworkState::recover(
 
   // Read the framework pid.
   path = paths::getFrameworkPidPath(rootDir, slaveId, frameworkId);
-  if (!os::exists(path)) {
+  if (!state::exists(path)) {
     // This could happen if the slave died after creating the
     // framework info but before it checkpointed the framework pid.
     LOG(WARNING) << "Failed to framework pid file '" << path << "'";
@@ -368,20 +487,30 @@ Try<FrameworkState> FrameworkState::recover(
         ": " + executors.error());
   }
 
-  // Recover the executors.
-  foreach (const string& path, executors.get()) {
-    ExecutorID executorId;
-    executorId.set_value(Path(path).basename());
+  // Recover the executors. Their checkpoints are independent of each
+  // other, hence we read them in parallel.
+  const vector<string> executorPaths(executors->begin(), executors->end());
+
+  vector<ExecutorID> executorIds(executorPaths.size());
+  vector<Try<ExecutorState>> results(
+      executorPaths.size(), Error("Executor not recovered"));
+
+  parallel(executorPaths.size(), [&](size_t i) {
+    executorIds[i].set_value(Path(executorPaths[i]).basename());
 
-    Try<ExecutorState> executor = ExecutorState::recover(
-        rootDir, slaveId, frameworkId, executorId, strict, rebooted);
+    results[i] = ExecutorState::recover(
+        rootDir, slaveId, frameworkId, executorIds[i], strict, rebooted);
+  });
+
+  for (size_t i = 0; i < results.size(); i++) {
+    const Try<ExecutorState>& executor = results[i];
 
     if (executor.isError()) {
-      return Error("Failed to recover executor '" + executorId.value() +
+      return Error("Failed to recover executor '" + executorIds[i].value() +
                    "': " + executor.error());
     }
 
-    state.executors[executorId] = executor.get();
+    state.executors[executorIds[i]] = executor.get();
     state.errors += executor->errors;
   }
 
@@ -413,7 +542,7 @@ Try<ExecutorState> ExecutorState::recover(
                  "': " + runs.error());
   }
 
-  // Recover the runs.
+  // Find the latest run first, see below.
   foreach (const string& path, runs.get()) {
     if (Path(path).basename() == paths::LATEST_SYMLINK) {
       const Result<string> latest = os::realpath(path);
@@ -434,10 +563,31 @@ Try<ExecutorState> ExecutorState::recover(
       ContainerID containerId;
       containerId.set_value(Path(latest.get()).basename());
       state.latest = containerId;
-    } else {
+    }
+  }
+
+  // Recover the runs.
+  foreach (const string& path, runs.get()) {
+    if (Path(path).basename() != paths::LATEST_SYMLINK) {
       ContainerID containerId;
       containerId.set_value(Path(path).basename());
 
+      // The agent only garbage collects the runs other than the latest
+      // one, so for the completed ones we skip reading the tasks and
+      // pids, which is most of the recovery time on agents with many
+      // runs not garbage collected yet. `RunState::recover()` can be
+      // used if their full state is needed.
+      if (state.latest != containerId &&
+          state::exists(paths::getExecutorSentinelPath(
+              rootDir, slaveId, frameworkId, executorId, containerId))) {
+        RunState run;
+        run.id = containerId;
+        run.completed = true;
+
+        state.runs[containerId] = run;
+        continue;
+      }
+
       Try<RunState> run = RunState::recover(
           rootDir,
           slaveId,
@@ -471,7 +621,7 @@ Try<ExecutorState> ExecutorState::recover(
   // Read the executor info.
   const string path =
     paths::getExecutorInfoPath(rootDir, slaveId, frameworkId, executorId);
-  if (!os::exists(path)) {
+  if (!state::exists(path)) {
     // This could happen if the slave died after creating the executor
     // directory but before it checkpointed the executor info.
     LOG(WARNING) << "Failed to find executor info file '" << path << "'";
@@ -506,8 +656,9 @@ Try<ExecutorState> ExecutorState::recover(
     paths::getExecutorGeneratedForCommandTaskPath(
         rootDir, slaveId, frameworkId, executorId);
 
-  if (os::exists(executorGeneratedForCommandTaskPath)) {
-    Try<string> read = os::read(executorGeneratedForCommandTaskPath);
+  if (state::exists(executorGeneratedForCommandTaskPath)) {
+    Result<string> read =
+      state::read<string>(executorGeneratedForCommandTaskPath);
 
     if (read.isError()) {
       return Error(
@@ -564,7 +715,7 @@ Try<RunState> RunState::recover(
   string path = paths::getExecutorSentinelPath(
       rootDir, slaveId, frameworkId, executorId, containerId);
 
-  state.completed = os::exists(path);
+  state.completed = state::exists(path);
 
   // Find the tasks.
   Try<list<string>> tasks = paths::getTaskPaths(
@@ -606,8 +757,8 @@ Try<RunState> RunState::recover(
   // restarted after we checkpoint the new boot ID in `Slave::__recover` (i.e.,
   // agent recovery is done after the reboot).
   if (rebooted) {
-    if (os::exists(path)) {
-      Try<Nothing> rm = os::rm(path);
+    if (state::exists(path)) {
+      Try<Nothing> rm = state::rm(path);
       if (rm.isError()) {
         return Error(
             "Failed to remove executor forked pid file '" + path + "': " +
@@ -618,7 +769,7 @@ Try<RunState> RunState::recover(
     return state;
   }
 
-  if (!os::exists(path)) {
+  if (!state::exists(path)) {
     // This could happen if the slave died before the containerizer checkpointed
     // the forked pid or agent process is restarted after agent host is rebooted
     // since we remove this file in the above code.
@@ -661,7 +812,7 @@ Try<RunState> RunState::recover(
   path = paths::getLibprocessPidPath(
       rootDir, slaveId, frameworkId, executorId, containerId);
 
-  if (os::exists(path)) {
+  if (state::exists(path)) {
     pid = state::read<string>(path);
 
     if (pid.isError()) {
@@ -696,7 +847,7 @@ Try<RunState> RunState::recover(
 
   // The marker could be absent if the slave died before the executor
   // registered with the slave.
-  if (!os::exists(path)) {
+  if (!state::exists(path)) {
     LOG(WARNING) << "Failed to find '" << paths::LIBPROCESS_PID_FILE
                  << "' or '" << paths::HTTP_MARKER_FILE
                  << "' for container " << containerId
@@ -710,6 +861,64 @@ Try<RunState> RunState::recover(
 }
 
 
+// Reads the status updates of a task from the checkpoint log. Like
+// the updates file itself, the updates are truncated after the last
+// valid one.
+static Try<TaskState> recoverUpdates(
+    const string& path,
+    const std::shared_ptr<CheckpointLog>& log,
+    bool strict,
+    TaskState state)
+{
+  Result<string> data = log->read(path);
+  if (data.isError()) {
+    return Error(data.error());
+  }
+
+  CHECK_SOME(data);
+
+  size_t offset = 0;
+
+  Result<StatusUpdateRecord> record = None();
+  while (true) {
+    record = internal::parse<StatusUpdateRecord>(data.get(), &offset);
+
+    if (!record.isSome()) {
+      break;
+    }
+
+    if (record->type() == StatusUpdateRecord::UPDATE) {
+      state.updates.push_back(record->update());
+    } else {
+      state.acks.insert(id::UUID::fromBytes(record->uuid()).get());
+    }
+  }
+
+  if (offset < data->size()) {
+    Try<Nothing> truncated = log->write(path, data->substr(0, offset));
+    if (truncated.isError()) {
+      return Error(
+          "Failed to truncate status updates file '" + path +
+          "': " + truncated.error());
+    }
+  }
+
+  if (record.isError()) {
+    const string message = "Failed to read status updates file  '" + path +
+                           "': " + record.error();
+
+    if (strict) {
+      return Error(message);
+    } else {
+      LOG(WARNING) << message;
+      state.errors++;
+    }
+  }
+
+  return state;
+}
+
+
 Try<TaskState> TaskState::recover(
     const string& rootDir,
     const SlaveID& slaveId,
@@ -726,7 +935,7 @@ Try<TaskState> TaskState::recover(
   // Read the task info.
   string path = paths::getTaskInfoPath(
       rootDir, slaveId, frameworkId, executorId, containerId, taskId);
-  if (!os::exists(path)) {
+  if (!state::exists(path)) {
     // This could happen if the slave died after creating the task
     // directory but before it checkpointed the task info.
     LOG(WARNING) << "Failed to find task info file '" << path << "'";
@@ -759,13 +968,18 @@ Try<TaskState> TaskState::recover(
   // Read the status updates.
   path = paths::getTaskUpdatesPath(
       rootDir, slaveId, frameworkId, executorId, containerId, taskId);
-  if (!os::exists(path)) {
+  if (!state::exists(path)) {
     // This could happen if the slave died before it checkpointed any
     // status updates for this task.
     LOG(WARNING) << "Failed to find status updates file '" << path << "'";
     return state;
   }
 
+  std::shared_ptr<CheckpointLog> log = getCheckpointLog(path);
+  if (log) {
+    return recoverUpdates(path, log, strict, state);
+  }
+
   // Open the status updates file for reading and writing (for
   // truncating).
   Try<int_fd> fd = os::open(path, O_RDWR | O_CLOEXEC);
@@ -21,6 +21,9 @@
 #include <unistd.h>
 #endif // __WINDOWS__
 
+#include <cstring>
+#include <memory>
+#include <string>
 #include <vector>
 
 #include <mesos/resources.hpp>
@@ -28,8 +31,10 @@
 
 #include <process/pid.hpp>
 
+#include <stout/foreach.hpp>
 #include <stout/hashmap.hpp>
 #include <stout/hashset.hpp>
+#include <stout/option.hpp>
 #include <stout/path.hpp>
 #include <stout/protobuf.hpp>
 #include <stout/try.hpp>
@@ -46,6 +51,8 @@
 
 #include "messages/messages.hpp"
 
+#include "slave/checkpoint_log.hpp"
+
 namespace mesos {
 namespace internal {
 namespace slave {
@@ -74,13 +81,119 @@ struct TaskState;
 Try<State> recover(const std::string& rootDir, bool strict);
 
 
+// Routes the checkpoints of the files under the meta directory
+// `rootDir` which are held by `log` (see `CheckpointLog::covers()`) to
+// the log instead of individual files. Passing `nullptr` stops routing
+// them, e.g., when the agent terminates.
+void setCheckpointLog(
+    const std::string& rootDir,
+    const std::shared_ptr<CheckpointLog>& log);
+
+
+// Returns the checkpoint log holding the file at `path`, if any.
+std::shared_ptr<CheckpointLog> getCheckpointLog(const std::string& path);
+
+
+// Variants of `os::exists`, `os::touch` and `os::rm` for checkpointed
+// files which may be held by a checkpoint log.
+bool exists(const std::string& path);
+Try<Nothing> touch(const std::string& path);
+Try<Nothing> rm(const std::string& path);
+
+
+namespace internal {
+
+// Parses the next message at `*offset` of the contents of a file
+// written by `protobuf::write()`, i.e., a sequence of messages each
+// preceded by its size, and advances `offset` past it. Returns none at
+// the end of `data` or if the message is incomplete.
+template <typename T>
+Result<T> parse(const std::string& data, size_t* offset)
+{
+  uint32_t size;
+  if (data.size() - *offset < sizeof(size)) {
+    return None();
+  }
+
+  memcpy(&size, data.data() + *offset, sizeof(size));
+
+  if (data.size() - *offset - sizeof(size) < size) {
+    return None();
+  }
+
+  T message;
+  if (!message.ParseFromArray(data.data() + *offset + sizeof(size), size)) {
+    return Error("Failed to deserialize message");
+  }
+
+  *offset += sizeof(size) + size;
+
+  return message;
+}
+
+
+// Parses the protobuf message(s) from the contents of a file, like
+// `protobuf::read()` does from the file itself.
+template <typename T>
+struct Parse
+{
+  Result<T> operator()(const std::string& data)
+  {
+    size_t offset = 0;
+    return parse<T>(data, &offset);
+  }
+};
+
+
+template <typename T>
+struct Parse<google::protobuf::RepeatedPtrField<T>>
+{
+  Result<google::protobuf::RepeatedPtrField<T>> operator()(
+      const std::string& data)
+  {
+    google::protobuf::RepeatedPtrField<T> result;
+
+    size_t offset = 0;
+    while (true) {
+      Result<T> message = parse<T>(data, &offset);
+      if (message.isError()) {
+        return Error(message.error());
+      } else if (message.isNone()) {
+        break;
+      }
+
+      result.Add()->CopyFrom(message.get());
+    }
+
+    return result;
+  }
+};
+
+}  // namespace internal {
+
+
 // Reads the protobuf message(s) from the given path.
 // `T` may be either a single protobuf message or a sequence of messages
 // if `T` is a specialization of `google::protobuf::RepeatedPtrField`.
 template <typename T>
 Result<T> read(const std::string& path)
 {
-  Result<T> result = ::protobuf::read<T>(path);
+  Result<T> result = None();
+
+  std::shared_ptr<CheckpointLog> log = getCheckpointLog(path);
+  if (log) {
+    Result<std::string> data = log->read(path);
+    if (data.isError()) {
+      return Error(data.error());
+    } else if (data.isNone()) {
+      return Error("Failed to find '" + path + "' in the checkpoint log");
+    }
+
+    result = internal::Parse<T>()(data.get());
+  } else {
+    result = ::protobuf::read<T>(path);
+  }
+
   if (result.isSome()) {
     upgradeResources(&result.get());
   }
@@ -96,6 +209,18 @@ Result<T> read(const std::string& path)
 template <>
 inline Result<std::string> read<std::string>(const std::string& path)
 {
+  std::shared_ptr<CheckpointLog> log = getCheckpointLog(path);
+  if (log) {
+    Result<std::string> data = log->read(path);
+    if (data.isError()) {
+      return Error(data.error());
+    } else if (data.isNone()) {
+      return Error("Failed to find '" + path + "' in the checkpoint log");
+    }
+
+    return data.get();
+  }
+
   return os::read(path);
 }
 
@@ -120,13 +245,33 @@ inline Result<Resources> read<Resources>(const std::string& path)
 
 namespace internal {
 
-inline Try<Nothing> checkpoint(
-    const std::string& path,
+// Appends the message to `data` in the format written by
+// `protobuf::write()`, i.e., preceded by its size.
+inline Try<Nothing> encode(
+    const google::protobuf::Message& message,
+    std::string* data)
+{
+  if (!message.IsInitialized()) {
+    return Error(message.InitializationErrorString() +
+                 " is required but not initialized");
+  }
+
+  uint32_t size = message.ByteSize();
+  data->append((const char*) &size, sizeof(size));
+
+  if (!message.AppendToString(data)) {
+    return Error("Failed to serialize message");
+  }
+
+  return Nothing();
+}
+
+
+inline Try<std::string> serialize(
     const std::string& message,
-    bool sync,
     bool downgradeResources)
 {
-  return ::os::write(path, message, sync);
+  return message;
 }
 
 
@@ -135,11 +280,7 @@ template <
     typename std::enable_if<
         std::is_convertible<T*, google::protobuf::Message*>::value,
         int>::type = 0>
-inline Try<Nothing> checkpoint(
-    const std::string& path,
-    T message,
-    bool sync,
-    bool downgrade)
+inline Try<std::string> serialize(T message, bool downgrade)
 {
   if (downgrade) {
     // If the `Try` from `downgradeResources` returns an `Error`, we currently
@@ -153,14 +294,19 @@ inline Try<Nothing> checkpoint(
     downgradeResources(&message);
   }
 
-  return ::protobuf::write(path, message, sync);
+  std::string data;
+
+  Try<Nothing> encode = internal::encode(message, &data);
+  if (encode.isError()) {
+    return Error(encode.error());
+  }
+
+  return data;
 }
 
 
-inline Try<Nothing> checkpoint(
-    const std::string& path,
+inline Try<std::string> serialize(
     google::protobuf::RepeatedPtrField<Resource> resources,
-    bool sync,
     bool downgrade)
 {
   if (downgrade) {
@@ -175,18 +321,23 @@ inline Try<Nothing> checkpoint(
     downgradeResources(&resources);
   }
 
-  return ::protobuf::write(path, resources, sync);
+  std::string data;
+
+  foreach (const Resource& resource, resources) {
+    Try<Nothing> encode = internal::encode(resource, &data);
+    if (encode.isError()) {
+      return Error(encode.error());
+    }
+  }
+
+  return data;
 }
 
 
-inline Try<Nothing> checkpoint(
-    const std::string& path,
-    const Resources& resources,
-    bool sync,
-    bool downgrade)
+inline Try<std::string> serialize(const Resources& resources, bool downgrade)
 {
   const google::protobuf::RepeatedPtrField<Resource>& messages = resources;
-  return checkpoint(path, messages, sync, downgrade);
+  return serialize(messages, downgrade);
 }
 
 }  // namespace internal {
@@ -195,7 +346,7 @@ inline Try<Nothing> checkpoint(
 // Thin wrapper to checkpoint data to disk and perform the necessary
 // error checking. It checkpoints an instance of T at the given path.
 // We can checkpoint anything as long as T is supported by
-// internal::checkpoint. Currently the list of supported Ts are:
+// internal::serialize. Currently the list of supported Ts are:
 //   - std::string
 //   - google::protobuf::Message
 //   - google::protobuf::RepeatedPtrField<T>
@@ -207,6 +358,10 @@ inline Try<Nothing> checkpoint(
 // only if `fsync` is supported and successfully commits the changes to the
 // filesystem for the checkpoint file and each created directory.
 //
+// If the file is held by a checkpoint log (see `setCheckpointLog()`), it
+// is written to the log instead, which is atomic by itself. Such writes
+// are always synced, since the log group commits them.
+//
 // TODO(chhsiao): Consider enabling syncing by default after evaluating its
 // performance impact.
 template <typename T>
@@ -216,6 +371,11 @@ Try<Nothing> checkpoint(
     bool sync = false,
     bool downgrade = true)
 {
+  Try<std::string> data = internal::serialize(t, downgrade);
+  if (data.isError()) {
+    return Error(data.error());
+  }
+
   // Create the base directory.
   std::string base = Path(path).dirname();
 
@@ -224,6 +384,11 @@ Try<Nothing> checkpoint(
     return Error("Failed to create directory '" + base + "': " + mkdir.error());
   }
 
+  std::shared_ptr<CheckpointLog> log = getCheckpointLog(path);
+  if (log) {
+    return log->write(path, data.get(), true);
+  }
+
   // NOTE: We create the temporary file at 'base/XXXXXX' to make sure
   // rename below does not cross devices (MESOS-2319).
   //
@@ -236,8 +401,7 @@ Try<Nothing> checkpoint(
   }
 
   // Now checkpoint the instance of T to the temporary file.
-  Try<Nothing> checkpoint =
-    internal::checkpoint(temp.get(), t, sync, downgrade);
+  Try<Nothing> checkpoint = os::write(temp.get(), data.get(), sync);
   if (checkpoint.isError()) {
     // Try removing the temporary file on error.
     os::rm(temp.get());
@@ -301,6 +465,10 @@ struct RunState
       bool rebooted);
 
   Option<ContainerID> id;
+
+  // NOTE: Only the id of a completed run which isn't the latest run of
+  // its executor is recovered by `ExecutorState::recover()`, i.e., its
+  // tasks and pids are not.
   hashmap<TaskID, TaskState> tasks;
   Option<pid_t> forkedPid;
   Option<process::UPID> libprocessPid;
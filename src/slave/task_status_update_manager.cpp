@@ -684,6 +684,11 @@ TaskStatusUpdateStream::TaskStatusUpdateStream(
       return;
     }
 
+    log = state::getCheckpointLog(path.get());
+    if (log) {
+      return;
+    }
+
     // Open the updates file.
     // NOTE: We don't use `O_SYNC` here because we only read this file
     // if the host did not crash. `os::write` success implies the kernel
@@ -842,8 +847,6 @@ Try<Nothing> TaskStatusUpdateStream::handle(
     LOG(INFO) << "Checkpointing " << type << " for task status update "
               << update;
 
-    CHECK_SOME(fd);
-
     StatusUpdateRecord record;
     record.set_type(type);
 
@@ -853,7 +856,19 @@ Try<Nothing> TaskStatusUpdateStream::handle(
       record.set_uuid(update.uuid());
     }
 
-    Try<Nothing> write = ::protobuf::write(fd.get(), record);
+    Try<Nothing> write = Nothing();
+
+    if (log) {
+      string data;
+      write = state::internal::encode(record, &data);
+      if (write.isSome()) {
+        write = log->append(path.get(), data, true);
+      }
+    } else {
+      CHECK_SOME(fd);
+      write = ::protobuf::write(fd.get(), record);
+    }
+
     if (write.isError()) {
       error = "Failed to write task status update " + stringify(update) +
               " to '" + path.get() + "': " + write.error();
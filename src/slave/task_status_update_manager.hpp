@@ -17,6 +17,7 @@
 #ifndef __TASK_STATUS_UPDATE_MANAGER_HPP__
 #define __TASK_STATUS_UPDATE_MANAGER_HPP__
 
+#include <memory>
 #include <queue>
 #include <string>
 
@@ -34,6 +35,7 @@
 
 #include "messages/messages.hpp"
 
+#include "slave/checkpoint_log.hpp"
 #include "slave/flags.hpp"
 
 namespace mesos {
@@ -199,6 +201,10 @@ private:
   Option<std::string> path; // File path of the update stream.
   Option<int_fd> fd; // File descriptor to the update stream.
 
+  // The checkpoint log holding the update stream instead of `fd`, if
+  // the agent uses one.
+  std::shared_ptr<CheckpointLog> log;
+
   Option<std::string> error; // Potential non-retryable error.
 };
 
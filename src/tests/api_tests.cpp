@@ -446,6 +446,64 @@ TEST_P(MasterAPITest, GetFrameworks)
 }
 
 
+// This test verifies that the GetFrameworks v1 API call only includes
+// the selected and the required fields when given a field mask.
+TEST_P(MasterAPITest, GetFrameworksFieldMask)
+{
+  Try<Owned<cluster::Master>> master = StartMaster();
+  ASSERT_SOME(master);
+
+  Owned<MasterDetector> detector = master.get()->createDetector();
+  Try<Owned<cluster::Slave>> slave = StartSlave(detector.get());
+  ASSERT_SOME(slave);
+
+  MockScheduler sched;
+  MesosSchedulerDriver driver(
+      &sched, DEFAULT_FRAMEWORK_INFO, master.get()->pid, DEFAULT_CREDENTIAL);
+
+  EXPECT_CALL(sched, registered(&driver, _, _));
+
+  Future<vector<Offer>> offers;
+  EXPECT_CALL(sched, resourceOffers(&driver, _))
+    .WillOnce(FutureArg<1>(&offers))
+    .WillRepeatedly(Return()); // Ignore subsequent offers.
+
+  driver.start();
+
+  AWAIT_READY(offers);
+  ASSERT_FALSE(offers->empty());
+
+  v1::master::Call v1Call;
+  v1Call.set_type(v1::master::Call::GET_FRAMEWORKS);
+  v1Call.mutable_get_frameworks()->mutable_field_mask()->add_paths(
+      "registered_time.nanoseconds");
+
+  ContentType contentType = GetParam();
+
+  Future<v1::master::Response> v1Response =
+    post(master.get()->pid, v1Call, contentType);
+
+  AWAIT_READY(v1Response);
+  ASSERT_TRUE(v1Response->IsInitialized());
+  ASSERT_EQ(v1::master::Response::GET_FRAMEWORKS, v1Response->type());
+  ASSERT_EQ(1, v1Response->get_frameworks().frameworks_size());
+
+  const v1::master::Response::GetFrameworks::Framework& framework =
+    v1Response->get_frameworks().frameworks(0);
+
+  EXPECT_EQ("default", framework.framework_info().name());
+  EXPECT_TRUE(framework.active());
+  EXPECT_TRUE(framework.has_registered_time());
+
+  // The outstanding offer is not included.
+  EXPECT_TRUE(framework.offers().empty());
+  EXPECT_TRUE(framework.offered_resources().empty());
+
+  driver.stop();
+  driver.join();
+}
+
+
 TEST_P(MasterAPITest, GetHealth)
 {
   Try<Owned<cluster::Master>> master = this->StartMaster();
@@ -945,6 +1003,207 @@ TEST_P(MasterAPITest, GetTasks)
 }
 
 
+// This test verifies that the GetTasks v1 API call supports filters,
+// pagination and field masks.
+TEST_P(MasterAPITest, GetTasksSelection)
+{
+  Try<Owned<cluster::Master>> master = StartMaster();
+  ASSERT_SOME(master);
+
+  MockExecutor exec(DEFAULT_EXECUTOR_ID);
+  TestContainerizer containerizer(&exec);
+
+  Owned<MasterDetector> detector = master.get()->createDetector();
+  Try<Owned<cluster::Slave>> slave = StartSlave(detector.get(), &containerizer);
+  ASSERT_SOME(slave);
+
+  MockScheduler sched;
+  MesosSchedulerDriver driver(
+      &sched, DEFAULT_FRAMEWORK_INFO, master.get()->pid, DEFAULT_CREDENTIAL);
+
+  EXPECT_CALL(sched, registered(&driver, _, _));
+
+  EXPECT_CALL(sched, resourceOffers(&driver, _))
+    .WillOnce(LaunchTasks(DEFAULT_EXECUTOR_INFO, 3, 0.1, 32, "*"))
+    .WillRepeatedly(Return()); // Ignore subsequent offers.
+
+  EXPECT_CALL(exec, registered(_, _, _, _));
+
+  EXPECT_CALL(exec, launchTask(_, _))
+    .WillRepeatedly(SendStatusUpdateFromTask(TASK_RUNNING));
+
+  Future<Nothing> statusUpdates;
+  EXPECT_CALL(sched, statusUpdate(&driver, _))
+    .WillOnce(Return())
+    .WillOnce(Return())
+    .WillOnce(FutureSatisfy(&statusUpdates));
+
+  driver.start();
+
+  AWAIT_READY(statusUpdates);
+
+  ContentType contentType = GetParam();
+
+  v1::master::Call v1Call;
+  v1Call.set_type(v1::master::Call::GET_TASKS);
+  v1Call.mutable_get_tasks()->set_limit(2);
+  v1Call.mutable_get_tasks()->mutable_field_mask()->add_paths("state");
+
+  hashset<string> taskIds;
+
+  {
+    Future<v1::master::Response> v1Response =
+      post(master.get()->pid, v1Call, contentType);
+
+    AWAIT_READY(v1Response);
+    ASSERT_TRUE(v1Response->IsInitialized());
+    ASSERT_EQ(v1::master::Response::GET_TASKS, v1Response->type());
+    ASSERT_EQ(2, v1Response->get_tasks().tasks_size());
+    ASSERT_TRUE(v1Response->get_tasks().has_next_cursor());
+
+    foreach (const mesos::v1::Task& task, v1Response->get_tasks().tasks()) {
+      EXPECT_EQ(v1::TASK_RUNNING, task.state());
+
+      // Only the selected and the required fields are included.
+      EXPECT_TRUE(task.resources().empty());
+      EXPECT_TRUE(task.statuses().empty());
+      EXPECT_FALSE(task.has_executor_id());
+
+      taskIds.insert(task.task_id().value());
+    }
+
+    v1Call.mutable_get_tasks()->set_cursor(
+        v1Response->get_tasks().next_cursor());
+  }
+
+  {
+    Future<v1::master::Response> v1Response =
+      post(master.get()->pid, v1Call, contentType);
+
+    AWAIT_READY(v1Response);
+    ASSERT_EQ(1, v1Response->get_tasks().tasks_size());
+    EXPECT_FALSE(v1Response->get_tasks().has_next_cursor());
+
+    taskIds.insert(v1Response->get_tasks().tasks(0).task_id().value());
+  }
+
+  // All tasks have been returned exactly once.
+  EXPECT_EQ(3u, taskIds.size());
+
+  {
+    v1::master::Call v1Call;
+    v1Call.set_type(v1::master::Call::GET_TASKS);
+    v1Call.mutable_get_tasks()->add_states(v1::TASK_FINISHED);
+
+    Future<v1::master::Response> v1Response =
+      post(master.get()->pid, v1Call, contentType);
+
+    AWAIT_READY(v1Response);
+    EXPECT_TRUE(v1Response->get_tasks().tasks().empty());
+  }
+
+  {
+    v1::master::Call v1Call;
+    v1Call.set_type(v1::master::Call::GET_TASKS);
+    v1Call.mutable_get_tasks()->mutable_field_mask()->add_paths("foo");
+
+    AWAIT_FAILED(post(master.get()->pid, v1Call, contentType));
+  }
+
+  EXPECT_CALL(exec, shutdown(_))
+    .Times(AtMost(1));
+
+  driver.stop();
+  driver.join();
+}
+
+
+// This test verifies that the GetTasks v1 API call only includes the
+// tasks of completed frameworks which the principal is authorized to
+// view.
+TEST_P(MasterAPITest, GetTasksCompletedFrameworkAuthorization)
+{
+  master::Flags masterFlags = CreateMasterFlags();
+
+  {
+    // Default principal 2 is not allowed to view any framework.
+    mesos::ACL::ViewFramework* acl = masterFlags.acls->add_view_frameworks();
+    acl->mutable_principals()->add_values(DEFAULT_CREDENTIAL_2.principal());
+    acl->mutable_users()->set_type(mesos::ACL::Entity::NONE);
+  }
+
+  Try<Owned<cluster::Master>> master = StartMaster(masterFlags);
+  ASSERT_SOME(master);
+
+  MockExecutor exec(DEFAULT_EXECUTOR_ID);
+  TestContainerizer containerizer(&exec);
+
+  Owned<MasterDetector> detector = master.get()->createDetector();
+  Try<Owned<cluster::Slave>> slave = StartSlave(detector.get(), &containerizer);
+  ASSERT_SOME(slave);
+
+  MockScheduler sched;
+  MesosSchedulerDriver driver(
+      &sched, DEFAULT_FRAMEWORK_INFO, master.get()->pid, DEFAULT_CREDENTIAL);
+
+  EXPECT_CALL(sched, registered(&driver, _, _));
+
+  EXPECT_CALL(sched, resourceOffers(&driver, _))
+    .WillOnce(LaunchTasks(DEFAULT_EXECUTOR_INFO, 1, 0.1, 32, "*"))
+    .WillRepeatedly(Return()); // Ignore subsequent offers.
+
+  EXPECT_CALL(exec, registered(_, _, _, _));
+
+  EXPECT_CALL(exec, launchTask(_, _))
+    .WillOnce(SendStatusUpdateFromTask(TASK_RUNNING));
+
+  Future<TaskStatus> status;
+  EXPECT_CALL(sched, statusUpdate(&driver, _))
+    .WillOnce(FutureArg<1>(&status));
+
+  driver.start();
+
+  AWAIT_READY(status);
+  EXPECT_EQ(TASK_RUNNING, status->state());
+
+  // Tearing down the framework completes it along with its task. The
+  // master has done so once it shuts down the executor.
+  Future<Nothing> shutdown;
+  EXPECT_CALL(exec, shutdown(_))
+    .WillOnce(FutureSatisfy(&shutdown));
+
+  driver.stop();
+  driver.join();
+
+  AWAIT_READY(shutdown);
+
+  ContentType contentType = GetParam();
+
+  v1::master::Call v1Call;
+  v1Call.set_type(v1::master::Call::GET_TASKS);
+
+  {
+    Future<v1::master::Response> v1Response =
+      post(master.get()->pid, v1Call, contentType);
+
+    AWAIT_READY(v1Response);
+    ASSERT_EQ(v1::master::Response::GET_TASKS, v1Response->type());
+    EXPECT_TRUE(v1Response->get_tasks().tasks().empty());
+    EXPECT_EQ(1, v1Response->get_tasks().completed_tasks().size());
+  }
+
+  {
+    Future<v1::master::Response> v1Response =
+      post(master.get()->pid, v1Call, contentType, DEFAULT_CREDENTIAL_2);
+
+    AWAIT_READY(v1Response);
+    ASSERT_EQ(v1::master::Response::GET_TASKS, v1Response->type());
+    EXPECT_TRUE(v1Response->get_tasks().tasks().empty());
+    EXPECT_TRUE(v1Response->get_tasks().completed_tasks().empty());
+  }
+}
+
+
 TEST_P(MasterAPITest, GetLoggingLevel)
 {
   Try<Owned<cluster::Master>> master = this->StartMaster();
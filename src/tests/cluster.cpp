@@ -447,7 +447,10 @@ Try<process::Owned<Slave>> Slave::create(
 
   // If the garbage collector is not provided, create a default one.
   if (gc.isNone()) {
-    slave->gc.reset(new slave::GarbageCollector(flags.work_dir));
+    slave->gc.reset(new slave::GarbageCollector(
+        flags.work_dir,
+        flags.gc_parallelism,
+        flags.gc_max_unlinks_per_second));
   }
 
   // If the flag `--volume_gid_range` is specified, create a volume gid manager.
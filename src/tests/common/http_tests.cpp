@@ -14,6 +14,9 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <iostream>
+#include <string>
 #include <vector>
 
 #include <gtest/gtest.h>
@@ -21,8 +24,17 @@
 #include <mesos/mesos.hpp>
 #include <mesos/resources.hpp>
 
+#include <mesos/v1/master/master.hpp>
+
+#include <mesos/v1/scheduler/scheduler.hpp>
+
+#include <stout/bytes.hpp>
 #include <stout/gtest.hpp>
 #include <stout/json.hpp>
+#include <stout/jsonify.hpp>
+#include <stout/protobuf.hpp>
+#include <stout/stopwatch.hpp>
+#include <stout/stringify.hpp>
 
 #include "common/http.hpp"
 #include "common/protobuf_utils.hpp"
@@ -34,6 +46,8 @@
 using namespace mesos;
 using namespace mesos::internal;
 
+using std::cout;
+using std::endl;
 using std::string;
 using std::vector;
 
@@ -313,3 +327,133 @@ TEST(HTTP, AsV1Protobuf)
       "}",
       string(jsonify(asV1Protobuf(parent))));
 }
+
+
+class HTTP_Deserialize_BENCHMARK_Test
+  : public ::testing::Test,
+    public ::testing::WithParamInterface<size_t> {};
+
+
+// Parameterized by the number of operations (or resources) of a call.
+INSTANTIATE_TEST_CASE_P(
+    OperationsCount,
+    HTTP_Deserialize_BENCHMARK_Test,
+    ::testing::Values(1u, 10u, 100u, 1000u));
+
+
+namespace {
+
+v1::Resource createReservedResource(
+    const string& name,
+    double value,
+    const string& role)
+{
+  v1::Resource resource;
+  resource.set_name(name);
+  resource.set_type(v1::Value::SCALAR);
+  resource.mutable_scalar()->set_value(value);
+
+  v1::Resource::ReservationInfo* reservation = resource.add_reservations();
+  reservation->set_type(v1::Resource::ReservationInfo::DYNAMIC);
+  reservation->set_role(role);
+  reservation->set_principal("principal");
+
+  return resource;
+}
+
+
+// Prints the time it takes to deserialize `json` a number of times,
+// both through a `JSON::Value` and directly from the string.
+template <typename Message>
+void benchmark(const string& name, const string& json)
+{
+  // Parse about 100MB worth of JSON each way.
+  const size_t iterations =
+    std::max<size_t>(1, Megabytes(100).bytes() / json.size());
+
+  Stopwatch watch;
+  watch.start();
+
+  for (size_t i = 0; i < iterations; i++) {
+    Try<JSON::Value> value = JSON::parse(json);
+    ASSERT_SOME(value);
+    ASSERT_SOME(::protobuf::parse<Message>(value.get()));
+  }
+
+  watch.stop();
+
+  cout << "Parsed " << iterations << " " << name << " calls of "
+       << Bytes(json.size()) << " through a JSON::Value in "
+       << watch.elapsed() << endl;
+
+  watch.start();
+
+  for (size_t i = 0; i < iterations; i++) {
+    ASSERT_SOME(deserialize<Message>(ContentType::JSON, json));
+  }
+
+  watch.stop();
+
+  cout << "Parsed " << iterations << " " << name << " calls of "
+       << Bytes(json.size()) << " directly in " << watch.elapsed() << endl;
+}
+
+} // namespace {
+
+
+// A scheduler accepting an offer with a task launch per operation.
+TEST_P(HTTP_Deserialize_BENCHMARK_Test, SchedulerAccept)
+{
+  const size_t operations = GetParam();
+
+  v1::scheduler::Call call;
+  call.set_type(v1::scheduler::Call::ACCEPT);
+  call.mutable_framework_id()->set_value("framework");
+
+  v1::scheduler::Call::Accept* accept = call.mutable_accept();
+  accept->add_offer_ids()->set_value("offer");
+  accept->mutable_filters()->set_refuse_seconds(5.0);
+
+  for (size_t i = 0; i < operations; i++) {
+    v1::Offer::Operation* operation = accept->add_operations();
+    operation->set_type(v1::Offer::Operation::LAUNCH);
+
+    v1::TaskInfo* task = operation->mutable_launch()->add_task_infos();
+    task->set_name("task-" + stringify(i));
+    task->mutable_task_id()->set_value("task-" + stringify(i));
+    task->mutable_agent_id()->set_value("agent");
+    task->mutable_command()->set_value("sleep 1000");
+
+    v1::Label* label = task->mutable_labels()->add_labels();
+    label->set_key("key");
+    label->set_value("value");
+
+    *task->add_resources() = createReservedResource("cpus", 0.1, "role");
+    *task->add_resources() = createReservedResource("mem", 32, "role");
+  }
+
+  benchmark<v1::scheduler::Call>("ACCEPT", jsonify(JSON::Protobuf(call)));
+}
+
+
+// An operator reserving a number of resources on an agent.
+TEST_P(HTTP_Deserialize_BENCHMARK_Test, OperatorReserveResources)
+{
+  const size_t resources = GetParam();
+
+  v1::master::Call call;
+  call.set_type(v1::master::Call::RESERVE_RESOURCES);
+
+  v1::master::Call::ReserveResources* reserve =
+    call.mutable_reserve_resources();
+
+  reserve->mutable_agent_id()->set_value("agent");
+
+  for (size_t i = 0; i < resources; i++) {
+    *reserve->add_resources() =
+      createReservedResource("cpus", 1, "role-" + stringify(i));
+  }
+
+  benchmark<v1::master::Call>(
+      "RESERVE_RESOURCES", jsonify(JSON::Protobuf(call)));
+}
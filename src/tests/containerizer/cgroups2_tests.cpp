@@ -0,0 +1,470 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <signal.h>
+#include <unistd.h>
+
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include <gmock/gmock.h>
+
+#include <process/collect.hpp>
+#include <process/future.hpp>
+#include <process/gtest.hpp>
+
+#include <stout/foreach.hpp>
+#include <stout/gtest.hpp>
+#include <stout/hashmap.hpp>
+#include <stout/lambda.hpp>
+#include <stout/numify.hpp>
+#include <stout/path.hpp>
+#include <stout/stopwatch.hpp>
+#include <stout/stringify.hpp>
+#include <stout/strings.hpp>
+
+#include "linux/cgroups.hpp"
+#include "linux/cgroups2.hpp"
+
+#include "tests/mesos.hpp" // For TEST_CGROUPS_ROOT.
+#include "tests/utils.hpp"
+
+using mesos::PressureStallInformation;
+
+using process::Future;
+
+using std::cout;
+using std::endl;
+using std::set;
+using std::string;
+using std::vector;
+
+using testing::WithParamInterface;
+
+namespace mesos {
+namespace internal {
+namespace tests {
+
+static const vector<string> PRESSURE_CONTROLS = {
+  "cpu.pressure", "memory.pressure", "io.pressure"};
+
+
+// Forks a process which, once `assign` has placed it into a cgroup,
+// forks another process; both then wait to be killed. Returns the pid
+// of the first process.
+static Try<pid_t> spawn(const lambda::function<Try<Nothing>(pid_t)>& assign)
+{
+  int pipes[2];
+  if (::pipe(pipes) < 0) {
+    return ErrnoError("Failed to create pipe");
+  }
+
+  pid_t pid = ::fork();
+  if (pid < 0) {
+    ::close(pipes[0]);
+    ::close(pipes[1]);
+    return ErrnoError("Failed to fork");
+  }
+
+  if (pid == 0) {
+    // In child process.
+    ::close(pipes[1]);
+
+    char dummy;
+    if (::read(pipes[0], &dummy, sizeof(dummy)) != sizeof(dummy)) {
+      ::_exit(EXIT_FAILURE);
+    }
+
+    ::close(pipes[0]);
+    ::fork();
+
+    while (true) {
+      ::pause();
+    }
+  }
+
+  // In parent process.
+  ::close(pipes[0]);
+
+  Try<Nothing> assigned = assign(pid);
+
+  char dummy = '\0';
+  ssize_t length = ::write(pipes[1], &dummy, sizeof(dummy));
+  ::close(pipes[1]);
+
+  if (assigned.isError()) {
+    ::kill(pid, SIGKILL);
+    ::waitpid(pid, nullptr, 0);
+    return Error(assigned.error());
+  }
+
+  if (length != sizeof(dummy)) {
+    return ErrnoError("Failed to notify the child");
+  }
+
+  return pid;
+}
+
+
+TEST(PressureStallInformationTest, Parse)
+{
+  Try<PressureStallInformation> pressure = cgroups2::parsePressure(
+      "some avg10=1.50 avg60=0.25 avg300=0.00 total=123456\n"
+      "full avg10=0.00 avg60=0.00 avg300=0.00 total=42\n");
+
+  ASSERT_SOME(pressure);
+  EXPECT_DOUBLE_EQ(1.5, pressure->some().avg10());
+  EXPECT_DOUBLE_EQ(0.25, pressure->some().avg60());
+  EXPECT_DOUBLE_EQ(0.0, pressure->some().avg300());
+  EXPECT_EQ(123456u, pressure->some().total());
+  EXPECT_EQ(42u, pressure->full().total());
+
+  // Older kernels do not report 'full' for CPU.
+  pressure = cgroups2::parsePressure(
+      "some avg10=0.00 avg60=0.00 avg300=0.00 total=7\n");
+
+  ASSERT_SOME(pressure);
+  EXPECT_EQ(7u, pressure->some().total());
+  EXPECT_FALSE(pressure->has_full());
+
+  EXPECT_ERROR(cgroups2::parsePressure("partial avg10=0.00\n"));
+  EXPECT_ERROR(cgroups2::parsePressure("some avg10=abc\n"));
+}
+
+
+class Cgroups2Test : public TemporaryDirectoryTest
+{
+protected:
+  void SetUp() override
+  {
+    TemporaryDirectoryTest::SetUp();
+
+    Try<string> mountpoint = cgroups2::mountpoint();
+    ASSERT_SOME(mountpoint);
+    root = mountpoint.get();
+
+    Try<set<string>> available =
+      cgroups2::controllers::available(root, "/");
+
+    ASSERT_SOME(available);
+
+    foreach (const string& controller, controllers) {
+      ASSERT_EQ(1u, available->count(controller))
+        << "-------------------------------------------------------------\n"
+        << "We cannot run any cgroup v2 tests because the '" << controller
+        << "'\ncontroller is not available in '" << root << "'; it is\n"
+        << "likely still bound to a cgroups v1 hierarchy.\n"
+        << "-------------------------------------------------------------";
+    }
+
+    // Clean up the testing cgroup, in case it wasn't cleaned up
+    // properly from previous tests.
+    AWAIT_READY(cgroups2::destroy(root, TEST_CGROUPS_ROOT));
+
+    ASSERT_SOME(cgroups2::controllers::enable(root, "/", controllers));
+    ASSERT_SOME(cgroups2::create(root, TEST_CGROUPS_ROOT));
+    ASSERT_SOME(
+        cgroups2::controllers::enable(root, TEST_CGROUPS_ROOT, controllers));
+  }
+
+  void TearDown() override
+  {
+    AWAIT_READY(cgroups2::destroy(root, TEST_CGROUPS_ROOT));
+
+    TemporaryDirectoryTest::TearDown();
+  }
+
+  // Returns a function which assigns a pid to the given cgroup.
+  lambda::function<Try<Nothing>(pid_t)> assigner(const string& cgroup) const
+  {
+    const string _root = root;
+    return [_root, cgroup](pid_t pid) {
+      return cgroups2::assign(_root, cgroup, pid);
+    };
+  }
+
+  const set<string> controllers = {"cpu", "memory"};
+
+  string root;
+};
+
+
+// Verifies that destroying a cgroup kills all processes in it and in
+// its descendants and removes all the cgroups.
+TEST_F(Cgroups2Test, ROOT_CGROUPS2_Destroy)
+{
+  const string parent = path::join(TEST_CGROUPS_ROOT, "parent");
+  const string child = path::join(parent, "child");
+
+  ASSERT_SOME(cgroups2::create(root, child, true));
+
+  Try<pid_t> pid1 = spawn(assigner(parent));
+  ASSERT_SOME(pid1);
+
+  Try<pid_t> pid2 = spawn(assigner(child));
+  ASSERT_SOME(pid2);
+
+  Try<set<pid_t>> processes = cgroups2::processes(root, parent);
+  ASSERT_SOME(processes);
+  EXPECT_EQ(1u, processes->count(pid1.get()));
+
+  AWAIT_READY(cgroups2::destroy(root, parent));
+
+  EXPECT_FALSE(cgroups2::exists(root, child));
+  EXPECT_FALSE(cgroups2::exists(root, parent));
+
+  // The processes are not reaped by `destroy()`.
+  foreach (pid_t pid, vector<pid_t>({pid1.get(), pid2.get()})) {
+    int status;
+    ASSERT_EQ(pid, ::waitpid(pid, &status, 0));
+    ASSERT_TRUE(WIFSIGNALED(status));
+    EXPECT_EQ(SIGKILL, WTERMSIG(status));
+  }
+}
+
+
+// Verifies that the statistics the isolator relies on can be read and
+// parsed for a cgroup with processes in it.
+TEST_F(Cgroups2Test, ROOT_CGROUPS2_Statistics)
+{
+  const string cgroup = path::join(TEST_CGROUPS_ROOT, "statistics");
+  ASSERT_SOME(cgroups2::create(root, cgroup));
+
+  ASSERT_SOME(cgroups2::write(root, cgroup, "memory.high", "67108864"));
+  ASSERT_SOME(cgroups2::write(root, cgroup, "cpu.weight", "100"));
+
+  Try<pid_t> pid = spawn(assigner(cgroup));
+  ASSERT_SOME(pid);
+
+  Try<hashmap<string, uint64_t>> cpu =
+    cgroups2::stat(root, cgroup, "cpu.stat");
+  ASSERT_SOME(cpu);
+  EXPECT_TRUE(cpu->contains("usage_usec"));
+  EXPECT_TRUE(cpu->contains("user_usec"));
+  EXPECT_TRUE(cpu->contains("system_usec"));
+
+  Try<hashmap<string, uint64_t>> memory =
+    cgroups2::stat(root, cgroup, "memory.stat");
+
+  ASSERT_SOME(memory);
+  EXPECT_TRUE(memory->contains("anon"));
+  EXPECT_TRUE(memory->contains("file"));
+
+  Try<hashmap<string, uint64_t>> events =
+    cgroups2::stat(root, cgroup, "memory.events");
+
+  ASSERT_SOME(events);
+  EXPECT_EQ(0u, events->get("oom_kill").getOrElse(0));
+
+  Try<string> current = cgroups2::read(root, cgroup, "memory.current");
+  ASSERT_SOME(current);
+  EXPECT_SOME(numify<uint64_t>(strings::trim(current.get())));
+
+  Try<string> high = cgroups2::read(root, cgroup, "memory.high");
+  ASSERT_SOME(high);
+  EXPECT_EQ("67108864", strings::trim(high.get()));
+
+  foreach (const string& control, PRESSURE_CONTROLS) {
+    if (cgroups2::exists(root, cgroup, control)) {
+      Try<PressureStallInformation> pressure =
+        cgroups2::pressure(root, cgroup, control);
+
+      ASSERT_SOME(pressure) << control;
+      EXPECT_TRUE(pressure->has_some()) << control;
+    }
+  }
+
+  AWAIT_READY(cgroups2::destroy(root, cgroup));
+
+  ASSERT_EQ(pid.get(), ::waitpid(pid.get(), nullptr, 0));
+}
+
+
+class Cgroups2_BENCHMARK_Test
+  : public Cgroups2Test,
+    public WithParamInterface<size_t> {};
+
+
+INSTANTIATE_TEST_CASE_P(
+    Containers,
+    Cgroups2_BENCHMARK_Test,
+    ::testing::Values(10U, 100U, 500U));
+
+
+// This benchmark measures how long it takes to destroy cgroups with
+// two processes each using 'cgroup.kill' in the unified hierarchy,
+// compared with freezing and killing in the cgroups v1 freezer
+// hierarchy (if it is mounted).
+TEST_P(Cgroups2_BENCHMARK_Test, ROOT_CGROUPS2_DestroyLatency)
+{
+  const size_t containers = GetParam();
+
+  vector<pid_t> pids;
+  vector<string> cgroups;
+
+  for (size_t i = 0; i < containers; i++) {
+    const string cgroup = path::join(TEST_CGROUPS_ROOT, stringify(i));
+    ASSERT_SOME(cgroups2::create(root, cgroup));
+
+    Try<pid_t> pid = spawn(assigner(cgroup));
+    ASSERT_SOME(pid);
+
+    pids.push_back(pid.get());
+    cgroups.push_back(cgroup);
+  }
+
+  Stopwatch watch;
+  watch.start();
+
+  vector<Future<Nothing>> destroys;
+  foreach (const string& cgroup, cgroups) {
+    destroys.push_back(cgroups2::destroy(root, cgroup));
+  }
+
+  AWAIT_READY_FOR(process::collect(destroys), Minutes(5));
+
+  watch.stop();
+
+  cout << "Destroyed " << containers << " cgroup v2 cgroups in "
+       << watch.elapsed() << endl;
+
+  foreach (pid_t pid, pids) {
+    ::waitpid(pid, nullptr, 0);
+  }
+
+  Result<string> freezer = cgroups::hierarchy("freezer");
+  if (!freezer.isSome()) {
+    cout << "Skipping cgroups v1 comparison since the freezer "
+         << "hierarchy is not mounted" << endl;
+    return;
+  }
+
+  const string hierarchy = freezer.get();
+
+  pids.clear();
+
+  for (size_t i = 0; i < containers; i++) {
+    const string cgroup = path::join(TEST_CGROUPS_ROOT, stringify(i));
+    ASSERT_SOME(cgroups::create(hierarchy, cgroup, true));
+
+    Try<pid_t> pid = spawn([hierarchy, cgroup](pid_t pid) {
+      return cgroups::assign(hierarchy, cgroup, pid);
+    });
+
+    ASSERT_SOME(pid);
+    pids.push_back(pid.get());
+  }
+
+  watch.start();
+
+  destroys.clear();
+  foreach (const string& cgroup, cgroups) {
+    destroys.push_back(cgroups::destroy(hierarchy, cgroup));
+  }
+
+  AWAIT_READY_FOR(process::collect(destroys), Minutes(5));
+
+  watch.stop();
+
+  cout << "Destroyed " << containers << " cgroups v1 freezer cgroups in "
+       << watch.elapsed() << endl;
+
+  AWAIT_READY(cgroups::destroy(hierarchy, TEST_CGROUPS_ROOT));
+}
+
+
+// This benchmark measures the cost of collecting the CPU and memory
+// statistics (and PSI) of a cgroup in the unified hierarchy, compared
+// with reading the same statistics from the cgroups v1 'cpuacct' and
+// 'memory' hierarchies (if they are mounted).
+TEST_P(Cgroups2_BENCHMARK_Test, ROOT_CGROUPS2_StatisticsCost)
+{
+  const size_t containers = GetParam();
+  const size_t rounds = 10;
+
+  vector<string> cgroups;
+  for (size_t i = 0; i < containers; i++) {
+    const string cgroup = path::join(TEST_CGROUPS_ROOT, stringify(i));
+    ASSERT_SOME(cgroups2::create(root, cgroup));
+    cgroups.push_back(cgroup);
+  }
+
+  Stopwatch watch;
+  watch.start();
+
+  for (size_t round = 0; round < rounds; round++) {
+    foreach (const string& cgroup, cgroups) {
+      ASSERT_SOME(cgroups2::stat(root, cgroup, "cpu.stat"));
+      ASSERT_SOME(cgroups2::stat(root, cgroup, "memory.stat"));
+      ASSERT_SOME(cgroups2::read(root, cgroup, "memory.current"));
+      ASSERT_SOME(cgroups2::read(root, cgroup, "memory.max"));
+
+      foreach (const string& control, PRESSURE_CONTROLS) {
+        if (cgroups2::exists(root, cgroup, control)) {
+          ASSERT_SOME(cgroups2::pressure(root, cgroup, control));
+        }
+      }
+    }
+  }
+
+  watch.stop();
+
+  cout << "Collected the statistics of " << containers
+       << " cgroup v2 cgroups in " << watch.elapsed() / rounds
+       << " on average" << endl;
+
+  Result<string> cpuacct = cgroups::hierarchy("cpuacct");
+  Result<string> memory = cgroups::hierarchy("memory");
+  if (!cpuacct.isSome() || !memory.isSome()) {
+    cout << "Skipping cgroups v1 comparison since the cpuacct and "
+         << "memory hierarchies are not mounted" << endl;
+    return;
+  }
+
+  foreach (const string& cgroup, cgroups) {
+    ASSERT_SOME(cgroups::create(cpuacct.get(), cgroup, true));
+    ASSERT_SOME(cgroups::create(memory.get(), cgroup, true));
+  }
+
+  watch.start();
+
+  for (size_t round = 0; round < rounds; round++) {
+    foreach (const string& cgroup, cgroups) {
+      ASSERT_SOME(cgroups::stat(cpuacct.get(), cgroup, "cpuacct.stat"));
+      ASSERT_SOME(cgroups::stat(memory.get(), cgroup, "memory.stat"));
+      ASSERT_SOME(cgroups::memory::usage_in_bytes(memory.get(), cgroup));
+      ASSERT_SOME(cgroups::memory::limit_in_bytes(memory.get(), cgroup));
+    }
+  }
+
+  watch.stop();
+
+  cout << "Collected the statistics of " << containers
+       << " cgroups v1 cgroups in " << watch.elapsed() / rounds
+       << " on average" << endl;
+
+  AWAIT_READY(cgroups::destroy(cpuacct.get(), TEST_CGROUPS_ROOT));
+  AWAIT_READY(cgroups::destroy(memory.get(), TEST_CGROUPS_ROOT));
+}
+
+} // namespace tests {
+} // namespace internal {
+} // namespace mesos {
@@ -22,9 +22,11 @@
 #include <string.h>
 #include <unistd.h>
 
+#include <iostream>
 #include <set>
 #include <string>
 #include <thread>
+#include <utility>
 #include <vector>
 
 #include <sys/mman.h>
@@ -47,6 +49,7 @@
 #include <stout/os.hpp>
 #include <stout/path.hpp>
 #include <stout/proc.hpp>
+#include <stout/stopwatch.hpp>
 #include <stout/stringify.hpp>
 #include <stout/strings.hpp>
 
@@ -66,10 +69,16 @@ using namespace process;
 using cgroups::memory::pressure::Level;
 using cgroups::memory::pressure::Counter;
 
+using std::cout;
+using std::endl;
+using std::make_pair;
+using std::pair;
 using std::set;
 using std::string;
 using std::vector;
 
+using testing::WithParamInterface;
+
 namespace mesos {
 namespace internal {
 namespace tests {
@@ -958,6 +967,111 @@ TEST_F(CgroupsAnyHierarchyWithFreezerTest, ROOT_CGROUPS_DestroyTracedProcess)
 }
 
 
+class CgroupsAnyHierarchyWithFreezer_BENCHMARK_Test
+  : public CgroupsAnyHierarchyWithFreezerTest,
+    public WithParamInterface<pair<size_t, size_t>> {};
+
+
+// Parameters are the number of nested containers of each container
+// (fan-out) and the number of nesting levels (depth).
+INSTANTIATE_TEST_CASE_P(
+    FanOutAndDepth,
+    CgroupsAnyHierarchyWithFreezer_BENCHMARK_Test,
+    ::testing::Values(
+        make_pair(10U, 1U),
+        make_pair(100U, 1U),
+        make_pair(1000U, 1U),
+        make_pair(10U, 2U),
+        make_pair(30U, 2U),
+        make_pair(5U, 4U)));
+
+
+// This benchmark measures how long it takes to destroy a tree of nested
+// container cgroups, laid out like the launcher does, in which every
+// container has two processes.
+TEST_P(CgroupsAnyHierarchyWithFreezer_BENCHMARK_Test, ROOT_CGROUPS_DestroyTree)
+{
+  const size_t fanOut = GetParam().first;
+  const size_t depth = GetParam().second;
+
+  string hierarchy = path::join(baseHierarchy, "freezer");
+  ASSERT_SOME(cgroups::create(hierarchy, TEST_CGROUPS_ROOT));
+
+  vector<string> cgroups;
+  vector<string> parents = {TEST_CGROUPS_ROOT};
+
+  for (size_t level = 0; level < depth; level++) {
+    vector<string> children;
+    foreach (const string& parent, parents) {
+      for (size_t i = 0; i < fanOut; i++) {
+        const string cgroup = level == 0
+          ? path::join(parent, stringify(i))
+          : path::join(parent, "mesos", stringify(i));
+
+        ASSERT_SOME(cgroups::create(hierarchy, cgroup, true));
+        children.push_back(cgroup);
+      }
+    }
+
+    cgroups.insert(cgroups.end(), children.begin(), children.end());
+    parents = children;
+  }
+
+  vector<pid_t> pids;
+
+  foreach (const string& cgroup, cgroups) {
+    int pipes[2];
+    ASSERT_NE(-1, ::pipe(pipes));
+
+    pid_t pid = ::fork();
+    ASSERT_NE(-1, pid);
+
+    if (pid == 0) {
+      // In child process, wait until we have been assigned and then
+      // fork a second process within the cgroup.
+      ::close(pipes[1]);
+
+      char dummy;
+      if (::read(pipes[0], &dummy, sizeof(dummy)) != sizeof(dummy)) {
+        ::_exit(EXIT_FAILURE);
+      }
+
+      ::fork();
+
+      while (true) { ::pause(); }
+
+      ABORT("Child should not reach this statement");
+    }
+
+    // In parent process.
+    ::close(pipes[0]);
+
+    ASSERT_SOME(cgroups::assign(hierarchy, cgroup, pid));
+
+    char dummy = '\0';
+    ASSERT_EQ(1, ::write(pipes[1], &dummy, sizeof(dummy)));
+    ::close(pipes[1]);
+
+    pids.push_back(pid);
+  }
+
+  Stopwatch watch;
+  watch.start();
+
+  AWAIT_READY_FOR(cgroups::destroy(hierarchy, TEST_CGROUPS_ROOT), Minutes(5));
+
+  watch.stop();
+
+  cout << "Destroyed " << cgroups.size() << " nested containers with "
+       << (2 * pids.size()) << " processes (fan-out " << fanOut
+       << ", depth " << depth << ") in " << watch.elapsed() << endl;
+
+  foreach (pid_t pid, pids) {
+    ::waitpid(pid, nullptr, 0);
+  }
+}
+
+
 class CgroupsAnyHierarchyWithPerfEventTest
   : public CgroupsAnyHierarchyTest
 {
@@ -1046,6 +1160,192 @@ TEST_F(CgroupsAnyHierarchyWithPerfEventTest, ROOT_CGROUPS_PERF_PerfTest)
 }
 
 
+TEST_F(CgroupsAnyHierarchyWithPerfEventTest, ROOT_CGROUPS_PerfCounters)
+{
+  int pipes[2];
+  int dummy;
+  ASSERT_NE(-1, ::pipe(pipes));
+
+  string hierarchy = path::join(baseHierarchy, "perf_event");
+  ASSERT_SOME(cgroups::create(hierarchy, TEST_CGROUPS_ROOT));
+
+  // Software events are used as hardware events are commonly not
+  // available in virtual machines.
+  Try<Owned<perf::Counters>> _counters = perf::Counters::create(
+      {"task-clock", "context-switches"},
+      path::join(hierarchy, TEST_CGROUPS_ROOT));
+
+  ASSERT_SOME(_counters);
+
+  Owned<perf::Counters> counters = _counters.get();
+  EXPECT_EQ(0u, counters->size() % 2);
+
+  // Counters which would take more file descriptors than the limit
+  // are not opened.
+  EXPECT_ERROR(perf::Counters::create(
+      {"task-clock", "context-switches"},
+      path::join(hierarchy, TEST_CGROUPS_ROOT),
+      counters->size() - 1));
+
+  EXPECT_SOME(perf::Counters::create(
+      {"task-clock", "context-switches"},
+      path::join(hierarchy, TEST_CGROUPS_ROOT),
+      counters->size()));
+
+  Try<PerfStatistics> before = counters->read();
+  ASSERT_SOME(before);
+  EXPECT_EQ(0.0, before->task_clock());
+
+  pid_t pid = ::fork();
+  ASSERT_NE(-1, pid);
+
+  if (pid == 0) {
+    // In child process.
+    ::close(pipes[1]);
+
+    // Wait until parent has assigned us to the cgroup.
+    ssize_t len;
+    while ((len = ::read(pipes[0], &dummy, sizeof(dummy))) == -1 &&
+           errno == EINTR);
+    ASSERT_EQ((ssize_t) sizeof(dummy), len);
+    ::close(pipes[0]);
+
+    while (true) {
+      // Don't sleep so that the task clock advances.
+    }
+
+    ABORT("Child should not reach here");
+  }
+
+  // In parent.
+  ::close(pipes[0]);
+
+  // Put child into the test cgroup.
+  ASSERT_SOME(cgroups::assign(hierarchy, TEST_CGROUPS_ROOT, pid));
+
+  ssize_t len;
+  while ((len = ::write(pipes[1], &dummy, sizeof(dummy))) == -1 &&
+         errno == EINTR);
+  ASSERT_EQ((ssize_t) sizeof(dummy), len);
+  ::close(pipes[1]);
+
+  os::sleep(Milliseconds(500));
+
+  Try<PerfStatistics> after = counters->read();
+  ASSERT_SOME(after);
+
+  PerfStatistics delta = perf::delta(before.get(), after.get());
+
+  EXPECT_DOUBLE_EQ(
+      before->timestamp() + before->duration(), delta.timestamp());
+  EXPECT_LT(0.0, delta.duration());
+
+  ASSERT_TRUE(delta.has_task_clock());
+  EXPECT_LT(0.0, delta.task_clock());
+  EXPECT_TRUE(delta.has_context_switches());
+
+  // Kill the child process.
+  ASSERT_NE(-1, ::kill(pid, SIGKILL));
+
+  // Wait for the child process.
+  AWAIT_EXPECT_WTERMSIG_EQ(SIGKILL, reap(pid));
+
+  // Close the counters before destroying the cgroup.
+  counters.reset();
+
+  Future<Nothing> destroy = cgroups::destroy(hierarchy, TEST_CGROUPS_ROOT);
+  AWAIT_READY(destroy);
+}
+
+
+class CgroupsAnyHierarchyWithPerfEvent_BENCHMARK_Test
+  : public CgroupsAnyHierarchyWithPerfEventTest {};
+
+
+// This benchmark measures the cost of sampling the perf events of 200
+// containers with in-process counters, and with `perf stat` if the
+// `perf` binary is available.
+TEST_F(CgroupsAnyHierarchyWithPerfEvent_BENCHMARK_Test, ROOT_CGROUPS_Sample)
+{
+  const size_t containers = 200;
+  const size_t rounds = 100;
+
+  string hierarchy = path::join(baseHierarchy, "perf_event");
+  ASSERT_SOME(cgroups::create(hierarchy, TEST_CGROUPS_ROOT));
+
+  set<string> events = {
+    "cycles", "instructions", "cache-references", "cache-misses"};
+
+  // Fall back to software events if there are no hardware counters,
+  // e.g., in a virtual machine.
+  Try<Nothing> supported = perf::Counters::supported(events, hierarchy);
+  if (supported.isError()) {
+    cout << "Hardware events cannot be counted (" << supported.error()
+         << "), using software events" << endl;
+
+    events = {"task-clock", "context-switches", "page-faults"};
+  }
+
+  set<string> cgroups;
+  for (size_t i = 0; i < containers; i++) {
+    string cgroup = path::join(TEST_CGROUPS_ROOT, stringify(i));
+    ASSERT_SOME(cgroups::create(hierarchy, cgroup));
+    cgroups.insert(cgroup);
+  }
+
+  vector<Owned<perf::Counters>> counters;
+
+  Stopwatch watch;
+  watch.start();
+
+  foreach (const string& cgroup, cgroups) {
+    Try<Owned<perf::Counters>> _counters =
+      perf::Counters::create(events, path::join(hierarchy, cgroup));
+
+    ASSERT_SOME(_counters);
+    counters.push_back(_counters.get());
+  }
+
+  watch.stop();
+
+  cout << "Opened " << stringify(events) << " for " << containers
+       << " cgroups in " << watch.elapsed() << endl;
+
+  watch.start();
+
+  for (size_t round = 0; round < rounds; round++) {
+    foreach (const Owned<perf::Counters>& _counters, counters) {
+      ASSERT_SOME(_counters->read());
+    }
+  }
+
+  watch.stop();
+
+  cout << "Read the counters of " << containers << " cgroups in "
+       << watch.elapsed() / rounds << " on average" << endl;
+
+  counters.clear();
+
+  if (perf::supported()) {
+    const Duration duration = Milliseconds(100);
+
+    watch.start();
+
+    Future<hashmap<string, PerfStatistics>> statistics =
+      perf::sample(events, cgroups, duration);
+
+    AWAIT_READY_FOR(statistics, Minutes(1));
+
+    watch.stop();
+
+    cout << "Sampled " << containers << " cgroups with 'perf stat' for "
+         << duration << " in " << watch.elapsed() << endl;
+  }
+
+  AWAIT_READY(cgroups::destroy(hierarchy, TEST_CGROUPS_ROOT));
+}
+
+
 class CgroupsAnyHierarchyMemoryPressureTest
   : public CgroupsAnyHierarchyTest
 {
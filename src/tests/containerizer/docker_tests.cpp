@@ -16,6 +16,8 @@
 
 #include <algorithm>
 #include <list>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -23,12 +25,20 @@
 
 #include <process/future.hpp>
 #include <process/gtest.hpp>
+#include <process/http.hpp>
+#include <process/loop.hpp>
 #include <process/owned.hpp>
+#include <process/socket.hpp>
 #include <process/subprocess.hpp>
 
 #include <stout/duration.hpp>
+#include <stout/foreach.hpp>
+#include <stout/hashmap.hpp>
+#include <stout/json.hpp>
 #include <stout/option.hpp>
 #include <stout/gtest.hpp>
+#include <stout/path.hpp>
+#include <stout/synchronized.hpp>
 
 #include <stout/os/constants.hpp>
 
@@ -44,6 +54,10 @@
 
 using namespace process;
 
+#ifndef __WINDOWS__
+namespace unix = process::network::unix;
+#endif // __WINDOWS__
+
 using std::list;
 using std::string;
 using std::vector;
@@ -1096,6 +1110,240 @@ TEST_F(DockerTest, ROOT_DOCKER_ConflictingVolumeDrivers)
   ASSERT_ERROR(runOptions);
 }
 
+
+#ifndef __WINDOWS__
+// Runs a stand-in for the Docker daemon on a unix domain socket which
+// serves the Docker Engine API endpoints used by `Docker::inspect()`
+// and `Docker::ps()`. The Docker CLI path points to a nonexistent
+// binary so any fallback to the CLI fails the test.
+class DockerAPITest : public TemporaryDirectoryTest
+{
+protected:
+  struct Daemon
+  {
+    std::mutex mutex;
+
+    // Inspect output of the containers keyed by their name.
+    hashmap<string, JSON::Object> containers;
+
+    Option<http::Pipe::Writer> events;
+    Promise<Nothing> subscribed;
+
+    size_t connections = 0;
+    vector<Future<Nothing>> serving;
+  };
+
+  void SetUp() override
+  {
+    TemporaryDirectoryTest::SetUp();
+
+    const string socket = path::join(sandbox.get(), "docker.sock");
+
+    Try<unix::Address> address = unix::Address::create(socket);
+    ASSERT_SOME(address);
+
+    Try<unix::Socket> server = unix::Socket::create();
+    ASSERT_SOME(server);
+    ASSERT_SOME(server->bind(address.get()));
+    ASSERT_SOME(server->listen(16));
+
+    Try<Owned<Docker>> create =
+      Docker::create(path::join(sandbox.get(), "docker"), socket, false);
+
+    ASSERT_SOME(create);
+    docker = create.get();
+
+    std::shared_ptr<Daemon> daemon = this->daemon;
+
+    accepting = loop(
+        None(),
+        [=]() mutable {
+          return server->accept();
+        },
+        [=](const unix::Socket& socket) -> ControlFlow<Nothing> {
+          synchronized (daemon->mutex) {
+            daemon->connections++;
+            daemon->serving.push_back(http::serve(
+                socket,
+                [=](const http::Request& request) {
+                  return handle(daemon, request);
+                }));
+          }
+
+          return Continue();
+        });
+  }
+
+  void TearDown() override
+  {
+    accepting.discard();
+
+    synchronized (daemon->mutex) {
+      if (daemon->events.isSome()) {
+        daemon->events->close();
+      }
+
+      foreach (Future<Nothing> serving, daemon->serving) {
+        serving.discard();
+      }
+    }
+
+    TemporaryDirectoryTest::TearDown();
+  }
+
+  static Future<http::Response> handle(
+      const std::shared_ptr<Daemon>& daemon,
+      const http::Request& request)
+  {
+    const vector<string> tokens = strings::tokenize(request.url.path, "/");
+
+    synchronized (daemon->mutex) {
+      if (request.url.path == "/containers/json") {
+        JSON::Array list;
+        foreachvalue (const JSON::Object& container, daemon->containers) {
+          list.values.push_back(JSON::Object{
+              {"Id", container.values.at("Id")},
+              {"Names", JSON::Array{container.values.at("Name")}}});
+        }
+
+        return http::OK(list);
+      }
+
+      if (tokens.size() == 3 &&
+          tokens[0] == "containers" &&
+          tokens[2] == "json") {
+        foreachpair (const string& name,
+                     const JSON::Object& container,
+                     daemon->containers) {
+          if (tokens[1] == name ||
+              tokens[1] == container.values.at("Id").as<JSON::String>().value) {
+            return http::OK(container);
+          }
+        }
+      }
+
+      if (request.url.path == "/events") {
+        http::Pipe pipe;
+        daemon->events = pipe.writer();
+        daemon->subscribed.set(Nothing());
+
+        http::OK response;
+        response.type = http::Response::PIPE;
+        response.reader = pipe.reader();
+
+        return response;
+      }
+    }
+
+    return http::NotFound();
+  }
+
+  void run(const string& id, const string& name, bool started)
+  {
+    const JSON::Object container{
+      {"Id", id},
+      {"Name", "/" + name},
+      {"State", JSON::Object{
+          {"Pid", started ? 42 : 0},
+          {"StartedAt",
+           started ? "2020-01-01T00:00:00.0Z" : "0001-01-01T00:00:00Z"}}},
+      {"HostConfig", JSON::Object{{"NetworkMode", "bridge"}}},
+      {"NetworkSettings", JSON::Object{
+          {"Networks", JSON::Object{
+              {"bridge", JSON::Object{{"IPAddress", "172.17.0.2"}}}}}}}};
+
+    synchronized (daemon->mutex) {
+      daemon->containers.put(name, container);
+    }
+  }
+
+  Owned<Docker> docker;
+  std::shared_ptr<Daemon> daemon = std::make_shared<Daemon>();
+  Future<Nothing> accepting;
+};
+
+
+// This test verifies that containers are inspected through the
+// Docker Engine API.
+TEST_F(DockerAPITest, Inspect)
+{
+  run("1234", "mesos-1", true);
+
+  Future<Docker::Container> container = docker->inspect("mesos-1");
+
+  AWAIT_READY(container);
+  EXPECT_EQ("1234", container->id);
+  EXPECT_EQ("/mesos-1", container->name);
+  EXPECT_SOME_EQ(42, container->pid);
+  EXPECT_TRUE(container->started);
+  EXPECT_SOME_EQ("172.17.0.2", container->ipAddress);
+
+  AWAIT_FAILED(docker->inspect("mesos-2"));
+}
+
+
+// This test verifies that when waiting for a container to start we
+// inspect it again as soon as the daemon reports that it started
+// rather than after the retry interval.
+TEST_F(DockerAPITest, InspectWaitsForStartEvent)
+{
+  run("1234", "mesos-1", false);
+
+  Future<Docker::Container> container =
+    docker->inspect("mesos-1", Minutes(10));
+
+  AWAIT_READY(daemon->subscribed.future());
+  EXPECT_TRUE(container.isPending());
+
+  run("1234", "mesos-1", true);
+
+  synchronized (daemon->mutex) {
+    ASSERT_SOME(daemon->events);
+    daemon->events->write(
+        "{\"Type\":\"container\",\"Action\":\"start\","
+        "\"Actor\":{\"ID\":\"1234\"}}\n");
+  }
+
+  AWAIT_READY(container);
+  EXPECT_TRUE(container->started);
+  EXPECT_SOME_EQ(42, container->pid);
+
+  run("5678", "mesos-2", false);
+
+  container = docker->inspect("mesos-2", Minutes(10));
+  container.discard();
+
+  AWAIT_DISCARDED(container);
+}
+
+
+// This test verifies that 'ps' lists and inspects all containers
+// over a single connection to the daemon.
+TEST_F(DockerAPITest, Ps)
+{
+  run("1", "mesos-1", true);
+  run("2", "mesos-2", false);
+  run("3", "other", true);
+
+  Future<vector<Docker::Container>> containers = docker->ps(true, "mesos-");
+
+  AWAIT_READY(containers);
+  ASSERT_EQ(2u, containers->size());
+
+  vector<string> names;
+  foreach (const Docker::Container& container, containers.get()) {
+    names.push_back(container.name);
+  }
+
+  std::sort(names.begin(), names.end());
+  EXPECT_EQ((vector<string>{"/mesos-1", "/mesos-2"}), names);
+
+  synchronized (daemon->mutex) {
+    EXPECT_EQ(1u, daemon->connections);
+  }
+}
+#endif // __WINDOWS__
+
 } // namespace tests {
 } // namespace internal {
 } // namespace mesos {
@@ -14,6 +14,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <iostream>
 #include <list>
 #include <map>
 #include <string>
@@ -26,12 +27,15 @@
 
 #include <mesos/slave/isolator.hpp>
 
+#include <process/after.hpp>
+#include <process/collect.hpp>
 #include <process/future.hpp>
 #include <process/owned.hpp>
 #include <process/shared.hpp>
 
 #include <stout/net.hpp>
 #include <stout/path.hpp>
+#include <stout/stopwatch.hpp>
 #include <stout/strings.hpp>
 #include <stout/uuid.hpp>
 
@@ -86,6 +90,8 @@ using mesos::slave::ContainerState;
 using mesos::slave::ContainerTermination;
 using mesos::slave::Isolator;
 
+using std::cout;
+using std::endl;
 using std::list;
 using std::map;
 using std::string;
@@ -95,6 +101,7 @@ using testing::_;
 using testing::DoAll;
 using testing::Invoke;
 using testing::Return;
+using testing::WithParamInterface;
 
 namespace mesos {
 namespace internal {
@@ -584,6 +591,244 @@ TEST_F(MesosContainerizerIsolatorPreparationTest, ExecutorEnvironmentVariable)
 }
 
 
+// A mock isolator which can be prepared concurrently with others.
+class MockParallelIsolator : public MockIsolator
+{
+public:
+  bool supportsParallelPrepare() override { return true; }
+};
+
+
+// Adjacent isolators which support parallel preparation are prepared
+// concurrently, while an isolator that does not is only prepared once
+// all of the isolators before it have been prepared.
+TEST_F(MesosContainerizerIsolatorPreparationTest, ParallelPrepare)
+{
+  slave::Flags flags = CreateSlaveFlags();
+  flags.launcher = "posix";
+
+  Try<Launcher*> launcher_ = SubprocessLauncher::create(flags);
+  ASSERT_SOME(launcher_);
+
+  Owned<Launcher> launcher(launcher_.get());
+
+  MockParallelIsolator* isolator1 = new MockParallelIsolator();
+  MockParallelIsolator* isolator2 = new MockParallelIsolator();
+  MockIsolator* isolator3 = new MockIsolator();
+
+  Future<Nothing> prepare1;
+  Future<Nothing> prepare2;
+  Future<Nothing> prepare3;
+  Promise<Option<ContainerLaunchInfo>> promise1;
+  Promise<Option<ContainerLaunchInfo>> promise2;
+
+  EXPECT_CALL(*isolator1, prepare(_, _))
+    .WillOnce(DoAll(FutureSatisfy(&prepare1),
+                    Return(promise1.future())));
+
+  EXPECT_CALL(*isolator2, prepare(_, _))
+    .WillOnce(DoAll(FutureSatisfy(&prepare2),
+                    Return(promise2.future())));
+
+  EXPECT_CALL(*isolator3, prepare(_, _))
+    .WillOnce(DoAll(FutureSatisfy(&prepare3),
+                    Return(None())));
+
+  Fetcher fetcher(flags);
+
+  Try<Owned<Provisioner>> provisioner = Provisioner::create(flags);
+  ASSERT_SOME(provisioner);
+
+  Try<MesosContainerizer*> _containerizer = MesosContainerizer::create(
+      flags,
+      true,
+      &fetcher,
+      nullptr,
+      launcher,
+      provisioner->share(),
+      {Owned<Isolator>(isolator1),
+       Owned<Isolator>(isolator2),
+       Owned<Isolator>(isolator3)});
+
+  ASSERT_SOME(_containerizer);
+
+  Owned<MesosContainerizer> containerizer(_containerizer.get());
+
+  ContainerID containerId;
+  containerId.set_value(id::UUID::random().toString());
+
+  // The first and the second environment variables are set by the
+  // isolators in the reverse order in which they are prepared, so the
+  // executor only succeeds if the launch infos are merged in the
+  // order of the isolators.
+  ContainerLaunchInfo launchInfo1;
+  mesos::Environment::Variable* variable =
+    launchInfo1.mutable_environment()->add_variables();
+  variable->set_name("TEST_ENVIRONMENT");
+  variable->set_value("first");
+
+  ContainerLaunchInfo launchInfo2;
+  variable = launchInfo2.mutable_environment()->add_variables();
+  variable->set_name("TEST_ENVIRONMENT");
+  variable->set_value("second");
+
+  Future<Containerizer::LaunchResult> launch = containerizer->launch(
+      containerId,
+      createContainerConfig(
+          None(),
+          createExecutorInfo(
+              "executor", "test \"$TEST_ENVIRONMENT\" = second"),
+          sandbox.get()),
+      map<string, string>(),
+      None());
+
+  // Both parallel isolators are being prepared at the same time.
+  AWAIT_READY(prepare1);
+  AWAIT_READY(prepare2);
+
+  EXPECT_TRUE(prepare3.isPending());
+
+  Option<ContainerLaunchInfo> option = launchInfo2;
+  promise2.set(option);
+
+  // Settle the clock to ensure that the third isolator is not
+  // prepared until the first one has completed as well.
+  Clock::pause();
+  Clock::settle();
+  Clock::resume();
+
+  EXPECT_TRUE(prepare3.isPending());
+
+  option = launchInfo1;
+  promise1.set(option);
+
+  AWAIT_READY(prepare3);
+
+  AWAIT_ASSERT_EQ(Containerizer::LaunchResult::SUCCESS, launch);
+
+  Future<Option<ContainerTermination>> wait = containerizer->wait(containerId);
+
+  AWAIT_READY(wait);
+  ASSERT_SOME(wait.get());
+
+  EXPECT_TRUE(wait->get().has_status());
+  EXPECT_EQ(0, wait->get().status());
+}
+
+
+// An isolator that takes a fixed amount of time to prepare a
+// container, which is used to simulate an isolator that needs to talk
+// to the kernel or to an external component.
+class SlowIsolator : public Isolator
+{
+public:
+  SlowIsolator(const Duration& _latency, bool _parallel)
+    : latency(_latency), parallel(_parallel) {}
+
+  bool supportsParallelPrepare() override { return parallel; }
+
+  Future<Option<ContainerLaunchInfo>> prepare(
+      const ContainerID& containerId,
+      const ContainerConfig& containerConfig) override
+  {
+    return after(latency)
+      .then([]() -> Option<ContainerLaunchInfo> { return None(); });
+  }
+
+private:
+  const Duration latency;
+  const bool parallel;
+};
+
+
+class MesosContainerizer_BENCHMARK_Test
+  : public MesosTest,
+    public WithParamInterface<size_t> {};
+
+
+INSTANTIATE_TEST_CASE_P(
+    Containers,
+    MesosContainerizer_BENCHMARK_Test,
+    ::testing::Values(10U, 100U));
+
+
+// This benchmark measures how long it takes for a number of concurrently
+// launched containers to be running, when their isolators are prepared
+// one after another and when they are prepared concurrently.
+TEST_P(MesosContainerizer_BENCHMARK_Test, ConcurrentLaunch)
+{
+  const size_t containerCount = GetParam();
+  const size_t isolatorCount = 4;
+  const Duration latency = Milliseconds(50);
+
+  foreach (bool parallel, vector<bool>({false, true})) {
+    slave::Flags flags = CreateSlaveFlags();
+    flags.launcher = "posix";
+
+    Try<Launcher*> launcher = SubprocessLauncher::create(flags);
+    ASSERT_SOME(launcher);
+
+    vector<Owned<Isolator>> isolators;
+    for (size_t i = 0; i < isolatorCount; i++) {
+      isolators.push_back(Owned<Isolator>(new SlowIsolator(latency, parallel)));
+    }
+
+    Fetcher fetcher(flags);
+
+    Try<Owned<Provisioner>> provisioner = Provisioner::create(flags);
+    ASSERT_SOME(provisioner);
+
+    Try<MesosContainerizer*> _containerizer = MesosContainerizer::create(
+        flags,
+        true,
+        &fetcher,
+        nullptr,
+        Owned<Launcher>(launcher.get()),
+        provisioner->share(),
+        isolators);
+
+    ASSERT_SOME(_containerizer);
+
+    Owned<MesosContainerizer> containerizer(_containerizer.get());
+
+    vector<ContainerID> containerIds;
+    vector<Future<Containerizer::LaunchResult>> launches;
+
+    Stopwatch watch;
+    watch.start();
+
+    for (size_t i = 0; i < containerCount; i++) {
+      ContainerID containerId;
+      containerId.set_value(id::UUID::random().toString());
+
+      const string directory = path::join(sandbox.get(), stringify(i));
+      ASSERT_SOME(os::mkdir(directory));
+
+      launches.push_back(containerizer->launch(
+          containerId,
+          createContainerConfig(
+              None(),
+              createExecutorInfo("executor", "sleep 1000"),
+              directory),
+          map<string, string>(),
+          None()));
+
+      containerIds.push_back(containerId);
+    }
+
+    AWAIT_READY_FOR(collect(launches), Minutes(5));
+
+    cout << "Launched " << containerCount << " containers with "
+         << isolatorCount << (parallel ? " parallel" : " sequential")
+         << " isolators in " << watch.elapsed() << endl;
+
+    foreach (const ContainerID& containerId, containerIds) {
+      AWAIT_READY(containerizer->destroy(containerId));
+    }
+  }
+}
+
+
 class MesosContainerizerExecuteTest : public MesosTest {};
 
 
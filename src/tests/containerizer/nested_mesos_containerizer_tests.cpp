@@ -17,21 +17,27 @@
 #include <sys/stat.h>
 #include <sys/wait.h>
 
+#include <iostream>
 #include <map>
+#include <set>
 #include <sstream>
 #include <string>
+#include <tuple>
 #include <vector>
 
 #include <gmock/gmock.h>
 
+#include <stout/bytes.hpp>
 #include <stout/gtest.hpp>
 #include <stout/none.hpp>
 #include <stout/option.hpp>
 #include <stout/os.hpp>
+#include <stout/stopwatch.hpp>
 #include <stout/try.hpp>
 
 #include <stout/os/exists.hpp>
 #include <stout/os/kill.hpp>
+#include <stout/os/shell.hpp>
 
 #include <process/future.hpp>
 #include <process/gtest.hpp>
@@ -52,6 +58,8 @@
 
 using mesos::internal::slave::Containerizer;
 using mesos::internal::slave::Fetcher;
+using mesos::internal::slave::Launcher;
+using mesos::internal::slave::LinuxLauncher;
 using mesos::internal::slave::MesosContainerizer;
 using mesos::internal::slave::containerizer::paths::getCgroupPath;
 using mesos::internal::slave::containerizer::paths::getContainerConfig;
@@ -71,15 +79,20 @@ using mesos::internal::slave::state::SlaveState;
 using mesos::master::detector::MasterDetector;
 
 using mesos::slave::ContainerClass;
+using mesos::slave::ContainerIO;
 using mesos::slave::ContainerState;
 using mesos::slave::ContainerTermination;
 
 using process::Future;
 using process::Owned;
 
+using std::cout;
+using std::endl;
 using std::map;
 using std::ostringstream;
+using std::set;
 using std::string;
+using std::tuple;
 using std::vector;
 
 namespace mesos {
@@ -3202,6 +3215,175 @@ TEST_F(NestedMesosContainerizerTest,
   AWAIT_FAILED(remove);
 }
 
+
+// This test verifies that containers cloned by the zygote of the Linux
+// launcher are placed into their cgroups, and that the exit status of a
+// nested container, which is cloned in the namespaces of its parent, is
+// reported as usual.
+TEST_F(NestedMesosContainerizerTest, ROOT_CGROUPS_LaunchNestedThroughZygote)
+{
+  slave::Flags flags = CreateSlaveFlags();
+  flags.launcher = "linux";
+  flags.launcher_zygote = true;
+  flags.isolation = "cgroups/cpu,filesystem/linux,namespaces/pid";
+
+  Fetcher fetcher(flags);
+
+  Try<MesosContainerizer*> create = MesosContainerizer::create(
+      flags,
+      false,
+      &fetcher);
+
+  ASSERT_SOME(create);
+
+  Owned<MesosContainerizer> containerizer(create.get());
+
+  SlaveState state;
+  state.id = SlaveID();
+
+  AWAIT_READY(containerizer->recover(state));
+
+  ContainerID containerId;
+  containerId.set_value(id::UUID::random().toString());
+
+  Try<string> directory = environment->mkdtemp();
+  ASSERT_SOME(directory);
+
+  Future<Containerizer::LaunchResult> launch = containerizer->launch(
+      containerId,
+      createContainerConfig(
+          None(),
+          createExecutorInfo("executor", "sleep 1000", "cpus:1"),
+          directory.get()),
+      map<string, string>(),
+      None());
+
+  AWAIT_ASSERT_EQ(Containerizer::LaunchResult::SUCCESS, launch);
+
+  Future<ContainerStatus> status = containerizer->status(containerId);
+  AWAIT_READY(status);
+  ASSERT_TRUE(status->has_executor_pid());
+
+  pid_t pid = status->executor_pid();
+
+  // The container was not cloned by the agent.
+  Result<os::Process> process = os::process(pid);
+  ASSERT_SOME(process);
+  EXPECT_NE(::getpid(), process->parent);
+
+  Result<string> freezerHierarchy = cgroups::hierarchy("freezer");
+  ASSERT_SOME(freezerHierarchy);
+
+  Try<set<pid_t>> pids = cgroups::processes(
+      freezerHierarchy.get(),
+      getCgroupPath(flags.cgroups_root, containerId));
+
+  ASSERT_SOME(pids);
+  EXPECT_EQ(1u, pids->count(pid));
+
+  ContainerID nestedContainerId;
+  nestedContainerId.mutable_parent()->CopyFrom(containerId);
+  nestedContainerId.set_value(id::UUID::random().toString());
+
+  launch = containerizer->launch(
+      nestedContainerId,
+      createNestedContainerConfig("cpus:0.1", createCommandInfo("exit 42")),
+      map<string, string>(),
+      None());
+
+  AWAIT_ASSERT_EQ(Containerizer::LaunchResult::SUCCESS, launch);
+
+  Future<Option<ContainerTermination>> wait = containerizer->wait(
+      nestedContainerId);
+
+  AWAIT_READY(wait);
+  ASSERT_SOME(wait.get());
+  ASSERT_TRUE(wait.get()->has_status());
+  EXPECT_WEXITSTATUS_EQ(42, wait.get()->status());
+
+  Future<Option<ContainerTermination>> termination =
+    containerizer->destroy(containerId);
+
+  AWAIT_READY(termination);
+  ASSERT_SOME(termination.get());
+  ASSERT_TRUE(termination.get()->has_status());
+  EXPECT_WTERMSIG_EQ(SIGKILL, termination.get()->status());
+}
+
+
+class LinuxLauncher_BENCHMARK_Test
+  : public MesosTest,
+    public ::testing::WithParamInterface<tuple<Bytes, bool>> {};
+
+
+INSTANTIATE_TEST_CASE_P(
+    AgentMemoryAndZygote,
+    LinuxLauncher_BENCHMARK_Test,
+    ::testing::Values(
+        std::make_tuple(Bytes(0), false),
+        std::make_tuple(Bytes(0), true),
+        std::make_tuple(Gigabytes(2), false),
+        std::make_tuple(Gigabytes(2), true)));
+
+
+// This benchmark measures how long it takes the Linux launcher to
+// launch processes, either by cloning the agent or through the zygote,
+// while the agent (i.e., this test) holds a given amount of memory.
+TEST_P(LinuxLauncher_BENCHMARK_Test, ROOT_CGROUPS_Fork)
+{
+  Bytes memory;
+  bool zygote;
+
+  std::tie(memory, zygote) = GetParam();
+
+  const size_t processCount = 100;
+
+  // Touch every page, so that they are all mapped when we clone.
+  vector<char> ballast(memory.bytes(), 1);
+
+  slave::Flags flags = CreateSlaveFlags();
+  flags.launcher = "linux";
+  flags.launcher_zygote = zygote;
+
+  Try<Launcher*> _launcher = LinuxLauncher::create(flags);
+  ASSERT_SOME(_launcher);
+
+  Owned<Launcher> launcher(_launcher.get());
+
+  vector<ContainerID> containerIds;
+
+  Stopwatch watch;
+  watch.start();
+
+  for (size_t i = 0; i < processCount; i++) {
+    ContainerID containerId;
+    containerId.set_value(id::UUID::random().toString());
+
+    Try<pid_t> pid = launcher->fork(
+        containerId,
+        os::Shell::name,
+        {os::Shell::arg0, os::Shell::arg1, "sleep 1000"},
+        ContainerIO(),
+        nullptr,
+        None(),
+        None(),
+        None(),
+        {});
+
+    ASSERT_SOME(pid);
+
+    containerIds.push_back(containerId);
+  }
+
+  cout << "Launched " << processCount << " processes "
+       << (zygote ? "through the zygote" : "from the agent") << " with "
+       << memory << " of agent memory in " << watch.elapsed() << endl;
+
+  foreach (const ContainerID& containerId, containerIds) {
+    AWAIT_READY(launcher->destroy(containerId));
+  }
+}
+
 } // namespace tests {
 } // namespace internal {
 } // namespace mesos {
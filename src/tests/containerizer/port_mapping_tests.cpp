@@ -93,6 +93,8 @@ using mesos::slave::ContainerLaunchInfo;
 using mesos::slave::ContainerTermination;
 using mesos::slave::Isolator;
 
+using std::cout;
+using std::endl;
 using std::list;
 using std::ostringstream;
 using std::set;
@@ -102,6 +104,7 @@ using std::vector;
 using testing::_;
 using testing::Eq;
 using testing::Return;
+using testing::WithParamInterface;
 
 namespace mesos {
 namespace internal {
@@ -1895,6 +1898,120 @@ TEST_F(PortMappingIsolatorTest, ROOT_CleanupNotIsolated)
 }
 
 
+class PortMappingIsolator_BENCHMARK_Test
+  : public PortMappingIsolatorTest,
+    public WithParamInterface<size_t> {};
+
+
+// The number of non-ephemeral port ranges of the container.
+INSTANTIATE_TEST_CASE_P(
+    PortRanges,
+    PortMappingIsolator_BENCHMARK_Test,
+    ::testing::Values(1U, 32U, 256U));
+
+
+// Measures how long it takes to set up, update and clean up the IP
+// packet filters of a container using many non-ephemeral port ranges.
+TEST_P(PortMappingIsolator_BENCHMARK_Test, ROOT_ManyPortRanges)
+{
+  const size_t count = GetParam();
+
+  // Use single ports which are not adjacent to each other so that
+  // each of them ends up in its own port range.
+  vector<string> ranges;
+  for (size_t i = 0; i < count; i++) {
+    const string port = stringify(31000 + 2 * i);
+    ranges.push_back(port + "-" + port);
+  }
+
+  Try<Resources> resources =
+    Resources::parse("ports:[" + strings::join(",", ranges) + "]");
+
+  ASSERT_SOME(resources);
+
+  // Drop every other port range upon update.
+  ranges.resize((count + 1) / 2);
+
+  Try<Resources> updatedResources =
+    Resources::parse("ports:[" + strings::join(",", ranges) + "]");
+
+  ASSERT_SOME(updatedResources);
+
+  Try<Isolator*> _isolator = PortMappingIsolatorProcess::create(flags);
+  ASSERT_SOME(_isolator);
+  Owned<Isolator> isolator(_isolator.get());
+
+  Try<Launcher*> _launcher = LinuxLauncher::create(flags);
+  ASSERT_SOME(_launcher);
+  Owned<Launcher> launcher(_launcher.get());
+
+  ExecutorInfo executorInfo;
+  executorInfo.mutable_resources()->CopyFrom(resources.get());
+
+  ContainerID containerId;
+  containerId.set_value(id::UUID::random().toString());
+
+  Try<string> dir = os::mkdtemp(path::join(os::getcwd(), "XXXXXX"));
+  ASSERT_SOME(dir);
+
+  ContainerConfig containerConfig;
+  containerConfig.mutable_executor_info()->CopyFrom(executorInfo);
+  containerConfig.set_directory(dir.get());
+
+  Future<Option<ContainerLaunchInfo>> launchInfo =
+    isolator->prepare(containerId, containerConfig);
+
+  AWAIT_READY(launchInfo);
+  ASSERT_SOME(launchInfo.get());
+
+  int pipes[2];
+  ASSERT_NE(-1, ::pipe(pipes));
+
+  Try<pid_t> pid = launchHelper(
+      launcher.get(),
+      pipes,
+      containerId,
+      "sleep 1000",
+      launchInfo.get());
+
+  ASSERT_SOME(pid);
+
+  // Reap the forked child.
+  Future<Option<int>> status = process::reap(pid.get());
+
+  ::close(pipes[0]);
+
+  Stopwatch watch;
+  watch.start();
+
+  AWAIT_READY(isolator->isolate(containerId, pid.get()));
+
+  cout << "Isolating a container with " << count << " port ranges took "
+       << watch.elapsed() << endl;
+
+  // Now signal the child to continue.
+  char dummy;
+  ASSERT_LT(0, ::write(pipes[1], &dummy, sizeof(dummy)));
+  ::close(pipes[1]);
+
+  watch.start();
+
+  AWAIT_READY(isolator->update(containerId, updatedResources.get()));
+
+  cout << "Updating the container to " << ranges.size()
+       << " port ranges took " << watch.elapsed() << endl;
+
+  AWAIT_READY(launcher->destroy(containerId));
+  AWAIT_READY(status);
+
+  watch.start();
+
+  AWAIT_READY(isolator->cleanup(containerId));
+
+  cout << "Cleaning up the container took " << watch.elapsed() << endl;
+}
+
+
 class PortMappingMesosTest : public ContainerizerTest<MesosContainerizer>
 {
 public:
@@ -1410,6 +1410,68 @@ TEST_F(RoutingVethTest, ROOT_HandleGeneration)
   EXPECT_SOME_TRUE(ip::remove(TEST_VETH_LINK, ingress::HANDLE, classifier2));
 }
 
+// Tests that IP packet filters created and removed in a batch get
+// distinct handles and can be individually found and removed.
+TEST_F(RoutingVethTest, ROOT_IPFilterBatch)
+{
+  ASSERT_SOME(link::veth::create(TEST_VETH_LINK, TEST_PEER_LINK, None()));
+
+  EXPECT_SOME_TRUE(link::exists(TEST_VETH_LINK));
+  EXPECT_SOME_TRUE(link::exists(TEST_PEER_LINK));
+
+  ASSERT_SOME_TRUE(ingress::create(TEST_VETH_LINK));
+
+  net::IP ip = net::IP(0x01020304); // 1.2.3.4
+
+  vector<ip::Classifier> classifiers;
+  vector<Filter<ip::Classifier>> filters;
+
+  // Use two priorities so that the batch has to learn the handle
+  // chosen by the kernel for each of them.
+  for (uint16_t port = 1024; port < 1024 + 200; port++) {
+    Try<ip::PortRange> sourcePorts = ip::PortRange::fromBeginEnd(port, port);
+    ASSERT_SOME(sourcePorts);
+
+    ip::Classifier classifier(None(), ip, sourcePorts.get(), None());
+    classifiers.push_back(classifier);
+
+    filters.push_back(Filter<ip::Classifier>(
+        ingress::HANDLE,
+        classifier,
+        Priority(2, port % 2 == 0 ? 1 : 2),
+        None(),
+        None(),
+        action::Redirect(TEST_PEER_LINK)));
+  }
+
+  EXPECT_SOME_TRUE(ip::create(TEST_VETH_LINK, filters));
+
+  // Creating any of the filters again should fail as a whole.
+  EXPECT_SOME_FALSE(ip::create(
+      TEST_VETH_LINK,
+      vector<Filter<ip::Classifier>>({filters.back()})));
+
+  Result<vector<ip::Classifier>> _classifiers =
+    ip::classifiers(TEST_VETH_LINK, ingress::HANDLE);
+
+  ASSERT_SOME(_classifiers);
+  EXPECT_EQ(classifiers.size(), _classifiers->size());
+
+  // If two filters ended up with the same handle, removing one of
+  // them would remove the other one as well.
+  EXPECT_SOME_TRUE(
+      ip::remove(TEST_VETH_LINK, ingress::HANDLE, classifiers.front()));
+
+  EXPECT_SOME_EQ(
+      classifiers.size() - 1,
+      ip::remove(TEST_VETH_LINK, ingress::HANDLE, classifiers));
+
+  _classifiers = ip::classifiers(TEST_VETH_LINK, ingress::HANDLE);
+
+  ASSERT_SOME(_classifiers);
+  EXPECT_TRUE(_classifiers->empty());
+}
+
 } // namespace tests {
 } // namespace internal {
 } // namespace mesos {
@@ -60,6 +60,7 @@
 
 #ifdef __linux__
 #include "linux/cgroups.hpp"
+#include "linux/cgroups2.hpp"
 #include "linux/fs.hpp"
 #include "linux/perf.hpp"
 #endif
@@ -194,6 +195,12 @@ public:
 
   bool disable(const ::testing::TestInfo* test) const override
   {
+    // NOTE: Tests of the unified hierarchy are handled by
+    // 'Cgroups2Filter' below.
+    if (matches(test, "CGROUPS2_")) {
+      return false;
+    }
+
     if (matches(test, "CGROUPS_") || matches(test, "Cgroups")) {
 #ifdef __linux__
       Result<string> user = os::user();
@@ -219,6 +226,30 @@ private:
 };
 
 
+// This filter enables tests for the cgroup v2 unified hierarchy (see
+// the 'cgroups2/all' isolator) only if a cgroup2 file system is mounted
+// and the tests are run as root.
+class Cgroups2Filter : public TestFilter
+{
+public:
+  bool disable(const ::testing::TestInfo* test) const override
+  {
+    if (matches(test, "CGROUPS2_")) {
+#ifdef __linux__
+      Result<string> user = os::user();
+      CHECK_SOME(user);
+
+      return user.get() != "root" || !cgroups2::enabled();
+#else
+      return true;
+#endif // __linux__
+    }
+
+    return false;
+  }
+};
+
+
 class CurlFilter : public TestFilter
 {
 public:
@@ -1103,6 +1134,7 @@ Environment::Environment(const Flags& _flags)
             std::make_shared<BenchmarkFilter>(),
             std::make_shared<CfsFilter>(),
             std::make_shared<CgroupsFilter>(),
+            std::make_shared<Cgroups2Filter>(),
             std::make_shared<CurlFilter>(),
             std::make_shared<DockerFilter>(),
             std::make_shared<DtypeFilter>(),
@@ -14,9 +14,11 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <iostream>
 #include <list>
 #include <map>
 #include <string>
+#include <tuple>
 #include <vector>
 
 #include <gmock/gmock.h>
@@ -41,10 +43,12 @@
 #include <process/timeout.hpp>
 
 #include <stout/duration.hpp>
+#include <stout/fs.hpp>
 #include <stout/gtest.hpp>
 #include <stout/nothing.hpp>
 #include <stout/os.hpp>
 #include <stout/path.hpp>
+#include <stout/stopwatch.hpp>
 
 #include <stout/os/realpath.hpp>
 
@@ -83,9 +87,14 @@ using process::Owned;
 using process::PID;
 using process::Timeout;
 
+using std::cout;
+using std::endl;
 using std::list;
+using std::make_tuple;
 using std::map;
 using std::string;
+using std::tie;
+using std::tuple;
 using std::vector;
 
 using testing::_;
@@ -94,6 +103,7 @@ using testing::AtMost;
 using testing::DoAll;
 using testing::Return;
 using testing::SaveArg;
+using testing::WithParamInterface;
 
 namespace mesos {
 namespace internal {
@@ -302,6 +312,78 @@ TEST_F(GarbageCollectorTest, Prune)
 }
 
 
+// This test verifies that the deletion of the paths left in the trash
+// is resumed, and that symbolic links are not followed.
+TEST_F(GarbageCollectorTest, Trash)
+{
+  const string trash = path::join("work_dir", "gc_trash");
+  const string leftover = path::join(trash, "leftover");
+
+  ASSERT_SOME(os::mkdir(path::join(leftover, "nested")));
+  ASSERT_SOME(os::touch(path::join(leftover, "nested", "file")));
+  ASSERT_SOME(os::touch("target"));
+  ASSERT_SOME(::fs::symlink(
+      path::join(os::getcwd(), "target"),
+      path::join(leftover, "link")));
+
+  GarbageCollector gc("work_dir");
+
+  Timeout timeout = Timeout::in(process::TEST_AWAIT_TIMEOUT);
+  while (os::exists(leftover) && !timeout.expired()) {
+    os::sleep(Milliseconds(10));
+  }
+
+  EXPECT_FALSE(os::exists(leftover));
+  EXPECT_TRUE(os::exists("target"));
+}
+
+
+// This test verifies that `maxUnlinksPerSecond` limits the rate at
+// which the files are deleted, and that the scheduled path is freed
+// before its deletion completes.
+TEST_F(GarbageCollectorTest, MaxUnlinksPerSecond)
+{
+  Clock::pause();
+
+  GarbageCollector gc("work_dir", 1, 100);
+
+  // The sandbox and its files make for 151 deletions.
+  const string sandbox = "sandbox";
+  ASSERT_SOME(os::mkdir(sandbox));
+
+  for (int i = 0; i < 150; i++) {
+    ASSERT_SOME(os::touch(path::join(sandbox, stringify(i))));
+  }
+
+  Future<Nothing> schedule = gc.schedule(Seconds(0), sandbox);
+
+  Clock::settle();
+
+  AWAIT_READY(schedule);
+  EXPECT_FALSE(os::exists(sandbox));
+
+  // Only the first 100 deletions are allowed right away.
+  const string trash = path::join("work_dir", "gc_trash");
+
+  Try<list<string>> entries = os::ls(trash);
+  ASSERT_SOME(entries);
+  ASSERT_EQ(1u, entries->size());
+
+  Try<list<string>> files = os::ls(path::join(trash, entries->front()));
+  ASSERT_SOME(files);
+  EXPECT_EQ(50u, files->size());
+
+  Clock::advance(Seconds(1));
+  Clock::settle();
+
+  entries = os::ls(trash);
+  ASSERT_SOME(entries);
+  EXPECT_TRUE(entries->empty());
+
+  Clock::resume();
+}
+
+
 class GarbageCollectorIntegrationTest : public MesosTest {};
 
 
@@ -1655,6 +1737,79 @@ TEST_F(GarbageCollectorIntegrationTest, ROOT_OrphanContainer)
 }
 #endif // __linux__
 
+class GarbageCollector_BENCHMARK_Test
+  : public TemporaryDirectoryTest,
+    public WithParamInterface<tuple<size_t, size_t, size_t>> {};
+
+
+INSTANTIATE_TEST_CASE_P(
+    SandboxesFilesParallelism,
+    GarbageCollector_BENCHMARK_Test,
+    ::testing::Values(
+        make_tuple(1000, 1000, 1),
+        make_tuple(1000, 1000, 4),
+        make_tuple(10000, 1000, 1),
+        make_tuple(10000, 1000, 4),
+        make_tuple(10000, 1000, 16)));
+
+
+// This benchmark measures how long it takes for the garbage collector
+// to free the paths of many sandboxes and to delete them.
+TEST_P(GarbageCollector_BENCHMARK_Test, Sandboxes)
+{
+  size_t sandboxCount;
+  size_t filesPerSandbox;
+  size_t parallelism;
+
+  tie(sandboxCount, filesPerSandbox, parallelism) = GetParam();
+
+  vector<string> sandboxes;
+
+  for (size_t i = 0; i < sandboxCount; i++) {
+    const string sandbox = path::join(os::getcwd(), "sandbox" + stringify(i));
+    ASSERT_SOME(os::mkdir(sandbox));
+
+    for (size_t j = 0; j < filesPerSandbox; j++) {
+      ASSERT_SOME(os::write(path::join(sandbox, stringify(j)), "data"));
+    }
+
+    sandboxes.push_back(sandbox);
+  }
+
+  cout << "Test setup: " << sandboxCount << " sandboxes with "
+       << filesPerSandbox << " files each" << endl;
+
+  const string workDir = path::join(os::getcwd(), "work_dir");
+  GarbageCollector gc(workDir, parallelism);
+
+  Stopwatch watch;
+  watch.start();
+
+  vector<Future<Nothing>> schedules;
+  foreach (const string& sandbox, sandboxes) {
+    schedules.push_back(gc.schedule(Seconds(0), sandbox));
+  }
+
+  AWAIT_READY_FOR(process::collect(schedules), Minutes(10));
+
+  cout << "Freed the paths of " << sandboxCount << " sandboxes in "
+       << watch.elapsed() << endl;
+
+  const string trash = path::join(workDir, "gc_trash");
+
+  Try<list<string>> entries = os::ls(trash);
+  while (entries.isSome() && !entries->empty()) {
+    os::sleep(Milliseconds(10));
+    entries = os::ls(trash);
+  }
+
+  watch.stop();
+
+  cout << "Deleted " << sandboxCount << " sandboxes with " << parallelism
+       << " executors in " << watch.elapsed() << endl;
+}
+
+
 } // namespace tests {
 } // namespace internal {
 } // namespace mesos {
@@ -14,11 +14,15 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <sys/resource.h>
+
 #include <atomic>
+#include <functional>
 #include <limits>
 #include <memory>
 #include <string>
 #include <tuple>
+#include <utility>
 #include <vector>
 
 #include <mesos/resources.hpp>
@@ -34,7 +38,12 @@
 #include <process/protobuf.hpp>
 #include <process/statistics.hpp>
 
+#include <stout/bytes.hpp>
 #include <stout/duration.hpp>
+#include <stout/numify.hpp>
+#include <stout/os.hpp>
+#include <stout/strings.hpp>
+#include <stout/uuid.hpp>
 #include <stout/stopwatch.hpp>
 
 #include "common/protobuf_utils.hpp"
@@ -68,12 +77,16 @@ using std::cout;
 using std::endl;
 using std::make_tuple;
 using std::numeric_limits;
+using std::pair;
 using std::shared_ptr;
 using std::string;
 using std::tie;
 using std::tuple;
 using std::vector;
 
+using testing::_;
+using testing::Invoke;
+using testing::Return;
 using testing::WithParamInterface;
 
 namespace mesos {
@@ -200,8 +213,10 @@ public:
 
   Future<Nothing> reregister()
   {
+    promise.reset(new Promise<Nothing>());
+
     send(masterPid, message);
-    return promise.future();
+    return promise->future();
   }
 
   TestSlaveProcess(const TestSlaveProcess& other) = delete;
@@ -210,7 +225,9 @@ public:
 private:
   void reregistered(const SlaveReregisteredMessage&)
   {
-    promise.set(Nothing());
+    if (promise.get() != nullptr) {
+      promise->set(Nothing());
+    }
   }
 
   // We need to answer pings to keep the agent registered.
@@ -227,7 +244,7 @@ private:
   const size_t tasksPerCompletedFramework;
 
   ReregisterSlaveMessage message;
-  Promise<Nothing> promise;
+  Owned<Promise<Nothing>> promise;
 };
 
 
@@ -356,6 +373,184 @@ TEST_P(MasterFailover_BENCHMARK_Test, AgentReregistrationDelay)
 }
 
 
+// This test measures the rate at which the master processes agent
+// re-registrations after a failover, in agents and tasks per second. After
+// the initial re-registration, all agents reregister again a number of
+// times (as they do when they lose the connection to the master), which
+// exercises the master's handling of re-registrations of known agents.
+TEST_P(MasterFailover_BENCHMARK_Test, AgentReregistrationThroughput)
+{
+  size_t agentCount;
+  size_t frameworksPerAgent;
+  size_t tasksPerFramework;
+  size_t completedFrameworksPerAgent;
+  size_t tasksPerCompletedFramework;
+
+  tie(agentCount,
+      frameworksPerAgent,
+      tasksPerFramework,
+      completedFrameworksPerAgent,
+      tasksPerCompletedFramework) = GetParam();
+
+  const size_t rounds = 3;
+
+  master::Flags masterFlags = CreateMasterFlags();
+  masterFlags.authenticate_agents = false;
+
+  // Use replicated log so it better simulates the production scenario.
+  masterFlags.registry = "replicated_log";
+
+  Try<Owned<cluster::Master>> master = StartMaster(masterFlags);
+  ASSERT_SOME(master);
+
+  vector<Owned<TestSlave>> slaves;
+
+  for (size_t i = 0; i < agentCount; i++) {
+    SlaveID slaveId;
+    slaveId.set_value("agent" + stringify(i));
+
+    slaves.push_back(Owned<TestSlave>(new TestSlave(
+        master.get()->pid,
+        slaveId,
+        frameworksPerAgent,
+        tasksPerFramework,
+        completedFrameworksPerAgent,
+        tasksPerCompletedFramework)));
+  }
+
+  // Make sure all agents are ready to reregister before we start the stopwatch.
+  Clock::pause();
+  Clock::settle();
+  Clock::resume();
+
+  const size_t taskCount =
+    (frameworksPerAgent * tasksPerFramework +
+     completedFrameworksPerAgent * tasksPerCompletedFramework) * agentCount;
+
+  cout << "Test setup: " << agentCount << " agents with a total of "
+       << taskCount << " running and completed tasks" << endl;
+
+  for (size_t round = 0; round <= rounds; round++) {
+    vector<Future<Nothing>> reregistered;
+
+    Stopwatch watch;
+    watch.start();
+
+    foreach (const Owned<TestSlave>& slave, slaves) {
+      reregistered.push_back(slave->reregister());
+    }
+
+    await(reregistered).await();
+
+    watch.stop();
+
+    cout << (round == 0 ? "Initial re-registration" :
+             "Re-registration " + stringify(round))
+         << ": " << agentCount << " agents in " << watch.elapsed() << " ("
+         << agentCount / watch.elapsed().secs() << " agents and "
+         << taskCount / watch.elapsed().secs() << " tasks per second)"
+         << endl;
+  }
+}
+
+
+// Resets the peak resident set size ("VmHWM") of this process to its
+// current resident set size, see proc(5). This requires Linux 4.0+.
+static Try<Nothing> resetPeakRss()
+{
+  return os::write("/proc/self/clear_refs", "5");
+}
+
+
+// Returns the peak resident set size ("VmHWM") of this process.
+static Try<Bytes> peakRss()
+{
+  Try<string> status = os::read("/proc/self/status");
+  if (status.isError()) {
+    return Error(status.error());
+  }
+
+  foreach (const string& line, strings::tokenize(status.get(), "\n")) {
+    // The line looks like: "VmHWM:    123456 kB".
+    vector<string> tokens = strings::tokenize(line, " \t");
+    if (tokens.size() == 3 && tokens[0] == "VmHWM:") {
+      Try<uint64_t> value = numify<uint64_t>(tokens[1]);
+      if (value.isError()) {
+        return Error("Failed to parse '" + line + "': " + value.error());
+      }
+
+      return Kilobytes(value.get());
+    }
+  }
+
+  return Error("No 'VmHWM' in /proc/self/status");
+}
+
+
+// Sends the request and reads the (streamed) response to completion,
+// reporting the time to first byte and the total time. Where the
+// platform allows resetting it, the peak RSS of this process (which
+// includes the master) during the request is reported as well. Note
+// that keeping the `body` contributes to the peak RSS, too.
+static void measure(
+    const string& description,
+    const std::function<Future<http::Response>()>& send,
+    string* body)
+{
+  Try<Nothing> resetPeak = resetPeakRss();
+
+  Stopwatch watch;
+  watch.start();
+
+  Future<http::Response> response = send();
+  response.await();
+
+  ASSERT_TRUE(response.isReady());
+  ASSERT_EQ(http::OK().status, response->status);
+  ASSERT_EQ(http::Response::PIPE, response->type);
+  ASSERT_SOME(response->reader);
+
+  http::Pipe::Reader reader = response->reader.get();
+
+  Option<Duration> firstByte;
+  Bytes size;
+
+  while (true) {
+    Future<string> chunk = reader.read();
+    chunk.await();
+
+    ASSERT_TRUE(chunk.isReady());
+
+    if (chunk->empty()) {
+      break; // EOF.
+    }
+
+    if (firstByte.isNone()) {
+      firstByte = watch.elapsed();
+    }
+
+    size += Bytes(chunk->size());
+
+    if (body != nullptr) {
+      body->append(chunk.get());
+    }
+  }
+
+  watch.stop();
+
+  cout << description << " response took " << watch.elapsed()
+       << " (" << size << ", first byte after "
+       << firstByte.getOrElse(watch.elapsed()) << ")";
+
+  Try<Bytes> peak = peakRss();
+  if (resetPeak.isSome() && peak.isSome()) {
+    cout << ", peak RSS " << peak.get();
+  }
+
+  cout << endl;
+}
+
+
 class MasterStateQuery_BENCHMARK_Test
   : public MesosTest,
     public WithParamInterface<tuple<
@@ -395,6 +590,9 @@ TEST_P(MasterStateQuery_BENCHMARK_Test, GetState)
   master::Flags masterFlags = CreateMasterFlags();
   masterFlags.authenticate_agents = false;
 
+  // Measure the streamed responses, see `measure()`.
+  masterFlags.stream_state_responses = true;
+
   Try<Owned<cluster::Master>> master = StartMaster(masterFlags);
   ASSERT_SOME(master);
 
@@ -433,41 +631,21 @@ TEST_P(MasterStateQuery_BENCHMARK_Test, GetState)
   Clock::settle();
   Clock::resume();
 
-  Stopwatch watch;
-  watch.start();
-
   // We first measure v0 "state" endpoint performance as the baseline.
-  Future<http::Response> v0Response = http::get(
-      master.get()->pid,
-      "state",
-      None(),
-      createBasicAuthHeaders(DEFAULT_CREDENTIAL));
-
-  v0Response.await();
-
-  watch.stop();
-
-  ASSERT_EQ(v0Response->status, http::OK().status);
-
-  cout << "v0 '/state' response took " << watch.elapsed() << endl;
-
-  // Helper function to post a request to '/api/v1' master endpoint
-  // and return the response.
-  auto post = [](
-      const process::PID<master::Master>& pid,
-      const v1::master::Call& call,
-      const ContentType& contentType)
-  {
-    http::Headers headers = createBasicAuthHeaders(DEFAULT_CREDENTIAL);
-    headers["Accept"] = stringify(contentType);
-
-    return http::post(
-        pid,
-        "api/v1",
-        headers,
-        serialize(contentType, call),
-        stringify(contentType));
-  };
+  measure(
+      "v0 '/state'",
+      [&master]() {
+        return http::streaming::get(
+            master.get()->pid,
+            "state",
+            None(),
+            createBasicAuthHeaders(DEFAULT_CREDENTIAL));
+      },
+      nullptr);
+
+  if (HasFatalFailure()) {
+    return;
+  }
 
   // We measure both JSON and protobuf formats.
   const ContentType contentTypes[] =
@@ -477,25 +655,155 @@ TEST_P(MasterStateQuery_BENCHMARK_Test, GetState)
     v1::master::Call v1Call;
     v1Call.set_type(v1::master::Call::GET_STATE);
 
-    watch.start();
-
-    Future<http::Response> response =
-      post(master.get()->pid, v1Call, contentType);
+    string body;
 
-    response.await();
+    measure(
+        "v1 'master::call::GetState' " + stringify(contentType),
+        [&master, &v1Call, contentType]() {
+          http::Headers headers = createBasicAuthHeaders(DEFAULT_CREDENTIAL);
+          headers["Accept"] = stringify(contentType);
 
-    watch.stop();
+          return http::streaming::post(
+              master.get()->pid,
+              "api/v1",
+              headers,
+              serialize(contentType, v1Call),
+              stringify(contentType));
+        },
+        &body);
 
-    ASSERT_EQ(response->status, http::OK().status);
+    if (HasFatalFailure()) {
+      return;
+    }
 
     Future<v1::master::Response> v1Response =
-      deserialize<v1::master::Response>(contentType, response->body);
+      deserialize<v1::master::Response>(contentType, body);
 
     ASSERT_TRUE(v1Response->IsInitialized());
     EXPECT_EQ(v1::master::Response::GET_STATE, v1Response->type());
+  }
+}
 
-    cout << "v1 'master::call::GetState' "
-         << contentType << " response took " << watch.elapsed() << endl;
+
+class MasterTaskQuery_BENCHMARK_Test
+  : public MesosTest,
+    public WithParamInterface<tuple<size_t, size_t, size_t>> {};
+
+
+INSTANTIATE_TEST_CASE_P(
+    AgentFrameworkTaskCount,
+    MasterTaskQuery_BENCHMARK_Test,
+    ::testing::Values(
+        make_tuple(1000, 5, 20),
+        make_tuple(10000, 5, 20),
+        make_tuple(100000, 5, 2),
+        make_tuple(100000, 5, 20)));
+
+
+// This test measures the performance of the `master::call::GetTasks`
+// v1 api when only the task states are requested through a field mask,
+// and when a single page of tasks is requested, against the full output.
+TEST_P(MasterTaskQuery_BENCHMARK_Test, GetTasks)
+{
+  size_t agentCount;
+  size_t frameworksPerAgent;
+  size_t tasksPerFramework;
+
+  tie(agentCount, frameworksPerAgent, tasksPerFramework) = GetParam();
+
+  // Disable authentication to avoid the overhead, since we don't care about
+  // it in this test.
+  master::Flags masterFlags = CreateMasterFlags();
+  masterFlags.authenticate_agents = false;
+
+  // Measure the streamed responses, see `measure()`.
+  masterFlags.stream_state_responses = true;
+
+  Try<Owned<cluster::Master>> master = StartMaster(masterFlags);
+  ASSERT_SOME(master);
+
+  vector<Owned<TestSlave>> slaves;
+
+  for (size_t i = 0; i < agentCount; i++) {
+    SlaveID slaveId;
+    slaveId.set_value("agent" + stringify(i));
+
+    slaves.push_back(Owned<TestSlave>(new TestSlave(
+        master.get()->pid,
+        slaveId,
+        frameworksPerAgent,
+        tasksPerFramework,
+        0,
+        0)));
+  }
+
+  cout << "Test setup: "
+       << agentCount << " agents with a total of "
+       << frameworksPerAgent * tasksPerFramework * agentCount
+       << " running tasks" << endl;
+
+  vector<Future<Nothing>> reregistered;
+
+  foreach (const Owned<TestSlave>& slave, slaves) {
+    reregistered.push_back(slave->reregister());
+  }
+
+  // Wait all agents to finish reregistration.
+  await(reregistered).await();
+
+  Clock::pause();
+  Clock::settle();
+  Clock::resume();
+
+  v1::master::Call full;
+  full.set_type(v1::master::Call::GET_TASKS);
+
+  v1::master::Call masked = full;
+  masked.mutable_get_tasks()->mutable_field_mask()->add_paths("state");
+
+  v1::master::Call page = full;
+  page.mutable_get_tasks()->set_limit(100);
+
+  const vector<pair<string, v1::master::Call>> calls = {
+    {"full", full},
+    {"field mask 'state'", masked},
+    {"limit 100", page}
+  };
+
+  // We measure both JSON and protobuf formats.
+  const ContentType contentTypes[] =
+    { ContentType::PROTOBUF, ContentType::JSON };
+
+  for (ContentType contentType : contentTypes) {
+    foreach (const auto& call, calls) {
+      string body;
+
+      measure(
+          "v1 'master::call::GetTasks' " + call.first + " " +
+            stringify(contentType),
+          [&master, &call, contentType]() {
+            http::Headers headers = createBasicAuthHeaders(DEFAULT_CREDENTIAL);
+            headers["Accept"] = stringify(contentType);
+
+            return http::streaming::post(
+                master.get()->pid,
+                "api/v1",
+                headers,
+                serialize(contentType, call.second),
+                stringify(contentType));
+          },
+          &body);
+
+      if (HasFatalFailure()) {
+        return;
+      }
+
+      Future<v1::master::Response> v1Response =
+        deserialize<v1::master::Response>(contentType, body);
+
+      ASSERT_TRUE(v1Response->IsInitialized());
+      EXPECT_EQ(v1::master::Response::GET_TASKS, v1Response->type());
+    }
   }
 }
 
@@ -713,6 +1021,427 @@ TEST_P(MasterActorResponsiveness_BENCHMARK_Test, WithV0StateLoad)
 }
 
 
+// This test indirectly measures how the Master actor is affected by a
+// scheduler acknowledging a large number of status updates. The same
+// acknowledgements are sent first as individual 'ACKNOWLEDGE' calls and
+// then as 'BATCH' calls, while constantly probing '/health' as the load
+// indicator, similar to the test above.
+TEST_P(MasterActorResponsiveness_BENCHMARK_Test, WithSchedulerAcknowledgeLoad)
+{
+  size_t agentCount;
+  size_t frameworksPerAgent;
+  size_t tasksPerFramework;
+  size_t completedFrameworksPerAgent;
+  size_t tasksPerCompletedFramework;
+  size_t numRequests;
+  size_t numClients;
+
+  tie(agentCount,
+    frameworksPerAgent,
+    tasksPerFramework,
+    completedFrameworksPerAgent,
+    tasksPerCompletedFramework,
+    numRequests,
+    numClients) = GetParam();
+
+  // Number of acknowledgements carried by each 'BATCH' call.
+  const size_t acknowledgementsPerBatch = 100;
+
+  const string indicatorEndpoint = "health";
+
+  // Disable authentication to avoid the overhead, since we don't care about
+  // it in this test.
+  master::Flags masterFlags = CreateMasterFlags();
+  masterFlags.authenticate_agents = false;
+  masterFlags.authenticate_frameworks = false;
+  masterFlags.authenticate_http_frameworks = false;
+
+  Try<Owned<cluster::Master>> master = StartMaster(masterFlags);
+  ASSERT_SOME(master);
+
+  vector<Owned<TestSlave>> slaves;
+
+  for (size_t i = 0; i < agentCount; i++) {
+    SlaveID slaveId;
+    slaveId.set_value("agent" + stringify(i));
+
+    slaves.push_back(Owned<TestSlave>(new TestSlave(
+        master.get()->pid,
+        slaveId,
+        frameworksPerAgent,
+        tasksPerFramework,
+        completedFrameworksPerAgent,
+        tasksPerCompletedFramework)));
+  }
+
+  vector<Future<Nothing>> reregistered;
+
+  foreach (const Owned<TestSlave>& slave, slaves) {
+    reregistered.push_back(slave->reregister());
+  }
+
+  // Wait all agents to finish reregistration.
+  await(reregistered).await();
+
+  auto scheduler = std::make_shared<v1::MockHTTPScheduler>();
+
+  EXPECT_CALL(*scheduler, connected(_))
+    .WillOnce(v1::scheduler::SendSubscribe(v1::DEFAULT_FRAMEWORK_INFO));
+
+  Future<v1::scheduler::Event::Subscribed> subscribed;
+  EXPECT_CALL(*scheduler, subscribed(_, _))
+    .WillOnce(FutureArg<1>(&subscribed));
+
+  // Ignore heartbeats and offers.
+  EXPECT_CALL(*scheduler, heartbeat(_))
+    .WillRepeatedly(Return());
+
+  EXPECT_CALL(*scheduler, offers(_, _))
+    .WillRepeatedly(Return());
+
+  v1::scheduler::TestMesos mesos(
+      master.get()->pid,
+      ContentType::PROTOBUF,
+      scheduler);
+
+  AWAIT_READY(subscribed);
+
+  const v1::FrameworkID frameworkId = subscribed->framework_id();
+
+  // The acknowledged status updates are made up, but as they are for
+  // registered agents the master processes them all the way through and
+  // forwards them to the agents (which then ignore them).
+  auto createAcknowledge = [agentCount](size_t index) {
+    v1::scheduler::Call::Acknowledge acknowledge;
+    acknowledge.mutable_agent_id()->set_value(
+        "agent" + stringify(index % agentCount));
+    acknowledge.mutable_task_id()->set_value("task" + stringify(index));
+    acknowledge.set_uuid(id::UUID::random().toBytes());
+
+    return acknowledge;
+  };
+
+  v1::scheduler::Call acknowledgeCall;
+  acknowledgeCall.set_type(v1::scheduler::Call::ACKNOWLEDGE);
+  *acknowledgeCall.mutable_framework_id() = frameworkId;
+  *acknowledgeCall.mutable_acknowledge() = createAcknowledge(0);
+
+  v1::scheduler::Call batchCall;
+  batchCall.set_type(v1::scheduler::Call::BATCH);
+  *batchCall.mutable_framework_id() = frameworkId;
+
+  for (size_t i = 0; i < acknowledgementsPerBatch; i++) {
+    *batchCall.mutable_batch()->add_acknowledges() = createAcknowledge(i);
+  }
+
+  cout << "Test setup: " << agentCount << " agents with a total of "
+       << frameworksPerAgent * tasksPerFramework * agentCount
+       << " running tasks and "
+       << completedFrameworksPerAgent * tasksPerCompletedFramework * agentCount
+       << " completed tasks" << endl;
+
+  Clock::pause();
+  Clock::settle();
+  Clock::resume();
+
+  // A helper probing the `indicatorEndpoint` and measuring the time it
+  // takes to receive a response.
+  auto indicatorRequest = [master, indicatorEndpoint]() -> Future<Duration> {
+    shared_ptr<Stopwatch> watch(new Stopwatch);
+    watch->start();
+
+    return http::get(master.get()->pid, indicatorEndpoint)
+      .then([watch](const http::Response& r) -> Future<Duration> {
+        watch->stop();
+        EXPECT_EQ(r.status, http::OK().status);
+        return watch->elapsed();
+      });
+  };
+
+  // A helper sending a single scheduler call and measuring the time it
+  // takes for the master to respond.
+  auto schedulerCall = [&mesos](
+      const v1::scheduler::Call& call) -> Future<Duration> {
+    shared_ptr<Stopwatch> watch(new Stopwatch);
+    watch->start();
+
+    return mesos.call(call)
+      .then([watch](const v1::scheduler::APIResult& result)
+          -> Future<Duration> {
+        watch->stop();
+        EXPECT_TRUE(
+            result.status_code() == http::Status::ACCEPTED ||
+            result.status_code() == http::Status::OK);
+        return watch->elapsed();
+      });
+  };
+
+  // Synchronizes completion of all lambdas sending requests.
+  atomic_bool stop = { false };
+
+  // A helper sending `numRequests` requests using `request`. An early exit
+  // is possible if `stop` is set. Note that this lambda sets `stop` once
+  // `numRequests` requests have been sent.
+  auto repeatRequests = [&stop](
+      const std::function<Future<Duration>()>& request,
+      size_t numRequests) -> vector<Duration> {
+    vector<Duration> durations;
+
+    size_t remaining = numRequests;
+    auto f = loop(
+        None(),
+        request,
+        [&remaining, &durations, &stop](
+            const Duration& d) -> ControlFlow<Nothing> {
+          durations.push_back(d);
+
+          if (--remaining <= 0) {
+            stop.store(true);
+          }
+
+          if (stop.load()) {
+            return Break();
+          } else {
+            return Continue();
+          }
+        });
+
+    f.await();
+    EXPECT_TRUE(f.isReady());
+
+    return durations;
+  };
+
+  auto printStats = [](const vector<Duration>& durations) {
+    Option<Statistics<Duration>> s =
+      Statistics<Duration>::from(durations.cbegin(), durations.cend());
+    EXPECT_SOME(s);
+
+    cout << "[" << s->min << ", " << s->p25 << ", " << s->p50 << ", "
+         << s->p75 << ", " << s->p90 << ", " << s->max << "]"
+         << " from " << s->count << " measurements" << endl;
+  };
+
+  const tuple<string, v1::scheduler::Call, size_t> loads[] = {
+    make_tuple("ACKNOWLEDGE", acknowledgeCall, 1),
+    make_tuple("BATCH", batchCall, acknowledgementsPerBatch)
+  };
+
+  for (const tuple<string, v1::scheduler::Call, size_t>& load : loads) {
+    const string& name = std::get<0>(load);
+    const v1::scheduler::Call& call = std::get<1>(load);
+    const size_t acknowledgementsPerCall = std::get<2>(load);
+
+    stop.store(false);
+
+    cout << "Benchmark: " << numClients << " clients each sending up to "
+         << numRequests << " '" << name << "' calls with "
+         << acknowledgementsPerCall << " acknowledgement(s) while probing '/"
+         << indicatorEndpoint << "'" << endl;
+
+    Stopwatch watch;
+    watch.start();
+
+    vector<Future<vector<Duration>>> callsFinished;
+    for (size_t i = 0; i < numClients; i++) {
+      callsFinished.push_back(async(
+          repeatRequests,
+          [schedulerCall, call]() { return schedulerCall(call); },
+          numRequests));
+    }
+
+    Future<vector<Duration>> indicatorFinished = async(
+        repeatRequests, indicatorRequest, numeric_limits<size_t>::max());
+
+    Future<vector<vector<Duration>>> collected = collect(callsFinished);
+    collected.await();
+    CHECK_READY(collected);
+
+    watch.stop();
+
+    indicatorFinished.await();
+    CHECK_READY(indicatorFinished);
+
+    // Aggregate response times for all scheduler clients.
+    vector<Duration> aggregatedCalls;
+    foreach (const vector<Duration>& v, collected.get()) {
+      aggregatedCalls.insert(aggregatedCalls.end(), v.cbegin(), v.cend());
+    }
+
+    const size_t acknowledgements =
+      aggregatedCalls.size() * acknowledgementsPerCall;
+
+    cout << "Processed " << acknowledgements << " acknowledgements in "
+         << watch.elapsed() << " ("
+         << acknowledgements / watch.elapsed().secs() << " per second)"
+         << endl;
+
+    cout << "Results [min, p25, p50, p75, p90, max]: " << endl
+         << "  '/" << indicatorEndpoint << "' -> ";
+    printStats(indicatorFinished.get());
+
+    cout << "  '" << name << "' -> ";
+    printStats(aggregatedCalls);
+
+    Clock::pause();
+    Clock::settle();
+    Clock::resume();
+  }
+}
+
+
+class MasterOffers_BENCHMARK_Test
+  : public MesosTest,
+    public WithParamInterface<size_t> {};
+
+
+INSTANTIATE_TEST_CASE_P(
+    AgentCount,
+    MasterOffers_BENCHMARK_Test,
+    ::testing::Values(1000U, 5000U, 10000U));
+
+
+// This benchmark measures the CPU time spent per allocation cycle with a
+// framework which keeps all offered resources available to itself. Without
+// the OFFER_DELTAS capability such a framework has to decline its offers
+// (with a zero refusal timeout) so that the master sends fresh offers in
+// every allocation cycle. With the capability the framework holds one
+// standing offer per agent, and the master only sends deltas once the
+// offered resources change.
+//
+// NOTE: The measured CPU time is that of the whole test process, i.e., it
+// includes the scheduler library and the fake agents.
+TEST_P(MasterOffers_BENCHMARK_Test, AllocationCycle)
+{
+  const size_t agentCount = GetParam();
+  const size_t cycles = 20;
+
+  master::Flags masterFlags = CreateMasterFlags();
+  masterFlags.authenticate_agents = false;
+  masterFlags.authenticate_frameworks = false;
+  masterFlags.authenticate_http_frameworks = false;
+  masterFlags.allocation_interval = Milliseconds(100);
+
+  Try<Owned<cluster::Master>> master = StartMaster(masterFlags);
+  ASSERT_SOME(master);
+
+  vector<Owned<TestSlave>> slaves;
+
+  for (size_t i = 0; i < agentCount; i++) {
+    SlaveID slaveId;
+    slaveId.set_value("agent" + stringify(i));
+
+    slaves.push_back(Owned<TestSlave>(
+        new TestSlave(master.get()->pid, slaveId, 0, 0, 0, 0)));
+  }
+
+  vector<Future<Nothing>> reregistered;
+
+  foreach (const Owned<TestSlave>& slave, slaves) {
+    reregistered.push_back(slave->reregister());
+  }
+
+  await(reregistered).await();
+
+  cout << "Test setup: " << agentCount << " agents" << endl;
+
+  auto cpuTime = []() {
+    struct rusage usage;
+    CHECK_EQ(0, ::getrusage(RUSAGE_SELF, &usage));
+
+    return Seconds(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) +
+           Microseconds(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec);
+  };
+
+  foreach (bool offerDeltas, vector<bool>({false, true})) {
+    v1::FrameworkInfo frameworkInfo = v1::DEFAULT_FRAMEWORK_INFO;
+
+    if (offerDeltas) {
+      frameworkInfo.add_capabilities()->set_type(
+          v1::FrameworkInfo::Capability::OFFER_DELTAS);
+    }
+
+    auto scheduler = std::make_shared<v1::MockHTTPScheduler>();
+
+    EXPECT_CALL(*scheduler, connected(_))
+      .WillOnce(v1::scheduler::SendSubscribe(frameworkInfo));
+
+    Future<v1::scheduler::Event::Subscribed> subscribed;
+    EXPECT_CALL(*scheduler, subscribed(_, _))
+      .WillOnce(FutureArg<1>(&subscribed));
+
+    EXPECT_CALL(*scheduler, heartbeat(_))
+      .WillRepeatedly(Return());
+
+    std::atomic<size_t> offersReceived(0);
+    std::atomic<size_t> deltasReceived(0);
+
+    EXPECT_CALL(*scheduler, offers(_, _))
+      .WillRepeatedly(Invoke([&](
+          v1::scheduler::Mesos* mesos,
+          const v1::scheduler::Event::Offers& event) {
+        offersReceived += event.offers().size();
+        deltasReceived += event.offer_deltas().size();
+
+        if (offerDeltas || event.offers().empty()) {
+          return;
+        }
+
+        v1::scheduler::Call call;
+        call.set_type(v1::scheduler::Call::DECLINE);
+        *call.mutable_framework_id() = event.offers(0).framework_id();
+
+        v1::scheduler::Call::Decline* decline = call.mutable_decline();
+        decline->mutable_filters()->set_refuse_seconds(0);
+
+        foreach (const v1::Offer& offer, event.offers()) {
+          *decline->add_offer_ids() = offer.id();
+        }
+
+        mesos->send(call);
+      }));
+
+    v1::scheduler::TestMesos mesos(
+        master.get()->pid,
+        ContentType::PROTOBUF,
+        scheduler);
+
+    AWAIT_READY(subscribed);
+
+    // Let the first allocation cycle hand out all resources.
+    os::sleep(masterFlags.allocation_interval * 2);
+
+    offersReceived = 0;
+    deltasReceived = 0;
+
+    const Duration start = cpuTime();
+
+    Stopwatch watch;
+    watch.start();
+
+    os::sleep(masterFlags.allocation_interval * cycles);
+
+    watch.stop();
+
+    const Duration cpu = cpuTime() - start;
+
+    cout << (offerDeltas ? "With" : "Without") << " offer deltas: "
+         << offersReceived.load() << " offers and "
+         << deltasReceived.load() << " deltas received in "
+         << watch.elapsed() << ", using " << cpu << " of CPU time ("
+         << cpu / cycles << " per allocation cycle)" << endl;
+
+    // Tear down the framework before the next run so that its
+    // resources are available again.
+    v1::scheduler::Call teardown;
+    teardown.set_type(v1::scheduler::Call::TEARDOWN);
+    *teardown.mutable_framework_id() = subscribed->framework_id();
+
+    AWAIT_READY(mesos.call(teardown));
+  }
+}
+
+
 class MasterMetricsQuery_BENCHMARK_Test
   : public MesosTest,
     public WithParamInterface<tuple<
@@ -851,6 +1580,97 @@ TEST_P(MasterMetricsQuery_BENCHMARK_Test, GetMetrics)
   }
 }
 
+
+// This test measures the response time of '/metrics/snapshot' while the
+// master actor is busy serving '/state' requests, with and without the
+// master caching the values of its pull gauges. Without the cache, the
+// snapshot has to queue up behind the '/state' requests on the master.
+TEST_P(MasterMetricsQuery_BENCHMARK_Test, GetMetricsUnderLoad)
+{
+  size_t agentCount;
+  size_t activeFrameworkCount;
+  size_t tasksPerActiveFramework;
+  size_t completedFrameworkCount;
+  size_t tasksPerCompletedFramework;
+
+  tie(agentCount,
+    activeFrameworkCount,
+    tasksPerActiveFramework,
+    completedFrameworkCount,
+    tasksPerCompletedFramework) = GetParam();
+
+  const size_t stateRequests = 10;
+
+  const Option<Duration> cacheIntervals[] = { None(), Seconds(1) };
+
+  foreach (const Option<Duration>& cacheInterval, cacheIntervals) {
+    master::Flags masterFlags = CreateMasterFlags();
+    masterFlags.authenticate_agents = false;
+    masterFlags.authenticate_http_readwrite = false;
+    masterFlags.authenticate_http_readonly = false;
+    masterFlags.metrics_cache_interval = cacheInterval;
+
+    Try<Owned<cluster::Master>> master = StartMaster(masterFlags);
+    ASSERT_SOME(master);
+
+    vector<Owned<TestSlave>> slaves;
+
+    for (size_t i = 0; i < agentCount; i++) {
+      SlaveID slaveId;
+      slaveId.set_value("agent" + stringify(i));
+
+      slaves.push_back(Owned<TestSlave>(new TestSlave(
+          master.get()->pid,
+          slaveId,
+          activeFrameworkCount,
+          tasksPerActiveFramework,
+          completedFrameworkCount,
+          tasksPerCompletedFramework)));
+    }
+
+    vector<Future<Nothing>> reregistered;
+
+    foreach (const Owned<TestSlave>& slave, slaves) {
+      reregistered.push_back(slave->reregister());
+    }
+
+    await(reregistered).await();
+
+    Clock::pause();
+    Clock::settle();
+    Clock::resume();
+
+    UPID upid("metrics", process::address());
+
+    // Take a first snapshot so that the cached gauges have a value.
+    Future<http::Response> response = http::get(upid, "snapshot");
+    response.await();
+    ASSERT_EQ(response->status, http::OK().status);
+
+    vector<Future<http::Response>> states;
+    for (size_t i = 0; i < stateRequests; i++) {
+      states.push_back(http::get(master.get()->pid, "state"));
+    }
+
+    Stopwatch watch;
+    watch.start();
+    response = http::get(upid, "snapshot");
+    response.await();
+    watch.stop();
+
+    ASSERT_EQ(response->status, http::OK().status);
+
+    cout << "unversioned /metrics/snapshot' response behind "
+         << stateRequests << " '/state' requests took " << watch.elapsed()
+         << (cacheInterval.isSome()
+               ? " with a " + stringify(cacheInterval.get()) + " cache"
+               : " without a cache")
+         << endl;
+
+    await(states).await();
+  }
+}
+
 } // namespace tests {
 } // namespace internal {
 } // namespace mesos {
@@ -360,6 +360,35 @@ bool MasterLoadTest::RequestDescriptor::operator<(
 }
 
 
+// Returns the body of a response returned by one of the master's
+// read-only handlers, producing it first in case it is streamed.
+static std::string body(
+    const std::pair<
+        Response,
+        Option<mesos::internal::master::Master::ReadOnlyHandler::
+          PostProcessing>>& result)
+{
+  typedef mesos::internal::master::Master::ReadOnlyHandler::PostProcessing
+    PostProcessing;
+
+  std::string body = result.first.body;
+
+  if (result.second.isSome()) {
+    result.second->state.visit(
+        [](const PostProcessing::Subscribe&) {},
+        [&body](const PostProcessing::Stream& stream) {
+          for (Option<std::string> chunk = stream.next();
+               chunk.isSome();
+               chunk = stream.next()) {
+            body += chunk.get();
+          }
+        });
+  }
+
+  return body;
+}
+
+
 // Test that simultaneous responses to various different endpoints
 // all return the expected result.
 TEST_F(MasterLoadTest, SimultaneousBatchedRequests)
@@ -414,27 +443,27 @@ TEST_F(MasterLoadTest, SimultaneousBatchedRequests)
         {VIEW_ROLE, VIEW_FLAGS, VIEW_FRAMEWORK, VIEW_TASK, VIEW_EXECUTOR})
       .get();
 
-    Response reference;
+    std::string reference;
     if (request.endpoint == "/state") {
-      reference = readOnlyHandler.state(
-          ContentType::JSON, queryParameters, approvers).first;
+      reference = body(readOnlyHandler.state(
+          ContentType::JSON, queryParameters, approvers));
     } else if (request.endpoint == "/state-summary") {
-      reference = readOnlyHandler.stateSummary(
-          ContentType::JSON, queryParameters, approvers).first;
+      reference = body(readOnlyHandler.stateSummary(
+          ContentType::JSON, queryParameters, approvers));
     } else if (request.endpoint == "/roles") {
-      reference = readOnlyHandler.roles(
-          ContentType::JSON, queryParameters, approvers).first;
+      reference = body(readOnlyHandler.roles(
+          ContentType::JSON, queryParameters, approvers));
     } else if (request.endpoint == "/frameworks") {
-      reference = readOnlyHandler.frameworks(
-          ContentType::JSON, queryParameters, approvers).first;
+      reference = body(readOnlyHandler.frameworks(
+          ContentType::JSON, queryParameters, approvers));
     } else if (request.endpoint == "/slaves") {
-      reference = readOnlyHandler.slaves(
-          ContentType::JSON, queryParameters, approvers).first;
+      reference = body(readOnlyHandler.slaves(
+          ContentType::JSON, queryParameters, approvers));
     } else {
       UNREACHABLE();
     }
 
-    EXPECT_EQ(reference.body, response->body);
+    EXPECT_EQ(reference, response->body);
   }
 
   // Ensure that we actually hit the metrics code path while executing
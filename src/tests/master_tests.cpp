@@ -5068,6 +5068,78 @@ TEST_F(MasterTest, StateEndpoint)
 }
 
 
+// This test ensures that by default the body of the state endpoint is
+// produced at once, i.e. sent with a 'Content-Length'.
+TEST_F(MasterTest, StateEndpointNotStreamed)
+{
+  Try<Owned<cluster::Master>> master = StartMaster();
+  ASSERT_SOME(master);
+
+  Future<Response> response = process::http::streaming::get(
+      master.get()->pid,
+      "state",
+      None(),
+      createBasicAuthHeaders(DEFAULT_CREDENTIAL));
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(OK().status, response);
+  AWAIT_EXPECT_RESPONSE_HEADER_EQ(APPLICATION_JSON, "Content-Type", response);
+  ASSERT_TRUE(response->headers.contains("Content-Length"));
+
+  // The streaming client hands out the body through a pipe regardless.
+  ASSERT_EQ(Response::PIPE, response->type);
+  ASSERT_SOME(response->reader);
+
+  process::http::Pipe::Reader reader = response->reader.get();
+
+  Future<string> body = reader.readAll();
+  AWAIT_READY(body);
+
+  EXPECT_EQ(response->headers.at("Content-Length"), stringify(body->size()));
+
+  Try<JSON::Object> state = JSON::parse<JSON::Object>(body.get());
+  ASSERT_SOME(state);
+
+  EXPECT_EQ(MESOS_VERSION, state->values["version"]);
+}
+
+
+// This test ensures that with '--stream_state_responses' the body of the
+// state endpoint is streamed, i.e. sent in chunks instead of with a
+// 'Content-Length'.
+TEST_F(MasterTest, StateEndpointStreamed)
+{
+  master::Flags masterFlags = CreateMasterFlags();
+  masterFlags.stream_state_responses = true;
+
+  Try<Owned<cluster::Master>> master = StartMaster(masterFlags);
+  ASSERT_SOME(master);
+
+  Future<Response> response = process::http::streaming::get(
+      master.get()->pid,
+      "state",
+      None(),
+      createBasicAuthHeaders(DEFAULT_CREDENTIAL));
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(OK().status, response);
+  AWAIT_EXPECT_RESPONSE_HEADER_EQ(APPLICATION_JSON, "Content-Type", response);
+  EXPECT_EQ(Response::PIPE, response->type);
+  EXPECT_FALSE(response->headers.contains("Content-Length"));
+
+  ASSERT_SOME(response->reader);
+
+  process::http::Pipe::Reader reader = response->reader.get();
+
+  Future<string> body = reader.readAll();
+  AWAIT_READY(body);
+
+  Try<JSON::Object> state = JSON::parse<JSON::Object>(body.get());
+  ASSERT_SOME(state);
+
+  EXPECT_EQ(MESOS_VERSION, state->values["version"]);
+  EXPECT_EQ(stringify(master.get()->pid), state->values["pid"]);
+}
+
+
 // This test ensures that the framework's information is included in
 // the master's state endpoint.
 //
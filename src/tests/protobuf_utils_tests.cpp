@@ -260,6 +260,9 @@ TEST(ProtobufUtilTest, FrameworkCapabilities)
     if (capabilities.regionAware) {
       result.insert(FrameworkInfo::Capability::REGION_AWARE);
     }
+    if (capabilities.offerDeltas) {
+      result.insert(FrameworkInfo::Capability::OFFER_DELTAS);
+    }
 
     return result;
   };
@@ -309,6 +312,9 @@ TEST(ProtobufUtilTest, FrameworkCapabilities)
 
   expected = { FrameworkInfo::Capability::REGION_AWARE };
   EXPECT_EQ(expected, backAndForth(expected));
+
+  expected = { FrameworkInfo::Capability::OFFER_DELTAS };
+  EXPECT_EQ(expected, backAndForth(expected));
 }
 
 
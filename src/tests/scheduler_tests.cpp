@@ -38,9 +38,11 @@
 
 #include <process/metrics/metrics.hpp>
 
+#include <stout/hashmap.hpp>
 #include <stout/hashset.hpp>
 #include <stout/lambda.hpp>
 #include <stout/try.hpp>
+#include <stout/uuid.hpp>
 
 #include "internal/devolve.hpp"
 #include "internal/evolve.hpp"
@@ -1066,6 +1068,686 @@ TEST_P(SchedulerTest, KillTask)
 }
 
 
+// This test verifies that acknowledgements and kills sent in a 'BATCH'
+// call are processed by the master, and that the result of each item is
+// returned to the scheduler.
+TEST_P(SchedulerTest, Batch)
+{
+  Try<Owned<cluster::Master>> master = StartMaster();
+  ASSERT_SOME(master);
+
+  auto scheduler = std::make_shared<v1::MockHTTPScheduler>();
+  auto executor = std::make_shared<v1::MockHTTPExecutor>();
+
+  ExecutorID executorId = DEFAULT_EXECUTOR_ID;
+  TestContainerizer containerizer(executorId, executor);
+
+  Owned<MasterDetector> detector = master.get()->createDetector();
+  Try<Owned<cluster::Slave>> slave = StartSlave(detector.get(), &containerizer);
+  ASSERT_SOME(slave);
+
+  EXPECT_CALL(*scheduler, connected(_))
+    .WillOnce(v1::scheduler::SendSubscribe(v1::DEFAULT_FRAMEWORK_INFO));
+
+  Future<Event::Subscribed> subscribed;
+  EXPECT_CALL(*scheduler, subscribed(_, _))
+    .WillOnce(FutureArg<1>(&subscribed));
+
+  EXPECT_CALL(*scheduler, heartbeat(_))
+    .WillRepeatedly(Return()); // Ignore heartbeats.
+
+  Future<Event::Offers> offers;
+  EXPECT_CALL(*scheduler, offers(_, _))
+    .WillOnce(FutureArg<1>(&offers));
+
+  v1::scheduler::TestMesos mesos(
+      master.get()->pid,
+      GetParam(),
+      scheduler);
+
+  AWAIT_READY(subscribed);
+
+  v1::FrameworkID frameworkId(subscribed->framework_id());
+
+  AWAIT_READY(offers);
+  ASSERT_FALSE(offers->offers().empty());
+
+  EXPECT_CALL(*executor, connected(_))
+    .WillOnce(v1::executor::SendSubscribe(frameworkId, evolve(executorId)));
+
+  EXPECT_CALL(*executor, subscribed(_, _));
+
+  EXPECT_CALL(*executor, launch(_, _))
+    .WillOnce(v1::executor::SendUpdateFromTask(
+        frameworkId, evolve(executorId), v1::TASK_RUNNING));
+
+  Future<Nothing> acknowledged;
+  EXPECT_CALL(*executor, acknowledged(_, _))
+    .WillOnce(FutureSatisfy(&acknowledged))
+    .WillRepeatedly(Return());
+
+  Future<Event::Update> update1;
+  EXPECT_CALL(*scheduler, update(_, _))
+    .WillOnce(FutureArg<1>(&update1));
+
+  const v1::Offer& offer = offers->offers(0);
+
+  v1::TaskInfo taskInfo =
+    evolve(createTask(devolve(offer), "", DEFAULT_EXECUTOR_ID));
+
+  mesos.send(
+      v1::createCallAccept(
+          frameworkId,
+          offer,
+          {v1::LAUNCH({taskInfo})}));
+
+  AWAIT_READY(update1);
+
+  EXPECT_EQ(v1::TASK_RUNNING, update1->status().state());
+
+  // Acknowledge the TASK_RUNNING update, together with an update
+  // for an unknown agent which the master has to drop.
+  Future<mesos::v1::scheduler::APIResult> result;
+
+  {
+    Call call;
+    call.mutable_framework_id()->CopyFrom(frameworkId);
+    call.set_type(Call::BATCH);
+
+    Call::Acknowledge* acknowledge =
+      call.mutable_batch()->add_acknowledges();
+    acknowledge->mutable_task_id()->CopyFrom(taskInfo.task_id());
+    acknowledge->mutable_agent_id()->CopyFrom(offer.agent_id());
+    acknowledge->set_uuid(update1->status().uuid());
+
+    acknowledge = call.mutable_batch()->add_acknowledges();
+    acknowledge->mutable_task_id()->CopyFrom(taskInfo.task_id());
+    acknowledge->mutable_agent_id()->set_value("unknown");
+    acknowledge->set_uuid(update1->status().uuid());
+
+    result = mesos.call(call);
+  }
+
+  AWAIT_READY(result);
+  AWAIT_READY(acknowledged);
+
+  ASSERT_EQ(process::http::Status::OK, result->status_code());
+  ASSERT_TRUE(result->has_response());
+  ASSERT_EQ(
+      mesos::v1::scheduler::Response::BATCH,
+      result->response().type());
+
+  ASSERT_EQ(2, result->response().batch().acknowledges_size());
+  EXPECT_FALSE(result->response().batch().acknowledges(0).has_error());
+  EXPECT_TRUE(result->response().batch().acknowledges(1).has_error());
+
+  Future<Event::Update> update2;
+  EXPECT_CALL(*scheduler, update(_, _))
+    .WillOnce(FutureArg<1>(&update2));
+
+  EXPECT_CALL(*executor, kill(_, _))
+    .WillOnce(v1::executor::SendUpdateFromTaskID(
+        frameworkId, evolve(executorId), v1::TASK_KILLED));
+
+  // Kill the task, together with a kill naming the wrong agent.
+  {
+    Call call;
+    call.mutable_framework_id()->CopyFrom(frameworkId);
+    call.set_type(Call::BATCH);
+
+    Call::Kill* kill = call.mutable_batch()->add_kills();
+    kill->mutable_task_id()->CopyFrom(taskInfo.task_id());
+    kill->mutable_agent_id()->CopyFrom(offer.agent_id());
+
+    kill = call.mutable_batch()->add_kills();
+    kill->mutable_task_id()->CopyFrom(taskInfo.task_id());
+    kill->mutable_agent_id()->set_value("unknown");
+
+    result = mesos.call(call);
+  }
+
+  AWAIT_READY(result);
+  AWAIT_READY(update2);
+
+  EXPECT_EQ(v1::TASK_KILLED, update2->status().state());
+
+  ASSERT_EQ(process::http::Status::OK, result->status_code());
+  ASSERT_TRUE(result->has_response());
+
+  ASSERT_EQ(2, result->response().batch().kills_size());
+  EXPECT_FALSE(result->response().batch().kills(0).has_error());
+  EXPECT_TRUE(result->response().batch().kills(1).has_error());
+
+  EXPECT_CALL(*executor, shutdown(_))
+    .Times(AtMost(1));
+
+  EXPECT_CALL(*executor, disconnected(_))
+    .Times(AtMost(1));
+}
+
+
+// This test verifies that a 'BATCH' call can also be sent without
+// waiting for its results, i.e., that the scheduler library accepts
+// the "200 OK" response to it, and that the items of the batch are
+// processed by the master.
+TEST_P(SchedulerTest, SendBatch)
+{
+  Try<Owned<cluster::Master>> master = StartMaster();
+  ASSERT_SOME(master);
+
+  Owned<MasterDetector> detector = master.get()->createDetector();
+  Try<Owned<cluster::Slave>> slave = StartSlave(detector.get());
+  ASSERT_SOME(slave);
+
+  auto scheduler = std::make_shared<v1::MockHTTPScheduler>();
+
+  EXPECT_CALL(*scheduler, connected(_))
+    .WillOnce(v1::scheduler::SendSubscribe(v1::DEFAULT_FRAMEWORK_INFO));
+
+  Future<Event::Subscribed> subscribed;
+  EXPECT_CALL(*scheduler, subscribed(_, _))
+    .WillOnce(FutureArg<1>(&subscribed));
+
+  EXPECT_CALL(*scheduler, heartbeat(_))
+    .WillRepeatedly(Return()); // Ignore heartbeats.
+
+  // The scheduler library must neither report an error nor disconnect
+  // because of the response to the 'BATCH' call.
+  EXPECT_CALL(*scheduler, error(_, _))
+    .Times(0);
+
+  EXPECT_CALL(*scheduler, disconnected(_))
+    .Times(0);
+
+  Future<Event::Offers> offers1;
+  EXPECT_CALL(*scheduler, offers(_, _))
+    .WillOnce(FutureArg<1>(&offers1));
+
+  v1::scheduler::TestMesos mesos(
+      master.get()->pid,
+      GetParam(),
+      scheduler);
+
+  AWAIT_READY(subscribed);
+
+  v1::FrameworkID frameworkId(subscribed->framework_id());
+
+  AWAIT_READY(offers1);
+  ASSERT_FALSE(offers1->offers().empty());
+
+  const v1::Offer& offer = offers1->offers(0);
+
+  Future<Event::Offers> offers2;
+  EXPECT_CALL(*scheduler, offers(_, _))
+    .WillOnce(FutureArg<1>(&offers2));
+
+  Future<Nothing> recoverResources =
+    FUTURE_DISPATCH(_, &MesosAllocatorProcess::recoverResources);
+
+  // Decline the offer, together with an acknowledgement for an unknown
+  // agent which is dropped by the master.
+  {
+    Call call;
+    call.mutable_framework_id()->CopyFrom(frameworkId);
+    call.set_type(Call::BATCH);
+
+    Call::Decline* decline = call.mutable_batch()->add_declines();
+    decline->add_offer_ids()->CopyFrom(offer.id());
+
+    // Set 1hr filter to not immediately get another offer.
+    decline->mutable_filters()->set_refuse_seconds(Hours(1).secs());
+
+    Call::Acknowledge* acknowledge =
+      call.mutable_batch()->add_acknowledges();
+    acknowledge->mutable_task_id()->set_value("unknown");
+    acknowledge->mutable_agent_id()->set_value("unknown");
+    acknowledge->set_uuid(id::UUID::random().toBytes());
+
+    mesos.send(call);
+  }
+
+  AWAIT_READY(recoverResources);
+
+  // No offers should be sent within 30 mins because we set a filter
+  // for 1 hr.
+  Clock::pause();
+  Clock::advance(Minutes(30));
+  Clock::settle();
+
+  ASSERT_TRUE(offers2.isPending());
+
+  // The scheduler is still subscribed, so reviving gets it another
+  // offer with the same resources.
+  {
+    Call call;
+    call.mutable_framework_id()->CopyFrom(frameworkId);
+    call.set_type(Call::REVIVE);
+
+    mesos.send(call);
+  }
+
+  AWAIT_READY(offers2);
+  ASSERT_FALSE(offers2->offers().empty());
+  EXPECT_EQ(offer.resources(), offers2->offers(0).resources());
+}
+
+
+// This test verifies that for a framework with the OFFER_DELTAS
+// capability, the resources left unused by an ACCEPT call stay in the
+// accepted offer, and that the framework is sent a delta describing
+// the consumed resources.
+TEST_P(SchedulerTest, OfferDeltas)
+{
+  Try<Owned<cluster::Master>> master = StartMaster();
+  ASSERT_SOME(master);
+
+  auto scheduler = std::make_shared<v1::MockHTTPScheduler>();
+  auto executor = std::make_shared<v1::MockHTTPExecutor>();
+
+  ExecutorID executorId = DEFAULT_EXECUTOR_ID;
+  TestContainerizer containerizer(executorId, executor);
+
+  Owned<MasterDetector> detector = master.get()->createDetector();
+  Try<Owned<cluster::Slave>> slave = StartSlave(detector.get(), &containerizer);
+  ASSERT_SOME(slave);
+
+  v1::FrameworkInfo frameworkInfo = v1::DEFAULT_FRAMEWORK_INFO;
+  frameworkInfo.add_capabilities()->set_type(
+      v1::FrameworkInfo::Capability::OFFER_DELTAS);
+
+  EXPECT_CALL(*scheduler, connected(_))
+    .WillOnce(v1::scheduler::SendSubscribe(frameworkInfo));
+
+  Future<Event::Subscribed> subscribed;
+  EXPECT_CALL(*scheduler, subscribed(_, _))
+    .WillOnce(FutureArg<1>(&subscribed));
+
+  EXPECT_CALL(*scheduler, heartbeat(_))
+    .WillRepeatedly(Return()); // Ignore heartbeats.
+
+  EXPECT_CALL(*scheduler, update(_, _))
+    .WillRepeatedly(Return());
+
+  Future<Event::Offers> offers;
+  Future<Event::Offers> deltas;
+  EXPECT_CALL(*scheduler, offers(_, _))
+    .WillOnce(FutureArg<1>(&offers))
+    .WillOnce(FutureArg<1>(&deltas))
+    .WillRepeatedly(Return());
+
+  v1::scheduler::TestMesos mesos(
+      master.get()->pid,
+      GetParam(),
+      scheduler);
+
+  AWAIT_READY(subscribed);
+
+  v1::FrameworkID frameworkId(subscribed->framework_id());
+
+  AWAIT_READY(offers);
+  ASSERT_EQ(1, offers->offers().size());
+
+  const v1::Offer& offer = offers->offers(0);
+  ASSERT_TRUE(offer.has_version());
+  EXPECT_EQ(0u, offer.version());
+
+  EXPECT_CALL(*executor, connected(_))
+    .WillOnce(v1::executor::SendSubscribe(frameworkId, evolve(executorId)));
+
+  EXPECT_CALL(*executor, subscribed(_, _));
+
+  EXPECT_CALL(*executor, launch(_, _))
+    .WillOnce(v1::executor::SendUpdateFromTask(
+        frameworkId, evolve(executorId), v1::TASK_RUNNING));
+
+  EXPECT_CALL(*executor, acknowledged(_, _))
+    .WillRepeatedly(Return());
+
+  v1::Resources taskResources =
+    v1::Resources::parse("cpus:0.1;mem:32").get();
+  taskResources.allocate(frameworkInfo.roles(0));
+
+  v1::TaskInfo taskInfo = v1::createTask(
+      offer.agent_id(), taskResources, "", evolve(executorId));
+
+  Call call = v1::createCallAccept(
+      frameworkId,
+      offer,
+      {v1::LAUNCH({taskInfo})});
+
+  call.mutable_accept()->add_offer_versions(offer.version());
+
+  mesos.send(call);
+
+  AWAIT_READY(deltas);
+
+  EXPECT_TRUE(deltas->offers().empty());
+  ASSERT_EQ(1, deltas->offer_deltas().size());
+
+  const v1::Offer::Delta& delta = deltas->offer_deltas(0);
+
+  EXPECT_EQ(offer.id(), delta.offer_id());
+  EXPECT_EQ(1u, delta.version());
+  EXPECT_TRUE(delta.added().empty());
+  EXPECT_EQ(taskResources, v1::Resources(delta.removed()));
+
+  EXPECT_CALL(*executor, shutdown(_))
+    .Times(AtMost(1));
+
+  EXPECT_CALL(*executor, disconnected(_))
+    .Times(AtMost(1));
+}
+
+
+// This test verifies that for a framework with the OFFER_DELTAS
+// capability, resources which are allocated to the framework on an
+// agent where it holds an offer are added to that offer, and that the
+// framework is sent a delta describing the added resources.
+TEST_P(SchedulerTest, OfferDeltasAllocation)
+{
+  Try<Owned<cluster::Master>> master = StartMaster();
+  ASSERT_SOME(master);
+
+  auto scheduler = std::make_shared<v1::MockHTTPScheduler>();
+  auto executor = std::make_shared<v1::MockHTTPExecutor>();
+
+  ExecutorID executorId = DEFAULT_EXECUTOR_ID;
+  TestContainerizer containerizer(executorId, executor);
+
+  Owned<MasterDetector> detector = master.get()->createDetector();
+  Try<Owned<cluster::Slave>> slave = StartSlave(detector.get(), &containerizer);
+  ASSERT_SOME(slave);
+
+  v1::FrameworkInfo frameworkInfo = v1::DEFAULT_FRAMEWORK_INFO;
+  frameworkInfo.add_capabilities()->set_type(
+      v1::FrameworkInfo::Capability::OFFER_DELTAS);
+
+  EXPECT_CALL(*scheduler, connected(_))
+    .WillOnce(v1::scheduler::SendSubscribe(frameworkInfo));
+
+  Future<Event::Subscribed> subscribed;
+  EXPECT_CALL(*scheduler, subscribed(_, _))
+    .WillOnce(FutureArg<1>(&subscribed));
+
+  EXPECT_CALL(*scheduler, heartbeat(_))
+    .WillRepeatedly(Return()); // Ignore heartbeats.
+
+  EXPECT_CALL(*scheduler, update(_, _))
+    .WillRepeatedly(Return());
+
+  Future<Event::Offers> offers;
+  Future<Event::Offers> removed;
+  Future<Event::Offers> added;
+  EXPECT_CALL(*scheduler, offers(_, _))
+    .WillOnce(FutureArg<1>(&offers))
+    .WillOnce(FutureArg<1>(&removed))
+    .WillOnce(FutureArg<1>(&added))
+    .WillRepeatedly(Return());
+
+  v1::scheduler::TestMesos mesos(
+      master.get()->pid,
+      GetParam(),
+      scheduler);
+
+  AWAIT_READY(subscribed);
+
+  v1::FrameworkID frameworkId(subscribed->framework_id());
+
+  AWAIT_READY(offers);
+  ASSERT_EQ(1, offers->offers().size());
+
+  const v1::Offer& offer = offers->offers(0);
+
+  EXPECT_CALL(*executor, connected(_))
+    .WillOnce(v1::executor::SendSubscribe(frameworkId, evolve(executorId)));
+
+  EXPECT_CALL(*executor, subscribed(_, _));
+
+  // The task finishes right away, so that its resources are allocated
+  // to the framework again.
+  EXPECT_CALL(*executor, launch(_, _))
+    .WillOnce(v1::executor::SendUpdateFromTask(
+        frameworkId, evolve(executorId), v1::TASK_FINISHED));
+
+  EXPECT_CALL(*executor, acknowledged(_, _))
+    .WillRepeatedly(Return());
+
+  v1::Resources taskResources =
+    v1::Resources::parse("cpus:0.1;mem:32").get();
+  taskResources.allocate(frameworkInfo.roles(0));
+
+  v1::TaskInfo taskInfo = v1::createTask(
+      offer.agent_id(), taskResources, "", evolve(executorId));
+
+  mesos.send(v1::createCallAccept(
+      frameworkId,
+      offer,
+      {v1::LAUNCH({taskInfo})}));
+
+  AWAIT_READY(removed);
+  ASSERT_EQ(1, removed->offer_deltas().size());
+  EXPECT_EQ(1u, removed->offer_deltas(0).version());
+
+  AWAIT_READY(added);
+
+  EXPECT_TRUE(added->offers().empty());
+  ASSERT_EQ(1, added->offer_deltas().size());
+
+  const v1::Offer::Delta& delta = added->offer_deltas(0);
+
+  EXPECT_EQ(offer.id(), delta.offer_id());
+  EXPECT_EQ(2u, delta.version());
+  EXPECT_EQ(taskResources, v1::Resources(delta.added()));
+  EXPECT_TRUE(delta.removed().empty());
+
+  EXPECT_CALL(*executor, shutdown(_))
+    .Times(AtMost(1));
+
+  EXPECT_CALL(*executor, disconnected(_))
+    .Times(AtMost(1));
+}
+
+
+// This test verifies that for a framework with the OFFER_DELTAS
+// capability, the resources left unused by an ACCEPT call of offers
+// for several roles stay in the accepted offer of their role.
+TEST_P(SchedulerTest, OfferDeltasPerRole)
+{
+  Try<Owned<cluster::Master>> master = StartMaster();
+  ASSERT_SOME(master);
+
+  auto scheduler = std::make_shared<v1::MockHTTPScheduler>();
+  auto executor = std::make_shared<v1::MockHTTPExecutor>();
+
+  ExecutorID executorId = DEFAULT_EXECUTOR_ID;
+  TestContainerizer containerizer(executorId, executor);
+
+  // The resources of the agent are reserved for two roles, so that
+  // the framework is offered them in one offer per role.
+  slave::Flags flags = CreateSlaveFlags();
+  flags.resources =
+    "cpus(role1):1;mem(role1):512;cpus(role2):1;mem(role2):512";
+
+  Owned<MasterDetector> detector = master.get()->createDetector();
+  Try<Owned<cluster::Slave>> slave =
+    StartSlave(detector.get(), &containerizer, flags);
+  ASSERT_SOME(slave);
+
+  v1::FrameworkInfo frameworkInfo = v1::DEFAULT_FRAMEWORK_INFO;
+  frameworkInfo.clear_roles();
+  frameworkInfo.add_roles("role1");
+  frameworkInfo.add_roles("role2");
+  frameworkInfo.add_capabilities()->set_type(
+      v1::FrameworkInfo::Capability::OFFER_DELTAS);
+
+  EXPECT_CALL(*scheduler, connected(_))
+    .WillOnce(v1::scheduler::SendSubscribe(frameworkInfo));
+
+  Future<Event::Subscribed> subscribed;
+  EXPECT_CALL(*scheduler, subscribed(_, _))
+    .WillOnce(FutureArg<1>(&subscribed));
+
+  EXPECT_CALL(*scheduler, heartbeat(_))
+    .WillRepeatedly(Return()); // Ignore heartbeats.
+
+  EXPECT_CALL(*scheduler, update(_, _))
+    .WillRepeatedly(Return());
+
+  Future<Event::Offers> offers;
+  Future<Event::Offers> deltas;
+  EXPECT_CALL(*scheduler, offers(_, _))
+    .WillOnce(FutureArg<1>(&offers))
+    .WillOnce(FutureArg<1>(&deltas))
+    .WillRepeatedly(Return());
+
+  v1::scheduler::TestMesos mesos(
+      master.get()->pid,
+      GetParam(),
+      scheduler);
+
+  AWAIT_READY(subscribed);
+
+  v1::FrameworkID frameworkId(subscribed->framework_id());
+
+  AWAIT_READY(offers);
+  ASSERT_EQ(2, offers->offers().size());
+
+  hashmap<string, v1::Offer> roleOffers;
+  foreach (const v1::Offer& offer, offers->offers()) {
+    roleOffers[offer.allocation_info().role()] = offer;
+  }
+
+  ASSERT_TRUE(roleOffers.contains("role1"));
+  ASSERT_TRUE(roleOffers.contains("role2"));
+
+  EXPECT_CALL(*executor, connected(_))
+    .WillOnce(v1::executor::SendSubscribe(frameworkId, evolve(executorId)));
+
+  EXPECT_CALL(*executor, subscribed(_, _));
+
+  EXPECT_CALL(*executor, launch(_, _))
+    .WillOnce(v1::executor::SendUpdateFromTask(
+        frameworkId, evolve(executorId), v1::TASK_RUNNING));
+
+  EXPECT_CALL(*executor, acknowledged(_, _))
+    .WillRepeatedly(Return());
+
+  v1::Resources taskResources =
+    v1::Resources::parse("cpus(role1):0.1;mem(role1):32").get();
+  taskResources.allocate("role1");
+
+  v1::TaskInfo taskInfo = v1::createTask(
+      roleOffers["role1"].agent_id(), taskResources, "", evolve(executorId));
+
+  Call call = v1::createCallAccept(
+      frameworkId,
+      roleOffers["role1"],
+      {v1::LAUNCH({taskInfo})});
+
+  call.mutable_accept()->add_offer_ids()->CopyFrom(roleOffers["role2"].id());
+
+  mesos.send(call);
+
+  AWAIT_READY(deltas);
+
+  EXPECT_TRUE(deltas->offers().empty());
+  ASSERT_EQ(2, deltas->offer_deltas().size());
+
+  foreach (const v1::Offer::Delta& delta, deltas->offer_deltas()) {
+    EXPECT_EQ(1u, delta.version());
+    EXPECT_TRUE(delta.added().empty());
+
+    if (delta.offer_id() == roleOffers["role1"].id()) {
+      EXPECT_EQ(taskResources, v1::Resources(delta.removed()));
+    } else {
+      EXPECT_EQ(roleOffers["role2"].id(), delta.offer_id());
+      EXPECT_TRUE(delta.removed().empty());
+    }
+  }
+
+  EXPECT_CALL(*executor, shutdown(_))
+    .Times(AtMost(1));
+
+  EXPECT_CALL(*executor, disconnected(_))
+    .Times(AtMost(1));
+}
+
+
+// This test verifies that an ACCEPT call naming an offer version
+// other than the current version of the offer is rejected.
+TEST_P(SchedulerTest, OfferDeltasVersionMismatch)
+{
+  Try<Owned<cluster::Master>> master = StartMaster();
+  ASSERT_SOME(master);
+
+  Owned<MasterDetector> detector = master.get()->createDetector();
+  Try<Owned<cluster::Slave>> slave = StartSlave(detector.get());
+  ASSERT_SOME(slave);
+
+  auto scheduler = std::make_shared<v1::MockHTTPScheduler>();
+
+  v1::FrameworkInfo frameworkInfo = v1::DEFAULT_FRAMEWORK_INFO;
+  frameworkInfo.add_capabilities()->set_type(
+      v1::FrameworkInfo::Capability::OFFER_DELTAS);
+
+  EXPECT_CALL(*scheduler, connected(_))
+    .WillOnce(v1::scheduler::SendSubscribe(frameworkInfo));
+
+  Future<Event::Subscribed> subscribed;
+  EXPECT_CALL(*scheduler, subscribed(_, _))
+    .WillOnce(FutureArg<1>(&subscribed));
+
+  EXPECT_CALL(*scheduler, heartbeat(_))
+    .WillRepeatedly(Return()); // Ignore heartbeats.
+
+  Future<Event::Offers> offers;
+  EXPECT_CALL(*scheduler, offers(_, _))
+    .WillOnce(FutureArg<1>(&offers))
+    .WillRepeatedly(Return());
+
+  v1::scheduler::TestMesos mesos(
+      master.get()->pid,
+      GetParam(),
+      scheduler);
+
+  AWAIT_READY(subscribed);
+
+  v1::FrameworkID frameworkId(subscribed->framework_id());
+
+  AWAIT_READY(offers);
+  ASSERT_EQ(1, offers->offers().size());
+
+  const v1::Offer& offer = offers->offers(0);
+  ASSERT_TRUE(offer.has_version());
+
+  v1::TaskInfo taskInfo = v1::createTask(
+      offer.agent_id(),
+      v1::Resources::parse("cpus:0.1;mem:32").get(),
+      SLEEP_COMMAND(1000));
+
+  Future<Event::Update> update;
+  EXPECT_CALL(*scheduler, update(_, _))
+    .WillOnce(FutureArg<1>(&update));
+
+  Call call = v1::createCallAccept(
+      frameworkId,
+      offer,
+      {v1::LAUNCH({taskInfo})});
+
+  call.mutable_accept()->add_offer_versions(offer.version() + 1);
+
+  mesos.send(call);
+
+  AWAIT_READY(update);
+
+  EXPECT_EQ(taskInfo.task_id(), update->status().task_id());
+  EXPECT_EQ(v1::TASK_LOST, update->status().state());
+  EXPECT_EQ(v1::TaskStatus::SOURCE_MASTER, update->status().source());
+  EXPECT_EQ(
+      v1::TaskStatus::REASON_INVALID_OFFERS, update->status().reason());
+}
+
+
 // Verifies invalidation of LAUNCH and LAUNCH_GROUP operations with `id` set.
 TEST_P(SchedulerTest, OperationFeedbackValidationWithResourceProviderCapability)
 {
@@ -18,6 +18,8 @@
 #include <unistd.h>
 #endif // __WINDOWS__
 
+#include <iostream>
+#include <memory>
 #include <string>
 
 #include <gtest/gtest.h>
@@ -41,12 +43,14 @@
 #include <process/owned.hpp>
 #include <process/reap.hpp>
 
+#include <stout/fs.hpp>
 #include <stout/hashset.hpp>
 #include <stout/none.hpp>
 #include <stout/numify.hpp>
 #include <stout/option.hpp>
 #include <stout/os.hpp>
 #include <stout/path.hpp>
+#include <stout/stopwatch.hpp>
 #include <stout/uuid.hpp>
 
 #include <stout/os/killtree.hpp>
@@ -59,6 +63,7 @@
 
 #include "master/detector/standalone.hpp"
 
+#include "slave/checkpoint_log.hpp"
 #include "slave/gc.hpp"
 #include "slave/gc_process.hpp"
 #include "slave/paths.hpp"
@@ -95,6 +100,8 @@ using mesos::slave::ContainerTermination;
 
 using mesos::v1::executor::Call;
 
+using std::cout;
+using std::endl;
 using std::map;
 using std::string;
 using std::vector;
@@ -105,6 +112,7 @@ using testing::DoAll;
 using testing::Eq;
 using testing::Return;
 using testing::SaveArg;
+using testing::WithParamInterface;
 
 namespace mesos {
 namespace internal {
@@ -157,6 +165,463 @@ TEST_F(SlaveStateTest, CheckpointRepeatedProtobufMessages)
 }
 
 
+// Checkpoints the state of an agent running a single framework with
+// `executorCount` executors, each of which has a running latest run
+// and `completedRunCount` completed runs, with a task in every run.
+static void checkpointAgentState(
+    const string& rootDir,
+    size_t executorCount,
+    size_t completedRunCount)
+{
+  SlaveID slaveId;
+  slaveId.set_value("agent");
+
+  SlaveInfo slaveInfo;
+  slaveInfo.set_hostname("localhost");
+  slaveInfo.mutable_id()->CopyFrom(slaveId);
+
+  ASSERT_SOME(slave::state::checkpoint(
+      paths::getSlaveInfoPath(rootDir, slaveId), slaveInfo));
+
+  ASSERT_SOME(fs::symlink(
+      paths::getSlavePath(rootDir, slaveId),
+      paths::getLatestSlavePath(rootDir)));
+
+  FrameworkInfo frameworkInfo = DEFAULT_FRAMEWORK_INFO;
+  frameworkInfo.mutable_id()->set_value("framework");
+
+  const FrameworkID& frameworkId = frameworkInfo.id();
+
+  ASSERT_SOME(slave::state::checkpoint(
+      paths::getFrameworkInfoPath(rootDir, slaveId, frameworkId),
+      frameworkInfo));
+
+  ASSERT_SOME(slave::state::checkpoint(
+      paths::getFrameworkPidPath(rootDir, slaveId, frameworkId),
+      string("scheduler@127.0.0.1:5050")));
+
+  for (size_t i = 0; i < executorCount; i++) {
+    ExecutorInfo executorInfo;
+    executorInfo.mutable_executor_id()->set_value("executor" + stringify(i));
+    executorInfo.mutable_framework_id()->CopyFrom(frameworkId);
+    executorInfo.mutable_command()->set_value("sleep 1000");
+
+    const ExecutorID& executorId = executorInfo.executor_id();
+
+    ASSERT_SOME(slave::state::checkpoint(
+        paths::getExecutorInfoPath(rootDir, slaveId, frameworkId, executorId),
+        executorInfo));
+
+    // NOTE: The run created last becomes the latest run.
+    for (size_t j = 0; j <= completedRunCount; j++) {
+      ContainerID containerId;
+      containerId.set_value(id::UUID::random().toString());
+
+      ASSERT_SOME(paths::createExecutorDirectory(
+          rootDir, slaveId, frameworkId, executorId, containerId));
+
+      ASSERT_SOME(slave::state::checkpoint(
+          paths::getForkedPidPath(
+              rootDir, slaveId, frameworkId, executorId, containerId),
+          stringify(1000 + i)));
+
+      ASSERT_SOME(slave::state::checkpoint(
+          paths::getLibprocessPidPath(
+              rootDir, slaveId, frameworkId, executorId, containerId),
+          string("executor@127.0.0.1:5051")));
+
+      const bool completed = j < completedRunCount;
+
+      Task task;
+      task.set_name("task");
+      task.mutable_task_id()->set_value(containerId.value());
+      task.mutable_framework_id()->CopyFrom(frameworkId);
+      task.mutable_slave_id()->CopyFrom(slaveId);
+      task.mutable_executor_id()->CopyFrom(executorId);
+      task.set_state(completed ? TASK_FINISHED : TASK_RUNNING);
+
+      ASSERT_SOME(slave::state::checkpoint(
+          paths::getTaskInfoPath(
+              rootDir,
+              slaveId,
+              frameworkId,
+              executorId,
+              containerId,
+              task.task_id()),
+          task));
+
+      StatusUpdateRecord record;
+      record.set_type(StatusUpdateRecord::UPDATE);
+      record.mutable_update()->CopyFrom(protobuf::createStatusUpdate(
+          frameworkId,
+          slaveId,
+          task.task_id(),
+          task.state(),
+          TaskStatus::SOURCE_EXECUTOR,
+          id::UUID::random()));
+
+      ASSERT_SOME(slave::state::checkpoint(
+          paths::getTaskUpdatesPath(
+              rootDir,
+              slaveId,
+              frameworkId,
+              executorId,
+              containerId,
+              task.task_id()),
+          record));
+
+      if (completed) {
+        ASSERT_SOME(slave::state::checkpoint(
+            paths::getExecutorSentinelPath(
+                rootDir, slaveId, frameworkId, executorId, containerId),
+            string()));
+      }
+    }
+  }
+}
+
+
+// This test verifies that recovery reads the full state of the latest
+// run of the executors only, but still reports their completed runs.
+TEST_F(SlaveStateTest, RecoverCompletedRuns)
+{
+  checkpointAgentState(sandbox.get(), 10, 2);
+
+  Try<slave::state::State> state = slave::state::recover(sandbox.get(), true);
+  ASSERT_SOME(state);
+  ASSERT_SOME(state->slave);
+  EXPECT_EQ(0u, state->errors);
+  ASSERT_EQ(1u, state->slave->frameworks.size());
+
+  const slave::state::FrameworkState& framework =
+    state->slave->frameworks.begin()->second;
+
+  ASSERT_EQ(10u, framework.executors.size());
+
+  foreachvalue (const slave::state::ExecutorState& executor,
+                framework.executors) {
+    ASSERT_SOME(executor.info);
+    ASSERT_SOME(executor.latest);
+    ASSERT_EQ(3u, executor.runs.size());
+
+    foreachvalue (const slave::state::RunState& run, executor.runs) {
+      ASSERT_SOME(run.id);
+
+      if (run.id.get() == executor.latest.get()) {
+        EXPECT_FALSE(run.completed);
+        EXPECT_EQ(1u, run.tasks.size());
+        EXPECT_SOME(run.forkedPid);
+        EXPECT_SOME(run.libprocessPid);
+        continue;
+      }
+
+      EXPECT_TRUE(run.completed);
+      EXPECT_TRUE(run.tasks.empty());
+      EXPECT_NONE(run.forkedPid);
+
+      // The full state of a completed run can still be recovered.
+      Try<slave::state::RunState> recovered =
+        slave::state::RunState::recover(
+            sandbox.get(),
+            state->slave->id,
+            framework.id,
+            executor.id,
+            run.id.get(),
+            true,
+            false);
+
+      ASSERT_SOME(recovered);
+      EXPECT_TRUE(recovered->completed);
+      EXPECT_EQ(1u, recovered->tasks.size());
+    }
+  }
+}
+
+
+// This test verifies that the checkpointed files of the frameworks are
+// moved into the checkpoint log and back out of it, and that a record
+// torn by a crash is dropped when the log is replayed.
+TEST_F(SlaveStateTest, CheckpointLog)
+{
+  checkpointAgentState(sandbox.get(), 10, 2);
+
+  Try<slave::state::State> state = slave::state::recover(sandbox.get(), true);
+  ASSERT_SOME(state);
+  ASSERT_SOME(state->slave);
+  ASSERT_EQ(1u, state->slave->frameworks.size());
+
+  const SlaveID slaveId = state->slave->id;
+
+  const slave::state::FrameworkState framework =
+    state->slave->frameworks.begin()->second;
+
+  const slave::state::ExecutorState executor =
+    framework.executors.begin()->second;
+
+  ASSERT_SOME(executor.latest);
+
+  const slave::state::RunState run = executor.runs.at(executor.latest.get());
+  ASSERT_EQ(1u, run.tasks.size());
+
+  const TaskID taskId = run.tasks.begin()->first;
+
+  const string frameworkInfoPath =
+    paths::getFrameworkInfoPath(sandbox.get(), slaveId, framework.id);
+
+  const string updatesPath = paths::getTaskUpdatesPath(
+      sandbox.get(),
+      slaveId,
+      framework.id,
+      executor.id,
+      executor.latest.get(),
+      taskId);
+
+  Try<std::shared_ptr<CheckpointLog>> log = CheckpointLog::open(sandbox.get(), true);
+  ASSERT_SOME(log);
+
+  EXPECT_FALSE(os::exists(frameworkInfoPath));
+  EXPECT_TRUE(log.get()->exists(frameworkInfoPath));
+  EXPECT_TRUE(os::exists(paths::getSlaveInfoPath(sandbox.get(), slaveId)));
+
+  slave::state::setCheckpointLog(sandbox.get(), log.get());
+
+  // Checkpoint another status update and simulate a crash while
+  // appending yet another one.
+  StatusUpdateRecord record;
+  record.set_type(StatusUpdateRecord::ACK);
+  record.set_uuid(run.tasks.at(taskId).updates.front().uuid());
+
+  string data;
+  ASSERT_SOME(slave::state::internal::encode(record, &data));
+  ASSERT_SOME(log.get()->append(updatesPath, data));
+
+  Try<int_fd> fd = os::open(
+      paths::getCheckpointLogPath(sandbox.get()),
+      O_WRONLY | O_APPEND | O_CLOEXEC);
+
+  ASSERT_SOME(fd);
+  ASSERT_SOME(os::write(fd.get(), data.substr(0, data.size() / 2)));
+  ASSERT_SOME(os::close(fd.get()));
+
+  log = CheckpointLog::open(sandbox.get(), true);
+  ASSERT_SOME(log);
+
+  slave::state::setCheckpointLog(sandbox.get(), log.get());
+
+  state = slave::state::recover(sandbox.get(), true);
+  ASSERT_SOME(state);
+  ASSERT_SOME(state->slave);
+  EXPECT_EQ(0u, state->errors);
+  EXPECT_EQ(
+      10u, state->slave->frameworks.at(framework.id).executors.size());
+
+  slave::state::TaskState task = state->slave->frameworks.at(framework.id)
+    .executors.at(executor.id)
+    .runs.at(executor.latest.get())
+    .tasks.at(taskId);
+
+  EXPECT_EQ(1u, task.updates.size());
+  EXPECT_EQ(1u, task.acks.size());
+
+  // Move the checkpointed files back out of the log.
+  slave::state::setCheckpointLog(sandbox.get(), nullptr);
+
+  ASSERT_SOME(CheckpointLog::restore(sandbox.get(), true));
+
+  EXPECT_FALSE(os::exists(paths::getCheckpointLogPath(sandbox.get())));
+  EXPECT_TRUE(os::exists(frameworkInfoPath));
+
+  state = slave::state::recover(sandbox.get(), true);
+  ASSERT_SOME(state);
+  ASSERT_SOME(state->slave);
+  EXPECT_EQ(0u, state->errors);
+
+  task = state->slave->frameworks.at(framework.id)
+    .executors.at(executor.id)
+    .runs.at(executor.latest.get())
+    .tasks.at(taskId);
+
+  EXPECT_EQ(1u, task.updates.size());
+  EXPECT_EQ(1u, task.acks.size());
+}
+
+
+// This test verifies that a corrupted record in the middle of the
+// checkpoint log is skipped when the log is replayed, unless the
+// recovery is strict.
+TEST_F(SlaveStateTest, CheckpointLogCorruptedRecord)
+{
+  checkpointAgentState(sandbox.get(), 1, 0);
+
+  Try<slave::state::State> state = slave::state::recover(sandbox.get(), true);
+  ASSERT_SOME(state);
+  ASSERT_SOME(state->slave);
+
+  const SlaveID slaveId = state->slave->id;
+  const FrameworkID frameworkId = state->slave->frameworks.begin()->first;
+
+  const string frameworkInfoPath =
+    paths::getFrameworkInfoPath(sandbox.get(), slaveId, frameworkId);
+
+  // NOTE: We use a file which has not been checkpointed before, since
+  // the records following a skipped one apply to the previous contents.
+  const string filePath =
+    path::join(Path(frameworkInfoPath).dirname(), "file");
+
+  const string logPath = paths::getCheckpointLogPath(sandbox.get());
+
+  Bytes offset;
+
+  {
+    Try<std::shared_ptr<CheckpointLog>> log =
+      CheckpointLog::open(sandbox.get(), true);
+
+    ASSERT_SOME(log);
+
+    Try<Bytes> size = os::stat::size(logPath);
+    ASSERT_SOME(size);
+
+    offset = size.get();
+
+    ASSERT_SOME(log.get()->write(filePath, "corrupted", true));
+    ASSERT_SOME(log.get()->append(filePath, "valid", true));
+  }
+
+  // Flip the last byte of the data of the first record.
+  Try<string> data = os::read(logPath);
+  ASSERT_SOME(data);
+
+  const string marker = "corrupted";
+  const size_t position = data->find(marker, offset.bytes());
+  ASSERT_NE(string::npos, position);
+
+  string corrupted = data.get();
+  corrupted[position + marker.size() - 1] ^= 0xff;
+  ASSERT_SOME(os::write(logPath, corrupted));
+
+  EXPECT_ERROR(CheckpointLog::open(sandbox.get(), true));
+
+  Try<std::shared_ptr<CheckpointLog>> log =
+    CheckpointLog::open(sandbox.get(), false);
+
+  ASSERT_SOME(log);
+
+  // Only the append following the corrupted record is replayed.
+  EXPECT_SOME_EQ("valid", log.get()->read(filePath));
+  EXPECT_SOME(log.get()->read(frameworkInfoPath));
+
+  // The corrupted record is dropped from the log.
+  log = CheckpointLog::open(sandbox.get(), true);
+  ASSERT_SOME(log);
+
+  EXPECT_SOME_EQ("valid", log.get()->read(filePath));
+}
+
+
+class SlaveState_BENCHMARK_Test
+  : public TemporaryDirectoryTest,
+    public WithParamInterface<size_t> {};
+
+
+INSTANTIATE_TEST_CASE_P(
+    Executors,
+    SlaveState_BENCHMARK_Test,
+    ::testing::Values(1000U, 10000U));
+
+
+// This benchmark measures how long it takes to recover the checkpointed
+// state of an agent with many executors, each of which has a couple of
+// completed runs that have not been garbage collected yet.
+TEST_P(SlaveState_BENCHMARK_Test, Recover)
+{
+  const size_t executorCount = GetParam();
+  const size_t completedRunCount = 2;
+
+  checkpointAgentState(sandbox.get(), executorCount, completedRunCount);
+
+  cout << "Test setup: " << executorCount << " executors with "
+       << completedRunCount << " completed runs each" << endl;
+
+  Stopwatch watch;
+  watch.start();
+
+  Try<slave::state::State> state = slave::state::recover(sandbox.get(), true);
+
+  ASSERT_SOME(state);
+  ASSERT_SOME(state->slave);
+  ASSERT_EQ(1u, state->slave->frameworks.size());
+  EXPECT_EQ(
+      executorCount,
+      state->slave->frameworks.begin()->second.executors.size());
+
+  cout << "Recovered the agent state in " << watch.elapsed() << endl;
+}
+
+
+// This benchmark compares checkpointing the state of an agent with many
+// executors and recovering it when it is stored in individual files and
+// when it is stored in the checkpoint log.
+TEST_P(SlaveState_BENCHMARK_Test, CheckpointLog)
+{
+  const size_t executorCount = GetParam();
+  const size_t completedRunCount = 2;
+
+  cout << "Test setup: " << executorCount << " executors with "
+       << completedRunCount << " completed runs each" << endl;
+
+  for (bool checkpointLog : {false, true}) {
+    const string rootDir =
+      path::join(sandbox.get(), checkpointLog ? "log" : "files");
+
+    const string layout = checkpointLog ? "the checkpoint log" : "files";
+
+    Try<std::shared_ptr<CheckpointLog>> log =
+      std::shared_ptr<CheckpointLog>();
+
+    if (checkpointLog) {
+      log = CheckpointLog::open(rootDir, true);
+      ASSERT_SOME(log);
+
+      slave::state::setCheckpointLog(rootDir, log.get());
+    }
+
+    Stopwatch watch;
+    watch.start();
+
+    checkpointAgentState(rootDir, executorCount, completedRunCount);
+
+    cout << "Checkpointed the agent state to " << layout << " in "
+         << watch.elapsed() << endl;
+
+    watch.start();
+
+    // Recovering from the log includes replaying it.
+    if (checkpointLog) {
+      slave::state::setCheckpointLog(rootDir, nullptr);
+
+      log = CheckpointLog::open(rootDir, true);
+      ASSERT_SOME(log);
+
+      slave::state::setCheckpointLog(rootDir, log.get());
+    }
+
+    Try<slave::state::State> state = slave::state::recover(rootDir, true);
+
+    ASSERT_SOME(state);
+    ASSERT_SOME(state->slave);
+    ASSERT_EQ(1u, state->slave->frameworks.size());
+    EXPECT_EQ(
+        executorCount,
+        state->slave->frameworks.begin()->second.executors.size());
+
+    cout << "Recovered the agent state from " << layout << " in "
+         << watch.elapsed() << endl;
+
+    slave::state::setCheckpointLog(rootDir, nullptr);
+  }
+}
+
+
 template <typename T>
 class SlaveRecoveryTest : public ContainerizerTest<T>
 {